@@ -1,6 +1,7 @@
 #pragma once
 
 #include "CommandLineOptionsParser.h"
+#include "assembler/ObjectCode.h"
 
 namespace ASM
 {
@@ -15,6 +16,10 @@ public:
 
 protected:
     CommandLineOptionsParser const & options;
+
+    bool RunBatch();
+    bool ShowTrace();
+    void Recompile(Assembler::ObjectCode const & objectCode);
 };
 
 } // namespace ASM
\ No newline at end of file
@@ -14,6 +14,12 @@ public:
     bool listSymbols;
     bool listSymbolCrossReferences;
     bool emulate;
+    std::string batchFilePath;
+    uint32_t jobs;
+    std::string traceFilePath;
+    std::string showTraceFilePath;
+    std::string diffTraceFilePath;
+    std::string recompileFilePath;
 
     void ResolveDefaults();
 };
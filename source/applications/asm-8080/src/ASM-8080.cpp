@@ -1,7 +1,13 @@
 #include "ASM-8080.h"
+#include <cctype>
+#include <iomanip>
+#include "core/Path.h"
 #include "assembler/Parser.h"
 #include "assembler/ObjectFile.h"
 #include "emulator/Emulator.h"
+#include "emulator/BatchRunnerIntel8080.h"
+#include "emulator/TraceIntel8080.h"
+#include "emulator/RecompilerIntel8080.h"
 
 using namespace std;
 using namespace ASM;
@@ -20,6 +26,11 @@ ASM_8080::~ASM_8080()
 
 bool ASM_8080::Run()
 {
+    if (!options.showTraceFilePath.empty())
+        return ShowTrace();
+    if (!options.batchFilePath.empty())
+        return RunBatch();
+
     Assembler::AssemblerMessages messages;
     std::ifstream inputStream(options.inputFilePath);
     std::ofstream outputObjectStream(options.outputObjectFilePath, std::ios::binary);
@@ -45,11 +56,23 @@ bool ASM_8080::Run()
             cout << "Listing symbol cross reference" << endl;
             parser.PrintSymbolCrossReference();
         }
+        if (!options.recompileFilePath.empty())
+            Recompile(objectCode);
         if (options.emulate)
         {
             PrettyPrinter<wchar_t> printer(reportStream);
-            std::unique_ptr<ICPUEmulator> emulator = CreateEmulator(parser.GetCPUType(), objectCode, printer);
-            emulator->Run(Options::ShowInstructionResults);
+            if (!options.traceFilePath.empty())
+            {
+                cout << "Writing trace to " << options.traceFilePath << endl;
+                std::ofstream traceStream(options.traceFilePath, std::ios::binary);
+                std::unique_ptr<ICPUEmulator> emulator = CreateEmulator(parser.GetCPUType(), objectCode, printer, &traceStream);
+                emulator->Run(Options::TraceInstructions | Options::ShowFinalResults);
+            }
+            else
+            {
+                std::unique_ptr<ICPUEmulator> emulator = CreateEmulator(parser.GetCPUType(), objectCode, printer);
+                emulator->Run(Options::ShowInstructionResults);
+            }
         }
         return true;
     }
@@ -57,3 +80,109 @@ bool ASM_8080::Run()
 
     return false;
 }
+
+// Assemble every file listed in the batch file, run all of them on a pool of emulators,
+// and print one comma separated line of results per file
+bool ASM_8080::RunBatch()
+{
+    std::ifstream batchStream(options.batchFilePath);
+    std::vector<std::string> inputFilePaths;
+    std::string line;
+    while (std::getline(batchStream, line))
+    {
+        line.erase(line.find_last_not_of(" \t\r") + 1);
+        if (!line.empty())
+            inputFilePaths.push_back(line);
+    }
+
+    std::vector<ObjectCode> images;
+    bool result = true;
+    for (auto const & inputFilePath : inputFilePaths)
+    {
+        Assembler::AssemblerMessages messages;
+        std::ifstream inputStream(inputFilePath);
+        std::string reportingFilePath = Core::Path::StripExtension(inputFilePath) + "-lst.txt";
+        std::wofstream reportStream(reportingFilePath);
+        Assembler::Scanner scanner(&inputStream, true);
+        Assembler::Parser parser("code", scanner, messages, reportStream);
+
+        cout << "Assembling " << inputFilePath << endl;
+        if (!parser.Parse() || (parser.GetCPUType() != CPUType::Intel8080))
+        {
+            cout << "Errors found, please check " << reportingFilePath << endl;
+            result = false;
+            continue;
+        }
+        images.push_back(parser.GetObjectCode());
+    }
+    if (!result)
+        return false;
+
+    BatchRunnerIntel8080 runner(options.jobs);
+    cout << "Emulating " << images.size() << " programs on " << runner.WorkerCount() << " threads" << endl;
+    BatchResultsIntel8080 results = runner.Run(images);
+    cout << "file,result,cycles,pc,sp,a,bc,de,hl,flags,error" << endl;
+    for (auto const & batchResult : results)
+    {
+        RegistersIntel8080 const & registers = batchResult.registers;
+        cout << inputFilePaths[batchResult.index] << ","
+             << (batchResult.Succeeded() ? "halted" : (batchResult.timedOut ? "timeout" : "error")) << ","
+             << batchResult.registers.cycleCountTotal << std::hex << std::uppercase << std::setfill('0') << ","
+             << std::setw(4) << int(registers.pc) << ","
+             << std::setw(4) << int(registers.sp.W) << ","
+             << std::setw(2) << int(registers.a) << ","
+             << std::setw(4) << int(registers.bc.W) << ","
+             << std::setw(4) << int(registers.de.W) << ","
+             << std::setw(4) << int(registers.hl.W) << ","
+             << std::setw(2) << int(registers.flags) << std::dec << ","
+             << batchResult.error << endl;
+        result = result && batchResult.Succeeded();
+    }
+    return result;
+}
+
+// Print a binary trace, or when a second trace is given, the records around the first difference between them
+bool ASM_8080::ShowTrace()
+{
+    std::ifstream traceStream(options.showTraceFilePath, std::ios::binary);
+    TraceRecordsIntel8080 trace = TraceReaderIntel8080::Load(traceStream);
+    if (options.diffTraceFilePath.empty())
+    {
+        TraceReaderIntel8080::Print(cout, trace);
+        return true;
+    }
+
+    static const size_t Context = 8;
+    std::ifstream diffStream(options.diffTraceFilePath, std::ios::binary);
+    TraceRecordsIntel8080 other = TraceReaderIntel8080::Load(diffStream);
+    size_t index = TraceReaderIntel8080::Diff(trace, other);
+    if (index == TraceReaderIntel8080::npos)
+    {
+        cout << "Traces are equal (" << trace.size() << " records)" << endl;
+        return true;
+    }
+    cout << "Traces differ at record " << index << endl;
+    size_t begin = (index > Context) ? index - Context : 0;
+    for (size_t record = begin; record < std::min(trace.size(), index + 1); ++record)
+        TraceReaderIntel8080::Print(cout << "< ", trace[record]);
+    for (size_t record = begin; record < std::min(other.size(), index + 1); ++record)
+        TraceReaderIntel8080::Print(cout << "> ", other[record]);
+    return false;
+}
+
+// Write the program as C++ source for RecompiledProcessorIntel8080, named after the input file
+void ASM_8080::Recompile(Assembler::ObjectCode const & objectCode)
+{
+    std::string name = Core::Path::StripExtension(Core::Path::LastPartOfPath(options.inputFilePath));
+    for (auto & ch : name)
+    {
+        if (!std::isalnum(static_cast<unsigned char>(ch)))
+            ch = '_';
+    }
+    if (name.empty() || std::isdigit(static_cast<unsigned char>(name[0])))
+        name = "_" + name;
+    cout << "Writing recompiled code " << name << " to " << options.recompileFilePath << endl;
+    std::ofstream stream(options.recompileFilePath);
+    RecompilerIntel8080 recompiler(objectCode);
+    recompiler.Generate(stream, name);
+}
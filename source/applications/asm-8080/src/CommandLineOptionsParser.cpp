@@ -15,6 +15,12 @@ CommandLineOptionsParser::CommandLineOptionsParser()
     , listSymbols()
     , listSymbolCrossReferences()
     , emulate()
+    , batchFilePath()
+    , jobs()
+    , traceFilePath()
+    , showTraceFilePath()
+    , diffTraceFilePath()
+    , recompileFilePath()
 {
     Core::CommandLineOptionGroupPtr group = std::make_shared<Core::CommandLineOptionGroup>("Main", "Global options");
     group->AddOptionRequiredArgument("input", 'i', "Input file (required)", &inputFilePath);
@@ -23,11 +29,35 @@ CommandLineOptionsParser::CommandLineOptionsParser()
     group->AddOptionNoArgument("symbols", 's', "Output symbols list to reporting file", &listSymbols);
     group->AddOptionNoArgument("xref", 'x', "Output symbols cross reference to reporting file", &listSymbolCrossReferences);
     group->AddOptionNoArgument("emulate", 'e', "After successful assembling, start emulator", &emulate);
+    group->AddOptionRequiredArgument("batch", 'b', "Assemble and emulate all input files listed in file, one per line", &batchFilePath);
+    group->AddOptionRequiredArgument("jobs", 'j', "Number of emulators running in parallel in batch mode (default = number of cores)", &jobs);
+    group->AddOptionRequiredArgument("trace", 't', "Record a binary trace of every emulated instruction to file", &traceFilePath);
+    group->AddOptionRequiredArgument("showtrace", 'p', "Print the binary trace in file", &showTraceFilePath);
+    group->AddOptionRequiredArgument("difftrace", 'd', "Compare the trace printed with --showtrace to the trace in file", &diffTraceFilePath);
+    group->AddOptionRequiredArgument("recompile", 'c', "After successful assembling, write the program recompiled to C++ to file", &recompileFilePath);
     AddGroup(group);
 }
 
 void CommandLineOptionsParser::ResolveDefaults()
 {
+    if (!showTraceFilePath.empty())
+    {
+        if (!Core::Path::FileExists(showTraceFilePath) || (!diffTraceFilePath.empty() && !Core::Path::FileExists(diffTraceFilePath)))
+        {
+            std::cerr << GetHelp(ApplicationName) << std::endl;
+            throw std::runtime_error("Non-existing trace file specified");
+        }
+        return;
+    }
+    if (!batchFilePath.empty())
+    {
+        if (!Core::Path::FileExists(batchFilePath))
+        {
+            std::cerr << GetHelp(ApplicationName) << std::endl;
+            throw std::runtime_error("Non-existing batch file specified");
+        }
+        return;
+    }
     if (inputFilePath.empty())
     {
         std::cerr << GetHelp(ApplicationName) << std::endl;
@@ -0,0 +1,109 @@
+#pragma once
+
+#include <cstdint>
+#include <functional>
+#include <iostream>
+#include <string>
+#include <vector>
+
+namespace Benchmark
+{
+
+// What one repetition of a case executed, the same for every repetition
+struct RunCounts
+{
+    uint64_t instructions;
+    uint64_t cycles;
+
+    RunCounts()
+        : instructions()
+        , cycles()
+    {}
+};
+
+// One workload on one interpreter engine.
+// run() executes a single repetition, and throws std::runtime_error if the end state is not the one expected.
+struct BenchmarkCase
+{
+    std::string interpreter;
+    std::string engine;
+    std::string workload;
+    double clockFrequency;      // Nominal clock frequency of the emulated processor, in Hz
+    std::function<RunCounts()> run;
+
+    std::string Name() const { return interpreter + "/" + engine + "/" + workload; }
+};
+
+// A workload that an interpreter cannot run, listed in the output so missing results are explained
+struct SkippedCase
+{
+    std::string interpreter;
+    std::string workload;
+    std::string reason;
+};
+
+struct BenchmarkSuite
+{
+    std::vector<BenchmarkCase> cases;
+    std::vector<SkippedCase> skipped;
+
+    void Add(std::string const & interpreter, std::string const & engine, std::string const & workload,
+             double clockFrequency, std::function<RunCounts()> const & run);
+    void Skip(std::string const & interpreter, std::string const & workload, std::string const & reason);
+};
+
+// Wall clock seconds per repetition
+struct TimingStatistics
+{
+    double min;
+    double median;
+    double mean;
+    double max;
+    double stddev;              // Sample standard deviation, 0 for a single repetition
+
+    TimingStatistics()
+        : min()
+        , median()
+        , mean()
+        , max()
+        , stddev()
+    {}
+};
+
+TimingStatistics ComputeStatistics(std::vector<double> samples);
+
+struct BenchmarkResult
+{
+    std::string interpreter;
+    std::string engine;
+    std::string workload;
+    double clockFrequency;
+    RunCounts counts;
+    std::vector<double> samples;
+    TimingStatistics seconds;
+
+    // Rates are based on the median time
+    double MIPS() const;
+    double NanosecondsPerInstruction() const;
+    double EmulatedMHz() const;
+    // Emulated clock frequency relative to the nominal one, > 1 is faster than the real processor
+    double RealTimeFactor() const;
+};
+
+// Runs warmup repetitions untimed (translation caches fill up, the end state is verified), then repetitions timed
+BenchmarkResult RunCase(BenchmarkCase const & benchmarkCase, size_t repetitions, size_t warmup);
+
+void WriteJSON(std::ostream & stream, std::vector<BenchmarkResult> const & results,
+               std::vector<SkippedCase> const & skipped, size_t repetitions, size_t warmup);
+void WriteSummary(std::ostream & stream, std::vector<BenchmarkResult> const & results);
+
+// Cases per interpreter. Each is in a separate translation unit, as the processor and simple-processor components
+// use the same names in namespace Simulate.
+void AddIntel8080Cases(BenchmarkSuite & suite);
+// A CP/M program on every 8080 engine, run with the BDOS emulated. The console output of every engine has to be
+// the one of the reference interpreter, so an instruction exerciser doubles as a conformance test.
+void AddCPMCases(BenchmarkSuite & suite, std::string const & path);
+void AddProcessor8080Cases(BenchmarkSuite & suite);
+void AddSimpleProcessorCases(BenchmarkSuite & suite);
+
+} // namespace Benchmark
@@ -0,0 +1,19 @@
+#pragma once
+
+#include "core/CommandLineParser.h"
+#include "core/CommandLineOptionGroup.h"
+
+class CommandLineOptionsParser : public Core::CommandLineParser
+{
+public:
+    CommandLineOptionsParser();
+
+    uint32_t repetitions;
+    uint32_t warmup;
+    std::string filter;
+    std::string outputFilePath;
+    std::string cpmProgram;
+    bool list;
+
+    void ResolveDefaults();
+};
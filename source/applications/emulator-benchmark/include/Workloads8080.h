@@ -0,0 +1,58 @@
+#pragma once
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+namespace Emulator
+{
+
+struct RecompiledCodeIntel8080;
+
+namespace Recompiled
+{
+
+// Generated at build time from testdata/asm-8080/Multiply3x7.asm by asm-8080 --recompile
+RecompiledCodeIntel8080 const & Multiply3x7();
+
+} // namespace Recompiled
+
+} // namespace Emulator
+
+namespace Benchmark
+{
+
+// Synthetic instruction mix for the 8080 interpreters.
+// As a loop program (BuildLoopProgram8080()) the body runs iterations times with DE as the loop counter, so
+// setup, body and subroutines leave D and E alone. Straight-line workloads have no control transfers in setup and
+// body, and only use instructions Simulate::Processor8080 implements, so they can also run without the loop.
+struct Workload8080
+{
+    std::string name;
+    std::vector<uint8_t> setup;         // Run once before the loop
+    std::vector<uint8_t> body;          // At BodyOrigin
+    std::vector<uint8_t> subroutines;   // At SubroutineOrigin
+    uint16_t iterations;
+    bool straightLine;
+};
+
+// An existing test program, restarted from address 0 until it has run long enough to time
+struct Program8080
+{
+    std::string name;
+    std::vector<uint8_t> code;
+    size_t restarts;
+};
+
+static const uint16_t BodyOrigin = 0x0100;
+static const uint16_t SubroutineOrigin = 0x0200;
+static const uint16_t StackTop = 0x8000;
+
+std::vector<Workload8080> const & GetWorkloads8080();
+std::vector<Program8080> const & GetPrograms8080();
+
+// LXI SP,StackTop / LXI D,iterations / setup / JMP BodyOrigin, the body followed by DCX D / MOV A,D / ORA E /
+// JNZ BodyOrigin / HLT, and the subroutines
+std::vector<uint8_t> BuildLoopProgram8080(Workload8080 const & workload);
+
+} // namespace Benchmark
@@ -0,0 +1,199 @@
+#include "Benchmark.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <iomanip>
+#include <sstream>
+
+namespace Benchmark
+{
+
+void BenchmarkSuite::Add(std::string const & interpreter, std::string const & engine, std::string const & workload,
+                         double clockFrequency, std::function<RunCounts()> const & run)
+{
+    BenchmarkCase benchmarkCase;
+    benchmarkCase.interpreter = interpreter;
+    benchmarkCase.engine = engine;
+    benchmarkCase.workload = workload;
+    benchmarkCase.clockFrequency = clockFrequency;
+    benchmarkCase.run = run;
+    cases.push_back(benchmarkCase);
+}
+
+void BenchmarkSuite::Skip(std::string const & interpreter, std::string const & workload, std::string const & reason)
+{
+    SkippedCase skippedCase;
+    skippedCase.interpreter = interpreter;
+    skippedCase.workload = workload;
+    skippedCase.reason = reason;
+    skipped.push_back(skippedCase);
+}
+
+TimingStatistics ComputeStatistics(std::vector<double> samples)
+{
+    TimingStatistics statistics;
+    if (samples.empty())
+        return statistics;
+    std::sort(samples.begin(), samples.end());
+    size_t count = samples.size();
+    statistics.min = samples.front();
+    statistics.max = samples.back();
+    statistics.median = (count % 2 != 0) ? samples[count / 2] : (samples[count / 2 - 1] + samples[count / 2]) / 2;
+    double sum = 0;
+    for (auto sample : samples)
+        sum += sample;
+    statistics.mean = sum / count;
+    if (count > 1)
+    {
+        double squares = 0;
+        for (auto sample : samples)
+            squares += (sample - statistics.mean) * (sample - statistics.mean);
+        statistics.stddev = std::sqrt(squares / (count - 1));
+    }
+    return statistics;
+}
+
+double BenchmarkResult::MIPS() const
+{
+    return (seconds.median > 0) ? counts.instructions / seconds.median / 1E6 : 0.0;
+}
+
+double BenchmarkResult::NanosecondsPerInstruction() const
+{
+    return (counts.instructions != 0) ? seconds.median * 1E9 / counts.instructions : 0.0;
+}
+
+double BenchmarkResult::EmulatedMHz() const
+{
+    return (seconds.median > 0) ? counts.cycles / seconds.median / 1E6 : 0.0;
+}
+
+double BenchmarkResult::RealTimeFactor() const
+{
+    return (clockFrequency > 0) ? EmulatedMHz() * 1E6 / clockFrequency : 0.0;
+}
+
+BenchmarkResult RunCase(BenchmarkCase const & benchmarkCase, size_t repetitions, size_t warmup)
+{
+    using Clock = std::chrono::steady_clock;
+
+    BenchmarkResult result;
+    result.interpreter = benchmarkCase.interpreter;
+    result.engine = benchmarkCase.engine;
+    result.workload = benchmarkCase.workload;
+    result.clockFrequency = benchmarkCase.clockFrequency;
+    for (size_t repetition = 0; repetition < warmup; ++repetition)
+    {
+        result.counts = benchmarkCase.run();
+    }
+    for (size_t repetition = 0; repetition < repetitions; ++repetition)
+    {
+        Clock::time_point start = Clock::now();
+        result.counts = benchmarkCase.run();
+        result.samples.push_back(std::chrono::duration<double>(Clock::now() - start).count());
+    }
+    result.seconds = ComputeStatistics(result.samples);
+    return result;
+}
+
+static std::string Quote(std::string const & text)
+{
+    std::ostringstream stream;
+    stream << '"';
+    for (auto ch : text)
+    {
+        switch (ch)
+        {
+        case '"':
+            stream << "\\\"";
+            break;
+        case '\\':
+            stream << "\\\\";
+            break;
+        case '\n':
+            stream << "\\n";
+            break;
+        default:
+            if (uint8_t(ch) < 0x20)
+                stream << "\\u" << std::hex << std::setw(4) << std::setfill('0') << int(ch) << std::dec;
+            else
+                stream << ch;
+        }
+    }
+    stream << '"';
+    return stream.str();
+}
+
+void WriteJSON(std::ostream & stream, std::vector<BenchmarkResult> const & results,
+               std::vector<SkippedCase> const & skipped, size_t repetitions, size_t warmup)
+{
+    std::ostringstream json;
+    json << std::setprecision(9);
+    json << "{" << std::endl;
+    json << "  \"repetitions\": " << repetitions << "," << std::endl;
+    json << "  \"warmup\": " << warmup << "," << std::endl;
+    json << "  \"results\": [";
+    for (size_t index = 0; index < results.size(); ++index)
+    {
+        BenchmarkResult const & result = results[index];
+        json << ((index == 0) ? "" : ",") << std::endl;
+        json << "    {" << std::endl;
+        json << "      \"interpreter\": " << Quote(result.interpreter) << "," << std::endl;
+        json << "      \"engine\": " << Quote(result.engine) << "," << std::endl;
+        json << "      \"workload\": " << Quote(result.workload) << "," << std::endl;
+        json << "      \"instructions\": " << result.counts.instructions << "," << std::endl;
+        json << "      \"cycles\": " << result.counts.cycles << "," << std::endl;
+        json << "      \"clockFrequency\": " << result.clockFrequency << "," << std::endl;
+        json << "      \"seconds\": { \"min\": " << result.seconds.min
+             << ", \"median\": " << result.seconds.median
+             << ", \"mean\": " << result.seconds.mean
+             << ", \"max\": " << result.seconds.max
+             << ", \"stddev\": " << result.seconds.stddev << " }," << std::endl;
+        json << "      \"samples\": [";
+        for (size_t sample = 0; sample < result.samples.size(); ++sample)
+        {
+            json << ((sample == 0) ? "" : ", ") << result.samples[sample];
+        }
+        json << "]," << std::endl;
+        json << "      \"mips\": " << result.MIPS() << "," << std::endl;
+        json << "      \"nsPerInstruction\": " << result.NanosecondsPerInstruction() << "," << std::endl;
+        json << "      \"emulatedMHz\": " << result.EmulatedMHz() << "," << std::endl;
+        json << "      \"realTimeFactor\": " << result.RealTimeFactor() << std::endl;
+        json << "    }";
+    }
+    json << std::endl << "  ]," << std::endl;
+    json << "  \"skipped\": [";
+    for (size_t index = 0; index < skipped.size(); ++index)
+    {
+        json << ((index == 0) ? "" : ",") << std::endl;
+        json << "    { \"interpreter\": " << Quote(skipped[index].interpreter)
+             << ", \"workload\": " << Quote(skipped[index].workload)
+             << ", \"reason\": " << Quote(skipped[index].reason) << " }";
+    }
+    json << std::endl << "  ]" << std::endl;
+    json << "}" << std::endl;
+    stream << json.str();
+}
+
+void WriteSummary(std::ostream & stream, std::vector<BenchmarkResult> const & results)
+{
+    std::ostringstream summary;
+    summary << std::left << std::setw(56) << "case" << std::right
+            << std::setw(10) << "MIPS" << std::setw(10) << "ns/instr" << std::setw(10) << "MHz" << std::setw(10) << "stddev" << std::endl;
+    for (auto const & result : results)
+    {
+        double deviation = (result.seconds.median > 0) ? result.seconds.stddev / result.seconds.median * 100 : 0.0;
+        std::ostringstream deviationText;
+        deviationText << std::fixed << std::setprecision(1) << deviation << "%";
+        summary << std::left << std::setw(56) << (result.interpreter + "/" + result.engine + "/" + result.workload) << std::right
+                << std::fixed << std::setprecision(1)
+                << std::setw(10) << result.MIPS()
+                << std::setw(10) << std::setprecision(2) << result.NanosecondsPerInstruction()
+                << std::setw(10) << std::setprecision(1) << result.EmulatedMHz()
+                << std::setw(10) << deviationText.str() << std::endl;
+    }
+    stream << summary.str();
+}
+
+} // namespace Benchmark
@@ -0,0 +1,248 @@
+#include "Benchmark.h"
+
+#include <fstream>
+#include <sstream>
+#include <stdexcept>
+#include "Workloads8080.h"
+#include "core/Path.h"
+#include "emulator/CPMMachineIntel8080.h"
+#include "emulator/CachedProcessorIntel8080.h"
+#include "emulator/CoverageMapIntel8080.h"
+#include "emulator/JitProcessorIntel8080.h"
+#include "emulator/ProfilerIntel8080.h"
+#include "emulator/RecompiledProcessorIntel8080.h"
+#include "emulator/IOPort.h"
+#include "emulator/RAM.h"
+
+using namespace Emulator;
+
+namespace Benchmark
+{
+
+static const std::string Interpreter = "Emulator::ProcessorIntel8080";
+static const double ClockFrequency = 2000000;
+static const size_t IOSize = 256;
+
+using ProcessorPtr = std::shared_ptr<ProcessorIntel8080>;
+
+// All of the address space as RAM, so the workloads can use any address
+template <class Processor>
+static ProcessorPtr CreateProcessor(std::vector<uint8_t> const & code)
+{
+    std::shared_ptr<Processor> processor = std::make_shared<Processor>();
+    MemoryManagerPtr memoryManager = std::make_shared<MemoryManager>();
+    RAMPtr ram = std::make_shared<RAM>(0, MemoryManager::AddressSpaceSize);
+    memoryManager->AddMemory(ram);
+    IOManagerPtr ioManager = std::make_shared<IOManager>();
+    ioManager->AddIO(std::make_shared<IOPort>(0, IOSize));
+    processor->Setup(memoryManager, ioManager);
+    processor->LoadData(code, 0, ram);
+    return processor;
+}
+
+// Programs recompiled to C++ by the build, only these run on the recompiled engine
+static RecompiledCodeIntel8080 const * GetRecompiledCode(std::string const & workload)
+{
+    if (workload == "multiply3x7")
+        return &Recompiled::Multiply3x7();
+    return nullptr;
+}
+
+static ProcessorPtr CreateRecompiledProcessor(std::string const & workload, std::vector<uint8_t> const & code)
+{
+    ProcessorPtr processor = CreateProcessor<RecompiledProcessorIntel8080>(code);
+    RecompiledCodeIntel8080 const & recompiled = *GetRecompiledCode(workload);
+    if (std::static_pointer_cast<RecompiledProcessorIntel8080>(processor)->LoadRecompiledCode(recompiled) != recompiled.blockCount)
+        throw std::runtime_error(workload + ": recompiled code does not match the program");
+    return processor;
+}
+
+static ProcessorPtr CreateProcessor(std::string const & engine, std::vector<uint8_t> const & code)
+{
+    if ((engine == "fast") || (engine == "fast+coverage") || (engine == "fast+profiler"))
+        return CreateProcessor<FastProcessorIntel8080>(code);
+    if (engine == "fast+lazy")
+    {
+        ProcessorPtr processor = CreateProcessor<FastProcessorIntel8080>(code);
+        std::static_pointer_cast<FastProcessorIntel8080>(processor)->SetLazyFlags(true);
+        return processor;
+    }
+    if (engine == "cached")
+        return CreateProcessor<CachedProcessorIntel8080>(code);
+    if (engine == "jit")
+        return CreateProcessor<JitProcessorIntel8080>(code);
+    return CreateProcessor<ProcessorIntel8080>(code);
+}
+
+static void RunProgram(ProcessorIntel8080 & processor, size_t restarts)
+{
+    for (size_t restart = 0; restart < restarts; ++restart)
+    {
+        processor.Reset();
+        processor.GetRegisters().isHalted = false;
+        processor.Run();
+    }
+}
+
+// Counts instructions and cycles with a profiler on the reference interpreter, the timed runs have none attached
+static RunCounts Calibrate(std::vector<uint8_t> const & code, size_t restarts, RegistersIntel8080 & expected)
+{
+    ProcessorPtr processor = CreateProcessor<ProcessorIntel8080>(code);
+    ProfilerIntel8080 profiler;
+    processor->SetProfiler(&profiler);
+    RunProgram(*processor, restarts);
+    processor->SetProfiler(nullptr);
+    expected = processor->GetRegisters();
+
+    RunCounts counts;
+    counts.instructions = profiler.TotalInstructions();
+    counts.cycles = profiler.TotalCycles();
+    return counts;
+}
+
+static void Verify(std::string const & engine, std::string const & workload,
+                   RegistersIntel8080 const & expected, RegistersIntel8080 const & actual)
+{
+    if ((expected.pc != actual.pc) || (expected.sp.W != actual.sp.W) || (expected.bc.W != actual.bc.W) ||
+        (expected.de.W != actual.de.W) || (expected.hl.W != actual.hl.W) || (expected.a != actual.a) ||
+        (expected.flags != actual.flags) || !actual.isHalted)
+    {
+        std::ostringstream message;
+        message << Interpreter << "/" << engine << "/" << workload << ": end state differs from the reference interpreter";
+        throw std::runtime_error(message.str());
+    }
+}
+
+// fast+lazy is the fast engine with lazy flag evaluation (FastProcessorIntel8080::SetLazyFlags()).
+// fast+coverage is the fast engine recording edge coverage, as a fuzzer runs it.
+// fast+profiler is the fast engine with a ProfilerIntel8080 attached.
+// The recompiled engine needs the program translated to C++ at build time, so it only runs those programs.
+static const char * const Engines[] = { "interpreter", "fast", "fast+lazy", "fast+coverage", "fast+profiler", "cached", "jit", "recompiled" };
+
+static void AddCases(BenchmarkSuite & suite, std::string const & workload, std::vector<uint8_t> const & code, size_t restarts)
+{
+    RegistersIntel8080 expected;
+    RunCounts counts = Calibrate(code, restarts, expected);
+    for (auto name : Engines)
+    {
+        std::string engine = name;
+        if ((engine == "recompiled") && (GetRecompiledCode(workload) == nullptr))
+            continue;
+        ProcessorPtr processor = (engine == "recompiled") ? CreateRecompiledProcessor(workload, code) : CreateProcessor(engine, code);
+        std::shared_ptr<CoverageMapIntel8080> coverage;
+        if (engine == "fast+coverage")
+        {
+            coverage = std::make_shared<CoverageMapIntel8080>();
+            processor->SetCoverage(coverage.get());
+        }
+        std::shared_ptr<ProfilerIntel8080> profiler;
+        if (engine == "fast+profiler")
+        {
+            profiler = std::make_shared<ProfilerIntel8080>();
+            processor->SetProfiler(profiler.get());
+        }
+        suite.Add(Interpreter, engine, workload, ClockFrequency, [=]()
+        {
+            if (coverage)
+                coverage->Reset();
+            if (profiler)
+                profiler->Reset();
+            RunProgram(*processor, restarts);
+            Verify(engine, workload, expected, processor->GetRegisters());
+            return counts;
+        });
+    }
+}
+
+void AddIntel8080Cases(BenchmarkSuite & suite)
+{
+    for (auto const & workload : GetWorkloads8080())
+    {
+        AddCases(suite, workload.name, BuildLoopProgram8080(workload), 1);
+    }
+    for (auto const & program : GetPrograms8080())
+    {
+        AddCases(suite, program.name, program.code, program.restarts);
+    }
+}
+
+// The CP/M machine sets up memory and IO of the processor itself
+static ProcessorPtr CreateCPMProcessor(std::string const & engine)
+{
+    if (engine == "fast")
+        return std::make_shared<FastProcessorIntel8080>();
+    if (engine == "fast+lazy")
+    {
+        std::shared_ptr<FastProcessorIntel8080> processor = std::make_shared<FastProcessorIntel8080>();
+        processor->SetLazyFlags(true);
+        return processor;
+    }
+    if (engine == "cached")
+        return std::make_shared<CachedProcessorIntel8080>();
+    if (engine == "jit")
+        return std::make_shared<JitProcessorIntel8080>();
+    return std::make_shared<ProcessorIntel8080>();
+}
+
+struct CPMRun
+{
+    ProcessorPtr processor;
+    std::istringstream input;
+    std::ostringstream output;
+    std::shared_ptr<CPMMachineIntel8080> machine;
+
+    explicit CPMRun(std::string const & engine)
+        : processor(CreateCPMProcessor(engine))
+        , input()
+        , output()
+        , machine()
+    {
+        machine = std::make_shared<CPMMachineIntel8080>(*processor, input, output);
+    }
+
+    std::string Run(std::vector<uint8_t> const & program, std::string const & name)
+    {
+        output.str("");
+        machine->Load(program);
+        if (!machine->Run())
+            throw std::runtime_error(name + ": program did not return to CP/M");
+        return output.str();
+    }
+};
+
+void AddCPMCases(BenchmarkSuite & suite, std::string const & path)
+{
+    std::ifstream file(path, std::ios::binary);
+    if (!file)
+        throw std::runtime_error("Cannot open CP/M program " + path);
+    std::vector<uint8_t> program((std::istreambuf_iterator<char>(file)), std::istreambuf_iterator<char>());
+    std::string workload = "cpm:" + Core::Path::LastPartOfPath(path);
+
+    CPMRun reference("interpreter");
+    ProfilerIntel8080 profiler;
+    reference.processor->SetProfiler(&profiler);
+    std::string expected = reference.Run(program, workload);
+    RunCounts counts;
+    counts.instructions = profiler.TotalInstructions();
+    counts.cycles = profiler.TotalCycles();
+
+    for (auto name : Engines)
+    {
+        std::string engine = name;
+        if ((engine == "fast+coverage") || (engine == "fast+profiler") || (engine == "recompiled"))
+            continue;
+        std::shared_ptr<CPMRun> run = std::make_shared<CPMRun>(engine);
+        suite.Add(Interpreter, engine, workload, ClockFrequency, [=]()
+        {
+            if (run->Run(program, workload) != expected)
+            {
+                std::ostringstream message;
+                message << Interpreter << "/" << engine << "/" << workload << ": console output differs from the reference interpreter";
+                throw std::runtime_error(message.str());
+            }
+            return counts;
+        });
+    }
+}
+
+} // namespace Benchmark
@@ -0,0 +1,101 @@
+#include "Benchmark.h"
+
+#include "Workloads8080.h"
+#include "processor8080.h"
+#include "iomanager.h"
+#include "memorymanager.h"
+#include "ram.h"
+
+using namespace Simulate;
+
+namespace Benchmark
+{
+
+static const std::string Interpreter = "Simulate::Processor8080";
+static const double ClockFrequency = 2000000;
+static const size_t AddressSpaceSize = 0x10000;
+static const int LoopPeriod = 20000;
+static const std::string NotImplemented = "Processor8080 does not implement jumps, calls, returns, compares, rotates or IO";
+
+// Processor8080 has no jumps, so the body is not run as a loop: after the last instruction of the body the run loop
+// moves the program counter back to its start
+class StraightLineRunner
+{
+public:
+    StraightLineRunner(Workload8080 const & workload)
+        : processor(std::make_shared<Processor8080>(ClockFrequency))
+        , bodyStart()
+        , bodyEnd()
+        , iterations(workload.iterations)
+    {
+        std::vector<uint8_t> code = { 0x31, uint8_t(StackTop), uint8_t(StackTop >> 8) };  // LXI SP,StackTop
+        code.insert(code.end(), workload.setup.begin(), workload.setup.end());
+        bodyStart = uint16_t(code.size());
+        code.insert(code.end(), workload.body.begin(), workload.body.end());
+        bodyEnd = uint16_t(code.size());
+
+        RAMPtr ram = std::make_shared<RAM>(0, AddressSpaceSize);
+        for (size_t address = 0; address < code.size(); ++address)
+        {
+            ram->Store8(address, code[address]);
+        }
+        MemoryManagerPtr memory = std::make_shared<MemoryManager>(MemoryVector({ ram }));
+        IOManagerPtr io = std::make_shared<IOManager>(IOVector({}));
+        processor->Setup(memory, io);
+    }
+
+    RunCounts Run()
+    {
+        Registers8080 & registers = static_cast<Registers8080 &>(processor->GetRegisters());
+        processor->Reset();
+        registers.trap = 0xFFFF;
+        registers.trace = false;
+        registers.cycleCountPeriod = LoopPeriod;
+        registers.cycleCount = LoopPeriod;
+        registers.interruptRequest = InterruptFlags8080::None;
+
+        RunCounts counts;
+        uint16_t passes = 0;
+        while (passes < iterations)
+        {
+            processor->RunInstruction();
+            ++counts.instructions;
+            counts.cycles += registers.instructionCycles;
+            if (registers.pc == bodyEnd)
+            {
+                registers.pc = bodyStart;
+                ++passes;
+            }
+        }
+        return counts;
+    }
+
+private:
+    std::shared_ptr<Processor8080> processor;
+    uint16_t bodyStart;
+    uint16_t bodyEnd;
+    uint16_t iterations;
+};
+
+void AddProcessor8080Cases(BenchmarkSuite & suite)
+{
+    for (auto const & workload : GetWorkloads8080())
+    {
+        if (!workload.straightLine)
+        {
+            suite.Skip(Interpreter, workload.name, NotImplemented);
+            continue;
+        }
+        std::shared_ptr<StraightLineRunner> runner = std::make_shared<StraightLineRunner>(workload);
+        suite.Add(Interpreter, "interpreter", workload.name, ClockFrequency, [runner]()
+        {
+            return runner->Run();
+        });
+    }
+    for (auto const & program : GetPrograms8080())
+    {
+        suite.Skip(Interpreter, program.name, NotImplemented);
+    }
+}
+
+} // namespace Benchmark
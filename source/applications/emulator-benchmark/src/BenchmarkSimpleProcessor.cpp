@@ -0,0 +1,292 @@
+#include "Benchmark.h"
+
+#include <memory>
+#include <sstream>
+#include <stdexcept>
+#include "simple-processor/simplemachine.h"
+#include "simple-processor/stringreader.h"
+
+using namespace Simulate;
+
+namespace Benchmark
+{
+
+static const std::string Interpreter = "Simulate::SimpleProcessor";
+static const double ClockFrequency = 1000000;
+
+// The body runs InnerCount times in X, that OuterCount times with the counter in memory at Counter,
+// so the body leaves X alone
+static const uint8_t OuterCount = 250;
+static const uint8_t InnerCount = 200;
+static const uint8_t BodyOrigin = 0x09;
+static const uint8_t SubroutineOrigin = 0xC0;
+static const uint8_t StackTop = 0xE0;
+static const uint8_t Counter = 0xF0;
+
+struct SimpleWorkload
+{
+    std::string name;
+    std::vector<uint8_t> body;          // At BodyOrigin
+    std::vector<uint8_t> subroutines;   // At SubroutineOrigin
+};
+
+struct SimpleProgram
+{
+    std::string name;
+    std::vector<uint8_t> code;
+    std::string input;
+    uint8_t resultAddress;              // Cleared before every restart
+    size_t restarts;
+};
+
+static std::vector<SimpleWorkload> const & GetWorkloads()
+{
+    static const std::vector<SimpleWorkload> workloads =
+    {
+        {
+            "alu",
+            {
+                /* 09       INC        */ 0x05,
+                /* 0A       ADI 03     */ 0x22, 0x03,
+                /* 0C       ACI 05     */ 0x25, 0x05,
+                /* 0E       SBI 07     */ 0x28, 0x07,
+                /* 10       SCI 01     */ 0x2B, 0x01,
+                /* 12       ANI 7F     */ 0x31, 0x7F,
+                /* 14       ORI 10     */ 0x34, 0x10,
+                /* 16       CPI 40     */ 0x2E, 0x40,
+                /* 18       SHL        */ 0x15,
+                /* 19       SHR        */ 0x16,
+                /* 1A       CMC        */ 0x04,
+                /* 1B       DEC        */ 0x06,
+            },
+            {},
+        },
+        {
+            "memory",
+            {
+                /* 09       LDA D0     */ 0x19, 0xD0,
+                /* 0B       ADD D1     */ 0x20, 0xD1,
+                /* 0D       STA D2     */ 0x1E, 0xD2,
+                /* 0F       ADX C0     */ 0x21, 0xC0,
+                /* 11       ADC D2     */ 0x23, 0xD2,
+                /* 13       STA D1     */ 0x1E, 0xD1,
+                /* 15       SUB D0     */ 0x26, 0xD0,
+                /* 17       STA D3     */ 0x1E, 0xD3,
+                /* 19       CMP D3     */ 0x2C, 0xD3,
+                /* 1B       ORA D1     */ 0x32, 0xD1,
+                /* 1D       ANA D2     */ 0x2F, 0xD2,
+                /* 1F       STA D0     */ 0x1E, 0xD0,
+            },
+            {},
+        },
+        {
+            "stack",
+            {
+                /* 09       JSR LEAF   */ 0x3C, 0xC0,
+                /* 0B       PSH        */ 0x13,
+                /* 0C       PSH        */ 0x13,
+                /* 0D       JSR LEAF   */ 0x3C, 0xC0,
+                /* 0F       POP        */ 0x14,
+                /* 10       POP        */ 0x14,
+            },
+            {
+                /* C0 LEAF: PSH        */ 0x13,
+                /* C1       POP        */ 0x14,
+                /* C2       RET        */ 0x17,
+            },
+        },
+        {
+            "branch",
+            {
+                /* 09       LDA D0     */ 0x19, 0xD0,
+                /* 0B       INC        */ 0x05,
+                /* 0C       STA D0     */ 0x1E, 0xD0,
+                /* 0E       ANI 01     */ 0x31, 0x01,
+                /* 10       BZE 13     */ 0x36, 0x13,
+                /* 12       NOP        */ 0x00,
+                /* 13       LDA D0     */ 0x19, 0xD0,
+                /* 15       ANI 02     */ 0x31, 0x02,
+                /* 17       BNZ 1A     */ 0x37, 0x1A,
+                /* 19       NOP        */ 0x00,
+                /* 1A       CLC        */ 0x02,
+                /* 1B       BCC 1E     */ 0x3A, 0x1E,
+                /* 1D       NOP        */ 0x00,
+                /* 1E       BRN 20     */ 0x35, 0x20,
+            },
+            {},
+        },
+        {
+            "io",
+            {
+                /* 09       LDI 41     */ 0x1B, 0x41,
+                /* 0B       OTA        */ 0x12,
+                /* 0C       OTC        */ 0x0F,
+                /* 0D       OTH        */ 0x10,
+                /* 0E       OTA        */ 0x12,
+            },
+            {},
+        },
+    };
+    return workloads;
+}
+
+static std::vector<SimpleProgram> const & GetPrograms()
+{
+    static const std::vector<SimpleProgram> programs =
+    {
+        {
+            // Bit counting program of the simple-processor assembler and emulator tests
+            "bitcount",
+            {
+                /* 00       INI        */ 0x0A,
+                /* 01 LOOP: SHR        */ 0x16,
+                /* 02       BCC EVEN   */ 0x3A, 0x0D,
+                /* 04       STA TEMP   */ 0x1E, 0x13,
+                /* 06       LDA BITS   */ 0x19, 0x14,
+                /* 08       INC        */ 0x05,
+                /* 09       STA BITS   */ 0x1E, 0x14,
+                /* 0B       LDA TEMP   */ 0x19, 0x13,
+                /* 0D EVEN: BNZ LOOP   */ 0x37, 0x01,
+                /* 0F       LDA BITS   */ 0x19, 0x14,
+                /* 11       OTI        */ 0x0E,
+                /* 12       HLT        */ 0x18,
+                /* 13 TEMP             */ 0x00,
+                /* 14 BITS             */ 0x00,
+            },
+            "255",
+            0x14,
+            20000,
+        },
+    };
+    return programs;
+}
+
+// LDI OuterCount / STA Counter / LSI StackTop / OUTER: LDI InnerCount / TAX / body / DEX / BNZ BodyOrigin /
+// LDA Counter / DEC / STA Counter / BNZ OUTER / HLT, and the subroutines
+static std::vector<uint8_t> BuildLoopProgram(SimpleWorkload const & workload)
+{
+    static const uint8_t Outer = 0x06;
+    std::vector<uint8_t> program =
+    {
+        0x1B, OuterCount,       // LDI OuterCount
+        0x1E, Counter,          // STA Counter
+        0x1D, StackTop,         // LSI StackTop
+        0x1B, InnerCount,       // OUTER: LDI InnerCount
+        0x09,                   // TAX
+    };
+    program.insert(program.end(), workload.body.begin(), workload.body.end());
+    program.insert(program.end(),
+    {
+        0x08,                   // DEX
+        0x37, BodyOrigin,       // BNZ BodyOrigin
+        0x19, Counter,          // LDA Counter
+        0x06,                   // DEC
+        0x1E, Counter,          // STA Counter
+        0x37, Outer,            // BNZ OUTER
+        0x18,                   // HLT
+    });
+    if (!workload.subroutines.empty())
+    {
+        program.resize(SubroutineOrigin);
+        program.insert(program.end(), workload.subroutines.begin(), workload.subroutines.end());
+    }
+    return program;
+}
+
+// Discards the output of the IO workload
+class NullWriter : public CharWriter
+{
+public:
+    virtual void ClearContents() override {}
+    virtual void WriteChar(char) override {}
+};
+
+class SimpleRunner
+{
+public:
+    SimpleRunner(std::string const & name, std::vector<uint8_t> const & code, std::string const & input,
+                 int resultAddress, size_t restarts)
+        : name(name)
+        , input(input)
+        , resultAddress(resultAddress)
+        , restarts(restarts)
+        , reader()
+        , writer()
+        , machine(ClockFrequency, code, reader, writer)
+        , counts()
+        , lastCycles()
+    {
+        machine.SetDebugMode(DebugMode::NonRealTime);
+        // Count the instructions with a run loop of our own, the timed runs use Machine::Run()
+        for (size_t restart = 0; restart < restarts; ++restart)
+        {
+            Prepare();
+            machine.Reset();
+            while (!machine.IsHalted())
+            {
+                machine.FetchAndExecute();
+                ++counts.instructions;
+            }
+            counts.cycles += machine.GetRegisters().totalClockCount;
+        }
+        lastCycles = machine.GetRegisters().totalClockCount;
+    }
+
+    RunCounts Run()
+    {
+        for (size_t restart = 0; restart < restarts; ++restart)
+        {
+            Prepare();
+            machine.Run();
+        }
+        if (!machine.IsHalted() || (machine.GetRegisters().totalClockCount != lastCycles))
+        {
+            std::ostringstream message;
+            message << Interpreter << "/interpreter/" << name << ": end state differs from the calibration run";
+            throw std::runtime_error(message.str());
+        }
+        return counts;
+    }
+
+private:
+    std::string name;
+    std::string input;
+    int resultAddress;
+    size_t restarts;
+    StringReader reader;
+    NullWriter writer;
+    SimpleMachine machine;
+    RunCounts counts;
+    ClockCount lastCycles;
+
+    void Prepare()
+    {
+        reader.SetContents(input);
+        if (resultAddress >= 0)
+            machine.Store(uint8_t(resultAddress), 0);
+    }
+};
+
+void AddSimpleProcessorCases(BenchmarkSuite & suite)
+{
+    for (auto const & workload : GetWorkloads())
+    {
+        std::shared_ptr<SimpleRunner> runner = std::make_shared<SimpleRunner>(workload.name, BuildLoopProgram(workload), "", -1, 1);
+        suite.Add(Interpreter, "interpreter", workload.name, ClockFrequency, [runner]()
+        {
+            return runner->Run();
+        });
+    }
+    suite.Skip(Interpreter, "daa", "SimpleProcessor has no BCD instructions");
+    for (auto const & program : GetPrograms())
+    {
+        std::shared_ptr<SimpleRunner> runner = std::make_shared<SimpleRunner>(program.name, program.code, program.input,
+                                                                              program.resultAddress, program.restarts);
+        suite.Add(Interpreter, "interpreter", program.name, ClockFrequency, [runner]()
+        {
+            return runner->Run();
+        });
+    }
+}
+
+} // namespace Benchmark
@@ -0,0 +1,29 @@
+#include "CommandLineOptionsParser.h"
+
+static const uint32_t DefaultRepetitions = 10;
+
+CommandLineOptionsParser::CommandLineOptionsParser()
+    : repetitions()
+    , warmup(1)
+    , filter()
+    , outputFilePath()
+    , cpmProgram()
+    , list()
+{
+    Core::CommandLineOptionGroupPtr group = std::make_shared<Core::CommandLineOptionGroup>("Main", "Global options");
+    group->AddOptionRequiredArgument("repetitions", 'n', "Number of timed repetitions of every case (default = 10)", &repetitions);
+    group->AddOptionRequiredArgument("warmup", 'w', "Number of untimed repetitions before timing (default = 1)", &warmup);
+    group->AddOptionRequiredArgument("filter", 'f', "Only run cases with interpreter/engine/workload containing this text", &filter);
+    group->AddOptionRequiredArgument("output", 'o', "Write the JSON results to file (default = standard output)", &outputFilePath);
+    group->AddOptionRequiredArgument("cpm", 'c', "Also run this CP/M .COM program, e.g. an instruction exerciser, on every engine", &cpmProgram);
+    group->AddOptionNoArgument("list", 'l', "List the cases without running them", &list);
+    AddGroup(group);
+}
+
+void CommandLineOptionsParser::ResolveDefaults()
+{
+    if (repetitions == 0)
+    {
+        repetitions = DefaultRepetitions;
+    }
+}
@@ -0,0 +1,226 @@
+#include "Workloads8080.h"
+
+#include "emulator/RecompiledProcessorIntel8080.h"
+
+namespace Benchmark
+{
+
+std::vector<Workload8080> const & GetWorkloads8080()
+{
+    static const std::vector<Workload8080> workloads =
+    {
+        {
+            "alu",
+            {
+                0x01, 0x34, 0x12,   // LXI B,1234
+                0x21, 0x78, 0x56,   // LXI H,5678
+            },
+            {
+                0x04,               // 0100 INR B
+                0x80,               // 0101 ADD B
+                0x89,               // 0102 ADC C
+                0x94,               // 0103 SUB H
+                0x9D,               // 0104 SBB L
+                0xA0,               // 0105 ANA B
+                0xA9,               // 0106 XRA C
+                0xB4,               // 0107 ORA H
+                0x0C,               // 0108 INR C
+                0x25,               // 0109 DCR H
+                0xC6, 0x11,         // 010A ADI 11
+                0xCE, 0x22,         // 010C ACI 22
+                0xD6, 0x33,         // 010E SUI 33
+                0xE6, 0x7F,         // 0110 ANI 7F
+                0xEE, 0x55,         // 0112 XRI 55
+                0xF6, 0x01,         // 0114 ORI 01
+            },
+            {},
+            50000,
+            true,
+        },
+        {
+            "memory",
+            {
+                0x21, 0x00, 0x40,   // LXI H,4000
+            },
+            {
+                0x77,               // 0100 MOV M,A
+                0x46,               // 0101 MOV B,M
+                0x34,               // 0102 INR M
+                0x4E,               // 0103 MOV C,M
+                0x35,               // 0104 DCR M
+                0x70,               // 0105 MOV M,B
+                0x7E,               // 0106 MOV A,M
+                0x86,               // 0107 ADD M
+                0x36, 0x5A,         // 0108 MVI M,5A
+                0x96,               // 010A SUB M
+                0x71,               // 010B MOV M,C
+                0x32, 0x00, 0x50,   // 010C STA 5000
+                0x3A, 0x00, 0x50,   // 010F LDA 5000
+                0x2C,               // 0112 INR L
+            },
+            {},
+            50000,
+            true,
+        },
+        {
+            "stack",
+            {
+                0x01, 0x00, 0x00,   // LXI B,0000
+                0x21, 0x00, 0x00,   // LXI H,0000
+            },
+            {
+                0xCD, 0x00, 0x02,   // 0100 CALL LEAF
+                0xC5,               // 0103 PUSH B
+                0xE5,               // 0104 PUSH H
+                0xCD, 0x00, 0x02,   // 0105 CALL LEAF
+                0xE1,               // 0108 POP H
+                0xC1,               // 0109 POP B
+                0xCD, 0x03, 0x02,   // 010A CALL NESTED
+            },
+            {
+                0xF5,               // 0200 LEAF: PUSH PSW
+                0xF1,               // 0201 POP PSW
+                0xC9,               // 0202 RET
+                0xCD, 0x00, 0x02,   // 0203 NESTED: CALL LEAF
+                0xC9,               // 0206 RET
+            },
+            50000,
+            false,
+        },
+        {
+            "daa",
+            {
+                0x01, 0x00, 0x00,   // LXI B,0000
+            },
+            {
+                0x78,               // 0100 MOV A,B
+                0xC6, 0x01,         // 0101 ADI 01
+                0x27,               // 0103 DAA
+                0x47,               // 0104 MOV B,A
+                0x79,               // 0105 MOV A,C
+                0xCE, 0x00,         // 0106 ACI 00
+                0x27,               // 0108 DAA
+                0x4F,               // 0109 MOV C,A
+                0x80,               // 010A ADD B
+                0x27,               // 010B DAA
+                0x89,               // 010C ADC C
+                0x27,               // 010D DAA
+            },
+            {},
+            50000,
+            true,
+        },
+        {
+            "branch",
+            {
+                0x01, 0x00, 0x00,   // LXI B,0000
+            },
+            {
+                0x04,               // 0100 INR B
+                0x78,               // 0101 MOV A,B
+                0xE6, 0x01,         // 0102 ANI 01
+                0xCA, 0x08, 0x01,   // 0104 JZ 0108
+                0x0C,               // 0107 INR C
+                0x78,               // 0108 MOV A,B
+                0xE6, 0x02,         // 0109 ANI 02
+                0xC2, 0x0F, 0x01,   // 010B JNZ 010F
+                0x0D,               // 010E DCR C
+                0x79,               // 010F MOV A,C
+                0xFE, 0x80,         // 0110 CPI 80
+                0xDA, 0x16, 0x01,   // 0112 JC 0116
+                0x00,               // 0115 NOP
+                0xB7,               // 0116 ORA A
+                0xF2, 0x1B, 0x01,   // 0117 JP 011B
+                0x37,               // 011A STC
+                0xEA, 0x1F, 0x01,   // 011B JPE 011F
+                0x3F,               // 011E CMC
+                0xC3, 0x22, 0x01,   // 011F JMP 0122
+            },
+            {},
+            50000,
+            false,
+        },
+        {
+            "io",
+            {},
+            {
+                0xDB, 0x10,         // 0100 IN 10
+                0xD3, 0x11,         // 0102 OUT 11
+                0xDB, 0x11,         // 0104 IN 11
+                0x80,               // 0106 ADD B
+                0xD3, 0x12,         // 0107 OUT 12
+                0x47,               // 0109 MOV B,A
+                0xDB, 0x12,         // 010A IN 12
+                0xD3, 0x10,         // 010C OUT 10
+            },
+            {},
+            50000,
+            false,
+        },
+    };
+    return workloads;
+}
+
+static std::vector<uint8_t> RecompiledImage(Emulator::RecompiledCodeIntel8080 const & code)
+{
+    return std::vector<uint8_t>(code.image, code.image + code.imageSize);
+}
+
+std::vector<Program8080> const & GetPrograms8080()
+{
+    static const std::vector<Program8080> programs =
+    {
+        {
+            // The image the recompiled engine was generated from, so all engines run the same code
+            "multiply3x7",
+            RecompiledImage(Emulator::Recompiled::Multiply3x7()),
+            20000,
+        },
+        {
+            // Counting loop of the breakpoint manager tests
+            "countloop",
+            {
+                0x31, 0x00, 0x08,   // 0000 LXI SP,0800
+                0x06, 0x00,         // 0003 MVI B,00
+                0x04,               // 0005 LOOP: INR B
+                0x78,               // 0006 MOV A,B
+                0x32, 0x00, 0x04,   // 0007 STA 0400
+                0xFE, 0x05,         // 000A CPI 05
+                0xC2, 0x05, 0x00,   // 000C JNZ LOOP
+                0x3A, 0x00, 0x04,   // 000F LDA 0400
+                0x76,               // 0012 HLT
+            },
+            40000,
+        },
+    };
+    return programs;
+}
+
+std::vector<uint8_t> BuildLoopProgram8080(Workload8080 const & workload)
+{
+    std::vector<uint8_t> program =
+    {
+        0x31, uint8_t(StackTop), uint8_t(StackTop >> 8),                        // LXI SP,StackTop
+        0x11, uint8_t(workload.iterations), uint8_t(workload.iterations >> 8),  // LXI D,iterations
+    };
+    program.insert(program.end(), workload.setup.begin(), workload.setup.end());
+    program.insert(program.end(), { 0xC3, uint8_t(BodyOrigin), uint8_t(BodyOrigin >> 8) });    // JMP BodyOrigin
+    program.resize(BodyOrigin);
+    program.insert(program.end(), workload.body.begin(), workload.body.end());
+    program.insert(program.end(),
+    {
+        0x1B,                                                   // DCX D
+        0x7A,                                                   // MOV A,D
+        0xB3,                                                   // ORA E
+        0xC2, uint8_t(BodyOrigin), uint8_t(BodyOrigin >> 8),    // JNZ BodyOrigin
+        0x76,                                                   // HLT
+    });
+    if (!workload.subroutines.empty())
+    {
+        program.resize(SubroutineOrigin);
+        program.insert(program.end(), workload.subroutines.begin(), workload.subroutines.end());
+    }
+    return program;
+}
+
+} // namespace Benchmark
@@ -0,0 +1,64 @@
+#include <fstream>
+#include <iostream>
+#include <stdexcept>
+#include <CommandLineOptionsParser.h>
+#include <Benchmark.h>
+
+using namespace std;
+using namespace Benchmark;
+
+// Results go to standard output as JSON (or to the --output file), progress and the summary to standard error
+int main(int argc, char * argv[])
+{
+    cerr << "8080 emulator benchmark (C) Barsoft 2016" << endl << endl;
+    CommandLineOptionsParser commandLineParser;
+
+    commandLineParser.Parse(argc, argv);
+    commandLineParser.ResolveDefaults();
+
+    try
+    {
+        BenchmarkSuite suite;
+        AddIntel8080Cases(suite);
+        if (!commandLineParser.cpmProgram.empty())
+            AddCPMCases(suite, commandLineParser.cpmProgram);
+        AddProcessor8080Cases(suite);
+        AddSimpleProcessorCases(suite);
+
+        vector<BenchmarkResult> results;
+        for (auto const & benchmarkCase : suite.cases)
+        {
+            if (benchmarkCase.Name().find(commandLineParser.filter) == string::npos)
+                continue;
+            if (commandLineParser.list)
+            {
+                cout << benchmarkCase.Name() << endl;
+                continue;
+            }
+            cerr << benchmarkCase.Name() << endl;
+            results.push_back(RunCase(benchmarkCase, commandLineParser.repetitions, commandLineParser.warmup));
+        }
+        if (commandLineParser.list)
+            return 0;
+
+        cerr << endl;
+        WriteSummary(cerr, results);
+        if (commandLineParser.outputFilePath.empty())
+        {
+            WriteJSON(cout, results, suite.skipped, commandLineParser.repetitions, commandLineParser.warmup);
+        }
+        else
+        {
+            ofstream stream(commandLineParser.outputFilePath);
+            if (!stream)
+                throw runtime_error("Cannot open output file " + commandLineParser.outputFilePath);
+            WriteJSON(stream, results, suite.skipped, commandLineParser.repetitions, commandLineParser.warmup);
+        }
+    }
+    catch (exception const & e)
+    {
+        cerr << "Benchmark failed: " << e.what() << endl;
+        return 1;
+    }
+    return 0;
+}
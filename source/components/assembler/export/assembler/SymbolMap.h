@@ -27,6 +27,14 @@ public:
     {
         return map.end();
     }
+    ConstIterator begin() const
+    {
+        return map.begin();
+    }
+    ConstIterator end() const
+    {
+        return map.end();
+    }
 
     void Add(std::wstring const & name, Value val)
     {
@@ -43,13 +51,13 @@ public:
 
     bool Exists(std::wstring const & name) const
     {
-        Map::const_iterator it = map.find(Core::String::ToUpper(name));
+        typename Map::const_iterator it = map.find(Core::String::ToUpper(name));
         return (it != map.end());
     }
 
 	Value const & Lookup(std::wstring const & name) const
     {
-        Map::const_iterator it = map.find(Core::String::ToUpper(name));
+        typename Map::const_iterator it = map.find(Core::String::ToUpper(name));
         if (it != map.end())
         {
             return it->second;
@@ -60,7 +68,7 @@ public:
 	}
 	Value & Lookup(std::wstring const & name)
     {
-        Map::iterator it = map.find(Core::String::ToUpper(name));
+        typename Map::iterator it = map.find(Core::String::ToUpper(name));
         if (it != map.end())
         {
             return it->second;
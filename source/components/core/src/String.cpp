@@ -201,7 +201,7 @@ std::string ToString(std::wstring const & str)
             delete[] tp;
             throw std::runtime_error("Invalid size written");
         }
-        std::string ret(tp);
+        std::string ret(tp, w);
         delete[] tp;
         return ret;
     #endif
@@ -0,0 +1,83 @@
+#pragma once
+
+#include <memory>
+#include <string>
+#include <vector>
+#include "assembler/ObjectCode.h"
+#include "emulator/FastProcessorIntel8080.h"
+#include "emulator/RAM.h"
+#include "emulator/IOPort.h"
+
+namespace Emulator
+{
+
+// Outcome of running a single image of a batch
+struct BatchResultIntel8080
+{
+    size_t index;                   // Index of the image in the batch
+    bool halted;                    // Ran up to a HLT instruction
+    bool timedOut;                  // Stopped at the cycle limit without halting
+    std::string error;              // Message of the exception stopping the run, if any
+    RegistersIntel8080 registers;   // Registers at the end of the run, cycleCountTotal holds the cycles executed
+
+    BatchResultIntel8080()
+        : index()
+        , halted()
+        , timedOut()
+        , error()
+        , registers()
+    {}
+    bool Succeeded() const { return halted && error.empty(); }
+};
+
+using BatchResultsIntel8080 = std::vector<BatchResultIntel8080>;
+
+// A single Intel 8080 machine which runs one image after another.
+// The memory layout is the one used by CPUEmulatorIntel8080: the ASEG segment in ROM, and RAM from the end
+// of the segment up to the end of the address space, and a single 256 byte IO port block.
+// Memory blocks are kept as long as consecutive images have the same ASEG offset and size, and are cleared
+// before every run.
+// Images run with FastProcessorIntel8080::Run(budget), so a run stops at the first instruction boundary at or after
+// the cycle limit.
+class BatchInstanceIntel8080
+{
+public:
+    BatchInstanceIntel8080();
+    virtual ~BatchInstanceIntel8080();
+
+    BatchResultIntel8080 Run(Assembler::ObjectCode const & objectCode, size_t maxCycles);
+
+private:
+    FastProcessorIntel8080 processor;
+    MemoryManagerPtr memoryManager;
+    ROMPtr rom;
+    RAMPtr ram;
+    IOManagerPtr ioManager;
+    IOPortPtr ioPort;
+
+    void SetupMemory(size_t codeOffset, size_t codeSize);
+};
+
+// Runs a batch of independent images on a pool of worker threads.
+// Every worker owns a BatchInstanceIntel8080, and takes the next image from the batch as soon as it is done
+// with the previous one. The instances are kept between calls to Run().
+class BatchRunnerIntel8080
+{
+public:
+    static const size_t DefaultMaxCycles = 100000000;
+
+    // A worker count of 0 selects one worker per hardware thread
+    BatchRunnerIntel8080(size_t workerCount = 0, size_t maxCycles = DefaultMaxCycles);
+    virtual ~BatchRunnerIntel8080();
+
+    size_t WorkerCount() const { return instances.size(); }
+    size_t MaxCycles() const { return maxCycles; }
+
+    BatchResultsIntel8080 Run(std::vector<Assembler::ObjectCode> const & images);
+
+private:
+    size_t maxCycles;
+    std::vector<std::unique_ptr<BatchInstanceIntel8080>> instances;
+};
+
+} // namespace Emulator
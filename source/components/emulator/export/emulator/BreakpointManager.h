@@ -0,0 +1,98 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <exception>
+#include <map>
+#include <set>
+#include "emulator/MemoryManager.h"
+
+namespace Emulator
+{
+
+// Thrown from an instruction fetch to stop the processor before the instruction runs.
+// The run loops catch it and return with pc at the instruction that was stopped at.
+class ExecutionBreak : public std::exception
+{
+public:
+    explicit ExecutionBreak(size_t address)
+        : address(address)
+    {}
+
+    char const * what() const noexcept override { return "Execution break"; }
+
+    size_t address;
+};
+
+using WatchpointID = size_t;
+
+// Stop on a read or write in [begin, end] (inclusive) of a value in [valueLow, valueHigh] (inclusive)
+struct Watchpoint
+{
+    size_t begin;
+    size_t end;
+    MemoryAccess access;
+    uint8_t valueLow;
+    uint8_t valueHigh;
+};
+
+struct BreakpointStop
+{
+    size_t pc;                  // Instruction that was stopped at
+    size_t address;             // Address accessed, pc for a breakpoint
+    MemoryAccess access;        // Execute for a breakpoint, Read or Write for a watchpoint
+    uint8_t data;               // Value read or written
+    WatchpointID watchpoint;    // Watchpoint hit, only valid if access is Read or Write
+};
+
+// Breakpoints and watchpoints using the page traps of a MemoryManager.
+// Only pages holding a breakpoint or watched address take the slow path of MemoryManager, the exact address
+// and value matching is done there. Untrapped pages run at full speed, so any number of breakpoints can be set.
+//
+// A breakpoint stops before the instruction at its address runs. A watchpoint stops after the instruction
+// accessing memory completed, before the next instruction runs: for this all pages trap execution for one instruction.
+// Running again from the stop address continues past it, without stopping there again.
+//
+// Engines that run translated code (CachedProcessorIntel8080, RecompiledProcessorIntel8080, JitProcessorIntel8080)
+// use the handlers of FastProcessorIntel8080 while any page has traps.
+class BreakpointManager
+{
+public:
+    explicit BreakpointManager(MemoryManagerPtr memoryManager);
+    virtual ~BreakpointManager();
+
+    void AddBreakpoint(size_t address);
+    // Returns false if no breakpoint is set at address
+    bool RemoveBreakpoint(size_t address);
+    bool HasBreakpoint(size_t address) const { return breakpoints.find(address) != breakpoints.end(); }
+    size_t BreakpointCount() const { return breakpoints.size(); }
+
+    WatchpointID AddWatchpoint(size_t begin, size_t end, MemoryAccess access, uint8_t valueLow = 0x00, uint8_t valueHigh = 0xFF);
+    // Returns false if the watchpoint does not exist
+    bool RemoveWatchpoint(WatchpointID id);
+    size_t WatchpointCount() const { return watchpoints.size(); }
+
+    // Remove all breakpoints and watchpoints
+    void Clear();
+
+    bool HasStopped() const { return stopped; }
+    BreakpointStop const & GetStop() const { return stop; }
+    void ClearStop();
+
+private:
+    MemoryManagerPtr memoryManager;
+    std::set<size_t> breakpoints;
+    std::map<WatchpointID, Watchpoint> watchpoints;
+    WatchpointID nextID;
+    BreakpointStop stop;
+    bool stopped;
+    bool stopPending;           // Watchpoint hit, stop at the next instruction fetch
+    bool resuming;              // Do not stop at resumeAddress on its next execution
+    size_t resumeAddress;
+
+    void OnAccess(size_t address, MemoryAccess access, uint8_t data);
+    void Stop(size_t pc);
+    void UpdateTraps();
+};
+
+} // namespace Emulator
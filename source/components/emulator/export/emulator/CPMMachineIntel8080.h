@@ -0,0 +1,153 @@
+#pragma once
+
+#include <fstream>
+#include <iostream>
+#include <limits>
+#include <map>
+#include <memory>
+#include <string>
+#include <vector>
+#include "emulator/ProcessorIntel8080.h"
+#include "emulator/RAM.h"
+
+namespace Emulator
+{
+
+// Runs CP/M-80 .COM programs on a processor, with the BDOS and BIOS emulated on the host (high level emulation).
+// The whole address space is RAM, laid out as CP/M 2.2 does: the jump to the BIOS warm boot at 0000,
+// the jump to the BDOS at 0005, the program at 0100 up to BDOSBase, and the BIOS jump vector at BIOSBase.
+// The BDOS entry and all BIOS entries are stubs of OUT port / RET, with the port selecting the function, so every call
+// is serviced by the IO device of the machine in a single instruction, and the processor runs at full speed in between.
+//
+// Drives A: to P: are host directories, file names are matched case insensitively, and new files get upper case names.
+// Files are host streams kept open from the first access until the program closes them or exits.
+// The names of the files of a drive are listed once and kept until a disk reset, so files added on the host
+// while a program runs show up after BDOS function 13 or 37, as they do on a real CP/M system.
+// Supported BDOS functions: 0 - 40, in the way CP/M 2.2 does them, with the file system functions working on the host files
+// rather than on a directory and allocation blocks. Search returns a single directory entry for every file, holding its last extent.
+// The BIOS character functions are supported, the BIOS disk functions report that there is no disk.
+//
+// The program returns to CP/M with BDOS function 0, a jump to 0000 or a return from its main routine,
+// which stops the processor as a HLT would. Console input is read from a stream, and echoed to the output as CP/M does.
+class CPMMachineIntel8080
+{
+public:
+    static const uint16_t TPA = 0x0100;
+    static const uint16_t DefaultFCB = 0x005C;
+    static const uint16_t DefaultDMA = 0x0080;
+    static const uint16_t BDOSBase = 0xFE00;        // Top of the TPA, the address at 0006 is BDOSBase + 6
+    static const uint16_t BIOSBase = 0xFF00;
+    static const uint8_t BIOSPortBase = 0xE0;       // BIOS function n traps through port BIOSPortBase + n
+    static const uint8_t BDOSPort = 0xFF;
+    static const size_t BIOSFunctionCount = 17;
+    static const size_t DriveCount = 16;
+    static const size_t RecordSize = 128;
+
+    CPMMachineIntel8080(ProcessorIntel8080 & processor, std::istream & input, std::ostream & output);
+    virtual ~CPMMachineIntel8080();
+
+    // drive 0 is A:, an empty directory unmaps the drive
+    void SetDrive(size_t drive, std::string const & directory);
+    std::string const & GetDrive(size_t drive) const { return drives[drive]; }
+
+    // Set up memory and registers to run a program from 0100. The command tail is what follows the program name
+    // on the command line, its first two arguments are parsed into the default FCBs at 005C and 006C.
+    void Load(std::vector<uint8_t> const & program, std::string const & commandTail = "");
+    // Same for a host file
+    void LoadFile(std::string const & path, std::string const & commandTail = "");
+
+    // Run until the program returns to CP/M or halts, or at least budget cycles are spent.
+    // Returns true if the program returned to CP/M.
+    bool Run(size_t budget = std::numeric_limits<size_t>::max());
+    bool HasExited() const { return exited; }
+
+    ProcessorIntel8080 & GetProcessor() { return processor; }
+    RAMPtr GetRAM() const { return ram; }
+    size_t BDOSCallCount() const { return bdosCalls; }
+
+private:
+    class TrapDevice;
+    // Open host file. The record functions keep track of its size and stream position,
+    // so sequential access neither asks the host for the size nor seeks.
+    struct FileState
+    {
+        std::fstream stream;
+        size_t size;
+        size_t position;        // npos after a failed write, the next access seeks
+        bool writing;           // Switching between reading and writing needs a seek in between
+
+        FileState()
+            : stream()
+            , size()
+            , position()
+            , writing()
+        {}
+    };
+    using FilePtr = std::shared_ptr<FileState>;
+    // Host files of a drive with names fitting in 8.3, as 11 character upper case FCB names, with their host names
+    using DriveEntries = std::map<std::string, std::string>;
+
+    ProcessorIntel8080 & processor;
+    std::istream & input;
+    std::ostream & output;
+    MemoryManagerPtr memoryManager;
+    RAMPtr ram;
+    std::vector<std::string> drives;
+    std::map<std::string, FilePtr> files;   // Open files by drive letter and FCB name
+    mutable std::vector<DriveEntries> driveEntries;
+    mutable std::vector<bool> driveListed;
+    bool exited;
+    size_t bdosCalls;
+    uint8_t currentDrive;
+    uint8_t userNumber;
+    uint16_t dma;
+    std::vector<std::vector<uint8_t>> searchEntries;    // Directory entries left for search next
+    size_t searchIndex;
+
+    void SetupMemory();
+    void Exit();
+    void BDOS();
+    void BIOS(size_t function);
+
+    uint8_t Fetch8(uint16_t address) const { return memoryManager->Fetch8(address); }
+    void Store8(uint16_t address, uint8_t data) { memoryManager->Store8(address, data); }
+
+    // Console
+    int ReadConsole();
+    bool ConsoleReady();
+    void WriteConsole(uint8_t data);
+    void PrintString(uint16_t address);
+    void ReadConsoleBuffer(uint16_t address);
+
+    // Files, fcb is the address of a file control block
+    bool IsDriveMapped(size_t drive) const { return (drive < DriveCount) && !drives[drive].empty(); }
+    size_t FCBDrive(uint16_t fcb) const;
+    std::string FCBName(uint16_t fcb) const;
+    std::string HostPath(uint16_t fcb) const;
+    bool HostFileExists(uint16_t fcb) const;
+    FilePtr GetFile(uint16_t fcb, bool create);
+    void CloseFile(std::string const & key);
+    static size_t FileRecords(FileState const & file);
+    static void SeekFile(FileState & file, size_t position, bool writing);
+    void SetExtentRecordCount(uint16_t fcb, size_t records);
+    size_t SequentialRecord(uint16_t fcb) const;
+    void SetSequentialRecord(uint16_t fcb, size_t record);
+    uint8_t ReadRecord(uint16_t fcb, size_t record);
+    uint8_t WriteRecord(uint16_t fcb, size_t record);
+    uint8_t OpenFile(uint16_t fcb);
+    uint8_t MakeFile(uint16_t fcb);
+    uint8_t DeleteFiles(uint16_t fcb);
+    uint8_t RenameFile(uint16_t fcb);
+    uint8_t Search(uint16_t fcb);
+    uint8_t SearchNext();
+    uint8_t ReadRandom(uint16_t fcb);
+    uint8_t WriteRandom(uint16_t fcb);
+    void ComputeFileSize(uint16_t fcb);
+    bool RandomRecord(uint16_t fcb, size_t & record) const;
+    void SetRandomRecord(uint16_t fcb, size_t record);
+    DriveEntries & GetDriveEntries(size_t drive) const;
+    void ResetDriveEntries();
+    DriveEntries ListDrive(size_t drive) const;
+}; // CPMMachineIntel8080
+
+} // namespace Emulator
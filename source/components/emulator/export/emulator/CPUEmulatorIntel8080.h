@@ -2,6 +2,7 @@
 
 #include "assembler/ObjectCode.h"
 #include "assembler/PrettyPrinter.h"
+#include <memory>
 #include "emulator/ICPUEmulator.h"
 #include "emulator/ProcessorIntel8080.h"
 
@@ -11,7 +12,9 @@ namespace Emulator
 class CPUEmulatorIntel8080 : public ICPUEmulator
 {
 public:
-    CPUEmulatorIntel8080(Assembler::ObjectCode const & objectCode, Assembler::PrettyPrinter<wchar_t> & printer);
+    // processor selects the variant and engine, by default the reference 8080 interpreter
+    CPUEmulatorIntel8080(Assembler::ObjectCode const & objectCode, Assembler::PrettyPrinter<wchar_t> & printer, std::ostream * traceStream = nullptr,
+                         std::shared_ptr<ProcessorIntel8080> processor = nullptr);
     virtual ~CPUEmulatorIntel8080();
 
 	bool Run(Options options) override;
@@ -19,7 +22,8 @@ public:
 private:
     Assembler::ObjectCode const & objectCode;
     Assembler::PrettyPrinter<wchar_t> & printer;
-    ProcessorIntel8080 processor;
+    std::ostream * traceStream;
+    std::shared_ptr<ProcessorIntel8080> processor;
 
     bool OnCallback(RegistersIntel8080 const &);
     void PrintRegisterValues(RegistersIntel8080 const & registers);
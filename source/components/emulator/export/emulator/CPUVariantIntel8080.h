@@ -0,0 +1,62 @@
+#pragma once
+
+#include <cstdint>
+#include "assembler/CPUType.h"
+
+namespace Emulator
+{
+
+// Compile time description of a member of the 8080 family, the policy the handlers of FastProcessorIntel8080 are
+// instantiated with. Every difference between the variants is a constant here, so each variant gets its own handler
+// table (FastProcessorIntel8080 for the 8080, ProcessorIntel8085 for the 8085) and nothing tests the variant while running.
+struct CPUVariantIntel8080
+{
+    static const Assembler::CPUType Type = Assembler::CPUType::Intel8080;
+    // RIM, SIM and the undocumented 8085 instructions DSUB, ARHL, RDEL, LDHI, LDSP, RSTV, SHLX, JNK, LHLX and JK
+    static const bool ExtendedInstructions = false;
+    // The 8085 V (overflow) and K flags, and AuxCarry set by ANA / ANI
+    static const bool ExtendedFlags = false;
+    // PUSH PSW pushes (flags & PSWMask) | PSWSet
+    static const uint8_t PSWMask = 0xD7;
+    static const uint8_t PSWSet = 0x02;
+
+    // Machine states of the instructions timed differently by the variants
+    static const uint8_t CyclesMOVRegister = 5;     // MOV r,r
+    static const uint8_t CyclesINRRegister = 5;     // INR r, DCR r
+    static const uint8_t CyclesINX = 5;             // INX, DCX
+    static const uint8_t CyclesJccNotTaken = 10;
+    static const uint8_t CyclesCALL = 17;           // CALL, Ccc taken
+    static const uint8_t CyclesCccNotTaken = 11;
+    static const uint8_t CyclesRccTaken = 11;
+    static const uint8_t CyclesRccNotTaken = 5;
+    static const uint8_t CyclesRST = 11;
+    static const uint8_t CyclesPUSH = 11;
+    static const uint8_t CyclesXTHL = 18;
+    static const uint8_t CyclesPCHL = 5;            // PCHL, SPHL
+    static const uint8_t CyclesHLT = 7;
+};
+
+struct CPUVariantIntel8085
+{
+    static const Assembler::CPUType Type = Assembler::CPUType::Intel8085;
+    static const bool ExtendedInstructions = true;
+    static const bool ExtendedFlags = true;
+    static const uint8_t PSWMask = 0xF7;
+    static const uint8_t PSWSet = 0x00;
+
+    static const uint8_t CyclesMOVRegister = 4;
+    static const uint8_t CyclesINRRegister = 4;
+    static const uint8_t CyclesINX = 6;
+    static const uint8_t CyclesJccNotTaken = 7;
+    static const uint8_t CyclesCALL = 18;
+    static const uint8_t CyclesCccNotTaken = 9;
+    static const uint8_t CyclesRccTaken = 12;
+    static const uint8_t CyclesRccNotTaken = 6;
+    static const uint8_t CyclesRST = 12;
+    static const uint8_t CyclesPUSH = 12;
+    static const uint8_t CyclesXTHL = 16;
+    static const uint8_t CyclesPCHL = 6;
+    static const uint8_t CyclesHLT = 5;
+};
+
+} // namespace Emulator
@@ -0,0 +1,118 @@
+#pragma once
+
+#include <memory>
+#include <vector>
+#include "emulator/FastProcessorIntel8080.h"
+
+namespace Emulator
+{
+
+struct BlockCacheStatistics
+{
+    size_t lookups;             // Number of blocks started
+    size_t hits;                // Number of blocks found in the cache
+    size_t translations;        // Number of blocks decoded
+    size_t invalidations;       // Number of blocks discarded because their code was overwritten
+
+    BlockCacheStatistics()
+        : lookups()
+        , hits()
+        , translations()
+        , invalidations()
+    {}
+    double HitRate() const
+    {
+        return (lookups != 0) ? double(hits) / double(lookups) : 0.0;
+    }
+};
+
+// Intel 8080 engine with a basic block translation cache.
+// Straight-line code up to and including the next jump, call, return, restart, PCHL or HLT is decoded once
+// into an array of handlers keyed by its start address, together with the immediate data and addresses of
+// the instructions, so running a block only fetches the data the instructions read or write.
+// Pages holding cached code are watched through a MemoryManager store subscription, a store to such a page
+// discards the blocks covering the address written.
+// Memory loaded through LoadCode() or LoadData() flushes the cache, for other direct changes to memory
+// blocks FlushCache() must be called.
+// With idle skipping enabled, Run(budget) uses the handlers without the cache (see FastProcessorIntel8080).
+// For its speed against the other engines see FastProcessorIntel8080.
+class CachedProcessorIntel8080 : public FastProcessorIntel8080
+{
+public:
+    static const size_t MaxBlockInstructions = 64;
+
+    CachedProcessorIntel8080();
+    virtual ~CachedProcessorIntel8080();
+
+    void LoadCode(std::vector<uint8_t> const & machineCode, MemoryAddressType origin, ROMPtr rom);
+    void LoadData(std::vector<uint8_t> const & data, MemoryAddressType origin, RAMPtr ram);
+    void Setup(MemoryManagerPtr memoryManager, IOManagerPtr ioManager) override;
+
+    void Run() override;
+    size_t Run(size_t budget) override;
+
+    void FlushCache();
+    size_t CachedBlockCount() const;
+    BlockCacheStatistics const & GetStatistics() const { return statistics; }
+    void ResetStatistics() { statistics = BlockCacheStatistics(); }
+
+protected:
+    struct MicroOp
+    {
+        InstructionHandler handler;
+        OpcodesIntel8080 instruction;
+        uint16_t operand;               // Immediate data or address, for the decoded handlers
+    };
+    struct Block
+    {
+        MemoryAddressType address;
+        size_t size;
+        std::vector<MicroOp> microOps;
+    };
+    using BlockPtr = std::unique_ptr<Block>;
+
+    std::vector<BlockPtr> blocks;
+    std::vector<std::vector<MemoryAddressType>> pageBlocks;
+    std::vector<BlockPtr> retiredBlocks;
+    bool codeModified;
+    BlockCacheStatistics statistics;
+    MemoryManager::StoreSubscription storeSubscription;
+
+    Block * LookupBlock(MemoryAddressType address)
+    {
+        ++statistics.lookups;
+        Block * block = blocks[address].get();
+        if (block != nullptr)
+        {
+            ++statistics.hits;
+            return block;
+        }
+        return TranslateBlock(address);
+    }
+    Block * TranslateBlock(MemoryAddressType address);
+    size_t Step()
+    {
+        Block const * block = LookupBlock(registers.pc);
+        codeModified = false;
+        size_t cycles = 0;
+        for (auto const & microOp : block->microOps)
+        {
+            ++registers.pc;
+            instruction = microOp.instruction;
+            decodedOperand = microOp.operand;
+            registers.instructionCycles = microOp.handler(*this);
+            cycles += registers.instructionCycles;
+            // Self-modifying code, the rest of the block may be stale
+            if (codeModified)
+                break;
+        }
+        // The block may have been invalidated while it was running
+        retiredBlocks.clear();
+        return cycles;
+    }
+    void InvalidateBlock(MemoryAddressType address);
+    void OnStore(size_t address);
+    static bool EndsBlock(OpcodesIntel8080 instruction);
+}; // CachedProcessorIntel8080
+
+} // namespace Emulator
@@ -0,0 +1,78 @@
+#pragma once
+
+#include "emulator/IODevice.h"
+
+namespace Emulator
+{
+
+// Floppy disk controller transferring whole sectors through a sector buffer.
+// Ports: base = track, base + 1 = sector (1 based), base + 2 = command (write) / status (read),
+// base + 3 = data, reading or writing the next byte of the sector buffer.
+// A read command fills the buffer from the selected sector, a write command stores the buffer in it.
+class DiskControllerDevice : public IODevice
+{
+public:
+    static const size_t TrackPort = 0;
+    static const size_t SectorPort = 1;
+    static const size_t CommandPort = 2;
+    static const size_t DataPort = 3;
+    static const uint8_t CommandRead = 0x01;
+    static const uint8_t CommandWrite = 0x02;
+    static const uint8_t StatusError = 0x01;
+    // IBM 3740 single sided single density, as used by CP/M
+    static const size_t DefaultTrackCount = 77;
+    static const size_t DefaultSectorsPerTrack = 26;
+    static const size_t DefaultSectorSize = 128;
+
+    DiskControllerDevice(size_t base,
+                         size_t trackCount = DefaultTrackCount,
+                         size_t sectorsPerTrack = DefaultSectorsPerTrack,
+                         size_t sectorSize = DefaultSectorSize);
+    virtual ~DiskControllerDevice();
+
+    // Image contents beyond the disk size are ignored, missing contents read as 0xE5 (formatted)
+    void LoadImage(std::vector<uint8_t> const & data);
+    std::vector<uint8_t> const & Image() const { return image; }
+    size_t SectorSize() const { return sectorBuffer.size(); }
+
+    uint8_t In8(size_t address) const override
+    {
+        if (address == base + DataPort)
+        {
+            uint8_t data = sectorBuffer[bufferIndex];
+            bufferIndex = (bufferIndex + 1) % sectorBuffer.size();
+            return data;
+        }
+        return InRegister(address);
+    }
+    void Out8(size_t address, uint8_t data) override
+    {
+        if (address == base + DataPort)
+        {
+            sectorBuffer[bufferIndex] = data;
+            bufferIndex = (bufferIndex + 1) % sectorBuffer.size();
+            return;
+        }
+        OutRegister(address, data);
+    }
+    void InRepeated(size_t address, uint8_t * data, size_t count) override;
+    void OutRepeated(size_t address, uint8_t const * data, size_t count) override;
+
+private:
+    size_t trackCount;
+    size_t sectorsPerTrack;
+    std::vector<uint8_t> image;
+    std::vector<uint8_t> sectorBuffer;
+    mutable size_t bufferIndex;
+    uint8_t track;
+    uint8_t sector;
+    uint8_t status;
+
+    uint8_t InRegister(size_t address) const;
+    void OutRegister(size_t address, uint8_t data);
+    bool SectorOffset(size_t & offset) const;
+};
+
+using DiskControllerDevicePtr = std::shared_ptr<DiskControllerDevice>;
+
+} // namespace Emulator
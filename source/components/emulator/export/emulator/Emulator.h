@@ -6,16 +6,21 @@
 #include "assembler/ObjectCode.h"
 #include "assembler/PrettyPrinter.h"
 #include "emulator/CPUEmulatorIntel8080.h"
+#include "emulator/ProcessorIntel8085.h"
 
 namespace Emulator
 {
 
-std::unique_ptr<ICPUEmulator> CreateEmulator(Assembler::CPUType cpuType, Assembler::ObjectCode const & objectCode, Assembler::PrettyPrinter<wchar_t> & printer)
+std::unique_ptr<ICPUEmulator> CreateEmulator(Assembler::CPUType cpuType, Assembler::ObjectCode const & objectCode, Assembler::PrettyPrinter<wchar_t> & printer,
+                                             std::ostream * traceStream = nullptr)
 {
     switch (cpuType)
     {
     case Assembler::CPUType::Intel8080:
-        return std::unique_ptr<ICPUEmulator>(new CPUEmulatorIntel8080(objectCode, printer));
+        return std::unique_ptr<ICPUEmulator>(new CPUEmulatorIntel8080(objectCode, printer, traceStream));
+    case Assembler::CPUType::Intel8085:
+        return std::unique_ptr<ICPUEmulator>(new CPUEmulatorIntel8080(objectCode, printer, traceStream,
+                                                                      std::make_shared<ProcessorIntel8085>()));
     default:
         {
             printer << L"Unsupported CPU type: " << cpuType;
@@ -0,0 +1,54 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <vector>
+
+namespace Emulator
+{
+
+using EventID = uint64_t;
+// Called with the deadline the event was scheduled for
+using EventCallback = std::function<void(uint64_t deadline)>;
+
+// Events ordered by deadline in emulated cycles, kept in a binary min-heap.
+// Events with the same deadline run in the order they were scheduled.
+class EventScheduler
+{
+public:
+    static const uint64_t NoDeadline = UINT64_MAX;
+
+    EventScheduler();
+    virtual ~EventScheduler();
+
+    EventID Schedule(uint64_t deadline, EventCallback const & callback);
+    // Returns false if the event already ran or was cancelled
+    bool Cancel(EventID id);
+    void Clear();
+
+    uint64_t NextDeadline() const { return events.empty() ? NoDeadline : events.front().deadline; }
+    size_t Size() const { return events.size(); }
+    // Run all events with a deadline up to and including now. Events scheduled by a callback run as well when due.
+    // Returns the number of events run.
+    size_t RunDue(uint64_t now);
+
+private:
+    struct Event
+    {
+        uint64_t deadline;
+        EventID id;
+        EventCallback callback;
+
+        // Ordering for std::push_heap / std::pop_heap, which keep the largest element on top
+        bool operator < (Event const & other) const
+        {
+            return (deadline > other.deadline) || ((deadline == other.deadline) && (id > other.id));
+        }
+    };
+
+    std::vector<Event> events;
+    EventID nextID;
+};
+
+} // namespace Emulator
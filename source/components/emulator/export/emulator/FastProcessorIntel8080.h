@@ -0,0 +1,263 @@
+#pragma once
+
+#include <limits>
+#include "emulator/ProcessorIntel8080.h"
+
+namespace Emulator
+{
+
+template<class Variant, bool Decoded = false>
+struct InstructionHandlersIntel8080;
+
+// Last flag setting ALU operation, for lazy flag evaluation
+enum class FlagsOperation : uint8_t
+{
+    None,       // registers.flags is up to date
+    Add,
+    AddC,
+    Sub,
+    SubC,
+    And,
+    Xor,
+    Or,
+    Cmp,
+    Inc,
+    Dec,
+};
+
+// Alternate execution engine for the Intel 8080.
+// Instead of the switch in ProcessorIntel8080::ExecuteInstruction, every opcode is dispatched
+// through a 256 entry table of handlers, each of which returns its own cycle count, so no
+// lookup in instruction8080[] is needed after execution.
+// Run() only performs the trap / trace / debug callback checks when they can have an effect,
+// otherwise the fetch-dispatch loop runs without any per instruction checks.
+// The handlers are instantiated for a CPU variant policy (CPUVariantIntel8080.h), this engine uses the 8080 table,
+// ProcessorIntel8085 the 8085 one.
+//
+// With lazy flags enabled, ALU instructions only record the operation and its operands, and registers.flags
+// is computed when it is needed: by a conditional instruction, PUSH PSW or any other instruction reading flags,
+// before calling the debug callback, at the end of Run() and in GetRegisters().
+// emulator-benchmark runs this mode as the fast+lazy engine.
+//
+// With idle skipping enabled (SetIdleSkipping()), Run(budget) looks for idle loops: a taken jump back over at most
+// MaxIdleLoopLength bytes, to a loop that only reads registers, memory and passive ports (IOManager::IsPassiveIn(),
+// reads without side effects), and has no stores, OUT, stack or interrupt instructions. The next iteration is run
+// with a check that it stays within the loop. If it ends at the loop start with the registers it started with, every
+// following iteration does the same until a scheduled event, an interrupt or the periodic handler changes something,
+// so the whole iterations up to the next of these are skipped.
+// Passive ports are assumed to only change on those events or through Out8().
+// Loops found not to be idle are not checked again for the next IdleLoopBackoff backward jumps to them.
+// Idle loops are not skipped while profiling, recording coverage or a trace, or using a replay log.
+// The engines running translated code (CachedProcessorIntel8080, JitProcessorIntel8080, RecompiledProcessorIntel8080)
+// have no backward jump check in their blocks, so with idle skipping enabled their Run(budget) runs this loop
+// instead, at the speed of this engine. Only enable it on them for programs spending most of their time idle.
+//
+// Speed of all the engines, measured together with emulator-benchmark --filter multiply3x7 (Multiply3x7 from
+// testdata/asm-8080 restarted in a loop), x86-64, gcc -O2:
+//   ProcessorIntel8080::Run()              ~  65 MIPS
+//   FastProcessorIntel8080::Run()          ~ 145 MIPS (~ 140 MIPS with lazy flags)
+//   CachedProcessorIntel8080::Run()        ~ 160 MIPS
+//   RecompiledProcessorIntel8080::Run()    ~ 435 MIPS
+//   JitProcessorIntel8080::Run()           ~ 465 MIPS
+// The handler table gains about 2x over the switch of ProcessorIntel8080, not the several times this engine was
+// meant to reach: both still execute one instruction at a time through the same register and memory accesses, only
+// the dispatch differs. Only the engines compiling whole blocks to host code get several times faster.
+class FastProcessorIntel8080 : public ProcessorIntel8080
+{
+public:
+    static const uint16_t MaxIdleLoopLength = 32;
+    static const size_t IdleLoopBackoff = 256;
+
+    FastProcessorIntel8080();
+    virtual ~FastProcessorIntel8080();
+
+    void Reset() override;
+    void FetchInstruction() override;
+    void ExecuteInstruction() override;
+    void Run() override;
+    size_t Run(size_t budget) override;
+
+    RegistersIntel8080 & GetRegisters() override
+    {
+        MaterializeFlags();
+        return registers;
+    }
+
+    void SetLazyFlags(bool lazy)
+    {
+        MaterializeFlags();
+        lazyFlags = lazy;
+    }
+    bool GetLazyFlags() const { return lazyFlags; }
+
+    template<class Variant, bool Decoded>
+    friend struct InstructionHandlersIntel8080;
+
+protected:
+    using InstructionHandler = uint8_t (*)(FastProcessorIntel8080 & processor);
+    // The 8080 handlers, also used by the engines running translated code
+    static const InstructionHandler * const instructionHandlers;
+    // The 8080 handlers taking immediate data and addresses from decodedOperand, for engines decoding them up front
+    static const InstructionHandler * const decodedInstructionHandlers;
+
+    explicit FastProcessorIntel8080(InstructionHandler const * handlers);
+
+    InstructionHandler const * handlers;
+    bool lazyFlags;
+    FlagsOperation flagsOperation;
+    uint8_t flagsOperand1;
+    uint8_t flagsOperand2;
+    FlagsIntel8080 flagsInput;
+    MemoryAddressType idleLoopRejected;     // Start of the last loop found not to be idle
+    size_t idleLoopBackoff;
+    size_t sliceEnd;                        // End of the slice of Run(budget), cleared by EI with an interrupt request pending
+    uint16_t decodedOperand;                // Immediate data or address of the instruction run by a decoded handler
+
+    void MaterializeFlags()
+    {
+        if (flagsOperation != FlagsOperation::None)
+            EvaluateFlags();
+    }
+    void EvaluateFlags();
+
+    bool NeedsTraceChecks() const
+    {
+        return registers.trapEnabled || (registers.trace && debugCallback);
+    }
+    // Breakpoints, watchpoints, profiling, coverage, replay logs and traces are handled by the loops of Run() and Run(budget)
+    // only, engines running translated code use these loops while any of them is active
+    bool NeedsHandlerLoop() const
+    {
+        return memoryManager->HasTraps() || (profiler != nullptr) || (coverage != nullptr) || (replayLog != nullptr) ||
+               (traceRecorder != nullptr);
+    }
+    // Run(budget) of the engines running translated code also uses the handler loop for idle skipping, which leaves
+    // their translated code unused while it is enabled
+    bool NeedsHandlerRun() const
+    {
+        return NeedsHandlerLoop() || idleSkipping;
+    }
+    // Run() and Run(budget) of the engines running translated code. step(limit) runs the code at registers.pc, a block
+    // or a single instruction, and returns its cycles. It may stop at limit cycles, but does not have to.
+    template<class Step>
+    void RunBlocks(Step step);
+    template<class Step>
+    size_t RunBlocks(size_t budget, Step step);
+    template<bool Instrumented>
+    void RunInstructions();
+    template<bool Instrumented>
+    void RunSlice(size_t & cycles);
+    void RunIdleSlice(size_t & cycles);
+    void RunProfiledInstructions();
+    void RunProfiledSlice(size_t & cycles);
+    void RecordTrace();
+    void SkipIdleLoop(MemoryAddressType jump, size_t & cycles);
+    bool IsIdleLoopCode(MemoryAddressType start, MemoryAddressType jump) const;
+    void RejectIdleLoop(MemoryAddressType start)
+    {
+        idleLoopRejected = start;
+        idleLoopBackoff = IdleLoopBackoff;
+    }
+    uint8_t FetchByte()
+    {
+        return memoryManager->Fetch8(registers.pc++);
+    }
+    uint16_t FetchWord()
+    {
+        uint8_t low = memoryManager->Fetch8(registers.pc++);
+        uint8_t high = memoryManager->Fetch8(registers.pc++);
+        return uint16_t(low | (high << 8));
+    }
+    void PushWord(uint16_t data)
+    {
+        memoryManager->Store8(--registers.sp.W, uint8_t(data >> 8));
+        memoryManager->Store8(--registers.sp.W, uint8_t(data));
+    }
+    uint16_t PopWord()
+    {
+        uint8_t low = memoryManager->Fetch8(registers.sp.W++);
+        uint8_t high = memoryManager->Fetch8(registers.sp.W++);
+        return uint16_t(low | (high << 8));
+    }
+}; // FastProcessorIntel8080
+
+template<class Step>
+void FastProcessorIntel8080::RunBlocks(Step step)
+{
+    if (NeedsHandlerLoop())
+    {
+        FastProcessorIntel8080::Run();
+        return;
+    }
+    // Trap, trace or a halted processor need the checks in FetchInstruction(), so run the
+    // instruction by instruction loop until none of them apply anymore
+    while (NeedsTraceChecks() || IsHalted())
+    {
+        if (!RunInstruction())
+            return;
+    }
+    while (!registers.isHalted)
+    {
+        size_t cycles = step(std::numeric_limits<size_t>::max());
+        if (registers.cycleCountPeriod != 0)
+            registers.cycleCount -= int64_t(cycles);
+    }
+    MaterializeFlags();
+}
+
+// The budget, the period and scheduled events are checked at the end of every slice, as in Run(budget), so all of them
+// can be exceeded by at most one block of instructions
+template<class Step>
+size_t FastProcessorIntel8080::RunBlocks(size_t budget, Step step)
+{
+    if (NeedsHandlerRun())
+        return FastProcessorIntel8080::Run(budget);
+    if (NeedsTraceChecks())
+        return ProcessorIntel8080::Run(budget);
+    size_t cycles = 0;
+    bool periodic = (registers.cycleCountPeriod != 0);
+    if (periodic && !registers.isHalted && (registers.cycleCount <= 0) && !PeriodElapsed())
+        return 0;
+    MaterializeFlags();
+    ServiceEvents();
+    while (cycles < budget)
+    {
+        if (registers.isHalted)
+        {
+            MaterializeFlags();
+            if (!SkipHalted(cycles, budget))
+                break;
+            continue;
+        }
+        size_t sliceStart = cycles;
+        sliceEnd = cycles + EventSliceLength(budget - cycles);
+        if (periodic)
+        {
+            size_t periodLeft = (registers.cycleCount > 0) ? size_t(registers.cycleCount) : 1;
+            if (periodLeft < sliceEnd - cycles)
+                sliceEnd = cycles + periodLeft;
+        }
+        while (!registers.isHalted && (cycles < sliceEnd))
+            cycles += step(sliceEnd - cycles);
+        registers.cycleCountTotal += cycles - sliceStart;
+        if (periodic)
+        {
+            registers.cycleCount -= int64_t(cycles - sliceStart);
+            if (registers.cycleCount <= 0)
+            {
+                MaterializeFlags();
+                if (!PeriodElapsed())
+                    break;
+            }
+        }
+        if (EventsDue())
+        {
+            MaterializeFlags();
+            ServiceEvents();
+        }
+    }
+    MaterializeFlags();
+    return cycles;
+}
+
+} // namespace Emulator
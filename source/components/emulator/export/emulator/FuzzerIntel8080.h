@@ -0,0 +1,108 @@
+#pragma once
+
+#include <cstdint>
+#include <memory>
+#include <random>
+#include <string>
+#include <vector>
+#include "assembler/ObjectCode.h"
+#include "emulator/CoverageMapIntel8080.h"
+#include "emulator/FastProcessorIntel8080.h"
+#include "emulator/RAM.h"
+
+namespace Emulator
+{
+
+// Outcome of running the image on a single input
+struct FuzzRunIntel8080
+{
+    bool halted;                    // Ran up to a HLT instruction
+    bool timedOut;                  // Stopped at the cycle limit without halting
+    std::string error;              // Message of the exception stopping the run, if any
+    size_t cycles;                  // Number of cycles executed
+    bool newCoverage;               // Reached an edge, or an edge hit count bucket, no earlier input reached
+
+    FuzzRunIntel8080()
+        : halted()
+        , timedOut()
+        , error()
+        , cycles()
+        , newCoverage()
+    {}
+    bool Crashed() const { return !error.empty(); }
+};
+
+struct FuzzStatisticsIntel8080
+{
+    size_t executions;
+    size_t crashes;                 // Runs stopped by an exception, e.g. an invalid instruction or a store to ROM
+    size_t timeouts;
+    size_t edges;                   // Map entries hit by any input so far
+
+    FuzzStatisticsIntel8080()
+        : executions()
+        , crashes()
+        , timeouts()
+        , edges()
+    {}
+};
+
+// In-process coverage guided fuzzer of 8080 programs, mutating the stream of bytes read with IN.
+// The memory layout is the one of BatchInstanceIntel8080: the ASEG segment in ROM, RAM from the end of the segment
+// up to the end of the address space. Every IN instruction, whatever the port, reads the next byte of the input,
+// and 0 once the input is used up. OUT instructions are ignored.
+//
+// Inputs are kept in the corpus when they reach new coverage, using the hit count buckets of AFL
+// (1, 2, 3, 4-7, 8-15, 16-31, 32-127, 128-255). Inputs stopping the run with an exception are kept as crashes
+// when their coverage differs from that of all earlier crashes, inputs running into the cycle limit are not kept.
+// With the same seed and seed inputs, a fuzzing session is fully reproducible.
+class FuzzerIntel8080
+{
+public:
+    static const size_t DefaultMaxCycles = 1000000;
+    static const size_t DefaultMaxInputSize = 256;
+
+    FuzzerIntel8080(Assembler::ObjectCode const & objectCode, uint32_t seed = 1,
+                    size_t maxCycles = DefaultMaxCycles, size_t maxInputSize = DefaultMaxInputSize);
+    virtual ~FuzzerIntel8080();
+
+    size_t MaxCycles() const { return maxCycles; }
+    size_t MaxInputSize() const { return maxInputSize; }
+
+    // Runs a single input, and adds it to the corpus if it reaches new coverage.
+    // The coverage map holds the edges of this run until the next one.
+    FuzzRunIntel8080 Execute(std::vector<uint8_t> const & input);
+    // Runs iterations mutations of inputs taken from the corpus. The first call runs the empty input first.
+    void Run(size_t iterations);
+
+    std::vector<std::vector<uint8_t>> const & GetCorpus() const { return corpus; }
+    std::vector<std::vector<uint8_t>> const & GetCrashes() const { return crashes; }
+    CoverageMapIntel8080 const & GetCoverage() const { return coverage; }
+    FuzzStatisticsIntel8080 const & GetStatistics() const { return statistics; }
+    RAMPtr GetRAM() const { return ram; }
+
+private:
+    class InputDevice;
+
+    size_t maxCycles;
+    size_t maxInputSize;
+    std::mt19937 random;
+    FastProcessorIntel8080 processor;
+    MemoryManagerPtr memoryManager;
+    ROMPtr rom;
+    RAMPtr ram;
+    std::shared_ptr<InputDevice> inputDevice;
+    CoverageMapIntel8080 coverage;
+    std::vector<uint8_t> virgin;            // Hit count buckets not seen yet, for every map entry
+    std::vector<uint8_t> virginCrashes;     // Same, for the runs which crashed
+    std::vector<std::vector<uint8_t>> corpus;
+    std::vector<std::vector<uint8_t>> crashes;
+    FuzzStatisticsIntel8080 statistics;
+
+    bool MergeCoverage(std::vector<uint8_t> & virginMap, bool countEdges);
+    std::vector<uint8_t> Mutate(std::vector<uint8_t> const & input);
+    size_t RandomIndex(size_t count) { return size_t(random() % count); }
+    uint8_t RandomByte() { return uint8_t(random()); }
+};
+
+} // namespace Emulator
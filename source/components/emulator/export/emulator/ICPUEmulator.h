@@ -11,6 +11,7 @@ enum class Options : uint8_t
     Step = 1 << 1,
     ShowInstructionResults = 1 << 2,
     ShowFinalResults = 1 << 3,
+    TraceInstructions = 1 << 4,     // Record a binary trace of every instruction to the trace stream
     None = 0x00,
 };
 
@@ -16,6 +16,9 @@ public:
 
     virtual std::vector<uint8_t> In(size_t address, size_t size) const = 0;
     virtual void Out(size_t address, std::vector<uint8_t> const & data) = 0;
+    // Bulk access through a caller supplied buffer, without allocating
+    virtual void In(size_t address, uint8_t * data, size_t size) const = 0;
+    virtual void Out(size_t address, uint8_t const * data, size_t size) = 0;
     virtual uint8_t In8(size_t address) const = 0;
     virtual void Out8(size_t address, uint8_t data) = 0;
     virtual uint16_t In16(size_t address) const = 0;
@@ -0,0 +1,48 @@
+#pragma once
+
+#include "emulator/IIO.h"
+
+namespace Emulator
+{
+
+// Base for peripherals attached to the IO manager.
+// A device only needs to implement In8() and Out8(), all wider and bulk accesses are built on them.
+// Reading a port may change device state, so devices keep that state mutable.
+class IODevice : public IIO
+{
+public:
+    IODevice(size_t base, size_t size);
+    virtual ~IODevice();
+
+    size_t Offset() const override;
+    size_t Size() const override;
+
+    std::vector<uint8_t> In(size_t address, size_t size) const override;
+    void Out(size_t address, std::vector<uint8_t> const & data) override;
+    void In(size_t address, uint8_t * data, size_t size) const override;
+    void Out(size_t address, uint8_t const * data, size_t size) override;
+    uint16_t In16(size_t address) const override;
+    void Out16(size_t address, uint16_t data) override;
+    uint32_t In32(size_t address) const override;
+    void Out32(size_t address, uint32_t data) override;
+    uint64_t In64(size_t address) const override;
+    void Out64(size_t address, uint64_t data) override;
+
+    // Transfer count bytes through the same port, as a sequence of IN or OUT instructions to one port would.
+    // Devices with a data port override these to move the whole run at once.
+    virtual void InRepeated(size_t address, uint8_t * data, size_t count);
+    virtual void OutRepeated(size_t address, uint8_t const * data, size_t count);
+    // Whether reading the port leaves the device as it is, like a status port only changed by Out8() or the host.
+    // Idle loop skipping (FastProcessorIntel8080) only skips loops reading ports without side effects.
+    virtual bool IsPassiveIn(size_t address) const;
+
+protected:
+    size_t base;
+    size_t size;
+
+    void CheckRange(size_t address, size_t count, char const * operation) const;
+};
+
+using IODevicePtr = std::shared_ptr<IODevice>;
+
+} // namespace Emulator
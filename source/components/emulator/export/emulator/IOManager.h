@@ -3,27 +3,78 @@
 #include <memory>
 #include <vector>
 #include "emulator/IIO.h"
+#include "emulator/IODevice.h"
 
 namespace Emulator
 {
 
+// Entry of the direct port table.
+// Passive IOPort bytes are accessed through contents, other blocks through a virtual call on io.
+struct IOPortEntry
+{
+    IIO * io;                   // Block handling the port, null if unmapped
+    IODevice * device;          // Same block if it is a device, for repeated transfers
+    uint8_t * contents;         // Direct pointer to the byte of an IOPort
+
+    IOPortEntry()
+        : io()
+        , device()
+        , contents()
+    {}
+};
+
 using IOVector = std::vector<std::shared_ptr<IIO>>;
+using IOPortEntryVector = std::vector<IOPortEntry>;
 
 class IOManager : public IIO
 {
 public:
+    static const size_t PortCount = 256;
+
     IOManager();
     virtual ~IOManager();
 
     void AddIO(IIOPtr memory);
+    IOVector const & GetIOPorts() const { return ioPorts; }
+    IOPortEntry const & GetPort(size_t address) const { return portTable[address]; }
 
     size_t Offset() const override;
     size_t Size() const override;
 
     std::vector<uint8_t> In(size_t address, size_t size) const override;
     void Out(size_t address, std::vector<uint8_t> const & data) override;
-    uint8_t In8(size_t address) const;
-    void Out8(size_t address, uint8_t data);
+    void In(size_t address, uint8_t * data, size_t size) const override;
+    void Out(size_t address, uint8_t const * data, size_t size) override;
+    uint8_t In8(size_t address) const override final
+    {
+        if (address < PortCount)
+        {
+            IOPortEntry const & entry = portTable[address];
+            if (entry.contents)
+                return *entry.contents;
+            if (entry.io)
+                return entry.io->In8(address);
+        }
+        return InBlock8(address);
+    }
+    void Out8(size_t address, uint8_t data) override final
+    {
+        if (address < PortCount)
+        {
+            IOPortEntry const & entry = portTable[address];
+            if (entry.contents)
+            {
+                *entry.contents = data;
+                return;
+            }
+            if (entry.io)
+            {
+                entry.io->Out8(address, data);
+                return;
+            }
+        }
+        OutBlock8(address, data);
+    }
     uint16_t In16(size_t address) const;
     void Out16(size_t address, uint16_t data);
     uint32_t In32(size_t address) const;
@@ -31,10 +82,27 @@ public:
     uint64_t In64(size_t address) const;
     void Out64(size_t address, uint64_t data);
 
+    // Reading the port has no side effects: it is an IOPort byte, or a device port declared passive by the device
+    bool IsPassiveIn(size_t address) const
+    {
+        if (address >= PortCount)
+            return false;
+        IOPortEntry const & entry = portTable[address];
+        return (entry.contents != nullptr) || ((entry.device != nullptr) && entry.device->IsPassiveIn(address));
+    }
+
+    // Transfer count bytes through a single port, in one call for devices supporting it
+    void InRepeated(size_t address, uint8_t * data, size_t count);
+    void OutRepeated(size_t address, uint8_t const * data, size_t count);
+
 private:
     IOVector ioPorts;
+    IOPortEntryVector portTable;
 
     IIOPtr FindIOPortForOffsetSize(size_t offset) const;
+    void MapPorts(IIOPtr io);
+    uint8_t InBlock8(size_t address) const;
+    void OutBlock8(size_t address, uint8_t data);
 };
 
 using IOManagerPtr = std::shared_ptr<IOManager>;
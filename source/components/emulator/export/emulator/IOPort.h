@@ -16,9 +16,13 @@ public:
 
     size_t Offset() const override;
     size_t Size() const override;
+    uint8_t * Data() { return ports.data(); }
+    uint8_t const * Data() const { return ports.data(); }
 
     std::vector<uint8_t> In(size_t address, size_t size) const override;
     void Out(size_t address, std::vector<uint8_t> const & data) override;
+    void In(size_t address, uint8_t * data, size_t size) const override;
+    void Out(size_t address, uint8_t const * data, size_t size) override;
     uint8_t In8(size_t address) const override;
     void Out8(size_t address, uint8_t data) override;
     uint16_t In16(size_t address) const override;
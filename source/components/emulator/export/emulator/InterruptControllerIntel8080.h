@@ -0,0 +1,35 @@
+#pragma once
+
+#include <cstdint>
+
+namespace Emulator
+{
+
+// Priority interrupt controller for the eight restart vectors of the 8080, like the Intel 8214.
+// Level n is delivered as RST n, the highest pending level that is not masked wins.
+class InterruptControllerIntel8080
+{
+public:
+    static const uint8_t LevelCount = 8;
+
+    InterruptControllerIntel8080();
+    virtual ~InterruptControllerIntel8080();
+
+    void Request(uint8_t level);
+    void Cancel(uint8_t level);
+    void Reset();
+    // Masked levels stay pending but are not delivered
+    void SetMask(uint8_t mask) { this->mask = mask; }
+    uint8_t GetMask() const { return mask; }
+
+    uint8_t GetPending() const { return pending; }
+    bool IsPending() const { return (pending & ~mask) != 0; }
+    // Take the highest pending level out of the pending set and return it. Only valid if IsPending().
+    uint8_t Acknowledge();
+
+private:
+    uint8_t pending;
+    uint8_t mask;
+};
+
+} // namespace Emulator
@@ -0,0 +1,148 @@
+#pragma once
+
+#include <exception>
+#include <memory>
+#include <unordered_map>
+#include <vector>
+#include "emulator/FastProcessorIntel8080.h"
+
+namespace Emulator
+{
+
+struct JitStatistics
+{
+    size_t entries;                     // Number of times translated code was entered from the run loop
+    size_t translations;                // Number of blocks translated to host code
+    size_t interpretedInstructions;     // Number of instructions run by the interpreter
+    size_t invalidations;               // Number of blocks discarded because their code was overwritten
+    size_t flushes;                     // Number of times the code cache ran full and was emptied
+
+    JitStatistics()
+        : entries()
+        , translations()
+        , interpretedInstructions()
+        , invalidations()
+        , flushes()
+    {}
+};
+
+// Intel 8080 engine translating hot basic blocks to x86-64 machine code.
+// Code is interpreted by the handlers of FastProcessorIntel8080 until an address has been reached
+// hotThreshold times, then the block starting there is translated into an executable code cache.
+// While running translated code A, BC, DE, HL, SP and the flags live in host registers (bl, bh, r12 - r15),
+// flags are only computed when a later instruction in the block or the code after it can read them.
+// Exits to a translated block are chained by patching the jump, returns and PCHL look up the target block.
+// Stores to pages holding translated code discard the blocks covering the address written, and unlink the jumps into them.
+//
+// Rotates and DAA call the helpers of the interpreter from translated code. XTHL, IN, OUT, EI, DI, HLT and invalid
+// opcodes always run in the interpreter, the block stops before them.
+// Translation is only available on x86-64 hosts with the System V calling convention (IsSupported()),
+// elsewhere this engine runs everything in the interpreter. Run(budget) also stays in the interpreter while
+// idle skipping is enabled.
+// For its speed against the other engines see FastProcessorIntel8080.
+class JitProcessorIntel8080 : public FastProcessorIntel8080
+{
+public:
+    static const size_t DefaultCodeCacheSize = 4 * 1024 * 1024;
+    static const uint8_t DefaultHotThreshold = 8;
+    static const size_t MaxBlockInstructions = 64;
+
+    explicit JitProcessorIntel8080(size_t codeCacheSize = DefaultCodeCacheSize);
+    virtual ~JitProcessorIntel8080();
+
+    static bool IsSupported();
+
+    void LoadCode(std::vector<uint8_t> const & machineCode, MemoryAddressType origin, ROMPtr rom);
+    void LoadData(std::vector<uint8_t> const & data, MemoryAddressType origin, RAMPtr ram);
+    void Setup(MemoryManagerPtr memoryManager, IOManagerPtr ioManager) override;
+
+    void Run() override;
+    size_t Run(size_t budget) override;
+
+    // Number of visits to an address before its block is translated, 1 translates on the first visit
+    void SetHotThreshold(uint8_t threshold) { hotThreshold = (threshold != 0) ? threshold : 1; }
+    uint8_t GetHotThreshold() const { return hotThreshold; }
+    // Must not be called while translated code is running, e.g. from a store callback
+    void FlushCache();
+    size_t TranslatedBlockCount() const;
+    size_t CodeCacheUsed() const { return size_t(codeCacheFree - codeCache); }
+    JitStatistics const & GetStatistics() const { return statistics; }
+    void ResetStatistics() { statistics = JitStatistics(); }
+
+protected:
+    class Translator;
+    friend class Translator;
+
+    struct Exit
+    {
+        MemoryAddressType target;
+        uint8_t * jump;             // rel32 operand of the jump leaving the block, patched to chain
+        uint8_t * stub;             // Code returning to the run loop with pc set to target
+    };
+    struct Block
+    {
+        MemoryAddressType address;
+        size_t size;
+        std::vector<Exit> exits;
+    };
+    using BlockPtr = std::unique_ptr<Block>;
+    using EntryFunction = void (*)(JitProcessorIntel8080 * processor, uint8_t const * code);
+
+    size_t codeCacheSize;
+    uint8_t * codeCache;
+    uint8_t * codeCacheBlocks;          // Start of the block area, after the entry and exit code
+    uint8_t * codeCacheFree;
+    bool codeWritable;                  // The code cache is either writable or executable, never both
+    bool executing;
+    EntryFunction enterCode;
+    uint8_t * exitCode;
+    std::vector<BlockPtr> blocks;
+    std::vector<uint8_t const *> entries;
+    std::unordered_map<MemoryAddressType, std::vector<Exit *>> incoming;
+    std::vector<std::vector<MemoryAddressType>> pageBlocks;
+    std::vector<uint8_t> heat;
+    uint8_t hotThreshold;
+    size_t pageSizeBits;
+    JitStatistics statistics;
+    MemoryManager::StoreSubscription storeSubscription;
+
+    // State shared with the translated code, addressed relative to this
+    int64_t cyclesLeft;
+    MemoryPage const * pages;
+    uint8_t const * const * entryTable;
+    bool codeModified;
+    bool aborted;
+    std::exception_ptr exception;
+
+    // A limit of one cycle (e.g. an interrupt waiting to be accepted) always runs a single instruction
+    size_t Step(size_t limit)
+    {
+        uint8_t const * code = entries[registers.pc];
+        if ((code == nullptr) && (++heat[registers.pc] >= hotThreshold))
+            code = TranslateBlock(registers.pc);
+        if ((code == nullptr) || (limit <= 1))
+        {
+            ++statistics.interpretedInstructions;
+            uint8_t data = memoryManager->FetchOpcode8(registers.pc);
+            ++registers.pc;
+            instruction = OpcodesIntel8080(data);
+            registers.instructionCycles = instructionHandlers[data](*this);
+            return registers.instructionCycles;
+        }
+        return Execute(code, limit);
+    }
+    size_t Execute(uint8_t const * code, size_t limit);
+    uint8_t const * TranslateBlock(MemoryAddressType address);
+    void InvalidateBlock(MemoryAddressType address);
+    void OnStore(size_t address);
+    void GenerateEntryAndExit();
+    void MakeCodeWritable();
+    void MakeCodeExecutable();
+    static void Patch(uint8_t * jump, uint8_t const * target);
+
+    // Slow paths of memory accesses from translated code, which cannot unwind exceptions
+    static uint32_t Fetch8(JitProcessorIntel8080 * processor, uint32_t address);
+    static void Store8(JitProcessorIntel8080 * processor, uint32_t address, uint32_t data);
+}; // JitProcessorIntel8080
+
+} // namespace Emulator
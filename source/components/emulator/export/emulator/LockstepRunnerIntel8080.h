@@ -0,0 +1,141 @@
+#pragma once
+
+#include <memory>
+#include <vector>
+#include "assembler/ObjectCode.h"
+#include "emulator/BatchRunnerIntel8080.h"
+
+namespace Emulator
+{
+
+// Input vector of a single lane, loaded before the run
+struct LockstepInputIntel8080
+{
+    uint16_t dataOrigin;            // Address to load data at, must be in RAM
+    std::vector<uint8_t> data;
+    std::vector<uint8_t> io;        // Contents of the IO ports, from port 0 on
+
+    LockstepInputIntel8080()
+        : dataOrigin()
+        , data()
+        , io()
+    {}
+    LockstepInputIntel8080(uint16_t dataOrigin, std::vector<uint8_t> const & data, std::vector<uint8_t> const & io = {})
+        : dataOrigin(dataOrigin)
+        , data(data)
+        , io(io)
+    {}
+};
+
+struct LockstepStatisticsIntel8080
+{
+    size_t lockstepInstructions;        // Instructions executed for all lanes of a block in lockstep at once
+    size_t lockstepLaneInstructions;    // Lane instructions executed as part of these
+    size_t scalarCycles;                // Lane cycles executed one lane at a time
+    size_t divergedLanes;               // Lanes which left lockstep while others continued
+
+    LockstepStatisticsIntel8080()
+        : lockstepInstructions()
+        , lockstepLaneInstructions()
+        , scalarCycles()
+        , divergedLanes()
+    {}
+};
+
+struct LockstepHandlersIntel8080;
+
+// Runs a single image against many input vectors, with one lane (machine) per input vector.
+// Every lane has the memory layout of BatchInstanceIntel8080, the ROM holding the image is shared by all lanes.
+//
+// The registers of the lanes are kept in structure-of-arrays form. As long as the program counters of the lanes agree,
+// every instruction is executed for all of them at once, using SSE2 operations on VectorLanes lanes at a time
+// where available. A lane leaves lockstep when it takes another path on a conditional jump, call or return, or
+// when one of its memory accesses cannot use the direct page pointers, and then continues on its own
+// FastProcessorIntel8080, using Run(budget). Lanes do not rejoin. Code outside the ROM and invalid instructions run
+// one lane at a time.
+// The lanes run in blocks of BlockLanes, each from the start, so the memory of the lanes in lockstep stays in the cache.
+// Once fewer than MinLockstepLanes lanes of a block are left in lockstep, they run faster on their own.
+//
+// Lane instructions per second for 64 lanes, against SetLockstep(false), which runs every lane on
+// FastProcessorIntel8080::Run(budget), x86-64, gcc -O2:
+//                                      lockstep        Run(budget)
+//   checksum over 256 bytes            ~ 290 MIPS      ~ 115 MIPS
+//   BCD addition over 16 bytes         ~ 200 MIPS      ~ 120 MIPS
+//   byte copy through a subroutine     ~ 145 MIPS      ~ 100 MIPS
+//   maximum, branching on the data     ~ 100 MIPS      ~ 100 MIPS (the lanes diverge at once)
+// With fewer lanes than MinLockstepLanes both run at the speed of Run(budget).
+//
+// The results, including registers.cycleCountTotal, are those of running every lane on its own from the start up to
+// the cycle limit, which is what SetLockstep(false) does.
+class LockstepRunnerIntel8080
+{
+public:
+    static const size_t DefaultMaxCycles = BatchRunnerIntel8080::DefaultMaxCycles;
+    static const size_t VectorLanes = 8;
+    static const size_t BlockLanes = 64;
+    static const size_t MinLockstepLanes = 4;
+
+    LockstepRunnerIntel8080(size_t maxCycles = DefaultMaxCycles);
+    virtual ~LockstepRunnerIntel8080();
+
+    size_t MaxCycles() const { return maxCycles; }
+    void SetLockstep(bool enable) { lockstep = enable; }
+    bool GetLockstep() const { return lockstep; }
+
+    BatchResultsIntel8080 Run(Assembler::ObjectCode const & objectCode, std::vector<LockstepInputIntel8080> const & inputs);
+
+    // Lanes of the last run
+    size_t LaneCount() const { return laneCount; }
+    RAMPtr GetRAM(size_t lane) const;
+    IOPortPtr GetIOPort(size_t lane) const;
+    LockstepStatisticsIntel8080 const & GetStatistics() const { return statistics; }
+
+    friend struct LockstepHandlersIntel8080;
+
+private:
+    struct Lane
+    {
+        FastProcessorIntel8080 processor;
+        MemoryManagerPtr memoryManager;
+        RAMPtr ram;
+        IOManagerPtr ioManager;
+        IOPortPtr ioPort;
+    };
+
+    size_t maxCycles;
+    bool lockstep;
+    ROMPtr rom;
+    std::vector<std::unique_ptr<Lane>> lanes;
+    size_t laneCount;
+    LockstepStatisticsIntel8080 statistics;
+
+    // Lockstep state. The program counter and interrupt enable are the same for all lanes in lockstep,
+    // the arrays have an entry per lane, padded to a multiple of VectorLanes.
+    uint16_t pc;
+    bool ie;
+    size_t cycles;
+    uint8_t lastCycles;
+    bool lastCyclesPerLane;
+    std::vector<uint16_t> sp;
+    std::vector<uint16_t> bc;
+    std::vector<uint16_t> de;
+    std::vector<uint16_t> hl;
+    std::vector<uint16_t> wz;
+    std::vector<uint16_t> a;
+    std::vector<uint16_t> flags;
+    std::vector<uint16_t> operand;          // Memory operand of the current instruction
+    std::vector<uint16_t> nextPC;           // Program counter after a jump, call or return
+    std::vector<uint8_t> laneCycles;        // Cycles of a conditional instruction
+    std::vector<int64_t> cycleAdjust;       // Cycles differing from the lockstep count
+    int64_t maxCycleAdjust;                 // Largest of cycleAdjust, bounding the cycles of all lanes
+    std::vector<size_t> activeLanes;        // Lanes in lockstep, in ascending order
+    std::vector<MemoryManager *> laneMemory;    // Memory of every lane, without going through lanes[]
+
+    void SetupLanes(size_t codeOffset, size_t codeSize, size_t count);
+    void RunLockstep();
+    void RunBlock();
+    void Leave(size_t lane, uint16_t pc, bool halted);
+    void RunScalar(size_t lane, BatchResultIntel8080 & result);
+};
+
+} // namespace Emulator
@@ -1,28 +1,150 @@
 #pragma once
 
+#include <functional>
 #include <memory>
+#include <utility>
 #include <vector>
+#include "osal/flagoperators.h"
 #include "emulator/IMemory.h"
 
 namespace Emulator
 {
 
+// Kinds of memory access, used as page trap bits
+enum class MemoryAccess : uint8_t
+{
+    None = 0x00,
+    Read = 0x01,
+    Write = 0x02,
+    Execute = 0x04,     // Instruction fetch through FetchOpcode8()
+};
+DEFINE_FLAG_OPERATORS(MemoryAccess, uint8_t);
+
+// Page descriptor for the direct memory map.
+// A null read or write pointer means the access cannot be served directly (unmapped, ROM write,
+// a page shared by several blocks, a page with watched stores or traps, or a clean page while tracking dirty pages)
+// and has to go through the owning memory block.
+struct MemoryPage
+{
+    uint8_t const * read;
+    uint8_t * write;
+    uint8_t * contents;         // Direct pointer to RAM contents, also when write is blocked
+    uint8_t const * data;       // Direct pointer to RAM or ROM contents, also when read is blocked
+    uint16_t storeWatchers;     // Number of WatchStores() requests for this page, stores are reported while non-zero
+    bool dirty;                 // Stored to since dirty pages were last cleared (only maintained while tracking)
+    MemoryAccess traps;         // Accesses to this page reported through the access callback
+
+    MemoryPage()
+        : read()
+        , write()
+        , contents()
+        , data()
+        , storeWatchers()
+        , dirty()
+        , traps()
+    {}
+};
+
 using MemoryVector = std::vector<IMemoryPtr>;
+using MemoryPageVector = std::vector<MemoryPage>;
+
 class MemoryManager : public IMemory
 {
 public:
+    using StoreCallback = std::function<void(size_t address)>;
+    using StoreSubscription = size_t;
+    using AccessCallback = std::function<void(size_t address, MemoryAccess access, uint8_t data)>;
+
+    static const size_t AddressSpaceSize = 0x10000;
+    static const size_t DefaultPageSizeBits = 8;
+
     MemoryManager();
+    MemoryManager(size_t pageSizeBits);
     virtual ~MemoryManager();
 
     void AddMemory(IMemoryPtr memory);
+    MemoryVector const & GetMemoryBlocks() const { return memoryBlocks; }
 
     size_t Offset() const override;
     size_t Size() const override;
+    size_t PageSize() const { return size_t{ 1 } << pageSizeBits; }
+    MemoryPage const & GetPage(size_t address) const { return pages[address >> pageSizeBits]; }
+
+    // Stores to watched pages take the slow path and are reported to every store subscriber after completing.
+    // Several users (e.g. engines sharing the memory) can subscribe, each removes only its own subscription by the
+    // token returned. Requests to watch a page nest: it is watched until every WatchStores(address, true) has been
+    // matched by a WatchStores(address, false).
+    StoreSubscription SubscribeStores(StoreCallback const & callback);
+    void UnsubscribeStores(StoreSubscription subscription);
+    void WatchStores(size_t address, bool watch);
+    bool IsWatchingStores(size_t address) const
+    {
+        return (address < AddressSpaceSize) && (pages[address >> pageSizeBits].storeWatchers != 0);
+    }
+
+    // Access traps for debugging. Trapped accesses to a page take the slow path, and are reported to the
+    // access callback after reading or storing. Untrapped pages are not affected at all.
+    // Execute traps also block the direct read pointer, as instruction fetches share it with reads.
+    // Only the processor accesses (Fetch8() - Fetch64(), FetchOpcode8(), Store8() - Store64()) are reported,
+    // bulk Fetch() and Store() are not.
+    void SetAccessCallback(AccessCallback const & callback) { accessCallback = callback; }
+    void SetTraps(size_t address, MemoryAccess traps);
+    MemoryAccess GetTraps(size_t address) const
+    {
+        return (address < AddressSpaceSize) ? pages[address >> pageSizeBits].traps : MemoryAccess::None;
+    }
+    bool HasTraps() const { return trappedPages != 0; }
+
+    // Dirty page tracking. Clean pages lose their direct write pointer, so only the first store to a page
+    // after clearing takes the slow path. With tracking disabled the store path is not affected at all.
+    void TrackDirtyPages(bool track);
+    bool IsTrackingDirtyPages() const { return trackDirtyPages; }
+    bool IsDirty(size_t address) const
+    {
+        return (address < AddressSpaceSize) && pages[address >> pageSizeBits].dirty;
+    }
+    // Start addresses of all dirty pages, in ascending order
+    std::vector<size_t> GetDirtyPages() const;
+    void ClearDirtyPages();
 
     std::vector<uint8_t> Fetch(size_t address, size_t size) const override;
     void Store(size_t address, std::vector<uint8_t> const & data) override;
-    uint8_t Fetch8(size_t address) const override;
-    void Store8(size_t address, uint8_t data) override;
+    void Fetch(size_t address, uint8_t * data, size_t size) const override;
+    void Store(size_t address, uint8_t const * data, size_t size) override;
+    uint8_t Fetch8(size_t address) const override final
+    {
+        if (address < AddressSpaceSize)
+        {
+            MemoryPage const & page = pages[address >> pageSizeBits];
+            if (page.read)
+                return page.read[address & pageMask];
+        }
+        return FetchBlock8(address);
+    }
+    // Fetch of an instruction opcode, only differs from Fetch8() for pages with traps
+    uint8_t FetchOpcode8(size_t address) const
+    {
+        if (address < AddressSpaceSize)
+        {
+            MemoryPage const & page = pages[address >> pageSizeBits];
+            if (page.read)
+                return page.read[address & pageMask];
+        }
+        return FetchOpcodeBlock8(address);
+    }
+    void Store8(size_t address, uint8_t data) override final
+    {
+        if (address < AddressSpaceSize)
+        {
+            MemoryPage const & page = pages[address >> pageSizeBits];
+            if (page.write)
+            {
+                page.write[address & pageMask] = data;
+                return;
+            }
+        }
+        StoreBlock8(address, data);
+    }
     uint16_t Fetch16(size_t address) const override;
     void Store16(size_t address, uint16_t data) override;
     uint32_t Fetch32(size_t address) const override;
@@ -32,8 +154,53 @@ public:
 
 protected:
     MemoryVector memoryBlocks;
+    size_t pageSizeBits;
+    size_t pageMask;
+    MemoryPageVector pages;
+    std::vector<std::pair<StoreSubscription, StoreCallback>> storeSubscribers;
+    StoreSubscription nextStoreSubscription;
+    AccessCallback accessCallback;
+    size_t trappedPages;
+    bool trackDirtyPages;
 
     IMemoryPtr FindMemoryBlockForOffsetSize(size_t offset) const;
+    void MapPages(IMemoryPtr memory);
+    uint8_t FetchBlock8(size_t address) const;
+    uint8_t FetchOpcodeBlock8(size_t address) const;
+    void StoreBlock8(size_t address, uint8_t data);
+    void NotifyStore(size_t address)
+    {
+        if (IsWatchingStores(address))
+            NotifySubscribers(address);
+    }
+    void NotifySubscribers(size_t address);
+    void NotifyStores(size_t address, size_t size);
+    void NotifyAccess(size_t address, MemoryAccess access, uint8_t data) const
+    {
+        if ((address < AddressSpaceSize) && ((pages[address >> pageSizeBits].traps & access) != MemoryAccess::None) && accessCallback)
+            accessCallback(address, access, data);
+    }
+    void UpdateRead(MemoryPage & page)
+    {
+        page.read = ((page.traps & (MemoryAccess::Read | MemoryAccess::Execute)) != MemoryAccess::None) ? nullptr : page.data;
+    }
+    void UpdateWrite(MemoryPage & page)
+    {
+        page.write = ((page.storeWatchers != 0) || ((page.traps & MemoryAccess::Write) != MemoryAccess::None) || (trackDirtyPages && !page.dirty))
+                   ? nullptr : page.contents;
+    }
+    void MarkDirty(size_t address)
+    {
+        if (!trackDirtyPages || (address >= AddressSpaceSize))
+            return;
+        MemoryPage & page = pages[address >> pageSizeBits];
+        if (!page.dirty)
+        {
+            page.dirty = true;
+            UpdateWrite(page);
+        }
+    }
+    void MarkDirty(size_t address, size_t size);
 };
 
 using MemoryManagerPtr = std::shared_ptr<MemoryManager>;
@@ -0,0 +1,138 @@
+#pragma once
+
+#include <cstdint>
+#include <memory>
+#include <vector>
+#include "emulator/IOManager.h"
+#include "emulator/MemoryManager.h"
+#include "emulator/ProcessorIntel8080.h"
+
+namespace Emulator
+{
+
+// How the processors of a MultiProcessorSystemIntel8080 share the host
+enum class SchedulingIntel8080
+{
+    Deterministic,      // All processors on the calling thread, one quantum each in turn, in the order they were added
+    Threaded,           // Every processor on its own host thread, synchronizing every SyncQuanta quanta
+};
+
+struct MultiProcessorStatisticsIntel8080
+{
+    size_t syncs;               // Sync points: every round of quanta when deterministic, every barrier when threaded
+    size_t quanta;              // Quanta in which a processor executed instructions
+    uint64_t quantumCycles;     // Cycles executed in these quanta, including the last instruction overrunning the quantum,
+                                // not counting the cycles spent halted
+    size_t minQuantumCycles;
+    size_t maxQuantumCycles;
+    size_t haltedQuanta;        // Quanta in which a processor spent time halted
+    size_t sharedPageWrites;    // Shared memory pages written, counted once per processor and sync point
+    size_t contendedPages;      // Shared memory pages written by more than one processor between two sync points
+    size_t contendedSyncs;      // Sync points with at least one contended page
+
+    MultiProcessorStatisticsIntel8080()
+        : syncs()
+        , quanta()
+        , quantumCycles()
+        , minQuantumCycles()
+        , maxQuantumCycles()
+        , haltedQuanta()
+        , sharedPageWrites()
+        , contendedPages()
+        , contendedSyncs()
+    {}
+    double MeanQuantumCycles() const
+    {
+        return (quanta != 0) ? double(quantumCycles) / double(quanta) : 0.0;
+    }
+    double ContentionRate() const
+    {
+        return (syncs != 0) ? double(contendedSyncs) / double(syncs) : 0.0;
+    }
+    void Add(MultiProcessorStatisticsIntel8080 const & other);
+};
+
+// A board with several 8080 family processors sharing memory.
+// Every processor gets its own MemoryManager, holding the shared memory blocks followed by its private ones,
+// so the processors see the shared memory at the same addresses, and their engines keep their own page state.
+// IO goes through the IOManager of the system, unless a processor is added with its own.
+//
+// Processors are interleaved by quanta of emulated cycles on a common time line, the cycleCountTotal of every processor.
+// A processor runs until its time reaches the end of the quantum, so it may overrun the quantum by one instruction,
+// and starts the next quantum that much later. Time passes on a halted processor through its own Run(budget), so
+// events due within the quantum run at their deadline. With nothing scheduled it waits for the end of the quantum.
+//
+// Deterministic scheduling gives the same interleaving of shared memory accesses, and so the same results, on every run.
+// Threaded scheduling lets the processors race between the sync points, for throughput. Shared memory accesses are then
+// not synchronized, and devices shared between processors have to be thread safe.
+// Stores of one processor do not invalidate translations of the others, so the engines running translated code
+// must not execute code in shared memory that other processors write.
+//
+// Contention is measured per page of shared memory, through dirty page tracking: a page is contended when
+// more than one processor wrote to it between two sync points.
+class MultiProcessorSystemIntel8080
+{
+public:
+    static const size_t DefaultQuantum = 1000;
+    static const size_t DefaultSyncQuanta = 16;
+
+    MultiProcessorSystemIntel8080(size_t quantum = DefaultQuantum);
+    virtual ~MultiProcessorSystemIntel8080();
+
+    // Shared memory is also added to processors added later
+    void AddSharedMemory(IMemoryPtr memory);
+    // Returns the index of the processor. A null ioManager selects the IOManager of the system.
+    size_t AddProcessor(std::shared_ptr<ProcessorIntel8080> processor, IOManagerPtr ioManager = nullptr);
+    void AddPrivateMemory(size_t index, IMemoryPtr memory);
+
+    size_t ProcessorCount() const { return processors.size(); }
+    ProcessorIntel8080 & GetProcessor(size_t index) const;
+    MemoryManagerPtr GetMemoryManager(size_t index) const;
+    IOManagerPtr GetIOManager() const { return ioManager; }
+
+    void SetQuantum(size_t cycles);
+    size_t GetQuantum() const { return quantum; }
+    void SetScheduling(SchedulingIntel8080 scheduling) { this->scheduling = scheduling; }
+    SchedulingIntel8080 GetScheduling() const { return scheduling; }
+    // Quanta every processor runs between sync points with threaded scheduling
+    void SetSyncQuanta(size_t quanta);
+    size_t GetSyncQuanta() const { return syncQuanta; }
+
+    // Reset all processors and the time line
+    void Reset();
+    // Run all processors for budget cycles, or until all of them are halted with no event or interrupt to wake them up.
+    // Returns the number of cycles the time line advanced.
+    uint64_t Run(uint64_t budget);
+    uint64_t Now() const { return now; }
+    bool IsStopped() const;
+
+    MultiProcessorStatisticsIntel8080 const & GetStatistics() const { return statistics; }
+    void ResetStatistics() { statistics = MultiProcessorStatisticsIntel8080(); }
+
+private:
+    struct ThreadedRun;
+    class Worker;
+    struct Node
+    {
+        std::shared_ptr<ProcessorIntel8080> processor;
+        MemoryManagerPtr memoryManager;
+    };
+
+    size_t quantum;
+    size_t syncQuanta;
+    SchedulingIntel8080 scheduling;
+    IOManagerPtr ioManager;
+    std::vector<IMemoryPtr> sharedMemory;
+    std::vector<Node> processors;
+    uint64_t now;
+    MultiProcessorStatisticsIntel8080 statistics;
+    std::vector<size_t> pageWriters;    // Processors writing every page since the last sync point
+
+    uint64_t RunDeterministic(uint64_t end);
+    uint64_t RunThreaded(uint64_t end);
+    void RunQuantum(size_t index, uint64_t end, MultiProcessorStatisticsIntel8080 & quantumStatistics);
+    bool IsShared(size_t address) const;
+    void Sync();
+}; // MultiProcessorSystemIntel8080
+
+} // namespace Emulator
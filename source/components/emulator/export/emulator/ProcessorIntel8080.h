@@ -9,6 +9,8 @@
 #include "emulator/ROM.h"
 #include "emulator/RAM.h"
 #include "emulator/IOPort.h"
+#include "emulator/EventScheduler.h"
+#include "emulator/InterruptControllerIntel8080.h"
 
 namespace Emulator
 {
@@ -114,7 +116,7 @@ public:
     FlagsIntel8080 flags;
     bool ie;
     uint8_t instructionCycles;
-    size_t cycleCount;
+    int64_t cycleCount;         // Cycles left until the next call to Loop()
     size_t cycleCountPeriod;    // Set cycleCountPeriod to number of CPU cycles between calls to Loop()
     size_t cycleCountBackup;    // Private, don't touch
     size_t cycleCountTotal;     // Total cycles executed since last reset
@@ -190,11 +192,49 @@ struct InstructionDataIntel8080
     }
 };
 
+// Result of the periodic handler Loop(): the address of the restart routine of an interrupt to deliver, or one of these
+enum class InterruptFlagsIntel8080 : uint16_t
+{
+    None = 0xFFFF,      // No interrupt required
+    Quit = 0xFFFE,      // Stop running
+};
+
+// Emulated time skipped by Run(budget) instead of executing instructions: halted time, and idle loops with idle skipping enabled
+struct IdleStatisticsIntel8080
+{
+    size_t haltSkips;           // Number of times a halted processor was moved on to the next event
+    uint64_t haltCycles;
+    size_t loopSkips;           // Number of times iterations of an idle loop were skipped
+    uint64_t loopCycles;
+
+    IdleStatisticsIntel8080()
+        : haltSkips()
+        , haltCycles()
+        , loopSkips()
+        , loopCycles()
+    {}
+    uint64_t SkippedCycles() const { return haltCycles + loopCycles; }
+    // Emulated cycles per cycle actually executed, > 1 is a gain
+    double Speedup(uint64_t totalCycles) const
+    {
+        uint64_t skipped = SkippedCycles();
+        return (totalCycles > skipped) ? double(totalCycles) / double(totalCycles - skipped) : 1.0;
+    }
+};
+
+class ProfilerIntel8080;
+class CoverageMapIntel8080;
+class ReplayLogIntel8080;
+class TraceRecorderIntel8080;
+struct LockstepHandlersIntel8080;
+
 class ProcessorIntel8080 : public IProcessor<RegistersIntel8080, uint16_t, uint8_t>
 {
 public:
     using MemoryAddressType = uint16_t;
     using IOAddressType = uint8_t;
+    using LoopCallback = std::function<InterruptFlagsIntel8080(RegistersIntel8080 &)>;
+
     ProcessorIntel8080();
     virtual ~ProcessorIntel8080();
 
@@ -209,6 +249,24 @@ public:
 
     bool RunInstruction() override;
     void Run() override;
+    // Run until at least budget cycles are spent, the processor stops, or Loop() returns Quit.
+    // With a non-zero cycleCountPeriod, Loop() is called every time cycleCount runs out.
+    // Scheduled events run when cycleCountTotal reaches their deadline, pending interrupts are
+    // accepted as soon as interrupts are enabled.
+    // Time passes on a halted processor up to the next event, period end or the end of the budget in a single step,
+    // so an interrupt raised by an event or Loop() ends the halt. A halted processor with neither a period nor
+    // an event left to pass the time with has stopped, and Run(budget) returns.
+    // Returns the number of cycles executed, including the cycles spent halted.
+    virtual size_t Run(size_t budget);
+
+    // With idle skipping, FastProcessorIntel8080 and the engines derived from it also skip the iterations of
+    // idle loops in Run(budget), see FastProcessorIntel8080. The engines running translated code fall back to
+    // the FastProcessorIntel8080 handlers for this.
+    // The cycles skipped count as executed in the result of Run(budget), cycleCount and cycleCountTotal.
+    void SetIdleSkipping(bool enable) { idleSkipping = enable; }
+    bool GetIdleSkipping() const { return idleSkipping; }
+    IdleStatisticsIntel8080 const & GetIdleStatistics() const { return idleStatistics; }
+    void ResetIdleStatistics() { idleStatistics = IdleStatisticsIntel8080(); }
 
     RegistersIntel8080 & GetRegisters() override { return registers; }
     MemoryManagerPtr GetMemoryManager() const override { return memoryManager; }
@@ -224,8 +282,31 @@ public:
         debugEnabled = false;
         debugCallback = nullptr;
     }
+    void SetupLoop(LoopCallback const & callback) { loopCallback = callback; }
+    // Profile every instruction run from now on, nullptr stops profiling. The profiler is not owned.
+    void SetProfiler(ProfilerIntel8080 * profiler) { this->profiler = profiler; }
+    ProfilerIntel8080 * GetProfiler() const { return profiler; }
+    // Record the edges of every instruction run from now on, nullptr stops recording. The map is not owned.
+    void SetCoverage(CoverageMapIntel8080 * coverage) { this->coverage = coverage; }
+    CoverageMapIntel8080 * GetCoverage() const { return coverage; }
+    // Set by ReplayLogIntel8080::StartRecording() and StartReplay(), the log is not owned
+    void SetReplayLog(ReplayLogIntel8080 * replayLog) { this->replayLog = replayLog; }
+    ReplayLogIntel8080 * GetReplayLog() const { return replayLog; }
+    // Set by TraceRecorderIntel8080::Start() and Stop(), the recorder is not owned
+    void SetTraceRecorder(TraceRecorderIntel8080 * traceRecorder) { this->traceRecorder = traceRecorder; }
+    TraceRecorderIntel8080 * GetTraceRecorder() const { return traceRecorder; }
+
+    // Events and interrupt requests are only acted upon by Run(budget).
+    // Deadlines are in cycles on the cycleCountTotal time line.
+    EventScheduler & GetScheduler() { return scheduler; }
+    InterruptControllerIntel8080 & GetInterruptController() { return interruptController; }
+    uint64_t Now() const { return registers.cycleCountTotal; }
+
+    static InstructionDataIntel8080 const & GetInstructionData(OpcodesIntel8080 opcode) { return instruction8080[uint8_t(opcode)]; }
 
     friend std::ostream & Emulator::operator << (std::ostream & stream, OpcodesIntel8080 opcode);
+    friend class ReplayLogIntel8080;
+    friend struct LockstepHandlersIntel8080;
 
 protected:
     MemoryManagerPtr memoryManager;
@@ -234,7 +315,30 @@ protected:
     OpcodesIntel8080 instruction;
     bool debugEnabled;
     DebugCallback debugCallback;
+    LoopCallback loopCallback;
     bool isForcedToHalt;
+    EventScheduler scheduler;
+    InterruptControllerIntel8080 interruptController;
+    ProfilerIntel8080 * profiler;
+    CoverageMapIntel8080 * coverage;
+    ReplayLogIntel8080 * replayLog;
+    TraceRecorderIntel8080 * traceRecorder;
+    bool idleSkipping;
+    IdleStatisticsIntel8080 idleStatistics;
+
+    virtual InterruptFlagsIntel8080 Loop();
+    bool PeriodElapsed();
+    void HandleInterrupt(InterruptFlagsIntel8080 interrupt);
+    void DeliverInterrupt(uint16_t address);
+    uint8_t InPort(uint8_t port);
+    bool EventsDue() const
+    {
+        return (scheduler.NextDeadline() <= registers.cycleCountTotal) || (registers.ie && interruptController.IsPending());
+    }
+    size_t EventSliceLength(size_t limit) const;
+    void ServiceEvents();
+    void AcceptInterrupt();
+    bool SkipHalted(size_t & cycles, size_t budget);
 
     uint8_t FetchInstructionByte();
     bool IsHalted() { return registers.isHalted | isForcedToHalt; }
@@ -0,0 +1,42 @@
+#pragma once
+
+#include "emulator/FastProcessorIntel8080.h"
+
+namespace Emulator
+{
+
+// Intel 8085, on the handler engine of FastProcessorIntel8080 with its handlers instantiated for CPUVariantIntel8085:
+// the 8085 timings, the V (overflow) and K flags, RIM and SIM, and the undocumented instructions
+// DSUB, ARHL, RDEL, LDHI, LDSP, RSTV, SHLX, JNK, LHLX and JK.
+// The 8080 engines are not affected, every difference is resolved when the handler tables are compiled.
+//
+// K is set by INX / DCX when the register pair wraps around, and by the 8 bit arithmetic instructions as the result
+// of a signed comparison (S xor V). Flags are always evaluated eagerly, SetLazyFlags() has no effect.
+// The RST 5.5, 6.5 and 7.5 inputs are not modelled, only their masks as set by SIM and read by RIM.
+class ProcessorIntel8085 : public FastProcessorIntel8080
+{
+public:
+    ProcessorIntel8085();
+    virtual ~ProcessorIntel8085();
+
+    void Reset() override;
+
+    // M5.5, M6.5 and M7.5 in bits 0 - 2
+    uint8_t GetInterruptMasks() const { return interruptMasks; }
+    // SID is read by RIM, SOD is written by SIM
+    void SetSerialInput(bool level) { serialInput = level; }
+    bool GetSerialOutput() const { return serialOutput; }
+
+    template<class Variant, bool Decoded>
+    friend struct InstructionHandlersIntel8080;
+    friend class SnapshotIntel8080;
+
+protected:
+    static const InstructionHandler * const instructionHandlers8085;
+
+    uint8_t interruptMasks;
+    bool serialInput;
+    bool serialOutput;
+}; // ProcessorIntel8085
+
+} // namespace Emulator
@@ -0,0 +1,208 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <iostream>
+#include <map>
+#include <string>
+#include <vector>
+#include "core/String.h"
+
+namespace Emulator
+{
+
+struct ProfileCountersIntel8080
+{
+    uint64_t executions;
+    uint64_t cycles;
+    uint64_t taken;             // Conditional jumps, calls and returns only
+    uint64_t notTaken;
+
+    ProfileCountersIntel8080()
+        : executions()
+        , cycles()
+        , taken()
+        , notTaken()
+    {}
+};
+
+// Node in the call tree, one for every distinct path of calls from the entry point
+struct CallNodeIntel8080
+{
+    uint16_t function;          // Address called
+    size_t parent;
+    uint64_t calls;
+    uint64_t selfCycles;        // Cycles spent in the function itself, not in its callees
+    std::map<uint16_t, size_t> children;
+
+    CallNodeIntel8080(uint16_t function, size_t parent)
+        : function(function)
+        , parent(parent)
+        , calls()
+        , selfCycles()
+        , children()
+    {}
+};
+
+// Address to label, see ProfilerIntel8080::MakeSymbolTable()
+using SymbolTableIntel8080 = std::map<uint16_t, std::string>;
+
+// Execution profile of a processor, attached with ProcessorIntel8080::SetProfiler().
+// Counts executions, cycles and taken / not taken branches for every address in a preallocated table,
+// and builds a call tree from CALL, RST and RET. A return is matched with the call that pushed its return address,
+// so code dropping or replacing return addresses on the stack does not corrupt the tree.
+// Interrupts are not tracked as calls, the cycles of interrupt routines are counted in the function interrupted.
+//
+// The engines running translated code use the handlers of FastProcessorIntel8080 while a profiler is attached.
+// Without a profiler the run loops are the same as before, define EMULATOR_NO_PROFILER to compile the profiling out completely.
+// With a profiler and nothing else attached FastProcessorIntel8080 runs a loop of its own, recording through a Recorder.
+// Conditional jumps are counted inline, only calls and returns leave the loop for RecordControlFlow().
+//
+// emulator-benchmark -f multiply3x7, engines fast and fast+profiler, median times, x86-64, gcc -O2:
+//   FastProcessorIntel8080::Run()                      ~ 190 MIPS
+//   FastProcessorIntel8080::Run() with a profiler      ~ 175 MIPS, 5 - 10% slower over several runs
+class ProfilerIntel8080
+{
+private:
+    enum class ControlFlow : uint8_t;
+
+public:
+    static const size_t AddressSpaceSize = 0x10000;
+    static const size_t MaxCallDepth = 256;
+    static const size_t Root = 0;
+
+    explicit ProfilerIntel8080(uint16_t entry = 0);
+    virtual ~ProfilerIntel8080();
+
+    void Reset();
+
+    // Called by the processor after executing the instruction at pc, with nextPC the address of the next instruction
+    void Record(uint16_t pc, uint8_t opcode, uint16_t nextPC, size_t cycles)
+    {
+        ProfileCountersIntel8080 & counter = counters[pc];
+        ++counter.executions;
+        counter.cycles += cycles;
+        totalCycles += cycles;
+        ControlFlow flow = controlFlow[opcode];
+        if (flow == ControlFlow::Jump)
+            CountJump(counter, pc, nextPC);
+        else if (flow != ControlFlow::None)
+            RecordControlFlow(pc, opcode, nextPC);
+    }
+
+    // Record() for the run loop of an engine. Holds the counter table and the cycle total in locals of the loop
+    // instead of going through the profiler after every instruction, and writes the total back when it goes out of scope.
+    class Recorder
+    {
+    public:
+        explicit Recorder(ProfilerIntel8080 & profiler)
+            : profiler(profiler)
+            , counters(profiler.counters.data())
+            , controlFlow(profiler.controlFlow)
+            , totalCycles(profiler.totalCycles)
+        {}
+        ~Recorder()
+        {
+            profiler.totalCycles = totalCycles;
+        }
+
+        void Record(uint16_t pc, uint8_t opcode, uint16_t nextPC, size_t cycles)
+        {
+            ProfileCountersIntel8080 & counter = counters[pc];
+            ++counter.executions;
+            counter.cycles += cycles;
+            totalCycles += cycles;
+            ControlFlow flow = controlFlow[opcode];
+            if (flow == ControlFlow::Jump)
+                CountJump(counter, pc, nextPC);
+            else if (flow != ControlFlow::None)
+            {
+                profiler.totalCycles = totalCycles;
+                profiler.RecordControlFlow(pc, opcode, nextPC);
+            }
+        }
+
+    private:
+        ProfilerIntel8080 & profiler;
+        ProfileCountersIntel8080 * counters;
+        ControlFlow const * controlFlow;
+        uint64_t totalCycles;
+    };
+
+    ProfileCountersIntel8080 const & GetCounters(uint16_t address) const { return counters[address]; }
+    std::vector<CallNodeIntel8080> const & GetCallTree() const
+    {
+        UpdateCurrentNode();
+        return nodes;
+    }
+    uint64_t TotalCycles() const { return totalCycles; }
+    uint64_t TotalInstructions() const;
+
+    // Hotspots by function (the nearest label at or below an address) and by address, hottest first
+    void WriteFlat(std::ostream & stream, SymbolTableIntel8080 const & symbols, size_t maxAddresses = size_t(-1)) const;
+    // Calls, inclusive and self cycles for every path in the call tree
+    void WriteCallTree(std::ostream & stream, SymbolTableIntel8080 const & symbols) const;
+    // One line per call path with its self cycles, "START;MAIN;MULT 1234", the input of flamegraph.pl
+    void WriteFolded(std::ostream & stream, SymbolTableIntel8080 const & symbols) const;
+
+    // Label of an address: "MULT", "MULT+3" or "0123" without a label at or below the address
+    static std::string Describe(SymbolTableIntel8080 const & symbols, uint16_t address);
+
+    // Symbol table from the labels of an assembler parser (CPUParserIntel8080_8085::GetLabels()).
+    // The first label in name order wins when several labels share an address.
+    template<class Labels>
+    static SymbolTableIntel8080 MakeSymbolTable(Labels const & labels)
+    {
+        SymbolTableIntel8080 symbols;
+        for (auto const & entry : labels)
+        {
+            if (entry.second.locationDefined)
+                symbols.insert(std::make_pair(uint16_t(entry.second.location), Core::String::ToString(entry.second.name)));
+        }
+        return symbols;
+    }
+
+private:
+    enum class ControlFlow : uint8_t
+    {
+        None,
+        Jump,                   // Conditional jump
+        Call,
+        ConditionalCall,
+        Return,
+        ConditionalReturn,
+    };
+    struct Frame
+    {
+        uint16_t returnAddress;
+        size_t node;
+    };
+
+    uint16_t entry;
+    std::vector<ProfileCountersIntel8080> counters;
+    mutable std::vector<CallNodeIntel8080> nodes;
+    std::vector<Frame> callStack;
+    size_t currentNode;
+    uint64_t totalCycles;
+    mutable uint64_t nodeStartCycles;   // totalCycles when the self cycles of currentNode were last updated
+    ControlFlow controlFlow[256];
+
+    // Conditional jumps are counted inline, they are frequent and do not change the call tree
+    static void CountJump(ProfileCountersIntel8080 & counter, uint16_t pc, uint16_t nextPC)
+    {
+        ++*((nextPC == uint16_t(pc + 3)) ? &counter.notTaken : &counter.taken);
+    }
+    void RecordControlFlow(uint16_t pc, uint8_t opcode, uint16_t nextPC);
+    // The self cycles of the current node are only added up when leaving it, or when the tree is read
+    void UpdateCurrentNode() const
+    {
+        nodes[currentNode].selfCycles += totalCycles - nodeStartCycles;
+        nodeStartCycles = totalCycles;
+    }
+    std::vector<uint64_t> InclusiveCycles() const;
+    void WriteCallTree(std::ostream & stream, SymbolTableIntel8080 const & symbols, std::vector<uint64_t> const & inclusive,
+                       size_t node, size_t depth) const;
+    void WriteFolded(std::ostream & stream, SymbolTableIntel8080 const & symbols, std::string const & path, size_t node) const;
+};
+
+} // namespace Emulator
@@ -16,9 +16,12 @@ public:
 
     size_t Offset() const override;
     size_t Size() const override;
+    uint8_t const * Data() const { return contents.data(); }
 
     std::vector<uint8_t> Fetch(size_t address, size_t size) const override;
     void Store(size_t address, std::vector<uint8_t> const & data) { throw std::runtime_error("Can't write to ROM"); }
+    void Fetch(size_t address, uint8_t * data, size_t size) const override;
+    void Store(size_t address, uint8_t const * data, size_t size) { throw std::runtime_error("Can't write to ROM"); }
     uint8_t Fetch8(size_t address) const override;
     void Store8(size_t address, uint8_t data) { throw std::runtime_error("Can't write to ROM"); }
     uint16_t Fetch16(size_t address) const override;
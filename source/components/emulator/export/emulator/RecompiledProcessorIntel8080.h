@@ -0,0 +1,131 @@
+#pragma once
+
+#include <vector>
+#include "emulator/FastProcessorIntel8080.h"
+
+namespace Emulator
+{
+
+class RecompiledProcessorIntel8080;
+
+// Generated function for one basic block. Executes the block, leaves pc at the next instruction to run
+// and returns the number of machine states taken.
+using RecompiledFunctionIntel8080 = size_t (*)(RecompiledProcessorIntel8080 & processor);
+
+struct RecompiledBlockIntel8080
+{
+    uint16_t address;
+    uint16_t size;
+    OpcodesIntel8080 lastInstruction;
+    RecompiledFunctionIntel8080 function;
+};
+
+// Translation unit generated by RecompilerIntel8080 from an ASEG image
+struct RecompiledCodeIntel8080
+{
+    char const * name;
+    uint16_t origin;
+    uint8_t const * image;
+    size_t imageSize;
+    RecompiledBlockIntel8080 const * blocks;
+    size_t blockCount;
+};
+
+struct RecompiledStatistics
+{
+    size_t blocks;                      // Number of recompiled blocks run
+    size_t interpretedInstructions;     // Number of instructions run by the interpreter
+    size_t invalidations;               // Number of blocks discarded because their code was overwritten
+
+    RecompiledStatistics()
+        : blocks()
+        , interpretedInstructions()
+        , invalidations()
+    {}
+};
+
+// Intel 8080 engine running code recompiled ahead of time to C++ by RecompilerIntel8080.
+// Every pc with a recompiled block runs the generated function, all other code (computed jump targets
+// not found by the recompiler, code in RAM loaded at run time) goes through the handlers of
+// FastProcessorIntel8080. A store to the code of a block discards it, the rest of the program keeps
+// running recompiled.
+//
+// Load the memory first, LoadRecompiledCode() only installs blocks whose code matches the memory contents.
+// Idle skipping runs Run(budget) on the handlers instead of the recompiled blocks.
+// For its speed against the other engines see FastProcessorIntel8080.
+class RecompiledProcessorIntel8080 : public FastProcessorIntel8080
+{
+public:
+    RecompiledProcessorIntel8080();
+    virtual ~RecompiledProcessorIntel8080();
+
+    void Setup(MemoryManagerPtr memoryManager, IOManagerPtr ioManager) override;
+
+    // Returns the number of blocks installed
+    size_t LoadRecompiledCode(RecompiledCodeIntel8080 const & code);
+    void UnloadRecompiledCode();
+    size_t RecompiledBlockCount() const;
+    RecompiledStatistics const & GetStatistics() const { return statistics; }
+    void ResetStatistics() { statistics = RecompiledStatistics(); }
+
+    void Run() override;
+    size_t Run(size_t budget) override;
+
+    // Interface for the generated code
+    RegistersIntel8080 & Registers() { return registers; }
+    MemoryManager & Memory() { return *memoryManager; }
+    IOManager & IO() { return *ioManager; }
+    bool CodeModified() const { return codeModified; }
+    using ProcessorIntel8080::Add;
+    using ProcessorIntel8080::AddC;
+    using ProcessorIntel8080::Sub;
+    using ProcessorIntel8080::SubC;
+    using ProcessorIntel8080::Inc;
+    using ProcessorIntel8080::Dec;
+    using ProcessorIntel8080::AddW;
+    using ProcessorIntel8080::DAA;
+    using ProcessorIntel8080::And;
+    using ProcessorIntel8080::Or;
+    using ProcessorIntel8080::Xor;
+    using ProcessorIntel8080::Cmp;
+    using ProcessorIntel8080::RLC;
+    using ProcessorIntel8080::RRC;
+    using ProcessorIntel8080::RAL;
+    using ProcessorIntel8080::RAR;
+    using ProcessorIntel8080::Push;
+    using ProcessorIntel8080::Pop;
+
+protected:
+    std::vector<RecompiledBlockIntel8080 const *> blocks;
+    std::vector<std::vector<MemoryAddressType>> pageBlocks;
+    bool codeModified;
+    RecompiledStatistics statistics;
+    MemoryManager::StoreSubscription storeSubscription;
+
+    size_t Step()
+    {
+        RecompiledBlockIntel8080 const * block = blocks[registers.pc];
+        if (block == nullptr)
+        {
+            ++statistics.interpretedInstructions;
+            uint8_t data = memoryManager->FetchOpcode8(registers.pc);
+            ++registers.pc;
+            instruction = OpcodesIntel8080(data);
+            registers.instructionCycles = instructionHandlers[data](*this);
+            return registers.instructionCycles;
+        }
+        ++statistics.blocks;
+        MaterializeFlags();
+        codeModified = false;
+        instruction = block->lastInstruction;
+        size_t cycles = block->function(*this);
+        // A block ends with EI, which the generated code runs inline. As with the handler, a request
+        // pending is accepted after the next instruction, which starts a new slice.
+        if ((instruction == OpcodesIntel8080::EI) && interruptController.IsPending())
+            sliceEnd = 0;
+        return cycles;
+    }
+    void OnStore(size_t address);
+}; // RecompiledProcessorIntel8080
+
+} // namespace Emulator
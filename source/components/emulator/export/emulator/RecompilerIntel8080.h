@@ -0,0 +1,60 @@
+#pragma once
+
+#include <iostream>
+#include <map>
+#include <set>
+#include <string>
+#include <vector>
+#include "assembler/ObjectCode.h"
+#include "emulator/ProcessorIntel8080.h"
+
+namespace Emulator
+{
+
+// Static recompiler translating the ASEG image of an object file to a C++ translation unit for RecompiledProcessorIntel8080.
+// Code is found by recursive descent from the entry points, following fall through, jump, call and restart targets.
+// Each basic block becomes a function on RegistersIntel8080, with memory and IO going through the MemoryManager and IOManager.
+// Code only reachable through PCHL, RET to a modified address or interrupts is left to the interpreter,
+// unless its address is added as an entry point.
+//
+// The translation unit defines
+//     Emulator::RecompiledCodeIntel8080 const & Emulator::Recompiled::<name>();
+class RecompilerIntel8080
+{
+public:
+    struct Block
+    {
+        uint16_t address;
+        uint16_t size;
+        std::vector<uint16_t> instructions;
+    };
+
+    explicit RecompilerIntel8080(Assembler::ObjectCode const & objectCode);
+    RecompilerIntel8080(std::vector<uint8_t> const & image, uint16_t origin);
+    virtual ~RecompilerIntel8080();
+
+    // The origin of the image is always an entry point
+    void AddEntryPoint(uint16_t address);
+    std::vector<uint16_t> GetBlockAddresses();
+    Block const & GetBlock(uint16_t address);
+    void Generate(std::ostream & stream, std::string const & name);
+
+private:
+    std::vector<uint8_t> image;
+    uint16_t origin;
+    std::set<uint16_t> entryPoints;
+    std::map<uint16_t, Block> blocks;
+    bool discovered;
+
+    bool InImage(size_t address, size_t size = 1) const
+    {
+        return (address >= origin) && (address + size <= origin + image.size());
+    }
+    uint8_t Byte(size_t address) const { return image[address - origin]; }
+    uint16_t Word(size_t address) const { return uint16_t(Byte(address) | (Byte(address + 1) << 8)); }
+    void Discover();
+    void GenerateBlock(std::ostream & stream, Block const & block);
+    static bool EndsBlock(OpcodesIntel8080 instruction);
+};
+
+} // namespace Emulator
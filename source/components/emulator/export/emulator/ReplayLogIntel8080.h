@@ -0,0 +1,112 @@
+#pragma once
+
+#include <iostream>
+#include <vector>
+#include "emulator/EventScheduler.h"
+#include "emulator/SnapshotIntel8080.h"
+
+namespace Emulator
+{
+
+enum class ReplayEventIntel8080 : uint8_t
+{
+    In = 0,
+    Interrupt = 1,
+};
+
+struct ReplayEntryIntel8080
+{
+    uint64_t cycles;            // cycleCountTotal at the start of the IN instruction, or when the interrupt was delivered
+    ReplayEventIntel8080 event;
+    uint16_t address;           // Port read, or the restart address of the interrupt
+    uint8_t data;               // Value read
+
+    bool operator == (ReplayEntryIntel8080 const & other) const
+    {
+        return (cycles == other.cycles) && (event == other.event) && (address == other.address) && (data == other.data);
+    }
+    bool operator != (ReplayEntryIntel8080 const & other) const { return !(*this == other); }
+};
+
+using ReplayEntriesIntel8080 = std::vector<ReplayEntryIntel8080>;
+
+// State of the machine at a point of the log, entry is the index of the first entry after it
+struct ReplayCheckpointIntel8080
+{
+    size_t entry;
+    SnapshotIntel8080 snapshot;
+};
+
+enum class ReplayModeIntel8080
+{
+    Idle,
+    Recording,
+    Replaying,
+};
+
+// Deterministic record and replay of the inputs of a processor.
+// Recording logs every value read by IN and every interrupt delivered, with the cycleCountTotal it happened at.
+// Replaying feeds the values read back to IN and delivers the interrupts at exactly the same cycle,
+// interrupts from the interrupt controller or the periodic handler are ignored. The IO devices are not needed for replay,
+// but the processor must have the same RAM and IOPort layout. OUT still goes to the IO manager.
+// A replay that reads a different port or reads at a different cycle than recorded throws std::runtime_error.
+//
+// Recording can take a checkpoint every checkpointInterval cycles, an incremental snapshot of the machine which only
+// costs the pages written since the previous one. Seek() restores the last checkpoint before the target and replays from there.
+//
+// Cycles are only counted by Run(budget), so record and replay with Run(budget). While a log is attached the engines
+// running translated code use the handlers of FastProcessorIntel8080, which count cycles for every instruction.
+// Memory written by devices (e.g. DMA) is not logged.
+class ReplayLogIntel8080
+{
+public:
+    static const uint32_t Magic = 0x38303852;   // "R808"
+    static const uint16_t Version = 1;
+
+    ReplayLogIntel8080();
+    virtual ~ReplayLogIntel8080();
+
+    // Start a new log from the current state of processor, with a checkpoint at the start if checkpointInterval is not 0
+    void StartRecording(ProcessorIntel8080 & processor, uint64_t checkpointInterval = 0);
+    // Replay from the start of the log. Restores the first checkpoint if there is one, otherwise processor
+    // must be in the state recording started from.
+    void StartReplay(ProcessorIntel8080 & processor);
+    // Detach from the processor
+    void Stop();
+    // Restore the last checkpoint at or before cycles and replay up to the first instruction boundary at or after cycles
+    void Seek(uint64_t cycles);
+
+    ReplayModeIntel8080 GetMode() const { return mode; }
+    bool IsReplaying() const { return mode == ReplayModeIntel8080::Replaying; }
+    ReplayEntriesIntel8080 const & GetEntries() const { return entries; }
+    std::vector<ReplayCheckpointIntel8080> const & GetCheckpoints() const { return checkpoints; }
+    // Index of the next entry to replay
+    size_t Position() const { return position; }
+
+    // Called by the processor for every IN, and for every interrupt delivered while recording
+    uint8_t In(uint8_t port);
+    void RecordInterrupt(uint16_t address);
+
+    // Entries are stored with the cycle delta to the previous entry as a variable length number,
+    // followed by the checkpoints as snapshots
+    void Save(std::ostream & stream) const;
+    static ReplayLogIntel8080 Load(std::istream & stream);
+
+private:
+    ReplayModeIntel8080 mode;
+    ProcessorIntel8080 * processor;
+    ReplayEntriesIntel8080 entries;
+    std::vector<ReplayCheckpointIntel8080> checkpoints;
+    uint64_t checkpointInterval;
+    size_t position;
+    EventID event;
+    bool eventScheduled;
+
+    void Attach(ProcessorIntel8080 & processor, ReplayModeIntel8080 mode);
+    void CancelEvent();
+    void ScheduleCheckpoint(uint64_t deadline);
+    void ScheduleInterrupt();
+    void DeliverInterrupt();
+};
+
+} // namespace Emulator
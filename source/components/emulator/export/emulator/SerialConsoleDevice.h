@@ -0,0 +1,69 @@
+#pragma once
+
+#include <deque>
+#include <iostream>
+#include <string>
+#include "emulator/IODevice.h"
+
+namespace Emulator
+{
+
+// Serial console with a data port at base and a status port at base + 1.
+// Received bytes are queued by the host with Receive(), transmitted bytes are collected and optionally echoed to a stream.
+class SerialConsoleDevice : public IODevice
+{
+public:
+    static const size_t DataPort = 0;
+    static const size_t StatusPort = 1;
+    static const uint8_t StatusReceiveReady = 0x01;
+    static const uint8_t StatusTransmitReady = 0x02;
+
+    SerialConsoleDevice(size_t base);
+    virtual ~SerialConsoleDevice();
+
+    void Receive(std::string const & text);
+    void Receive(uint8_t const * data, size_t size);
+    size_t ReceiveQueueSize() const { return input.size(); }
+    std::vector<uint8_t> const & Transmitted() const { return output; }
+    std::string TransmittedText() const { return std::string(output.begin(), output.end()); }
+    void ClearTransmitted() { output.clear(); }
+    void SetOutputStream(std::ostream * stream) { outputStream = stream; }
+
+    uint8_t In8(size_t address) const override
+    {
+        if (address == base + DataPort)
+        {
+            if (input.empty())
+                return 0;
+            uint8_t data = input.front();
+            input.pop_front();
+            return data;
+        }
+        if (address == base + StatusPort)
+            return StatusTransmitReady | (input.empty() ? 0 : StatusReceiveReady);
+        CheckRange(address, 1, "In");
+        return 0;
+    }
+    void Out8(size_t address, uint8_t data) override
+    {
+        if (address == base + DataPort)
+            Transmit(&data, 1);
+        else
+            CheckRange(address, 1, "Out");
+    }
+    void InRepeated(size_t address, uint8_t * data, size_t count) override;
+    void OutRepeated(size_t address, uint8_t const * data, size_t count) override;
+    // Reading the status port does not consume input
+    bool IsPassiveIn(size_t address) const override { return address == base + StatusPort; }
+
+private:
+    mutable std::deque<uint8_t> input;
+    std::vector<uint8_t> output;
+    std::ostream * outputStream;
+
+    void Transmit(uint8_t const * data, size_t size);
+};
+
+using SerialConsoleDevicePtr = std::shared_ptr<SerialConsoleDevice>;
+
+} // namespace Emulator
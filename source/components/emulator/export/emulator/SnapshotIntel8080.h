@@ -0,0 +1,95 @@
+#pragma once
+
+#include <iostream>
+#include <memory>
+#include <vector>
+#include "emulator/ProcessorIntel8080.h"
+
+namespace Emulator
+{
+
+using SnapshotPage = std::vector<uint8_t>;
+using SnapshotPagePtr = std::shared_ptr<SnapshotPage const>;
+
+// Contents of a single RAM or IO block, split at memory manager page boundaries.
+// Pages are never modified after creation, so they can be shared between snapshots.
+struct SnapshotBlock
+{
+    size_t offset;
+    size_t size;
+    std::vector<SnapshotPagePtr> pages;
+
+    SnapshotBlock()
+        : offset()
+        , size()
+        , pages()
+    {}
+};
+
+using SnapshotBlockVector = std::vector<SnapshotBlock>;
+
+// Interrupt state outside the registers
+struct SnapshotInterruptsIntel8080
+{
+    uint8_t pending;            // InterruptControllerIntel8080
+    uint8_t mask;
+    bool is8085;                // The processor is a ProcessorIntel8085, the following are only used for it
+    uint8_t interruptMasks;     // M5.5, M6.5 and M7.5
+    bool serialInput;
+    bool serialOutput;
+
+    SnapshotInterruptsIntel8080()
+        : pending()
+        , mask()
+        , is8085()
+        , interruptMasks()
+        , serialInput()
+        , serialOutput()
+    {}
+};
+
+// State of an Intel 8080 machine: registers and cycle counters, the pending and masked levels of the interrupt
+// controller, for a ProcessorIntel8085 the RST 5.5 - 7.5 masks and serial lines, the contents of all RAM blocks of the
+// memory manager and of all IOPort blocks of the IO manager. ROM contents, IO devices, scheduled events, the debug
+// settings (trap, trace) and callbacks are not included.
+// Copying a snapshot only copies the page pointers, so forking many machines from one snapshot is cheap.
+// Restoring writes through MemoryManager::Store(), so a CachedProcessorIntel8080 discards blocks for changed code.
+class SnapshotIntel8080
+{
+public:
+    static const uint32_t Magic = 0x38303853;   // "S808"
+    static const uint16_t Version = 2;
+
+    SnapshotIntel8080();
+    virtual ~SnapshotIntel8080();
+
+    // Take a snapshot of the processor and its memory and IO. Pages with the same contents as in base are shared with it.
+    static SnapshotIntel8080 Take(ProcessorIntel8080 & processor, SnapshotIntel8080 const * base = nullptr);
+    // Take a snapshot while the memory manager tracks dirty pages. Only RAM pages stored to since the dirty pages were
+    // last cleared are read, all others are shared with previous, which must be the snapshot taken at that moment.
+    // Clears the dirty pages, so a chain of checkpoints each only costs the pages written in between.
+    static SnapshotIntel8080 TakeIncremental(ProcessorIntel8080 & processor, SnapshotIntel8080 const & previous);
+    // Restore into a processor set up with the same RAM and IO layout. Only pages which differ are written.
+    void Restore(ProcessorIntel8080 & processor) const;
+
+    void Save(std::ostream & stream) const;
+    static SnapshotIntel8080 Load(std::istream & stream);
+
+    RegistersIntel8080 const & GetRegisters() const { return registers; }
+    SnapshotInterruptsIntel8080 const & GetInterrupts() const { return interrupts; }
+    SnapshotBlockVector const & GetMemoryBlocks() const { return memoryBlocks; }
+    SnapshotBlockVector const & GetIOBlocks() const { return ioBlocks; }
+    size_t PageCount() const;
+    size_t SharedPageCount(SnapshotIntel8080 const & other) const;
+
+private:
+    size_t pageSize;
+    RegistersIntel8080 registers;
+    SnapshotInterruptsIntel8080 interrupts;
+    SnapshotBlockVector memoryBlocks;
+    SnapshotBlockVector ioBlocks;
+
+    static SnapshotIntel8080 TakeSnapshot(ProcessorIntel8080 & processor, SnapshotIntel8080 const * base, bool useDirtyPages);
+};
+
+} // namespace Emulator
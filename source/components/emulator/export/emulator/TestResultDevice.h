@@ -0,0 +1,42 @@
+#pragma once
+
+#include "emulator/IODevice.h"
+
+namespace Emulator
+{
+
+// Single port through which a test program reports its result: 0 for success, any other value is an error code.
+// Every byte written is kept, the first one is the result. Reading returns the result, or NoResult if none was written yet.
+class TestResultDevice : public IODevice
+{
+public:
+    static const uint8_t Passed = 0x00;
+    static const uint8_t NoResult = 0xFF;
+
+    TestResultDevice(size_t base);
+    virtual ~TestResultDevice();
+
+    bool HasResult() const { return !results.empty(); }
+    uint8_t Result() const { return results.empty() ? NoResult : results.front(); }
+    bool IsPassed() const { return HasResult() && (Result() == Passed); }
+    std::vector<uint8_t> const & Results() const { return results; }
+    void Clear() { results.clear(); }
+
+    uint8_t In8(size_t address) const override
+    {
+        CheckRange(address, 1, "In");
+        return Result();
+    }
+    void Out8(size_t address, uint8_t data) override
+    {
+        CheckRange(address, 1, "Out");
+        results.push_back(data);
+    }
+
+private:
+    std::vector<uint8_t> results;
+};
+
+using TestResultDevicePtr = std::shared_ptr<TestResultDevice>;
+
+} // namespace Emulator
@@ -0,0 +1,49 @@
+#pragma once
+
+#include "emulator/IODevice.h"
+
+namespace Emulator
+{
+
+// Programmable interval timer, driven by the emulated cycle count through Advance().
+// Ports: base = control (write) / status (read, clears the expired bit), base + 1 / base + 2 = period in ticks, low / high byte.
+// A period of 0 counts 65536 ticks.
+class TimerDevice : public IODevice
+{
+public:
+    static const size_t ControlPort = 0;
+    static const size_t PeriodLowPort = 1;
+    static const size_t PeriodHighPort = 2;
+    static const uint8_t ControlEnable = 0x01;
+    static const uint8_t ControlInterruptEnable = 0x02;
+    static const uint8_t StatusExpired = 0x80;
+    static const size_t DefaultCyclesPerTick = 100;
+
+    TimerDevice(size_t base, size_t cyclesPerTick = DefaultCyclesPerTick);
+    virtual ~TimerDevice();
+
+    // Let cycles elapse, returns the number of times the timer expired
+    size_t Advance(size_t cycles);
+    // Cycles until the timer next expires, or SIZE_MAX when not running
+    size_t CyclesUntilExpiry() const;
+    bool IsEnabled() const { return (control & ControlEnable) != 0; }
+    bool IsExpired() const { return expired; }
+    bool InterruptPending() const { return expired && ((control & ControlInterruptEnable) != 0); }
+    void AcknowledgeInterrupt() { expired = false; }
+    size_t PeriodCycles() const { return (period ? period : 0x10000) * cyclesPerTick; }
+
+    uint8_t In8(size_t address) const override;
+    void Out8(size_t address, uint8_t data) override;
+    bool IsPassiveIn(size_t address) const override;
+
+private:
+    size_t cyclesPerTick;
+    uint8_t control;
+    uint16_t period;
+    size_t remaining;
+    mutable bool expired;
+};
+
+using TimerDevicePtr = std::shared_ptr<TimerDevice>;
+
+} // namespace Emulator
@@ -0,0 +1,137 @@
+#pragma once
+
+#include <atomic>
+#include <iostream>
+#include <memory>
+#include <vector>
+#include "core/ActiveObject.h"
+#include "emulator/ProcessorIntel8080.h"
+
+namespace Emulator
+{
+
+// Fixed size trace record, stored little-endian in trace files.
+// Describes the state before executing the instruction at pc.
+struct TraceRecordIntel8080
+{
+    uint64_t cycles;            // Cycles executed since tracing started
+    uint16_t pc;
+    uint16_t sp;
+    uint16_t bc;
+    uint16_t de;
+    uint16_t hl;
+    uint8_t opcode;
+    uint8_t operand1;
+    uint8_t operand2;
+    uint8_t a;
+    uint8_t flags;
+    uint8_t status;             // StatusInterruptsEnabled
+    uint8_t reserved[8];
+
+    static const uint8_t StatusInterruptsEnabled = 0x01;
+    static const size_t Size = 32;
+
+    TraceRecordIntel8080()
+        : cycles()
+        , pc()
+        , sp()
+        , bc()
+        , de()
+        , hl()
+        , opcode()
+        , operand1()
+        , operand2()
+        , a()
+        , flags()
+        , status()
+        , reserved()
+    {}
+    bool operator == (TraceRecordIntel8080 const & other) const;
+    bool operator != (TraceRecordIntel8080 const & other) const { return !(*this == other); }
+};
+
+using TraceRecordsIntel8080 = std::vector<TraceRecordIntel8080>;
+
+// Lock-free ring buffer for a single producer (the emulator) and a single consumer (the trace writer)
+class TraceBufferIntel8080
+{
+public:
+    explicit TraceBufferIntel8080(size_t capacity);
+
+    size_t Capacity() const { return records.size(); }
+    size_t Size() const { return head.load(std::memory_order_acquire) - tail.load(std::memory_order_acquire); }
+
+    bool TryPush(TraceRecordIntel8080 const & record)
+    {
+        size_t position = head.load(std::memory_order_relaxed);
+        if (position - tail.load(std::memory_order_acquire) >= records.size())
+            return false;
+        records[position & mask] = record;
+        head.store(position + 1, std::memory_order_release);
+        return true;
+    }
+    // Waits for the consumer when the buffer is full, no records are dropped
+    void Push(TraceRecordIntel8080 const & record);
+    // Take up to maxCount records out of the buffer, returns the number taken
+    size_t Pop(TraceRecordIntel8080 * data, size_t maxCount);
+
+private:
+    std::vector<TraceRecordIntel8080> records;
+    size_t mask;
+    std::atomic<size_t> head;
+    std::atomic<size_t> tail;
+};
+
+// Records a binary trace of a processor. The engines call Record() from their run loops before every instruction,
+// FastProcessorIntel8080 and the engines derived from it only check for a recorder in their instrumented loops,
+// so the loops used without tracing are not affected.
+// A background thread streams the records from the ring buffer to the output stream in large chunks.
+class TraceRecorderIntel8080 : protected Core::ActiveObject
+{
+public:
+    static const uint32_t Magic = 0x38303854;   // "T808"
+    static const uint16_t Version = 1;
+    static const size_t DefaultCapacity = 65536;
+
+    TraceRecorderIntel8080(std::ostream & stream, size_t capacity = DefaultCapacity);
+    virtual ~TraceRecorderIntel8080();
+
+    // Attach to processor and start tracing
+    void Start(ProcessorIntel8080 & processor);
+    // Detach from the processor and write all outstanding records
+    void Stop();
+
+    void Record(RegistersIntel8080 const & registers);
+    size_t RecordCount() const { return recordCount; }
+
+    static void WriteHeader(std::ostream & stream);
+    static void Write(std::ostream & stream, TraceRecordIntel8080 const * records, size_t count);
+
+protected:
+    void Run() override;
+
+private:
+    std::ostream & stream;
+    TraceBufferIntel8080 buffer;
+    ProcessorIntel8080 * processor;
+    MemoryManager * memoryManager;
+    uint64_t cycles;
+    size_t recordCount;
+
+    size_t Drain(std::vector<TraceRecordIntel8080> & chunk);
+};
+
+// Offline access to trace files
+class TraceReaderIntel8080
+{
+public:
+    static TraceRecordsIntel8080 Load(std::istream & stream);
+    static void Print(std::ostream & stream, TraceRecordIntel8080 const & record);
+    static void Print(std::ostream & stream, TraceRecordsIntel8080 const & records);
+    // Index of the first record where the traces differ, or npos if they are equal
+    static size_t Diff(TraceRecordsIntel8080 const & first, TraceRecordsIntel8080 const & second);
+
+    static const size_t npos = size_t(-1);
+};
+
+} // namespace Emulator
@@ -0,0 +1,151 @@
+#include "emulator/BatchRunnerIntel8080.h"
+
+#include <algorithm>
+#include <atomic>
+#include <thread>
+#include "core/WorkerThread.h"
+
+using namespace Emulator;
+
+BatchInstanceIntel8080::BatchInstanceIntel8080()
+    : processor()
+    , memoryManager()
+    , rom()
+    , ram()
+    , ioManager()
+    , ioPort()
+{
+}
+
+BatchInstanceIntel8080::~BatchInstanceIntel8080()
+{
+}
+
+void BatchInstanceIntel8080::SetupMemory(size_t codeOffset, size_t codeSize)
+{
+    if (rom && (rom->Offset() == codeOffset) && (rom->Size() == codeSize))
+    {
+        // Same layout as the previous image, only clear what it left behind
+        ram->Load(std::vector<uint8_t>(), ram->Offset());
+        ioPort->Load(std::vector<uint8_t>(), ioPort->Offset());
+        return;
+    }
+    size_t ramOffset = codeOffset + codeSize;
+    memoryManager = std::make_shared<MemoryManager>();
+    rom = std::make_shared<ROM>(codeOffset, codeSize);
+    ram = std::make_shared<RAM>(ramOffset, MemoryManager::AddressSpaceSize - ramOffset);
+    memoryManager->AddMemory(rom);
+    memoryManager->AddMemory(ram);
+    ioManager = std::make_shared<IOManager>();
+    ioPort = std::make_shared<IOPort>(0, 256);
+    ioManager->AddIO(ioPort);
+    processor.Setup(memoryManager, ioManager);
+}
+
+BatchResultIntel8080 BatchInstanceIntel8080::Run(Assembler::ObjectCode const & objectCode, size_t maxCycles)
+{
+    BatchResultIntel8080 result;
+    try
+    {
+        Assembler::CodeSegment const & segment = objectCode.GetSegment(Assembler::SegmentID::ASEG);
+        SetupMemory(segment.Offset(), segment.Size());
+        processor.Reset();
+        processor.GetRegisters().isHalted = false;
+        processor.LoadCode(segment.Data(), segment.Offset(), rom);
+        // Run(budget) returns 0 once the processor has stopped
+        RegistersIntel8080 const & registers = processor.GetRegisters();
+        while (!registers.isHalted && (registers.cycleCountTotal < maxCycles))
+        {
+            if (processor.Run(size_t(maxCycles - registers.cycleCountTotal)) == 0)
+                break;
+        }
+    }
+    catch (std::exception & e)
+    {
+        result.error = e.what();
+        if (result.error.empty())
+            result.error = "Unknown error";
+    }
+    result.registers = processor.GetRegisters();
+    result.halted = result.registers.isHalted;
+    result.timedOut = !result.halted && result.error.empty();
+    return result;
+}
+
+namespace Emulator
+{
+
+class BatchWorkerIntel8080 : public Core::WorkerThread
+{
+public:
+    BatchWorkerIntel8080(std::string const & name,
+                         BatchInstanceIntel8080 & instance,
+                         std::vector<Assembler::ObjectCode> const & images,
+                         BatchResultsIntel8080 & results,
+                         std::atomic<size_t> & nextImage,
+                         size_t maxCycles)
+        : Core::WorkerThread(name)
+        , instance(instance)
+        , images(images)
+        , results(results)
+        , nextImage(nextImage)
+        , maxCycles(maxCycles)
+    {
+    }
+
+    // Every worker writes to its own entries of results only, the shared index is the only synchronization
+    void * Thread() override
+    {
+        size_t index;
+        while ((index = nextImage++) < images.size())
+        {
+            results[index] = instance.Run(images[index], maxCycles);
+            results[index].index = index;
+        }
+        return nullptr;
+    }
+
+private:
+    BatchInstanceIntel8080 & instance;
+    std::vector<Assembler::ObjectCode> const & images;
+    BatchResultsIntel8080 & results;
+    std::atomic<size_t> & nextImage;
+    size_t maxCycles;
+};
+
+} // namespace Emulator
+
+BatchRunnerIntel8080::BatchRunnerIntel8080(size_t workerCount, size_t maxCycles)
+    : maxCycles(maxCycles)
+    , instances()
+{
+    if (workerCount == 0)
+        workerCount = std::max(size_t(std::thread::hardware_concurrency()), size_t{ 1 });
+    for (size_t index = 0; index < workerCount; ++index)
+    {
+        instances.emplace_back(new BatchInstanceIntel8080);
+    }
+}
+
+BatchRunnerIntel8080::~BatchRunnerIntel8080()
+{
+}
+
+BatchResultsIntel8080 BatchRunnerIntel8080::Run(std::vector<Assembler::ObjectCode> const & images)
+{
+    BatchResultsIntel8080 results(images.size());
+    std::atomic<size_t> nextImage(0);
+    size_t workerCount = std::min(instances.size(), images.size());
+    std::vector<std::unique_ptr<BatchWorkerIntel8080>> workers;
+    for (size_t index = 0; index < workerCount; ++index)
+    {
+        workers.emplace_back(new BatchWorkerIntel8080("Batch" + std::to_string(index), *instances[index],
+                                                      images, results, nextImage, maxCycles));
+        workers.back()->Create();
+    }
+    for (auto & worker : workers)
+    {
+        worker->WaitForDeath();
+    }
+    return results;
+}
@@ -0,0 +1,171 @@
+#include "emulator/BreakpointManager.h"
+
+#include <iomanip>
+#include <sstream>
+#include <stdexcept>
+#include <vector>
+
+using namespace Emulator;
+
+BreakpointManager::BreakpointManager(MemoryManagerPtr memoryManager)
+    : memoryManager(memoryManager)
+    , breakpoints()
+    , watchpoints()
+    , nextID()
+    , stop()
+    , stopped()
+    , stopPending()
+    , resuming()
+    , resumeAddress()
+{
+    memoryManager->SetAccessCallback([this](size_t address, MemoryAccess access, uint8_t data) { OnAccess(address, access, data); });
+}
+
+BreakpointManager::~BreakpointManager()
+{
+    breakpoints.clear();
+    watchpoints.clear();
+    stopPending = false;
+    UpdateTraps();
+    memoryManager->SetAccessCallback(nullptr);
+}
+
+void BreakpointManager::AddBreakpoint(size_t address)
+{
+    if (address >= MemoryManager::AddressSpaceSize)
+    {
+        std::ostringstream stream;
+        stream << "AddBreakpoint: Address " << std::hex << std::setw(8) << std::setfill('0') << address << std::dec
+               << " outside address space";
+        throw std::runtime_error(stream.str());
+    }
+    breakpoints.insert(address);
+    UpdateTraps();
+}
+
+bool BreakpointManager::RemoveBreakpoint(size_t address)
+{
+    if (breakpoints.erase(address) == 0)
+        return false;
+    UpdateTraps();
+    return true;
+}
+
+WatchpointID BreakpointManager::AddWatchpoint(size_t begin, size_t end, MemoryAccess access, uint8_t valueLow, uint8_t valueHigh)
+{
+    if ((begin > end) || (end >= MemoryManager::AddressSpaceSize))
+    {
+        std::ostringstream stream;
+        stream << "AddWatchpoint: Invalid range " << std::hex << std::setw(8) << std::setfill('0') << begin
+               << "-" << std::setw(8) << std::setfill('0') << end << std::dec;
+        throw std::runtime_error(stream.str());
+    }
+    Watchpoint watchpoint;
+    watchpoint.begin = begin;
+    watchpoint.end = end;
+    watchpoint.access = access & (MemoryAccess::Read | MemoryAccess::Write);
+    watchpoint.valueLow = valueLow;
+    watchpoint.valueHigh = valueHigh;
+    WatchpointID id = nextID++;
+    watchpoints[id] = watchpoint;
+    UpdateTraps();
+    return id;
+}
+
+bool BreakpointManager::RemoveWatchpoint(WatchpointID id)
+{
+    if (watchpoints.erase(id) == 0)
+        return false;
+    UpdateTraps();
+    return true;
+}
+
+void BreakpointManager::Clear()
+{
+    breakpoints.clear();
+    watchpoints.clear();
+    stopPending = false;
+    UpdateTraps();
+}
+
+void BreakpointManager::ClearStop()
+{
+    stopped = false;
+    stop = BreakpointStop();
+}
+
+void BreakpointManager::OnAccess(size_t address, MemoryAccess access, uint8_t data)
+{
+    if (access == MemoryAccess::Execute)
+    {
+        if (stopPending)
+        {
+            // The instruction hitting a watchpoint has completed
+            stopPending = false;
+            UpdateTraps();
+            Stop(address);
+        }
+        if (resuming)
+        {
+            resuming = false;
+            if (address == resumeAddress)
+                return;
+        }
+        if (HasBreakpoint(address))
+        {
+            stop = BreakpointStop();
+            stop.address = address;
+            stop.access = MemoryAccess::Execute;
+            stop.data = data;
+            Stop(address);
+        }
+        return;
+    }
+    // Only the first watchpoint hit of an instruction is reported
+    if (stopPending)
+        return;
+    for (auto const & entry : watchpoints)
+    {
+        Watchpoint const & watchpoint = entry.second;
+        if ((address < watchpoint.begin) || (address > watchpoint.end) || ((access & watchpoint.access) == MemoryAccess::None) ||
+            (data < watchpoint.valueLow) || (data > watchpoint.valueHigh))
+            continue;
+        stop = BreakpointStop();
+        stop.address = address;
+        stop.access = access;
+        stop.data = data;
+        stop.watchpoint = entry.first;
+        // Trap execution on all pages to stop at the next instruction boundary
+        stopPending = true;
+        UpdateTraps();
+        return;
+    }
+}
+
+void BreakpointManager::Stop(size_t pc)
+{
+    stop.pc = pc;
+    stopped = true;
+    resuming = true;
+    resumeAddress = pc;
+    throw ExecutionBreak(pc);
+}
+
+// Recomputes the traps of all pages, called only when breakpoints or watchpoints change
+void BreakpointManager::UpdateTraps()
+{
+    size_t pageSize = memoryManager->PageSize();
+    std::vector<MemoryAccess> traps(MemoryManager::AddressSpaceSize / pageSize, stopPending ? MemoryAccess::Execute : MemoryAccess::None);
+    for (auto address : breakpoints)
+        traps[address / pageSize] |= MemoryAccess::Execute;
+    for (auto const & entry : watchpoints)
+    {
+        for (size_t page = entry.second.begin / pageSize; page <= entry.second.end / pageSize; ++page)
+            traps[page] |= entry.second.access;
+    }
+    for (size_t page = 0; page < traps.size(); ++page)
+    {
+        if (memoryManager->GetTraps(page * pageSize) != traps[page])
+            memoryManager->SetTraps(page * pageSize, traps[page]);
+    }
+}
@@ -0,0 +1,956 @@
+#include "emulator/CPMMachineIntel8080.h"
+
+#include <algorithm>
+#include <cctype>
+#include <cstdio>
+#include <sstream>
+#if defined(_WIN32)
+#include <windows.h>
+#else
+#include <dirent.h>
+#endif
+#include "core/Path.h"
+#include "emulator/IODevice.h"
+#include "emulator/IOManager.h"
+
+using namespace Emulator;
+
+namespace Emulator
+{
+
+// Calls the BDOS or BIOS function selected by the port written to by the stubs
+class CPMMachineIntel8080::TrapDevice : public IODevice
+{
+public:
+    TrapDevice(CPMMachineIntel8080 & machine)
+        : IODevice(BIOSPortBase, IOManager::PortCount - BIOSPortBase)
+        , machine(machine)
+    {}
+
+    uint8_t In8(size_t /*address*/) const override
+    {
+        return 0xFF;
+    }
+    void Out8(size_t address, uint8_t /*data*/) override
+    {
+        if (address == BDOSPort)
+            machine.BDOS();
+        else
+            machine.BIOS(address - BIOSPortBase);
+    }
+
+private:
+    CPMMachineIntel8080 & machine;
+};
+
+} // namespace Emulator
+
+static const uint8_t OpcodeJMP = 0xC3;
+static const uint8_t OpcodeOUT = 0xD3;
+static const uint8_t OpcodeRET = 0xC9;
+static const uint8_t EndOfFile = 0x1A;
+static const uint8_t EmptyEntry = 0xE5;
+static const size_t DirectoryEntrySize = 32;
+static const size_t ExtentRecords = 128;            // Records per extent with 2K blocks
+static const size_t BlockRecords = 16;
+static const size_t FCBNameSize = 11;
+// FCB fields
+static const uint16_t FCBExtent = 12;
+static const uint16_t FCBModule = 14;
+static const uint16_t FCBRecordCount = 15;
+static const uint16_t FCBNewName = 16;
+static const uint16_t FCBCurrentRecord = 32;
+static const uint16_t FCBRandomRecord = 33;
+// BDOS data, after the serial number and entry stub
+static const uint16_t DiskParameterBlock = CPMMachineIntel8080::BDOSBase + 0x10;
+static const uint16_t AllocationVector = CPMMachineIntel8080::BDOSBase + 0x40;
+static const uint16_t BIOSStubs = CPMMachineIntel8080::BIOSBase + 0x40;
+
+// 2 MB drive with 2K blocks and 256 directory entries, as a hard disk BIOS would define it
+static const uint8_t DiskParameters[] =
+{
+    0x40, 0x00,     // SPT: sectors per track
+    0x04,           // BSH: block shift, 2K blocks
+    0x0F,           // BLM: block mask
+    0x00,           // EXM: extent mask
+    0xFF, 0x03,     // DSM: highest block number
+    0xFF, 0x00,     // DRM: highest directory entry number
+    0xF0, 0x00,     // AL0, AL1: blocks reserved for the directory
+    0x00, 0x00,     // CKS: no checked directory entries
+    0x00, 0x00,     // OFF: no reserved tracks
+};
+
+// The 11 character FCB name as a host file name, e.g. "DUMP    COM" as DUMP.COM
+static std::string HostName(std::string const & name)
+{
+    std::string base = name.substr(0, 8);
+    std::string extension = name.substr(8, 3);
+    base.erase(base.find_last_not_of(' ') + 1);
+    extension.erase(extension.find_last_not_of(' ') + 1);
+    return extension.empty() ? base : base + "." + extension;
+}
+
+// The host file name as an upper case 11 character FCB name, empty if it does not fit 8.3
+static std::string FCBNameOf(std::string const & hostName)
+{
+    size_t dot = hostName.find('.');
+    std::string base = hostName.substr(0, dot);
+    std::string extension = (dot == std::string::npos) ? "" : hostName.substr(dot + 1);
+    if (base.empty() || (base.size() > 8) || (extension.size() > 3) || (extension.find('.') != std::string::npos))
+        return "";
+    std::string result = base + std::string(8 - base.size(), ' ') + extension + std::string(3 - extension.size(), ' ');
+    for (auto & ch : result)
+        ch = char(std::toupper(ch));
+    for (auto ch : base + extension)
+    {
+        if ((ch <= ' ') || (ch > '~') || (ch == '?') || (ch == '*') || (ch == ':'))
+            return "";
+    }
+    return result;
+}
+
+static bool Matches(std::string const & pattern, std::string const & name)
+{
+    for (size_t index = 0; index < FCBNameSize; ++index)
+    {
+        if ((pattern[index] != '?') && (pattern[index] != name[index]))
+            return false;
+    }
+    return true;
+}
+
+static size_t HostFileSize(std::string const & path)
+{
+    std::ifstream file(path, std::ios::binary | std::ios::ate);
+    return file ? size_t(file.tellg()) : 0;
+}
+
+static size_t Records(size_t size)
+{
+    return (size + CPMMachineIntel8080::RecordSize - 1) / CPMMachineIntel8080::RecordSize;
+}
+
+CPMMachineIntel8080::CPMMachineIntel8080(ProcessorIntel8080 & processor, std::istream & input, std::ostream & output)
+    : processor(processor)
+    , input(input)
+    , output(output)
+    , memoryManager()
+    , ram()
+    , drives(DriveCount)
+    , files()
+    , driveEntries(DriveCount)
+    , driveListed(DriveCount)
+    , exited()
+    , bdosCalls()
+    , currentDrive()
+    , userNumber()
+    , dma(DefaultDMA)
+    , searchEntries()
+    , searchIndex()
+{
+    memoryManager = std::make_shared<MemoryManager>();
+    ram = std::make_shared<RAM>(0, MemoryManager::AddressSpaceSize);
+    memoryManager->AddMemory(ram);
+    IOManagerPtr ioManager = std::make_shared<IOManager>();
+    ioManager->AddIO(std::make_shared<TrapDevice>(*this));
+    processor.Setup(memoryManager, ioManager);
+    drives[0] = ".";
+}
+
+CPMMachineIntel8080::~CPMMachineIntel8080()
+{
+}
+
+void CPMMachineIntel8080::SetDrive(size_t drive, std::string const & directory)
+{
+    if (drive >= DriveCount)
+    {
+        std::ostringstream stream;
+        stream << "Invalid drive " << drive << ", CP/M has drives 0 (A:) to " << DriveCount - 1 << " (P:)";
+        throw std::runtime_error(stream.str());
+    }
+    drives[drive] = directory;
+    driveListed[drive] = false;
+}
+
+void CPMMachineIntel8080::Load(std::vector<uint8_t> const & program, std::string const & commandTail)
+{
+    if (program.size() > BDOSBase - TPA)
+    {
+        std::ostringstream stream;
+        stream << "Program of " << program.size() << " bytes does not fit in the TPA of " << BDOSBase - TPA << " bytes";
+        throw std::runtime_error(stream.str());
+    }
+    files.clear();
+    ResetDriveEntries();
+    searchEntries.clear();
+    exited = false;
+    bdosCalls = 0;
+    dma = DefaultDMA;
+    SetupMemory();
+    memoryManager->Store(TPA, program);
+
+    std::string tail;
+    for (auto ch : commandTail)
+        tail += char(std::toupper(ch));
+    if (!tail.empty())
+        tail = " " + tail;
+    tail.resize(std::min(tail.size(), size_t{ 126 }));
+    Store8(DefaultDMA, uint8_t(tail.size()));
+    memoryManager->Store(DefaultDMA + 1, reinterpret_cast<uint8_t const *>(tail.c_str()), tail.size() + 1);
+
+    // The default FCBs, as the CCP fills them from the first two arguments
+    std::vector<uint8_t> fcbs(DefaultDMA - DefaultFCB, 0);
+    std::fill(fcbs.begin() + 1, fcbs.begin() + 1 + FCBNameSize, ' ');
+    std::fill(fcbs.begin() + 17, fcbs.begin() + 17 + FCBNameSize, ' ');
+    std::istringstream arguments(tail);
+    for (size_t argument = 0; argument < 2; ++argument)
+    {
+        std::string text;
+        if (!(arguments >> text))
+            break;
+        size_t fcb = argument * 16;
+        if ((text.size() >= 2) && (text[1] == ':'))
+        {
+            fcbs[fcb] = uint8_t(text[0] - 'A' + 1);
+            text = text.substr(2);
+        }
+        size_t dot = text.find('.');
+        std::string parts[] = { text.substr(0, dot), (dot == std::string::npos) ? "" : text.substr(dot + 1) };
+        size_t offsets[] = { 1, 9 };
+        size_t sizes[] = { 8, 3 };
+        for (size_t part = 0; part < 2; ++part)
+        {
+            for (size_t index = 0; index < sizes[part]; ++index)
+            {
+                if ((index < parts[part].size()) && (parts[part][index] == '*'))
+                {
+                    std::fill(fcbs.begin() + fcb + offsets[part] + index, fcbs.begin() + fcb + offsets[part] + sizes[part], '?');
+                    break;
+                }
+                if (index < parts[part].size())
+                    fcbs[fcb + offsets[part] + index] = uint8_t(parts[part][index]);
+            }
+        }
+    }
+    memoryManager->Store(DefaultFCB, fcbs);
+
+    processor.Reset();
+    RegistersIntel8080 & registers = processor.GetRegisters();
+    registers.isHalted = false;
+    // Returning from the program is a warm boot
+    registers.sp.W = BDOSBase - 2;
+    memoryManager->Store16(registers.sp.W, 0x0000);
+    registers.pc = TPA;
+    registers.bc.B.l = uint8_t((userNumber << 4) | currentDrive);
+}
+
+void CPMMachineIntel8080::LoadFile(std::string const & path, std::string const & commandTail)
+{
+    std::ifstream file(path, std::ios::binary);
+    if (!file)
+    {
+        std::ostringstream stream;
+        stream << "Cannot open " << path;
+        throw std::runtime_error(stream.str());
+    }
+    std::vector<uint8_t> program((std::istreambuf_iterator<char>(file)), std::istreambuf_iterator<char>());
+    Load(program, commandTail);
+}
+
+bool CPMMachineIntel8080::Run(size_t budget)
+{
+    size_t cycles = 0;
+    while (!exited && !processor.GetRegisters().isHalted && (cycles < budget))
+    {
+        size_t executed = processor.Run(budget - cycles);
+        if (executed == 0)
+            break;
+        cycles += executed;
+    }
+    return exited;
+}
+
+void CPMMachineIntel8080::SetupMemory()
+{
+    memoryManager->Store(0, std::vector<uint8_t>(MemoryManager::AddressSpaceSize, 0));
+    uint8_t page0[] =
+    {
+        OpcodeJMP, uint8_t(BIOSBase + 3), uint8_t((BIOSBase + 3) >> 8),
+        0x00,                                                                   // IOBYTE
+        uint8_t((userNumber << 4) | currentDrive),
+        OpcodeJMP, uint8_t(BDOSBase + 6), uint8_t((BDOSBase + 6) >> 8),
+    };
+    memoryManager->Store(0, page0, sizeof(page0));
+    uint8_t bdosStub[] = { OpcodeOUT, BDOSPort, OpcodeRET };
+    memoryManager->Store(BDOSBase + 6, bdosStub, sizeof(bdosStub));
+    memoryManager->Store(DiskParameterBlock, DiskParameters, sizeof(DiskParameters));
+    Store8(AllocationVector, DiskParameters[9]);
+    for (size_t function = 0; function < BIOSFunctionCount; ++function)
+    {
+        uint16_t stub = uint16_t(BIOSStubs + 3 * function);
+        uint8_t entry[] = { OpcodeJMP, uint8_t(stub), uint8_t(stub >> 8) };
+        uint8_t code[] = { OpcodeOUT, uint8_t(BIOSPortBase + function), OpcodeRET };
+        memoryManager->Store(BIOSBase + 3 * function, entry, sizeof(entry));
+        memoryManager->Store(stub, code, sizeof(code));
+    }
+}
+
+void CPMMachineIntel8080::Exit()
+{
+    files.clear();
+    output.flush();
+    exited = true;
+    processor.GetRegisters().isHalted = true;
+}
+
+void CPMMachineIntel8080::BDOS()
+{
+    ++bdosCalls;
+    RegistersIntel8080 & registers = processor.GetRegisters();
+    uint8_t function = registers.bc.B.l;
+    uint16_t parameter = registers.de.W;
+    uint8_t e = registers.de.B.l;
+    uint16_t result = 0;
+    switch (function)
+    {
+    case 0:     // System reset
+        Exit();
+        return;
+    case 1:     // Console input
+        {
+            int data = ReadConsole();
+            if ((data >= ' ') || (data == '\r') || (data == '\n') || (data == '\t') || (data == '\b'))
+                WriteConsole(uint8_t(data));
+            result = uint8_t(data);
+        }
+        break;
+    case 2:     // Console output
+        WriteConsole(e);
+        break;
+    case 3:     // Reader input
+        result = EndOfFile;
+        break;
+    case 4:     // Punch output
+    case 5:     // List output
+        break;
+    case 6:     // Direct console IO
+        if (e == 0xFF)
+            result = ConsoleReady() ? uint8_t(ReadConsole()) : 0;
+        else if (e == 0xFE)
+            result = ConsoleReady() ? 0xFF : 0;
+        else
+            WriteConsole(e);
+        break;
+    case 7:     // Get IOBYTE
+        result = Fetch8(0x0003);
+        break;
+    case 8:     // Set IOBYTE
+        Store8(0x0003, e);
+        break;
+    case 9:     // Print string
+        PrintString(parameter);
+        break;
+    case 10:    // Read console buffer
+        ReadConsoleBuffer(parameter);
+        break;
+    case 11:    // Get console status
+        result = ConsoleReady() ? 0xFF : 0;
+        break;
+    case 12:    // Return version number
+        result = 0x0022;
+        break;
+    case 13:    // Reset disk system
+        files.clear();
+        ResetDriveEntries();
+        currentDrive = 0;
+        dma = DefaultDMA;
+        Store8(0x0004, uint8_t(userNumber << 4));
+        break;
+    case 14:    // Select disk
+        if (!IsDriveMapped(e & 0x0F))
+        {
+            result = 0xFF;
+            break;
+        }
+        currentDrive = e & 0x0F;
+        Store8(0x0004, uint8_t((userNumber << 4) | currentDrive));
+        break;
+    case 15:    // Open file
+        result = OpenFile(parameter);
+        break;
+    case 16:    // Close file
+        result = HostFileExists(parameter) ? 0 : 0xFF;
+        CloseFile(std::string(1, char('A' + FCBDrive(parameter))) + FCBName(parameter));
+        break;
+    case 17:    // Search for first
+        result = Search(parameter);
+        break;
+    case 18:    // Search for next
+        result = SearchNext();
+        break;
+    case 19:    // Delete file
+        result = DeleteFiles(parameter);
+        break;
+    case 20:    // Read sequential
+        {
+            size_t record = SequentialRecord(parameter);
+            result = ReadRecord(parameter, record);
+            if (result == 0)
+                SetSequentialRecord(parameter, record + 1);
+        }
+        break;
+    case 21:    // Write sequential
+        {
+            size_t record = SequentialRecord(parameter);
+            result = WriteRecord(parameter, record);
+            if (result == 0)
+                SetSequentialRecord(parameter, record + 1);
+        }
+        break;
+    case 22:    // Make file
+        result = MakeFile(parameter);
+        break;
+    case 23:    // Rename file
+        result = RenameFile(parameter);
+        break;
+    case 24:    // Return login vector
+        for (size_t drive = 0; drive < DriveCount; ++drive)
+        {
+            if (IsDriveMapped(drive))
+                result |= uint16_t(1 << drive);
+        }
+        break;
+    case 25:    // Return current disk
+        result = currentDrive;
+        break;
+    case 26:    // Set DMA address
+        dma = parameter;
+        break;
+    case 27:    // Get allocation vector address
+        result = AllocationVector;
+        break;
+    case 28:    // Write protect disk
+    case 29:    // Get read only vector
+        break;
+    case 30:    // Set file attributes
+        result = HostFileExists(parameter) ? 0 : 0xFF;
+        break;
+    case 31:    // Get disk parameter block address
+        result = DiskParameterBlock;
+        break;
+    case 32:    // Get / set user code
+        if (e == 0xFF)
+            result = userNumber;
+        else
+            userNumber = e & 0x0F;
+        break;
+    case 33:    // Read random
+        result = ReadRandom(parameter);
+        break;
+    case 34:    // Write random
+    case 40:    // Write random with zero fill, the host fills the gap with zeros
+        result = WriteRandom(parameter);
+        break;
+    case 35:    // Compute file size
+        ComputeFileSize(parameter);
+        break;
+    case 36:    // Set random record
+        SetRandomRecord(parameter, SequentialRecord(parameter));
+        break;
+    case 37:    // Reset drive
+        for (size_t drive = 0; drive < DriveCount; ++drive)
+        {
+            if ((parameter & (1 << drive)) != 0)
+                driveListed[drive] = false;
+        }
+        break;
+    default:
+        break;
+    }
+    registers.hl.W = result;
+    registers.a = registers.hl.B.l;
+    registers.bc.B.h = registers.hl.B.h;
+}
+
+void CPMMachineIntel8080::BIOS(size_t function)
+{
+    RegistersIntel8080 & registers = processor.GetRegisters();
+    switch (function)
+    {
+    case 0:     // BOOT
+    case 1:     // WBOOT
+        Exit();
+        break;
+    case 2:     // CONST
+        registers.a = ConsoleReady() ? 0xFF : 0;
+        break;
+    case 3:     // CONIN
+        registers.a = uint8_t(ReadConsole());
+        break;
+    case 4:     // CONOUT
+        WriteConsole(registers.bc.B.l);
+        break;
+    case 7:     // READER
+        registers.a = EndOfFile;
+        break;
+    case 9:     // SELDSK, there are no disks to select
+        registers.hl.W = 0;
+        break;
+    case 13:    // READ
+    case 14:    // WRITE
+        registers.a = 1;
+        break;
+    case 15:    // LISTST
+        registers.a = 0xFF;
+        break;
+    case 16:    // SECTRAN
+        registers.hl.W = registers.bc.W;
+        break;
+    case 5:     // LIST
+    case 6:     // PUNCH
+    case 8:     // HOME
+    case 10:    // SETTRK
+    case 11:    // SETSEC
+    case 12:    // SETDMA
+    default:
+        break;
+    }
+}
+
+// Host line ends read as a carriage return, the end of input as ^Z
+int CPMMachineIntel8080::ReadConsole()
+{
+    int data = input.get();
+    if (data == std::char_traits<char>::eof())
+        return EndOfFile;
+    if ((data == '\r') && (input.peek() == '\n'))
+        input.get();
+    return (data == '\n') ? '\r' : data;
+}
+
+// Only input already available counts, so programs polling the console do not wait for it
+bool CPMMachineIntel8080::ConsoleReady()
+{
+    return input.rdbuf()->in_avail() > 0;
+}
+
+void CPMMachineIntel8080::WriteConsole(uint8_t data)
+{
+    output.put(char(data));
+}
+
+void CPMMachineIntel8080::PrintString(uint16_t address)
+{
+    for (size_t count = 0; count < MemoryManager::AddressSpaceSize; ++count)
+    {
+        uint8_t data = Fetch8(uint16_t(address + count));
+        if (data == '$')
+            break;
+        WriteConsole(data);
+    }
+}
+
+void CPMMachineIntel8080::ReadConsoleBuffer(uint16_t address)
+{
+    uint8_t maximum = Fetch8(address);
+    uint8_t count = 0;
+    for (;;)
+    {
+        int data = ReadConsole();
+        if ((data == '\r') || ((data == EndOfFile) && input.eof()))
+            break;
+        // ^C at the start of the line is a warm boot
+        if ((data == 0x03) && (count == 0))
+        {
+            Exit();
+            return;
+        }
+        if ((data == '\b') || (data == 0x7F))
+        {
+            if (count > 0)
+                --count;
+            continue;
+        }
+        if (count >= maximum)
+            break;
+        Store8(uint16_t(address + 2 + count), uint8_t(data));
+        ++count;
+        WriteConsole(uint8_t(data));
+        // A full buffer ends the line, as CP/M does
+        if (count == maximum)
+            break;
+    }
+    Store8(uint16_t(address + 1), count);
+    WriteConsole('\r');
+}
+
+size_t CPMMachineIntel8080::FCBDrive(uint16_t fcb) const
+{
+    uint8_t drive = Fetch8(fcb) & 0x1F;
+    return (drive == 0) ? currentDrive : drive - 1;
+}
+
+std::string CPMMachineIntel8080::FCBName(uint16_t fcb) const
+{
+    std::string name(FCBNameSize, ' ');
+    for (size_t index = 0; index < FCBNameSize; ++index)
+        name[index] = char(std::toupper(Fetch8(uint16_t(fcb + 1 + index)) & 0x7F));
+    return name;
+}
+
+// Path of the host file of an FCB, an existing file matched case insensitively, or the name in upper case.
+// Empty if the drive is not mapped.
+std::string CPMMachineIntel8080::HostPath(uint16_t fcb) const
+{
+    size_t drive = FCBDrive(fcb);
+    if (!IsDriveMapped(drive))
+        return "";
+    std::string name = FCBName(fcb);
+    DriveEntries const & entries = GetDriveEntries(drive);
+    auto entry = entries.find(name);
+    return Core::Path::CombinePath(drives[drive], (entry != entries.end()) ? entry->second : HostName(name));
+}
+
+bool CPMMachineIntel8080::HostFileExists(uint16_t fcb) const
+{
+    size_t drive = FCBDrive(fcb);
+    if (!IsDriveMapped(drive))
+        return false;
+    DriveEntries const & entries = GetDriveEntries(drive);
+    return entries.find(FCBName(fcb)) != entries.end();
+}
+
+// Open files are kept by drive letter and FCB name
+CPMMachineIntel8080::FilePtr CPMMachineIntel8080::GetFile(uint16_t fcb, bool create)
+{
+    std::string key = std::string(1, char('A' + FCBDrive(fcb))) + FCBName(fcb);
+    auto file = files.find(key);
+    if (file != files.end())
+        return file->second;
+    std::string path = HostPath(fcb);
+    if (path.empty() || (!create && !HostFileExists(fcb)))
+        return nullptr;
+    if (create)
+    {
+        std::ofstream(path, std::ios::binary | std::ios::trunc);
+        GetDriveEntries(FCBDrive(fcb)).insert(std::make_pair(FCBName(fcb), Core::Path::LastPartOfPath(path)));
+    }
+    FilePtr result = std::make_shared<FileState>();
+    result->stream.open(path, std::ios::binary | std::ios::in | std::ios::out);
+    if (!result->stream)
+    {
+        result->stream.clear();
+        result->stream.open(path, std::ios::binary | std::ios::in);
+    }
+    if (!result->stream)
+        return nullptr;
+    // The only time the size is asked from the host, the stream is left at the end
+    result->stream.seekg(0, std::ios::end);
+    result->size = size_t(result->stream.tellg());
+    result->position = result->size;
+    files[key] = result;
+    return result;
+}
+
+void CPMMachineIntel8080::CloseFile(std::string const & key)
+{
+    files.erase(key);
+}
+
+size_t CPMMachineIntel8080::FileRecords(FileState const & file)
+{
+    return Records(file.size);
+}
+
+// Seeks when the record is not where the last access left the stream, i.e. on random access
+void CPMMachineIntel8080::SeekFile(FileState & file, size_t position, bool writing)
+{
+    if ((file.position == position) && (file.writing == writing))
+        return;
+    file.stream.clear();
+    if (writing)
+        file.stream.seekp(std::streamoff(position));
+    else
+        file.stream.seekg(std::streamoff(position));
+    file.position = position;
+    file.writing = writing;
+}
+
+void CPMMachineIntel8080::SetExtentRecordCount(uint16_t fcb, size_t records)
+{
+    size_t extent = ((Fetch8(uint16_t(fcb + FCBModule)) & 0x3F) << 5) | (Fetch8(uint16_t(fcb + FCBExtent)) & 0x1F);
+    size_t first = extent * ExtentRecords;
+    Store8(uint16_t(fcb + FCBRecordCount), uint8_t((records > first) ? std::min(records - first, ExtentRecords) : 0));
+}
+
+size_t CPMMachineIntel8080::SequentialRecord(uint16_t fcb) const
+{
+    size_t extent = ((Fetch8(uint16_t(fcb + FCBModule)) & 0x3F) << 5) | (Fetch8(uint16_t(fcb + FCBExtent)) & 0x1F);
+    return extent * ExtentRecords + (Fetch8(uint16_t(fcb + FCBCurrentRecord)) & 0x7F);
+}
+
+void CPMMachineIntel8080::SetSequentialRecord(uint16_t fcb, size_t record)
+{
+    size_t extent = record / ExtentRecords;
+    Store8(uint16_t(fcb + FCBCurrentRecord), uint8_t(record % ExtentRecords));
+    Store8(uint16_t(fcb + FCBExtent), uint8_t(extent & 0x1F));
+    Store8(uint16_t(fcb + FCBModule), uint8_t(extent >> 5));
+    FilePtr file = GetFile(fcb, false);
+    if (file)
+        SetExtentRecordCount(fcb, FileRecords(*file));
+}
+
+// Returns 1 when reading past the end of the file
+uint8_t CPMMachineIntel8080::ReadRecord(uint16_t fcb, size_t record)
+{
+    FilePtr file = GetFile(fcb, false);
+    if (!file)
+        return 1;
+    if (record >= FileRecords(*file))
+        return 1;
+    uint8_t buffer[RecordSize];
+    SeekFile(*file, record * RecordSize, false);
+    file->stream.read(reinterpret_cast<char *>(buffer), RecordSize);
+    size_t count = size_t(file->stream.gcount());
+    file->stream.clear();
+    file->position += count;
+    std::fill(buffer + count, buffer + RecordSize, EndOfFile);
+    memoryManager->Store(dma, buffer, RecordSize);
+    return 0;
+}
+
+// Returns 2 (disk full) when the file cannot be written
+uint8_t CPMMachineIntel8080::WriteRecord(uint16_t fcb, size_t record)
+{
+    FilePtr file = GetFile(fcb, false);
+    if (!file)
+        return 2;
+    uint8_t buffer[RecordSize];
+    memoryManager->Fetch(dma, buffer, RecordSize);
+    SeekFile(*file, record * RecordSize, true);
+    file->stream.write(reinterpret_cast<char const *>(buffer), RecordSize);
+    if (!file->stream)
+    {
+        file->stream.clear();
+        file->position = std::string::npos;
+        return 2;
+    }
+    file->position += RecordSize;
+    file->size = std::max(file->size, file->position);
+    return 0;
+}
+
+uint8_t CPMMachineIntel8080::OpenFile(uint16_t fcb)
+{
+    FilePtr file = GetFile(fcb, false);
+    if (!file)
+        return 0xFF;
+    Store8(uint16_t(fcb + FCBModule), 0);
+    SetExtentRecordCount(fcb, FileRecords(*file));
+    return 0;
+}
+
+uint8_t CPMMachineIntel8080::MakeFile(uint16_t fcb)
+{
+    CloseFile(std::string(1, char('A' + FCBDrive(fcb))) + FCBName(fcb));
+    FilePtr file = GetFile(fcb, true);
+    if (!file)
+        return 0xFF;
+    Store8(uint16_t(fcb + FCBModule), 0);
+    Store8(uint16_t(fcb + FCBRecordCount), 0);
+    return 0;
+}
+
+uint8_t CPMMachineIntel8080::DeleteFiles(uint16_t fcb)
+{
+    size_t drive = FCBDrive(fcb);
+    if (!IsDriveMapped(drive))
+        return 0xFF;
+    std::string pattern = FCBName(fcb);
+    uint8_t result = 0xFF;
+    DriveEntries & entries = GetDriveEntries(drive);
+    for (auto entry = entries.begin(); entry != entries.end();)
+    {
+        if (!Matches(pattern, entry->first))
+        {
+            ++entry;
+            continue;
+        }
+        CloseFile(std::string(1, char('A' + drive)) + entry->first);
+        if (std::remove(Core::Path::CombinePath(drives[drive], entry->second).c_str()) == 0)
+        {
+            result = 0;
+            entry = entries.erase(entry);
+        }
+        else
+            ++entry;
+    }
+    return result;
+}
+
+uint8_t CPMMachineIntel8080::RenameFile(uint16_t fcb)
+{
+    size_t drive = FCBDrive(fcb);
+    if (!IsDriveMapped(drive))
+        return 0xFF;
+    std::string oldName = FCBName(fcb);
+    std::string newName = FCBName(uint16_t(fcb + FCBNewName));
+    DriveEntries & entries = GetDriveEntries(drive);
+    auto entry = entries.find(oldName);
+    if ((entry == entries.end()) || (entries.find(newName) != entries.end()))
+        return 0xFF;
+    std::string letter(1, char('A' + drive));
+    CloseFile(letter + oldName);
+    CloseFile(letter + newName);
+    if (std::rename(Core::Path::CombinePath(drives[drive], entry->second).c_str(),
+                    Core::Path::CombinePath(drives[drive], HostName(newName)).c_str()) != 0)
+        return 0xFF;
+    entries.erase(entry);
+    entries[newName] = HostName(newName);
+    return 0;
+}
+
+// Collects a directory entry for every matching file, describing its last extent
+uint8_t CPMMachineIntel8080::Search(uint16_t fcb)
+{
+    searchEntries.clear();
+    searchIndex = 0;
+    bool all = (Fetch8(fcb) == '?');
+    size_t drive = all ? currentDrive : FCBDrive(fcb);
+    if (!IsDriveMapped(drive))
+        return 0xFF;
+    std::string pattern = all ? std::string(FCBNameSize, '?') : FCBName(fcb);
+    for (auto const & entry : GetDriveEntries(drive))
+    {
+        if (!Matches(pattern, entry.first))
+            continue;
+        // An open file may have writes the host does not see yet
+        auto file = files.find(std::string(1, char('A' + drive)) + entry.first);
+        size_t records = (file != files.end()) ? FileRecords(*file->second)
+                                               : Records(HostFileSize(Core::Path::CombinePath(drives[drive], entry.second)));
+        size_t extent = (records == 0) ? 0 : (records - 1) / ExtentRecords;
+        size_t extentRecords = records - extent * ExtentRecords;
+        std::vector<uint8_t> directoryEntry(DirectoryEntrySize, 0);
+        directoryEntry[0] = userNumber;
+        std::copy(entry.first.begin(), entry.first.end(), directoryEntry.begin() + 1);
+        directoryEntry[FCBExtent] = uint8_t(extent & 0x1F);
+        directoryEntry[FCBModule] = uint8_t(extent >> 5);
+        directoryEntry[FCBRecordCount] = uint8_t(extentRecords);
+        // 16 bit block numbers, as the drive has more than 256 blocks
+        for (size_t block = 0; block < (extentRecords + BlockRecords - 1) / BlockRecords; ++block)
+            directoryEntry[16 + 2 * block] = uint8_t(block + 1);
+        searchEntries.push_back(directoryEntry);
+    }
+    return SearchNext();
+}
+
+// The entry is returned as the first of the directory record at the DMA address
+uint8_t CPMMachineIntel8080::SearchNext()
+{
+    if (searchIndex >= searchEntries.size())
+        return 0xFF;
+    std::vector<uint8_t> record(RecordSize, EmptyEntry);
+    std::copy(searchEntries[searchIndex].begin(), searchEntries[searchIndex].end(), record.begin());
+    ++searchIndex;
+    memoryManager->Store(dma, record);
+    return 0;
+}
+
+bool CPMMachineIntel8080::RandomRecord(uint16_t fcb, size_t & record) const
+{
+    if (Fetch8(uint16_t(fcb + FCBRandomRecord + 2)) != 0)
+        return false;
+    record = memoryManager->Fetch16(uint16_t(fcb + FCBRandomRecord));
+    return true;
+}
+
+void CPMMachineIntel8080::SetRandomRecord(uint16_t fcb, size_t record)
+{
+    Store8(uint16_t(fcb + FCBRandomRecord), uint8_t(record));
+    Store8(uint16_t(fcb + FCBRandomRecord + 1), uint8_t(record >> 8));
+    Store8(uint16_t(fcb + FCBRandomRecord + 2), uint8_t(record >> 16));
+}
+
+// The sequential position is set to the record, so a sequential read or write accesses the same record
+uint8_t CPMMachineIntel8080::ReadRandom(uint16_t fcb)
+{
+    size_t record;
+    if (!RandomRecord(fcb, record))
+        return 6;
+    uint8_t result = ReadRecord(fcb, record);
+    if (result == 0)
+        SetSequentialRecord(fcb, record);
+    return result;
+}
+
+uint8_t CPMMachineIntel8080::WriteRandom(uint16_t fcb)
+{
+    size_t record;
+    if (!RandomRecord(fcb, record))
+        return 6;
+    uint8_t result = WriteRecord(fcb, record);
+    if (result == 0)
+        SetSequentialRecord(fcb, record);
+    return result;
+}
+
+void CPMMachineIntel8080::ComputeFileSize(uint16_t fcb)
+{
+    FilePtr file = GetFile(fcb, false);
+    SetRandomRecord(fcb, file ? FileRecords(*file) : 0);
+}
+
+CPMMachineIntel8080::DriveEntries & CPMMachineIntel8080::GetDriveEntries(size_t drive) const
+{
+    if (!driveListed[drive])
+    {
+        driveEntries[drive] = ListDrive(drive);
+        driveListed[drive] = true;
+    }
+    return driveEntries[drive];
+}
+
+void CPMMachineIntel8080::ResetDriveEntries()
+{
+    std::fill(driveListed.begin(), driveListed.end(), false);
+}
+
+CPMMachineIntel8080::DriveEntries CPMMachineIntel8080::ListDrive(size_t drive) const
+{
+    DriveEntries result;
+    std::vector<std::string> names;
+#if defined(_WIN32)
+    WIN32_FIND_DATAA data;
+    HANDLE handle = FindFirstFileA(Core::Path::CombinePath(drives[drive], "*").c_str(), &data);
+    if (handle != INVALID_HANDLE_VALUE)
+    {
+        do
+        {
+            if ((data.dwFileAttributes & FILE_ATTRIBUTE_DIRECTORY) == 0)
+                names.push_back(data.cFileName);
+        }
+        while (FindNextFileA(handle, &data));
+        FindClose(handle);
+    }
+#else
+    DIR * directory = opendir(drives[drive].c_str());
+    if (directory)
+    {
+        while (dirent * entry = readdir(directory))
+        {
+            if (Core::Path::FileExists(Core::Path::CombinePath(drives[drive], entry->d_name)))
+                names.push_back(entry->d_name);
+        }
+        closedir(directory);
+    }
+#endif
+    for (auto const & name : names)
+    {
+        std::string fcbName = FCBNameOf(name);
+        // The first of names only differing in case wins
+        if (!fcbName.empty() && (result.find(fcbName) == result.end()))
+            result[fcbName] = name;
+    }
+    return result;
+}
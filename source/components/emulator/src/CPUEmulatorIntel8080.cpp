@@ -2,6 +2,7 @@
 #include <iomanip>
 #include "core/Util.h"
 #include "emulator/RAM.h"
+#include "emulator/TraceIntel8080.h"
 
 using namespace std;
 using namespace Emulator;
@@ -19,10 +20,12 @@ std::wostream & Emulator::operator << (std::wostream & stream, FlagsIntel8080 va
     return stream;
 }
 
-CPUEmulatorIntel8080::CPUEmulatorIntel8080(Assembler::ObjectCode const & objectCode, Assembler::PrettyPrinter<wchar_t> & printer)
+CPUEmulatorIntel8080::CPUEmulatorIntel8080(Assembler::ObjectCode const & objectCode, Assembler::PrettyPrinter<wchar_t> & printer, std::ostream * traceStream,
+                                           std::shared_ptr<ProcessorIntel8080> processor)
     : objectCode(objectCode)
     , printer(printer)
-    , processor()
+    , traceStream(traceStream)
+    , processor(processor ? processor : std::make_shared<ProcessorIntel8080>())
 {
 }
 
@@ -80,8 +83,8 @@ bool CPUEmulatorIntel8080::OnCallback(RegistersIntel8080 const & registers)
 
 bool CPUEmulatorIntel8080::Run(Options options)
 {
-    RegistersIntel8080 & registers = processor.GetRegisters();
-    processor.Reset();
+    RegistersIntel8080 & registers = processor->GetRegisters();
+    processor->Reset();
     MemoryManagerPtr memoryManager = std::make_shared<MemoryManager>();
     ROMPtr rom = std::make_shared<ROM>(objectCode.GetSegment(Assembler::SegmentID::ASEG).Offset(), 
                                        objectCode.GetSegment(Assembler::SegmentID::ASEG).Size());
@@ -92,20 +95,29 @@ bool CPUEmulatorIntel8080::Run(Options options)
     IOManagerPtr ioManager = std::make_shared<IOManager>();
     IOPortPtr ioPort = std::make_shared<IOPort>(0, 256);
     ioManager->AddIO(ioPort);
-    processor.Setup(memoryManager, ioManager);
-    processor.LoadCode(objectCode.GetSegment(Assembler::SegmentID::ASEG).Data(), 
+    processor->Setup(memoryManager, ioManager);
+    processor->LoadCode(objectCode.GetSegment(Assembler::SegmentID::ASEG).Data(), 
                        objectCode.GetSegment(Assembler::SegmentID::ASEG).Offset(),
                        rom);
-    if ((options & Options::ShowInstructionResults) != Options::None)
+    // A binary trace takes precedence over printing the registers for every instruction
+    std::unique_ptr<TraceRecorderIntel8080> traceRecorder;
+    if (((options & Options::TraceInstructions) != Options::None) && traceStream)
     {
-        processor.SetupDebug(std::bind(&CPUEmulatorIntel8080::OnCallback, this, placeholders::_1));
+        traceRecorder.reset(new TraceRecorderIntel8080(*traceStream));
+        traceRecorder->Start(*processor);
+    }
+    else if ((options & Options::ShowInstructionResults) != Options::None)
+    {
+        processor->SetupDebug(std::bind(&CPUEmulatorIntel8080::OnCallback, this, placeholders::_1));
         registers.trace = true;
     }
     bool done = false;
     while (!done)
     {
-        done = !processor.RunInstruction();
+        done = !processor->RunInstruction();
     }
+    if (traceRecorder)
+        traceRecorder->Stop();
     if (((options & Options::ShowFinalResults) != Options::None) || ((options & Options::ShowInstructionResults) != Options::None))
         PrintRegisterValues(registers);
     return true;
@@ -0,0 +1,203 @@
+#include "emulator/CachedProcessorIntel8080.h"
+
+#include <algorithm>
+
+using namespace Emulator;
+
+CachedProcessorIntel8080::CachedProcessorIntel8080()
+    : FastProcessorIntel8080()
+    , blocks(MemoryManager::AddressSpaceSize)
+    , pageBlocks()
+    , retiredBlocks()
+    , codeModified()
+    , statistics()
+    , storeSubscription()
+{
+}
+
+CachedProcessorIntel8080::~CachedProcessorIntel8080()
+{
+    if (memoryManager)
+    {
+        FlushCache();
+        memoryManager->UnsubscribeStores(storeSubscription);
+    }
+}
+
+void CachedProcessorIntel8080::LoadCode(std::vector<uint8_t> const & machineCode, MemoryAddressType origin, ROMPtr rom)
+{
+    FastProcessorIntel8080::LoadCode(machineCode, origin, rom);
+    FlushCache();
+}
+
+void CachedProcessorIntel8080::LoadData(std::vector<uint8_t> const & data, MemoryAddressType origin, RAMPtr ram)
+{
+    FastProcessorIntel8080::LoadData(data, origin, ram);
+    FlushCache();
+}
+
+void CachedProcessorIntel8080::Setup(MemoryManagerPtr memoryManager, IOManagerPtr ioManager)
+{
+    FlushCache();
+    if (this->memoryManager)
+        this->memoryManager->UnsubscribeStores(storeSubscription);
+    FastProcessorIntel8080::Setup(memoryManager, ioManager);
+    pageBlocks.clear();
+    if (memoryManager)
+    {
+        pageBlocks.resize(MemoryManager::AddressSpaceSize / memoryManager->PageSize());
+        storeSubscription = memoryManager->SubscribeStores([this](size_t address) { OnStore(address); });
+    }
+}
+
+void CachedProcessorIntel8080::FlushCache()
+{
+    for (size_t pageIndex = 0; pageIndex < pageBlocks.size(); ++pageIndex)
+    {
+        if (!pageBlocks[pageIndex].empty())
+            memoryManager->WatchStores(pageIndex * memoryManager->PageSize(), false);
+        pageBlocks[pageIndex].clear();
+    }
+    for (auto & block : blocks)
+    {
+        if (block)
+            retiredBlocks.push_back(std::move(block));
+    }
+    codeModified = true;
+}
+
+size_t CachedProcessorIntel8080::CachedBlockCount() const
+{
+    return size_t(std::count_if(blocks.begin(), blocks.end(), [](BlockPtr const & block) { return block != nullptr; }));
+}
+
+bool CachedProcessorIntel8080::EndsBlock(OpcodesIntel8080 instruction)
+{
+    InstructionDataIntel8080 const & instructionData = instruction8080[uint8_t(instruction)];
+    // Invalid opcodes, and conditional jumps, calls and returns
+    if ((instructionData.instructionSize == 0) || (instructionData.machineStateCountConditionFailed != 0))
+        return true;
+    switch (instruction)
+    {
+    case OpcodesIntel8080::JMP:
+    case OpcodesIntel8080::CALL:
+    case OpcodesIntel8080::RET:
+    case OpcodesIntel8080::PCHL:
+    case OpcodesIntel8080::HLT:
+    case OpcodesIntel8080::RST_0:
+    case OpcodesIntel8080::RST_1:
+    case OpcodesIntel8080::RST_2:
+    case OpcodesIntel8080::RST_3:
+    case OpcodesIntel8080::RST_4:
+    case OpcodesIntel8080::RST_5:
+    case OpcodesIntel8080::RST_6:
+    case OpcodesIntel8080::RST_7:
+        return true;
+    default:
+        return false;
+    }
+}
+
+CachedProcessorIntel8080::Block * CachedProcessorIntel8080::TranslateBlock(MemoryAddressType address)
+{
+    BlockPtr block(new Block);
+    block->address = address;
+    block->size = 0;
+    size_t offset = address;
+    while ((block->microOps.size() < MaxBlockInstructions) && (offset < MemoryManager::AddressSpaceSize))
+    {
+        uint8_t data;
+        try
+        {
+            data = memoryManager->Fetch8(offset);
+        }
+        catch (std::exception &)
+        {
+            // Leave reporting the missing memory to the instruction fetch
+            if (block->microOps.empty())
+                throw;
+            break;
+        }
+        OpcodesIntel8080 instruction = OpcodesIntel8080(data);
+        size_t instructionSize = std::max(instruction8080[data].instructionSize, size_t{ 1 });
+        MicroOp microOp;
+        microOp.handler = decodedInstructionHandlers[data];
+        microOp.instruction = instruction;
+        microOp.operand = 0;
+        try
+        {
+            if (instructionSize == 2)
+                microOp.operand = memoryManager->Fetch8(offset + 1);
+            else if (instructionSize == 3)
+                microOp.operand = uint16_t(memoryManager->Fetch8(offset + 1) | (memoryManager->Fetch8(offset + 2) << 8));
+        }
+        catch (std::exception &)
+        {
+            // The operand runs into missing memory, leave the error to the handler fetching it
+            if (!block->microOps.empty())
+                break;
+            microOp.handler = instructionHandlers[data];
+        }
+        block->microOps.push_back(microOp);
+        offset += instructionSize;
+        if (EndsBlock(instruction))
+            break;
+    }
+    if (offset > MemoryManager::AddressSpaceSize)
+        offset = MemoryManager::AddressSpaceSize;
+    block->size = offset - address;
+
+    size_t pageSize = memoryManager->PageSize();
+    for (size_t pageIndex = address / pageSize; pageIndex <= (offset - 1) / pageSize; ++pageIndex)
+    {
+        if (pageBlocks[pageIndex].empty())
+            memoryManager->WatchStores(pageIndex * pageSize, true);
+        pageBlocks[pageIndex].push_back(address);
+    }
+    ++statistics.translations;
+    blocks[address] = std::move(block);
+    return blocks[address].get();
+}
+
+void CachedProcessorIntel8080::InvalidateBlock(MemoryAddressType address)
+{
+    BlockPtr & block = blocks[address];
+    if (!block)
+        return;
+    size_t pageSize = memoryManager->PageSize();
+    for (size_t pageIndex = address / pageSize; pageIndex <= (address + block->size - 1) / pageSize; ++pageIndex)
+    {
+        std::vector<MemoryAddressType> & addresses = pageBlocks[pageIndex];
+        addresses.erase(std::remove(addresses.begin(), addresses.end(), address), addresses.end());
+        if (addresses.empty())
+            memoryManager->WatchStores(pageIndex * pageSize, false);
+    }
+    // The block may be executing, so keep it alive until the run loop has left it
+    retiredBlocks.push_back(std::move(block));
+    ++statistics.invalidations;
+    codeModified = true;
+}
+
+void CachedProcessorIntel8080::OnStore(size_t address)
+{
+    size_t pageIndex = address / memoryManager->PageSize();
+    if (pageIndex >= pageBlocks.size())
+        return;
+    std::vector<MemoryAddressType> addresses = pageBlocks[pageIndex];
+    for (auto blockAddress : addresses)
+    {
+        Block const * block = blocks[blockAddress].get();
+        if ((block != nullptr) && (blockAddress <= address) && (address < blockAddress + block->size))
+            InvalidateBlock(blockAddress);
+    }
+}
+
+void CachedProcessorIntel8080::Run()
+{
+    RunBlocks([this](size_t) { return Step(); });
+}
+
+size_t CachedProcessorIntel8080::Run(size_t budget)
+{
+    return RunBlocks(budget, [this](size_t) { return Step(); });
+}
@@ -0,0 +1,56 @@
+#include "emulator/CoverageMapIntel8080.h"
+
+#include <algorithm>
+#include <cstring>
+
+using namespace Emulator;
+
+CoverageMapIntel8080::CoverageMapIntel8080()
+    : ownedMap(MapSize)
+    , map(ownedMap.data())
+    , fallThrough()
+{
+    Initialize();
+}
+
+CoverageMapIntel8080::CoverageMapIntel8080(uint8_t * externalMap)
+    : ownedMap()
+    , map(externalMap)
+    , fallThrough()
+{
+    Initialize();
+    Reset();
+}
+
+CoverageMapIntel8080::~CoverageMapIntel8080()
+{
+}
+
+void CoverageMapIntel8080::Initialize()
+{
+    for (size_t opcode = 0; opcode < 256; ++opcode)
+    {
+        switch (opcode & 0xC7)
+        {
+        case 0xC0: fallThrough[opcode] = 1; break;      // Rcc
+        case 0xC2: fallThrough[opcode] = 3; break;      // Jcc
+        case 0xC4: fallThrough[opcode] = 3; break;      // Ccc
+        case 0xC7: fallThrough[opcode] = 1; break;      // RST
+        default:   fallThrough[opcode] = 0; break;
+        }
+    }
+    fallThrough[0xC3] = 3;                              // JMP
+    fallThrough[0xCD] = 3;                              // CALL
+    fallThrough[0xC9] = 1;                              // RET
+    fallThrough[0xE9] = 1;                              // PCHL
+}
+
+void CoverageMapIntel8080::Reset()
+{
+    std::memset(map, 0, MapSize);
+}
+
+size_t CoverageMapIntel8080::EdgeCount() const
+{
+    return MapSize - size_t(std::count(map, map + MapSize, uint8_t{ 0 }));
+}
@@ -0,0 +1,120 @@
+#include "emulator/DiskControllerDevice.h"
+
+#include <algorithm>
+#include <stdexcept>
+
+using namespace Emulator;
+
+static const uint8_t FormattedByte = 0xE5;
+
+DiskControllerDevice::DiskControllerDevice(size_t base, size_t trackCount, size_t sectorsPerTrack, size_t sectorSize)
+    : IODevice(base, 4)
+    , trackCount(trackCount)
+    , sectorsPerTrack(sectorsPerTrack)
+    , image(trackCount * sectorsPerTrack * sectorSize, FormattedByte)
+    , sectorBuffer(sectorSize)
+    , bufferIndex()
+    , track()
+    , sector(1)
+    , status()
+{
+    if (sectorSize == 0)
+        throw std::invalid_argument("Invalid sector size for disk controller");
+}
+
+DiskControllerDevice::~DiskControllerDevice()
+{
+}
+
+void DiskControllerDevice::LoadImage(std::vector<uint8_t> const & data)
+{
+    size_t size = std::min(data.size(), image.size());
+    std::copy(data.begin(), data.begin() + size, image.begin());
+    std::fill(image.begin() + size, image.end(), FormattedByte);
+}
+
+bool DiskControllerDevice::SectorOffset(size_t & offset) const
+{
+    if ((track >= trackCount) || (sector < 1) || (sector > sectorsPerTrack))
+        return false;
+    offset = (track * sectorsPerTrack + (sector - 1)) * sectorBuffer.size();
+    return true;
+}
+
+uint8_t DiskControllerDevice::InRegister(size_t address) const
+{
+    CheckRange(address, 1, "In");
+    switch (address - base)
+    {
+    case TrackPort:
+        return track;
+    case SectorPort:
+        return sector;
+    default:
+        return status;
+    }
+}
+
+void DiskControllerDevice::OutRegister(size_t address, uint8_t data)
+{
+    CheckRange(address, 1, "Out");
+    switch (address - base)
+    {
+    case TrackPort:
+        track = data;
+        break;
+    case SectorPort:
+        sector = data;
+        break;
+    default:
+        {
+            size_t offset;
+            bufferIndex = 0;
+            status = 0;
+            if (((data != CommandRead) && (data != CommandWrite)) || !SectorOffset(offset))
+            {
+                status = StatusError;
+                break;
+            }
+            if (data == CommandRead)
+                std::copy(image.begin() + offset, image.begin() + offset + sectorBuffer.size(), sectorBuffer.begin());
+            else
+                std::copy(sectorBuffer.begin(), sectorBuffer.end(), image.begin() + offset);
+        }
+        break;
+    }
+}
+
+void DiskControllerDevice::InRepeated(size_t address, uint8_t * data, size_t count)
+{
+    if (address != base + DataPort)
+    {
+        IODevice::InRepeated(address, data, count);
+        return;
+    }
+    while (count > 0)
+    {
+        size_t chunk = std::min(count, sectorBuffer.size() - bufferIndex);
+        std::copy(sectorBuffer.begin() + bufferIndex, sectorBuffer.begin() + bufferIndex + chunk, data);
+        bufferIndex = (bufferIndex + chunk) % sectorBuffer.size();
+        data += chunk;
+        count -= chunk;
+    }
+}
+
+void DiskControllerDevice::OutRepeated(size_t address, uint8_t const * data, size_t count)
+{
+    if (address != base + DataPort)
+    {
+        IODevice::OutRepeated(address, data, count);
+        return;
+    }
+    while (count > 0)
+    {
+        size_t chunk = std::min(count, sectorBuffer.size() - bufferIndex);
+        std::copy(data, data + chunk, sectorBuffer.begin() + bufferIndex);
+        bufferIndex = (bufferIndex + chunk) % sectorBuffer.size();
+        data += chunk;
+        count -= chunk;
+    }
+}
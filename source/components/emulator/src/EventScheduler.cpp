@@ -0,0 +1,56 @@
+#include "emulator/EventScheduler.h"
+
+#include <algorithm>
+
+using namespace Emulator;
+
+EventScheduler::EventScheduler()
+    : events()
+    , nextID()
+{
+}
+
+EventScheduler::~EventScheduler()
+{
+}
+
+EventID EventScheduler::Schedule(uint64_t deadline, EventCallback const & callback)
+{
+    Event event;
+    event.deadline = deadline;
+    event.id = nextID++;
+    event.callback = callback;
+    events.push_back(event);
+    std::push_heap(events.begin(), events.end());
+    return event.id;
+}
+
+// Cancelling is rare compared to scheduling and running, so a linear search is good enough
+bool EventScheduler::Cancel(EventID id)
+{
+    auto it = std::find_if(events.begin(), events.end(), [id](Event const & event) { return event.id == id; });
+    if (it == events.end())
+        return false;
+    events.erase(it);
+    std::make_heap(events.begin(), events.end());
+    return true;
+}
+
+void EventScheduler::Clear()
+{
+    events.clear();
+}
+
+size_t EventScheduler::RunDue(uint64_t now)
+{
+    size_t count = 0;
+    while (!events.empty() && (events.front().deadline <= now))
+    {
+        std::pop_heap(events.begin(), events.end());
+        Event event = std::move(events.back());
+        events.pop_back();
+        event.callback(event.deadline);
+        ++count;
+    }
+    return count;
+}
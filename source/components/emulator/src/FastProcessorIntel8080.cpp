@@ -0,0 +1,1115 @@
+#include "emulator/FastProcessorIntel8080.h"
+
+#include "emulator/BreakpointManager.h"
+#include "emulator/CoverageMapIntel8080.h"
+#include "emulator/CPUVariantIntel8080.h"
+#include "emulator/ProcessorIntel8085.h"
+#include "emulator/ProfilerIntel8080.h"
+#include "emulator/TraceIntel8080.h"
+
+using namespace Emulator;
+
+namespace Emulator
+{
+
+enum Operand8 { OperandB, OperandC, OperandD, OperandE, OperandH, OperandL, OperandM, OperandA };
+enum Operand16 { OperandBC, OperandDE, OperandHL, OperandSP };
+enum Condition { ConditionNZ, ConditionZ, ConditionNC, ConditionC, ConditionPO, ConditionPE, ConditionP, ConditionM };
+
+using Processor = FastProcessorIntel8080;
+
+// Handlers for every opcode. Each handler executes one instruction, with pc already pointing
+// past the opcode byte, and returns the number of machine states it took.
+// Operands are template parameters, so the register selection is resolved at compile time,
+// as are the differences between the CPU variants.
+// Decoded handlers take their immediate data or address from decodedOperand instead of fetching it from memory.
+template<class Variant, bool Decoded>
+struct InstructionHandlersIntel8080
+{
+    static const Processor::InstructionHandler instructionTable[256];
+
+    static uint8_t Immediate8(Processor & processor)
+    {
+        if (!Decoded)
+            return processor.FetchByte();
+        ++processor.registers.pc;
+        return uint8_t(processor.decodedOperand);
+    }
+    static uint16_t Immediate16(Processor & processor)
+    {
+        if (!Decoded)
+            return processor.FetchWord();
+        processor.registers.pc += 2;
+        return processor.decodedOperand;
+    }
+
+    template<int R>
+    static uint8_t Get(Processor & processor)
+    {
+        RegistersIntel8080 & registers = processor.registers;
+        switch (R)
+        {
+        case OperandB:  return registers.bc.B.h;
+        case OperandC:  return registers.bc.B.l;
+        case OperandD:  return registers.de.B.h;
+        case OperandE:  return registers.de.B.l;
+        case OperandH:  return registers.hl.B.h;
+        case OperandL:  return registers.hl.B.l;
+        case OperandM:  return processor.memoryManager->Fetch8(registers.hl.W);
+        default:        return registers.a;
+        }
+    }
+    template<int R>
+    static void Set(Processor & processor, uint8_t value)
+    {
+        RegistersIntel8080 & registers = processor.registers;
+        switch (R)
+        {
+        case OperandB:  registers.bc.B.h = value; break;
+        case OperandC:  registers.bc.B.l = value; break;
+        case OperandD:  registers.de.B.h = value; break;
+        case OperandE:  registers.de.B.l = value; break;
+        case OperandH:  registers.hl.B.h = value; break;
+        case OperandL:  registers.hl.B.l = value; break;
+        case OperandM:  processor.memoryManager->Store8(registers.hl.W, value); break;
+        default:        registers.a = value; break;
+        }
+    }
+    template<int RP>
+    static Reg16 & Pair(Processor & processor)
+    {
+        RegistersIntel8080 & registers = processor.registers;
+        switch (RP)
+        {
+        case OperandBC: return registers.bc.W;
+        case OperandDE: return registers.de.W;
+        case OperandHL: return registers.hl.W;
+        default:        return registers.sp.W;
+        }
+    }
+    template<int C>
+    static bool Test(Processor & processor)
+    {
+        processor.MaterializeFlags();
+        FlagsIntel8080 flags = processor.registers.flags;
+        switch (C)
+        {
+        case ConditionNZ:   return (flags & FlagsIntel8080::Zero) == FlagsIntel8080::None;
+        case ConditionZ:    return (flags & FlagsIntel8080::Zero) != FlagsIntel8080::None;
+        case ConditionNC:   return (flags & FlagsIntel8080::Carry) == FlagsIntel8080::None;
+        case ConditionC:    return (flags & FlagsIntel8080::Carry) != FlagsIntel8080::None;
+        case ConditionPO:   return (flags & FlagsIntel8080::Parity) == FlagsIntel8080::None;
+        case ConditionPE:   return (flags & FlagsIntel8080::Parity) != FlagsIntel8080::None;
+        case ConditionP:    return (flags & FlagsIntel8080::Sign) == FlagsIntel8080::None;
+        default:            return (flags & FlagsIntel8080::Sign) != FlagsIntel8080::None;
+        }
+    }
+
+    // Eager evaluation of an ALU operation, updating flags
+    template<FlagsOperation Operation>
+    static uint8_t Evaluate(uint8_t a, uint8_t r, FlagsIntel8080 & flags)
+    {
+        uint8_t carry = uint8_t(flags & FlagsIntel8080::Carry);
+        uint8_t result;
+        switch (Operation)
+        {
+        case FlagsOperation::Add:   result = Processor::Add(a, r, flags); break;
+        case FlagsOperation::AddC:  result = Processor::AddC(a, r, flags); break;
+        case FlagsOperation::Sub:   result = Processor::Sub(a, r, flags); break;
+        case FlagsOperation::SubC:  result = Processor::SubC(a, r, flags); break;
+        case FlagsOperation::And:   result = Processor::And(a, r, flags); break;
+        case FlagsOperation::Xor:   result = Processor::Xor(a, r, flags); break;
+        case FlagsOperation::Or:    result = Processor::Or(a, r, flags); break;
+        case FlagsOperation::Cmp:   Processor::Cmp(a, r, flags); result = a; break;
+        case FlagsOperation::Inc:   result = Processor::Inc(a, flags); break;
+        case FlagsOperation::Dec:   result = Processor::Dec(a, flags); break;
+        default:                    result = a; break;
+        }
+        if (Variant::ExtendedFlags)
+            ExtendFlags<Operation>(a, r, carry, flags);
+        return result;
+    }
+    // V is the signed overflow of the operation, K the signed comparison result S xor V.
+    // Logical operations clear both, ANA / ANI also set AuxCarry.
+    template<FlagsOperation Operation>
+    static void ExtendFlags(uint8_t a, uint8_t r, uint8_t carry, FlagsIntel8080 & flags)
+    {
+        uint8_t overflow;
+        switch (Operation)
+        {
+        case FlagsOperation::Add:
+        case FlagsOperation::AddC:
+        case FlagsOperation::Inc:
+            {
+                uint8_t operand = (Operation == FlagsOperation::Inc) ? 1 : r;
+                uint8_t result = uint8_t(a + operand + ((Operation == FlagsOperation::AddC) ? carry : 0));
+                overflow = (a ^ result) & (operand ^ result) & 0x80;
+            }
+            break;
+        case FlagsOperation::Sub:
+        case FlagsOperation::SubC:
+        case FlagsOperation::Cmp:
+        case FlagsOperation::Dec:
+            {
+                uint8_t operand = (Operation == FlagsOperation::Dec) ? 1 : r;
+                uint8_t result = uint8_t(a - operand - ((Operation == FlagsOperation::SubC) ? carry : 0));
+                overflow = (a ^ operand) & (a ^ result) & 0x80;
+            }
+            break;
+        default:
+            flags &= ~(FlagsIntel8080::Overflow | FlagsIntel8080::KFlag);
+            if (Operation == FlagsOperation::And)
+                flags |= FlagsIntel8080::AuxCarry;
+            return;
+        }
+        SetOverflow(overflow != 0, flags);
+    }
+    static void SetOverflow(bool overflow, FlagsIntel8080 & flags)
+    {
+        bool sign = (flags & FlagsIntel8080::Sign) != FlagsIntel8080::None;
+        flags &= ~(FlagsIntel8080::Overflow | FlagsIntel8080::KFlag);
+        if (overflow)
+            flags |= FlagsIntel8080::Overflow;
+        if (overflow != sign)
+            flags |= FlagsIntel8080::KFlag;
+    }
+    // ALU operation, in lazy mode only the result is computed and the flags are left to EvaluateFlags().
+    // EvaluateFlags() only knows the 8080 flags, so variants with extended flags always evaluate eagerly.
+    template<FlagsOperation Operation>
+    static uint8_t Arithmetic(Processor & processor, uint8_t a, uint8_t r)
+    {
+        RegistersIntel8080 & registers = processor.registers;
+        if (!processor.lazyFlags || Variant::ExtendedFlags)
+            return Evaluate<Operation>(a, r, registers.flags);
+        uint8_t result;
+        switch (Operation)
+        {
+        case FlagsOperation::Add:   result = uint8_t(a + r); break;
+        case FlagsOperation::Sub:   result = uint8_t(a - r); break;
+        case FlagsOperation::And:   result = a & r; break;
+        case FlagsOperation::Xor:   result = a ^ r; break;
+        case FlagsOperation::Or:    result = a | r; break;
+        case FlagsOperation::Cmp:   result = a; break;
+        default:
+            // The result or the flags depend on the incoming flags
+            processor.MaterializeFlags();
+            processor.flagsInput = registers.flags;
+            switch (Operation)
+            {
+            case FlagsOperation::AddC:  result = uint8_t(a + r + (registers.flags & FlagsIntel8080::Carry)); break;
+            case FlagsOperation::SubC:  result = uint8_t(a - r - (registers.flags & FlagsIntel8080::Carry)); break;
+            case FlagsOperation::Inc:   result = uint8_t(a + 1); break;
+            default:                    result = uint8_t(a - 1); break;
+            }
+            break;
+        }
+        processor.flagsOperation = Operation;
+        processor.flagsOperand1 = a;
+        processor.flagsOperand2 = r;
+        return result;
+    }
+
+    static uint8_t Invalid(Processor & processor)
+    {
+        throw ProcessorInvalidInstruction(processor.instruction);
+    }
+    static uint8_t NOP(Processor &)
+    {
+        return 4;
+    }
+    template<int RP>
+    static uint8_t LXI(Processor & processor)
+    {
+        Pair<RP>(processor) = Immediate16(processor);
+        return 10;
+    }
+    template<int RP>
+    static uint8_t STAX(Processor & processor)
+    {
+        processor.memoryManager->Store8(Pair<RP>(processor), processor.registers.a);
+        return 7;
+    }
+    template<int RP>
+    static uint8_t LDAX(Processor & processor)
+    {
+        processor.registers.a = processor.memoryManager->Fetch8(Pair<RP>(processor));
+        return 7;
+    }
+    template<int RP>
+    static uint8_t INX(Processor & processor)
+    {
+        Pair<RP>(processor)++;
+        if (Variant::ExtendedFlags)
+            SetPairWrapped(processor, Pair<RP>(processor) == 0x0000);
+        return Variant::CyclesINX;
+    }
+    template<int RP>
+    static uint8_t DCX(Processor & processor)
+    {
+        Pair<RP>(processor)--;
+        if (Variant::ExtendedFlags)
+            SetPairWrapped(processor, Pair<RP>(processor) == 0xFFFF);
+        return Variant::CyclesINX;
+    }
+    // K reports INX / DCX wrapping around, for JK / JNK loops
+    static void SetPairWrapped(Processor & processor, bool wrapped)
+    {
+        FlagsIntel8080 & flags = processor.registers.flags;
+        flags &= ~FlagsIntel8080::KFlag;
+        if (wrapped)
+            flags |= FlagsIntel8080::KFlag;
+    }
+    template<int RP>
+    static uint8_t DAD(Processor & processor)
+    {
+        RegistersIntel8080 & registers = processor.registers;
+        processor.MaterializeFlags();
+        registers.hl.W = Processor::AddW(registers.hl.W, Pair<RP>(processor), registers.flags);
+        return 10;
+    }
+    template<int R>
+    static uint8_t INR(Processor & processor)
+    {
+        Set<R>(processor, Arithmetic<FlagsOperation::Inc>(processor, Get<R>(processor), 0));
+        return (R == OperandM) ? 10 : Variant::CyclesINRRegister;
+    }
+    template<int R>
+    static uint8_t DCR(Processor & processor)
+    {
+        Set<R>(processor, Arithmetic<FlagsOperation::Dec>(processor, Get<R>(processor), 0));
+        return (R == OperandM) ? 10 : Variant::CyclesINRRegister;
+    }
+    template<int R>
+    static uint8_t MVI(Processor & processor)
+    {
+        Set<R>(processor, Immediate8(processor));
+        return (R == OperandM) ? 10 : 7;
+    }
+    template<int D, int S>
+    static uint8_t MOV(Processor & processor)
+    {
+        Set<D>(processor, Get<S>(processor));
+        return ((D == OperandM) || (S == OperandM)) ? 7 : Variant::CyclesMOVRegister;
+    }
+    template<FlagsOperation Operation, int R>
+    static uint8_t ALU(Processor & processor)
+    {
+        RegistersIntel8080 & registers = processor.registers;
+        registers.a = Arithmetic<Operation>(processor, registers.a, Get<R>(processor));
+        return (R == OperandM) ? 7 : 4;
+    }
+    template<FlagsOperation Operation>
+    static uint8_t ALUImmediate(Processor & processor)
+    {
+        RegistersIntel8080 & registers = processor.registers;
+        registers.a = Arithmetic<Operation>(processor, registers.a, Immediate8(processor));
+        return 7;
+    }
+    static uint8_t RLC(Processor & processor)
+    {
+        processor.MaterializeFlags();
+        processor.registers.a = Processor::RLC(processor.registers.a, processor.registers.flags);
+        return 4;
+    }
+    static uint8_t RRC(Processor & processor)
+    {
+        processor.MaterializeFlags();
+        processor.registers.a = Processor::RRC(processor.registers.a, processor.registers.flags);
+        return 4;
+    }
+    static uint8_t RAL(Processor & processor)
+    {
+        processor.MaterializeFlags();
+        processor.registers.a = Processor::RAL(processor.registers.a, processor.registers.flags);
+        return 4;
+    }
+    static uint8_t RAR(Processor & processor)
+    {
+        processor.MaterializeFlags();
+        processor.registers.a = Processor::RAR(processor.registers.a, processor.registers.flags);
+        return 4;
+    }
+    static uint8_t DAA(Processor & processor)
+    {
+        processor.MaterializeFlags();
+        processor.registers.a = Processor::DAA(processor.registers.a, processor.registers.flags);
+        return 4;
+    }
+    static uint8_t CMA(Processor & processor)
+    {
+        processor.registers.a ^= 0xFF;
+        return 4;
+    }
+    static uint8_t STC(Processor & processor)
+    {
+        processor.MaterializeFlags();
+        processor.registers.flags |= FlagsIntel8080::Carry;
+        return 4;
+    }
+    static uint8_t CMC(Processor & processor)
+    {
+        processor.MaterializeFlags();
+        processor.registers.flags ^= FlagsIntel8080::Carry;
+        return 4;
+    }
+    static uint8_t SHLD(Processor & processor)
+    {
+        RegistersIntel8080 & registers = processor.registers;
+        registers.wz.W = Immediate16(processor);
+        processor.memoryManager->Store16(registers.wz.W, registers.hl.W);
+        return 16;
+    }
+    static uint8_t LHLD(Processor & processor)
+    {
+        RegistersIntel8080 & registers = processor.registers;
+        registers.wz.W = Immediate16(processor);
+        registers.hl.W = processor.memoryManager->Fetch16(registers.wz.W);
+        return 16;
+    }
+    static uint8_t STA(Processor & processor)
+    {
+        RegistersIntel8080 & registers = processor.registers;
+        registers.wz.W = Immediate16(processor);
+        processor.memoryManager->Store8(registers.wz.W, registers.a);
+        return 13;
+    }
+    static uint8_t LDA(Processor & processor)
+    {
+        RegistersIntel8080 & registers = processor.registers;
+        registers.wz.W = Immediate16(processor);
+        registers.a = processor.memoryManager->Fetch8(registers.wz.W);
+        return 13;
+    }
+    static uint8_t HLT(Processor & processor)
+    {
+        processor.registers.isHalted = true;
+        return Variant::CyclesHLT;
+    }
+    template<int C>
+    static uint8_t RET(Processor & processor)
+    {
+        if (!Test<C>(processor))
+            return Variant::CyclesRccNotTaken;
+        processor.registers.pc = processor.PopWord();
+        return Variant::CyclesRccTaken;
+    }
+    static uint8_t RET(Processor & processor)
+    {
+        processor.registers.pc = processor.PopWord();
+        return 10;
+    }
+    template<int C>
+    static uint8_t JMP(Processor & processor)
+    {
+        uint16_t address = Immediate16(processor);
+        if (!Test<C>(processor))
+            return Variant::CyclesJccNotTaken;
+        processor.registers.pc = address;
+        return 10;
+    }
+    static uint8_t JMP(Processor & processor)
+    {
+        processor.registers.pc = Immediate16(processor);
+        return 10;
+    }
+    template<int C>
+    static uint8_t CALL(Processor & processor)
+    {
+        RegistersIntel8080 & registers = processor.registers;
+        if (!Test<C>(processor))
+        {
+            registers.pc += 2;
+            return Variant::CyclesCccNotTaken;
+        }
+        registers.wz.W = Immediate16(processor);
+        processor.PushWord(registers.pc);
+        registers.pc = registers.wz.W;
+        return Variant::CyclesCALL;
+    }
+    static uint8_t CALL(Processor & processor)
+    {
+        RegistersIntel8080 & registers = processor.registers;
+        registers.wz.W = Immediate16(processor);
+        processor.PushWord(registers.pc);
+        registers.pc = registers.wz.W;
+        return Variant::CyclesCALL;
+    }
+    template<uint16_t Address>
+    static uint8_t RST(Processor & processor)
+    {
+        processor.PushWord(processor.registers.pc);
+        processor.registers.pc = Address;
+        return Variant::CyclesRST;
+    }
+    template<int RP>
+    static uint8_t PUSH(Processor & processor)
+    {
+        processor.PushWord(Pair<RP>(processor));
+        return Variant::CyclesPUSH;
+    }
+    template<int RP>
+    static uint8_t POP(Processor & processor)
+    {
+        Pair<RP>(processor) = processor.PopWord();
+        return 10;
+    }
+    static uint8_t PUSH_PSW(Processor & processor)
+    {
+        RegistersIntel8080 & registers = processor.registers;
+        processor.MaterializeFlags();
+        processor.PushWord(uint16_t(registers.a << 8 | ((uint8_t(registers.flags) & Variant::PSWMask) | Variant::PSWSet)));
+        return Variant::CyclesPUSH;
+    }
+    static uint8_t POP_PSW(Processor & processor)
+    {
+        RegistersIntel8080 & registers = processor.registers;
+        registers.wz.W = processor.PopWord();
+        registers.a = registers.wz.B.h;
+        registers.flags = FlagsIntel8080(registers.wz.B.l);
+        processor.flagsOperation = FlagsOperation::None;
+        return 10;
+    }
+    static uint8_t OUTP(Processor & processor)
+    {
+        processor.ioManager->Out8(Immediate8(processor), processor.registers.a);
+        return 10;
+    }
+    static uint8_t INP(Processor & processor)
+    {
+        processor.registers.a = processor.InPort(Immediate8(processor));
+        return 10;
+    }
+    static uint8_t XTHL(Processor & processor)
+    {
+        RegistersIntel8080 & registers = processor.registers;
+        registers.wz.W = processor.memoryManager->Fetch16(registers.sp.W);
+        processor.memoryManager->Store16(registers.sp.W, registers.hl.W);
+        registers.hl.W = registers.wz.W;
+        return Variant::CyclesXTHL;
+    }
+    static uint8_t PCHL(Processor & processor)
+    {
+        processor.registers.pc = processor.registers.hl.W;
+        return Variant::CyclesPCHL;
+    }
+    static uint8_t XCHG(Processor & processor)
+    {
+        std::swap(processor.registers.de.W, processor.registers.hl.W);
+        return 4;
+    }
+    static uint8_t SPHL(Processor & processor)
+    {
+        processor.registers.sp.W = processor.registers.hl.W;
+        return Variant::CyclesPCHL;
+    }
+    static uint8_t DI(Processor & processor)
+    {
+        processor.registers.ie = false;
+        return 4;
+    }
+    static uint8_t EI(Processor & processor)
+    {
+        processor.registers.ie = true;
+        // The request is accepted after the next instruction, which starts a new slice
+        if (processor.interruptController.IsPending())
+            processor.sliceEnd = 0;
+        return 4;
+    }
+
+    // 8085 only
+    static uint8_t RIM(Processor & processor)
+    {
+        ProcessorIntel8085 & processor8085 = static_cast<ProcessorIntel8085 &>(processor);
+        processor.registers.a = uint8_t((processor8085.serialInput ? 0x80 : 0x00) |
+                                        (processor.registers.ie ? 0x08 : 0x00) |
+                                        processor8085.interruptMasks);
+        return 4;
+    }
+    static uint8_t SIM(Processor & processor)
+    {
+        ProcessorIntel8085 & processor8085 = static_cast<ProcessorIntel8085 &>(processor);
+        uint8_t data = processor.registers.a;
+        // Mask set enable, serial output enable
+        if (data & 0x08)
+            processor8085.interruptMasks = data & 0x07;
+        if (data & 0x40)
+            processor8085.serialOutput = (data & 0x80) != 0;
+        return 4;
+    }
+    static uint8_t DSUB(Processor & processor)
+    {
+        RegistersIntel8080 & registers = processor.registers;
+        uint16_t hl = registers.hl.W;
+        uint16_t bc = registers.bc.W;
+        uint32_t result = uint32_t(hl) - bc;
+        registers.hl.W = uint16_t(result);
+        FlagsIntel8080 flags = FlagsIntel8080(Processor::flagsPZSTable[registers.hl.B.l] &
+                                              (FlagsIntel8080::Parity));
+        if (registers.hl.W == 0)
+            flags |= FlagsIntel8080::Zero;
+        if (registers.hl.W & 0x8000)
+            flags |= FlagsIntel8080::Sign;
+        if (result & 0x10000)
+            flags |= FlagsIntel8080::Carry;
+        if ((hl ^ bc ^ result) & 0x10)
+            flags |= FlagsIntel8080::AuxCarry;
+        SetOverflow(((hl ^ bc) & (hl ^ result) & 0x8000) != 0, flags);
+        registers.flags = flags;
+        return 10;
+    }
+    static uint8_t ARHL(Processor & processor)
+    {
+        RegistersIntel8080 & registers = processor.registers;
+        registers.flags &= ~FlagsIntel8080::Carry;
+        if (registers.hl.W & 0x0001)
+            registers.flags |= FlagsIntel8080::Carry;
+        registers.hl.W = uint16_t((registers.hl.W >> 1) | (registers.hl.W & 0x8000));
+        return 7;
+    }
+    static uint8_t RDEL(Processor & processor)
+    {
+        RegistersIntel8080 & registers = processor.registers;
+        uint16_t de = registers.de.W;
+        registers.de.W = uint16_t((de << 1) | ((registers.flags & FlagsIntel8080::Carry) ? 1 : 0));
+        registers.flags &= ~(FlagsIntel8080::Carry | FlagsIntel8080::Overflow);
+        if (de & 0x8000)
+            registers.flags |= FlagsIntel8080::Carry;
+        if ((de ^ registers.de.W) & 0x8000)
+            registers.flags |= FlagsIntel8080::Overflow;
+        return 10;
+    }
+    template<int RP>
+    static uint8_t LDXI(Processor & processor)
+    {
+        processor.registers.de.W = uint16_t(Pair<RP>(processor) + Immediate8(processor));
+        return 10;
+    }
+    static uint8_t RSTV(Processor & processor)
+    {
+        if ((processor.registers.flags & FlagsIntel8080::Overflow) == FlagsIntel8080::None)
+            return 6;
+        processor.PushWord(processor.registers.pc);
+        processor.registers.pc = 0x0040;
+        return 12;
+    }
+    static uint8_t SHLX(Processor & processor)
+    {
+        processor.memoryManager->Store16(processor.registers.de.W, processor.registers.hl.W);
+        return 10;
+    }
+    static uint8_t LHLX(Processor & processor)
+    {
+        processor.registers.hl.W = processor.memoryManager->Fetch16(processor.registers.de.W);
+        return 10;
+    }
+    template<bool K>
+    static uint8_t JK(Processor & processor)
+    {
+        uint16_t address = Immediate16(processor);
+        if (((processor.registers.flags & FlagsIntel8080::KFlag) != FlagsIntel8080::None) != K)
+            return 7;
+        processor.registers.pc = address;
+        return 10;
+    }
+};
+
+// Unqualified names resolve to the handlers of the instantiation. The opcodes the 8080 leaves unused
+// are the 8085 additions, only valid for variants with ExtendedInstructions.
+template<class Variant, bool Decoded>
+const FastProcessorIntel8080::InstructionHandler InstructionHandlersIntel8080<Variant, Decoded>::instructionTable[256] =
+{
+    // 00
+    &NOP, &LXI<OperandBC>, &STAX<OperandBC>, &INX<OperandBC>, &INR<OperandB>, &DCR<OperandB>, &MVI<OperandB>, &RLC,
+    // 08
+    Variant::ExtendedInstructions ? &DSUB : &Invalid, &DAD<OperandBC>, &LDAX<OperandBC>, &DCX<OperandBC>, &INR<OperandC>, &DCR<OperandC>, &MVI<OperandC>, &RRC,
+    // 10
+    Variant::ExtendedInstructions ? &ARHL : &Invalid, &LXI<OperandDE>, &STAX<OperandDE>, &INX<OperandDE>, &INR<OperandD>, &DCR<OperandD>, &MVI<OperandD>, &RAL,
+    // 18
+    Variant::ExtendedInstructions ? &RDEL : &Invalid, &DAD<OperandDE>, &LDAX<OperandDE>, &DCX<OperandDE>, &INR<OperandE>, &DCR<OperandE>, &MVI<OperandE>, &RAR,
+    // 20
+    Variant::ExtendedInstructions ? &RIM : &Invalid, &LXI<OperandHL>, &SHLD, &INX<OperandHL>, &INR<OperandH>, &DCR<OperandH>, &MVI<OperandH>, &DAA,
+    // 28
+    Variant::ExtendedInstructions ? &LDXI<OperandHL> : &Invalid, &DAD<OperandHL>, &LHLD, &DCX<OperandHL>, &INR<OperandL>, &DCR<OperandL>, &MVI<OperandL>, &CMA,
+    // 30
+    Variant::ExtendedInstructions ? &SIM : &Invalid, &LXI<OperandSP>, &STA, &INX<OperandSP>, &INR<OperandM>, &DCR<OperandM>, &MVI<OperandM>, &STC,
+    // 38
+    Variant::ExtendedInstructions ? &LDXI<OperandSP> : &Invalid, &DAD<OperandSP>, &LDA, &DCX<OperandSP>, &INR<OperandA>, &DCR<OperandA>, &MVI<OperandA>, &CMC,
+    // 40
+    &MOV<OperandB, OperandB>, &MOV<OperandB, OperandC>, &MOV<OperandB, OperandD>, &MOV<OperandB, OperandE>,
+    &MOV<OperandB, OperandH>, &MOV<OperandB, OperandL>, &MOV<OperandB, OperandM>, &MOV<OperandB, OperandA>,
+    // 48
+    &MOV<OperandC, OperandB>, &MOV<OperandC, OperandC>, &MOV<OperandC, OperandD>, &MOV<OperandC, OperandE>,
+    &MOV<OperandC, OperandH>, &MOV<OperandC, OperandL>, &MOV<OperandC, OperandM>, &MOV<OperandC, OperandA>,
+    // 50
+    &MOV<OperandD, OperandB>, &MOV<OperandD, OperandC>, &MOV<OperandD, OperandD>, &MOV<OperandD, OperandE>,
+    &MOV<OperandD, OperandH>, &MOV<OperandD, OperandL>, &MOV<OperandD, OperandM>, &MOV<OperandD, OperandA>,
+    // 58
+    &MOV<OperandE, OperandB>, &MOV<OperandE, OperandC>, &MOV<OperandE, OperandD>, &MOV<OperandE, OperandE>,
+    &MOV<OperandE, OperandH>, &MOV<OperandE, OperandL>, &MOV<OperandE, OperandM>, &MOV<OperandE, OperandA>,
+    // 60
+    &MOV<OperandH, OperandB>, &MOV<OperandH, OperandC>, &MOV<OperandH, OperandD>, &MOV<OperandH, OperandE>,
+    &MOV<OperandH, OperandH>, &MOV<OperandH, OperandL>, &MOV<OperandH, OperandM>, &MOV<OperandH, OperandA>,
+    // 68
+    &MOV<OperandL, OperandB>, &MOV<OperandL, OperandC>, &MOV<OperandL, OperandD>, &MOV<OperandL, OperandE>,
+    &MOV<OperandL, OperandH>, &MOV<OperandL, OperandL>, &MOV<OperandL, OperandM>, &MOV<OperandL, OperandA>,
+    // 70
+    &MOV<OperandM, OperandB>, &MOV<OperandM, OperandC>, &MOV<OperandM, OperandD>, &MOV<OperandM, OperandE>,
+    &MOV<OperandM, OperandH>, &MOV<OperandM, OperandL>, &HLT, &MOV<OperandM, OperandA>,
+    // 78
+    &MOV<OperandA, OperandB>, &MOV<OperandA, OperandC>, &MOV<OperandA, OperandD>, &MOV<OperandA, OperandE>,
+    &MOV<OperandA, OperandH>, &MOV<OperandA, OperandL>, &MOV<OperandA, OperandM>, &MOV<OperandA, OperandA>,
+    // 80
+    &ALU<FlagsOperation::Add, OperandB>, &ALU<FlagsOperation::Add, OperandC>, &ALU<FlagsOperation::Add, OperandD>, &ALU<FlagsOperation::Add, OperandE>,
+    &ALU<FlagsOperation::Add, OperandH>, &ALU<FlagsOperation::Add, OperandL>, &ALU<FlagsOperation::Add, OperandM>, &ALU<FlagsOperation::Add, OperandA>,
+    // 88
+    &ALU<FlagsOperation::AddC, OperandB>, &ALU<FlagsOperation::AddC, OperandC>, &ALU<FlagsOperation::AddC, OperandD>, &ALU<FlagsOperation::AddC, OperandE>,
+    &ALU<FlagsOperation::AddC, OperandH>, &ALU<FlagsOperation::AddC, OperandL>, &ALU<FlagsOperation::AddC, OperandM>, &ALU<FlagsOperation::AddC, OperandA>,
+    // 90
+    &ALU<FlagsOperation::Sub, OperandB>, &ALU<FlagsOperation::Sub, OperandC>, &ALU<FlagsOperation::Sub, OperandD>, &ALU<FlagsOperation::Sub, OperandE>,
+    &ALU<FlagsOperation::Sub, OperandH>, &ALU<FlagsOperation::Sub, OperandL>, &ALU<FlagsOperation::Sub, OperandM>, &ALU<FlagsOperation::Sub, OperandA>,
+    // 98
+    &ALU<FlagsOperation::SubC, OperandB>, &ALU<FlagsOperation::SubC, OperandC>, &ALU<FlagsOperation::SubC, OperandD>, &ALU<FlagsOperation::SubC, OperandE>,
+    &ALU<FlagsOperation::SubC, OperandH>, &ALU<FlagsOperation::SubC, OperandL>, &ALU<FlagsOperation::SubC, OperandM>, &ALU<FlagsOperation::SubC, OperandA>,
+    // A0
+    &ALU<FlagsOperation::And, OperandB>, &ALU<FlagsOperation::And, OperandC>, &ALU<FlagsOperation::And, OperandD>, &ALU<FlagsOperation::And, OperandE>,
+    &ALU<FlagsOperation::And, OperandH>, &ALU<FlagsOperation::And, OperandL>, &ALU<FlagsOperation::And, OperandM>, &ALU<FlagsOperation::And, OperandA>,
+    // A8
+    &ALU<FlagsOperation::Xor, OperandB>, &ALU<FlagsOperation::Xor, OperandC>, &ALU<FlagsOperation::Xor, OperandD>, &ALU<FlagsOperation::Xor, OperandE>,
+    &ALU<FlagsOperation::Xor, OperandH>, &ALU<FlagsOperation::Xor, OperandL>, &ALU<FlagsOperation::Xor, OperandM>, &ALU<FlagsOperation::Xor, OperandA>,
+    // B0
+    &ALU<FlagsOperation::Or, OperandB>, &ALU<FlagsOperation::Or, OperandC>, &ALU<FlagsOperation::Or, OperandD>, &ALU<FlagsOperation::Or, OperandE>,
+    &ALU<FlagsOperation::Or, OperandH>, &ALU<FlagsOperation::Or, OperandL>, &ALU<FlagsOperation::Or, OperandM>, &ALU<FlagsOperation::Or, OperandA>,
+    // B8
+    &ALU<FlagsOperation::Cmp, OperandB>, &ALU<FlagsOperation::Cmp, OperandC>, &ALU<FlagsOperation::Cmp, OperandD>, &ALU<FlagsOperation::Cmp, OperandE>,
+    &ALU<FlagsOperation::Cmp, OperandH>, &ALU<FlagsOperation::Cmp, OperandL>, &ALU<FlagsOperation::Cmp, OperandM>, &ALU<FlagsOperation::Cmp, OperandA>,
+    // C0
+    &RET<ConditionNZ>, &POP<OperandBC>, &JMP<ConditionNZ>, &JMP, &CALL<ConditionNZ>, &PUSH<OperandBC>, &ALUImmediate<FlagsOperation::Add>, &RST<0x0000>,
+    // C8
+    &RET<ConditionZ>, &RET, &JMP<ConditionZ>, Variant::ExtendedInstructions ? &RSTV : &Invalid, &CALL<ConditionZ>, &CALL, &ALUImmediate<FlagsOperation::AddC>, &RST<0x0008>,
+    // D0
+    &RET<ConditionNC>, &POP<OperandDE>, &JMP<ConditionNC>, &OUTP, &CALL<ConditionNC>, &PUSH<OperandDE>, &ALUImmediate<FlagsOperation::Sub>, &RST<0x0010>,
+    // D8
+    &RET<ConditionC>, Variant::ExtendedInstructions ? &SHLX : &Invalid, &JMP<ConditionC>, &INP, &CALL<ConditionC>, Variant::ExtendedInstructions ? &JK<false> : &Invalid, &ALUImmediate<FlagsOperation::SubC>, &RST<0x0018>,
+    // E0
+    &RET<ConditionPO>, &POP<OperandHL>, &JMP<ConditionPO>, &XTHL, &CALL<ConditionPO>, &PUSH<OperandHL>, &ALUImmediate<FlagsOperation::And>, &RST<0x0020>,
+    // E8
+    &RET<ConditionPE>, &PCHL, &JMP<ConditionPE>, &XCHG, &CALL<ConditionPE>, Variant::ExtendedInstructions ? &LHLX : &Invalid, &ALUImmediate<FlagsOperation::Xor>, &RST<0x0028>,
+    // F0
+    &RET<ConditionP>, &POP_PSW, &JMP<ConditionP>, &DI, &CALL<ConditionP>, &PUSH_PSW, &ALUImmediate<FlagsOperation::Or>, &RST<0x0030>,
+    // F8
+    &RET<ConditionM>, &SPHL, &JMP<ConditionM>, &EI, &CALL<ConditionM>, Variant::ExtendedInstructions ? &JK<true> : &Invalid, &ALUImmediate<FlagsOperation::Cmp>, &RST<0x0038>,
+};
+
+} // namespace Emulator
+
+const FastProcessorIntel8080::InstructionHandler * const FastProcessorIntel8080::instructionHandlers =
+    InstructionHandlersIntel8080<CPUVariantIntel8080>::instructionTable;
+const FastProcessorIntel8080::InstructionHandler * const FastProcessorIntel8080::decodedInstructionHandlers =
+    InstructionHandlersIntel8080<CPUVariantIntel8080, true>::instructionTable;
+const FastProcessorIntel8080::InstructionHandler * const ProcessorIntel8085::instructionHandlers8085 =
+    InstructionHandlersIntel8080<CPUVariantIntel8085>::instructionTable;
+
+FastProcessorIntel8080::FastProcessorIntel8080()
+    : FastProcessorIntel8080(instructionHandlers)
+{
+}
+
+FastProcessorIntel8080::FastProcessorIntel8080(InstructionHandler const * handlers)
+    : ProcessorIntel8080()
+    , handlers(handlers)
+    , lazyFlags()
+    , flagsOperation(FlagsOperation::None)
+    , flagsOperand1()
+    , flagsOperand2()
+    , flagsInput()
+    , idleLoopRejected()
+    , idleLoopBackoff()
+    , sliceEnd()
+    , decodedOperand()
+{
+}
+
+FastProcessorIntel8080::~FastProcessorIntel8080()
+{
+}
+
+void FastProcessorIntel8080::Reset()
+{
+    flagsOperation = FlagsOperation::None;
+    idleLoopBackoff = 0;
+    ProcessorIntel8080::Reset();
+}
+
+void FastProcessorIntel8080::FetchInstruction()
+{
+    // The debug callback gets to see the actual flags
+    MaterializeFlags();
+    ProcessorIntel8080::FetchInstruction();
+}
+
+void FastProcessorIntel8080::EvaluateFlags()
+{
+    using H = InstructionHandlersIntel8080<CPUVariantIntel8080>;
+    FlagsIntel8080 flags = flagsInput;
+    switch (flagsOperation)
+    {
+    case FlagsOperation::Add:   H::Evaluate<FlagsOperation::Add>(flagsOperand1, flagsOperand2, flags); break;
+    case FlagsOperation::AddC:  H::Evaluate<FlagsOperation::AddC>(flagsOperand1, flagsOperand2, flags); break;
+    case FlagsOperation::Sub:   H::Evaluate<FlagsOperation::Sub>(flagsOperand1, flagsOperand2, flags); break;
+    case FlagsOperation::SubC:  H::Evaluate<FlagsOperation::SubC>(flagsOperand1, flagsOperand2, flags); break;
+    case FlagsOperation::And:   H::Evaluate<FlagsOperation::And>(flagsOperand1, flagsOperand2, flags); break;
+    case FlagsOperation::Xor:   H::Evaluate<FlagsOperation::Xor>(flagsOperand1, flagsOperand2, flags); break;
+    case FlagsOperation::Or:    H::Evaluate<FlagsOperation::Or>(flagsOperand1, flagsOperand2, flags); break;
+    case FlagsOperation::Cmp:   H::Evaluate<FlagsOperation::Cmp>(flagsOperand1, flagsOperand2, flags); break;
+    case FlagsOperation::Inc:   H::Evaluate<FlagsOperation::Inc>(flagsOperand1, flagsOperand2, flags); break;
+    case FlagsOperation::Dec:   H::Evaluate<FlagsOperation::Dec>(flagsOperand1, flagsOperand2, flags); break;
+    default:                    flags = registers.flags; break;
+    }
+    registers.flags = flags;
+    flagsOperation = FlagsOperation::None;
+}
+
+void FastProcessorIntel8080::ExecuteInstruction()
+{
+    registers.instructionCycles = handlers[uint8_t(instruction)](*this);
+    if (registers.cycleCountPeriod != 0)
+        registers.cycleCount -= registers.instructionCycles;
+}
+
+// The loop of Run(), with the profiling and coverage compiled in or out
+template<bool Instrumented>
+void FastProcessorIntel8080::RunInstructions()
+{
+    InstructionHandler const * table = handlers;
+    while (!registers.isHalted)
+    {
+        if (Instrumented && traceRecorder)
+            RecordTrace();
+        MemoryAddressType pc = registers.pc;
+        uint8_t data = memoryManager->FetchOpcode8(pc);
+        ++registers.pc;
+        instruction = OpcodesIntel8080(data);
+        registers.instructionCycles = table[data](*this);
+        if (registers.cycleCountPeriod != 0)
+            registers.cycleCount -= registers.instructionCycles;
+        if (Instrumented)
+        {
+#if !defined(EMULATOR_NO_PROFILER)
+            if (profiler)
+                profiler->Record(pc, data, registers.pc, registers.instructionCycles);
+#endif
+            if (coverage)
+                coverage->Record(pc, data, registers.pc);
+        }
+    }
+}
+
+// The inner loop of Run(budget). cycles is updated after every instruction, so it is correct when a breakpoint stops the loop.
+// Instrumented, for a profiler, a coverage map, a replay log or a trace, also keeps cycleCountTotal exact for every instruction.
+template<bool Instrumented>
+void FastProcessorIntel8080::RunSlice(size_t & cycles)
+{
+    InstructionHandler const * table = handlers;
+    while (!registers.isHalted && (cycles < sliceEnd))
+    {
+        if (Instrumented && traceRecorder)
+            RecordTrace();
+        MemoryAddressType pc = registers.pc;
+        uint8_t data = memoryManager->FetchOpcode8(pc);
+        ++registers.pc;
+        instruction = OpcodesIntel8080(data);
+        registers.instructionCycles = table[data](*this);
+        cycles += registers.instructionCycles;
+        if (Instrumented)
+        {
+            registers.cycleCountTotal += registers.instructionCycles;
+#if !defined(EMULATOR_NO_PROFILER)
+            if (profiler)
+                profiler->Record(pc, data, registers.pc, registers.instructionCycles);
+#endif
+            if (coverage)
+                coverage->Record(pc, data, registers.pc);
+        }
+    }
+}
+
+#if !defined(EMULATOR_NO_PROFILER)
+// RunInstructions() with a profiler and no other instrumentation, recording without going through the profiler
+void FastProcessorIntel8080::RunProfiledInstructions()
+{
+    InstructionHandler const * table = handlers;
+    ProfilerIntel8080::Recorder recorder(*profiler);
+    while (!registers.isHalted)
+    {
+        MemoryAddressType pc = registers.pc;
+        uint8_t data = memoryManager->FetchOpcode8(pc);
+        ++registers.pc;
+        instruction = OpcodesIntel8080(data);
+        registers.instructionCycles = table[data](*this);
+        if (registers.cycleCountPeriod != 0)
+            registers.cycleCount -= registers.instructionCycles;
+        recorder.Record(pc, data, registers.pc, registers.instructionCycles);
+    }
+}
+
+// RunSlice<true>() with a profiler and no other instrumentation
+void FastProcessorIntel8080::RunProfiledSlice(size_t & cycles)
+{
+    InstructionHandler const * table = handlers;
+    ProfilerIntel8080::Recorder recorder(*profiler);
+    while (!registers.isHalted && (cycles < sliceEnd))
+    {
+        MemoryAddressType pc = registers.pc;
+        uint8_t data = memoryManager->FetchOpcode8(pc);
+        ++registers.pc;
+        instruction = OpcodesIntel8080(data);
+        registers.instructionCycles = table[data](*this);
+        cycles += registers.instructionCycles;
+        registers.cycleCountTotal += registers.instructionCycles;
+        recorder.Record(pc, data, registers.pc, registers.instructionCycles);
+    }
+}
+#endif
+
+// The record describes the state before the instruction, so the lazy flags have to be up to date
+void FastProcessorIntel8080::RecordTrace()
+{
+    MaterializeFlags();
+    traceRecorder->Record(registers);
+}
+
+// RunSlice() for idle skipping, checking taken jumps back for idle loops
+void FastProcessorIntel8080::RunIdleSlice(size_t & cycles)
+{
+    InstructionHandler const * table = handlers;
+    while (!registers.isHalted && (cycles < sliceEnd))
+    {
+        MemoryAddressType pc = registers.pc;
+        uint8_t data = memoryManager->FetchOpcode8(pc);
+        ++registers.pc;
+        instruction = OpcodesIntel8080(data);
+        registers.instructionCycles = table[data](*this);
+        cycles += registers.instructionCycles;
+        if ((registers.pc <= pc) && (pc - registers.pc < MaxIdleLoopLength) &&
+            ((data == 0xC3) || ((data & 0xC7) == 0xC2)))
+            SkipIdleLoop(pc, cycles);
+    }
+}
+
+// Called after the jump at address jump went back to the start of a loop.
+// Runs the next iteration, and if that ends in the state it started with, skips iterations up to sliceEnd.
+void FastProcessorIntel8080::SkipIdleLoop(MemoryAddressType jump, size_t & cycles)
+{
+    MemoryAddressType start = registers.pc;
+    if (cycles >= sliceEnd)
+        return;
+    if ((start == idleLoopRejected) && (idleLoopBackoff != 0))
+    {
+        --idleLoopBackoff;
+        return;
+    }
+    if (!IsIdleLoopCode(start, jump))
+    {
+        RejectIdleLoop(start);
+        return;
+    }
+    MaterializeFlags();
+    RegistersIntel8080 const before = registers;
+    size_t iterationStart = cycles;
+    InstructionHandler const * table = handlers;
+    do
+    {
+        MemoryAddressType pc = registers.pc;
+        if ((pc < start) || (pc > jump))
+        {
+            RejectIdleLoop(start);
+            return;
+        }
+        uint8_t data = memoryManager->FetchOpcode8(pc);
+        ++registers.pc;
+        instruction = OpcodesIntel8080(data);
+        registers.instructionCycles = table[data](*this);
+        cycles += registers.instructionCycles;
+        // The rest of the iteration runs in the next slice, after the event due
+        if (cycles >= sliceEnd)
+            return;
+    }
+    while (registers.pc != start);
+    MaterializeFlags();
+    if ((registers.a != before.a) || (registers.flags != before.flags) || (registers.bc.W != before.bc.W) ||
+        (registers.de.W != before.de.W) || (registers.hl.W != before.hl.W) || (registers.sp.W != before.sp.W))
+    {
+        RejectIdleLoop(start);
+        return;
+    }
+    // Only whole iterations are skipped, so the event is handled at the same instruction as without skipping
+    size_t iterationCycles = cycles - iterationStart;
+    size_t skip = (sliceEnd - cycles) / iterationCycles * iterationCycles;
+    if (skip == 0)
+        return;
+    cycles += skip;
+    ++idleStatistics.loopSkips;
+    idleStatistics.loopCycles += skip;
+}
+
+// Checks the code of a loop for instructions that may change memory, ports, the stack or the interrupt state,
+// or leave the loop other than by falling through or a jump, and for reads from ports with side effects.
+bool FastProcessorIntel8080::IsIdleLoopCode(MemoryAddressType start, MemoryAddressType jump) const
+{
+    MemoryAddressType address = start;
+    while (address <= jump)
+    {
+        uint8_t data = memoryManager->Fetch8(address);
+        size_t size = instruction8080[data].instructionSize;
+        if (size == 0)
+            return false;
+        switch (OpcodesIntel8080(data))
+        {
+        case OpcodesIntel8080::STAX_B:
+        case OpcodesIntel8080::STAX_D:
+        case OpcodesIntel8080::SHLD:
+        case OpcodesIntel8080::STA:
+        case OpcodesIntel8080::INR_M:
+        case OpcodesIntel8080::DCR_M:
+        case OpcodesIntel8080::MVI_M:
+        case OpcodesIntel8080::HLT:
+        case OpcodesIntel8080::OUTP:
+        case OpcodesIntel8080::XTHL:
+        case OpcodesIntel8080::PCHL:
+        case OpcodesIntel8080::EI:
+        case OpcodesIntel8080::DI:
+            return false;
+        case OpcodesIntel8080::INP:
+            // A skipped iteration would not repeat the side effects of the read
+            if (!ioManager->IsPassiveIn(memoryManager->Fetch8(MemoryAddressType(address + 1))))
+                return false;
+            break;
+        default:
+            break;
+        }
+        // MOV M,r, pushes, calls, returns and restarts
+        if (((data & 0xF8) == 0x70) || ((data & 0xCF) == 0xC5) || ((data & 0xC7) == 0xC4) || (data == 0xCD) ||
+            ((data & 0xC7) == 0xC0) || (data == 0xC9) || ((data & 0xC7) == 0xC7))
+            return false;
+        address = MemoryAddressType(address + size);
+    }
+    return true;
+}
+
+void FastProcessorIntel8080::Run()
+{
+    // Trap, trace or a halted processor need the checks in FetchInstruction(), so run the
+    // instruction by instruction loop until none of them apply anymore
+    while (NeedsTraceChecks() || IsHalted())
+    {
+        if (!RunInstruction())
+            return;
+    }
+    bool instrumented = (coverage != nullptr) || (traceRecorder != nullptr);
+#if !defined(EMULATOR_NO_PROFILER)
+    bool profiledOnly = !instrumented && (profiler != nullptr);
+    instrumented = instrumented || (profiler != nullptr);
+#endif
+    try
+    {
+#if !defined(EMULATOR_NO_PROFILER)
+        if (profiledOnly)
+            RunProfiledInstructions();
+        else
+#endif
+        if (instrumented)
+            RunInstructions<true>();
+        else
+            RunInstructions<false>();
+    }
+    catch (ExecutionBreak const &)
+    {
+    }
+    MaterializeFlags();
+}
+
+size_t FastProcessorIntel8080::Run(size_t budget)
+{
+    if (NeedsTraceChecks())
+        return ProcessorIntel8080::Run(budget);
+    size_t cycles = 0;
+    bool periodic = (registers.cycleCountPeriod != 0);
+    if (periodic && !registers.isHalted && (registers.cycleCount <= 0) && !PeriodElapsed())
+        return 0;
+    bool instrumented = (replayLog != nullptr) || (coverage != nullptr) || (traceRecorder != nullptr);
+#if !defined(EMULATOR_NO_PROFILER)
+    bool profiledOnly = !instrumented && (profiler != nullptr);
+    instrumented = instrumented || (profiler != nullptr);
+#endif
+    bool skipIdleLoops = idleSkipping && !instrumented;
+    MaterializeFlags();
+    ServiceEvents();
+    while (cycles < budget)
+    {
+        if (registers.isHalted)
+        {
+            MaterializeFlags();
+            if (!SkipHalted(cycles, budget))
+                break;
+            continue;
+        }
+        // Run up to the end of the budget, the current period or the next event, whichever comes first,
+        // so the inner loop needs no bookkeeping for any of them
+        size_t sliceStart = cycles;
+        sliceEnd = cycles + EventSliceLength(budget - cycles);
+        if (periodic)
+        {
+            size_t periodLeft = (registers.cycleCount > 0) ? size_t(registers.cycleCount) : 1;
+            if (periodLeft < sliceEnd - cycles)
+                sliceEnd = cycles + periodLeft;
+        }
+        bool stopped = false;
+        try
+        {
+#if !defined(EMULATOR_NO_PROFILER)
+            if (profiledOnly)
+                RunProfiledSlice(cycles);
+            else
+#endif
+            if (instrumented)
+                RunSlice<true>(cycles);
+            else if (skipIdleLoops)
+                RunIdleSlice(cycles);
+            else
+                RunSlice<false>(cycles);
+        }
+        catch (ExecutionBreak const &)
+        {
+            stopped = true;
+        }
+        catch (std::exception const &)
+        {
+            // Keep cycleCountTotal up to the failing instruction, as RunInstruction() does
+            if (!instrumented)
+                registers.cycleCountTotal += cycles - sliceStart;
+            MaterializeFlags();
+            throw;
+        }
+        if (!instrumented)
+            registers.cycleCountTotal += cycles - sliceStart;
+        if (periodic)
+        {
+            registers.cycleCount -= int64_t(cycles - sliceStart);
+            if (registers.cycleCount <= 0)
+            {
+                MaterializeFlags();
+                if (!PeriodElapsed())
+                    break;
+            }
+        }
+        if (stopped)
+            break;
+        if (EventsDue())
+        {
+            MaterializeFlags();
+            ServiceEvents();
+        }
+    }
+    MaterializeFlags();
+    return cycles;
+}
@@ -0,0 +1,232 @@
+#include "emulator/FuzzerIntel8080.h"
+
+#include <algorithm>
+#include "emulator/IODevice.h"
+#include "emulator/IOManager.h"
+#include "emulator/ROM.h"
+
+using namespace Emulator;
+
+namespace Emulator
+{
+
+// Serves the input on every port, one byte per read
+class FuzzerIntel8080::InputDevice : public IODevice
+{
+public:
+    InputDevice()
+        : IODevice(0, IOManager::PortCount)
+        , input()
+        , position()
+    {}
+
+    void SetInput(std::vector<uint8_t> const & data)
+    {
+        input = data;
+        position = 0;
+    }
+
+    uint8_t In8(size_t /*address*/) const override
+    {
+        return (position < input.size()) ? input[position++] : 0;
+    }
+    void Out8(size_t /*address*/, uint8_t /*data*/) override
+    {
+    }
+
+private:
+    std::vector<uint8_t> input;
+    mutable size_t position;
+};
+
+} // namespace Emulator
+
+// Bit of the AFL hit count bucket of a map entry
+static uint8_t Bucket(uint8_t hits)
+{
+    if (hits < 4)
+        return (hits == 3) ? 0x04 : hits;
+    if (hits < 8)
+        return 0x08;
+    if (hits < 16)
+        return 0x10;
+    if (hits < 32)
+        return 0x20;
+    if (hits < 128)
+        return 0x40;
+    return 0x80;
+}
+
+static const uint8_t InterestingValues[] = { 0x00, 0x01, 0x02, 0x0A, 0x0D, 0x10, 0x20, 0x30, 0x39, 0x41, 0x7F, 0x80, 0xFE, 0xFF };
+
+FuzzerIntel8080::FuzzerIntel8080(Assembler::ObjectCode const & objectCode, uint32_t seed,
+                                 size_t maxCycles, size_t maxInputSize)
+    : maxCycles(maxCycles)
+    , maxInputSize(maxInputSize)
+    , random(seed)
+    , processor()
+    , memoryManager()
+    , rom()
+    , ram()
+    , inputDevice()
+    , coverage()
+    , virgin(CoverageMapIntel8080::MapSize, 0xFF)
+    , virginCrashes(CoverageMapIntel8080::MapSize, 0xFF)
+    , corpus()
+    , crashes()
+    , statistics()
+{
+    Assembler::CodeSegment const & segment = objectCode.GetSegment(Assembler::SegmentID::ASEG);
+    size_t ramOffset = segment.Offset() + segment.Size();
+    memoryManager = std::make_shared<MemoryManager>();
+    rom = std::make_shared<ROM>(segment.Offset(), segment.Size());
+    ram = std::make_shared<RAM>(ramOffset, MemoryManager::AddressSpaceSize - ramOffset);
+    memoryManager->AddMemory(rom);
+    memoryManager->AddMemory(ram);
+    IOManagerPtr ioManager = std::make_shared<IOManager>();
+    inputDevice = std::make_shared<InputDevice>();
+    ioManager->AddIO(inputDevice);
+    processor.Setup(memoryManager, ioManager);
+    processor.LoadCode(segment.Data(), segment.Offset(), rom);
+    processor.SetCoverage(&coverage);
+}
+
+FuzzerIntel8080::~FuzzerIntel8080()
+{
+}
+
+FuzzRunIntel8080 FuzzerIntel8080::Execute(std::vector<uint8_t> const & input)
+{
+    FuzzRunIntel8080 run;
+    ram->Load(std::vector<uint8_t>(), ram->Offset());
+    inputDevice->SetInput(input);
+    coverage.Reset();
+    processor.Reset();
+    processor.GetRegisters().isHalted = false;
+    try
+    {
+        processor.Run(maxCycles);
+    }
+    catch (std::exception & e)
+    {
+        run.error = e.what();
+        if (run.error.empty())
+            run.error = "Unknown error";
+    }
+    RegistersIntel8080 const & registers = processor.GetRegisters();
+    // With a coverage map attached, cycleCountTotal is exact up to the instruction throwing
+    run.cycles = registers.cycleCountTotal;
+    run.halted = registers.isHalted;
+    run.timedOut = !run.halted && run.error.empty();
+
+    ++statistics.executions;
+    if (run.Crashed())
+    {
+        ++statistics.crashes;
+        // The address the run stopped at counts as an edge, so crashes at different places on the same path are told apart
+        coverage.RecordEdge(registers.pc, registers.pc);
+        run.newCoverage = MergeCoverage(virginCrashes, false);
+        if (run.newCoverage)
+            crashes.push_back(input);
+        return run;
+    }
+    if (run.timedOut)
+        ++statistics.timeouts;
+    run.newCoverage = MergeCoverage(virgin, true);
+    // Inputs running into the cycle limit only slow down fuzzing, so they are not kept
+    if (run.newCoverage && !run.timedOut)
+        corpus.push_back(input);
+    return run;
+}
+
+void FuzzerIntel8080::Run(size_t iterations)
+{
+    if (statistics.executions == 0)
+        Execute(std::vector<uint8_t>());
+    for (size_t iteration = 0; iteration < iterations; ++iteration)
+    {
+        std::vector<uint8_t> input = corpus.empty() ? std::vector<uint8_t>() : corpus[RandomIndex(corpus.size())];
+        Execute(Mutate(input));
+    }
+}
+
+bool FuzzerIntel8080::MergeCoverage(std::vector<uint8_t> & virginMap, bool countEdges)
+{
+    bool newCoverage = false;
+    uint8_t const * map = coverage.Data();
+    for (size_t index = 0; index < CoverageMapIntel8080::MapSize; ++index)
+    {
+        if (map[index] == 0)
+            continue;
+        uint8_t bucket = Bucket(map[index]);
+        if ((virginMap[index] & bucket) == 0)
+            continue;
+        if (countEdges && (virginMap[index] == 0xFF))
+            ++statistics.edges;
+        virginMap[index] &= uint8_t(~bucket);
+        newCoverage = true;
+    }
+    return newCoverage;
+}
+
+// One to four random changes, as the havoc stage of AFL does
+std::vector<uint8_t> FuzzerIntel8080::Mutate(std::vector<uint8_t> const & input)
+{
+    std::vector<uint8_t> result = input;
+    size_t changes = 1 + RandomIndex(4);
+    for (size_t change = 0; change < changes; ++change)
+    {
+        size_t mutation = RandomIndex(8);
+        // Only growing the input makes sense when it is empty
+        if (result.empty())
+            mutation = 4;
+        switch (mutation)
+        {
+        case 0:
+            result[RandomIndex(result.size())] ^= uint8_t(1 << RandomIndex(8));
+            break;
+        case 1:
+            result[RandomIndex(result.size())] = RandomByte();
+            break;
+        case 2:
+            result[RandomIndex(result.size())] = InterestingValues[RandomIndex(sizeof(InterestingValues))];
+            break;
+        case 3:
+            {
+                uint8_t delta = uint8_t(1 + RandomIndex(16));
+                uint8_t & data = result[RandomIndex(result.size())];
+                data = (RandomIndex(2) == 0) ? uint8_t(data + delta) : uint8_t(data - delta);
+            }
+            break;
+        case 4:
+            if (result.size() < maxInputSize)
+                result.insert(result.begin() + RandomIndex(result.size() + 1), RandomByte());
+            break;
+        case 5:
+            result.erase(result.begin() + RandomIndex(result.size()));
+            break;
+        case 6:
+            {
+                size_t start = RandomIndex(result.size());
+                size_t length = std::min(1 + RandomIndex(result.size() - start), maxInputSize - std::min(maxInputSize, result.size()));
+                std::vector<uint8_t> block(result.begin() + start, result.begin() + start + length);
+                result.insert(result.begin() + RandomIndex(result.size() + 1), block.begin(), block.end());
+            }
+            break;
+        case 7:
+            // Splice: the head of this input with the tail of another one
+            if (!corpus.empty())
+            {
+                std::vector<uint8_t> const & other = corpus[RandomIndex(corpus.size())];
+                size_t split = RandomIndex(result.size() + 1);
+                result.resize(split);
+                if (!other.empty())
+                    result.insert(result.end(), other.begin() + std::min(split, other.size()), other.end());
+                if (result.size() > maxInputSize)
+                    result.resize(maxInputSize);
+            }
+            break;
+        }
+    }
+    return result;
+}
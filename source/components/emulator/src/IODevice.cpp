@@ -0,0 +1,119 @@
+#include "emulator/IODevice.h"
+
+#include <sstream>
+#include <iomanip>
+#include <stdexcept>
+
+using namespace Emulator;
+
+IODevice::IODevice(size_t base, size_t size)
+    : base(base)
+    , size(size)
+{
+}
+
+IODevice::~IODevice()
+{
+}
+
+size_t IODevice::Offset() const
+{
+    return base;
+}
+
+size_t IODevice::Size() const
+{
+    return size;
+}
+
+bool IODevice::IsPassiveIn(size_t /*address*/) const
+{
+    return false;
+}
+
+void IODevice::CheckRange(size_t address, size_t count, char const * operation) const
+{
+    if ((address < base) || (address + count > base + size))
+    {
+        std::ostringstream stream;
+        stream << operation << " outside IO device region (" << std::hex << std::setw(8) << std::setfill('0') << base << "-"
+               << std::setw(8) << std::setfill('0') << base + size - 1 << "), trying to access @ "
+               << std::setw(8) << std::setfill('0') << address << std::dec;
+        throw std::runtime_error(stream.str());
+    }
+}
+
+std::vector<uint8_t> IODevice::In(size_t address, size_t size) const
+{
+    std::vector<uint8_t> data(size);
+    In(address, data.data(), size);
+    return data;
+}
+
+void IODevice::Out(size_t address, std::vector<uint8_t> const & data)
+{
+    Out(address, data.data(), data.size());
+}
+
+void IODevice::In(size_t address, uint8_t * data, size_t size) const
+{
+    CheckRange(address, size, "In");
+    for (size_t index = 0; index < size; ++index)
+        data[index] = In8(address + index);
+}
+
+void IODevice::Out(size_t address, uint8_t const * data, size_t size)
+{
+    CheckRange(address, size, "Out");
+    for (size_t index = 0; index < size; ++index)
+        Out8(address + index, data[index]);
+}
+
+uint16_t IODevice::In16(size_t address) const
+{
+    uint8_t data[2];
+    In(address, data, sizeof(data));
+    return uint16_t(data[0] | (data[1] << 8));
+}
+
+void IODevice::Out16(size_t address, uint16_t data)
+{
+    uint8_t bytes[2] = { uint8_t(data), uint8_t(data >> 8) };
+    Out(address, bytes, sizeof(bytes));
+}
+
+uint32_t IODevice::In32(size_t address) const
+{
+    return uint32_t(In16(address)) | (uint32_t(In16(address + 2)) << 16);
+}
+
+void IODevice::Out32(size_t address, uint32_t data)
+{
+    Out16(address, uint16_t(data));
+    Out16(address + 2, uint16_t(data >> 16));
+}
+
+uint64_t IODevice::In64(size_t address) const
+{
+    return uint64_t(In32(address)) | (uint64_t(In32(address + 4)) << 32);
+}
+
+void IODevice::Out64(size_t address, uint64_t data)
+{
+    Out32(address, uint32_t(data));
+    Out32(address + 4, uint32_t(data >> 32));
+}
+
+void IODevice::InRepeated(size_t address, uint8_t * data, size_t count)
+{
+    CheckRange(address, 1, "In");
+    for (size_t index = 0; index < count; ++index)
+        data[index] = In8(address);
+}
+
+void IODevice::OutRepeated(size_t address, uint8_t const * data, size_t count)
+{
+    CheckRange(address, 1, "Out");
+    for (size_t index = 0; index < count; ++index)
+        Out8(address, data[index]);
+}
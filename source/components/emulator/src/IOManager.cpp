@@ -4,11 +4,13 @@
 #include <iomanip>
 #include <algorithm>
 #include <limits>
+#include "emulator/IOPort.h"
 
 using namespace Emulator;
 
 IOManager::IOManager()
     : ioPorts()
+    , portTable(PortCount)
 {
 
 }
@@ -21,6 +23,24 @@ IOManager::~IOManager()
 void IOManager::AddIO(IIOPtr io)
 {
     ioPorts.push_back(io);
+    MapPorts(io);
+}
+
+// Enter a newly added block in the port table. As with the lookup, a port claimed by an earlier block stays with it.
+void IOManager::MapPorts(IIOPtr io)
+{
+    IOPortPtr ioPort = std::dynamic_pointer_cast<IOPort>(io);
+    IODevice * device = dynamic_cast<IODevice *>(io.get());
+    size_t end = std::min(io->Offset() + io->Size(), PortCount);
+    for (size_t address = io->Offset(); address < end; ++address)
+    {
+        IOPortEntry & entry = portTable[address];
+        if (entry.io)
+            continue;
+        entry.io = io.get();
+        entry.device = device;
+        entry.contents = ioPort ? ioPort->Data() + (address - io->Offset()) : nullptr;
+    }
 }
 
 size_t IOManager::Offset() const
@@ -58,11 +78,17 @@ IIOPtr IOManager::FindIOPortForOffsetSize(size_t offset) const
 }
 
 std::vector<uint8_t> IOManager::In(size_t address, size_t size) const
+{
+    std::vector<uint8_t> data(size);
+    In(address, data.data(), size);
+    return data;
+}
+
+void IOManager::In(size_t address, uint8_t * data, size_t size) const
 {
     size_t count = size;
     size_t offset = address;
     size_t dataOffset = 0;
-    std::vector<uint8_t> data(size);
     while (count > 0)
     {
         IIOPtr ioBlock = FindIOPortForOffsetSize(offset);
@@ -73,19 +99,21 @@ std::vector<uint8_t> IOManager::In(size_t address, size_t size) const
             throw std::runtime_error(stream.str());
         }
         size_t maxBytes = std::min(count, ioBlock->Size() - (offset - ioBlock->Offset()));
-        while (maxBytes > 0)
-        {
-            data[dataOffset++] = ioBlock->In8(offset++);
-            maxBytes--;
-            count--;
-        }
+        ioBlock->In(offset, data + dataOffset, maxBytes);
+        offset += maxBytes;
+        dataOffset += maxBytes;
+        count -= maxBytes;
     }
-    return data;
 }
 
 void IOManager::Out(size_t address, std::vector<uint8_t> const & data)
 {
-    size_t count = data.size();
+    Out(address, data.data(), data.size());
+}
+
+void IOManager::Out(size_t address, uint8_t const * data, size_t size)
+{
+    size_t count = size;
     size_t offset = address;
     size_t dataOffset = 0;
     while (count > 0)
@@ -98,16 +126,14 @@ void IOManager::Out(size_t address, std::vector<uint8_t> const & data)
             throw std::runtime_error(stream.str());
         }
         size_t maxBytes = std::min(count, ioBlock->Size() - (offset - ioBlock->Offset()));
-        while (maxBytes > 0)
-        {
-            ioBlock->Out8(offset++, data[dataOffset++]);
-            maxBytes--;
-            count--;
-        }
+        ioBlock->Out(offset, data + dataOffset, maxBytes);
+        offset += maxBytes;
+        dataOffset += maxBytes;
+        count -= maxBytes;
     }
 }
 
-uint8_t IOManager::In8(size_t address) const
+uint8_t IOManager::InBlock8(size_t address) const
 {
     IIOPtr ioBlock = FindIOPortForOffsetSize(address);
     if (ioBlock)
@@ -117,7 +143,7 @@ uint8_t IOManager::In8(size_t address) const
     throw std::runtime_error(stream.str());
 }
 
-void IOManager::Out8(size_t address, uint8_t data)
+void IOManager::OutBlock8(size_t address, uint8_t data)
 {
     IIOPtr ioBlock = FindIOPortForOffsetSize(address);
     if (ioBlock)
@@ -130,6 +156,28 @@ void IOManager::Out8(size_t address, uint8_t data)
     throw std::runtime_error(stream.str());
 }
 
+void IOManager::InRepeated(size_t address, uint8_t * data, size_t count)
+{
+    if ((address < PortCount) && portTable[address].device)
+    {
+        portTable[address].device->InRepeated(address, data, count);
+        return;
+    }
+    for (size_t index = 0; index < count; ++index)
+        data[index] = In8(address);
+}
+
+void IOManager::OutRepeated(size_t address, uint8_t const * data, size_t count)
+{
+    if ((address < PortCount) && portTable[address].device)
+    {
+        portTable[address].device->OutRepeated(address, data, count);
+        return;
+    }
+    for (size_t index = 0; index < count; ++index)
+        Out8(address, data[index]);
+}
+
 uint16_t IOManager::In16(size_t address) const
 {
     size_t offset = address;
@@ -2,6 +2,7 @@
 
 #include <sstream>
 #include <iomanip>
+#include <cstring>
 
 using namespace Emulator;
 
@@ -68,6 +69,13 @@ size_t IOPort::Size() const
 }
 
 std::vector<uint8_t> IOPort::In(size_t address, size_t size) const
+{
+    std::vector<uint8_t> data(size);
+    In(address, data.data(), size);
+    return data;
+}
+
+void IOPort::In(size_t address, uint8_t * data, size_t size) const
 {
     if ((address < base) || (address + size > base + ports.size()))
     {
@@ -78,25 +86,28 @@ std::vector<uint8_t> IOPort::In(size_t address, size_t size) const
                << std::setw(8) << std::setfill('0') << address + size << std::dec;
         throw std::runtime_error(stream.str());
     }
-    size_t offset = address - base;
-    std::vector<uint8_t> data(size);
-    std::copy(ports.begin() + offset, ports.begin() + offset + size, data.begin());
-    return data;
+    if (size > 0)
+        std::memcpy(data, ports.data() + (address - base), size);
 }
 
 void IOPort::Out(size_t address, std::vector<uint8_t> const & data)
 {
-    if ((address < base) || (address + data.size() > base + ports.size()))
+    Out(address, data.data(), data.size());
+}
+
+void IOPort::Out(size_t address, uint8_t const * data, size_t size)
+{
+    if ((address < base) || (address + size > base + ports.size()))
     {
         std::ostringstream stream;
-        stream << "In outside IOPort region (" << std::hex << std::setw(8) << std::setfill('0') << base << "-" 
-               << std::setw(8) << std::setfill('0') << base + ports.size() - 1 << "), trying to fetch @ "
+        stream << "Out outside IOPort region (" << std::hex << std::setw(8) << std::setfill('0') << base << "-" 
+               << std::setw(8) << std::setfill('0') << base + ports.size() - 1 << "), trying to store @ "
                << std::setw(8) << std::setfill('0') << address << "-"
-               << std::setw(8) << std::setfill('0') << address + data.size() << std::dec;
+               << std::setw(8) << std::setfill('0') << address + size << std::dec;
         throw std::runtime_error(stream.str());
     }
-    size_t offset = address - base;
-    std::copy(data.begin(), data.end(), ports.begin() + offset);
+    if (size > 0)
+        std::memcpy(ports.data() + (address - base), data, size);
 }
 
 uint8_t IOPort::In8(size_t address) const
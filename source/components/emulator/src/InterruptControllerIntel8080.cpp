@@ -0,0 +1,54 @@
+#include "emulator/InterruptControllerIntel8080.h"
+
+#include <sstream>
+#include <stdexcept>
+
+using namespace Emulator;
+
+static void CheckLevel(uint8_t level)
+{
+    if (level >= InterruptControllerIntel8080::LevelCount)
+    {
+        std::ostringstream stream;
+        stream << "Invalid interrupt level " << int(level);
+        throw std::runtime_error(stream.str());
+    }
+}
+
+InterruptControllerIntel8080::InterruptControllerIntel8080()
+    : pending()
+    , mask()
+{
+}
+
+InterruptControllerIntel8080::~InterruptControllerIntel8080()
+{
+}
+
+void InterruptControllerIntel8080::Request(uint8_t level)
+{
+    CheckLevel(level);
+    pending |= uint8_t(1 << level);
+}
+
+void InterruptControllerIntel8080::Cancel(uint8_t level)
+{
+    CheckLevel(level);
+    pending &= uint8_t(~(1 << level));
+}
+
+void InterruptControllerIntel8080::Reset()
+{
+    pending = 0;
+    mask = 0;
+}
+
+uint8_t InterruptControllerIntel8080::Acknowledge()
+{
+    uint8_t active = pending & ~mask;
+    uint8_t level = LevelCount - 1;
+    while ((level > 0) && ((active & (1 << level)) == 0))
+        --level;
+    pending &= uint8_t(~(1 << level));
+    return level;
+}
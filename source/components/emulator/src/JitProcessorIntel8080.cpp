@@ -0,0 +1,1395 @@
+#include "emulator/JitProcessorIntel8080.h"
+
+#include <algorithm>
+#include <cstddef>
+#include <cstring>
+#include <initializer_list>
+#include <limits>
+#include "osal/memory.h"
+
+#if defined(__x86_64__) && !defined(_WIN32)
+#define JIT_X86_64
+#endif
+
+using namespace Emulator;
+
+// Cycles for a slice without a limit, leaves room for the last block to run past it
+static const int64_t UnlimitedSlice = std::numeric_limits<int64_t>::max() / 2;
+
+#if defined(JIT_X86_64)
+
+namespace
+{
+
+enum HostRegister : uint8_t
+{
+    RAX, RCX, RDX, RBX, RSP, RBP, RSI, RDI, R8, R9, R10, R11, R12, R13, R14, R15,
+};
+
+// Host register holding each register pair, indexed by the pair field of the opcode
+const HostRegister PairRegisters[] = { R12, R13, R14, R15 };
+
+const uint8_t AllFlags = FlagsIntel8080::Sign | FlagsIntel8080::Zero | FlagsIntel8080::AuxCarry |
+                         FlagsIntel8080::Parity | FlagsIntel8080::Carry;
+// Flags tested by each condition field of a conditional jump, call or return
+const uint8_t ConditionFlags[] =
+{
+    FlagsIntel8080::Zero, FlagsIntel8080::Zero, FlagsIntel8080::Carry, FlagsIntel8080::Carry,
+    FlagsIntel8080::Parity, FlagsIntel8080::Parity, FlagsIntel8080::Sign, FlagsIntel8080::Sign,
+};
+
+// x86-64 machine code writer, stops writing and flags overflow at the end of the buffer
+class CodeWriter
+{
+public:
+    CodeWriter(uint8_t * start, uint8_t * end)
+        : cursor(start)
+        , end(end)
+        , overflow()
+    {}
+
+    uint8_t * Here() const { return cursor; }
+    bool Overflow() const { return overflow; }
+
+    void Byte(uint8_t value)
+    {
+        if (cursor < end)
+            *cursor++ = value;
+        else
+            overflow = true;
+    }
+    void Bytes(std::initializer_list<uint8_t> values)
+    {
+        for (auto value : values)
+            Byte(value);
+    }
+    void Word(uint16_t value)
+    {
+        Byte(uint8_t(value));
+        Byte(uint8_t(value >> 8));
+    }
+    void Dword(uint32_t value)
+    {
+        Word(uint16_t(value));
+        Word(uint16_t(value >> 16));
+    }
+    void Qword(uint64_t value)
+    {
+        Dword(uint32_t(value));
+        Dword(uint32_t(value >> 32));
+    }
+    void Rex(bool wide, int reg, int base)
+    {
+        uint8_t rex = uint8_t(0x40 | (wide ? 0x08 : 0x00) | ((reg & 8) >> 1) | ((base & 8) >> 3));
+        if (rex != 0x40)
+            Byte(rex);
+    }
+    void ModRM(int mod, int reg, int rm)
+    {
+        Byte(uint8_t((mod << 6) | ((reg & 7) << 3) | (rm & 7)));
+    }
+    // Register operands. Byte registers 4 - 7 without REX are ah, ch, dh, bh.
+    void RR(std::initializer_list<uint8_t> opcode, int reg, int rm, bool wide = false)
+    {
+        Rex(wide, reg, rm);
+        Bytes(opcode);
+        ModRM(3, reg, rm);
+    }
+    // Register and [rbp + displacement] operands
+    void RM(std::initializer_list<uint8_t> opcode, int reg, int32_t displacement, bool wide = false)
+    {
+        Rex(wide, reg, RBP);
+        Bytes(opcode);
+        ModRM(2, reg, RBP);
+        Dword(uint32_t(displacement));
+    }
+    void MovImm(HostRegister reg, uint32_t value)
+    {
+        Rex(false, 0, reg);
+        Byte(uint8_t(0xB8 + (reg & 7)));
+        Dword(value);
+    }
+    void MovImm64(HostRegister reg, uint64_t value)
+    {
+        Rex(true, 0, reg);
+        Byte(uint8_t(0xB8 + (reg & 7)));
+        Qword(value);
+    }
+    // Jump with a 32 bit displacement, returns the location of the displacement for later patching
+    uint8_t * Jump(std::initializer_list<uint8_t> opcode)
+    {
+        Bytes(opcode);
+        uint8_t * displacement = cursor;
+        Dword(0);
+        return overflow ? nullptr : displacement;
+    }
+
+private:
+    uint8_t * cursor;
+    uint8_t * end;
+    bool overflow;
+};
+
+} // namespace anonymous
+
+// Translates one basic block into the code cache.
+// Register use in translated code:
+//   rbp        the processor
+//   bl, bh     A and the flags, in the layout of LAHF
+//   r12 - r15  BC, DE, HL, SP, zero extended
+//   eax, ecx, edx, esi, edi  scratch, esi and edx hold address and data for memory accesses
+class JitProcessorIntel8080::Translator
+{
+public:
+    Translator(JitProcessorIntel8080 & processor, uint8_t * start, uint8_t * end)
+        : processor(processor)
+        , code(start, end)
+        , instructions()
+        , stubs()
+        , offsetPC(Offset(&processor.registers.pc))
+        , offsetSP(Offset(&processor.registers.sp.W))
+        , offsetBC(Offset(&processor.registers.bc.W))
+        , offsetDE(Offset(&processor.registers.de.W))
+        , offsetHL(Offset(&processor.registers.hl.W))
+        , offsetWZ(Offset(&processor.registers.wz.W))
+        , offsetA(Offset(&processor.registers.a))
+        , offsetFlags(Offset(&processor.registers.flags))
+        , offsetInstructionCycles(Offset(&processor.registers.instructionCycles))
+        , offsetInstruction(Offset(&processor.instruction))
+        , offsetCyclesLeft(Offset(&processor.cyclesLeft))
+        , offsetPages(Offset(&processor.pages))
+        , offsetEntryTable(Offset(&processor.entryTable))
+        , offsetCodeModified(Offset(&processor.codeModified))
+        , offsetAborted(Offset(&processor.aborted))
+    {}
+
+    uint8_t * Here() const { return code.Here(); }
+    bool Overflow() const { return code.Overflow(); }
+
+    void GenerateEntry();
+    void GenerateExit();
+    uint8_t const * Translate(MemoryAddressType address, Block & block);
+
+private:
+    struct Instruction
+    {
+        MemoryAddressType address;
+        uint8_t opcode;
+        uint16_t operand;
+        uint8_t size;
+        uint8_t cycles;
+        uint8_t liveFlags;      // Flags read after this instruction
+    };
+    // Code leaving to the run loop
+    struct Stub
+    {
+        std::vector<uint8_t *> jumps;
+        size_t cycles;          // Cycles still to account for, 0 if already done before jumping here
+        MemoryAddressType pc;
+        uint8_t instructionCycles;
+        uint8_t opcode;
+        bool exit;              // Chainable exit of the block
+        uint8_t * chainJump;
+    };
+
+    JitProcessorIntel8080 & processor;
+    CodeWriter code;
+    std::vector<Instruction> instructions;
+    std::vector<Stub> stubs;
+    int32_t offsetPC;
+    int32_t offsetSP;
+    int32_t offsetBC;
+    int32_t offsetDE;
+    int32_t offsetHL;
+    int32_t offsetWZ;
+    int32_t offsetA;
+    int32_t offsetFlags;
+    int32_t offsetInstructionCycles;
+    int32_t offsetInstruction;
+    int32_t offsetCyclesLeft;
+    int32_t offsetPages;
+    int32_t offsetEntryTable;
+    int32_t offsetCodeModified;
+    int32_t offsetAborted;
+
+    int32_t Offset(void const * member) const
+    {
+        return int32_t(static_cast<uint8_t const *>(member) - reinterpret_cast<uint8_t const *>(&processor));
+    }
+
+    static bool IsTranslated(uint8_t opcode);
+    static bool EndsBlock(uint8_t opcode);
+    static bool MayStore(uint8_t opcode);
+    static uint8_t DefinedFlags(uint8_t opcode);
+    static uint8_t UsedFlags(uint8_t opcode);
+
+    bool Decode(MemoryAddressType address);
+    void ComputeLiveFlags();
+    void EmitInstruction(Instruction const & instruction, size_t cyclesBefore);
+
+    size_t AddStub(size_t cycles, MemoryAddressType pc, Instruction const & instruction, uint8_t instructionCycles)
+    {
+        Stub stub;
+        stub.cycles = cycles;
+        stub.pc = pc;
+        stub.instructionCycles = instructionCycles;
+        stub.opcode = instruction.opcode;
+        stub.exit = false;
+        stub.chainJump = nullptr;
+        stubs.push_back(stub);
+        return stubs.size() - 1;
+    }
+    void JumpToStub(std::initializer_list<uint8_t> opcode, size_t stub)
+    {
+        stubs[stub].jumps.push_back(code.Jump(opcode));
+    }
+    void EmitStubs(Block & block);
+
+    void Get8(int r, HostRegister destination);
+    void Set8(int r);
+    void IncrementPair(HostRegister pair, bool decrement);
+    void Load(size_t abortStub);
+    void Store(size_t abortStub);
+    void LoadM(Instruction const & instruction, size_t cyclesBefore, HostRegister destination);
+    void StoreM(Instruction const & instruction, size_t cyclesBefore);
+    void Push(Instruction const & instruction, size_t cyclesBefore, int pair, uint16_t value);
+    void Pop(Instruction const & instruction, size_t cyclesBefore);
+    void CaptureFlags(uint8_t mask);
+    void CaptureCarry();
+    void CallAccumulatorHelper(uint8_t (* helper)(uint8_t a, FlagsIntel8080 & flags));
+    void CarryIn();
+    void EmitExit(Instruction const & instruction, size_t cycles, MemoryAddressType target, uint8_t instructionCycles);
+    void EmitDynamicExit(Instruction const & instruction, size_t cycles, uint8_t instructionCycles);
+    uint8_t * TestCondition(uint8_t opcode);
+};
+
+void JitProcessorIntel8080::Translator::GenerateEntry()
+{
+    // void enter(JitProcessorIntel8080 * processor, uint8_t const * code)
+    code.Byte(0x53);                                // push rbx
+    code.Byte(0x55);                                // push rbp
+    code.Bytes({ 0x41, 0x54 });                     // push r12
+    code.Bytes({ 0x41, 0x55 });                     // push r13
+    code.Bytes({ 0x41, 0x56 });                     // push r14
+    code.Bytes({ 0x41, 0x57 });                     // push r15
+    code.Bytes({ 0x48, 0x83, 0xEC, 0x08 });         // sub rsp, 8 (align the stack for calls, [rsp] is a scratch slot)
+    code.RR({ 0x89 }, RDI, RBP, true);              // mov rbp, rdi
+    code.RM({ 0x0F, 0xB6 }, RBX, offsetA);          // movzx ebx, byte [a]
+    code.RM({ 0x8A }, 7, offsetFlags);              // mov bh, [flags]
+    code.RM({ 0x0F, 0xB7 }, R12, offsetBC);         // movzx r12d, word [bc]
+    code.RM({ 0x0F, 0xB7 }, R13, offsetDE);
+    code.RM({ 0x0F, 0xB7 }, R14, offsetHL);
+    code.RM({ 0x0F, 0xB7 }, R15, offsetSP);
+    code.Bytes({ 0xFF, 0xE6 });                     // jmp rsi
+}
+
+void JitProcessorIntel8080::Translator::GenerateExit()
+{
+    code.RM({ 0x88 }, RBX, offsetA);                // mov [a], bl
+    code.RM({ 0x88 }, 7, offsetFlags);              // mov [flags], bh
+    code.Byte(0x66);
+    code.RM({ 0x89 }, R12, offsetBC);               // mov [bc], r12w
+    code.Byte(0x66);
+    code.RM({ 0x89 }, R13, offsetDE);
+    code.Byte(0x66);
+    code.RM({ 0x89 }, R14, offsetHL);
+    code.Byte(0x66);
+    code.RM({ 0x89 }, R15, offsetSP);
+    code.Bytes({ 0x48, 0x83, 0xC4, 0x08 });         // add rsp, 8
+    code.Bytes({ 0x41, 0x5F });                     // pop r15
+    code.Bytes({ 0x41, 0x5E });                     // pop r14
+    code.Bytes({ 0x41, 0x5D });                     // pop r13
+    code.Bytes({ 0x41, 0x5C });                     // pop r12
+    code.Byte(0x5D);                                // pop rbp
+    code.Byte(0x5B);                                // pop rbx
+    code.Byte(0xC3);                                // ret
+}
+
+bool JitProcessorIntel8080::Translator::IsTranslated(uint8_t opcode)
+{
+    if ((opcode >= 0x40) && (opcode < 0xC0))
+        return opcode != uint8_t(OpcodesIntel8080::HLT);
+    switch (OpcodesIntel8080(opcode))
+    {
+    case OpcodesIntel8080::OUTP:
+    case OpcodesIntel8080::INP:
+    case OpcodesIntel8080::XTHL:
+    case OpcodesIntel8080::DI:
+    case OpcodesIntel8080::EI:
+        return false;
+    default:
+        // Invalid opcodes have no size
+        return instruction8080[opcode].instructionSize != 0;
+    }
+}
+
+bool JitProcessorIntel8080::Translator::EndsBlock(uint8_t opcode)
+{
+    switch (opcode & 0xC7)
+    {
+    case 0xC0:  // Rcc
+    case 0xC2:  // Jcc
+    case 0xC4:  // Ccc
+    case 0xC7:  // RST
+        return true;
+    default:
+        break;
+    }
+    switch (OpcodesIntel8080(opcode))
+    {
+    case OpcodesIntel8080::JMP:
+    case OpcodesIntel8080::CALL:
+    case OpcodesIntel8080::RET:
+    case OpcodesIntel8080::PCHL:
+        return true;
+    default:
+        return false;
+    }
+}
+
+// Instructions after which the block may have to be left because code was overwritten
+bool JitProcessorIntel8080::Translator::MayStore(uint8_t opcode)
+{
+    if ((opcode & 0xF8) == 0x70)
+        return true;
+    if ((opcode & 0xCF) == 0xC5)
+        return true;
+    switch (OpcodesIntel8080(opcode))
+    {
+    case OpcodesIntel8080::STAX_B:
+    case OpcodesIntel8080::STAX_D:
+    case OpcodesIntel8080::SHLD:
+    case OpcodesIntel8080::STA:
+    case OpcodesIntel8080::INR_M:
+    case OpcodesIntel8080::DCR_M:
+    case OpcodesIntel8080::MVI_M:
+        return true;
+    default:
+        return false;
+    }
+}
+
+uint8_t JitProcessorIntel8080::Translator::DefinedFlags(uint8_t opcode)
+{
+    if (((opcode & 0xC0) == 0x80) || ((opcode & 0xC7) == 0xC6))
+        return AllFlags;
+    if (((opcode & 0xC7) == 0x04) || ((opcode & 0xC7) == 0x05))
+        return AllFlags & ~FlagsIntel8080::Carry;
+    if ((opcode & 0xCF) == 0x09)
+        return FlagsIntel8080::Carry;
+    switch (OpcodesIntel8080(opcode))
+    {
+    case OpcodesIntel8080::STC:
+    case OpcodesIntel8080::CMC:
+        return FlagsIntel8080::Carry;
+    case OpcodesIntel8080::RLC:
+    case OpcodesIntel8080::RRC:
+    case OpcodesIntel8080::RAL:
+    case OpcodesIntel8080::RAR:
+    case OpcodesIntel8080::DAA:
+    case OpcodesIntel8080::POP_PSW:
+        return AllFlags;
+    default:
+        return 0;
+    }
+}
+
+uint8_t JitProcessorIntel8080::Translator::UsedFlags(uint8_t opcode)
+{
+    // ADC, SBB, ACI, SBI
+    if (((opcode & 0xF0) == 0x80) || ((opcode & 0xF0) == 0x90) || (opcode == 0xCE) || (opcode == 0xDE))
+        return ((opcode & 0x08) != 0) ? FlagsIntel8080::Carry : 0;
+    switch (opcode & 0xC7)
+    {
+    case 0xC0:
+    case 0xC2:
+    case 0xC4:
+        return ConditionFlags[(opcode >> 3) & 0x07];
+    default:
+        break;
+    }
+    switch (OpcodesIntel8080(opcode))
+    {
+    case OpcodesIntel8080::CMC:
+        return FlagsIntel8080::Carry;
+    // Rotates and DAA run the helpers of the interpreter, which read all of the flags
+    case OpcodesIntel8080::RLC:
+    case OpcodesIntel8080::RRC:
+    case OpcodesIntel8080::RAL:
+    case OpcodesIntel8080::RAR:
+    case OpcodesIntel8080::DAA:
+    case OpcodesIntel8080::PUSH_PSW:
+        return AllFlags;
+    default:
+        return 0;
+    }
+}
+
+bool JitProcessorIntel8080::Translator::Decode(MemoryAddressType address)
+{
+    MemoryManager & memory = *processor.memoryManager;
+    size_t offset = address;
+    while (instructions.size() < MaxBlockInstructions)
+    {
+        Instruction instruction {};
+        instruction.address = MemoryAddressType(offset);
+        try
+        {
+            instruction.opcode = memory.Fetch8(offset);
+            if (!IsTranslated(instruction.opcode))
+                break;
+            instruction.size = uint8_t(instruction8080[instruction.opcode].instructionSize);
+            if (offset + instruction.size > MemoryManager::AddressSpaceSize)
+                break;
+            if (instruction.size > 1)
+                instruction.operand = memory.Fetch8(offset + 1);
+            if (instruction.size > 2)
+                instruction.operand |= uint16_t(memory.Fetch8(offset + 2) << 8);
+        }
+        catch (std::exception &)
+        {
+            // Leave reporting the missing memory to the interpreter
+            break;
+        }
+        // The second byte of a word at the end of memory is left to the interpreter
+        if (((instruction.opcode == uint8_t(OpcodesIntel8080::SHLD)) || (instruction.opcode == uint8_t(OpcodesIntel8080::LHLD))) &&
+            (instruction.operand == 0xFFFF))
+            break;
+        instruction.cycles = instruction8080[instruction.opcode].machineStateCount;
+        instructions.push_back(instruction);
+        offset += instruction.size;
+        if (EndsBlock(instruction.opcode))
+            break;
+    }
+    return !instructions.empty();
+}
+
+// Flags only need to be computed when an instruction later in the block, or the code after the block reads them.
+// The block may be left after any store, so all flags are live there.
+void JitProcessorIntel8080::Translator::ComputeLiveFlags()
+{
+    uint8_t live = AllFlags;
+    for (size_t index = instructions.size(); index-- > 0;)
+    {
+        Instruction & instruction = instructions[index];
+        if (MayStore(instruction.opcode))
+            live = AllFlags;
+        instruction.liveFlags = live;
+        live = uint8_t((live & ~DefinedFlags(instruction.opcode)) | UsedFlags(instruction.opcode));
+    }
+}
+
+uint8_t const * JitProcessorIntel8080::Translator::Translate(MemoryAddressType address, Block & block)
+{
+    if (!Decode(address))
+        return nullptr;
+    processor.MakeCodeWritable();
+    ComputeLiveFlags();
+    uint8_t const * start = code.Here();
+    size_t cycles = 0;
+    for (auto const & instruction : instructions)
+    {
+        EmitInstruction(instruction, cycles);
+        cycles += instruction.cycles;
+    }
+    Instruction const & last = instructions.back();
+    if (!EndsBlock(last.opcode))
+        EmitExit(last, cycles, MemoryAddressType(last.address + last.size), last.cycles);
+    EmitStubs(block);
+    block.address = address;
+    block.size = size_t(last.address + last.size - address);
+    return code.Overflow() ? nullptr : start;
+}
+
+void JitProcessorIntel8080::Translator::EmitStubs(Block & block)
+{
+    for (auto & stub : stubs)
+    {
+        uint8_t * location = code.Here();
+        for (auto jump : stub.jumps)
+        {
+            if (jump != nullptr)
+                Patch(jump, location);
+        }
+        if (stub.cycles != 0)
+        {
+            code.RM({ 0x81 }, 5, offsetCyclesLeft, true);   // sub qword [cyclesLeft], cycles
+            code.Dword(uint32_t(stub.cycles));
+        }
+        code.Byte(0x66);
+        code.RM({ 0xC7 }, 0, offsetPC);                     // mov word [pc], pc
+        code.Word(stub.pc);
+        code.RM({ 0xC6 }, 0, offsetInstructionCycles);      // mov byte [instructionCycles], cycles
+        code.Byte(stub.instructionCycles);
+        code.RM({ 0xC6 }, 0, offsetInstruction);            // mov byte [instruction], opcode
+        code.Byte(stub.opcode);
+        uint8_t * jump = code.Jump({ 0xE9 });               // jmp exit
+        if (jump != nullptr)
+            Patch(jump, processor.exitCode);
+        if (stub.exit && (stub.chainJump != nullptr))
+        {
+            JitProcessorIntel8080::Exit exit;
+            exit.target = stub.pc;
+            exit.jump = stub.chainJump;
+            exit.stub = location;
+            block.exits.push_back(exit);
+        }
+    }
+}
+
+// Register r of an opcode (not M) to the 32 bit register destination
+void JitProcessorIntel8080::Translator::Get8(int r, HostRegister destination)
+{
+    if (r == 7)
+    {
+        code.RR({ 0x0F, 0xB6 }, destination, RBX);          // movzx destination, bl
+        return;
+    }
+    HostRegister pair = PairRegisters[r >> 1];
+    if ((r & 1) == 0)
+    {
+        code.RR({ 0x89 }, pair, destination);               // mov destination, pair
+        code.RR({ 0xC1 }, 5, destination);                  // shr destination, 8
+        code.Byte(8);
+    }
+    else
+    {
+        code.RR({ 0x0F, 0xB6 }, destination, pair);         // movzx destination, pair low
+    }
+}
+
+// al to register r of an opcode (not M)
+void JitProcessorIntel8080::Translator::Set8(int r)
+{
+    if (r == 7)
+    {
+        code.RR({ 0x88 }, RAX, RBX);                        // mov bl, al
+        return;
+    }
+    HostRegister pair = PairRegisters[r >> 1];
+    if ((r & 1) == 0)
+    {
+        code.RR({ 0x0F, 0xB6 }, RAX, RAX);                  // movzx eax, al
+        code.RR({ 0xC1 }, 4, RAX);                          // shl eax, 8
+        code.Byte(8);
+        code.RR({ 0x0F, 0xB6 }, pair, pair);                // movzx pair, pair low
+        code.RR({ 0x09 }, RAX, pair);                       // or pair, eax
+    }
+    else
+    {
+        code.RR({ 0x88 }, RAX, pair);                       // mov pair low, al
+    }
+}
+
+void JitProcessorIntel8080::Translator::IncrementPair(HostRegister pair, bool decrement)
+{
+    code.RR({ 0x83 }, decrement ? 5 : 0, pair);             // add / sub pair, 1
+    code.Byte(1);
+    code.RR({ 0x0F, 0xB7 }, pair, pair);                    // movzx pair, pair low word
+}
+
+// Byte at esi to eax, through the page map or the slow path
+void JitProcessorIntel8080::Translator::Load(size_t abortStub)
+{
+    code.RR({ 0x89 }, RSI, RAX);                            // mov eax, esi
+    code.RR({ 0xC1 }, 5, RAX);                              // shr eax, pageSizeBits
+    code.Byte(uint8_t(processor.pageSizeBits));
+    code.RR({ 0x69 }, RAX, RAX);                            // imul eax, eax, sizeof(MemoryPage)
+    code.Dword(uint32_t(sizeof(MemoryPage)));
+    code.RM({ 0x03 }, RAX, offsetPages, true);              // add rax, [pages]
+    code.Bytes({ 0x48, 0x8B, 0x48, uint8_t(offsetof(MemoryPage, read)) });   // mov rcx, [rax + read]
+    code.RR({ 0x85 }, RCX, RCX, true);                      // test rcx, rcx
+    uint8_t * slow = code.Jump({ 0x0F, 0x84 });             // jz slow
+    code.RR({ 0x89 }, RSI, RDX);                            // mov edx, esi
+    code.RR({ 0x81 }, 4, RDX);                              // and edx, pageMask
+    code.Dword(uint32_t(processor.memoryManager->PageSize() - 1));
+    code.Bytes({ 0x0F, 0xB6, 0x04, 0x11 });                 // movzx eax, byte [rcx + rdx]
+    uint8_t * done = code.Jump({ 0xE9 });                   // jmp done
+    if (slow != nullptr)
+        Patch(slow, code.Here());
+    code.RR({ 0x89 }, RBP, RDI, true);                      // mov rdi, rbp
+    code.MovImm64(RAX, reinterpret_cast<uint64_t>(&JitProcessorIntel8080::Fetch8));
+    code.Bytes({ 0xFF, 0xD0 });                             // call rax
+    code.RM({ 0x80 }, 7, offsetAborted);                    // cmp byte [aborted], 0
+    code.Byte(0);
+    JumpToStub({ 0x0F, 0x85 }, abortStub);                  // jne abort
+    if (done != nullptr)
+        Patch(done, code.Here());
+}
+
+// Byte in dl to esi, through the page map or the slow path. Watched pages have no write pointer.
+void JitProcessorIntel8080::Translator::Store(size_t abortStub)
+{
+    code.RR({ 0x89 }, RSI, RAX);                            // mov eax, esi
+    code.RR({ 0xC1 }, 5, RAX);                              // shr eax, pageSizeBits
+    code.Byte(uint8_t(processor.pageSizeBits));
+    code.RR({ 0x69 }, RAX, RAX);                            // imul eax, eax, sizeof(MemoryPage)
+    code.Dword(uint32_t(sizeof(MemoryPage)));
+    code.RM({ 0x03 }, RAX, offsetPages, true);              // add rax, [pages]
+    code.Bytes({ 0x48, 0x8B, 0x48, uint8_t(offsetof(MemoryPage, write)) });  // mov rcx, [rax + write]
+    code.RR({ 0x85 }, RCX, RCX, true);                      // test rcx, rcx
+    uint8_t * slow = code.Jump({ 0x0F, 0x84 });             // jz slow
+    code.RR({ 0x89 }, RSI, RAX);                            // mov eax, esi
+    code.RR({ 0x81 }, 4, RAX);                              // and eax, pageMask
+    code.Dword(uint32_t(processor.memoryManager->PageSize() - 1));
+    code.Bytes({ 0x88, 0x14, 0x01 });                       // mov [rcx + rax], dl
+    uint8_t * done = code.Jump({ 0xE9 });                   // jmp done
+    if (slow != nullptr)
+        Patch(slow, code.Here());
+    code.RR({ 0x89 }, RBP, RDI, true);                      // mov rdi, rbp
+    code.MovImm64(RAX, reinterpret_cast<uint64_t>(&JitProcessorIntel8080::Store8));
+    code.Bytes({ 0xFF, 0xD0 });                             // call rax
+    code.RM({ 0x80 }, 7, offsetAborted);                    // cmp byte [aborted], 0
+    code.Byte(0);
+    JumpToStub({ 0x0F, 0x85 }, abortStub);                  // jne abort
+    if (done != nullptr)
+        Patch(done, code.Here());
+}
+
+void JitProcessorIntel8080::Translator::LoadM(Instruction const & instruction, size_t cyclesBefore, HostRegister destination)
+{
+    code.RR({ 0x89 }, R14, RSI);                            // mov esi, r14d
+    Load(AddStub(cyclesBefore, instruction.address, instruction, instruction.cycles));
+    if (destination != RAX)
+        code.RR({ 0x89 }, RAX, destination);
+}
+
+// eax to (HL)
+void JitProcessorIntel8080::Translator::StoreM(Instruction const & instruction, size_t cyclesBefore)
+{
+    code.RR({ 0x89 }, RAX, RDX);                            // mov edx, eax
+    code.RR({ 0x89 }, R14, RSI);                            // mov esi, r14d
+    Store(AddStub(cyclesBefore, instruction.address, instruction, instruction.cycles));
+}
+
+// Push a register pair (4 is PSW), or value if pair is negative
+void JitProcessorIntel8080::Translator::Push(Instruction const & instruction, size_t cyclesBefore, int pair, uint16_t value)
+{
+    size_t abortStub = AddStub(cyclesBefore, instruction.address, instruction, instruction.cycles);
+    for (int high = 1; high >= 0; --high)
+    {
+        IncrementPair(R15, true);
+        code.RR({ 0x89 }, R15, RSI);                        // mov esi, r15d
+        if (pair < 0)
+        {
+            code.MovImm(RDX, high ? (value >> 8) : (value & 0xFF));
+        }
+        else if (pair == 4)
+        {
+            if (high)
+            {
+                code.RR({ 0x0F, 0xB6 }, RDX, RBX);          // movzx edx, bl
+            }
+            else
+            {
+                code.Bytes({ 0x0F, 0xB6, 0xD7 });           // movzx edx, bh
+                code.RR({ 0x81 }, 4, RDX);                  // and edx, 0xD7
+                code.Dword(0xD7);
+                code.RR({ 0x83 }, 1, RDX);                  // or edx, 0x02
+                code.Byte(0x02);
+            }
+        }
+        else
+        {
+            Get8(pair * 2 + (high ? 0 : 1), RDX);
+        }
+        Store(abortStub);
+    }
+}
+
+// Pop to the register pair of the instruction (PSW for POP PSW), or to eax for RET
+void JitProcessorIntel8080::Translator::Pop(Instruction const & instruction, size_t cyclesBefore)
+{
+    size_t abortStub = AddStub(cyclesBefore, instruction.address, instruction, instruction.cycles);
+    bool isReturn = ((instruction.opcode & 0xCF) != 0xC1);
+    int pair = (instruction.opcode >> 4) & 0x03;
+    for (int high = 0; high <= 1; ++high)
+    {
+        code.RR({ 0x89 }, R15, RSI);                        // mov esi, r15d
+        Load(abortStub);
+        IncrementPair(R15, false);
+        if (isReturn)
+        {
+            if (!high)
+                code.Bytes({ 0x88, 0x04, 0x24 });           // mov [rsp], al
+        }
+        else if (pair == 3)
+        {
+            if (high)
+                code.RR({ 0x88 }, RAX, RBX);                // mov bl, al
+            else
+                code.Bytes({ 0x88, 0xC7 });                 // mov bh, al
+        }
+        else
+        {
+            Set8(pair * 2 + (high ? 0 : 1));
+        }
+    }
+    if (isReturn)
+    {
+        code.RR({ 0xC1 }, 4, RAX);                          // shl eax, 8
+        code.Byte(8);
+        code.Bytes({ 0x0F, 0xB6, 0x0C, 0x24 });             // movzx ecx, byte [rsp]
+        code.RR({ 0x09 }, RCX, RAX);                        // or eax, ecx
+    }
+    else if (pair == 3)
+    {
+        code.RM({ 0x88 }, 7, offsetWZ);                     // mov [wz], bh
+        code.RM({ 0x88 }, RBX, offsetWZ + 1);               // mov [wz + 1], bl
+    }
+}
+
+// Flags of the last host ALU instruction to bh
+void JitProcessorIntel8080::Translator::CaptureFlags(uint8_t mask)
+{
+    code.Byte(0x9F);                                        // lahf
+    code.Bytes({ 0x80, 0xE4, mask });                       // and ah, mask
+    code.Bytes({ 0x88, 0xE7 });                             // mov bh, ah
+}
+
+void JitProcessorIntel8080::Translator::CaptureCarry()
+{
+    code.Bytes({ 0x0F, 0x92, 0xC0 });                       // setc al
+    code.Bytes({ 0x80, 0xE7, 0xFE });                       // and bh, 0xFE
+    code.Bytes({ 0x08, 0xC7 });                             // or bh, al
+}
+
+// A = helper(A, flags), for operations kept bit for bit identical to the interpreter
+void JitProcessorIntel8080::Translator::CallAccumulatorHelper(uint8_t (* helper)(uint8_t a, FlagsIntel8080 & flags))
+{
+    code.RM({ 0x88 }, 7, offsetFlags);                      // mov [flags], bh
+    code.RR({ 0x0F, 0xB6 }, RDI, RBX);                      // movzx edi, bl
+    code.RM({ 0x8D }, RSI, offsetFlags, true);              // lea rsi, [flags]
+    code.MovImm64(RAX, reinterpret_cast<uint64_t>(helper));
+    code.Bytes({ 0xFF, 0xD0 });                             // call rax
+    code.RR({ 0x88 }, RAX, RBX);                            // mov bl, al
+    code.RM({ 0x8A }, 7, offsetFlags);                      // mov bh, [flags]
+}
+
+void JitProcessorIntel8080::Translator::CarryIn()
+{
+    code.Bytes({ 0x0F, 0xBA, 0xE3, 0x08 });                 // bt ebx, 8
+}
+
+// Leave the block for target. Jumps straight to the block at target once it is translated.
+void JitProcessorIntel8080::Translator::EmitExit(Instruction const & instruction, size_t cycles, MemoryAddressType target, uint8_t instructionCycles)
+{
+    size_t stub = AddStub(0, target, instruction, instructionCycles);
+    code.RM({ 0x81 }, 5, offsetCyclesLeft, true);           // sub qword [cyclesLeft], cycles
+    code.Dword(uint32_t(cycles));
+    JumpToStub({ 0x0F, 0x8E }, stub);                       // jle stub
+    uint8_t * jump = code.Jump({ 0xE9 });                   // jmp stub, patched to chain
+    stubs[stub].jumps.push_back(jump);
+    stubs[stub].exit = true;
+    stubs[stub].chainJump = jump;
+}
+
+// Leave the block for the address in eax, through the entry table
+void JitProcessorIntel8080::Translator::EmitDynamicExit(Instruction const & instruction, size_t cycles, uint8_t instructionCycles)
+{
+    code.Byte(0x66);
+    code.RM({ 0x89 }, RAX, offsetPC);                       // mov [pc], ax
+    code.RM({ 0xC6 }, 0, offsetInstructionCycles);          // mov byte [instructionCycles], cycles
+    code.Byte(instructionCycles);
+    code.RM({ 0xC6 }, 0, offsetInstruction);                // mov byte [instruction], opcode
+    code.Byte(instruction.opcode);
+    code.RM({ 0x81 }, 5, offsetCyclesLeft, true);           // sub qword [cyclesLeft], cycles
+    code.Dword(uint32_t(cycles));
+    uint8_t * budget = code.Jump({ 0x0F, 0x8E });           // jle exit
+    if (budget != nullptr)
+        Patch(budget, processor.exitCode);
+    code.RM({ 0x8B }, RCX, offsetEntryTable, true);         // mov rcx, [entryTable]
+    code.Bytes({ 0x48, 0x8B, 0x0C, 0xC1 });                 // mov rcx, [rcx + rax * 8]
+    code.RR({ 0x85 }, RCX, RCX, true);                      // test rcx, rcx
+    uint8_t * missing = code.Jump({ 0x0F, 0x84 });          // jz exit
+    if (missing != nullptr)
+        Patch(missing, processor.exitCode);
+    code.Bytes({ 0xFF, 0xE1 });                             // jmp rcx
+}
+
+// Emits the test of a conditional instruction, returns the jump taken when the condition holds
+uint8_t * JitProcessorIntel8080::Translator::TestCondition(uint8_t opcode)
+{
+    int condition = (opcode >> 3) & 0x07;
+    code.Bytes({ 0xF6, 0xC7, ConditionFlags[condition] }); // test bh, flag
+    // Odd conditions hold when the flag is set
+    return code.Jump({ 0x0F, uint8_t((condition & 1) ? 0x85 : 0x84) });
+}
+
+void JitProcessorIntel8080::Translator::EmitInstruction(Instruction const & instruction, size_t cyclesBefore)
+{
+    uint8_t opcode = instruction.opcode;
+    size_t cycles = cyclesBefore + instruction.cycles;
+    MemoryAddressType next = MemoryAddressType(instruction.address + instruction.size);
+    bool liveResult = (instruction.liveFlags & DefinedFlags(opcode)) != 0;
+    HostRegister pair = PairRegisters[(opcode >> 4) & 0x03];
+
+    if ((opcode & 0xC0) == 0x40)
+    {
+        // MOV
+        int destination = (opcode >> 3) & 0x07;
+        int source = opcode & 0x07;
+        if (source == 6)
+        {
+            LoadM(instruction, cyclesBefore, RAX);
+            Set8(destination);
+        }
+        else if (destination == 6)
+        {
+            Get8(source, RAX);
+            StoreM(instruction, cyclesBefore);
+        }
+        else if (source != destination)
+        {
+            Get8(source, RAX);
+            Set8(destination);
+        }
+    }
+    else if (((opcode & 0xC0) == 0x80) || ((opcode & 0xC7) == 0xC6))
+    {
+        // ALU with register, M or immediate, on bl with the operand in cl
+        int operation = (opcode >> 3) & 0x07;
+        if ((opcode & 0xC0) == 0xC0)
+            code.MovImm(RCX, instruction.operand);
+        else if ((opcode & 0x07) == 6)
+            LoadM(instruction, cyclesBefore, RCX);
+        else
+            Get8(opcode & 0x07, RCX);
+        static const uint8_t hostOperations[] = { 0x00, 0x10, 0x28, 0x18, 0x20, 0x30, 0x08, 0x38 };
+        if (UsedFlags(opcode) != 0)
+            CarryIn();
+        code.Bytes({ hostOperations[operation], 0xCB });    // op bl, cl
+        if (liveResult)
+        {
+            // AND, XOR and OR clear AC and CY
+            bool logical = (operation >= 4) && (operation <= 6);
+            CaptureFlags(logical ? uint8_t(AllFlags & ~(FlagsIntel8080::AuxCarry | FlagsIntel8080::Carry)) : AllFlags);
+        }
+    }
+    else if (((opcode & 0xC6) == 0x04) && (((opcode >> 3) & 0x07) != 6))
+    {
+        // INR r, DCR r, CY is kept
+        int r = (opcode >> 3) & 0x07;
+        Get8(r, RAX);
+        if (liveResult)
+            CarryIn();
+        code.Bytes({ 0xFE, uint8_t((opcode & 1) ? 0xC8 : 0xC0) });  // inc / dec al
+        if (liveResult)
+            CaptureFlags(AllFlags);
+        Set8(r);
+    }
+    else if ((opcode & 0xC7) == 0x06)
+    {
+        // MVI
+        int r = (opcode >> 3) & 0x07;
+        code.MovImm(RAX, instruction.operand);
+        if (r == 6)
+            StoreM(instruction, cyclesBefore);
+        else
+            Set8(r);
+    }
+    else if ((opcode & 0xC7) == 0xC2)
+    {
+        uint8_t * taken = TestCondition(opcode);
+        EmitExit(instruction, cycles, next, instruction.cycles);
+        if (taken != nullptr)
+            Patch(taken, code.Here());
+        EmitExit(instruction, cycles, instruction.operand, instruction.cycles);
+    }
+    else if ((opcode & 0xC7) == 0xC4)
+    {
+        uint8_t notTakenCycles = instruction8080[opcode].machineStateCountConditionFailed;
+        uint8_t * taken = TestCondition(opcode);
+        EmitExit(instruction, cyclesBefore + notTakenCycles, next, notTakenCycles);
+        if (taken != nullptr)
+            Patch(taken, code.Here());
+        code.Byte(0x66);
+        code.RM({ 0xC7 }, 0, offsetWZ);                     // mov word [wz], target
+        code.Word(instruction.operand);
+        Push(instruction, cyclesBefore, -1, next);
+        EmitExit(instruction, cycles, instruction.operand, instruction.cycles);
+    }
+    else if ((opcode & 0xC7) == 0xC0)
+    {
+        uint8_t notTakenCycles = instruction8080[opcode].machineStateCountConditionFailed;
+        uint8_t * taken = TestCondition(opcode);
+        EmitExit(instruction, cyclesBefore + notTakenCycles, next, notTakenCycles);
+        if (taken != nullptr)
+            Patch(taken, code.Here());
+        Pop(instruction, cyclesBefore);
+        EmitDynamicExit(instruction, cycles, instruction.cycles);
+    }
+    else if ((opcode & 0xC7) == 0xC7)
+    {
+        Push(instruction, cyclesBefore, -1, next);
+        EmitExit(instruction, cycles, MemoryAddressType(opcode & 0x38), instruction.cycles);
+    }
+    else if ((opcode & 0xCF) == 0xC5)
+    {
+        Push(instruction, cyclesBefore, (opcode == 0xF5) ? 4 : ((opcode >> 4) & 0x03), 0);
+    }
+    else if ((opcode & 0xCF) == 0xC1)
+    {
+        Pop(instruction, cyclesBefore);
+    }
+    else
+    {
+        switch (OpcodesIntel8080(opcode))
+        {
+        case OpcodesIntel8080::NOP:
+            break;
+        case OpcodesIntel8080::LXI_B:
+        case OpcodesIntel8080::LXI_D:
+        case OpcodesIntel8080::LXI_H:
+        case OpcodesIntel8080::LXI_SP:
+            code.MovImm(pair, instruction.operand);
+            break;
+        case OpcodesIntel8080::STAX_B:
+        case OpcodesIntel8080::STAX_D:
+            code.RR({ 0x89 }, pair, RSI);                   // mov esi, pair
+            code.RR({ 0x0F, 0xB6 }, RDX, RBX);              // movzx edx, bl
+            Store(AddStub(cyclesBefore, instruction.address, instruction, instruction.cycles));
+            break;
+        case OpcodesIntel8080::LDAX_B:
+        case OpcodesIntel8080::LDAX_D:
+            code.RR({ 0x89 }, pair, RSI);                   // mov esi, pair
+            Load(AddStub(cyclesBefore, instruction.address, instruction, instruction.cycles));
+            code.RR({ 0x88 }, RAX, RBX);                    // mov bl, al
+            break;
+        case OpcodesIntel8080::INX_B:
+        case OpcodesIntel8080::INX_D:
+        case OpcodesIntel8080::INX_H:
+        case OpcodesIntel8080::INX_SP:
+            IncrementPair(pair, false);
+            break;
+        case OpcodesIntel8080::DCX_B:
+        case OpcodesIntel8080::DCX_D:
+        case OpcodesIntel8080::DCX_H:
+        case OpcodesIntel8080::DCX_SP:
+            IncrementPair(pair, true);
+            break;
+        case OpcodesIntel8080::DAD_B:
+        case OpcodesIntel8080::DAD_D:
+        case OpcodesIntel8080::DAD_H:
+        case OpcodesIntel8080::DAD_SP:
+            code.Byte(0x66);
+            code.RR({ 0x01 }, pair, R14);                   // add r14w, pair
+            if (liveResult)
+                CaptureCarry();
+            break;
+        case OpcodesIntel8080::INR_M:
+        case OpcodesIntel8080::DCR_M:
+            LoadM(instruction, cyclesBefore, RAX);
+            if (liveResult)
+                CarryIn();
+            code.Bytes({ 0xFE, uint8_t((opcode & 1) ? 0xC8 : 0xC0) });  // inc / dec al
+            if (liveResult)
+                CaptureFlags(AllFlags);
+            StoreM(instruction, cyclesBefore);
+            break;
+        case OpcodesIntel8080::SHLD:
+        case OpcodesIntel8080::LHLD:
+        case OpcodesIntel8080::STA:
+        case OpcodesIntel8080::LDA:
+            {
+                size_t abortStub = AddStub(cyclesBefore, instruction.address, instruction, instruction.cycles);
+                code.Byte(0x66);
+                code.RM({ 0xC7 }, 0, offsetWZ);             // mov word [wz], address
+                code.Word(instruction.operand);
+                code.MovImm(RSI, instruction.operand);
+                switch (OpcodesIntel8080(opcode))
+                {
+                case OpcodesIntel8080::SHLD:
+                    code.RR({ 0x0F, 0xB6 }, RDX, R14);      // movzx edx, r14b
+                    Store(abortStub);
+                    code.MovImm(RSI, instruction.operand + 1u);
+                    Get8(4, RDX);
+                    Store(abortStub);
+                    break;
+                case OpcodesIntel8080::LHLD:
+                    Load(abortStub);
+                    Set8(5);
+                    code.MovImm(RSI, instruction.operand + 1u);
+                    Load(abortStub);
+                    Set8(4);
+                    break;
+                case OpcodesIntel8080::STA:
+                    code.RR({ 0x0F, 0xB6 }, RDX, RBX);      // movzx edx, bl
+                    Store(abortStub);
+                    break;
+                default:
+                    Load(abortStub);
+                    code.RR({ 0x88 }, RAX, RBX);            // mov bl, al
+                    break;
+                }
+            }
+            break;
+        case OpcodesIntel8080::CMA:
+            code.Bytes({ 0xF6, 0xD3 });                     // not bl
+            break;
+        case OpcodesIntel8080::STC:
+            if (liveResult)
+                code.Bytes({ 0x80, 0xCF, 0x01 });           // or bh, 1
+            break;
+        case OpcodesIntel8080::CMC:
+            if (liveResult)
+                code.Bytes({ 0x80, 0xF7, 0x01 });           // xor bh, 1
+            break;
+        case OpcodesIntel8080::RLC:
+            CallAccumulatorHelper(&ProcessorIntel8080::RLC);
+            break;
+        case OpcodesIntel8080::RRC:
+            CallAccumulatorHelper(&ProcessorIntel8080::RRC);
+            break;
+        case OpcodesIntel8080::RAL:
+            CallAccumulatorHelper(&ProcessorIntel8080::RAL);
+            break;
+        case OpcodesIntel8080::RAR:
+            CallAccumulatorHelper(&ProcessorIntel8080::RAR);
+            break;
+        case OpcodesIntel8080::DAA:
+            CallAccumulatorHelper(&ProcessorIntel8080::DAA);
+            break;
+        case OpcodesIntel8080::JMP:
+            EmitExit(instruction, cycles, instruction.operand, instruction.cycles);
+            break;
+        case OpcodesIntel8080::CALL:
+            code.Byte(0x66);
+            code.RM({ 0xC7 }, 0, offsetWZ);                 // mov word [wz], target
+            code.Word(instruction.operand);
+            Push(instruction, cyclesBefore, -1, next);
+            EmitExit(instruction, cycles, instruction.operand, instruction.cycles);
+            break;
+        case OpcodesIntel8080::RET:
+            Pop(instruction, cyclesBefore);
+            EmitDynamicExit(instruction, cycles, instruction.cycles);
+            break;
+        case OpcodesIntel8080::PCHL:
+            code.RR({ 0x89 }, R14, RAX);                    // mov eax, r14d
+            EmitDynamicExit(instruction, cycles, instruction.cycles);
+            break;
+        case OpcodesIntel8080::XCHG:
+            code.RR({ 0x87 }, R13, R14);                    // xchg r14d, r13d
+            break;
+        case OpcodesIntel8080::SPHL:
+            code.RR({ 0x89 }, R14, R15);                    // mov r15d, r14d
+            break;
+        default:
+            break;
+        }
+    }
+
+    // The rest of the block may have been overwritten
+    if (MayStore(opcode) && !EndsBlock(opcode))
+    {
+        code.RM({ 0x80 }, 7, offsetCodeModified);           // cmp byte [codeModified], 0
+        code.Byte(0);
+        JumpToStub({ 0x0F, 0x85 }, AddStub(cycles, next, instruction, instruction.cycles));
+    }
+}
+
+#endif // defined(JIT_X86_64)
+
+JitProcessorIntel8080::JitProcessorIntel8080(size_t codeCacheSize)
+    : FastProcessorIntel8080()
+    , codeCacheSize(codeCacheSize)
+    , codeCache()
+    , codeCacheBlocks()
+    , codeCacheFree()
+    , codeWritable(true)
+    , executing()
+    , enterCode()
+    , exitCode()
+    , blocks(MemoryManager::AddressSpaceSize)
+    , entries(MemoryManager::AddressSpaceSize)
+    , incoming()
+    , pageBlocks()
+    , heat(MemoryManager::AddressSpaceSize)
+    , hotThreshold(DefaultHotThreshold)
+    , pageSizeBits()
+    , statistics()
+    , storeSubscription()
+    , cyclesLeft()
+    , pages()
+    , entryTable(entries.data())
+    , codeModified()
+    , aborted()
+    , exception()
+{
+    if (IsSupported())
+        codeCache = static_cast<uint8_t *>(OSAL::AllocateExecutableMemory(codeCacheSize));
+    GenerateEntryAndExit();
+}
+
+JitProcessorIntel8080::~JitProcessorIntel8080()
+{
+    if (memoryManager)
+    {
+        FlushCache();
+        memoryManager->UnsubscribeStores(storeSubscription);
+    }
+    OSAL::FreeExecutableMemory(codeCache, codeCacheSize);
+}
+
+bool JitProcessorIntel8080::IsSupported()
+{
+#if defined(JIT_X86_64)
+    return true;
+#else
+    return false;
+#endif
+}
+
+void JitProcessorIntel8080::LoadCode(std::vector<uint8_t> const & machineCode, MemoryAddressType origin, ROMPtr rom)
+{
+    FastProcessorIntel8080::LoadCode(machineCode, origin, rom);
+    FlushCache();
+}
+
+void JitProcessorIntel8080::LoadData(std::vector<uint8_t> const & data, MemoryAddressType origin, RAMPtr ram)
+{
+    FastProcessorIntel8080::LoadData(data, origin, ram);
+    FlushCache();
+}
+
+void JitProcessorIntel8080::Setup(MemoryManagerPtr memoryManager, IOManagerPtr ioManager)
+{
+    FlushCache();
+    if (this->memoryManager)
+        this->memoryManager->UnsubscribeStores(storeSubscription);
+    FastProcessorIntel8080::Setup(memoryManager, ioManager);
+    pageBlocks.clear();
+    pages = nullptr;
+    if (memoryManager)
+    {
+        pageBlocks.resize(MemoryManager::AddressSpaceSize / memoryManager->PageSize());
+        storeSubscription = memoryManager->SubscribeStores([this](size_t address) { OnStore(address); });
+        pages = &memoryManager->GetPage(0);
+        pageSizeBits = 0;
+        while ((size_t{ 1 } << pageSizeBits) < memoryManager->PageSize())
+            ++pageSizeBits;
+    }
+}
+
+void JitProcessorIntel8080::GenerateEntryAndExit()
+{
+    codeCacheFree = codeCacheBlocks = codeCache;
+#if defined(JIT_X86_64)
+    if (codeCache == nullptr)
+        return;
+    MakeCodeWritable();
+    Translator entry(*this, codeCache, codeCache + codeCacheSize);
+    entry.GenerateEntry();
+    exitCode = entry.Here();
+    entry.GenerateExit();
+    enterCode = reinterpret_cast<EntryFunction>(codeCache);
+    codeCacheFree = codeCacheBlocks = entry.Here();
+#endif
+}
+
+void JitProcessorIntel8080::FlushCache()
+{
+    for (size_t pageIndex = 0; pageIndex < pageBlocks.size(); ++pageIndex)
+    {
+        if (!pageBlocks[pageIndex].empty())
+            memoryManager->WatchStores(pageIndex * memoryManager->PageSize(), false);
+        pageBlocks[pageIndex].clear();
+    }
+    for (auto & block : blocks)
+        block.reset();
+    std::fill(entries.begin(), entries.end(), nullptr);
+    incoming.clear();
+    codeCacheFree = codeCacheBlocks;
+    codeModified = true;
+}
+
+size_t JitProcessorIntel8080::TranslatedBlockCount() const
+{
+    return size_t(std::count_if(blocks.begin(), blocks.end(), [](BlockPtr const & block) { return block != nullptr; }));
+}
+
+void JitProcessorIntel8080::MakeCodeWritable()
+{
+    if (codeWritable)
+        return;
+    if (!OSAL::ProtectExecutableMemory(codeCache, codeCacheSize, false))
+        throw std::runtime_error("JIT: cannot make the code cache writable");
+    codeWritable = true;
+}
+
+void JitProcessorIntel8080::MakeCodeExecutable()
+{
+    if (!codeWritable)
+        return;
+    if (!OSAL::ProtectExecutableMemory(codeCache, codeCacheSize, true))
+        throw std::runtime_error("JIT: cannot make the code cache executable");
+    codeWritable = false;
+}
+
+void JitProcessorIntel8080::Patch(uint8_t * jump, uint8_t const * target)
+{
+    int32_t displacement = int32_t(target - (jump + sizeof(int32_t)));
+    std::memcpy(jump, &displacement, sizeof(displacement));
+}
+
+uint8_t const * JitProcessorIntel8080::TranslateBlock(MemoryAddressType address)
+{
+    heat[address] = 0;
+#if defined(JIT_X86_64)
+    if ((codeCache == nullptr) || (memoryManager == nullptr))
+        return nullptr;
+    // A full code cache is emptied once, a block not fitting in an empty cache is interpreted
+    for (int attempt = 0; attempt < 2; ++attempt)
+    {
+        BlockPtr block(new Block);
+        Translator translator(*this, codeCacheFree, codeCache + codeCacheSize);
+        uint8_t const * code = translator.Translate(address, *block);
+        if (!translator.Overflow())
+        {
+            if (code == nullptr)
+                return nullptr;
+            codeCacheFree = translator.Here();
+            size_t pageSize = memoryManager->PageSize();
+            for (size_t pageIndex = address / pageSize; pageIndex <= (address + block->size - 1) / pageSize; ++pageIndex)
+            {
+                if (pageBlocks[pageIndex].empty())
+                    memoryManager->WatchStores(pageIndex * pageSize, true);
+                pageBlocks[pageIndex].push_back(address);
+            }
+            for (auto & exit : block->exits)
+            {
+                incoming[exit.target].push_back(&exit);
+                if (entries[exit.target] != nullptr)
+                    Patch(exit.jump, entries[exit.target]);
+            }
+            entries[address] = code;
+            auto chained = incoming.find(address);
+            if (chained != incoming.end())
+            {
+                for (auto exit : chained->second)
+                    Patch(exit->jump, code);
+            }
+            blocks[address] = std::move(block);
+            ++statistics.translations;
+            return code;
+        }
+        if (codeCacheFree == codeCacheBlocks)
+            break;
+        FlushCache();
+        ++statistics.flushes;
+    }
+#endif
+    return nullptr;
+}
+
+void JitProcessorIntel8080::InvalidateBlock(MemoryAddressType address)
+{
+    BlockPtr & block = blocks[address];
+    if (!block)
+        return;
+    size_t pageSize = memoryManager->PageSize();
+    for (size_t pageIndex = address / pageSize; pageIndex <= (address + block->size - 1) / pageSize; ++pageIndex)
+    {
+        std::vector<MemoryAddressType> & addresses = pageBlocks[pageIndex];
+        addresses.erase(std::remove(addresses.begin(), addresses.end(), address), addresses.end());
+        if (addresses.empty())
+            memoryManager->WatchStores(pageIndex * pageSize, false);
+    }
+    // Jumps into the block go back through their stubs to the run loop
+    entries[address] = nullptr;
+    auto chained = incoming.find(address);
+    if (chained != incoming.end())
+    {
+        // A store from translated code gets here through Store8(), which returns into the code cache
+        MakeCodeWritable();
+        for (auto exit : chained->second)
+            Patch(exit->jump, exit->stub);
+        if (executing)
+            MakeCodeExecutable();
+    }
+    for (auto & exit : block->exits)
+    {
+        std::vector<Exit *> & exits = incoming[exit.target];
+        exits.erase(std::remove(exits.begin(), exits.end(), &exit), exits.end());
+        if (exits.empty())
+            incoming.erase(exit.target);
+    }
+    // The host code may be executing, it stays in the code cache until the cache is flushed
+    block.reset();
+    ++statistics.invalidations;
+    codeModified = true;
+}
+
+void JitProcessorIntel8080::OnStore(size_t address)
+{
+    size_t pageIndex = address / memoryManager->PageSize();
+    if (pageIndex >= pageBlocks.size())
+        return;
+    std::vector<MemoryAddressType> addresses = pageBlocks[pageIndex];
+    for (auto blockAddress : addresses)
+    {
+        Block const * block = blocks[blockAddress].get();
+        if ((block != nullptr) && (blockAddress <= address) && (address < blockAddress + block->size))
+            InvalidateBlock(blockAddress);
+    }
+}
+
+uint32_t JitProcessorIntel8080::Fetch8(JitProcessorIntel8080 * processor, uint32_t address)
+{
+    try
+    {
+        return processor->memoryManager->Fetch8(address);
+    }
+    catch (...)
+    {
+        processor->exception = std::current_exception();
+        processor->aborted = true;
+        return 0;
+    }
+}
+
+void JitProcessorIntel8080::Store8(JitProcessorIntel8080 * processor, uint32_t address, uint32_t data)
+{
+    try
+    {
+        processor->memoryManager->Store8(address, uint8_t(data));
+    }
+    catch (...)
+    {
+        processor->exception = std::current_exception();
+        processor->aborted = true;
+    }
+}
+
+// Runs translated code until limit cycles have passed, or a block leaves to an address without translated code.
+// Memory errors in translated code are rethrown here, with pc at the failing instruction.
+size_t JitProcessorIntel8080::Execute(uint8_t const * code, size_t limit)
+{
+    MaterializeFlags();
+    int64_t start = (limit < size_t(UnlimitedSlice)) ? int64_t(limit) : UnlimitedSlice;
+    cyclesLeft = start;
+    codeModified = false;
+    ++statistics.entries;
+    MakeCodeExecutable();
+    executing = true;
+    enterCode(this, code);
+    executing = false;
+    if (aborted)
+    {
+        aborted = false;
+        std::exception_ptr error = exception;
+        exception = nullptr;
+        std::rethrow_exception(error);
+    }
+    return size_t(start - cyclesLeft);
+}
+
+void JitProcessorIntel8080::Run()
+{
+    RunBlocks([this](size_t limit) { return Step(limit); });
+}
+
+size_t JitProcessorIntel8080::Run(size_t budget)
+{
+    return RunBlocks(budget, [this](size_t limit) { return Step(limit); });
+}
@@ -0,0 +1,927 @@
+#include "emulator/LockstepRunnerIntel8080.h"
+
+#include <algorithm>
+#include <utility>
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && (_M_IX86_FP >= 2))
+#define LOCKSTEP_SSE2
+#include <emmintrin.h>
+#endif
+
+using namespace Emulator;
+
+namespace Emulator
+{
+
+// VectorLanes lanes of 16 bits. 8 bit registers are kept in the low byte, with the high byte 0.
+struct LaneVector
+{
+#if defined(LOCKSTEP_SSE2)
+    __m128i v;
+#else
+    uint16_t v[LockstepRunnerIntel8080::VectorLanes];
+#endif
+};
+
+#if defined(LOCKSTEP_SSE2)
+
+static inline LaneVector Load(uint16_t const * data) { return { _mm_loadu_si128(reinterpret_cast<__m128i const *>(data)) }; }
+static inline void Store(uint16_t * data, LaneVector x) { _mm_storeu_si128(reinterpret_cast<__m128i *>(data), x.v); }
+static inline LaneVector Splat(uint16_t value) { return { _mm_set1_epi16(short(value)) }; }
+static inline LaneVector Add(LaneVector x, LaneVector y) { return { _mm_add_epi16(x.v, y.v) }; }
+static inline LaneVector Sub(LaneVector x, LaneVector y) { return { _mm_sub_epi16(x.v, y.v) }; }
+static inline LaneVector And(LaneVector x, LaneVector y) { return { _mm_and_si128(x.v, y.v) }; }
+static inline LaneVector Or(LaneVector x, LaneVector y) { return { _mm_or_si128(x.v, y.v) }; }
+static inline LaneVector Xor(LaneVector x, LaneVector y) { return { _mm_xor_si128(x.v, y.v) }; }
+// ~x & y
+static inline LaneVector AndNot(LaneVector x, LaneVector y) { return { _mm_andnot_si128(x.v, y.v) }; }
+template<int N>
+static inline LaneVector ShiftLeft(LaneVector x) { return { _mm_slli_epi16(x.v, N) }; }
+template<int N>
+static inline LaneVector ShiftRight(LaneVector x) { return { _mm_srli_epi16(x.v, N) }; }
+// 0xFFFF in the lanes where the condition holds, 0 elsewhere
+static inline LaneVector Equal(LaneVector x, LaneVector y) { return { _mm_cmpeq_epi16(x.v, y.v) }; }
+static inline LaneVector LessUnsigned(LaneVector x, LaneVector y)
+{
+    __m128i bias = _mm_set1_epi16(short(0x8000));
+    return { _mm_cmplt_epi16(_mm_xor_si128(x.v, bias), _mm_xor_si128(y.v, bias)) };
+}
+
+#else
+
+template<class Operation>
+static inline LaneVector Apply(LaneVector x, LaneVector y, Operation operation)
+{
+    LaneVector result;
+    for (size_t lane = 0; lane < LockstepRunnerIntel8080::VectorLanes; ++lane)
+        result.v[lane] = uint16_t(operation(x.v[lane], y.v[lane]));
+    return result;
+}
+static inline LaneVector Load(uint16_t const * data)
+{
+    LaneVector result;
+    std::copy(data, data + LockstepRunnerIntel8080::VectorLanes, result.v);
+    return result;
+}
+static inline void Store(uint16_t * data, LaneVector x) { std::copy(x.v, x.v + LockstepRunnerIntel8080::VectorLanes, data); }
+static inline LaneVector Splat(uint16_t value)
+{
+    LaneVector result;
+    std::fill(result.v, result.v + LockstepRunnerIntel8080::VectorLanes, value);
+    return result;
+}
+static inline LaneVector Add(LaneVector x, LaneVector y) { return Apply(x, y, [](uint16_t p, uint16_t q) { return p + q; }); }
+static inline LaneVector Sub(LaneVector x, LaneVector y) { return Apply(x, y, [](uint16_t p, uint16_t q) { return p - q; }); }
+static inline LaneVector And(LaneVector x, LaneVector y) { return Apply(x, y, [](uint16_t p, uint16_t q) { return p & q; }); }
+static inline LaneVector Or(LaneVector x, LaneVector y) { return Apply(x, y, [](uint16_t p, uint16_t q) { return p | q; }); }
+static inline LaneVector Xor(LaneVector x, LaneVector y) { return Apply(x, y, [](uint16_t p, uint16_t q) { return p ^ q; }); }
+static inline LaneVector AndNot(LaneVector x, LaneVector y) { return Apply(x, y, [](uint16_t p, uint16_t q) { return ~p & q; }); }
+template<int N>
+static inline LaneVector ShiftLeft(LaneVector x) { return Apply(x, x, [](uint16_t p, uint16_t) { return p << N; }); }
+template<int N>
+static inline LaneVector ShiftRight(LaneVector x) { return Apply(x, x, [](uint16_t p, uint16_t) { return p >> N; }); }
+static inline LaneVector Equal(LaneVector x, LaneVector y) { return Apply(x, y, [](uint16_t p, uint16_t q) { return (p == q) ? 0xFFFF : 0; }); }
+static inline LaneVector LessUnsigned(LaneVector x, LaneVector y) { return Apply(x, y, [](uint16_t p, uint16_t q) { return (p < q) ? 0xFFFF : 0; }); }
+
+#endif
+
+enum LockstepOperand8 { LockstepB, LockstepC, LockstepD, LockstepE, LockstepH, LockstepL, LockstepM, LockstepA };
+enum LockstepOperation { LockstepAdd, LockstepAddC, LockstepSub, LockstepSubC, LockstepAnd, LockstepXor, LockstepOr, LockstepCmp };
+
+using Runner = LockstepRunnerIntel8080;
+
+// Lockstep execution of a single instruction. Every operation works on all lanes, lanes not in lockstep
+// anymore are computed as well but never read back. Only memory and IO accesses are restricted to the active lanes.
+// Flags are computed as in ProcessorIntel8080::Add() and friends.
+struct LockstepHandlersIntel8080
+{
+    static uint16_t * Pair(Runner & runner, int pair)
+    {
+        switch (pair)
+        {
+        case 0:     return runner.bc.data();
+        case 1:     return runner.de.data();
+        case 2:     return runner.hl.data();
+        default:    return runner.sp.data();
+        }
+    }
+    static LaneVector Get8(Runner & runner, int r, size_t group)
+    {
+        switch (r)
+        {
+        case LockstepB: return ShiftRight<8>(Load(&runner.bc[group]));
+        case LockstepC: return And(Load(&runner.bc[group]), Splat(0x00FF));
+        case LockstepD: return ShiftRight<8>(Load(&runner.de[group]));
+        case LockstepE: return And(Load(&runner.de[group]), Splat(0x00FF));
+        case LockstepH: return ShiftRight<8>(Load(&runner.hl[group]));
+        case LockstepL: return And(Load(&runner.hl[group]), Splat(0x00FF));
+        case LockstepM: return Load(&runner.operand[group]);
+        default:        return Load(&runner.a[group]);
+        }
+    }
+    static void SetHigh(uint16_t * pair, LaneVector value)
+    {
+        Store(pair, Or(And(Load(pair), Splat(0x00FF)), ShiftLeft<8>(value)));
+    }
+    static void SetLow(uint16_t * pair, LaneVector value)
+    {
+        Store(pair, Or(And(Load(pair), Splat(0xFF00)), value));
+    }
+    static void Set8(Runner & runner, int r, size_t group, LaneVector value)
+    {
+        switch (r)
+        {
+        case LockstepB: SetHigh(&runner.bc[group], value); break;
+        case LockstepC: SetLow(&runner.bc[group], value); break;
+        case LockstepD: SetHigh(&runner.de[group], value); break;
+        case LockstepE: SetLow(&runner.de[group], value); break;
+        case LockstepH: SetHigh(&runner.hl[group], value); break;
+        case LockstepL: SetLow(&runner.hl[group], value); break;
+        case LockstepM: Store(&runner.operand[group], value); break;
+        default:        Store(&runner.a[group], value); break;
+        }
+    }
+
+    // Sign, zero and parity, as flagsPZSTable
+    static LaneVector FlagsPZS(LaneVector result)
+    {
+        LaneVector parity = Xor(result, ShiftRight<4>(result));
+        parity = Xor(parity, ShiftRight<2>(parity));
+        parity = Xor(parity, ShiftRight<1>(parity));
+        LaneVector flags = And(result, Splat(FlagsIntel8080::Sign));
+        flags = Or(flags, And(Equal(result, Splat(0)), Splat(FlagsIntel8080::Zero)));
+        return Or(flags, ShiftLeft<2>(AndNot(parity, Splat(1))));
+    }
+    static LaneVector Arithmetic(int operation, LaneVector a, LaneVector r, LaneVector & flags)
+    {
+        LaneVector carry = And(flags, Splat(FlagsIntel8080::Carry));
+        LaneVector result;
+        switch (operation)
+        {
+        case LockstepAdd:   result = Add(a, r); break;
+        case LockstepAddC:  result = Add(Add(a, r), carry); break;
+        case LockstepSub:
+        case LockstepCmp:   result = Sub(a, r); break;
+        case LockstepSubC:  result = Sub(Sub(a, r), carry); break;
+        case LockstepAnd:   result = And(a, r); flags = FlagsPZS(result); return result;
+        case LockstepXor:   result = Xor(a, r); flags = FlagsPZS(result); return result;
+        default:            result = Or(a, r); flags = FlagsPZS(result); return result;
+        }
+        // Bit 8 of the 16 bit result is the carry or borrow
+        LaneVector low = And(result, Splat(0x00FF));
+        flags = Or(Or(FlagsPZS(low), And(ShiftRight<8>(result), Splat(FlagsIntel8080::Carry))),
+                   And(Xor(Xor(a, r), low), Splat(FlagsIntel8080::AuxCarry)));
+        return (operation == LockstepCmp) ? a : low;
+    }
+    static LaneVector Increment(LaneVector r, LaneVector & flags)
+    {
+        LaneVector result = And(Add(r, Splat(1)), Splat(0x00FF));
+        flags = Or(Or(And(flags, Splat(FlagsIntel8080::Carry)), FlagsPZS(result)),
+                   And(Equal(And(result, Splat(0x000F)), Splat(0)), Splat(FlagsIntel8080::AuxCarry)));
+        return result;
+    }
+    static LaneVector Decrement(LaneVector r, LaneVector & flags)
+    {
+        LaneVector result = And(Sub(r, Splat(1)), Splat(0x00FF));
+        flags = Or(Or(And(flags, Splat(FlagsIntel8080::Carry)), FlagsPZS(result)),
+                   And(Equal(And(r, Splat(0x000F)), Splat(0)), Splat(FlagsIntel8080::AuxCarry)));
+        return result;
+    }
+    // Flags as left by ProcessorIntel8080::RLC() - RAR(), which the scalar engines use as well
+    static LaneVector RotateFlags(LaneVector a, LaneVector flags, uint16_t bit)
+    {
+        LaneVector condition = Or(And(flags, Splat(uint16_t(~FlagsIntel8080::Carry & 0xFF))), And(a, Splat(bit)));
+        return AndNot(Equal(condition, Splat(0)), Splat(FlagsIntel8080::Carry));
+    }
+    static bool Test(int condition, uint16_t flags)
+    {
+        static const uint8_t conditionFlags[] =
+            { FlagsIntel8080::Zero, FlagsIntel8080::Carry, FlagsIntel8080::Parity, FlagsIntel8080::Sign };
+        bool set = (flags & conditionFlags[condition >> 1]) != 0;
+        return ((condition & 1) != 0) ? set : !set;
+    }
+
+    // Groups of VectorLanes lanes which hold active lanes
+    template<class Function>
+    static void ForEachGroup(Runner & runner, Function function)
+    {
+        size_t begin = runner.activeLanes.front() / Runner::VectorLanes * Runner::VectorLanes;
+        size_t end = runner.activeLanes.back() / Runner::VectorLanes * Runner::VectorLanes + Runner::VectorLanes;
+        for (size_t group = begin; group < end; group += Runner::VectorLanes)
+            function(group);
+    }
+    // Memory accesses take the direct page pointers only, lanes needing the slow path (unmapped addresses,
+    // ROM writes, traps) leave lockstep before the instruction, so they fail or trap on their own
+    static bool Direct(MemoryManager const & memory, size_t address, size_t size, bool write)
+    {
+        for (size_t offset = 0; offset < size; ++offset)
+        {
+            if (address + offset >= MemoryManager::AddressSpaceSize)
+                return false;
+            MemoryPage const & page = memory.GetPage(address + offset);
+            if (write ? (page.write == nullptr) : (page.read == nullptr))
+                return false;
+        }
+        return true;
+    }
+    // Direct pointers to a byte, null if the access has to take the slow path
+    static uint8_t const * ReadPointer(MemoryManager const & memory, uint16_t address)
+    {
+        uint8_t const * read = memory.GetPage(address).read;
+        return read ? read + (address & (memory.PageSize() - 1)) : nullptr;
+    }
+    static uint8_t * WritePointer(MemoryManager const & memory, uint16_t address)
+    {
+        uint8_t * write = memory.GetPage(address).write;
+        return write ? write + (address & (memory.PageSize() - 1)) : nullptr;
+    }
+    // Runs the memory accesses of the instruction for every lane in lockstep. Lanes for which access returns false,
+    // before changing anything, leave lockstep before the instruction.
+    template<class Access>
+    static void LeaveUnless(Runner & runner, Access access)
+    {
+        std::vector<size_t> & active = runner.activeLanes;
+        size_t kept = 0;
+        for (size_t index = 0; index < active.size(); ++index)
+        {
+            size_t lane = active[index];
+            if (access(*runner.laneMemory[lane], lane))
+                active[kept++] = lane;
+            else
+            {
+                runner.Leave(lane, runner.pc, false);
+                ++runner.statistics.divergedLanes;
+            }
+        }
+        active.resize(kept);
+    }
+    // Lanes which took another path than the first lane leave lockstep after the instruction
+    static void Diverge(Runner & runner)
+    {
+        std::vector<size_t> & active = runner.activeLanes;
+        size_t kept = 0;
+        for (size_t index = 0; index < active.size(); ++index)
+        {
+            size_t lane = active[index];
+            if (runner.nextPC[lane] == runner.pc)
+                active[kept++] = lane;
+            else
+            {
+                runner.Leave(lane, runner.nextPC[lane], false);
+                ++runner.statistics.divergedLanes;
+            }
+        }
+        active.resize(kept);
+    }
+    static void LeaveAll(Runner & runner, uint16_t pc, bool halted)
+    {
+        for (auto lane : runner.activeLanes)
+            runner.Leave(lane, pc, halted);
+        runner.activeLanes.clear();
+    }
+    static void Scatter(Runner & runner, uint16_t const * address, uint16_t const * data)
+    {
+        for (auto lane : runner.activeLanes)
+            runner.laneMemory[lane]->Store8(address[lane], uint8_t(data[lane]));
+    }
+    static uint16_t Fetch16(MemoryManager & memory, uint16_t address)
+    {
+        return uint16_t(memory.Fetch8(address) | (memory.Fetch8(uint16_t(address + 1)) << 8));
+    }
+    static void Store16(MemoryManager & memory, uint16_t address, uint16_t data)
+    {
+        memory.Store8(address, uint8_t(data));
+        memory.Store8(uint16_t(address + 1), uint8_t(data >> 8));
+    }
+    // Stack accesses, failing without any change if they cannot use the direct page pointers
+    static bool Push(MemoryManager const & memory, uint16_t & sp, uint16_t data)
+    {
+        uint8_t * high = WritePointer(memory, uint16_t(sp - 1));
+        uint8_t * low = WritePointer(memory, uint16_t(sp - 2));
+        if (!high || !low)
+            return false;
+        *high = uint8_t(data >> 8);
+        *low = uint8_t(data);
+        sp -= 2;
+        return true;
+    }
+    static bool Pop(MemoryManager const & memory, uint16_t & sp, uint16_t & data)
+    {
+        uint8_t const * low = ReadPointer(memory, sp);
+        uint8_t const * high = ReadPointer(memory, uint16_t(sp + 1));
+        if (!low || !high)
+            return false;
+        data = uint16_t(*low | (*high << 8));
+        sp += 2;
+        return true;
+    }
+
+    // Executes the instruction at runner.pc for the active lanes. Returns false if it cannot run in lockstep,
+    // with the lanes still active.
+    static bool Step(Runner & runner, uint8_t const * code)
+    {
+        uint8_t opcode = code[0];
+        InstructionDataIntel8080 const & data = ProcessorIntel8080::GetInstructionData(OpcodesIntel8080(opcode));
+        uint8_t byte = (data.instructionSize > 1) ? code[1] : 0;
+        uint16_t word = (data.instructionSize > 2) ? uint16_t(code[1] | (code[2] << 8)) : 0;
+        uint16_t next = uint16_t(runner.pc + data.instructionSize);
+        uint8_t cycles = data.machineStateCount;
+        bool branch = false;
+        bool conditional = false;
+
+        if ((opcode >= 0x40) && (opcode < 0xC0) && (opcode != 0x76))
+        {
+            // MOV, ADD - CMP
+            int source = opcode & 0x07;
+            int destination = (opcode >> 3) & 0x07;
+            bool move = (opcode < 0x80);
+            if ((source == LockstepM) || (move && (destination == LockstepM)))
+            {
+                bool write = move && (destination == LockstepM);
+                LeaveUnless(runner, [&](MemoryManager const & memory, size_t lane)
+                {
+                    if (write)
+                        return WritePointer(memory, runner.hl[lane]) != nullptr;
+                    uint8_t const * operand = ReadPointer(memory, runner.hl[lane]);
+                    if (!operand)
+                        return false;
+                    runner.operand[lane] = *operand;
+                    return true;
+                });
+                if (runner.activeLanes.empty())
+                    return true;
+            }
+            ForEachGroup(runner, [&](size_t group)
+            {
+                if (move)
+                    Set8(runner, destination, group, Get8(runner, source, group));
+                else
+                {
+                    LaneVector flags = Load(&runner.flags[group]);
+                    Store(&runner.a[group], Arithmetic(destination, Load(&runner.a[group]), Get8(runner, source, group), flags));
+                    Store(&runner.flags[group], flags);
+                }
+            });
+            if (move && (destination == LockstepM))
+                Scatter(runner, runner.hl.data(), runner.operand.data());
+        }
+        else if ((opcode < 0x40) && (((opcode & 0x07) == 0x04) || ((opcode & 0x07) == 0x05) || ((opcode & 0x07) == 0x06)))
+        {
+            // INR, DCR, MVI
+            int r = (opcode >> 3) & 0x07;
+            int kind = opcode & 0x07;
+            if (r == LockstepM)
+            {
+                LeaveUnless(runner, [&](MemoryManager const & memory, size_t lane)
+                {
+                    if (!WritePointer(memory, runner.hl[lane]))
+                        return false;
+                    if (kind == 0x06)
+                        return true;
+                    uint8_t const * operand = ReadPointer(memory, runner.hl[lane]);
+                    if (!operand)
+                        return false;
+                    runner.operand[lane] = *operand;
+                    return true;
+                });
+                if (runner.activeLanes.empty())
+                    return true;
+            }
+            ForEachGroup(runner, [&](size_t group)
+            {
+                if (kind == 0x06)
+                {
+                    Set8(runner, r, group, Splat(byte));
+                    return;
+                }
+                LaneVector flags = Load(&runner.flags[group]);
+                LaneVector value = Get8(runner, r, group);
+                Set8(runner, r, group, (kind == 0x04) ? Increment(value, flags) : Decrement(value, flags));
+                Store(&runner.flags[group], flags);
+            });
+            if (r == LockstepM)
+                Scatter(runner, runner.hl.data(), runner.operand.data());
+        }
+        else if ((opcode < 0x40) && (((opcode & 0x0F) == 0x01) || ((opcode & 0x0F) == 0x03) || ((opcode & 0x0F) == 0x09) || ((opcode & 0x0F) == 0x0B)))
+        {
+            // LXI, INX, DAD, DCX
+            uint16_t * pair = Pair(runner, opcode >> 4);
+            int kind = opcode & 0x0F;
+            ForEachGroup(runner, [&](size_t group)
+            {
+                switch (kind)
+                {
+                case 0x01:  Store(&pair[group], Splat(word)); break;
+                case 0x03:  Store(&pair[group], Add(Load(&pair[group]), Splat(1))); break;
+                case 0x0B:  Store(&pair[group], Sub(Load(&pair[group]), Splat(1))); break;
+                default:
+                    {
+                        LaneVector hl = Load(&runner.hl[group]);
+                        LaneVector sum = Add(hl, Load(&pair[group]));
+                        LaneVector carry = And(LessUnsigned(sum, hl), Splat(FlagsIntel8080::Carry));
+                        Store(&runner.flags[group], Or(And(Load(&runner.flags[group]), Splat(uint16_t(~FlagsIntel8080::Carry & 0xFF))), carry));
+                        Store(&runner.hl[group], sum);
+                    }
+                    break;
+                }
+            });
+        }
+        else if ((opcode >= 0xC0) && ((opcode & 0x07) == 0x06))
+        {
+            // ADI - CPI
+            int operation = (opcode >> 3) & 0x07;
+            ForEachGroup(runner, [&](size_t group)
+            {
+                LaneVector flags = Load(&runner.flags[group]);
+                Store(&runner.a[group], Arithmetic(operation, Load(&runner.a[group]), Splat(byte), flags));
+                Store(&runner.flags[group], flags);
+            });
+        }
+        else if ((opcode >= 0xC0) && ((opcode & 0x07) == 0x02))
+        {
+            // Jcc
+            int condition = (opcode >> 3) & 0x07;
+            for (auto lane : runner.activeLanes)
+                runner.nextPC[lane] = Test(condition, runner.flags[lane]) ? word : next;
+            branch = true;
+        }
+        else if ((opcode >= 0xC0) && ((opcode & 0x07) == 0x04))
+        {
+            // Ccc
+            int condition = (opcode >> 3) & 0x07;
+            LeaveUnless(runner, [&](MemoryManager const & memory, size_t lane)
+            {
+                if (Test(condition, runner.flags[lane]))
+                {
+                    if (!Push(memory, runner.sp[lane], next))
+                        return false;
+                    runner.wz[lane] = word;
+                    runner.nextPC[lane] = word;
+                    runner.laneCycles[lane] = data.machineStateCount;
+                }
+                else
+                {
+                    runner.nextPC[lane] = next;
+                    runner.laneCycles[lane] = data.machineStateCountConditionFailed;
+                }
+                return true;
+            });
+            branch = conditional = true;
+        }
+        else if ((opcode >= 0xC0) && ((opcode & 0x07) == 0x00))
+        {
+            // Rcc
+            int condition = (opcode >> 3) & 0x07;
+            LeaveUnless(runner, [&](MemoryManager const & memory, size_t lane)
+            {
+                if (Test(condition, runner.flags[lane]))
+                {
+                    if (!Pop(memory, runner.sp[lane], runner.nextPC[lane]))
+                        return false;
+                    runner.laneCycles[lane] = data.machineStateCount;
+                }
+                else
+                {
+                    runner.nextPC[lane] = next;
+                    runner.laneCycles[lane] = data.machineStateCountConditionFailed;
+                }
+                return true;
+            });
+            branch = conditional = true;
+        }
+        else if ((opcode >= 0xC0) && ((opcode & 0x07) == 0x07))
+        {
+            // RST
+            LeaveUnless(runner, [&](MemoryManager const & memory, size_t lane)
+            {
+                return Push(memory, runner.sp[lane], next);
+            });
+            next = uint16_t(opcode & 0x38);
+        }
+        else if ((opcode >= 0xC0) && (((opcode & 0x0F) == 0x05) || ((opcode & 0x0F) == 0x01)))
+        {
+            // PUSH, POP
+            bool push = (opcode & 0x0F) == 0x05;
+            int pair = (opcode >> 4) & 0x03;
+            uint16_t * registers = Pair(runner, pair);
+            LeaveUnless(runner, [&](MemoryManager const & memory, size_t lane)
+            {
+                if (push)
+                {
+                    uint16_t value = (pair == 3) ? uint16_t((runner.a[lane] << 8) | ((runner.flags[lane] & 0xD7) | 0x02)) : registers[lane];
+                    return Push(memory, runner.sp[lane], value);
+                }
+                if (pair != 3)
+                    return Pop(memory, runner.sp[lane], registers[lane]);
+                if (!Pop(memory, runner.sp[lane], runner.wz[lane]))
+                    return false;
+                runner.a[lane] = runner.wz[lane] >> 8;
+                runner.flags[lane] = runner.wz[lane] & 0x00FF;
+                return true;
+            });
+        }
+        else
+        {
+            switch (OpcodesIntel8080(opcode))
+            {
+            case OpcodesIntel8080::NOP:
+                break;
+            case OpcodesIntel8080::STAX_B:
+            case OpcodesIntel8080::STAX_D:
+            case OpcodesIntel8080::LDAX_B:
+            case OpcodesIntel8080::LDAX_D:
+                {
+                    uint16_t const * address = (opcode & 0x10) ? runner.de.data() : runner.bc.data();
+                    bool write = (opcode & 0x08) == 0;
+                    LeaveUnless(runner, [&](MemoryManager const & memory, size_t lane)
+                    {
+                        if (write)
+                        {
+                            uint8_t * target = WritePointer(memory, address[lane]);
+                            if (!target)
+                                return false;
+                            *target = uint8_t(runner.a[lane]);
+                            return true;
+                        }
+                        uint8_t const * source = ReadPointer(memory, address[lane]);
+                        if (!source)
+                            return false;
+                        runner.a[lane] = *source;
+                        return true;
+                    });
+                }
+                break;
+            case OpcodesIntel8080::SHLD:
+            case OpcodesIntel8080::LHLD:
+            case OpcodesIntel8080::STA:
+            case OpcodesIntel8080::LDA:
+                {
+                    bool write = (opcode == uint8_t(OpcodesIntel8080::SHLD)) || (opcode == uint8_t(OpcodesIntel8080::STA));
+                    bool pair = (opcode == uint8_t(OpcodesIntel8080::SHLD)) || (opcode == uint8_t(OpcodesIntel8080::LHLD));
+                    LeaveUnless(runner, [&](MemoryManager & memory, size_t lane)
+                    {
+                        if (!Direct(memory, word, pair ? 2 : 1, write))
+                            return false;
+                        runner.wz[lane] = word;
+                        if (pair && write)
+                            Store16(memory, word, runner.hl[lane]);
+                        else if (pair)
+                            runner.hl[lane] = Fetch16(memory, word);
+                        else if (write)
+                            memory.Store8(word, uint8_t(runner.a[lane]));
+                        else
+                            runner.a[lane] = memory.Fetch8(word);
+                        return true;
+                    });
+                }
+                break;
+            case OpcodesIntel8080::RLC:
+            case OpcodesIntel8080::RRC:
+            case OpcodesIntel8080::RAL:
+            case OpcodesIntel8080::RAR:
+                ForEachGroup(runner, [&](size_t group)
+                {
+                    LaneVector a = Load(&runner.a[group]);
+                    LaneVector flags = Load(&runner.flags[group]);
+                    LaneVector carry = And(flags, Splat(FlagsIntel8080::Carry));
+                    LaneVector result;
+                    switch (OpcodesIntel8080(opcode))
+                    {
+                    case OpcodesIntel8080::RLC: result = And(ShiftLeft<1>(a), Splat(0x00FF)); break;
+                    case OpcodesIntel8080::RRC: result = ShiftRight<1>(a); break;
+                    case OpcodesIntel8080::RAL: result = And(Or(ShiftLeft<1>(a), carry), Splat(0x00FF)); break;
+                    default:                    result = Or(ShiftRight<1>(a), ShiftLeft<7>(carry)); break;
+                    }
+                    bool left = (opcode == uint8_t(OpcodesIntel8080::RLC)) || (opcode == uint8_t(OpcodesIntel8080::RAL));
+                    Store(&runner.flags[group], RotateFlags(a, flags, left ? 0x80 : 0x01));
+                    Store(&runner.a[group], result);
+                });
+                break;
+            case OpcodesIntel8080::DAA:
+                // Table lookup, there is no gather in SSE2
+                for (auto lane : runner.activeLanes)
+                {
+                    FlagsIntel8080 flags = FlagsIntel8080(runner.flags[lane]);
+                    runner.a[lane] = ProcessorIntel8080::DAA(uint8_t(runner.a[lane]), flags);
+                    runner.flags[lane] = uint8_t(flags);
+                }
+                break;
+            case OpcodesIntel8080::CMA:
+            case OpcodesIntel8080::STC:
+            case OpcodesIntel8080::CMC:
+                ForEachGroup(runner, [&](size_t group)
+                {
+                    if (opcode == uint8_t(OpcodesIntel8080::CMA))
+                        Store(&runner.a[group], Xor(Load(&runner.a[group]), Splat(0x00FF)));
+                    else if (opcode == uint8_t(OpcodesIntel8080::STC))
+                        Store(&runner.flags[group], Or(Load(&runner.flags[group]), Splat(FlagsIntel8080::Carry)));
+                    else
+                        Store(&runner.flags[group], Xor(Load(&runner.flags[group]), Splat(FlagsIntel8080::Carry)));
+                });
+                break;
+            case OpcodesIntel8080::HLT:
+                runner.cycles += cycles;
+                runner.lastCycles = cycles;
+                runner.lastCyclesPerLane = false;
+                ++runner.statistics.lockstepInstructions;
+                runner.statistics.lockstepLaneInstructions += runner.activeLanes.size();
+                LeaveAll(runner, next, true);
+                return true;
+            case OpcodesIntel8080::JMP:
+                next = word;
+                break;
+            case OpcodesIntel8080::CALL:
+                LeaveUnless(runner, [&](MemoryManager const & memory, size_t lane)
+                {
+                    if (!Push(memory, runner.sp[lane], next))
+                        return false;
+                    runner.wz[lane] = word;
+                    return true;
+                });
+                next = word;
+                break;
+            case OpcodesIntel8080::RET:
+                LeaveUnless(runner, [&](MemoryManager const & memory, size_t lane)
+                {
+                    return Pop(memory, runner.sp[lane], runner.nextPC[lane]);
+                });
+                branch = true;
+                break;
+            case OpcodesIntel8080::PCHL:
+                for (auto lane : runner.activeLanes)
+                    runner.nextPC[lane] = runner.hl[lane];
+                branch = true;
+                break;
+            case OpcodesIntel8080::OUTP:
+                for (auto lane : runner.activeLanes)
+                    runner.lanes[lane]->ioManager->Out8(byte, uint8_t(runner.a[lane]));
+                break;
+            case OpcodesIntel8080::INP:
+                for (auto lane : runner.activeLanes)
+                    runner.a[lane] = runner.lanes[lane]->ioManager->In8(byte);
+                break;
+            case OpcodesIntel8080::XTHL:
+                LeaveUnless(runner, [&](MemoryManager & memory, size_t lane)
+                {
+                    if (!Direct(memory, runner.sp[lane], 2, false) || !Direct(memory, runner.sp[lane], 2, true))
+                        return false;
+                    runner.wz[lane] = Fetch16(memory, runner.sp[lane]);
+                    Store16(memory, runner.sp[lane], runner.hl[lane]);
+                    runner.hl[lane] = runner.wz[lane];
+                    return true;
+                });
+                break;
+            case OpcodesIntel8080::XCHG:
+                std::swap(runner.de, runner.hl);
+                break;
+            case OpcodesIntel8080::SPHL:
+                runner.sp = runner.hl;
+                break;
+            case OpcodesIntel8080::DI:
+                runner.ie = false;
+                break;
+            case OpcodesIntel8080::EI:
+                runner.ie = true;
+                break;
+            default:
+                // Invalid instructions throw on the lanes' own processors
+                return false;
+            }
+        }
+        if (runner.activeLanes.empty())
+            return true;
+
+        size_t leader = runner.activeLanes.front();
+        if (branch)
+            next = runner.nextPC[leader];
+        if (conditional)
+        {
+            cycles = runner.laneCycles[leader];
+            for (auto lane : runner.activeLanes)
+            {
+                runner.cycleAdjust[lane] += int64_t(runner.laneCycles[lane]) - cycles;
+                runner.maxCycleAdjust = std::max(runner.maxCycleAdjust, runner.cycleAdjust[lane]);
+            }
+        }
+        runner.cycles += cycles;
+        runner.lastCycles = cycles;
+        runner.lastCyclesPerLane = conditional;
+        ++runner.statistics.lockstepInstructions;
+        runner.statistics.lockstepLaneInstructions += runner.activeLanes.size();
+        runner.pc = next;
+        if (branch)
+            Diverge(runner);
+        return true;
+    }
+};
+
+} // namespace Emulator
+
+using H = LockstepHandlersIntel8080;
+
+LockstepRunnerIntel8080::LockstepRunnerIntel8080(size_t maxCycles)
+    : maxCycles(maxCycles)
+    , lockstep(true)
+    , rom()
+    , lanes()
+    , laneCount()
+    , statistics()
+    , pc()
+    , ie()
+    , cycles()
+    , lastCycles()
+    , lastCyclesPerLane()
+    , sp()
+    , bc()
+    , de()
+    , hl()
+    , wz()
+    , a()
+    , flags()
+    , operand()
+    , nextPC()
+    , laneCycles()
+    , cycleAdjust()
+    , maxCycleAdjust()
+    , activeLanes()
+    , laneMemory()
+{
+}
+
+LockstepRunnerIntel8080::~LockstepRunnerIntel8080()
+{
+}
+
+RAMPtr LockstepRunnerIntel8080::GetRAM(size_t lane) const
+{
+    return (lane < laneCount) ? lanes[lane]->ram : nullptr;
+}
+
+IOPortPtr LockstepRunnerIntel8080::GetIOPort(size_t lane) const
+{
+    return (lane < laneCount) ? lanes[lane]->ioPort : nullptr;
+}
+
+void LockstepRunnerIntel8080::SetupLanes(size_t codeOffset, size_t codeSize, size_t count)
+{
+    if (!rom || (rom->Offset() != codeOffset) || (rom->Size() != codeSize))
+    {
+        rom = std::make_shared<ROM>(codeOffset, codeSize);
+        lanes.clear();
+    }
+    size_t ramOffset = codeOffset + codeSize;
+    while (lanes.size() < count)
+    {
+        std::unique_ptr<Lane> lane(new Lane);
+        lane->memoryManager = std::make_shared<MemoryManager>();
+        lane->ram = std::make_shared<RAM>(ramOffset, MemoryManager::AddressSpaceSize - ramOffset);
+        lane->memoryManager->AddMemory(rom);
+        lane->memoryManager->AddMemory(lane->ram);
+        lane->ioManager = std::make_shared<IOManager>();
+        lane->ioPort = std::make_shared<IOPort>(0, 256);
+        lane->ioManager->AddIO(lane->ioPort);
+        lane->processor.Setup(lane->memoryManager, lane->ioManager);
+        lanes.push_back(std::move(lane));
+    }
+    laneCount = count;
+}
+
+void LockstepRunnerIntel8080::Leave(size_t lane, uint16_t pc, bool halted)
+{
+    RegistersIntel8080 & registers = lanes[lane]->processor.GetRegisters();
+    registers.pc = pc;
+    registers.sp.W = sp[lane];
+    registers.bc.W = bc[lane];
+    registers.de.W = de[lane];
+    registers.hl.W = hl[lane];
+    registers.wz.W = wz[lane];
+    registers.a = uint8_t(a[lane]);
+    registers.flags = FlagsIntel8080(uint8_t(flags[lane]));
+    registers.ie = ie;
+    registers.isHalted = halted;
+    registers.instructionCycles = lastCyclesPerLane ? laneCycles[lane] : lastCycles;
+    registers.cycleCountTotal = size_t(int64_t(cycles) + cycleAdjust[lane]);
+}
+
+void LockstepRunnerIntel8080::RunLockstep()
+{
+    size_t capacity = (laneCount + VectorLanes - 1) / VectorLanes * VectorLanes;
+    for (auto array : { &sp, &bc, &de, &hl, &wz, &a, &flags, &operand, &nextPC })
+        array->assign(capacity, 0);
+    laneCycles.assign(capacity, 0);
+    cycleAdjust.assign(capacity, 0);
+    laneMemory.assign(capacity, nullptr);
+    for (size_t lane = 0; lane < laneCount; ++lane)
+        laneMemory[lane] = lanes[lane]->memoryManager.get();
+
+    // Every block of lanes runs from the start on its own, so the memory of the lanes in lockstep stays in the cache
+    std::vector<size_t> readyLanes;
+    std::swap(readyLanes, activeLanes);
+    auto blockBegin = readyLanes.begin();
+    while (blockBegin != readyLanes.end())
+    {
+        size_t blockEnd = (*blockBegin / BlockLanes + 1) * BlockLanes;
+        auto next = std::find_if(blockBegin, readyLanes.end(), [blockEnd](size_t lane) { return lane >= blockEnd; });
+        activeLanes.assign(blockBegin, next);
+        RunBlock();
+        blockBegin = next;
+    }
+}
+
+void LockstepRunnerIntel8080::RunBlock()
+{
+    maxCycleAdjust = 0;
+    pc = 0;
+    ie = false;
+    cycles = 0;
+    lastCycles = 0;
+    lastCyclesPerLane = false;
+
+    size_t codeOffset = rom->Offset();
+    size_t codeSize = rom->Size();
+    // Fewer lanes run faster on their own processors than through the lockstep dispatch
+    while (activeLanes.size() >= MinLockstepLanes)
+    {
+        // A lane run on its own stops at the first instruction boundary at or after the limit, so leave before
+        // any lane could get there
+        if (!lockstep || (int64_t(cycles) + maxCycleAdjust >= int64_t(maxCycles)))
+            break;
+        // Only the shared ROM is known to hold the same code for all lanes
+        size_t offset = size_t(pc) - codeOffset;
+        if ((pc < codeOffset) || (offset >= codeSize))
+            break;
+        uint8_t const * code = rom->Data() + offset;
+        if (offset + std::max(ProcessorIntel8080::GetInstructionData(OpcodesIntel8080(code[0])).instructionSize, size_t{ 1 }) > codeSize)
+            break;
+        if (!H::Step(*this, code))
+            break;
+    }
+    H::LeaveAll(*this, pc, false);
+}
+
+void LockstepRunnerIntel8080::RunScalar(size_t lane, BatchResultIntel8080 & result)
+{
+    FastProcessorIntel8080 & processor = lanes[lane]->processor;
+    RegistersIntel8080 & registers = processor.GetRegisters();
+    try
+    {
+        while (!registers.isHalted && (registers.cycleCountTotal < maxCycles))
+        {
+            size_t sliceCycles = processor.Run(size_t(maxCycles - registers.cycleCountTotal));
+            statistics.scalarCycles += sliceCycles;
+            if (sliceCycles == 0)
+                break;
+        }
+    }
+    catch (std::exception & e)
+    {
+        result.error = e.what();
+        if (result.error.empty())
+            result.error = "Unknown error";
+    }
+}
+
+BatchResultsIntel8080 LockstepRunnerIntel8080::Run(Assembler::ObjectCode const & objectCode, std::vector<LockstepInputIntel8080> const & inputs)
+{
+    Assembler::CodeSegment const & segment = objectCode.GetSegment(Assembler::SegmentID::ASEG);
+    SetupLanes(segment.Offset(), segment.Size(), inputs.size());
+    rom->Load(segment.Data(), segment.Offset());
+    statistics = LockstepStatisticsIntel8080();
+
+    BatchResultsIntel8080 results(laneCount);
+    activeLanes.clear();
+    for (size_t lane = 0; lane < laneCount; ++lane)
+    {
+        Lane & machine = *lanes[lane];
+        results[lane].index = lane;
+        try
+        {
+            machine.ram->Load(std::vector<uint8_t>(), machine.ram->Offset());
+            machine.ioPort->Load(std::vector<uint8_t>(), machine.ioPort->Offset());
+            machine.processor.Reset();
+            machine.processor.GetRegisters().isHalted = false;
+            if (!inputs[lane].data.empty())
+                machine.processor.LoadData(inputs[lane].data, inputs[lane].dataOrigin, machine.ram);
+            if (!inputs[lane].io.empty())
+                machine.processor.LoadIO(inputs[lane].io, 0, machine.ioPort);
+            activeLanes.push_back(lane);
+        }
+        catch (std::exception & e)
+        {
+            results[lane].error = e.what();
+        }
+    }
+    if (!activeLanes.empty())
+        RunLockstep();
+
+    for (size_t lane = 0; lane < laneCount; ++lane)
+    {
+        BatchResultIntel8080 & result = results[lane];
+        if (result.error.empty())
+            RunScalar(lane, result);
+        result.registers = lanes[lane]->processor.GetRegisters();
+        result.halted = result.registers.isHalted;
+        result.timedOut = !result.halted && result.error.empty();
+    }
+    return results;
+}
@@ -4,15 +4,32 @@
 #include <iomanip>
 #include <algorithm>
 #include <limits>
+#include "emulator/RAM.h"
+#include "emulator/ROM.h"
 
 using namespace Emulator;
 
 MemoryManager::MemoryManager()
-    : memoryBlocks()
+    : MemoryManager(DefaultPageSizeBits)
 {
 
 }
 
+MemoryManager::MemoryManager(size_t pageSizeBits)
+    : memoryBlocks()
+    , pageSizeBits(pageSizeBits)
+    , pageMask((size_t{ 1 } << pageSizeBits) - 1)
+    , pages(AddressSpaceSize >> pageSizeBits)
+    , storeSubscribers()
+    , nextStoreSubscription()
+    , accessCallback()
+    , trappedPages()
+    , trackDirtyPages()
+{
+    if ((pageSizeBits == 0) || ((size_t{ 1 } << pageSizeBits) > AddressSpaceSize))
+        throw std::invalid_argument("Invalid page size for memory map");
+}
+
 MemoryManager::~MemoryManager()
 {
 
@@ -21,6 +38,144 @@ MemoryManager::~MemoryManager()
 void MemoryManager::AddMemory(IMemoryPtr memory)
 {
     memoryBlocks.push_back(memory);
+    MapPages(memory);
+}
+
+// Resolve the host pointers for all pages touched by a newly added block.
+// Only pages completely covered by a single RAM or ROM block get direct access,
+// all others fall back to looking up the block on every access.
+void MemoryManager::MapPages(IMemoryPtr memory)
+{
+    size_t pageSize = PageSize();
+    size_t blockBegin = memory->Offset();
+    size_t blockEnd = memory->Offset() + memory->Size();
+    if (blockEnd > AddressSpaceSize)
+        blockEnd = AddressSpaceSize;
+    if (blockBegin >= blockEnd)
+        return;
+    for (size_t pageIndex = blockBegin >> pageSizeBits; pageIndex <= ((blockEnd - 1) >> pageSizeBits); ++pageIndex)
+    {
+        size_t pageBegin = pageIndex << pageSizeBits;
+        size_t pageEnd = pageBegin + pageSize;
+        MemoryPage & page = pages[pageIndex];
+        uint16_t storeWatchers = page.storeWatchers;
+        bool dirty = page.dirty;
+        MemoryAccess traps = page.traps;
+        page = MemoryPage();
+        page.storeWatchers = storeWatchers;
+        page.dirty = dirty;
+        page.traps = traps;
+        size_t overlappingBlocks = 0;
+        for (auto block : memoryBlocks)
+        {
+            if ((block->Offset() < pageEnd) && (pageBegin < block->Offset() + block->Size()))
+                ++overlappingBlocks;
+        }
+        if ((overlappingBlocks != 1) || (pageBegin < blockBegin) || (pageEnd > blockEnd))
+            continue;
+        RAMPtr ram = std::dynamic_pointer_cast<RAM>(memory);
+        if (ram)
+        {
+            page.contents = ram->Data() + (pageBegin - blockBegin);
+            page.data = page.contents;
+            UpdateRead(page);
+            UpdateWrite(page);
+            continue;
+        }
+        ROMPtr rom = std::dynamic_pointer_cast<ROM>(memory);
+        if (rom)
+        {
+            page.data = rom->Data() + (pageBegin - blockBegin);
+            UpdateRead(page);
+        }
+    }
+}
+
+MemoryManager::StoreSubscription MemoryManager::SubscribeStores(StoreCallback const & callback)
+{
+    StoreSubscription subscription = ++nextStoreSubscription;
+    storeSubscribers.emplace_back(subscription, callback);
+    return subscription;
+}
+
+void MemoryManager::UnsubscribeStores(StoreSubscription subscription)
+{
+    storeSubscribers.erase(std::remove_if(storeSubscribers.begin(), storeSubscribers.end(),
+                                          [subscription](std::pair<StoreSubscription, StoreCallback> const & subscriber)
+                                          { return subscriber.first == subscription; }),
+                           storeSubscribers.end());
+}
+
+void MemoryManager::WatchStores(size_t address, bool watch)
+{
+    if (address >= AddressSpaceSize)
+        return;
+    MemoryPage & page = pages[address >> pageSizeBits];
+    if (watch)
+        ++page.storeWatchers;
+    else if (page.storeWatchers != 0)
+        --page.storeWatchers;
+    UpdateWrite(page);
+}
+
+void MemoryManager::SetTraps(size_t address, MemoryAccess traps)
+{
+    if (address >= AddressSpaceSize)
+        return;
+    MemoryPage & page = pages[address >> pageSizeBits];
+    if ((page.traps != MemoryAccess::None) != (traps != MemoryAccess::None))
+    {
+        if (traps != MemoryAccess::None)
+            ++trappedPages;
+        else
+            --trappedPages;
+    }
+    page.traps = traps;
+    UpdateRead(page);
+    UpdateWrite(page);
+}
+
+// Enabling starts with all pages clean
+void MemoryManager::TrackDirtyPages(bool track)
+{
+    trackDirtyPages = track;
+    for (auto & page : pages)
+    {
+        page.dirty = false;
+        UpdateWrite(page);
+    }
+}
+
+std::vector<size_t> MemoryManager::GetDirtyPages() const
+{
+    std::vector<size_t> result;
+    for (size_t pageIndex = 0; pageIndex < pages.size(); ++pageIndex)
+    {
+        if (pages[pageIndex].dirty)
+            result.push_back(pageIndex << pageSizeBits);
+    }
+    return result;
+}
+
+void MemoryManager::ClearDirtyPages()
+{
+    for (auto & page : pages)
+    {
+        if (page.dirty)
+        {
+            page.dirty = false;
+            UpdateWrite(page);
+        }
+    }
+}
+
+void MemoryManager::MarkDirty(size_t address, size_t size)
+{
+    if (!trackDirtyPages || (size == 0))
+        return;
+    size_t end = std::min(address + size, AddressSpaceSize);
+    for (size_t offset = address; offset < end; offset = ((offset >> pageSizeBits) + 1) << pageSizeBits)
+        MarkDirty(offset);
 }
 
 size_t MemoryManager::Offset() const
@@ -58,11 +213,18 @@ IMemoryPtr MemoryManager::FindMemoryBlockForOffsetSize(size_t offset) const
 }
 
 std::vector<uint8_t> MemoryManager::Fetch(size_t address, size_t size) const
+{
+    std::vector<uint8_t> data(size);
+    Fetch(address, data.data(), size);
+    return data;
+}
+
+// Bulk accesses are split at memory block boundaries, each part is handed to the block in one go
+void MemoryManager::Fetch(size_t address, uint8_t * data, size_t size) const
 {
     size_t count = size;
     size_t offset = address;
     size_t dataOffset = 0;
-    std::vector<uint8_t> data(size);
     while (count > 0)
     {
         IMemoryPtr memoryBlock = FindMemoryBlockForOffsetSize(offset);
@@ -73,19 +235,21 @@ std::vector<uint8_t> MemoryManager::Fetch(size_t address, size_t size) const
             throw std::runtime_error(stream.str());
         }
         size_t maxBytes = std::min(count, memoryBlock->Size() - (offset - memoryBlock->Offset()));
-        while (maxBytes > 0)
-        {
-            data[dataOffset++] = memoryBlock->Fetch8(offset++);
-            maxBytes--;
-            count--;
-        }
+        memoryBlock->Fetch(offset, data + dataOffset, maxBytes);
+        offset += maxBytes;
+        dataOffset += maxBytes;
+        count -= maxBytes;
     }
-    return data;
 }
 
 void MemoryManager::Store(size_t address, std::vector<uint8_t> const & data)
 {
-    size_t count = data.size();
+    Store(address, data.data(), data.size());
+}
+
+void MemoryManager::Store(size_t address, uint8_t const * data, size_t size)
+{
+    size_t count = size;
     size_t offset = address;
     size_t dataOffset = 0;
     while (count > 0)
@@ -98,31 +262,79 @@ void MemoryManager::Store(size_t address, std::vector<uint8_t> const & data)
             throw std::runtime_error(stream.str());
         }
         size_t maxBytes = std::min(count, memoryBlock->Size() - (offset - memoryBlock->Offset()));
-        while (maxBytes > 0)
+        memoryBlock->Store(offset, data + dataOffset, maxBytes);
+        MarkDirty(offset, maxBytes);
+        NotifyStores(offset, maxBytes);
+        offset += maxBytes;
+        dataOffset += maxBytes;
+        count -= maxBytes;
+    }
+}
+
+// Report every byte written to a watched page, pages without watchers are skipped as a whole
+void MemoryManager::NotifyStores(size_t address, size_t size)
+{
+    if (storeSubscribers.empty())
+        return;
+    size_t end = std::min(address + size, AddressSpaceSize);
+    size_t offset = address;
+    while (offset < end)
+    {
+        size_t pageEnd = std::min(((offset >> pageSizeBits) + 1) << pageSizeBits, end);
+        if (pages[offset >> pageSizeBits].storeWatchers != 0)
         {
-            memoryBlock->Store8(offset++, data[dataOffset++]);
-            maxBytes--;
-            count--;
+            for (; offset < pageEnd; ++offset)
+                NotifySubscribers(offset);
         }
+        offset = pageEnd;
+    }
+}
+
+void MemoryManager::NotifySubscribers(size_t address)
+{
+    for (size_t index = 0; index < storeSubscribers.size(); ++index)
+    {
+        storeSubscribers[index].second(address);
+    }
+}
+
+uint8_t MemoryManager::FetchBlock8(size_t address) const
+{
+    IMemoryPtr memoryBlock = FindMemoryBlockForOffsetSize(address);
+    if (memoryBlock)
+    {
+        uint8_t data = memoryBlock->Fetch8(address);
+        NotifyAccess(address, MemoryAccess::Read, data);
+        return data;
     }
+    std::ostringstream stream;
+    stream << "Fetch8: No memory at location " << std::hex << std::setw(8) << std::setfill('0') << address << std::dec;
+    throw std::runtime_error(stream.str());
 }
 
-uint8_t MemoryManager::Fetch8(size_t address) const
+uint8_t MemoryManager::FetchOpcodeBlock8(size_t address) const
 {
     IMemoryPtr memoryBlock = FindMemoryBlockForOffsetSize(address);
     if (memoryBlock)
-        return memoryBlock->Fetch8(address);
+    {
+        uint8_t data = memoryBlock->Fetch8(address);
+        NotifyAccess(address, MemoryAccess::Execute, data);
+        return data;
+    }
     std::ostringstream stream;
     stream << "Fetch8: No memory at location " << std::hex << std::setw(8) << std::setfill('0') << address << std::dec;
     throw std::runtime_error(stream.str());
 }
 
-void MemoryManager::Store8(size_t address, uint8_t data)
+void MemoryManager::StoreBlock8(size_t address, uint8_t data)
 {
     IMemoryPtr memoryBlock = FindMemoryBlockForOffsetSize(address);
     if (memoryBlock)
     {
         memoryBlock->Store8(address, data);
+        MarkDirty(address);
+        NotifyStore(address);
+        NotifyAccess(address, MemoryAccess::Write, data);
         return;
     }
     std::ostringstream stream;
@@ -0,0 +1,345 @@
+#include "emulator/MultiProcessorSystemIntel8080.h"
+
+#include <algorithm>
+#include <condition_variable>
+#include <exception>
+#include <mutex>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include "core/WorkerThread.h"
+
+using namespace Emulator;
+
+void MultiProcessorStatisticsIntel8080::Add(MultiProcessorStatisticsIntel8080 const & other)
+{
+    if (other.quanta != 0)
+    {
+        if ((quanta == 0) || (other.minQuantumCycles < minQuantumCycles))
+            minQuantumCycles = other.minQuantumCycles;
+        maxQuantumCycles = std::max(maxQuantumCycles, other.maxQuantumCycles);
+    }
+    syncs += other.syncs;
+    quanta += other.quanta;
+    quantumCycles += other.quantumCycles;
+    haltedQuanta += other.haltedQuanta;
+    sharedPageWrites += other.sharedPageWrites;
+    contendedPages += other.contendedPages;
+    contendedSyncs += other.contendedSyncs;
+}
+
+// State of a threaded run shared by the workers, protected by mutex
+struct MultiProcessorSystemIntel8080::ThreadedRun
+{
+    std::mutex mutex;
+    std::condition_variable condition;
+    size_t arrived;
+    size_t generation;
+    uint64_t windowStart;
+    uint64_t windowEnd;
+    uint64_t end;
+    bool done;
+    std::exception_ptr error;
+    std::vector<MultiProcessorStatisticsIntel8080> statistics;  // Of every processor, only written by its own worker
+
+    ThreadedRun(uint64_t start, uint64_t windowEnd, uint64_t end, size_t processorCount)
+        : mutex()
+        , condition()
+        , arrived()
+        , generation()
+        , windowStart(start)
+        , windowEnd(windowEnd)
+        , end(end)
+        , done()
+        , error()
+        , statistics(processorCount)
+    {
+    }
+};
+
+// Runs a single processor up to the end of every sync window, and waits for the others at the end of it.
+// The last worker to arrive does the work of the sync point, while all others are waiting.
+class MultiProcessorSystemIntel8080::Worker : public Core::WorkerThread
+{
+public:
+    Worker(std::string const & name, MultiProcessorSystemIntel8080 & system, ThreadedRun & run, size_t index)
+        : Core::WorkerThread(name)
+        , system(system)
+        , run(run)
+        , index(index)
+    {
+    }
+
+    void * Thread() override
+    {
+        for (;;)
+        {
+            uint64_t windowStart;
+            uint64_t windowEnd;
+            {
+                std::lock_guard<std::mutex> lock(run.mutex);
+                windowStart = run.windowStart;
+                windowEnd = run.windowEnd;
+            }
+            try
+            {
+                uint64_t target = windowStart;
+                while (target < windowEnd)
+                {
+                    target = std::min(target + system.quantum, windowEnd);
+                    system.RunQuantum(index, target, run.statistics[index]);
+                }
+            }
+            catch (...)
+            {
+                std::lock_guard<std::mutex> lock(run.mutex);
+                if (!run.error)
+                    run.error = std::current_exception();
+            }
+            std::unique_lock<std::mutex> lock(run.mutex);
+            if (++run.arrived == system.processors.size())
+            {
+                run.arrived = 0;
+                ++run.generation;
+                system.now = windowEnd;
+                system.Sync();
+                run.done = run.error || (windowEnd >= run.end) || system.IsStopped();
+                run.windowStart = windowEnd;
+                run.windowEnd = std::min(windowEnd + system.quantum * system.syncQuanta, run.end);
+                run.condition.notify_all();
+            }
+            else
+            {
+                size_t generation = run.generation;
+                run.condition.wait(lock, [this, generation]() { return run.generation != generation; });
+            }
+            if (run.done)
+                return nullptr;
+        }
+    }
+
+private:
+    MultiProcessorSystemIntel8080 & system;
+    ThreadedRun & run;
+    size_t index;
+};
+
+MultiProcessorSystemIntel8080::MultiProcessorSystemIntel8080(size_t quantum)
+    : quantum()
+    , syncQuanta(DefaultSyncQuanta)
+    , scheduling(SchedulingIntel8080::Deterministic)
+    , ioManager(std::make_shared<IOManager>())
+    , sharedMemory()
+    , processors()
+    , now()
+    , statistics()
+    , pageWriters(MemoryManager::AddressSpaceSize >> MemoryManager::DefaultPageSizeBits)
+{
+    SetQuantum(quantum);
+}
+
+MultiProcessorSystemIntel8080::~MultiProcessorSystemIntel8080()
+{
+}
+
+void MultiProcessorSystemIntel8080::AddSharedMemory(IMemoryPtr memory)
+{
+    sharedMemory.push_back(memory);
+    for (auto & node : processors)
+    {
+        node.memoryManager->AddMemory(memory);
+    }
+}
+
+size_t MultiProcessorSystemIntel8080::AddProcessor(std::shared_ptr<ProcessorIntel8080> processor, IOManagerPtr ioManager)
+{
+    if (processor == nullptr)
+        throw std::runtime_error("No processor to add");
+    Node node;
+    node.processor = processor;
+    node.memoryManager = std::make_shared<MemoryManager>();
+    for (auto memory : sharedMemory)
+    {
+        node.memoryManager->AddMemory(memory);
+    }
+    node.memoryManager->TrackDirtyPages(true);
+    processor->Setup(node.memoryManager, ioManager ? ioManager : this->ioManager);
+    // Joins the time line of the other processors
+    processor->GetRegisters().cycleCountTotal = now;
+    processors.push_back(node);
+    return processors.size() - 1;
+}
+
+void MultiProcessorSystemIntel8080::AddPrivateMemory(size_t index, IMemoryPtr memory)
+{
+    GetMemoryManager(index)->AddMemory(memory);
+}
+
+ProcessorIntel8080 & MultiProcessorSystemIntel8080::GetProcessor(size_t index) const
+{
+    if (index >= processors.size())
+    {
+        std::ostringstream stream;
+        stream << "Processor index " << index << " out of range, system has " << processors.size() << " processors";
+        throw std::runtime_error(stream.str());
+    }
+    return *processors[index].processor;
+}
+
+MemoryManagerPtr MultiProcessorSystemIntel8080::GetMemoryManager(size_t index) const
+{
+    GetProcessor(index);
+    return processors[index].memoryManager;
+}
+
+void MultiProcessorSystemIntel8080::SetQuantum(size_t cycles)
+{
+    if (cycles == 0)
+        throw std::runtime_error("Quantum must be at least one cycle");
+    quantum = cycles;
+}
+
+void MultiProcessorSystemIntel8080::SetSyncQuanta(size_t quanta)
+{
+    if (quanta == 0)
+        throw std::runtime_error("Sync interval must be at least one quantum");
+    syncQuanta = quanta;
+}
+
+void MultiProcessorSystemIntel8080::Reset()
+{
+    now = 0;
+    for (auto & node : processors)
+    {
+        node.processor->Reset();
+        node.memoryManager->ClearDirtyPages();
+    }
+}
+
+uint64_t MultiProcessorSystemIntel8080::Run(uint64_t budget)
+{
+    uint64_t start = now;
+    if (processors.empty() || IsStopped())
+        return 0;
+    uint64_t end = (budget > UINT64_MAX - now) ? UINT64_MAX : now + budget;
+    if (scheduling == SchedulingIntel8080::Threaded)
+        RunThreaded(end);
+    else
+        RunDeterministic(end);
+    return now - start;
+}
+
+bool MultiProcessorSystemIntel8080::IsStopped() const
+{
+    for (auto const & node : processors)
+    {
+        ProcessorIntel8080 & processor = *node.processor;
+        if (!processor.GetRegisters().isHalted || processor.GetInterruptController().IsPending() ||
+            (processor.GetScheduler().NextDeadline() != EventScheduler::NoDeadline))
+            return false;
+    }
+    return true;
+}
+
+uint64_t MultiProcessorSystemIntel8080::RunDeterministic(uint64_t end)
+{
+    while (now < end)
+    {
+        uint64_t target = (end - now > quantum) ? now + quantum : end;
+        for (size_t index = 0; index < processors.size(); ++index)
+        {
+            RunQuantum(index, target, statistics);
+        }
+        now = target;
+        Sync();
+        if (IsStopped())
+            break;
+    }
+    return now;
+}
+
+uint64_t MultiProcessorSystemIntel8080::RunThreaded(uint64_t end)
+{
+    uint64_t window = uint64_t(quantum) * syncQuanta;
+    ThreadedRun run(now, (end - now > window) ? now + window : end, end, processors.size());
+    std::vector<std::unique_ptr<Worker>> workers;
+    for (size_t index = 0; index < processors.size(); ++index)
+    {
+        workers.emplace_back(new Worker("CPU" + std::to_string(index), *this, run, index));
+        workers.back()->Create();
+    }
+    for (auto & worker : workers)
+    {
+        worker->WaitForDeath();
+    }
+    for (auto const & processorStatistics : run.statistics)
+    {
+        statistics.Add(processorStatistics);
+    }
+    if (run.error)
+        std::rethrow_exception(run.error);
+    return now;
+}
+
+// Run a processor up to end on the time line. Time passes on a halted processor through Run(budget), so events
+// due within the quantum run at their deadline. One with nothing scheduled waits for an event at the end of the quantum.
+void MultiProcessorSystemIntel8080::RunQuantum(size_t index, uint64_t end, MultiProcessorStatisticsIntel8080 & quantumStatistics)
+{
+    ProcessorIntel8080 & processor = *processors[index].processor;
+    if (processor.Now() >= end)
+        return;
+    uint64_t haltCycles = processor.GetIdleStatistics().haltCycles;
+    size_t cycles = processor.Run(size_t(end - processor.Now()));
+    if (processor.GetRegisters().isHalted && (processor.Now() < end))
+    {
+        EventID wait = processor.GetScheduler().Schedule(end, [](uint64_t) {});
+        cycles += processor.Run(size_t(end - processor.Now()));
+        processor.GetScheduler().Cancel(wait);
+    }
+    size_t halted = size_t(processor.GetIdleStatistics().haltCycles - haltCycles);
+    size_t executed = cycles - halted;
+    if (executed != 0)
+    {
+        if ((quantumStatistics.quanta == 0) || (executed < quantumStatistics.minQuantumCycles))
+            quantumStatistics.minQuantumCycles = executed;
+        quantumStatistics.maxQuantumCycles = std::max(quantumStatistics.maxQuantumCycles, executed);
+        ++quantumStatistics.quanta;
+        quantumStatistics.quantumCycles += executed;
+    }
+    if (halted != 0)
+        ++quantumStatistics.haltedQuanta;
+}
+
+bool MultiProcessorSystemIntel8080::IsShared(size_t address) const
+{
+    size_t pageEnd = address + (size_t{ 1 } << MemoryManager::DefaultPageSizeBits);
+    for (auto const & memory : sharedMemory)
+    {
+        if ((memory->Offset() < pageEnd) && (address < memory->Offset() + memory->Size()))
+            return true;
+    }
+    return false;
+}
+
+// Count the shared pages written since the last sync point, and by how many processors
+void MultiProcessorSystemIntel8080::Sync()
+{
+    ++statistics.syncs;
+    std::fill(pageWriters.begin(), pageWriters.end(), size_t{ 0 });
+    size_t contended = 0;
+    for (auto & node : processors)
+    {
+        for (size_t address : node.memoryManager->GetDirtyPages())
+        {
+            if (!IsShared(address))
+                continue;
+            ++statistics.sharedPageWrites;
+            if (++pageWriters[address >> MemoryManager::DefaultPageSizeBits] == 2)
+                ++contended;
+        }
+        node.memoryManager->ClearDirtyPages();
+    }
+    statistics.contendedPages += contended;
+    if (contended != 0)
+        ++statistics.contendedSyncs;
+}
@@ -1,6 +1,11 @@
 #include "emulator/ProcessorIntel8080.h"
 
 #include <memory>
+#include "emulator/BreakpointManager.h"
+#include "emulator/CoverageMapIntel8080.h"
+#include "emulator/ProfilerIntel8080.h"
+#include "emulator/ReplayLogIntel8080.h"
+#include "emulator/TraceIntel8080.h"
 
 using namespace Assembler;
 using namespace Emulator;
@@ -371,7 +376,7 @@ const uint16_t ProcessorIntel8080::correctDAATable[1024] =
     0x0140, 0x0541, 0x0542, 0x0143, 0x0544, 0x0145, 0x0146, 0x0547,
     0x0548, 0x0149, 0x1550, 0x1151, 0x1152, 0x1553, 0x1154, 0x1555,
     0x0550, 0x0151, 0x0152, 0x0553, 0x0154, 0x0555, 0x0556, 0x0157,
-    0x0158, 0x0559, 0x5400, 0x1001, 0x1002, 0x1403, 0x1004, 0x1405,
+    0x0158, 0x0559, 0x1560, 0x1161, 0x1162, 0x1563, 0x1164, 0x1565,
     0x0560, 0x0161, 0x0162, 0x0563, 0x0164, 0x0565, 0x0566, 0x0167,
     0x0168, 0x0569, 0x1170, 0x1571, 0x1572, 0x1173, 0x1574, 0x1175,
     0x0170, 0x0571, 0x0572, 0x0173, 0x0574, 0x0175, 0x0176, 0x0577,
@@ -435,7 +440,7 @@ const uint16_t ProcessorIntel8080::correctDAATable[1024] =
     0x1146, 0x1547, 0x1548, 0x1149, 0x114a, 0x154b, 0x114c, 0x154d,
     0x154e, 0x114f, 0x1550, 0x1151, 0x1152, 0x1553, 0x1154, 0x1555,
     0x1556, 0x1157, 0x1158, 0x1559, 0x155a, 0x115b, 0x155c, 0x115d,
-    0x115e, 0x155f, 0x5400, 0x1001, 0x1002, 0x1403, 0x1004, 0x1405,
+    0x115e, 0x155f, 0x1560, 0x1161, 0x1162, 0x1563, 0x1164, 0x1565,
     0x1566, 0x1167, 0x1168, 0x1569, 0x156a, 0x116b, 0x156c, 0x116d,
     0x116e, 0x156f, 0x1170, 0x1571, 0x1572, 0x1173, 0x1574, 0x1175,
     0x1176, 0x1577, 0x1578, 0x1179, 0x117a, 0x157b, 0x117c, 0x157d,
@@ -482,7 +487,16 @@ ProcessorIntel8080::ProcessorIntel8080()
     , instruction()
     , debugEnabled()
     , debugCallback()
+    , loopCallback()
     , isForcedToHalt()
+    , scheduler()
+    , interruptController()
+    , profiler()
+    , coverage()
+    , replayLog()
+    , traceRecorder()
+    , idleSkipping()
+    , idleStatistics()
 {
 
 }
@@ -547,6 +561,8 @@ void ProcessorIntel8080::FetchInstruction()
     // Turn tracing on when reached trap address
     if (registers.trapEnabled && (registers.pc == registers.trap))
         registers.trace = true;
+    if (traceRecorder)
+        traceRecorder->Record(registers);
     // Call single-step debugger, exit if requested
     if (registers.trace)
         if (debugCallback && !debugCallback(registers))
@@ -555,7 +571,9 @@ void ProcessorIntel8080::FetchInstruction()
             return;
         }
 
-    uint8_t data = FetchInstructionByte();
+    // Opcode fetches can stop at a breakpoint, leaving pc unchanged
+    uint8_t data = memoryManager->FetchOpcode8(registers.pc);
+    ++registers.pc;
     if (isForcedToHalt)
     {
         instruction = OpcodesIntel8080::NOP;
@@ -997,7 +1015,7 @@ void ProcessorIntel8080::ExecuteInstruction()
                                          registers.pc = FetchInstructionWord();
                                      else
                                          FetchInstructionWord();                                                         break;
-    case OpcodesIntel8080::INP:      registers.a = ioManager->In8(FetchInstructionByte());                               break;
+    case OpcodesIntel8080::INP:      registers.a = InPort(FetchInstructionByte());                                       break;
     case OpcodesIntel8080::CC:       condition = (registers.flags & FlagsIntel8080::Carry) != FlagsIntel8080::None;
                                      if (condition) 
                                      {
@@ -1118,10 +1136,24 @@ void ProcessorIntel8080::ExecuteInstruction()
 
 bool ProcessorIntel8080::RunInstruction()
 {
-    FetchInstruction();
+    MemoryAddressType pc = registers.pc;
+    try
+    {
+        FetchInstruction();
+    }
+    catch (ExecutionBreak const &)
+    {
+        return false;
+    }
     if (IsHalted())
         return false;
     ExecuteInstruction();
+#if !defined(EMULATOR_NO_PROFILER)
+    if (profiler)
+        profiler->Record(pc, uint8_t(instruction), registers.pc, registers.instructionCycles);
+#endif
+    if (coverage)
+        coverage->Record(pc, uint8_t(instruction), registers.pc);
     if (IsHalted())
         return false;
     return true;
@@ -1134,4 +1166,154 @@ void ProcessorIntel8080::Run()
     }
 }
 
+size_t ProcessorIntel8080::Run(size_t budget)
+{
+    size_t cycles = 0;
+    // An interrupt may wake up a halted processor
+    ServiceEvents();
+    // Fetching on a halted processor resets the registers
+    while (cycles < budget)
+    {
+        if (IsHalted())
+        {
+            if (!SkipHalted(cycles, budget))
+                break;
+            continue;
+        }
+        MemoryAddressType pc = registers.pc;
+        try
+        {
+            FetchInstruction();
+        }
+        catch (ExecutionBreak const &)
+        {
+            break;
+        }
+        if (IsHalted())
+            break;
+        ExecuteInstruction();
+#if !defined(EMULATOR_NO_PROFILER)
+        if (profiler)
+            profiler->Record(pc, uint8_t(instruction), registers.pc, registers.instructionCycles);
+#endif
+        if (coverage)
+            coverage->Record(pc, uint8_t(instruction), registers.pc);
+        cycles += registers.instructionCycles;
+        registers.cycleCountTotal += registers.instructionCycles;
+        if ((registers.cycleCountPeriod != 0) && (registers.cycleCount <= 0) && !PeriodElapsed())
+            break;
+        if (EventsDue())
+            ServiceEvents();
+    }
+    return cycles;
+}
+
+InterruptFlagsIntel8080 ProcessorIntel8080::Loop()
+{
+    if (loopCallback)
+        return loopCallback(registers);
+    return InterruptFlagsIntel8080::None;
+}
+
+// Called when cycleCount has run out: reload the counter, call the periodic handler and act on its result.
+// Returns false if the handler wants to stop running.
+bool ProcessorIntel8080::PeriodElapsed()
+{
+    registers.cycleCount += int64_t(registers.cycleCountPeriod);
+    InterruptFlagsIntel8080 interrupt = Loop();
+    if (interrupt == InterruptFlagsIntel8080::Quit)
+        return false;
+    if (interrupt != InterruptFlagsIntel8080::None)
+        HandleInterrupt(interrupt);
+    return true;
+}
+
+// Deliver an interrupt as the restart instruction would, if interrupts are enabled.
+// While replaying, interrupts only come from the replay log.
+void ProcessorIntel8080::HandleInterrupt(InterruptFlagsIntel8080 interrupt)
+{
+    if (!registers.ie)
+        return;
+    if (replayLog)
+    {
+        if (replayLog->IsReplaying())
+            return;
+        replayLog->RecordInterrupt(uint16_t(interrupt));
+    }
+    DeliverInterrupt(uint16_t(interrupt));
+}
+
+void ProcessorIntel8080::DeliverInterrupt(uint16_t address)
+{
+    registers.ie = false;
+    registers.isHalted = false;
+    Push(registers.pc);
+    registers.pc = address;
+}
+
+uint8_t ProcessorIntel8080::InPort(uint8_t port)
+{
+    if (replayLog)
+        return replayLog->In(port);
+    return ioManager->In8(port);
+}
+
+// Number of cycles that can run before the next event is due, at most limit.
+// While an interrupt is waiting to be accepted, run single instructions. Requests pending while interrupts
+// are disabled wait for EI, which ends the slice in every engine.
+size_t ProcessorIntel8080::EventSliceLength(size_t limit) const
+{
+    if (registers.ie && interruptController.IsPending())
+        return 1;
+    uint64_t deadline = scheduler.NextDeadline();
+    if (deadline <= registers.cycleCountTotal)
+        return 1;
+    if (deadline - registers.cycleCountTotal < limit)
+        return size_t(deadline - registers.cycleCountTotal);
+    return limit;
+}
+
+void ProcessorIntel8080::ServiceEvents()
+{
+    scheduler.RunDue(registers.cycleCountTotal);
+    AcceptInterrupt();
+}
+
+// Let time pass on a halted processor up to the next event, the end of the period or the end of the budget,
+// and service what is due then. Returns false if the processor has stopped: forced to halt, halted with neither
+// a period nor an event to pass the time with, or Loop() returning Quit.
+bool ProcessorIntel8080::SkipHalted(size_t & cycles, size_t budget)
+{
+    bool periodic = (registers.cycleCountPeriod != 0);
+    if (isForcedToHalt)
+        return false;
+    if (!periodic && (scheduler.NextDeadline() == EventScheduler::NoDeadline))
+        return false;
+    size_t skip = EventSliceLength(budget - cycles);
+    if (periodic && (registers.cycleCount > 0) && (size_t(registers.cycleCount) < skip))
+        skip = size_t(registers.cycleCount);
+    cycles += skip;
+    registers.cycleCountTotal += skip;
+    ++idleStatistics.haltSkips;
+    idleStatistics.haltCycles += skip;
+    if (periodic)
+    {
+        registers.cycleCount -= int64_t(skip);
+        if ((registers.cycleCount <= 0) && !PeriodElapsed())
+            return false;
+    }
+    if (EventsDue())
+        ServiceEvents();
+    return true;
+}
+
+// The instruction following EI is always executed before an interrupt is accepted
+void ProcessorIntel8080::AcceptInterrupt()
+{
+    if (!registers.ie || !interruptController.IsPending() || (instruction == OpcodesIntel8080::EI))
+        return;
+    uint8_t level = interruptController.Acknowledge();
+    HandleInterrupt(InterruptFlagsIntel8080(level * 8));
+}
+
  
\ No newline at end of file
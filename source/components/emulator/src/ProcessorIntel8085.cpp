@@ -0,0 +1,23 @@
+#include "emulator/ProcessorIntel8085.h"
+
+using namespace Emulator;
+
+ProcessorIntel8085::ProcessorIntel8085()
+    : FastProcessorIntel8080(instructionHandlers8085)
+    , interruptMasks(0x07)
+    , serialInput()
+    , serialOutput()
+{
+}
+
+ProcessorIntel8085::~ProcessorIntel8085()
+{
+}
+
+void ProcessorIntel8085::Reset()
+{
+    // RST 5.5, 6.5 and 7.5 are masked by a reset
+    interruptMasks = 0x07;
+    serialOutput = false;
+    FastProcessorIntel8080::Reset();
+}
@@ -0,0 +1,257 @@
+#include "emulator/ProfilerIntel8080.h"
+
+#include <algorithm>
+#include <iomanip>
+#include <sstream>
+
+using namespace Emulator;
+
+ProfilerIntel8080::ProfilerIntel8080(uint16_t entry)
+    : entry(entry)
+    , counters()
+    , nodes()
+    , callStack()
+    , currentNode()
+    , totalCycles()
+    , nodeStartCycles()
+    , controlFlow()
+{
+    for (size_t opcode = 0; opcode < 256; ++opcode)
+    {
+        switch (opcode & 0xC7)
+        {
+        case 0xC0: controlFlow[opcode] = ControlFlow::ConditionalReturn; break;
+        case 0xC2: controlFlow[opcode] = ControlFlow::Jump; break;
+        case 0xC4: controlFlow[opcode] = ControlFlow::ConditionalCall; break;
+        case 0xC7: controlFlow[opcode] = ControlFlow::Call; break;
+        default:   controlFlow[opcode] = ControlFlow::None; break;
+        }
+    }
+    controlFlow[0xCD] = ControlFlow::Call;
+    controlFlow[0xC9] = ControlFlow::Return;
+    Reset();
+}
+
+ProfilerIntel8080::~ProfilerIntel8080()
+{
+}
+
+void ProfilerIntel8080::Reset()
+{
+    counters.assign(AddressSpaceSize, ProfileCountersIntel8080());
+    nodes.clear();
+    nodes.emplace_back(entry, size_t{ Root });
+    nodes[Root].calls = 1;
+    callStack.clear();
+    callStack.reserve(MaxCallDepth);
+    currentNode = Root;
+    totalCycles = 0;
+    nodeStartCycles = 0;
+}
+
+void ProfilerIntel8080::RecordControlFlow(uint16_t pc, uint8_t opcode, uint16_t nextPC)
+{
+    ControlFlow flow = controlFlow[opcode];
+    uint16_t fallThrough = uint16_t(pc + (((flow == ControlFlow::Jump) || (flow == ControlFlow::ConditionalCall) || (opcode == 0xCD)) ? 3 : 1));
+    if ((flow == ControlFlow::Jump) || (flow == ControlFlow::ConditionalCall) || (flow == ControlFlow::ConditionalReturn))
+    {
+        ProfileCountersIntel8080 & counter = counters[pc];
+        if (nextPC == fallThrough)
+        {
+            ++counter.notTaken;
+            return;
+        }
+        ++counter.taken;
+    }
+    switch (flow)
+    {
+    case ControlFlow::Call:
+    case ControlFlow::ConditionalCall:
+        {
+            // Deeper calls, e.g. unbounded recursion, are counted in the deepest function
+            if (callStack.size() >= MaxCallDepth)
+                return;
+            size_t child;
+            auto it = nodes[currentNode].children.find(nextPC);
+            if (it == nodes[currentNode].children.end())
+            {
+                child = nodes.size();
+                nodes.emplace_back(nextPC, currentNode);
+                nodes[currentNode].children[nextPC] = child;
+            }
+            else
+                child = it->second;
+            ++nodes[child].calls;
+            UpdateCurrentNode();
+            Frame frame;
+            frame.returnAddress = fallThrough;
+            frame.node = currentNode;
+            callStack.push_back(frame);
+            currentNode = child;
+        }
+        break;
+    case ControlFlow::Return:
+    case ControlFlow::ConditionalReturn:
+        // A return to an address no call pushed is a computed jump, the tree stays as it is
+        for (size_t index = callStack.size(); index > 0; --index)
+        {
+            if (callStack[index - 1].returnAddress == nextPC)
+            {
+                UpdateCurrentNode();
+                currentNode = callStack[index - 1].node;
+                callStack.resize(index - 1);
+                break;
+            }
+        }
+        break;
+    default:
+        break;
+    }
+}
+
+uint64_t ProfilerIntel8080::TotalInstructions() const
+{
+    uint64_t total = 0;
+    for (auto const & counter : counters)
+        total += counter.executions;
+    return total;
+}
+
+std::string ProfilerIntel8080::Describe(SymbolTableIntel8080 const & symbols, uint16_t address)
+{
+    std::ostringstream stream;
+    stream << std::hex << std::uppercase;
+    auto it = symbols.upper_bound(address);
+    if (it == symbols.begin())
+    {
+        stream << std::setw(4) << std::setfill('0') << address;
+        return stream.str();
+    }
+    --it;
+    stream << it->second;
+    if (address != it->first)
+        stream << "+" << (address - it->first);
+    return stream.str();
+}
+
+static double Percentage(uint64_t part, uint64_t total)
+{
+    return (total != 0) ? 100.0 * double(part) / double(total) : 0.0;
+}
+
+void ProfilerIntel8080::WriteFlat(std::ostream & stream, SymbolTableIntel8080 const & symbols, size_t maxAddresses) const
+{
+    uint64_t totalCycles = TotalCycles();
+    stream << "Total: " << totalCycles << " cycles, " << TotalInstructions() << " instructions" << std::endl;
+
+    struct Function
+    {
+        std::string name;
+        uint64_t cycles;
+        uint64_t instructions;
+    };
+    std::map<uint16_t, Function> functions;
+    std::vector<uint16_t> addresses;
+    for (size_t address = 0; address < AddressSpaceSize; ++address)
+    {
+        ProfileCountersIntel8080 const & counter = counters[address];
+        if (counter.executions == 0)
+            continue;
+        addresses.push_back(uint16_t(address));
+        auto symbol = symbols.upper_bound(uint16_t(address));
+        uint16_t function = (symbol == symbols.begin()) ? uint16_t(address) : (--symbol)->first;
+        auto it = functions.find(function);
+        if (it == functions.end())
+        {
+            Function entry;
+            entry.name = Describe(symbols, function);
+            entry.cycles = 0;
+            entry.instructions = 0;
+            it = functions.insert(std::make_pair(function, entry)).first;
+        }
+        it->second.cycles += counter.cycles;
+        it->second.instructions += counter.executions;
+    }
+
+    std::vector<Function> sortedFunctions;
+    for (auto const & entry : functions)
+        sortedFunctions.push_back(entry.second);
+    std::stable_sort(sortedFunctions.begin(), sortedFunctions.end(),
+                     [](Function const & lhs, Function const & rhs) { return lhs.cycles > rhs.cycles; });
+    std::stable_sort(addresses.begin(), addresses.end(),
+                     [this](uint16_t lhs, uint16_t rhs) { return counters[lhs].cycles > counters[rhs].cycles; });
+
+    stream << std::endl << "      cycles       %  instructions  function" << std::endl;
+    for (auto const & function : sortedFunctions)
+    {
+        stream << std::setw(12) << function.cycles << " "
+               << std::setw(6) << std::fixed << std::setprecision(2) << Percentage(function.cycles, totalCycles) << "% "
+               << std::setw(13) << function.instructions << "  " << function.name << std::endl;
+    }
+
+    stream << std::endl << "      cycles       %    executions       taken   not taken  address  location" << std::endl;
+    size_t count = std::min(maxAddresses, addresses.size());
+    for (size_t index = 0; index < count; ++index)
+    {
+        uint16_t address = addresses[index];
+        ProfileCountersIntel8080 const & counter = counters[address];
+        stream << std::setw(12) << counter.cycles << " "
+               << std::setw(6) << std::fixed << std::setprecision(2) << Percentage(counter.cycles, totalCycles) << "% "
+               << std::setw(13) << counter.executions << " "
+               << std::setw(11) << counter.taken << " "
+               << std::setw(11) << counter.notTaken << "  "
+               << std::hex << std::uppercase << std::setfill('0') << std::setw(4) << address << std::dec << std::setfill(' ')
+               << "     " << Describe(symbols, address) << std::endl;
+    }
+}
+
+// Nodes are only appended, children always come after their parent
+std::vector<uint64_t> ProfilerIntel8080::InclusiveCycles() const
+{
+    UpdateCurrentNode();
+    std::vector<uint64_t> inclusive(nodes.size());
+    for (size_t node = nodes.size(); node > 0; --node)
+    {
+        inclusive[node - 1] += nodes[node - 1].selfCycles;
+        if (node - 1 != Root)
+            inclusive[nodes[node - 1].parent] += inclusive[node - 1];
+    }
+    return inclusive;
+}
+
+void ProfilerIntel8080::WriteCallTree(std::ostream & stream, SymbolTableIntel8080 const & symbols) const
+{
+    stream << "       calls   inclusive        self  function" << std::endl;
+    WriteCallTree(stream, symbols, InclusiveCycles(), Root, 0);
+}
+
+void ProfilerIntel8080::WriteCallTree(std::ostream & stream, SymbolTableIntel8080 const & symbols, std::vector<uint64_t> const & inclusive,
+                                      size_t node, size_t depth) const
+{
+    CallNodeIntel8080 const & callNode = nodes[node];
+    stream << std::setw(12) << callNode.calls << std::setw(12) << inclusive[node] << std::setw(12) << callNode.selfCycles << "  "
+           << std::string(2 * depth, ' ') << Describe(symbols, callNode.function) << std::endl;
+    std::vector<size_t> children;
+    for (auto const & child : callNode.children)
+        children.push_back(child.second);
+    std::stable_sort(children.begin(), children.end(),
+                     [&inclusive](size_t lhs, size_t rhs) { return inclusive[lhs] > inclusive[rhs]; });
+    for (auto child : children)
+        WriteCallTree(stream, symbols, inclusive, child, depth + 1);
+}
+
+void ProfilerIntel8080::WriteFolded(std::ostream & stream, SymbolTableIntel8080 const & symbols) const
+{
+    UpdateCurrentNode();
+    WriteFolded(stream, symbols, std::string(), Root);
+}
+
+void ProfilerIntel8080::WriteFolded(std::ostream & stream, SymbolTableIntel8080 const & symbols, std::string const & path, size_t node) const
+{
+    CallNodeIntel8080 const & callNode = nodes[node];
+    std::string nodePath = (path.empty() ? std::string() : path + ";") + Describe(symbols, callNode.function);
+    if (callNode.selfCycles != 0)
+        stream << nodePath << " " << callNode.selfCycles << std::endl;
+    for (auto const & child : callNode.children)
+        WriteFolded(stream, symbols, nodePath, child.second);
+}
@@ -2,6 +2,7 @@
 
 #include <sstream>
 #include <iomanip>
+#include <cstring>
 
 using namespace Emulator;
 
@@ -68,6 +69,13 @@ size_t RAM::Size() const
 }
 
 std::vector<uint8_t> RAM::Fetch(size_t address, size_t size) const
+{
+    std::vector<uint8_t> data(size);
+    Fetch(address, data.data(), size);
+    return data;
+}
+
+void RAM::Fetch(size_t address, uint8_t * data, size_t size) const
 {
     if ((address < base) || (address + size > base + contents.size()))
     {
@@ -78,25 +86,28 @@ std::vector<uint8_t> RAM::Fetch(size_t address, size_t size) const
                << std::setw(8) << std::setfill('0') << address + size << std::dec;
         throw std::runtime_error(stream.str());
     }
-    size_t offset = address - base;
-    std::vector<uint8_t> data(size);
-    std::copy(contents.begin() + offset, contents.begin() + offset + size, data.begin());
-    return data;
+    if (size > 0)
+        std::memcpy(data, contents.data() + (address - base), size);
 }
 
 void RAM::Store(size_t address, std::vector<uint8_t> const & data)
 {
-    if ((address < base) || (address + data.size() > base + contents.size()))
+    Store(address, data.data(), data.size());
+}
+
+void RAM::Store(size_t address, uint8_t const * data, size_t size)
+{
+    if ((address < base) || (address + size > base + contents.size()))
     {
         std::ostringstream stream;
-        stream << "Fetch outside RAM region (" << std::hex << std::setw(8) << std::setfill('0') << base << "-" 
-               << std::setw(8) << std::setfill('0') << base + contents.size() - 1 << "), trying to fetch @ "
+        stream << "Store outside RAM region (" << std::hex << std::setw(8) << std::setfill('0') << base << "-" 
+               << std::setw(8) << std::setfill('0') << base + contents.size() - 1 << "), trying to store @ "
                << std::setw(8) << std::setfill('0') << address << "-"
-               << std::setw(8) << std::setfill('0') << address + data.size() << std::dec;
+               << std::setw(8) << std::setfill('0') << address + size << std::dec;
         throw std::runtime_error(stream.str());
     }
-    size_t offset = address - base;
-    std::copy(data.begin(), data.end(), contents.begin() + offset);
+    if (size > 0)
+        std::memcpy(contents.data() + (address - base), data, size);
 }
 
 uint8_t RAM::Fetch8(size_t address) const
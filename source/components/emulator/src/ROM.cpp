@@ -2,6 +2,7 @@
 
 #include <sstream>
 #include <iomanip>
+#include <cstring>
 
 using namespace Emulator;
 
@@ -67,6 +68,13 @@ size_t ROM::Size() const
 }
 
 std::vector<uint8_t> ROM::Fetch(size_t address, size_t size) const
+{
+    std::vector<uint8_t> data(size);
+    Fetch(address, data.data(), size);
+    return data;
+}
+
+void ROM::Fetch(size_t address, uint8_t * data, size_t size) const
 {
     if ((address < base) || (address + size > base + contents.size()))
     {
@@ -77,10 +85,8 @@ std::vector<uint8_t> ROM::Fetch(size_t address, size_t size) const
                << std::setw(8) << std::setfill('0') << address + size << std::dec;
         throw std::runtime_error(stream.str());
     }
-    size_t offset = address - base;
-    std::vector<uint8_t> data(size);
-    std::copy(contents.begin() + offset, contents.begin() + offset + size, data.begin());
-    return data;
+    if (size > 0)
+        std::memcpy(data, contents.data() + (address - base), size);
 }
 
 uint8_t ROM::Fetch8(size_t address) const
@@ -0,0 +1,125 @@
+#include "emulator/RecompiledProcessorIntel8080.h"
+
+#include <algorithm>
+
+using namespace Emulator;
+
+RecompiledProcessorIntel8080::RecompiledProcessorIntel8080()
+    : FastProcessorIntel8080()
+    , blocks(MemoryManager::AddressSpaceSize)
+    , pageBlocks()
+    , codeModified()
+    , statistics()
+    , storeSubscription()
+{
+    // The generated code reads and writes registers.flags directly
+    lazyFlags = false;
+}
+
+RecompiledProcessorIntel8080::~RecompiledProcessorIntel8080()
+{
+    if (memoryManager)
+    {
+        UnloadRecompiledCode();
+        memoryManager->UnsubscribeStores(storeSubscription);
+    }
+}
+
+void RecompiledProcessorIntel8080::Setup(MemoryManagerPtr memoryManager, IOManagerPtr ioManager)
+{
+    UnloadRecompiledCode();
+    if (this->memoryManager)
+        this->memoryManager->UnsubscribeStores(storeSubscription);
+    FastProcessorIntel8080::Setup(memoryManager, ioManager);
+    pageBlocks.clear();
+    if (memoryManager)
+    {
+        pageBlocks.resize(MemoryManager::AddressSpaceSize / memoryManager->PageSize());
+        storeSubscription = memoryManager->SubscribeStores([this](size_t address) { OnStore(address); });
+    }
+}
+
+size_t RecompiledProcessorIntel8080::LoadRecompiledCode(RecompiledCodeIntel8080 const & code)
+{
+    if (memoryManager == nullptr)
+        throw std::runtime_error("Setup() not called, no MemoryManager available");
+    size_t pageSize = memoryManager->PageSize();
+    size_t count = 0;
+    for (size_t index = 0; index < code.blockCount; ++index)
+    {
+        RecompiledBlockIntel8080 const & block = code.blocks[index];
+        size_t offset = size_t(block.address - code.origin);
+        std::vector<uint8_t> contents;
+        try
+        {
+            contents = memoryManager->Fetch(block.address, block.size);
+        }
+        catch (std::exception &)
+        {
+            continue;
+        }
+        if (!std::equal(contents.begin(), contents.end(), code.image + offset))
+            continue;
+        blocks[block.address] = &block;
+        for (size_t pageIndex = block.address / pageSize; pageIndex <= (block.address + block.size - 1u) / pageSize; ++pageIndex)
+        {
+            if (pageBlocks[pageIndex].empty())
+                memoryManager->WatchStores(pageIndex * pageSize, true);
+            pageBlocks[pageIndex].push_back(block.address);
+        }
+        ++count;
+    }
+    return count;
+}
+
+void RecompiledProcessorIntel8080::UnloadRecompiledCode()
+{
+    for (size_t pageIndex = 0; pageIndex < pageBlocks.size(); ++pageIndex)
+    {
+        if (!pageBlocks[pageIndex].empty())
+            memoryManager->WatchStores(pageIndex * memoryManager->PageSize(), false);
+        pageBlocks[pageIndex].clear();
+    }
+    std::fill(blocks.begin(), blocks.end(), nullptr);
+    codeModified = true;
+}
+
+size_t RecompiledProcessorIntel8080::RecompiledBlockCount() const
+{
+    return size_t(std::count_if(blocks.begin(), blocks.end(), [](RecompiledBlockIntel8080 const * block) { return block != nullptr; }));
+}
+
+void RecompiledProcessorIntel8080::OnStore(size_t address)
+{
+    size_t pageSize = memoryManager->PageSize();
+    size_t pageIndex = address / pageSize;
+    if (pageIndex >= pageBlocks.size())
+        return;
+    std::vector<MemoryAddressType> & addresses = pageBlocks[pageIndex];
+    for (auto blockAddress : std::vector<MemoryAddressType>(addresses))
+    {
+        RecompiledBlockIntel8080 const * block = blocks[blockAddress];
+        if ((block == nullptr) || (address < blockAddress) || (address >= size_t(blockAddress + block->size)))
+            continue;
+        for (size_t index = blockAddress / pageSize; index <= (blockAddress + block->size - 1u) / pageSize; ++index)
+        {
+            std::vector<MemoryAddressType> & pageAddresses = pageBlocks[index];
+            pageAddresses.erase(std::remove(pageAddresses.begin(), pageAddresses.end(), blockAddress), pageAddresses.end());
+            if (pageAddresses.empty())
+                memoryManager->WatchStores(index * pageSize, false);
+        }
+        blocks[blockAddress] = nullptr;
+        ++statistics.invalidations;
+        codeModified = true;
+    }
+}
+
+void RecompiledProcessorIntel8080::Run()
+{
+    RunBlocks([this](size_t) { return Step(); });
+}
+
+size_t RecompiledProcessorIntel8080::Run(size_t budget)
+{
+    return RunBlocks(budget, [this](size_t) { return Step(); });
+}
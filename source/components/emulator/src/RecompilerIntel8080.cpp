@@ -0,0 +1,468 @@
+#include "emulator/RecompilerIntel8080.h"
+
+#include <algorithm>
+#include <cctype>
+#include <iomanip>
+#include <sstream>
+
+using namespace Emulator;
+
+static const char * const Registers8[] =
+{
+    "r.bc.B.h", "r.bc.B.l", "r.de.B.h", "r.de.B.l", "r.hl.B.h", "r.hl.B.l", "m.Fetch8(r.hl.W)", "r.a",
+};
+static const size_t OperandM = 6;
+static const char * const Registers16[] = { "r.bc.W", "r.de.W", "r.hl.W", "r.sp.W" };
+static const char * const Operations[] = { "Add", "AddC", "Sub", "SubC", "And", "Xor", "Or", "Cmp" };
+static const char * const Conditions[] =
+{
+    "(r.flags & FlagsIntel8080::Zero) == FlagsIntel8080::None",
+    "(r.flags & FlagsIntel8080::Zero) != FlagsIntel8080::None",
+    "(r.flags & FlagsIntel8080::Carry) == FlagsIntel8080::None",
+    "(r.flags & FlagsIntel8080::Carry) != FlagsIntel8080::None",
+    "(r.flags & FlagsIntel8080::Parity) == FlagsIntel8080::None",
+    "(r.flags & FlagsIntel8080::Parity) != FlagsIntel8080::None",
+    "(r.flags & FlagsIntel8080::Sign) == FlagsIntel8080::None",
+    "(r.flags & FlagsIntel8080::Sign) != FlagsIntel8080::None",
+};
+
+static std::string Hex(size_t value, int digits)
+{
+    std::ostringstream stream;
+    stream << "0x" << std::hex << std::uppercase << std::setfill('0') << std::setw(digits) << value;
+    return stream.str();
+}
+
+static std::string Alu(uint8_t operation, std::string const & operand)
+{
+    if (operation == 7)
+        return std::string("P::Cmp(r.a, ") + operand + ", r.flags);";
+    return std::string("r.a = P::") + Operations[operation] + "(r.a, " + operand + ", r.flags);";
+}
+
+static bool IsJump(uint8_t opcode)
+{
+    return (opcode == 0xC3) || ((opcode & 0xC7) == 0xC2);
+}
+
+static bool IsCall(uint8_t opcode)
+{
+    return (opcode == 0xCD) || ((opcode & 0xC7) == 0xC4);
+}
+
+static bool IsRestart(uint8_t opcode)
+{
+    return (opcode & 0xC7) == 0xC7;
+}
+
+// Instruction can continue with the next one
+static bool FallsThrough(uint8_t opcode)
+{
+    return !((opcode == 0xC3) || (opcode == 0xC9) || (opcode == 0xE9) || (opcode == 0x76));
+}
+
+RecompilerIntel8080::RecompilerIntel8080(Assembler::ObjectCode const & objectCode)
+    : image()
+    , origin()
+    , entryPoints()
+    , blocks()
+    , discovered()
+{
+    if (!objectCode.HaveSegment(Assembler::SegmentID::ASEG))
+        throw std::runtime_error("Recompiler: object code has no ASEG segment");
+    Assembler::CodeSegment const & segment = objectCode.GetSegment(Assembler::SegmentID::ASEG);
+    image = segment.Data();
+    origin = segment.Offset();
+    entryPoints.insert(origin);
+}
+
+RecompilerIntel8080::RecompilerIntel8080(std::vector<uint8_t> const & image, uint16_t origin)
+    : image(image)
+    , origin(origin)
+    , entryPoints()
+    , blocks()
+    , discovered()
+{
+    entryPoints.insert(origin);
+}
+
+RecompilerIntel8080::~RecompilerIntel8080()
+{
+}
+
+void RecompilerIntel8080::AddEntryPoint(uint16_t address)
+{
+    entryPoints.insert(address);
+    discovered = false;
+}
+
+std::vector<uint16_t> RecompilerIntel8080::GetBlockAddresses()
+{
+    Discover();
+    std::vector<uint16_t> addresses;
+    for (auto const & block : blocks)
+        addresses.push_back(block.first);
+    return addresses;
+}
+
+RecompilerIntel8080::Block const & RecompilerIntel8080::GetBlock(uint16_t address)
+{
+    Discover();
+    auto it = blocks.find(address);
+    if (it == blocks.end())
+    {
+        std::ostringstream stream;
+        stream << "Recompiler: no block at " << std::hex << std::uppercase << std::setfill('0') << std::setw(4) << address;
+        throw std::runtime_error(stream.str());
+    }
+    return it->second;
+}
+
+bool RecompilerIntel8080::EndsBlock(OpcodesIntel8080 instruction)
+{
+    uint8_t opcode = uint8_t(instruction);
+    // Interrupts are only accepted between blocks, the instruction after EI has to be the first of a block
+    return !FallsThrough(opcode) || IsJump(opcode) || IsCall(opcode) || IsRestart(opcode) ||
+        ((opcode & 0xC7) == 0xC0) || (instruction == OpcodesIntel8080::EI);
+}
+
+void RecompilerIntel8080::Discover()
+{
+    if (discovered)
+        return;
+    // Recursive descent, collecting the addresses where blocks start
+    std::set<uint16_t> leaders;
+    std::set<uint16_t> visited;
+    std::vector<uint16_t> pending;
+    auto addLeader = [&](size_t address)
+    {
+        if (!InImage(address))
+            return;
+        leaders.insert(uint16_t(address));
+        pending.push_back(uint16_t(address));
+    };
+    for (auto address : entryPoints)
+        addLeader(address);
+    while (!pending.empty())
+    {
+        size_t address = pending.back();
+        pending.pop_back();
+        while (InImage(address) && (visited.find(uint16_t(address)) == visited.end()))
+        {
+            uint8_t opcode = Byte(address);
+            size_t size = ProcessorIntel8080::GetInstructionData(OpcodesIntel8080(opcode)).instructionSize;
+            if ((size == 0) || !InImage(address, size))
+                break;
+            visited.insert(uint16_t(address));
+            size_t next = address + size;
+            if (IsJump(opcode) || IsCall(opcode))
+                addLeader(Word(address + 1));
+            else if (IsRestart(opcode))
+                addLeader(opcode & 0x38);
+            if (!FallsThrough(opcode))
+                break;
+            if (EndsBlock(OpcodesIntel8080(opcode)))
+            {
+                addLeader(next);
+                break;
+            }
+            address = next;
+        }
+    }
+
+    blocks.clear();
+    for (auto leader : leaders)
+    {
+        Block block;
+        block.address = leader;
+        size_t address = leader;
+        while (InImage(address))
+        {
+            uint8_t opcode = Byte(address);
+            size_t size = ProcessorIntel8080::GetInstructionData(OpcodesIntel8080(opcode)).instructionSize;
+            if ((size == 0) || !InImage(address, size))
+                break;
+            block.instructions.push_back(uint16_t(address));
+            address += size;
+            if (EndsBlock(OpcodesIntel8080(opcode)) || (leaders.find(uint16_t(address)) != leaders.end()))
+                break;
+        }
+        // Invalid instructions are left to the interpreter to report
+        if (block.instructions.empty())
+            continue;
+        block.size = uint16_t(address - leader);
+        blocks[leader] = block;
+    }
+    discovered = true;
+}
+
+void RecompilerIntel8080::GenerateBlock(std::ostream & stream, Block const & block)
+{
+    std::ostringstream body;
+    size_t cycles = 0;
+    bool ended = false;
+    for (auto address : block.instructions)
+    {
+        uint8_t opcode = Byte(address);
+        InstructionDataIntel8080 const & instructionData = ProcessorIntel8080::GetInstructionData(OpcodesIntel8080(opcode));
+        std::string next = Hex((address + instructionData.instructionSize) & 0xFFFF, 4);
+        std::string byte = (instructionData.instructionSize > 1) ? Hex(Byte(address + 1), 2) : std::string();
+        std::string word = (instructionData.instructionSize > 2) ? Hex(Word(address + 1), 4) : std::string();
+        size_t taken = cycles + instructionData.machineStateCount;
+        size_t notTaken = cycles + instructionData.machineStateCountConditionFailed;
+        std::string condition = Conditions[(opcode >> 3) & 7];
+        uint8_t destination = (opcode >> 3) & 7;
+        uint8_t source = opcode & 7;
+        std::string pair = Registers16[(opcode >> 4) & 3];
+        std::ostringstream code;
+        bool stores = false;
+
+        std::string mnemonic = instructionData.instructionMnemonic;
+        if (!word.empty())
+            mnemonic += word.substr(2);
+        else if (!byte.empty())
+            mnemonic += byte.substr(2);
+        body << "    // " << Hex(address, 4).substr(2) << " " << mnemonic.substr(0, mnemonic.find_last_not_of(' ') + 1) << std::endl;
+        auto leave = [&](std::string const & pc, size_t cyclesTotal)
+        {
+            code << "r.pc = " << pc << "; r.instructionCycles = " << int(instructionData.machineStateCount) << "; return " << cyclesTotal << ";";
+        };
+        if (opcode == 0x76)
+        {
+            code << "r.isHalted = true; ";
+            leave(next, taken);
+            ended = true;
+        }
+        else if ((opcode & 0xC0) == 0x40)
+        {
+            if (destination == OperandM)
+            {
+                code << "m.Store8(r.hl.W, " << Registers8[source] << ");";
+                stores = true;
+            }
+            else
+                code << Registers8[destination] << " = " << Registers8[source] << ";";
+        }
+        else if ((opcode & 0xC0) == 0x80)
+            code << Alu(destination, Registers8[source]);
+        else if ((opcode & 0xC7) == 0xC6)
+            code << Alu(destination, byte);
+        else if ((opcode & 0xC0) == 0x00)
+        {
+            switch (opcode & 0x0F)
+            {
+            case 0x01: code << pair << " = " << word << ";"; break;
+            case 0x03: code << pair << "++;"; break;
+            case 0x09: code << "r.hl.W = P::AddW(r.hl.W, " << pair << ", r.flags);"; break;
+            case 0x0B: code << pair << "--;"; break;
+            default:
+                break;
+            }
+            switch (opcode & 0x07)
+            {
+            case 0x04:
+            case 0x05:
+                {
+                    std::string function = ((opcode & 0x07) == 0x04) ? "P::Inc(" : "P::Dec(";
+                    if (destination == OperandM)
+                    {
+                        code << "m.Store8(r.hl.W, " << function << "m.Fetch8(r.hl.W), r.flags));";
+                        stores = true;
+                    }
+                    else
+                        code << Registers8[destination] << " = " << function << Registers8[destination] << ", r.flags);";
+                }
+                break;
+            case 0x06:
+                if (destination == OperandM)
+                {
+                    code << "m.Store8(r.hl.W, " << byte << ");";
+                    stores = true;
+                }
+                else
+                    code << Registers8[destination] << " = " << byte << ";";
+                break;
+            default:
+                break;
+            }
+            switch (opcode)
+            {
+            case 0x02: code << "m.Store8(r.bc.W, r.a);"; stores = true; break;
+            case 0x12: code << "m.Store8(r.de.W, r.a);"; stores = true; break;
+            case 0x0A: code << "r.a = m.Fetch8(r.bc.W);"; break;
+            case 0x1A: code << "r.a = m.Fetch8(r.de.W);"; break;
+            case 0x22: code << "r.wz.W = " << word << "; m.Store16(r.wz.W, r.hl.W);"; stores = true; break;
+            case 0x2A: code << "r.wz.W = " << word << "; r.hl.W = m.Fetch16(r.wz.W);"; break;
+            case 0x32: code << "r.wz.W = " << word << "; m.Store8(r.wz.W, r.a);"; stores = true; break;
+            case 0x3A: code << "r.wz.W = " << word << "; r.a = m.Fetch8(r.wz.W);"; break;
+            case 0x07: code << "r.a = P::RLC(r.a, r.flags);"; break;
+            case 0x0F: code << "r.a = P::RRC(r.a, r.flags);"; break;
+            case 0x17: code << "r.a = P::RAL(r.a, r.flags);"; break;
+            case 0x1F: code << "r.a = P::RAR(r.a, r.flags);"; break;
+            case 0x27: code << "r.a = P::DAA(r.a, r.flags);"; break;
+            case 0x2F: code << "r.a ^= 0xFF;"; break;
+            case 0x37: code << "r.flags |= FlagsIntel8080::Carry;"; break;
+            case 0x3F: code << "r.flags ^= FlagsIntel8080::Carry;"; break;
+            default:
+                break;
+            }
+        }
+        else if ((opcode & 0xC7) == 0xC0)
+        {
+            code << "if (" << condition << ") { p.Pop(r.pc); r.instructionCycles = " << int(instructionData.machineStateCount) << "; return " << taken << "; }" << std::endl << "    ";
+            code << "r.pc = " << next << "; r.instructionCycles = " << int(instructionData.machineStateCountConditionFailed) << "; return " << notTaken << ";";
+            ended = true;
+        }
+        else if ((opcode & 0xC7) == 0xC2)
+        {
+            code << "if (" << condition << ") { r.pc = " << word << "; r.instructionCycles = " << int(instructionData.machineStateCount) << "; return " << taken << "; }" << std::endl << "    ";
+            code << "r.pc = " << next << "; r.instructionCycles = " << int(instructionData.machineStateCountConditionFailed) << "; return " << notTaken << ";";
+            ended = true;
+        }
+        else if ((opcode & 0xC7) == 0xC4)
+        {
+            code << "if (" << condition << ") { r.wz.W = " << word << "; p.Push(" << next << "); r.pc = r.wz.W; r.instructionCycles = "
+                 << int(instructionData.machineStateCount) << "; return " << taken << "; }" << std::endl << "    ";
+            code << "r.pc = " << next << "; r.instructionCycles = " << int(instructionData.machineStateCountConditionFailed) << "; return " << notTaken << ";";
+            ended = true;
+        }
+        else if (IsRestart(opcode))
+        {
+            code << "p.Push(" << next << "); ";
+            leave(Hex(opcode & 0x38, 4), taken);
+            ended = true;
+        }
+        else
+        {
+            switch (opcode)
+            {
+            case 0xC1: case 0xD1: case 0xE1:
+                code << "p.Pop(" << pair << ");";
+                break;
+            case 0xF1:
+                code << "p.Pop(r.wz.W); r.a = r.wz.B.h; r.flags = FlagsIntel8080(r.wz.B.l);";
+                break;
+            case 0xC5: case 0xD5: case 0xE5:
+                code << "p.Push(" << pair << ");";
+                stores = true;
+                break;
+            case 0xF5:
+                code << "p.Push(uint16_t(r.a << 8 | ((uint8_t(r.flags) & 0xD7) | 0x02)));";
+                stores = true;
+                break;
+            case 0xC3:
+                leave(word, taken);
+                ended = true;
+                break;
+            case 0xC9:
+                code << "p.Pop(r.pc); r.instructionCycles = " << int(instructionData.machineStateCount) << "; return " << taken << ";";
+                ended = true;
+                break;
+            case 0xCD:
+                code << "r.wz.W = " << word << "; p.Push(" << next << "); ";
+                leave("r.wz.W", taken);
+                ended = true;
+                break;
+            case 0xE9:
+                leave("r.hl.W", taken);
+                ended = true;
+                break;
+            case 0xD3: code << "p.IO().Out8(" << byte << ", r.a);"; break;
+            case 0xDB: code << "r.a = p.IO().In8(" << byte << ");"; break;
+            case 0xE3:
+                code << "r.wz.W = m.Fetch16(r.sp.W); m.Store16(r.sp.W, r.hl.W); r.hl.W = r.wz.W;";
+                stores = true;
+                break;
+            case 0xEB: code << "std::swap(r.de.W, r.hl.W);"; break;
+            case 0xF3: code << "r.ie = false;"; break;
+            case 0xFB: code << "r.ie = true;"; break;
+            case 0xF9: code << "r.sp.W = r.hl.W;"; break;
+            default:
+                break;
+            }
+        }
+        cycles = taken;
+        if (!code.str().empty())
+            body << "    " << code.str() << std::endl;
+        if (ended)
+            break;
+        // The rest of the block may have been overwritten
+        if (stores && (address != block.instructions.back()))
+        {
+            body << "    if (p.CodeModified()) { r.pc = " << next << "; r.instructionCycles = " << int(instructionData.machineStateCount)
+                   << "; return " << cycles << "; }" << std::endl;
+        }
+        if (address == block.instructions.back())
+        {
+            body << "    r.pc = " << next << "; r.instructionCycles = " << int(instructionData.machineStateCount)
+                   << "; return " << cycles << ";" << std::endl;
+        }
+    }
+    stream << "size_t Block_" << Hex(block.address, 4).substr(2) << "(P & p)" << std::endl
+           << "{" << std::endl
+           << "    RegistersIntel8080 & r = p.Registers();" << std::endl;
+    if ((body.str().find("m.Fetch") != std::string::npos) || (body.str().find("m.Store") != std::string::npos))
+        stream << "    MemoryManager & m = p.Memory();" << std::endl;
+    stream << body.str();
+    stream << "}" << std::endl << std::endl;
+}
+
+void RecompilerIntel8080::Generate(std::ostream & stream, std::string const & name)
+{
+    if (name.empty() || std::isdigit(static_cast<unsigned char>(name[0])) ||
+        (std::find_if(name.begin(), name.end(), [](char c) { return !std::isalnum(static_cast<unsigned char>(c)) && (c != '_'); }) != name.end()))
+    {
+        throw std::runtime_error("Recompiler: invalid name " + name);
+    }
+    Discover();
+    if (blocks.empty())
+        throw std::runtime_error("Recompiler: no code found at the entry points");
+    stream << "// Generated by RecompilerIntel8080, do not edit" << std::endl
+           << "#include \"emulator/RecompiledProcessorIntel8080.h\"" << std::endl
+           << std::endl
+           << "#include <utility>" << std::endl
+           << std::endl
+           << "using namespace Emulator;" << std::endl
+           << "using P = RecompiledProcessorIntel8080;" << std::endl
+           << std::endl
+           << "namespace" << std::endl
+           << "{" << std::endl
+           << std::endl;
+    for (auto const & block : blocks)
+        GenerateBlock(stream, block.second);
+
+    stream << "const uint8_t Image[] =" << std::endl << "{";
+    for (size_t index = 0; index < image.size(); ++index)
+    {
+        stream << (((index % 16) == 0) ? "\n    " : " ") << Hex(image[index], 2) << ",";
+    }
+    stream << std::endl << "};" << std::endl << std::endl;
+
+    stream << "const RecompiledBlockIntel8080 Blocks[] =" << std::endl << "{" << std::endl;
+    for (auto const & block : blocks)
+    {
+        std::string address = Hex(block.first, 4);
+        stream << "    { " << address << ", " << block.second.size << ", OpcodesIntel8080(" << Hex(Byte(block.second.instructions.back()), 2)
+               << "), &Block_" << address.substr(2) << " }," << std::endl;
+    }
+    stream << "};" << std::endl
+           << std::endl
+           << "} // namespace" << std::endl
+           << std::endl
+           << "namespace Emulator" << std::endl
+           << "{" << std::endl
+           << std::endl
+           << "namespace Recompiled" << std::endl
+           << "{" << std::endl
+           << std::endl
+           << "RecompiledCodeIntel8080 const & " << name << "()" << std::endl
+           << "{" << std::endl
+           << "    static const RecompiledCodeIntel8080 code = { \"" << name << "\", " << Hex(origin, 4)
+           << ", Image, sizeof(Image), Blocks, sizeof(Blocks) / sizeof(Blocks[0]) };" << std::endl
+           << "    return code;" << std::endl
+           << "}" << std::endl
+           << std::endl
+           << "} // namespace Recompiled" << std::endl
+           << std::endl
+           << "} // namespace Emulator" << std::endl;
+}
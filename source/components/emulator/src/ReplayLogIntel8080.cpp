@@ -0,0 +1,303 @@
+#include "emulator/ReplayLogIntel8080.h"
+
+#include <sstream>
+
+using namespace Emulator;
+
+static void WriteValue(std::ostream & stream, uint64_t value, size_t size)
+{
+    uint8_t bytes[sizeof(uint64_t)];
+    for (size_t index = 0; index < size; ++index)
+    {
+        bytes[index] = uint8_t(value >> (8 * index));
+    }
+    stream.write(reinterpret_cast<char const *>(bytes), std::streamsize(size));
+}
+
+static uint64_t ReadValue(std::istream & stream, size_t size)
+{
+    uint8_t bytes[sizeof(uint64_t)];
+    if (!stream.read(reinterpret_cast<char *>(bytes), std::streamsize(size)))
+        throw std::runtime_error("Replay log: unexpected end of data");
+    uint64_t value = 0;
+    for (size_t index = 0; index < size; ++index)
+    {
+        value |= uint64_t(bytes[index]) << (8 * index);
+    }
+    return value;
+}
+
+// 7 bits per byte, low bits first, the top bit set on all but the last byte
+static void WriteNumber(std::ostream & stream, uint64_t value)
+{
+    while (value >= 0x80)
+    {
+        stream.put(char(uint8_t(value | 0x80)));
+        value >>= 7;
+    }
+    stream.put(char(uint8_t(value)));
+}
+
+static uint64_t ReadNumber(std::istream & stream)
+{
+    uint64_t value = 0;
+    for (size_t shift = 0; shift < 64; shift += 7)
+    {
+        uint8_t byte = uint8_t(ReadValue(stream, 1));
+        value |= uint64_t(byte & 0x7F) << shift;
+        if ((byte & 0x80) == 0)
+            return value;
+    }
+    throw std::runtime_error("Replay log: invalid number");
+}
+
+ReplayLogIntel8080::ReplayLogIntel8080()
+    : mode(ReplayModeIntel8080::Idle)
+    , processor()
+    , entries()
+    , checkpoints()
+    , checkpointInterval()
+    , position()
+    , event()
+    , eventScheduled()
+{
+}
+
+ReplayLogIntel8080::~ReplayLogIntel8080()
+{
+    Stop();
+}
+
+void ReplayLogIntel8080::StartRecording(ProcessorIntel8080 & processor, uint64_t checkpointInterval)
+{
+    Stop();
+    entries.clear();
+    checkpoints.clear();
+    this->checkpointInterval = checkpointInterval;
+    position = 0;
+    if (checkpointInterval != 0)
+    {
+        MemoryManagerPtr memoryManager = processor.GetMemoryManager();
+        memoryManager->TrackDirtyPages(true);
+        ReplayCheckpointIntel8080 checkpoint;
+        checkpoint.entry = 0;
+        checkpoint.snapshot = SnapshotIntel8080::Take(processor);
+        memoryManager->ClearDirtyPages();
+        checkpoints.push_back(checkpoint);
+    }
+    Attach(processor, ReplayModeIntel8080::Recording);
+    if (checkpointInterval != 0)
+        ScheduleCheckpoint(processor.Now() + checkpointInterval);
+}
+
+void ReplayLogIntel8080::StartReplay(ProcessorIntel8080 & processor)
+{
+    Stop();
+    if (!checkpoints.empty())
+        checkpoints[0].snapshot.Restore(processor);
+    position = 0;
+    Attach(processor, ReplayModeIntel8080::Replaying);
+    ScheduleInterrupt();
+}
+
+void ReplayLogIntel8080::Stop()
+{
+    if (processor == nullptr)
+        return;
+    CancelEvent();
+    processor->SetReplayLog(nullptr);
+    processor = nullptr;
+    mode = ReplayModeIntel8080::Idle;
+}
+
+void ReplayLogIntel8080::Seek(uint64_t cycles)
+{
+    if (!IsReplaying())
+        throw std::runtime_error("Replay log: seek requires replay mode");
+    // Run on from the current state if no checkpoint is closer to the target
+    size_t index = checkpoints.size();
+    while ((index > 0) && (checkpoints[index - 1].snapshot.GetRegisters().cycleCountTotal > cycles))
+        --index;
+    uint64_t now = processor->Now();
+    if ((index > 0) && ((now > cycles) || (checkpoints[index - 1].snapshot.GetRegisters().cycleCountTotal > now)))
+    {
+        CancelEvent();
+        checkpoints[index - 1].snapshot.Restore(*processor);
+        position = checkpoints[index - 1].entry;
+        ScheduleInterrupt();
+    }
+    else if (now > cycles)
+    {
+        std::ostringstream message;
+        message << "Replay log: no checkpoint at or before cycle " << cycles;
+        throw std::runtime_error(message.str());
+    }
+    while (processor->Now() < cycles)
+    {
+        if (processor->Run(size_t(cycles - processor->Now())) == 0)
+            break;
+    }
+}
+
+uint8_t ReplayLogIntel8080::In(uint8_t port)
+{
+    if (mode == ReplayModeIntel8080::Recording)
+    {
+        ReplayEntryIntel8080 entry;
+        entry.cycles = processor->Now();
+        entry.event = ReplayEventIntel8080::In;
+        entry.address = port;
+        entry.data = processor->GetIOManager()->In8(port);
+        entries.push_back(entry);
+        return entry.data;
+    }
+    if ((position >= entries.size()) || (entries[position].event != ReplayEventIntel8080::In) ||
+        (entries[position].cycles != processor->Now()) || (entries[position].address != port))
+    {
+        std::ostringstream message;
+        message << "Replay log: diverged at cycle " << processor->Now() << ", IN " << std::hex << int(port)
+                << std::dec << " not recorded at entry " << position;
+        throw std::runtime_error(message.str());
+    }
+    return entries[position++].data;
+}
+
+void ReplayLogIntel8080::RecordInterrupt(uint16_t address)
+{
+    ReplayEntryIntel8080 entry;
+    entry.cycles = processor->Now();
+    entry.event = ReplayEventIntel8080::Interrupt;
+    entry.address = address;
+    entry.data = 0;
+    entries.push_back(entry);
+}
+
+void ReplayLogIntel8080::Attach(ProcessorIntel8080 & processor, ReplayModeIntel8080 mode)
+{
+    this->processor = &processor;
+    this->mode = mode;
+    processor.SetReplayLog(this);
+}
+
+void ReplayLogIntel8080::CancelEvent()
+{
+    if (eventScheduled)
+        processor->GetScheduler().Cancel(event);
+    eventScheduled = false;
+}
+
+void ReplayLogIntel8080::ScheduleCheckpoint(uint64_t deadline)
+{
+    event = processor->GetScheduler().Schedule(deadline, [this](uint64_t time)
+    {
+        ReplayCheckpointIntel8080 checkpoint;
+        checkpoint.entry = entries.size();
+        checkpoint.snapshot = SnapshotIntel8080::TakeIncremental(*processor, checkpoints.back().snapshot);
+        checkpoints.push_back(checkpoint);
+        ScheduleCheckpoint(time + checkpointInterval);
+    });
+    eventScheduled = true;
+}
+
+// Interrupts are events at the cycle they were delivered at, IN entries in between are consumed by In()
+void ReplayLogIntel8080::ScheduleInterrupt()
+{
+    eventScheduled = false;
+    size_t index = position;
+    while ((index < entries.size()) && (entries[index].event != ReplayEventIntel8080::Interrupt))
+        ++index;
+    if (index >= entries.size())
+        return;
+    event = processor->GetScheduler().Schedule(entries[index].cycles, [this](uint64_t)
+    {
+        DeliverInterrupt();
+    });
+    eventScheduled = true;
+}
+
+void ReplayLogIntel8080::DeliverInterrupt()
+{
+    if ((position >= entries.size()) || (entries[position].event != ReplayEventIntel8080::Interrupt) ||
+        (entries[position].cycles != processor->Now()))
+    {
+        std::ostringstream message;
+        message << "Replay log: diverged at cycle " << processor->Now() << ", interrupt not reached at entry " << position;
+        throw std::runtime_error(message.str());
+    }
+    processor->DeliverInterrupt(entries[position++].address);
+    ScheduleInterrupt();
+}
+
+void ReplayLogIntel8080::Save(std::ostream & stream) const
+{
+    WriteValue(stream, Magic, 4);
+    WriteValue(stream, Version, 2);
+    WriteNumber(stream, checkpointInterval);
+    WriteNumber(stream, entries.size());
+    uint64_t cycles = 0;
+    for (auto const & entry : entries)
+    {
+        // The event type is the lowest bit of the delta
+        WriteNumber(stream, ((entry.cycles - cycles) << 1) | uint8_t(entry.event));
+        cycles = entry.cycles;
+        if (entry.event == ReplayEventIntel8080::In)
+        {
+            WriteValue(stream, entry.address, 1);
+            WriteValue(stream, entry.data, 1);
+        }
+        else
+            WriteValue(stream, entry.address, 2);
+    }
+    WriteNumber(stream, checkpoints.size());
+    for (auto const & checkpoint : checkpoints)
+    {
+        WriteNumber(stream, checkpoint.entry);
+        checkpoint.snapshot.Save(stream);
+    }
+}
+
+ReplayLogIntel8080 ReplayLogIntel8080::Load(std::istream & stream)
+{
+    ReplayLogIntel8080 log;
+    uint32_t magic = uint32_t(ReadValue(stream, 4));
+    uint16_t version = uint16_t(ReadValue(stream, 2));
+    if ((magic != Magic) || (version != Version))
+    {
+        std::ostringstream message;
+        message << "Replay log: invalid header " << std::hex << magic << " version " << std::dec << version;
+        throw std::runtime_error(message.str());
+    }
+    log.checkpointInterval = ReadNumber(stream);
+    size_t entryCount = size_t(ReadNumber(stream));
+    uint64_t cycles = 0;
+    for (size_t index = 0; index < entryCount; ++index)
+    {
+        uint64_t value = ReadNumber(stream);
+        ReplayEntryIntel8080 entry;
+        cycles += value >> 1;
+        entry.cycles = cycles;
+        entry.event = ReplayEventIntel8080(value & 1);
+        if (entry.event == ReplayEventIntel8080::In)
+        {
+            entry.address = uint16_t(ReadValue(stream, 1));
+            entry.data = uint8_t(ReadValue(stream, 1));
+        }
+        else
+        {
+            entry.address = uint16_t(ReadValue(stream, 2));
+            entry.data = 0;
+        }
+        log.entries.push_back(entry);
+    }
+    size_t checkpointCount = size_t(ReadNumber(stream));
+    for (size_t index = 0; index < checkpointCount; ++index)
+    {
+        ReplayCheckpointIntel8080 checkpoint;
+        checkpoint.entry = size_t(ReadNumber(stream));
+        if (checkpoint.entry > entryCount)
+            throw std::runtime_error("Replay log: invalid checkpoint");
+        checkpoint.snapshot = SnapshotIntel8080::Load(stream);
+        log.checkpoints.push_back(checkpoint);
+    }
+    return log;
+}
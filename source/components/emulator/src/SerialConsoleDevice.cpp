@@ -0,0 +1,58 @@
+#include "emulator/SerialConsoleDevice.h"
+
+#include <algorithm>
+
+using namespace Emulator;
+
+SerialConsoleDevice::SerialConsoleDevice(size_t base)
+    : IODevice(base, 2)
+    , input()
+    , output()
+    , outputStream()
+{
+}
+
+SerialConsoleDevice::~SerialConsoleDevice()
+{
+}
+
+void SerialConsoleDevice::Receive(std::string const & text)
+{
+    input.insert(input.end(), text.begin(), text.end());
+}
+
+void SerialConsoleDevice::Receive(uint8_t const * data, size_t size)
+{
+    input.insert(input.end(), data, data + size);
+}
+
+void SerialConsoleDevice::Transmit(uint8_t const * data, size_t size)
+{
+    output.insert(output.end(), data, data + size);
+    if (outputStream)
+        outputStream->write(reinterpret_cast<char const *>(data), std::streamsize(size));
+}
+
+// Reading an empty receiver returns 0, as the single byte path does
+void SerialConsoleDevice::InRepeated(size_t address, uint8_t * data, size_t count)
+{
+    if (address != base + DataPort)
+    {
+        IODevice::InRepeated(address, data, count);
+        return;
+    }
+    size_t available = std::min(count, input.size());
+    std::copy(input.begin(), input.begin() + available, data);
+    input.erase(input.begin(), input.begin() + available);
+    std::fill(data + available, data + count, uint8_t{ 0 });
+}
+
+void SerialConsoleDevice::OutRepeated(size_t address, uint8_t const * data, size_t count)
+{
+    if (address != base + DataPort)
+    {
+        IODevice::OutRepeated(address, data, count);
+        return;
+    }
+    Transmit(data, count);
+}
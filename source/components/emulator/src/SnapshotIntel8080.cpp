@@ -0,0 +1,372 @@
+#include "emulator/SnapshotIntel8080.h"
+
+#include <algorithm>
+#include <sstream>
+#include "emulator/IOPort.h"
+#include "emulator/ProcessorIntel8085.h"
+#include "emulator/RAM.h"
+
+using namespace Emulator;
+
+static void WriteValue(std::ostream & stream, uint64_t value, size_t size)
+{
+    uint8_t bytes[sizeof(uint64_t)];
+    for (size_t index = 0; index < size; ++index)
+    {
+        bytes[index] = uint8_t(value >> (8 * index));
+    }
+    stream.write(reinterpret_cast<char const *>(bytes), std::streamsize(size));
+}
+
+static uint64_t ReadValue(std::istream & stream, size_t size)
+{
+    uint8_t bytes[sizeof(uint64_t)];
+    if (!stream.read(reinterpret_cast<char *>(bytes), std::streamsize(size)))
+        throw std::runtime_error("Snapshot: unexpected end of data");
+    uint64_t value = 0;
+    for (size_t index = 0; index < size; ++index)
+    {
+        value |= uint64_t(bytes[index]) << (8 * index);
+    }
+    return value;
+}
+
+static size_t PageEnd(size_t address, size_t end, size_t pageSize)
+{
+    return std::min((address / pageSize + 1) * pageSize, end);
+}
+
+// Read a block page by page, sharing the pages which did not change with the same block in base.
+// Pages for which dirty() returns false are shared without reading them.
+template<class Read, class Dirty>
+static SnapshotBlock TakeBlock(size_t offset, size_t size, size_t pageSize, SnapshotBlock const * base, Read read, Dirty dirty)
+{
+    SnapshotBlock block;
+    block.offset = offset;
+    block.size = size;
+    if (base && ((base->offset != offset) || (base->size != size)))
+        base = nullptr;
+    SnapshotPage contents;
+    size_t end = offset + size;
+    for (size_t address = offset; address < end; address = PageEnd(address, end, pageSize))
+    {
+        SnapshotPagePtr const * basePage = base ? &base->pages[block.pages.size()] : nullptr;
+        if (basePage && !dirty(address))
+        {
+            block.pages.push_back(*basePage);
+            continue;
+        }
+        contents.resize(PageEnd(address, end, pageSize) - address);
+        read(address, contents.data(), contents.size());
+        if (basePage && (**basePage == contents))
+            block.pages.push_back(*basePage);
+        else
+            block.pages.push_back(std::make_shared<SnapshotPage const>(contents));
+    }
+    return block;
+}
+
+// Write back only the pages which differ from the current contents
+template<class Read, class Write>
+static void RestoreBlock(SnapshotBlock const & block, Read read, Write write)
+{
+    SnapshotPage contents;
+    size_t address = block.offset;
+    for (auto const & page : block.pages)
+    {
+        contents.resize(page->size());
+        read(address, contents.data(), contents.size());
+        if (contents != *page)
+            write(address, page->data(), page->size());
+        address += page->size();
+    }
+}
+
+static void SaveBlocks(std::ostream & stream, SnapshotBlockVector const & blocks)
+{
+    WriteValue(stream, blocks.size(), 2);
+    for (auto const & block : blocks)
+    {
+        WriteValue(stream, block.offset, 4);
+        WriteValue(stream, block.size, 4);
+        for (auto const & page : block.pages)
+        {
+            stream.write(reinterpret_cast<char const *>(page->data()), std::streamsize(page->size()));
+        }
+    }
+}
+
+static SnapshotBlockVector LoadBlocks(std::istream & stream, size_t pageSize)
+{
+    SnapshotBlockVector blocks(size_t(ReadValue(stream, 2)));
+    for (auto & block : blocks)
+    {
+        block.offset = size_t(ReadValue(stream, 4));
+        block.size = size_t(ReadValue(stream, 4));
+        size_t end = block.offset + block.size;
+        for (size_t address = block.offset; address < end; address = PageEnd(address, end, pageSize))
+        {
+            std::shared_ptr<SnapshotPage> page = std::make_shared<SnapshotPage>(PageEnd(address, end, pageSize) - address);
+            if (!stream.read(reinterpret_cast<char *>(page->data()), std::streamsize(page->size())))
+                throw std::runtime_error("Snapshot: unexpected end of data");
+            block.pages.push_back(page);
+        }
+    }
+    return blocks;
+}
+
+SnapshotIntel8080::SnapshotIntel8080()
+    : pageSize(size_t{ 1 } << MemoryManager::DefaultPageSizeBits)
+    , registers()
+    , interrupts()
+    , memoryBlocks()
+    , ioBlocks()
+{
+}
+
+SnapshotIntel8080::~SnapshotIntel8080()
+{
+}
+
+SnapshotIntel8080 SnapshotIntel8080::Take(ProcessorIntel8080 & processor, SnapshotIntel8080 const * base)
+{
+    return TakeSnapshot(processor, base, false);
+}
+
+SnapshotIntel8080 SnapshotIntel8080::TakeIncremental(ProcessorIntel8080 & processor, SnapshotIntel8080 const & previous)
+{
+    MemoryManagerPtr memoryManager = processor.GetMemoryManager();
+    if (!memoryManager || !memoryManager->IsTrackingDirtyPages())
+        throw std::runtime_error("Snapshot: incremental snapshot requires dirty page tracking");
+    SnapshotIntel8080 snapshot = TakeSnapshot(processor, &previous, true);
+    memoryManager->ClearDirtyPages();
+    return snapshot;
+}
+
+SnapshotIntel8080 SnapshotIntel8080::TakeSnapshot(ProcessorIntel8080 & processor, SnapshotIntel8080 const * base, bool useDirtyPages)
+{
+    MemoryManagerPtr memoryManager = processor.GetMemoryManager();
+    IOManagerPtr ioManager = processor.GetIOManager();
+    if (!memoryManager || !ioManager)
+        throw std::runtime_error("Snapshot: processor has no memory or IO set up");
+    SnapshotIntel8080 snapshot;
+    snapshot.pageSize = memoryManager->PageSize();
+    snapshot.registers = processor.GetRegisters();
+    InterruptControllerIntel8080 & interruptController = processor.GetInterruptController();
+    snapshot.interrupts.pending = interruptController.GetPending();
+    snapshot.interrupts.mask = interruptController.GetMask();
+    ProcessorIntel8085 const * processor8085 = dynamic_cast<ProcessorIntel8085 const *>(&processor);
+    if (processor8085)
+    {
+        snapshot.interrupts.is8085 = true;
+        snapshot.interrupts.interruptMasks = processor8085->interruptMasks;
+        snapshot.interrupts.serialInput = processor8085->serialInput;
+        snapshot.interrupts.serialOutput = processor8085->serialOutput;
+    }
+    if (base && (base->pageSize != snapshot.pageSize))
+        base = nullptr;
+
+    auto fetch = [&memoryManager](size_t address, uint8_t * data, size_t size) { memoryManager->Fetch(address, data, size); };
+    auto dirty = [&memoryManager, useDirtyPages](size_t address) { return !useDirtyPages || memoryManager->IsDirty(address); };
+    auto always = [](size_t) { return true; };
+    for (auto const & memory : memoryManager->GetMemoryBlocks())
+    {
+        if (!std::dynamic_pointer_cast<RAM>(memory))
+            continue;
+        size_t index = snapshot.memoryBlocks.size();
+        SnapshotBlock const * baseBlock = (base && (index < base->memoryBlocks.size())) ? &base->memoryBlocks[index] : nullptr;
+        snapshot.memoryBlocks.push_back(TakeBlock(memory->Offset(), memory->Size(), snapshot.pageSize, baseBlock, fetch, dirty));
+    }
+    for (auto const & io : ioManager->GetIOPorts())
+    {
+        if (!std::dynamic_pointer_cast<IOPort>(io))
+            continue;
+        size_t index = snapshot.ioBlocks.size();
+        SnapshotBlock const * baseBlock = (base && (index < base->ioBlocks.size())) ? &base->ioBlocks[index] : nullptr;
+        auto in = [&io](size_t address, uint8_t * data, size_t size) { io->In(address, data, size); };
+        snapshot.ioBlocks.push_back(TakeBlock(io->Offset(), io->Size(), snapshot.pageSize, baseBlock, in, always));
+    }
+    return snapshot;
+}
+
+void SnapshotIntel8080::Restore(ProcessorIntel8080 & processor) const
+{
+    MemoryManagerPtr memoryManager = processor.GetMemoryManager();
+    IOManagerPtr ioManager = processor.GetIOManager();
+    if (!memoryManager || !ioManager)
+        throw std::runtime_error("Snapshot: processor has no memory or IO set up");
+
+    std::vector<IMemoryPtr> ramBlocks;
+    for (auto const & memory : memoryManager->GetMemoryBlocks())
+    {
+        if (std::dynamic_pointer_cast<RAM>(memory))
+            ramBlocks.push_back(memory);
+    }
+    IOVector ioPorts;
+    for (auto const & io : ioManager->GetIOPorts())
+    {
+        if (std::dynamic_pointer_cast<IOPort>(io))
+            ioPorts.push_back(io);
+    }
+    bool layoutMatches = (ramBlocks.size() == memoryBlocks.size()) && (ioPorts.size() == ioBlocks.size());
+    for (size_t index = 0; layoutMatches && (index < ramBlocks.size()); ++index)
+    {
+        layoutMatches = (ramBlocks[index]->Offset() == memoryBlocks[index].offset) && (ramBlocks[index]->Size() == memoryBlocks[index].size);
+    }
+    for (size_t index = 0; layoutMatches && (index < ioPorts.size()); ++index)
+    {
+        layoutMatches = (ioPorts[index]->Offset() == ioBlocks[index].offset) && (ioPorts[index]->Size() == ioBlocks[index].size);
+    }
+    if (!layoutMatches)
+        throw std::runtime_error("Snapshot: memory or IO layout of processor does not match snapshot");
+    ProcessorIntel8085 * processor8085 = dynamic_cast<ProcessorIntel8085 *>(&processor);
+    if ((processor8085 != nullptr) != interrupts.is8085)
+        throw std::runtime_error("Snapshot: processor type does not match snapshot");
+
+    auto fetch = [&memoryManager](size_t address, uint8_t * data, size_t size) { memoryManager->Fetch(address, data, size); };
+    auto store = [&memoryManager](size_t address, uint8_t const * data, size_t size) { memoryManager->Store(address, data, size); };
+    for (auto const & block : memoryBlocks)
+    {
+        RestoreBlock(block, fetch, store);
+    }
+    for (size_t index = 0; index < ioBlocks.size(); ++index)
+    {
+        IIOPtr io = ioPorts[index];
+        auto in = [&io](size_t address, uint8_t * data, size_t size) { io->In(address, data, size); };
+        auto out = [&io](size_t address, uint8_t const * data, size_t size) { io->Out(address, data, size); };
+        RestoreBlock(ioBlocks[index], in, out);
+    }
+
+    // Keep the debug settings of the processor restored into
+    RegistersIntel8080 & target = processor.GetRegisters();
+    Reg16 trap = target.trap;
+    bool trapEnabled = target.trapEnabled;
+    bool trace = target.trace;
+    target = registers;
+    target.trap = trap;
+    target.trapEnabled = trapEnabled;
+    target.trace = trace;
+
+    InterruptControllerIntel8080 & interruptController = processor.GetInterruptController();
+    interruptController.Reset();
+    for (uint8_t level = 0; level < InterruptControllerIntel8080::LevelCount; ++level)
+    {
+        if (interrupts.pending & (1 << level))
+            interruptController.Request(level);
+    }
+    interruptController.SetMask(interrupts.mask);
+    if (processor8085)
+    {
+        processor8085->interruptMasks = interrupts.interruptMasks;
+        processor8085->serialInput = interrupts.serialInput;
+        processor8085->serialOutput = interrupts.serialOutput;
+    }
+}
+
+void SnapshotIntel8080::Save(std::ostream & stream) const
+{
+    WriteValue(stream, Magic, 4);
+    WriteValue(stream, Version, 2);
+    WriteValue(stream, pageSize, 4);
+    WriteValue(stream, registers.pc, 2);
+    WriteValue(stream, registers.sp.W, 2);
+    WriteValue(stream, registers.bc.W, 2);
+    WriteValue(stream, registers.de.W, 2);
+    WriteValue(stream, registers.hl.W, 2);
+    WriteValue(stream, registers.wz.W, 2);
+    WriteValue(stream, registers.a, 1);
+    WriteValue(stream, registers.tmp, 1);
+    WriteValue(stream, uint8_t(registers.flags), 1);
+    WriteValue(stream, registers.ie, 1);
+    WriteValue(stream, registers.isHalted, 1);
+    WriteValue(stream, registers.instructionCycles, 1);
+    WriteValue(stream, uint64_t(registers.cycleCount), 8);
+    WriteValue(stream, registers.cycleCountPeriod, 8);
+    WriteValue(stream, registers.cycleCountBackup, 8);
+    WriteValue(stream, registers.cycleCountTotal, 8);
+    WriteValue(stream, interrupts.pending, 1);
+    WriteValue(stream, interrupts.mask, 1);
+    WriteValue(stream, interrupts.is8085, 1);
+    WriteValue(stream, interrupts.interruptMasks, 1);
+    WriteValue(stream, interrupts.serialInput, 1);
+    WriteValue(stream, interrupts.serialOutput, 1);
+    SaveBlocks(stream, memoryBlocks);
+    SaveBlocks(stream, ioBlocks);
+}
+
+SnapshotIntel8080 SnapshotIntel8080::Load(std::istream & stream)
+{
+    SnapshotIntel8080 snapshot;
+    uint32_t magic = uint32_t(ReadValue(stream, 4));
+    uint16_t version = uint16_t(ReadValue(stream, 2));
+    if ((magic != Magic) || (version != Version))
+    {
+        std::ostringstream message;
+        message << "Snapshot: invalid header " << std::hex << magic << " version " << std::dec << version;
+        throw std::runtime_error(message.str());
+    }
+    snapshot.pageSize = size_t(ReadValue(stream, 4));
+    if ((snapshot.pageSize == 0) || (snapshot.pageSize > MemoryManager::AddressSpaceSize))
+        throw std::runtime_error("Snapshot: invalid page size");
+    RegistersIntel8080 & registers = snapshot.registers;
+    registers.pc = Reg16(ReadValue(stream, 2));
+    registers.sp.W = Reg16(ReadValue(stream, 2));
+    registers.bc.W = Reg16(ReadValue(stream, 2));
+    registers.de.W = Reg16(ReadValue(stream, 2));
+    registers.hl.W = Reg16(ReadValue(stream, 2));
+    registers.wz.W = Reg16(ReadValue(stream, 2));
+    registers.a = Reg8(ReadValue(stream, 1));
+    registers.tmp = Reg8(ReadValue(stream, 1));
+    registers.flags = FlagsIntel8080(ReadValue(stream, 1));
+    registers.ie = (ReadValue(stream, 1) != 0);
+    registers.isHalted = (ReadValue(stream, 1) != 0);
+    registers.instructionCycles = uint8_t(ReadValue(stream, 1));
+    registers.cycleCount = int64_t(ReadValue(stream, 8));
+    registers.cycleCountPeriod = size_t(ReadValue(stream, 8));
+    registers.cycleCountBackup = size_t(ReadValue(stream, 8));
+    registers.cycleCountTotal = size_t(ReadValue(stream, 8));
+    SnapshotInterruptsIntel8080 & interrupts = snapshot.interrupts;
+    interrupts.pending = uint8_t(ReadValue(stream, 1));
+    interrupts.mask = uint8_t(ReadValue(stream, 1));
+    interrupts.is8085 = (ReadValue(stream, 1) != 0);
+    interrupts.interruptMasks = uint8_t(ReadValue(stream, 1));
+    interrupts.serialInput = (ReadValue(stream, 1) != 0);
+    interrupts.serialOutput = (ReadValue(stream, 1) != 0);
+    snapshot.memoryBlocks = LoadBlocks(stream, snapshot.pageSize);
+    snapshot.ioBlocks = LoadBlocks(stream, snapshot.pageSize);
+    return snapshot;
+}
+
+size_t SnapshotIntel8080::PageCount() const
+{
+    size_t count = 0;
+    for (auto const & block : memoryBlocks)
+        count += block.pages.size();
+    for (auto const & block : ioBlocks)
+        count += block.pages.size();
+    return count;
+}
+
+// Number of pages of this snapshot stored only once for both snapshots
+size_t SnapshotIntel8080::SharedPageCount(SnapshotIntel8080 const & other) const
+{
+    size_t count = 0;
+    SnapshotBlockVector const * blockVectors[] = { &memoryBlocks, &ioBlocks };
+    SnapshotBlockVector const * otherBlockVectors[] = { &other.memoryBlocks, &other.ioBlocks };
+    for (size_t vectorIndex = 0; vectorIndex < 2; ++vectorIndex)
+    {
+        SnapshotBlockVector const & blocks = *blockVectors[vectorIndex];
+        SnapshotBlockVector const & otherBlocks = *otherBlockVectors[vectorIndex];
+        for (size_t blockIndex = 0; blockIndex < std::min(blocks.size(), otherBlocks.size()); ++blockIndex)
+        {
+            std::vector<SnapshotPagePtr> const & pages = blocks[blockIndex].pages;
+            std::vector<SnapshotPagePtr> const & otherPages = otherBlocks[blockIndex].pages;
+            for (size_t pageIndex = 0; pageIndex < std::min(pages.size(), otherPages.size()); ++pageIndex)
+            {
+                if (pages[pageIndex] == otherPages[pageIndex])
+                    ++count;
+            }
+        }
+    }
+    return count;
+}
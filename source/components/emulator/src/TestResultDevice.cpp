@@ -0,0 +1,13 @@
+#include "emulator/TestResultDevice.h"
+
+using namespace Emulator;
+
+TestResultDevice::TestResultDevice(size_t base)
+    : IODevice(base, 1)
+    , results()
+{
+}
+
+TestResultDevice::~TestResultDevice()
+{
+}
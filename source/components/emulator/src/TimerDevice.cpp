@@ -0,0 +1,84 @@
+#include "emulator/TimerDevice.h"
+
+#include <limits>
+
+using namespace Emulator;
+
+TimerDevice::TimerDevice(size_t base, size_t cyclesPerTick)
+    : IODevice(base, 3)
+    , cyclesPerTick(cyclesPerTick)
+    , control()
+    , period()
+    , remaining()
+    , expired()
+{
+}
+
+TimerDevice::~TimerDevice()
+{
+}
+
+size_t TimerDevice::Advance(size_t cycles)
+{
+    if (!IsEnabled())
+        return 0;
+    size_t expirations = 0;
+    while (cycles >= remaining)
+    {
+        cycles -= remaining;
+        remaining = PeriodCycles();
+        expired = true;
+        ++expirations;
+    }
+    remaining -= cycles;
+    return expirations;
+}
+
+size_t TimerDevice::CyclesUntilExpiry() const
+{
+    return IsEnabled() ? remaining : std::numeric_limits<size_t>::max();
+}
+
+uint8_t TimerDevice::In8(size_t address) const
+{
+    CheckRange(address, 1, "In");
+    switch (address - base)
+    {
+    case ControlPort:
+        {
+            uint8_t status = control | (expired ? StatusExpired : 0);
+            expired = false;
+            return status;
+        }
+    case PeriodLowPort:
+        return uint8_t(period);
+    default:
+        return uint8_t(period >> 8);
+    }
+}
+
+// Reading the status clears the expired bit, only the period can be read without side effects
+bool TimerDevice::IsPassiveIn(size_t address) const
+{
+    return (address == base + PeriodLowPort) || (address == base + PeriodHighPort);
+}
+
+// Enabling a stopped timer starts a full period
+void TimerDevice::Out8(size_t address, uint8_t data)
+{
+    CheckRange(address, 1, "Out");
+    switch (address - base)
+    {
+    case ControlPort:
+        if (!IsEnabled() && ((data & ControlEnable) != 0))
+            remaining = PeriodCycles();
+        control = data & (ControlEnable | ControlInterruptEnable);
+        break;
+    case PeriodLowPort:
+        period = uint16_t((period & 0xFF00) | data);
+        break;
+    default:
+        period = uint16_t((period & 0x00FF) | (data << 8));
+        break;
+    }
+}
@@ -0,0 +1,312 @@
+#include "emulator/TraceIntel8080.h"
+
+#include <algorithm>
+#include <cstddef>
+#include <cstring>
+#include <iomanip>
+#include <sstream>
+#include <thread>
+#include "core/Util.h"
+
+using namespace Emulator;
+
+static void PutValue(uint8_t * & data, uint64_t value, size_t size)
+{
+    for (size_t index = 0; index < size; ++index)
+    {
+        *data++ = uint8_t(value >> (8 * index));
+    }
+}
+
+static uint64_t GetValue(uint8_t const * & data, size_t size)
+{
+    uint64_t value = 0;
+    for (size_t index = 0; index < size; ++index)
+    {
+        value |= uint64_t(*data++) << (8 * index);
+    }
+    return value;
+}
+
+// Records can be written as they are when the host is little-endian and lays them out like the file does
+static bool RecordMatchesFileLayout()
+{
+    uint16_t value = 0x0001;
+    uint8_t firstByte;
+    std::memcpy(&firstByte, &value, 1);
+    return (firstByte == 0x01) && (sizeof(TraceRecordIntel8080) == TraceRecordIntel8080::Size) &&
+        (offsetof(TraceRecordIntel8080, cycles) == 0) && (offsetof(TraceRecordIntel8080, pc) == 8) &&
+        (offsetof(TraceRecordIntel8080, sp) == 10) && (offsetof(TraceRecordIntel8080, bc) == 12) &&
+        (offsetof(TraceRecordIntel8080, de) == 14) && (offsetof(TraceRecordIntel8080, hl) == 16) &&
+        (offsetof(TraceRecordIntel8080, opcode) == 18) && (offsetof(TraceRecordIntel8080, operand1) == 19) &&
+        (offsetof(TraceRecordIntel8080, operand2) == 20) && (offsetof(TraceRecordIntel8080, a) == 21) &&
+        (offsetof(TraceRecordIntel8080, flags) == 22) && (offsetof(TraceRecordIntel8080, status) == 23) &&
+        (offsetof(TraceRecordIntel8080, reserved) == 24);
+}
+
+static const bool recordMatchesFileLayout = RecordMatchesFileLayout();
+
+bool TraceRecordIntel8080::operator == (TraceRecordIntel8080 const & other) const
+{
+    return (cycles == other.cycles) &&
+        (pc == other.pc) &&
+        (sp == other.sp) &&
+        (bc == other.bc) &&
+        (de == other.de) &&
+        (hl == other.hl) &&
+        (opcode == other.opcode) &&
+        (operand1 == other.operand1) &&
+        (operand2 == other.operand2) &&
+        (a == other.a) &&
+        (flags == other.flags) &&
+        (status == other.status);
+}
+
+TraceBufferIntel8080::TraceBufferIntel8080(size_t capacity)
+    : records()
+    , mask()
+    , head(0)
+    , tail(0)
+{
+    size_t size = 2;
+    while (size < capacity)
+        size <<= 1;
+    records.resize(size);
+    mask = size - 1;
+}
+
+void TraceBufferIntel8080::Push(TraceRecordIntel8080 const & record)
+{
+    while (!TryPush(record))
+        std::this_thread::yield();
+}
+
+size_t TraceBufferIntel8080::Pop(TraceRecordIntel8080 * data, size_t maxCount)
+{
+    size_t position = tail.load(std::memory_order_relaxed);
+    size_t count = std::min(head.load(std::memory_order_acquire) - position, maxCount);
+    for (size_t index = 0; index < count; ++index)
+    {
+        data[index] = records[(position + index) & mask];
+    }
+    tail.store(position + count, std::memory_order_release);
+    return count;
+}
+
+TraceRecorderIntel8080::TraceRecorderIntel8080(std::ostream & stream, size_t capacity)
+    : Core::ActiveObject("TraceRecorderIntel8080")
+    , stream(stream)
+    , buffer(capacity)
+    , processor()
+    , memoryManager()
+    , cycles()
+    , recordCount()
+{
+}
+
+TraceRecorderIntel8080::~TraceRecorderIntel8080()
+{
+    Stop();
+}
+
+void TraceRecorderIntel8080::Start(ProcessorIntel8080 & processor)
+{
+    Stop();
+    this->processor = &processor;
+    memoryManager = processor.GetMemoryManager().get();
+    if (!memoryManager)
+        throw std::runtime_error("Trace: processor has no memory set up");
+    cycles = 0;
+    recordCount = 0;
+    WriteHeader(stream);
+    Create();
+    processor.SetTraceRecorder(this);
+}
+
+void TraceRecorderIntel8080::Stop()
+{
+    if (!processor)
+        return;
+    processor->SetTraceRecorder(nullptr);
+    processor = nullptr;
+    memoryManager = nullptr;
+    Kill();
+    stream.flush();
+}
+
+// Called before every instruction, instructionCycles still holds the cycles of the previous one
+void TraceRecorderIntel8080::Record(RegistersIntel8080 const & registers)
+{
+    if (recordCount > 0)
+        cycles += registers.instructionCycles;
+    TraceRecordIntel8080 record;
+    record.cycles = cycles;
+    record.pc = registers.pc;
+    record.sp = registers.sp.W;
+    record.bc = registers.bc.W;
+    record.de = registers.de.W;
+    record.hl = registers.hl.W;
+    record.a = registers.a;
+    record.flags = uint8_t(registers.flags);
+    record.status = registers.ie ? TraceRecordIntel8080::StatusInterruptsEnabled : 0;
+    // Bulk fetches are not reported to the access callback, so recording does not hit read watchpoints on the code
+    uint8_t code[3] = {};
+    memoryManager->Fetch(registers.pc, code, 1);
+    size_t instructionSize = ProcessorIntel8080::GetInstructionData(OpcodesIntel8080(code[0])).instructionSize;
+    for (size_t index = 1; index < instructionSize; ++index)
+        memoryManager->Fetch(Reg16(registers.pc + index), code + index, 1);
+    record.opcode = code[0];
+    record.operand1 = code[1];
+    record.operand2 = code[2];
+    buffer.Push(record);
+    ++recordCount;
+}
+
+void TraceRecorderIntel8080::Run()
+{
+    std::vector<TraceRecordIntel8080> chunk(buffer.Capacity());
+    while (!IsDying())
+    {
+        if (Drain(chunk) == 0)
+            Core::Util::Sleep(1);
+    }
+    while (Drain(chunk) > 0)
+    {
+    }
+}
+
+size_t TraceRecorderIntel8080::Drain(std::vector<TraceRecordIntel8080> & chunk)
+{
+    size_t count = buffer.Pop(chunk.data(), chunk.size());
+    Write(stream, chunk.data(), count);
+    return count;
+}
+
+void TraceRecorderIntel8080::WriteHeader(std::ostream & stream)
+{
+    uint8_t header[8];
+    uint8_t * data = header;
+    PutValue(data, Magic, 4);
+    PutValue(data, Version, 2);
+    PutValue(data, TraceRecordIntel8080::Size, 2);
+    stream.write(reinterpret_cast<char const *>(header), sizeof(header));
+}
+
+void TraceRecorderIntel8080::Write(std::ostream & stream, TraceRecordIntel8080 const * records, size_t count)
+{
+    if (count == 0)
+        return;
+    if (recordMatchesFileLayout)
+    {
+        stream.write(reinterpret_cast<char const *>(records), std::streamsize(count * TraceRecordIntel8080::Size));
+        return;
+    }
+    std::vector<uint8_t> bytes(count * TraceRecordIntel8080::Size);
+    uint8_t * data = bytes.data();
+    for (size_t index = 0; index < count; ++index)
+    {
+        TraceRecordIntel8080 const & record = records[index];
+        PutValue(data, record.cycles, 8);
+        PutValue(data, record.pc, 2);
+        PutValue(data, record.sp, 2);
+        PutValue(data, record.bc, 2);
+        PutValue(data, record.de, 2);
+        PutValue(data, record.hl, 2);
+        *data++ = record.opcode;
+        *data++ = record.operand1;
+        *data++ = record.operand2;
+        *data++ = record.a;
+        *data++ = record.flags;
+        *data++ = record.status;
+        for (auto reserved : record.reserved)
+            *data++ = reserved;
+    }
+    stream.write(reinterpret_cast<char const *>(bytes.data()), std::streamsize(bytes.size()));
+}
+
+TraceRecordsIntel8080 TraceReaderIntel8080::Load(std::istream & stream)
+{
+    uint8_t header[8];
+    if (!stream.read(reinterpret_cast<char *>(header), sizeof(header)))
+        throw std::runtime_error("Trace: unexpected end of data");
+    uint8_t const * data = header;
+    uint32_t magic = uint32_t(GetValue(data, 4));
+    uint16_t version = uint16_t(GetValue(data, 2));
+    uint16_t recordSize = uint16_t(GetValue(data, 2));
+    if ((magic != TraceRecorderIntel8080::Magic) || (version != TraceRecorderIntel8080::Version) || (recordSize != TraceRecordIntel8080::Size))
+    {
+        std::ostringstream message;
+        message << "Trace: invalid header " << std::hex << magic << " version " << std::dec << version << " record size " << recordSize;
+        throw std::runtime_error(message.str());
+    }
+    TraceRecordsIntel8080 records;
+    uint8_t bytes[TraceRecordIntel8080::Size];
+    while (stream.read(reinterpret_cast<char *>(bytes), sizeof(bytes)))
+    {
+        data = bytes;
+        TraceRecordIntel8080 record;
+        record.cycles = GetValue(data, 8);
+        record.pc = uint16_t(GetValue(data, 2));
+        record.sp = uint16_t(GetValue(data, 2));
+        record.bc = uint16_t(GetValue(data, 2));
+        record.de = uint16_t(GetValue(data, 2));
+        record.hl = uint16_t(GetValue(data, 2));
+        record.opcode = *data++;
+        record.operand1 = *data++;
+        record.operand2 = *data++;
+        record.a = *data++;
+        record.flags = *data++;
+        record.status = *data++;
+        std::copy(data, data + sizeof(record.reserved), record.reserved);
+        records.push_back(record);
+    }
+    if (stream.gcount() != 0)
+        throw std::runtime_error("Trace: incomplete record at end of data");
+    return records;
+}
+
+void TraceReaderIntel8080::Print(std::ostream & stream, TraceRecordIntel8080 const & record)
+{
+    InstructionDataIntel8080 const & instructionData = ProcessorIntel8080::GetInstructionData(OpcodesIntel8080(record.opcode));
+    std::ostringstream line;
+    line << std::setw(12) << record.cycles << " "
+         << std::hex << std::uppercase << std::setfill('0')
+         << std::setw(4) << record.pc << " "
+         << std::setw(2) << int(record.opcode);
+    if (instructionData.instructionSize > 1)
+        line << " " << std::setw(2) << int(record.operand1);
+    else
+        line << "   ";
+    if (instructionData.instructionSize > 2)
+        line << " " << std::setw(2) << int(record.operand2);
+    else
+        line << "   ";
+    line << " " << std::setw(12) << std::setfill(' ') << std::left << instructionData.instructionMnemonic << std::right << std::setfill('0')
+         << " A=" << std::setw(2) << int(record.a)
+         << " BC=" << std::setw(4) << record.bc
+         << " DE=" << std::setw(4) << record.de
+         << " HL=" << std::setw(4) << record.hl
+         << " SP=" << std::setw(4) << record.sp
+         << " F=" << std::setw(2) << int(record.flags)
+         << ((record.status & TraceRecordIntel8080::StatusInterruptsEnabled) ? " EI" : " DI");
+    stream << line.str() << std::endl;
+}
+
+void TraceReaderIntel8080::Print(std::ostream & stream, TraceRecordsIntel8080 const & records)
+{
+    for (auto const & record : records)
+    {
+        Print(stream, record);
+    }
+}
+
+size_t TraceReaderIntel8080::Diff(TraceRecordsIntel8080 const & first, TraceRecordsIntel8080 const & second)
+{
+    size_t count = std::min(first.size(), second.size());
+    for (size_t index = 0; index < count; ++index)
+    {
+        if (first[index] != second[index])
+            return index;
+    }
+    return (first.size() == second.size()) ? npos : count;
+}
@@ -0,0 +1,32 @@
+#pragma once
+
+#include <string>
+#include "core/Path.h"
+
+namespace Emulator
+{
+
+namespace Test
+{
+
+class TestData
+{
+public:
+    static const std::string ProjectName() { return "emulator"; }
+
+    static std::string SourceDirectory()
+    {
+        return Core::Path::StripPathToSubDirectory(Core::Path::CurrentDir(), "source");
+    }
+    static std::string TestSourceDirectory()
+    {
+        std::string projectDirectory = Core::Path::CombinePath(Core::Path::CombinePath(SourceDirectory(), "components"), ProjectName());
+        return Core::Path::CombinePath(Core::Path::CombinePath(Core::Path::CombinePath(projectDirectory, "test"), "src"), "Test");
+    }
+
+    static std::string RecompiledTestProgram() { return Core::Path::CombinePath(TestSourceDirectory(), "RecompiledTestProgram.cpp"); }
+};
+
+} // namespace Test
+
+} // namespace Emulator
@@ -0,0 +1,123 @@
+#pragma once
+
+#include <vector>
+#include "unit-test-c++/UnitTestC++.h"
+#include "emulator/ProcessorIntel8080.h"
+#include "emulator/RAM.h"
+#include "emulator/IOPort.h"
+
+namespace Emulator
+{
+
+namespace Test
+{
+
+// Machine setup and test programs shared by the tests of the execution engines
+class TestMachineIntel8080
+{
+public:
+    static const size_t ROMSize = 256;
+    static const size_t RAMSize = 2048;
+    static const size_t Origin = 0;
+    static const size_t RAMOrigin = Origin + ROMSize;
+    static const size_t IOOrigin = 0;
+    static const size_t IOSize = 256;
+
+    // testdata/asm-8080/Multiply3x7.asm
+    static std::vector<uint8_t> const & Multiply3x7()
+    {
+        static const std::vector<uint8_t> code =
+        {
+            0x0E, 0x03,         // 0000 MVI C,3
+            0x16, 0x07,         // 0002 MVI D,7
+            0x06, 0x00,         // 0004 MULT: MVI B,0
+            0x1E, 0x09,         // 0006 MVI E,9
+            0x79,               // 0008 MULT0: MOV A,C
+            0x1F,               // 0009 RAR
+            0x4F,               // 000A MOV C,A
+            0x1D,               // 000B DCR E
+            0xCA, 0x19, 0x00,   // 000C JZ DONE
+            0x78,               // 000F MOV A,B
+            0xD2, 0x14, 0x00,   // 0010 JNC MULT1
+            0x82,               // 0013 ADD D
+            0x1F,               // 0014 MULT1: RAR
+            0x47,               // 0015 MOV B,A
+            0xC3, 0x08, 0x00,   // 0016 JMP MULT0
+            0x76,               // 0019 DONE: HLT
+        };
+        return code;
+    }
+
+    // Nested calls, a conditional return and a loop, for the profiler and coverage tests
+    static std::vector<uint8_t> const & CallProgram()
+    {
+        static const std::vector<uint8_t> code =
+        {
+            0x31, 0x00, 0x08,   // 0000 START: LXI SP,0800
+            0x0E, 0x03,         // 0003 MVI C,03
+            0xCD, 0x10, 0x00,   // 0005 LOOP: CALL MULT
+            0x0D,               // 0008 DCR C
+            0xC2, 0x05, 0x00,   // 0009 JNZ LOOP
+            0x76,               // 000C HLT
+            0x00, 0x00, 0x00,
+            0x3E, 0x00,         // 0010 MULT: MVI A,00
+            0xCD, 0x18, 0x00,   // 0012 CALL ADDER
+            0xC8,               // 0015 RZ
+            0xC9,               // 0016 RET
+            0x00,
+            0xC6, 0x07,         // 0018 ADDER: ADI 07
+            0xC9,               // 001A RET
+        };
+        return code;
+    }
+
+    // ROM of ROMSize at Origin holding the code, RAM of RAMSize after it, and an IOPort.
+    // A template, so the LoadCode() of the engine itself is called.
+    template<class Processor>
+    static void SetupProcessor(Processor & processor, std::vector<uint8_t> const & code)
+    {
+        MemoryManagerPtr memoryManager = std::make_shared<MemoryManager>();
+        ROMPtr rom = std::make_shared<ROM>(Origin, ROMSize);
+        memoryManager->AddMemory(rom);
+        memoryManager->AddMemory(std::make_shared<RAM>(RAMOrigin, RAMSize));
+        IOManagerPtr ioManager = std::make_shared<IOManager>();
+        ioManager->AddIO(std::make_shared<IOPort>(IOOrigin, IOSize));
+        processor.Setup(memoryManager, ioManager);
+        processor.LoadCode(code, Origin, rom);
+    }
+
+    // RAM of ramSize from address 0 holding the code, for code that is modified or stores anywhere, and an IOPort
+    template<class Processor>
+    static void SetupProcessorRAM(Processor & processor, std::vector<uint8_t> const & code,
+                                  size_t ramSize = MemoryManager::AddressSpaceSize)
+    {
+        MemoryManagerPtr memoryManager = std::make_shared<MemoryManager>();
+        RAMPtr ram = std::make_shared<RAM>(0, ramSize);
+        memoryManager->AddMemory(ram);
+        IOManagerPtr ioManager = std::make_shared<IOManager>();
+        ioManager->AddIO(std::make_shared<IOPort>(IOOrigin, IOSize));
+        processor.Setup(memoryManager, ioManager);
+        processor.LoadData(code, 0, ram);
+    }
+
+    static void AssertRegisters(RegistersIntel8080 const & expected, RegistersIntel8080 const & actual)
+    {
+        EXPECT_EQ(expected.pc, actual.pc);
+        EXPECT_EQ(expected.sp.W, actual.sp.W);
+        EXPECT_EQ(expected.bc.W, actual.bc.W);
+        EXPECT_EQ(expected.de.W, actual.de.W);
+        EXPECT_EQ(expected.hl.W, actual.hl.W);
+        EXPECT_EQ(expected.wz.W, actual.wz.W);
+        EXPECT_EQ(expected.a, actual.a);
+        EXPECT_EQ(expected.flags, actual.flags);
+        EXPECT_EQ(expected.ie, actual.ie);
+        EXPECT_EQ(expected.instructionCycles, actual.instructionCycles);
+        EXPECT_EQ(expected.cycleCount, actual.cycleCount);
+        EXPECT_EQ(expected.cycleCountTotal, actual.cycleCountTotal);
+        EXPECT_EQ(expected.isHalted, actual.isHalted);
+    }
+};
+
+} // namespace Test
+
+} // namespace Emulator
@@ -0,0 +1,260 @@
+// Generated by RecompilerIntel8080, do not edit
+#include "emulator/RecompiledProcessorIntel8080.h"
+
+#include <utility>
+
+using namespace Emulator;
+using P = RecompiledProcessorIntel8080;
+
+namespace
+{
+
+size_t Block_0000(P & p)
+{
+    RegistersIntel8080 & r = p.Registers();
+    // 0000 JMP 0040
+    r.pc = 0x0040; r.instructionCycles = 10; return 10;
+}
+
+size_t Block_0008(P & p)
+{
+    RegistersIntel8080 & r = p.Registers();
+    // 0008 INR E
+    r.de.B.l = P::Inc(r.de.B.l, r.flags);
+    // 0009 RET
+    p.Pop(r.pc); r.instructionCycles = 10; return 15;
+}
+
+size_t Block_0040(P & p)
+{
+    RegistersIntel8080 & r = p.Registers();
+    // 0040 LXI SP,0800
+    r.sp.W = 0x0800;
+    // 0043 MVI C,03
+    r.bc.B.l = 0x03;
+    // 0045 MVI D,07
+    r.de.B.h = 0x07;
+    // 0047 CALL 0090
+    r.wz.W = 0x0090; p.Push(0x004A); r.pc = r.wz.W; r.instructionCycles = 17; return 41;
+}
+
+size_t Block_004A(P & p)
+{
+    RegistersIntel8080 & r = p.Registers();
+    MemoryManager & m = p.Memory();
+    // 004A LXI H,0400
+    r.hl.W = 0x0400;
+    // 004D MOV M,A
+    m.Store8(r.hl.W, r.a);
+    if (p.CodeModified()) { r.pc = 0x004E; r.instructionCycles = 7; return 17; }
+    // 004E INR M
+    m.Store8(r.hl.W, P::Inc(m.Fetch8(r.hl.W), r.flags));
+    if (p.CodeModified()) { r.pc = 0x004F; r.instructionCycles = 10; return 27; }
+    // 004F PUSH PSW
+    p.Push(uint16_t(r.a << 8 | ((uint8_t(r.flags) & 0xD7) | 0x02)));
+    if (p.CodeModified()) { r.pc = 0x0050; r.instructionCycles = 11; return 38; }
+    // 0050 POP B
+    p.Pop(r.bc.W);
+    // 0051 XCHG
+    std::swap(r.de.W, r.hl.W);
+    // 0052 DAD D
+    r.hl.W = P::AddW(r.hl.W, r.de.W, r.flags);
+    // 0053 SHLD 0402
+    r.wz.W = 0x0402; m.Store16(r.wz.W, r.hl.W);
+    if (p.CodeModified()) { r.pc = 0x0056; r.instructionCycles = 16; return 78; }
+    // 0056 LHLD 0402
+    r.wz.W = 0x0402; r.hl.W = m.Fetch16(r.wz.W);
+    // 0059 RST 1
+    p.Push(0x005A); r.pc = 0x0008; r.instructionCycles = 11; return 105;
+}
+
+size_t Block_005A(P & p)
+{
+    RegistersIntel8080 & r = p.Registers();
+    MemoryManager & m = p.Memory();
+    // 005A XTHL
+    r.wz.W = m.Fetch16(r.sp.W); m.Store16(r.sp.W, r.hl.W); r.hl.W = r.wz.W;
+    if (p.CodeModified()) { r.pc = 0x005B; r.instructionCycles = 18; return 18; }
+    // 005B XTHL
+    r.wz.W = m.Fetch16(r.sp.W); m.Store16(r.sp.W, r.hl.W); r.hl.W = r.wz.W;
+    if (p.CodeModified()) { r.pc = 0x005C; r.instructionCycles = 18; return 36; }
+    // 005C STA 0404
+    r.wz.W = 0x0404; m.Store8(r.wz.W, r.a);
+    if (p.CodeModified()) { r.pc = 0x005F; r.instructionCycles = 13; return 49; }
+    // 005F LDA 0404
+    r.wz.W = 0x0404; r.a = m.Fetch8(r.wz.W);
+    // 0062 ADI 99
+    r.a = P::Add(r.a, 0x99, r.flags);
+    // 0064 DAA
+    r.a = P::DAA(r.a, r.flags);
+    // 0065 CMA
+    r.a ^= 0xFF;
+    // 0066 STC
+    r.flags |= FlagsIntel8080::Carry;
+    // 0067 CMC
+    r.flags ^= FlagsIntel8080::Carry;
+    // 0068 RLC
+    r.a = P::RLC(r.a, r.flags);
+    // 0069 OUT 10
+    p.IO().Out8(0x10, r.a);
+    // 006B IN 10
+    r.a = p.IO().In8(0x10);
+    // 006D CPI 7F
+    P::Cmp(r.a, 0x7F, r.flags);
+    // 006F CNC 00A0
+    if ((r.flags & FlagsIntel8080::Carry) == FlagsIntel8080::None) { r.wz.W = 0x00A0; p.Push(0x0072); r.pc = r.wz.W; r.instructionCycles = 17; return 133; }
+    r.pc = 0x0072; r.instructionCycles = 11; return 127;
+}
+
+size_t Block_0072(P & p)
+{
+    RegistersIntel8080 & r = p.Registers();
+    MemoryManager & m = p.Memory();
+    // 0072 MVI A,04
+    r.a = 0x04;
+    // 0074 STA 00C1
+    r.wz.W = 0x00C1; m.Store8(r.wz.W, r.a);
+    if (p.CodeModified()) { r.pc = 0x0077; r.instructionCycles = 13; return 20; }
+    // 0077 CALL 00C0
+    r.wz.W = 0x00C0; p.Push(0x007A); r.pc = r.wz.W; r.instructionCycles = 17; return 37;
+}
+
+size_t Block_007A(P & p)
+{
+    RegistersIntel8080 & r = p.Registers();
+    // 007A CALL 00D0
+    r.wz.W = 0x00D0; p.Push(0x007D); r.pc = r.wz.W; r.instructionCycles = 17; return 17;
+}
+
+size_t Block_007D(P & p)
+{
+    RegistersIntel8080 & r = p.Registers();
+    // 007D LXI H,00A8
+    r.hl.W = 0x00A8;
+    // 0080 PCHL
+    r.pc = r.hl.W; r.instructionCycles = 5; return 15;
+}
+
+size_t Block_0090(P & p)
+{
+    RegistersIntel8080 & r = p.Registers();
+    // 0090 MVI A,00
+    r.a = 0x00;
+    r.pc = 0x0092; r.instructionCycles = 7; return 7;
+}
+
+size_t Block_0092(P & p)
+{
+    RegistersIntel8080 & r = p.Registers();
+    // 0092 ADD D
+    r.a = P::Add(r.a, r.de.B.h, r.flags);
+    // 0093 DCR C
+    r.bc.B.l = P::Dec(r.bc.B.l, r.flags);
+    // 0094 JNZ 0092
+    if ((r.flags & FlagsIntel8080::Zero) == FlagsIntel8080::None) { r.pc = 0x0092; r.instructionCycles = 10; return 19; }
+    r.pc = 0x0097; r.instructionCycles = 10; return 19;
+}
+
+size_t Block_0097(P & p)
+{
+    RegistersIntel8080 & r = p.Registers();
+    // 0097 RET
+    p.Pop(r.pc); r.instructionCycles = 10; return 10;
+}
+
+size_t Block_00A0(P & p)
+{
+    RegistersIntel8080 & r = p.Registers();
+    // 00A0 ORI 01
+    r.a = P::Or(r.a, 0x01, r.flags);
+    // 00A2 RZ
+    if ((r.flags & FlagsIntel8080::Zero) != FlagsIntel8080::None) { p.Pop(r.pc); r.instructionCycles = 11; return 18; }
+    r.pc = 0x00A3; r.instructionCycles = 5; return 12;
+}
+
+size_t Block_00A3(P & p)
+{
+    RegistersIntel8080 & r = p.Registers();
+    // 00A3 RET
+    p.Pop(r.pc); r.instructionCycles = 10; return 10;
+}
+
+size_t Block_00C0(P & p)
+{
+    RegistersIntel8080 & r = p.Registers();
+    // 00C0 MOV B,A
+    r.bc.B.h = r.a;
+    // 00C1 NOP
+    // 00C2 RET
+    p.Pop(r.pc); r.instructionCycles = 10; return 19;
+}
+
+size_t Block_00D0(P & p)
+{
+    RegistersIntel8080 & r = p.Registers();
+    MemoryManager & m = p.Memory();
+    // 00D0 MVI A,2C
+    r.a = 0x2C;
+    // 00D2 STA 00D6
+    r.wz.W = 0x00D6; m.Store8(r.wz.W, r.a);
+    if (p.CodeModified()) { r.pc = 0x00D5; r.instructionCycles = 13; return 20; }
+    // 00D5 NOP
+    // 00D6 NOP
+    // 00D7 RET
+    p.Pop(r.pc); r.instructionCycles = 10; return 38;
+}
+
+const uint8_t Image[] =
+{
+    0xC3, 0x40, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x1C, 0xC9, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+    0x31, 0x00, 0x08, 0x0E, 0x03, 0x16, 0x07, 0xCD, 0x90, 0x00, 0x21, 0x00, 0x04, 0x77, 0x34, 0xF5,
+    0xC1, 0xEB, 0x19, 0x22, 0x02, 0x04, 0x2A, 0x02, 0x04, 0xCF, 0xE3, 0xE3, 0x32, 0x04, 0x04, 0x3A,
+    0x04, 0x04, 0xC6, 0x99, 0x27, 0x2F, 0x37, 0x3F, 0x07, 0xD3, 0x10, 0xDB, 0x10, 0xFE, 0x7F, 0xD4,
+    0xA0, 0x00, 0x3E, 0x04, 0x32, 0xC1, 0x00, 0xCD, 0xC0, 0x00, 0xCD, 0xD0, 0x00, 0x21, 0xA8, 0x00,
+    0xE9, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+    0x3E, 0x00, 0x82, 0x0D, 0xC2, 0x92, 0x00, 0xC9, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+    0xF6, 0x01, 0xC8, 0xC9, 0x00, 0x00, 0x00, 0x00, 0x3C, 0x76, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+    0x47, 0x00, 0xC9, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+    0x3E, 0x2C, 0x32, 0xD6, 0x00, 0x00, 0x00, 0xC9,
+};
+
+const RecompiledBlockIntel8080 Blocks[] =
+{
+    { 0x0000, 3, OpcodesIntel8080(0xC3), &Block_0000 },
+    { 0x0008, 2, OpcodesIntel8080(0xC9), &Block_0008 },
+    { 0x0040, 10, OpcodesIntel8080(0xCD), &Block_0040 },
+    { 0x004A, 16, OpcodesIntel8080(0xCF), &Block_004A },
+    { 0x005A, 24, OpcodesIntel8080(0xD4), &Block_005A },
+    { 0x0072, 8, OpcodesIntel8080(0xCD), &Block_0072 },
+    { 0x007A, 3, OpcodesIntel8080(0xCD), &Block_007A },
+    { 0x007D, 4, OpcodesIntel8080(0xE9), &Block_007D },
+    { 0x0090, 2, OpcodesIntel8080(0x3E), &Block_0090 },
+    { 0x0092, 5, OpcodesIntel8080(0xC2), &Block_0092 },
+    { 0x0097, 1, OpcodesIntel8080(0xC9), &Block_0097 },
+    { 0x00A0, 3, OpcodesIntel8080(0xC8), &Block_00A0 },
+    { 0x00A3, 1, OpcodesIntel8080(0xC9), &Block_00A3 },
+    { 0x00C0, 3, OpcodesIntel8080(0xC9), &Block_00C0 },
+    { 0x00D0, 8, OpcodesIntel8080(0xC9), &Block_00D0 },
+};
+
+} // namespace
+
+namespace Emulator
+{
+
+namespace Recompiled
+{
+
+RecompiledCodeIntel8080 const & TestProgram()
+{
+    static const RecompiledCodeIntel8080 code = { "TestProgram", 0x0000, Image, sizeof(Image), Blocks, sizeof(Blocks) / sizeof(Blocks[0]) };
+    return code;
+}
+
+} // namespace Recompiled
+
+} // namespace Emulator
@@ -0,0 +1,145 @@
+#include "unit-test-c++/UnitTestC++.h"
+
+#include "emulator/BatchRunnerIntel8080.h"
+
+using namespace std;
+
+namespace Emulator
+{
+
+namespace Test
+{
+
+class BatchRunnerIntel8080Test : public UnitTestCpp::TestFixture
+{
+public:
+	virtual void SetUp();
+	virtual void TearDown();
+
+    static Assembler::ObjectCode CreateImage(vector<uint8_t> const & code, uint16_t origin = 0);
+};
+
+void BatchRunnerIntel8080Test::SetUp()
+{
+}
+
+void BatchRunnerIntel8080Test::TearDown()
+{
+}
+
+Assembler::ObjectCode BatchRunnerIntel8080Test::CreateImage(vector<uint8_t> const & code, uint16_t origin)
+{
+    Assembler::ObjectCode objectCode("test");
+    objectCode.GetSegment(Assembler::SegmentID::ASEG).SetOffset(origin);
+    objectCode.GetSegment(Assembler::SegmentID::ASEG).SetData(code);
+    return objectCode;
+}
+
+TEST_FIXTURE(BatchRunnerIntel8080Test, Construct)
+{
+    BatchRunnerIntel8080 runner(3, 1000);
+    EXPECT_EQ(size_t{ 3 }, runner.WorkerCount());
+    EXPECT_EQ(size_t{ 1000 }, runner.MaxCycles());
+    EXPECT_TRUE(BatchRunnerIntel8080().WorkerCount() > 0);
+    EXPECT_EQ(size_t{ 0 }, runner.Run({}).size());
+}
+
+TEST_FIXTURE(BatchRunnerIntel8080Test, RunInstance)
+{
+    BatchInstanceIntel8080 instance;
+    // 0000 LXI H,0100; 0003 MVI M,42; 0005 HLT
+    BatchResultIntel8080 result = instance.Run(CreateImage({ 0x21, 0x00, 0x01, 0x36, 0x42, 0x76 }), 100);
+    EXPECT_TRUE(result.Succeeded());
+    EXPECT_FALSE(result.timedOut);
+    EXPECT_EQ(size_t{ 10 + 10 + 7 }, result.registers.cycleCountTotal);
+    EXPECT_EQ(0x0100, result.registers.hl.W);
+    EXPECT_EQ(0x0006, result.registers.pc);
+
+    // Same layout, RAM written by the previous image is cleared
+    // 0000 LDA 0100; 0003 NOP; 0004 NOP; 0005 HLT
+    result = instance.Run(CreateImage({ 0x3A, 0x00, 0x01, 0x00, 0x00, 0x76 }), 100);
+    EXPECT_TRUE(result.Succeeded());
+    EXPECT_EQ(0x00, result.registers.a);
+
+    // Different layout, nothing is mapped at the reset address
+    // 0010 MVI A,01; 0012 HLT
+    result = instance.Run(CreateImage({ 0x3E, 0x01, 0x76 }, 0x0010), 100);
+    EXPECT_FALSE(result.Succeeded());
+    EXPECT_FALSE(result.error.empty());
+}
+
+TEST_FIXTURE(BatchRunnerIntel8080Test, RunInstanceFailures)
+{
+    BatchInstanceIntel8080 instance;
+    // 0000 JMP 0000
+    BatchResultIntel8080 result = instance.Run(CreateImage({ 0xC3, 0x00, 0x00 }), 100);
+    EXPECT_FALSE(result.Succeeded());
+    EXPECT_TRUE(result.timedOut);
+    EXPECT_TRUE(result.error.empty());
+    EXPECT_EQ(size_t{ 100 }, result.registers.cycleCountTotal);
+
+    // The limit is checked between instructions
+    result = instance.Run(CreateImage({ 0xC3, 0x00, 0x00 }), 95);
+    EXPECT_TRUE(result.timedOut);
+    EXPECT_EQ(size_t{ 100 }, result.registers.cycleCountTotal);
+
+    // 0000 NOP; 0001 invalid
+    result = instance.Run(CreateImage({ 0x00, 0x08 }), 100);
+    EXPECT_FALSE(result.Succeeded());
+    EXPECT_FALSE(result.timedOut);
+    EXPECT_FALSE(result.halted);
+    EXPECT_FALSE(result.error.empty());
+}
+
+TEST_FIXTURE(BatchRunnerIntel8080Test, Run)
+{
+    vector<Assembler::ObjectCode> images;
+    for (size_t index = 0; index < 200; ++index)
+    {
+        if (index % 50 == 49)
+        {
+            images.push_back(CreateImage({ 0xC3, 0x00, 0x00 }));                    // JMP 0000
+            continue;
+        }
+        uint8_t count = uint8_t(index);
+        images.push_back(CreateImage(
+        {
+            0xAF,               // 0000 XRA A
+            0x06, count,        // 0001 MVI B,count
+            0x04,               // 0003 INR B
+            0x05,               // 0004 LOOP: DCR B
+            0xCA, 0x0C, 0x00,   // 0005 JZ DONE
+            0x3C,               // 0008 INR A
+            0xC3, 0x04, 0x00,   // 0009 JMP LOOP
+            0x76,               // 000C DONE: HLT
+        }));
+    }
+    BatchRunnerIntel8080 runner(4, 10000);
+    BatchResultsIntel8080 results = runner.Run(images);
+
+    BatchInstanceIntel8080 instance;
+    ASSERT_EQ(images.size(), results.size());
+    for (size_t index = 0; index < images.size(); ++index)
+    {
+        BatchResultIntel8080 expected = instance.Run(images[index], 10000);
+        EXPECT_EQ(index, results[index].index);
+        EXPECT_EQ(expected.halted, results[index].halted);
+        EXPECT_EQ(expected.timedOut, results[index].timedOut);
+        EXPECT_EQ(expected.registers.cycleCountTotal, results[index].registers.cycleCountTotal);
+        EXPECT_EQ(expected.registers.a, results[index].registers.a);
+        EXPECT_EQ(expected.registers.pc, results[index].registers.pc);
+        if (index % 50 == 49)
+        {
+            EXPECT_TRUE(results[index].timedOut);
+        }
+        else
+        {
+            EXPECT_TRUE(results[index].Succeeded());
+            EXPECT_EQ(uint8_t(index), results[index].registers.a);
+        }
+    }
+}
+
+} // namespace Test
+
+} // namespace Emulator
@@ -0,0 +1,226 @@
+#include "unit-test-c++/UnitTestC++.h"
+
+#include "emulator/BreakpointManager.h"
+#include "emulator/CachedProcessorIntel8080.h"
+#include "emulator/JitProcessorIntel8080.h"
+#include "emulator/RAM.h"
+#include "emulator/IOPort.h"
+
+using namespace std;
+
+namespace Emulator
+{
+
+namespace Test
+{
+
+class BreakpointManagerTest : public UnitTestCpp::TestFixture
+{
+public:
+	virtual void SetUp();
+	virtual void TearDown();
+
+    static const size_t RAMSize = 2048;
+    static const size_t IOSize = 256;
+
+    static const vector<uint8_t> TestProgram;
+
+    MemoryManagerPtr memoryManager;
+    RAMPtr ram;
+    IOManagerPtr ioManager;
+
+    void SetupProcessor(ProcessorIntel8080 & processor);
+};
+
+const vector<uint8_t> BreakpointManagerTest::TestProgram =
+{
+    0x31, 0x00, 0x08,   // 0000 LXI SP,0800
+    0x06, 0x00,         // 0003 MVI B,00
+    0x04,               // 0005 LOOP: INR B
+    0x78,               // 0006 MOV A,B
+    0x32, 0x00, 0x04,   // 0007 STA 0400
+    0xFE, 0x05,         // 000A CPI 05
+    0xC2, 0x05, 0x00,   // 000C JNZ LOOP
+    0x3A, 0x00, 0x04,   // 000F LDA 0400
+    0x76,               // 0012 HLT
+};
+
+void BreakpointManagerTest::SetUp()
+{
+    memoryManager = std::make_shared<MemoryManager>();
+    ram = std::make_shared<RAM>(0, RAMSize);
+    memoryManager->AddMemory(ram);
+    ioManager = std::make_shared<IOManager>();
+    ioManager->AddIO(std::make_shared<IOPort>(0, IOSize));
+}
+
+void BreakpointManagerTest::TearDown()
+{
+}
+
+void BreakpointManagerTest::SetupProcessor(ProcessorIntel8080 & processor)
+{
+    processor.Setup(memoryManager, ioManager);
+    processor.LoadData(TestProgram, 0, ram);
+}
+
+TEST_FIXTURE(BreakpointManagerTest, Construct)
+{
+    BreakpointManager breakpoints(memoryManager);
+    EXPECT_EQ(size_t{ 0 }, breakpoints.BreakpointCount());
+    EXPECT_EQ(size_t{ 0 }, breakpoints.WatchpointCount());
+    EXPECT_FALSE(breakpoints.HasStopped());
+    EXPECT_FALSE(memoryManager->HasTraps());
+    EXPECT_THROW(breakpoints.AddBreakpoint(MemoryManager::AddressSpaceSize), std::runtime_error);
+    EXPECT_THROW(breakpoints.AddWatchpoint(0x0401, 0x0400, MemoryAccess::Write), std::runtime_error);
+}
+
+TEST_FIXTURE(BreakpointManagerTest, Breakpoint)
+{
+    FastProcessorIntel8080 processor;
+    SetupProcessor(processor);
+    BreakpointManager breakpoints(memoryManager);
+    breakpoints.AddBreakpoint(0x0006);
+    EXPECT_TRUE(breakpoints.HasBreakpoint(0x0006));
+    EXPECT_NULL(memoryManager->GetPage(0x0000).read);
+    EXPECT_NOT_NULL(memoryManager->GetPage(0x0000).write);
+
+    processor.Run();
+    EXPECT_TRUE(breakpoints.HasStopped());
+    EXPECT_EQ(size_t{ 0x0006 }, breakpoints.GetStop().pc);
+    EXPECT_EQ(size_t{ 0x0006 }, breakpoints.GetStop().address);
+    EXPECT_TRUE(MemoryAccess::Execute == breakpoints.GetStop().access);
+    EXPECT_EQ(0x78, breakpoints.GetStop().data);
+    EXPECT_EQ(0x0006, processor.GetRegisters().pc);
+    EXPECT_EQ(0x01, processor.GetRegisters().bc.B.h);
+    EXPECT_FALSE(processor.GetRegisters().isHalted);
+
+    // Continues past the stop address
+    breakpoints.ClearStop();
+    processor.Run();
+    EXPECT_TRUE(breakpoints.HasStopped());
+    EXPECT_EQ(0x0006, processor.GetRegisters().pc);
+    EXPECT_EQ(0x02, processor.GetRegisters().bc.B.h);
+
+    EXPECT_TRUE(breakpoints.RemoveBreakpoint(0x0006));
+    EXPECT_FALSE(breakpoints.RemoveBreakpoint(0x0006));
+    EXPECT_FALSE(memoryManager->HasTraps());
+    EXPECT_EQ(ram->Data(), memoryManager->GetPage(0x0000).read);
+    breakpoints.ClearStop();
+    processor.Run();
+    EXPECT_FALSE(breakpoints.HasStopped());
+    EXPECT_TRUE(processor.GetRegisters().isHalted);
+    EXPECT_EQ(0x05, processor.GetRegisters().bc.B.h);
+}
+
+TEST_FIXTURE(BreakpointManagerTest, ManyBreakpoints)
+{
+    FastProcessorIntel8080 processor;
+    SetupProcessor(processor);
+    BreakpointManager breakpoints(memoryManager);
+    for (size_t address = 0x0100; address < RAMSize; ++address)
+        breakpoints.AddBreakpoint(address);
+    breakpoints.AddBreakpoint(0x000F);
+    EXPECT_EQ(RAMSize - 0x0100 + 1, breakpoints.BreakpointCount());
+
+    processor.Run(size_t{ 100000 });
+    EXPECT_TRUE(breakpoints.HasStopped());
+    EXPECT_EQ(0x000F, processor.GetRegisters().pc);
+    EXPECT_EQ(0x05, processor.GetRegisters().bc.B.h);
+
+    breakpoints.Clear();
+    EXPECT_EQ(size_t{ 0 }, breakpoints.BreakpointCount());
+    EXPECT_FALSE(memoryManager->HasTraps());
+}
+
+TEST_FIXTURE(BreakpointManagerTest, WriteWatchpoint)
+{
+    ProcessorIntel8080 processor;
+    SetupProcessor(processor);
+    BreakpointManager breakpoints(memoryManager);
+    WatchpointID id = breakpoints.AddWatchpoint(0x0400, 0x0400, MemoryAccess::Write, 0x03, 0x04);
+
+    // Stops after the store, before the next instruction
+    processor.Run(size_t{ 100000 });
+    EXPECT_TRUE(breakpoints.HasStopped());
+    BreakpointStop stop = breakpoints.GetStop();
+    EXPECT_EQ(size_t{ 0x000A }, stop.pc);
+    EXPECT_EQ(size_t{ 0x0400 }, stop.address);
+    EXPECT_TRUE(MemoryAccess::Write == stop.access);
+    EXPECT_EQ(0x03, stop.data);
+    EXPECT_EQ(id, stop.watchpoint);
+    EXPECT_EQ(0x000A, processor.GetRegisters().pc);
+    EXPECT_EQ(0x03, memoryManager->Fetch8(0x0400));
+    // Execution traps are back to the breakpoints only
+    EXPECT_TRUE(MemoryAccess::None == memoryManager->GetTraps(0x0000));
+
+    breakpoints.ClearStop();
+    processor.Run(size_t{ 100000 });
+    EXPECT_EQ(0x04, breakpoints.GetStop().data);
+
+    breakpoints.ClearStop();
+    processor.Run(size_t{ 100000 });
+    EXPECT_FALSE(breakpoints.HasStopped());
+    EXPECT_TRUE(processor.GetRegisters().isHalted);
+    EXPECT_TRUE(breakpoints.RemoveWatchpoint(id));
+    EXPECT_FALSE(breakpoints.RemoveWatchpoint(id));
+}
+
+TEST_FIXTURE(BreakpointManagerTest, ReadWatchpoint)
+{
+    FastProcessorIntel8080 processor;
+    SetupProcessor(processor);
+    BreakpointManager breakpoints(memoryManager);
+    breakpoints.AddWatchpoint(0x0400, 0x04FF, MemoryAccess::Read);
+
+    processor.Run();
+    EXPECT_TRUE(breakpoints.HasStopped());
+    EXPECT_EQ(size_t{ 0x0012 }, breakpoints.GetStop().pc);
+    EXPECT_TRUE(MemoryAccess::Read == breakpoints.GetStop().access);
+    EXPECT_EQ(0x05, breakpoints.GetStop().data);
+    EXPECT_EQ(0x05, processor.GetRegisters().a);
+    EXPECT_FALSE(processor.GetRegisters().isHalted);
+}
+
+TEST_FIXTURE(BreakpointManagerTest, TranslatingEngines)
+{
+    // Engines running translated code fall back to the handlers while traps are set
+    CachedProcessorIntel8080 cached;
+    JitProcessorIntel8080 jit;
+    jit.SetHotThreshold(1);
+    ProcessorIntel8080 * processors[] = { &cached, &jit };
+    for (auto processor : processors)
+    {
+        SetUp();
+        SetupProcessor(*processor);
+        BreakpointManager breakpoints(memoryManager);
+        breakpoints.AddBreakpoint(0x000C);
+        processor->Run();
+        EXPECT_EQ(0x000C, processor->GetRegisters().pc);
+        EXPECT_EQ(0x01, processor->GetRegisters().bc.B.h);
+        processor->Run(size_t{ 100000 });
+        EXPECT_EQ(0x000C, processor->GetRegisters().pc);
+        EXPECT_EQ(0x02, processor->GetRegisters().bc.B.h);
+        breakpoints.Clear();
+        processor->Run();
+        EXPECT_TRUE(processor->GetRegisters().isHalted);
+        EXPECT_EQ(0x05, processor->GetRegisters().a);
+    }
+}
+
+TEST_FIXTURE(BreakpointManagerTest, Destruct)
+{
+    {
+        BreakpointManager breakpoints(memoryManager);
+        breakpoints.AddBreakpoint(0x0000);
+        breakpoints.AddWatchpoint(0x0400, 0x0400, MemoryAccess::Read | MemoryAccess::Write);
+        EXPECT_TRUE(memoryManager->HasTraps());
+    }
+    EXPECT_FALSE(memoryManager->HasTraps());
+    EXPECT_EQ(ram->Data(), memoryManager->GetPage(0x0000).read);
+    EXPECT_EQ(ram->Data() + 0x0400, memoryManager->GetPage(0x0400).write);
+}
+
+} // namespace Test
+
+} // namespace Emulator
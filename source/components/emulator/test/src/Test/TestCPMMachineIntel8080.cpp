@@ -0,0 +1,483 @@
+#include "unit-test-c++/UnitTestC++.h"
+
+#include <sstream>
+#include "core/Path.h"
+#include "emulator/CPMMachineIntel8080.h"
+#include "emulator/CachedProcessorIntel8080.h"
+#include "emulator/JitProcessorIntel8080.h"
+#include "emulator/RecompiledProcessorIntel8080.h"
+
+using namespace std;
+
+namespace Emulator
+{
+
+namespace Test
+{
+
+class CPMMachineIntel8080Test : public UnitTestCpp::TestFixture
+{
+public:
+	virtual void SetUp();
+	virtual void TearDown();
+
+    static const vector<uint8_t> HelloProgram;
+    static const uint16_t Results = 0x0300;
+
+    string directory;
+    vector<string> testFiles;
+
+    string TestFile(string const & name);
+    void WriteTestFile(string const & name, vector<uint8_t> const & data);
+    static void AssertHello(ProcessorIntel8080 & processor);
+};
+
+const vector<uint8_t> CPMMachineIntel8080Test::HelloProgram =
+{
+    0x0E, 0x09,         // 0100 MVI C,09
+    0x11, 0x09, 0x01,   // 0102 LXI D,MESSAGE
+    0xCD, 0x05, 0x00,   // 0105 CALL BDOS
+    0xC9,               // 0108 RET
+    'H', 'e', 'l', 'l', 'o', '\r', '\n', '$',  // 0109 MESSAGE
+};
+
+void CPMMachineIntel8080Test::SetUp()
+{
+    directory = Core::Path::CombinePath(OSAL::Tmpdir(), "cpm-test");
+    Core::Path::MakeSureDirectoryExists(directory);
+}
+
+void CPMMachineIntel8080Test::TearDown()
+{
+    for (auto const & path : testFiles)
+        Core::Path::MakeSureFileDoesNotExist(path);
+}
+
+string CPMMachineIntel8080Test::TestFile(string const & name)
+{
+    string path = Core::Path::CombinePath(directory, name);
+    Core::Path::MakeSureFileDoesNotExist(path);
+    testFiles.push_back(path);
+    return path;
+}
+
+void CPMMachineIntel8080Test::WriteTestFile(string const & name, vector<uint8_t> const & data)
+{
+    ofstream file(TestFile(name), ios::binary);
+    file.write(reinterpret_cast<char const *>(data.data()), streamsize(data.size()));
+}
+
+void CPMMachineIntel8080Test::AssertHello(ProcessorIntel8080 & processor)
+{
+    istringstream input;
+    ostringstream output;
+    CPMMachineIntel8080 machine(processor, input, output);
+    machine.Load(HelloProgram);
+    EXPECT_TRUE(machine.Run());
+    EXPECT_TRUE(machine.HasExited());
+    EXPECT_EQ("Hello\r\n", output.str());
+    EXPECT_EQ(size_t{ 1 }, machine.BDOSCallCount());
+
+    // Run again
+    output.str("");
+    machine.Load(HelloProgram);
+    EXPECT_TRUE(machine.Run());
+    EXPECT_EQ("Hello\r\n", output.str());
+}
+
+TEST_FIXTURE(CPMMachineIntel8080Test, Construct)
+{
+    istringstream input;
+    ostringstream output;
+    FastProcessorIntel8080 processor;
+    CPMMachineIntel8080 machine(processor, input, output);
+    EXPECT_FALSE(machine.HasExited());
+    EXPECT_EQ(".", machine.GetDrive(0));
+    EXPECT_EQ("", machine.GetDrive(1));
+    EXPECT_THROW(machine.SetDrive(CPMMachineIntel8080::DriveCount, "."), std::runtime_error);
+    EXPECT_THROW(machine.Load(vector<uint8_t>(CPMMachineIntel8080::BDOSBase)), std::runtime_error);
+}
+
+TEST_FIXTURE(CPMMachineIntel8080Test, Load)
+{
+    istringstream input;
+    ostringstream output;
+    FastProcessorIntel8080 processor;
+    CPMMachineIntel8080 machine(processor, input, output);
+    machine.Load(HelloProgram, "b:file.txt *.com");
+    uint8_t const * memory = machine.GetRAM()->Data();
+    EXPECT_EQ(0xC3, memory[0x0000]);
+    EXPECT_EQ(CPMMachineIntel8080::BIOSBase + 3, memory[0x0001] | (memory[0x0002] << 8));
+    EXPECT_EQ(0xC3, memory[0x0005]);
+    EXPECT_EQ(CPMMachineIntel8080::BDOSBase + 6, memory[0x0006] | (memory[0x0007] << 8));
+    EXPECT_EQ(0x0E, memory[0x0100]);
+    EXPECT_EQ(" B:FILE.TXT *.COM", string(reinterpret_cast<char const *>(memory + 0x0081), memory[0x0080]));
+    EXPECT_EQ(2, memory[0x005C]);
+    EXPECT_EQ("FILE    TXT", string(reinterpret_cast<char const *>(memory + 0x005D), 11));
+    EXPECT_EQ(0, memory[0x006C]);
+    EXPECT_EQ("????????COM", string(reinterpret_cast<char const *>(memory + 0x006D), 11));
+    EXPECT_EQ(0x0100, processor.GetRegisters().pc);
+    EXPECT_EQ(CPMMachineIntel8080::BDOSBase - 2, processor.GetRegisters().sp.W);
+}
+
+TEST_FIXTURE(CPMMachineIntel8080Test, HelloProcessorIntel8080)
+{
+    ProcessorIntel8080 processor;
+    AssertHello(processor);
+}
+
+TEST_FIXTURE(CPMMachineIntel8080Test, HelloFastProcessorIntel8080)
+{
+    FastProcessorIntel8080 processor;
+    AssertHello(processor);
+}
+
+TEST_FIXTURE(CPMMachineIntel8080Test, HelloCachedProcessorIntel8080)
+{
+    CachedProcessorIntel8080 processor;
+    AssertHello(processor);
+}
+
+TEST_FIXTURE(CPMMachineIntel8080Test, HelloJitProcessorIntel8080)
+{
+    JitProcessorIntel8080 processor;
+    processor.SetHotThreshold(1);
+    AssertHello(processor);
+}
+
+TEST_FIXTURE(CPMMachineIntel8080Test, HelloRecompiledProcessorIntel8080)
+{
+    RecompiledProcessorIntel8080 processor;
+    AssertHello(processor);
+}
+
+TEST_FIXTURE(CPMMachineIntel8080Test, SystemReset)
+{
+    istringstream input;
+    ostringstream output;
+    FastProcessorIntel8080 processor;
+    CPMMachineIntel8080 machine(processor, input, output);
+    // MVI C,00; CALL BDOS; HLT
+    machine.Load({ 0x0E, 0x00, 0xCD, 0x05, 0x00, 0x76 });
+    EXPECT_TRUE(machine.Run());
+    EXPECT_TRUE(processor.GetRegisters().isHalted);
+
+    // HLT does not return to CP/M
+    machine.Load({ 0x76 });
+    EXPECT_FALSE(machine.Run());
+    EXPECT_TRUE(processor.GetRegisters().isHalted);
+
+    // Budget exhausted: JMP 0100
+    machine.Load({ 0xC3, 0x00, 0x01 });
+    EXPECT_FALSE(machine.Run(1000));
+    EXPECT_FALSE(processor.GetRegisters().isHalted);
+}
+
+TEST_FIXTURE(CPMMachineIntel8080Test, Console)
+{
+    const vector<uint8_t> program =
+    {
+        0x3E, 0x0A,         // 0100 MVI A,10
+        0x32, 0x00, 0x02,   // 0102 STA BUFFER
+        0x0E, 0x0A,         // 0105 MVI C,0A
+        0x11, 0x00, 0x02,   // 0107 LXI D,BUFFER
+        0xCD, 0x05, 0x00,   // 010A CALL BDOS
+        0x3A, 0x01, 0x02,   // 010D LDA BUFFER+1
+        0x6F,               // 0110 MOV L,A
+        0x26, 0x02,         // 0111 MVI H,02
+        0x23,               // 0113 INX H
+        0x23,               // 0114 INX H
+        0x36, 0x24,         // 0115 MVI M,'$'
+        0x0E, 0x09,         // 0117 MVI C,09
+        0x11, 0x02, 0x02,   // 0119 LXI D,BUFFER+2
+        0xCD, 0x05, 0x00,   // 011C CALL BDOS
+        0x0E, 0x01,         // 011F MVI C,01
+        0xCD, 0x05, 0x00,   // 0121 CALL BDOS
+        0x32, 0x00, 0x03,   // 0124 STA RESULTS
+        0x0E, 0x01,         // 0127 MVI C,01
+        0xCD, 0x05, 0x00,   // 0129 CALL BDOS
+        0x32, 0x01, 0x03,   // 012C STA RESULTS+1
+        0xC3, 0x00, 0x00,   // 012F JMP 0000
+    };
+    istringstream input("hi there\nX");
+    ostringstream output;
+    FastProcessorIntel8080 processor;
+    CPMMachineIntel8080 machine(processor, input, output);
+    machine.Load(program);
+    EXPECT_TRUE(machine.Run());
+    EXPECT_EQ("hi there\rhi thereX", output.str());
+    uint8_t const * memory = machine.GetRAM()->Data();
+    EXPECT_EQ(8, memory[0x0201]);
+    EXPECT_EQ('X', memory[Results]);
+    // End of input
+    EXPECT_EQ(0x1A, memory[Results + 1]);
+
+    // A full buffer ends the line
+    input.clear();
+    input.str("0123456789abc\n");
+    output.str("");
+    machine.Load(program);
+    EXPECT_TRUE(machine.Run());
+    EXPECT_EQ("0123456789\r0123456789ab", output.str());
+}
+
+TEST_FIXTURE(CPMMachineIntel8080Test, WriteSequential)
+{
+    const vector<uint8_t> program =
+    {
+        0x0E, 0x16, 0x11, 0x5C, 0x00, 0xCD, 0x05, 0x00,     // 0100 Make file
+        0x32, 0x00, 0x03,                                   // 0108 STA RESULTS
+        0x0E, 0x15, 0x11, 0x5C, 0x00, 0xCD, 0x05, 0x00,     // 010B Write sequential
+        0x32, 0x01, 0x03,                                   // 0113 STA RESULTS+1
+        0x0E, 0x15, 0x11, 0x5C, 0x00, 0xCD, 0x05, 0x00,     // 0116 Write sequential
+        0x32, 0x02, 0x03,                                   // 011E STA RESULTS+2
+        0x0E, 0x10, 0x11, 0x5C, 0x00, 0xCD, 0x05, 0x00,     // 0121 Close file
+        0x32, 0x03, 0x03,                                   // 0129 STA RESULTS+3
+        0xC3, 0x00, 0x00,                                   // 012C JMP 0000
+    };
+    string path = TestFile("OUT.DAT");
+    istringstream input;
+    ostringstream output;
+    FastProcessorIntel8080 processor;
+    CPMMachineIntel8080 machine(processor, input, output);
+    machine.SetDrive(1, directory);
+    machine.Load(program, "B:OUT.DAT");
+    EXPECT_TRUE(machine.Run());
+    uint8_t const * memory = machine.GetRAM()->Data();
+    EXPECT_EQ(0, memory[Results]);
+    EXPECT_EQ(0, memory[Results + 1]);
+    EXPECT_EQ(0, memory[Results + 2]);
+    EXPECT_EQ(0, memory[Results + 3]);
+    EXPECT_EQ(2, memory[0x005C + 32]);
+
+    ifstream file(path, ios::binary);
+    vector<uint8_t> contents((istreambuf_iterator<char>(file)), istreambuf_iterator<char>());
+    ASSERT_EQ(size_t{ 256 }, contents.size());
+    // Both records are the command tail at the DMA address
+    EXPECT_EQ(10, contents[0]);
+    EXPECT_EQ('B', contents[2]);
+    EXPECT_EQ(10, contents[128]);
+}
+
+TEST_FIXTURE(CPMMachineIntel8080Test, ReadSequential)
+{
+    const vector<uint8_t> program =
+    {
+        0x0E, 0x0F, 0x11, 0x5C, 0x00, 0xCD, 0x05, 0x00,     // 0100 Open file
+        0x32, 0x00, 0x03,                                   // 0108 STA RESULTS
+        0x0E, 0x14, 0x11, 0x5C, 0x00, 0xCD, 0x05, 0x00,     // 010B Read sequential
+        0x32, 0x01, 0x03,                                   // 0113 STA RESULTS+1
+        0x0E, 0x14, 0x11, 0x5C, 0x00, 0xCD, 0x05, 0x00,     // 0116 Read sequential
+        0x32, 0x02, 0x03,                                   // 011E STA RESULTS+2
+        0x0E, 0x14, 0x11, 0x5C, 0x00, 0xCD, 0x05, 0x00,     // 0121 Read sequential
+        0x32, 0x03, 0x03,                                   // 0129 STA RESULTS+3
+        0x0E, 0x23, 0x11, 0x5C, 0x00, 0xCD, 0x05, 0x00,     // 012C Compute file size
+        0xC3, 0x00, 0x00,                                   // 0134 JMP 0000
+    };
+    vector<uint8_t> data(200);
+    for (size_t index = 0; index < data.size(); ++index)
+        data[index] = uint8_t(index);
+    // Names are matched case insensitively
+    WriteTestFile("data.txt", data);
+    istringstream input;
+    ostringstream output;
+    FastProcessorIntel8080 processor;
+    CPMMachineIntel8080 machine(processor, input, output);
+    machine.SetDrive(0, directory);
+    machine.Load(program, "DATA.TXT");
+    EXPECT_TRUE(machine.Run());
+    uint8_t const * memory = machine.GetRAM()->Data();
+    EXPECT_EQ(0, memory[Results]);
+    EXPECT_EQ(0, memory[Results + 1]);
+    EXPECT_EQ(0, memory[Results + 2]);
+    EXPECT_EQ(1, memory[Results + 3]);
+    // The partial last record is padded with ^Z
+    EXPECT_EQ(128, memory[0x0080]);
+    EXPECT_EQ(199, memory[0x0080 + 71]);
+    EXPECT_EQ(0x1A, memory[0x0080 + 72]);
+    EXPECT_EQ(0x1A, memory[0x00FF]);
+    // Record count and current record, random record from the file size
+    EXPECT_EQ(2, memory[0x005C + 15]);
+    EXPECT_EQ(2, memory[0x005C + 32]);
+    EXPECT_EQ(2, memory[0x005C + 33]);
+
+    // Missing file
+    machine.Load(program, "NONE.TXT");
+    EXPECT_TRUE(machine.Run());
+    EXPECT_EQ(0xFF, memory[Results]);
+    EXPECT_EQ(1, memory[Results + 1]);
+}
+
+TEST_FIXTURE(CPMMachineIntel8080Test, RandomAccess)
+{
+    const vector<uint8_t> program =
+    {
+        0x0E, 0x16, 0x11, 0x5C, 0x00, 0xCD, 0x05, 0x00,     // 0100 Make file
+        0x21, 0x03, 0x00,                                   // 0108 LXI H,3
+        0x22, 0x7D, 0x00,                                   // 010B SHLD FCB+33
+        0x0E, 0x22, 0x11, 0x5C, 0x00, 0xCD, 0x05, 0x00,     // 010E Write random
+        0x32, 0x00, 0x03,                                   // 0116 STA RESULTS
+        0x21, 0x01, 0x00,                                   // 0119 LXI H,1
+        0x22, 0x7D, 0x00,                                   // 011C SHLD FCB+33
+        0x0E, 0x21, 0x11, 0x5C, 0x00, 0xCD, 0x05, 0x00,     // 011F Read random, unwritten record reads as zeros
+        0x32, 0x01, 0x03,                                   // 0127 STA RESULTS+1
+        0x21, 0x04, 0x00,                                   // 012A LXI H,4
+        0x22, 0x7D, 0x00,                                   // 012D SHLD FCB+33
+        0x0E, 0x21, 0x11, 0x5C, 0x00, 0xCD, 0x05, 0x00,     // 0130 Read random, past the end
+        0x32, 0x02, 0x03,                                   // 0138 STA RESULTS+2
+        0x0E, 0x10, 0x11, 0x5C, 0x00, 0xCD, 0x05, 0x00,     // 013B Close file
+        0xC3, 0x00, 0x00,                                   // 0143 JMP 0000
+    };
+    string path = TestFile("RANDOM.DAT");
+    istringstream input;
+    ostringstream output;
+    FastProcessorIntel8080 processor;
+    CPMMachineIntel8080 machine(processor, input, output);
+    machine.SetDrive(0, directory);
+    machine.Load(program, "RANDOM.DAT");
+    EXPECT_TRUE(machine.Run());
+    uint8_t const * memory = machine.GetRAM()->Data();
+    EXPECT_EQ(0, memory[Results]);
+    EXPECT_EQ(0, memory[Results + 1]);
+    EXPECT_EQ(1, memory[Results + 2]);
+    EXPECT_EQ(0, memory[0x0080]);
+    EXPECT_EQ(1, memory[0x005C + 32]);
+    EXPECT_EQ(size_t{ 512 }, ifstream(path, ios::binary | ios::ate).tellg());
+}
+
+TEST_FIXTURE(CPMMachineIntel8080Test, MixedAccess)
+{
+    const vector<uint8_t> program =
+    {
+        0x0E, 0x16, 0x11, 0x5C, 0x00, 0xCD, 0x05, 0x00,     // 0100 Make file
+        0x32, 0x00, 0x03,                                   // 0108 STA RESULTS
+        0x21, 0x80, 0x00,                                   // 010B LXI H,0080
+        0x34,                                               // 010E INR M, every record differs
+        0x0E, 0x15, 0x11, 0x5C, 0x00, 0xCD, 0x05, 0x00,     // 010F Write sequential
+        0x21, 0x80, 0x00,                                   // 0117 LXI H,0080
+        0x34,                                               // 011A INR M
+        0x0E, 0x15, 0x11, 0x5C, 0x00, 0xCD, 0x05, 0x00,     // 011B Write sequential
+        0x21, 0x80, 0x00,                                   // 0123 LXI H,0080
+        0x34,                                               // 0126 INR M
+        0x0E, 0x15, 0x11, 0x5C, 0x00, 0xCD, 0x05, 0x00,     // 0127 Write sequential
+        0x32, 0x01, 0x03,                                   // 012F STA RESULTS+1
+        0x21, 0x01, 0x00,                                   // 0132 LXI H,1
+        0x22, 0x7D, 0x00,                                   // 0135 SHLD FCB+33
+        0x0E, 0x21, 0x11, 0x5C, 0x00, 0xCD, 0x05, 0x00,     // 0138 Read random, back to record 1 after writing
+        0x32, 0x02, 0x03,                                   // 0140 STA RESULTS+2
+        0x0E, 0x14, 0x11, 0x5C, 0x00, 0xCD, 0x05, 0x00,     // 0143 Read sequential, record 1 again
+        0x32, 0x03, 0x03,                                   // 014B STA RESULTS+3
+        0x3A, 0x80, 0x00,                                   // 014E LDA 0080
+        0x32, 0x04, 0x03,                                   // 0151 STA RESULTS+4
+        0x0E, 0x14, 0x11, 0x5C, 0x00, 0xCD, 0x05, 0x00,     // 0154 Read sequential, record 2
+        0x32, 0x05, 0x03,                                   // 015C STA RESULTS+5
+        0x0E, 0x14, 0x11, 0x5C, 0x00, 0xCD, 0x05, 0x00,     // 015F Read sequential, past the end
+        0x32, 0x06, 0x03,                                   // 0167 STA RESULTS+6
+        0x0E, 0x23, 0x11, 0x5C, 0x00, 0xCD, 0x05, 0x00,     // 016A Compute file size
+        0xC3, 0x00, 0x00,                                   // 0172 JMP 0000
+    };
+    string path = TestFile("MIXED.DAT");
+    istringstream input;
+    ostringstream output;
+    FastProcessorIntel8080 processor;
+    CPMMachineIntel8080 machine(processor, input, output);
+    machine.SetDrive(0, directory);
+    machine.Load(program, "MIXED.DAT");
+    EXPECT_TRUE(machine.Run());
+    uint8_t const * memory = machine.GetRAM()->Data();
+    EXPECT_EQ(0, memory[Results]);
+    EXPECT_EQ(0, memory[Results + 1]);
+    EXPECT_EQ(0, memory[Results + 2]);
+    EXPECT_EQ(0, memory[Results + 3]);
+    // The command tail " MIXED.DAT" has 10 characters, incremented before every write
+    EXPECT_EQ(12, memory[Results + 4]);
+    EXPECT_EQ(0, memory[Results + 5]);
+    EXPECT_EQ(13, memory[0x0080]);
+    EXPECT_EQ(1, memory[Results + 6]);
+    EXPECT_EQ(3, memory[0x005C + 33]);
+
+    ifstream file(path, ios::binary);
+    vector<uint8_t> contents((istreambuf_iterator<char>(file)), istreambuf_iterator<char>());
+    ASSERT_EQ(size_t{ 384 }, contents.size());
+    EXPECT_EQ(11, contents[0]);
+    EXPECT_EQ(12, contents[128]);
+    EXPECT_EQ(13, contents[256]);
+
+    // The drive is listed again for the next program, so it finds a file added in between
+    const vector<uint8_t> open =
+    {
+        0x0E, 0x0F, 0x11, 0x5C, 0x00, 0xCD, 0x05, 0x00,     // 0100 Open file
+        0x32, 0x00, 0x03,                                   // 0108 STA RESULTS
+        0xC3, 0x00, 0x00,                                   // 010B JMP 0000
+    };
+    WriteTestFile("late.txt", vector<uint8_t>(10));
+    machine.Load(open, "LATE.TXT");
+    EXPECT_TRUE(machine.Run());
+    EXPECT_EQ(0, memory[Results]);
+}
+
+TEST_FIXTURE(CPMMachineIntel8080Test, SearchDelete)
+{
+    const vector<uint8_t> program =
+    {
+        0x0E, 0x11, 0x11, 0x5C, 0x00, 0xCD, 0x05, 0x00,     // 0100 Search for first
+        0x32, 0x00, 0x03,                                   // 0108 STA RESULTS
+        0x0E, 0x12, 0xCD, 0x05, 0x00,                       // 010B Search for next
+        0x32, 0x01, 0x03,                                   // 0110 STA RESULTS+1
+        0x0E, 0x12, 0xCD, 0x05, 0x00,                       // 0113 Search for next
+        0x32, 0x02, 0x03,                                   // 0118 STA RESULTS+2
+        0x0E, 0x13, 0x11, 0x5C, 0x00, 0xCD, 0x05, 0x00,     // 011B Delete file
+        0x32, 0x03, 0x03,                                   // 0123 STA RESULTS+3
+        0xC3, 0x00, 0x00,                                   // 0126 JMP 0000
+    };
+    WriteTestFile("a.dat", vector<uint8_t>(300));
+    WriteTestFile("B.DAT", vector<uint8_t>(10));
+    WriteTestFile("c.txt", vector<uint8_t>(10));
+    WriteTestFile("long-name.dat", vector<uint8_t>(10));
+    istringstream input;
+    ostringstream output;
+    FastProcessorIntel8080 processor;
+    CPMMachineIntel8080 machine(processor, input, output);
+    machine.SetDrive(0, directory);
+    machine.Load(program, "*.DAT");
+    EXPECT_TRUE(machine.Run());
+    uint8_t const * memory = machine.GetRAM()->Data();
+    EXPECT_EQ(0, memory[Results]);
+    EXPECT_EQ(0, memory[Results + 1]);
+    EXPECT_EQ(0xFF, memory[Results + 2]);
+    EXPECT_EQ(0, memory[Results + 3]);
+    EXPECT_EQ("B       DAT", string(reinterpret_cast<char const *>(memory + 0x0081), 11));
+    EXPECT_EQ(1, memory[0x0080 + 15]);
+    EXPECT_EQ(0xE5, memory[0x0080 + 32]);
+
+    EXPECT_FALSE(Core::Path::FileExists(Core::Path::CombinePath(directory, "a.dat")));
+    EXPECT_FALSE(Core::Path::FileExists(Core::Path::CombinePath(directory, "B.DAT")));
+    EXPECT_TRUE(Core::Path::FileExists(Core::Path::CombinePath(directory, "c.txt")));
+    EXPECT_TRUE(Core::Path::FileExists(Core::Path::CombinePath(directory, "long-name.dat")));
+}
+
+TEST_FIXTURE(CPMMachineIntel8080Test, Rename)
+{
+    const vector<uint8_t> program =
+    {
+        0x0E, 0x17, 0x11, 0x5C, 0x00, 0xCD, 0x05, 0x00,     // 0100 Rename file, FCB+16 holds the new name
+        0x32, 0x00, 0x03,                                   // 0108 STA RESULTS
+        0xC3, 0x00, 0x00,                                   // 010B JMP 0000
+    };
+    WriteTestFile("old.txt", vector<uint8_t>(10));
+    string path = TestFile("NEW.TXT");
+    istringstream input;
+    ostringstream output;
+    FastProcessorIntel8080 processor;
+    CPMMachineIntel8080 machine(processor, input, output);
+    machine.SetDrive(0, directory);
+    machine.Load(program, "OLD.TXT NEW.TXT");
+    EXPECT_TRUE(machine.Run());
+    EXPECT_EQ(0, machine.GetRAM()->Data()[Results]);
+    EXPECT_TRUE(Core::Path::FileExists(path));
+    EXPECT_FALSE(Core::Path::FileExists(Core::Path::CombinePath(directory, "old.txt")));
+}
+
+} // namespace Test
+
+} // namespace Emulator
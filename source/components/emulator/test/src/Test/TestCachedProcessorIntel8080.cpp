@@ -0,0 +1,334 @@
+#include "unit-test-c++/UnitTestC++.h"
+
+#include "emulator/CachedProcessorIntel8080.h"
+#include "TestMachineIntel8080.h"
+
+using namespace std;
+
+namespace Emulator
+{
+
+namespace Test
+{
+
+class CachedProcessorIntel8080Test : public UnitTestCpp::TestFixture, public TestMachineIntel8080
+{
+public:
+	virtual void SetUp();
+	virtual void TearDown();
+
+    MemoryManagerPtr memoryManager;
+    ROMPtr rom;
+    RAMPtr ram;
+    IOManagerPtr ioManager;
+    IOPortPtr ioPort;
+};
+
+void CachedProcessorIntel8080Test::SetUp()
+{
+    memoryManager = std::make_shared<MemoryManager>();
+    rom = std::make_shared<ROM>(Origin, ROMSize);
+    ram = std::make_shared<RAM>(RAMOrigin, RAMSize);
+    memoryManager->AddMemory(rom);
+    memoryManager->AddMemory(ram);
+    ioManager = std::make_shared<IOManager>();
+    ioPort = std::make_shared<IOPort>(IOOrigin, IOSize);
+    ioManager->AddIO(ioPort);
+}
+
+void CachedProcessorIntel8080Test::TearDown()
+{
+}
+
+TEST_FIXTURE(CachedProcessorIntel8080Test, Construct)
+{
+    CachedProcessorIntel8080 processor;
+    BlockCacheStatistics const & statistics = processor.GetStatistics();
+    EXPECT_EQ(size_t{ 0 }, processor.CachedBlockCount());
+    EXPECT_EQ(size_t{ 0 }, statistics.lookups);
+    EXPECT_EQ(size_t{ 0 }, statistics.hits);
+    EXPECT_EQ(size_t{ 0 }, statistics.translations);
+    EXPECT_EQ(size_t{ 0 }, statistics.invalidations);
+    EXPECT_EQ(0.0, statistics.HitRate());
+}
+
+TEST_FIXTURE(CachedProcessorIntel8080Test, RunMultiply)
+{
+    vector<uint8_t> const & code = Multiply3x7();
+    ProcessorIntel8080 reference;
+    reference.Setup(memoryManager, ioManager);
+    reference.LoadCode(code, Origin, rom);
+    reference.Run();
+    CachedProcessorIntel8080 processor;
+    processor.Setup(memoryManager, ioManager);
+    processor.LoadCode(code, Origin, rom);
+    processor.Run();
+
+    RegistersIntel8080 & expected = reference.GetRegisters();
+    RegistersIntel8080 & registers = processor.GetRegisters();
+    EXPECT_TRUE(registers.isHalted);
+    EXPECT_EQ(0x001A, registers.pc);
+    EXPECT_EQ(expected.bc.W, registers.bc.W);
+    EXPECT_EQ(expected.de.W, registers.de.W);
+    EXPECT_EQ(expected.a, registers.a);
+    EXPECT_EQ(expected.flags, registers.flags);
+
+    BlockCacheStatistics const & statistics = processor.GetStatistics();
+    EXPECT_EQ(size_t{ 6 }, statistics.translations);
+    EXPECT_EQ(size_t{ 6 }, processor.CachedBlockCount());
+    EXPECT_EQ(statistics.lookups, statistics.hits + statistics.translations);
+    EXPECT_EQ(size_t{ 0 }, statistics.invalidations);
+    EXPECT_TRUE(statistics.HitRate() > 0.5);
+}
+
+TEST_FIXTURE(CachedProcessorIntel8080Test, RunBudgetPeriodic)
+{
+    CachedProcessorIntel8080 processor;
+    processor.Setup(memoryManager, ioManager);
+    processor.LoadCode(
+    {
+        0x00,               // 0000 NOP
+        0x00,               // 0001 NOP
+        0xC3, 0x00, 0x00,   // 0002 JMP 0000
+    }, Origin, rom);
+    size_t calls = 0;
+    processor.SetupLoop([&calls](RegistersIntel8080 &) { ++calls; return InterruptFlagsIntel8080::None; });
+    RegistersIntel8080 & registers = processor.GetRegisters();
+    registers.cycleCountPeriod = 180;
+    registers.cycleCount = 180;
+    // A block takes 18 cycles
+    EXPECT_EQ(size_t{ 1800 }, processor.Run(1800));
+    EXPECT_EQ(size_t{ 10 }, calls);
+    EXPECT_EQ(180, registers.cycleCount);
+    // Budget is checked at the end of the block
+    EXPECT_EQ(size_t{ 18 }, processor.Run(1));
+    EXPECT_EQ(size_t{ 1818 }, registers.cycleCountTotal);
+}
+
+TEST_FIXTURE(CachedProcessorIntel8080Test, RunScheduledInterrupt)
+{
+    CachedProcessorIntel8080 processor;
+    processor.Setup(memoryManager, ioManager);
+    processor.LoadCode(
+    {
+        0x31, 0x00, 0x08,   // 0000 LXI SP,0800
+        0xFB,               // 0003 EI
+        0x00,               // 0004 NOP
+        0xC3, 0x05, 0x00,   // 0005 JMP 0005
+        0x3E, 0x55,         // 0008 MVI A,55
+        0x76,               // 000A HLT
+    }, Origin, rom);
+    processor.GetScheduler().Schedule(100, [&processor](uint64_t) { processor.GetInterruptController().Request(1); });
+    processor.Run(size_t{ 10000 });
+
+    // Delivered at the end of the first block running past the deadline
+    RegistersIntel8080 & registers = processor.GetRegisters();
+    EXPECT_TRUE(registers.isHalted);
+    EXPECT_EQ(0x55, registers.a);
+    EXPECT_EQ(0x0005, memoryManager->Fetch16(0x07FE));
+    EXPECT_EQ(uint64_t{ 10 + 4 + 4 + 9 * 10 + 7 + 7 }, registers.cycleCountTotal);
+}
+
+TEST_FIXTURE(CachedProcessorIntel8080Test, RunIdleSkipping)
+{
+    CachedProcessorIntel8080 processor;
+    processor.Setup(memoryManager, ioManager);
+    processor.LoadCode(
+    {
+        0x31, 0x00, 0x08,   // 0000 LXI SP,0800
+        0xDB, 0x10,         // 0003 LOOP: IN 10
+        0xE6, 0x01,         // 0005 ANI 01
+        0xCA, 0x03, 0x00,   // 0007 JZ LOOP
+        0x76,               // 000A HLT
+    }, Origin, rom);
+    processor.SetIdleSkipping(true);
+    processor.GetScheduler().Schedule(1000, [this](uint64_t) { ioManager->Out8(0x10, 0x01); });
+    processor.Run(size_t{ 10000 });
+
+    // Run(budget) runs the handlers of FastProcessorIntel8080 to find idle loops, the cache is not used
+    RegistersIntel8080 & registers = processor.GetRegisters();
+    EXPECT_TRUE(registers.isHalted);
+    EXPECT_EQ(0x01, registers.a);
+    EXPECT_EQ(size_t{ 1 }, processor.GetIdleStatistics().loopSkips);
+    EXPECT_EQ(size_t{ 0 }, processor.CachedBlockCount());
+    EXPECT_EQ(size_t{ 0 }, processor.GetStatistics().lookups);
+}
+
+TEST_FIXTURE(CachedProcessorIntel8080Test, RunScheduledInterruptWakesHalted)
+{
+    CachedProcessorIntel8080 processor;
+    processor.Setup(memoryManager, ioManager);
+    processor.LoadCode(
+    {
+        0x31, 0x00, 0x08,   // 0000 LXI SP,0800
+        0xFB,               // 0003 EI
+        0x76,               // 0004 HLT
+        0x00, 0x00, 0x00,
+        0x3E, 0x55,         // 0008 MVI A,55
+        0x76,               // 000A HLT
+    }, Origin, rom);
+    processor.GetScheduler().Schedule(1000, [&processor](uint64_t) { processor.GetInterruptController().Request(1); });
+    for (int slice = 0; slice < 10; ++slice)
+    {
+        processor.Run(size_t{ 500 });
+    }
+
+    RegistersIntel8080 & registers = processor.GetRegisters();
+    EXPECT_TRUE(registers.isHalted);
+    EXPECT_EQ(0x55, registers.a);
+    EXPECT_EQ(0x0005, memoryManager->Fetch16(0x07FE));
+    EXPECT_EQ(uint64_t{ 1000 + 7 + 7 }, registers.cycleCountTotal);
+}
+
+TEST_FIXTURE(CachedProcessorIntel8080Test, RunPeriodicInterruptWakesHalted)
+{
+    CachedProcessorIntel8080 processor;
+    processor.Setup(memoryManager, ioManager);
+    processor.LoadCode(
+    {
+        0x31, 0x00, 0x08,   // 0000 LXI SP,0800
+        0xFB,               // 0003 EI
+        0x76,               // 0004 HLT
+        0x00, 0x00, 0x00,
+        0x3E, 0x55,         // 0008 MVI A,55
+        0x76,               // 000A HLT
+    }, Origin, rom);
+    size_t calls = 0;
+    processor.SetupLoop([&calls](RegistersIntel8080 &) { ++calls; return InterruptFlagsIntel8080(0x0008); });  // RST 1
+    RegistersIntel8080 & registers = processor.GetRegisters();
+    registers.cycleCountPeriod = 100;
+    registers.cycleCount = 100;
+    EXPECT_EQ(size_t{ 1000 }, processor.Run(1000));
+
+    EXPECT_TRUE(registers.isHalted);
+    EXPECT_EQ(0x55, registers.a);
+    EXPECT_EQ(0x0005, memoryManager->Fetch16(0x07FE));
+    EXPECT_EQ(size_t{ 10 }, calls);
+    EXPECT_EQ(uint64_t{ 1000 }, registers.cycleCountTotal);
+}
+
+TEST_FIXTURE(CachedProcessorIntel8080Test, SelfModifyingCode)
+{
+    CachedProcessorIntel8080 processor;
+    processor.Setup(memoryManager, ioManager);
+    processor.LoadCode({ 0xC3, 0x00, 0x01 }, Origin, rom);  // JMP 0100
+    processor.LoadData(
+    {
+        0x3E, 0x04,         // 0100 MVI A,04 (INR B)
+        0x32, 0x06, 0x01,   // 0102 STA 0106
+        0x00,               // 0105 NOP
+        0x00,               // 0106 NOP, overwritten with INR B
+        0x76,               // 0107 HLT
+    }, RAMOrigin, ram);
+    processor.Run();
+
+    RegistersIntel8080 & registers = processor.GetRegisters();
+    EXPECT_TRUE(registers.isHalted);
+    EXPECT_EQ(0x01, registers.bc.B.h);
+    EXPECT_EQ(size_t{ 1 }, processor.GetStatistics().invalidations);
+    EXPECT_EQ(size_t{ 3 }, processor.GetStatistics().translations);
+}
+
+TEST_FIXTURE(CachedProcessorIntel8080Test, StoreOutsideBlockKeepsCache)
+{
+    CachedProcessorIntel8080 processor;
+    processor.Setup(memoryManager, ioManager);
+    processor.LoadCode({ 0xC3, 0x00, 0x01 }, Origin, rom);  // JMP 0100
+    processor.LoadData(
+    {
+        0x3E, 0x04,         // 0100 MVI A,04
+        0x32, 0x80, 0x01,   // 0102 STA 0180
+        0x76,               // 0105 HLT
+    }, RAMOrigin, ram);
+    processor.Run();
+
+    EXPECT_TRUE(processor.GetRegisters().isHalted);
+    EXPECT_EQ(0x04, memoryManager->Fetch8(0x0180));
+    EXPECT_EQ(size_t{ 0 }, processor.GetStatistics().invalidations);
+    EXPECT_TRUE(memoryManager->IsWatchingStores(0x0180));
+}
+
+TEST_FIXTURE(CachedProcessorIntel8080Test, FlushCache)
+{
+    CachedProcessorIntel8080 processor;
+    processor.Setup(memoryManager, ioManager);
+    processor.LoadCode({ 0xC3, 0x00, 0x01 }, Origin, rom);  // JMP 0100
+    processor.LoadData({ 0x00, 0x76 }, RAMOrigin, ram);     // NOP, HLT
+    processor.Run();
+
+    EXPECT_EQ(size_t{ 2 }, processor.CachedBlockCount());
+    EXPECT_TRUE(memoryManager->IsWatchingStores(0x0100));
+    processor.FlushCache();
+    EXPECT_EQ(size_t{ 0 }, processor.CachedBlockCount());
+    EXPECT_FALSE(memoryManager->IsWatchingStores(0x0100));
+    memoryManager->Store8(0x0100, 0x00);
+    EXPECT_EQ(size_t{ 0 }, processor.GetStatistics().invalidations);
+}
+
+TEST_FIXTURE(CachedProcessorIntel8080Test, SharedMemory)
+{
+    CachedProcessorIntel8080 processor;
+    processor.Setup(memoryManager, ioManager);
+    processor.LoadCode({ 0xC3, 0x00, 0x01 }, Origin, rom);  // JMP 0100
+    processor.LoadData({ 0x04, 0x76 }, RAMOrigin, ram);     // 0100 INR B; 0101 HLT
+    {
+        CachedProcessorIntel8080 other;
+        other.Setup(memoryManager, ioManager);
+        other.Run();
+        processor.Run();
+        EXPECT_EQ(size_t{ 2 }, other.CachedBlockCount());
+        EXPECT_EQ(size_t{ 2 }, processor.CachedBlockCount());
+    }
+    // The other engine only gave up its own subscription and watched pages
+    EXPECT_TRUE(memoryManager->IsWatchingStores(0x0100));
+    memoryManager->Store8(0x0100, 0x0C);                    // INR C
+    EXPECT_EQ(size_t{ 1 }, processor.GetStatistics().invalidations);
+
+    RegistersIntel8080 & registers = processor.GetRegisters();
+    registers.pc = 0x0000;
+    registers.isHalted = false;
+    processor.Run();
+    EXPECT_EQ(0x01, registers.bc.B.h);
+    EXPECT_EQ(0x01, registers.bc.B.l);
+}
+
+TEST_FIXTURE(CachedProcessorIntel8080Test, DecodedOperands)
+{
+    CachedProcessorIntel8080 processor;
+    processor.Setup(memoryManager, ioManager);
+    processor.LoadCode({ 0xC3, 0x00, 0x01 }, Origin, rom);  // JMP 0100
+    processor.LoadData(
+    {
+        0x21, 0x34, 0x12,   // 0100 LXI H,1234
+        0x3E, 0x05,         // 0103 MVI A,05
+        0xC6, 0x03,         // 0105 ADI 03
+        0x32, 0x80, 0x01,   // 0107 STA 0180
+        0xCD, 0x10, 0x01,   // 010A CALL 0110
+        0x76,               // 010D HLT
+        0x00, 0x00,
+        0x3C,               // 0110 INR A
+        0xC9,               // 0111 RET
+    }, RAMOrigin, ram);
+    processor.GetRegisters().sp.W = 0x0200;
+    processor.Run();
+
+    RegistersIntel8080 const & registers = processor.GetRegisters();
+    EXPECT_TRUE(registers.isHalted);
+    EXPECT_EQ(0x1234, registers.hl.W);
+    EXPECT_EQ(0x09, registers.a);
+    EXPECT_EQ(0x08, memoryManager->Fetch8(0x0180));
+    EXPECT_EQ(0x010E, registers.pc);
+    EXPECT_EQ(0x0200, registers.sp.W);
+
+    // Rewriting an operand discards the block holding it
+    memoryManager->Store8(0x0104, 0x10);
+    processor.GetRegisters().pc = 0x0000;
+    processor.GetRegisters().isHalted = false;
+    processor.Run();
+    EXPECT_EQ(0x14, processor.GetRegisters().a);
+    EXPECT_EQ(0x13, memoryManager->Fetch8(0x0180));
+}
+
+} // namespace Test
+
+} // namespace Emulator
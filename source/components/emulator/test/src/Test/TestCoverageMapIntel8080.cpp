@@ -0,0 +1,144 @@
+#include "unit-test-c++/UnitTestC++.h"
+
+#include "emulator/CoverageMapIntel8080.h"
+#include "emulator/JitProcessorIntel8080.h"
+#include "TestMachineIntel8080.h"
+
+using namespace std;
+
+namespace Emulator
+{
+
+namespace Test
+{
+
+class CoverageMapIntel8080Test : public UnitTestCpp::TestFixture
+{
+public:
+	virtual void SetUp();
+	virtual void TearDown();
+
+    void SetupProcessor(ProcessorIntel8080 & processor);
+    void AssertCoverage(CoverageMapIntel8080 const & coverage);
+};
+
+void CoverageMapIntel8080Test::SetUp()
+{
+}
+
+void CoverageMapIntel8080Test::TearDown()
+{
+}
+
+void CoverageMapIntel8080Test::SetupProcessor(ProcessorIntel8080 & processor)
+{
+    TestMachineIntel8080::SetupProcessorRAM(processor, TestMachineIntel8080::CallProgram(), TestMachineIntel8080::RAMSize);
+}
+
+void CoverageMapIntel8080Test::AssertCoverage(CoverageMapIntel8080 const & coverage)
+{
+    EXPECT_EQ(size_t{ 5 }, coverage.EdgeCount());
+    EXPECT_EQ(3, coverage.Hits(0x0005, 0x0010));
+    EXPECT_EQ(3, coverage.Hits(0x0012, 0x0018));
+    EXPECT_EQ(3, coverage.Hits(0x001A, 0x0015));
+    EXPECT_EQ(3, coverage.Hits(0x0016, 0x0008));
+    EXPECT_EQ(2, coverage.Hits(0x0009, 0x0005));
+    // Not taken
+    EXPECT_EQ(0, coverage.Hits(0x0009, 0x000C));
+    EXPECT_EQ(0, coverage.Hits(0x0015, 0x0016));
+}
+
+TEST_FIXTURE(CoverageMapIntel8080Test, Construct)
+{
+    CoverageMapIntel8080 coverage;
+    EXPECT_EQ(CoverageMapIntel8080::MapSize, coverage.Size());
+    EXPECT_EQ(size_t{ 0 }, coverage.EdgeCount());
+    EXPECT_NE(CoverageMapIntel8080::EdgeIndex(0x0010, 0x0020), CoverageMapIntel8080::EdgeIndex(0x0020, 0x0010));
+    EXPECT_NE(0, CoverageMapIntel8080::EdgeIndex(0x0010, 0x0010));
+}
+
+TEST_FIXTURE(CoverageMapIntel8080Test, Record)
+{
+    CoverageMapIntel8080 coverage;
+    coverage.Record(0x0100, 0x00, 0x0101);      // NOP
+    coverage.Record(0x0100, 0xC2, 0x0103);      // JNZ not taken
+    coverage.Record(0x0100, 0xC3, 0x0103);      // JMP to the next instruction
+    coverage.Record(0x0100, 0xC0, 0x0101);      // RNZ not taken
+    EXPECT_EQ(size_t{ 0 }, coverage.EdgeCount());
+    coverage.Record(0x0100, 0xC2, 0x0200);      // JNZ taken
+    coverage.Record(0x0200, 0xE9, 0x0300);      // PCHL
+    coverage.Record(0x0300, 0xFF, 0x0038);      // RST 7
+    coverage.Record(0x0038, 0xC9, 0x0301);      // RET
+    coverage.Record(0x0100, 0xC2, 0x0200);
+    EXPECT_EQ(size_t{ 4 }, coverage.EdgeCount());
+    EXPECT_EQ(2, coverage.Hits(0x0100, 0x0200));
+    EXPECT_EQ(1, coverage.Hits(0x0038, 0x0301));
+    EXPECT_EQ(0, coverage.Hits(0x0200, 0x0100));
+
+    for (size_t count = 0; count < 255; ++count)
+        coverage.Record(0x0100, 0xC2, 0x0200);
+    EXPECT_EQ(1, coverage.Hits(0x0100, 0x0200));
+
+    coverage.Reset();
+    EXPECT_EQ(size_t{ 0 }, coverage.EdgeCount());
+}
+
+TEST_FIXTURE(CoverageMapIntel8080Test, ExternalMap)
+{
+    vector<uint8_t> memory(CoverageMapIntel8080::MapSize, 0xAA);
+    CoverageMapIntel8080 coverage(memory.data());
+    EXPECT_EQ(memory.data(), coverage.Data());
+    EXPECT_EQ(size_t{ 0 }, coverage.EdgeCount());
+    coverage.Record(0x0100, 0xCD, 0x0200);
+    EXPECT_EQ(1, memory[CoverageMapIntel8080::EdgeIndex(0x0100, 0x0200)]);
+}
+
+TEST_FIXTURE(CoverageMapIntel8080Test, CoverageProcessorIntel8080)
+{
+    ProcessorIntel8080 processor;
+    CoverageMapIntel8080 coverage;
+    SetupProcessor(processor);
+    processor.SetCoverage(&coverage);
+    processor.Run(size_t{ 100000 });
+    AssertCoverage(coverage);
+}
+
+TEST_FIXTURE(CoverageMapIntel8080Test, CoverageFastProcessorIntel8080)
+{
+    FastProcessorIntel8080 processor;
+    CoverageMapIntel8080 coverage;
+    SetupProcessor(processor);
+    processor.SetCoverage(&coverage);
+    processor.Run();
+    AssertCoverage(coverage);
+
+    coverage.Reset();
+    processor.GetRegisters().pc = 0;
+    processor.GetRegisters().isHalted = false;
+    processor.Run(size_t{ 100000 });
+    AssertCoverage(coverage);
+
+    coverage.Reset();
+    processor.SetCoverage(nullptr);
+    processor.GetRegisters().pc = 0;
+    processor.GetRegisters().isHalted = false;
+    processor.Run();
+    EXPECT_EQ(size_t{ 0 }, coverage.EdgeCount());
+}
+
+TEST_FIXTURE(CoverageMapIntel8080Test, CoverageJitProcessorIntel8080)
+{
+    // Uses the handlers while recording coverage
+    JitProcessorIntel8080 processor;
+    processor.SetHotThreshold(1);
+    CoverageMapIntel8080 coverage;
+    SetupProcessor(processor);
+    processor.SetCoverage(&coverage);
+    processor.Run(size_t{ 100000 });
+    AssertCoverage(coverage);
+    EXPECT_EQ(size_t{ 0 }, processor.GetStatistics().translations);
+}
+
+} // namespace Test
+
+} // namespace Emulator
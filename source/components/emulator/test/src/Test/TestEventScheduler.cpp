@@ -0,0 +1,113 @@
+#include "unit-test-c++/UnitTestC++.h"
+
+#include "emulator/EventScheduler.h"
+#include "emulator/InterruptControllerIntel8080.h"
+
+using namespace std;
+
+namespace Emulator
+{
+
+namespace Test
+{
+
+class EventSchedulerTest : public UnitTestCpp::TestFixture
+{
+public:
+	virtual void SetUp();
+	virtual void TearDown();
+};
+
+void EventSchedulerTest::SetUp()
+{
+}
+
+void EventSchedulerTest::TearDown()
+{
+}
+
+TEST_FIXTURE(EventSchedulerTest, Construct)
+{
+    EventScheduler scheduler;
+    EXPECT_EQ(size_t{ 0 }, scheduler.Size());
+    EXPECT_EQ(uint64_t{ EventScheduler::NoDeadline }, scheduler.NextDeadline());
+    EXPECT_EQ(size_t{ 0 }, scheduler.RunDue(1000));
+}
+
+TEST_FIXTURE(EventSchedulerTest, Order)
+{
+    EventScheduler scheduler;
+    vector<int> order;
+    scheduler.Schedule(300, [&order](uint64_t) { order.push_back(3); });
+    scheduler.Schedule(100, [&order](uint64_t) { order.push_back(1); });
+    scheduler.Schedule(200, [&order](uint64_t) { order.push_back(2); });
+    scheduler.Schedule(100, [&order](uint64_t) { order.push_back(4); });
+    EXPECT_EQ(size_t{ 4 }, scheduler.Size());
+    EXPECT_EQ(uint64_t{ 100 }, scheduler.NextDeadline());
+
+    EXPECT_EQ(size_t{ 0 }, scheduler.RunDue(99));
+    EXPECT_EQ(size_t{ 3 }, scheduler.RunDue(200));
+    EXPECT_EQ(vector<int>({ 1, 4, 2 }), order);
+    EXPECT_EQ(uint64_t{ 300 }, scheduler.NextDeadline());
+    EXPECT_EQ(size_t{ 1 }, scheduler.RunDue(1000));
+    EXPECT_EQ(vector<int>({ 1, 4, 2, 3 }), order);
+    EXPECT_EQ(size_t{ 0 }, scheduler.Size());
+}
+
+TEST_FIXTURE(EventSchedulerTest, Cancel)
+{
+    EventScheduler scheduler;
+    vector<int> order;
+    EventID first = scheduler.Schedule(100, [&order](uint64_t) { order.push_back(1); });
+    scheduler.Schedule(200, [&order](uint64_t) { order.push_back(2); });
+    EXPECT_TRUE(scheduler.Cancel(first));
+    EXPECT_FALSE(scheduler.Cancel(first));
+    EXPECT_EQ(uint64_t{ 200 }, scheduler.NextDeadline());
+    scheduler.RunDue(200);
+    EXPECT_EQ(vector<int>({ 2 }), order);
+
+    scheduler.Schedule(300, [&order](uint64_t) { order.push_back(3); });
+    scheduler.Clear();
+    EXPECT_EQ(size_t{ 0 }, scheduler.RunDue(1000));
+}
+
+TEST_FIXTURE(EventSchedulerTest, Reschedule)
+{
+    EventScheduler scheduler;
+    vector<uint64_t> deadlines;
+    EventCallback periodic = [&](uint64_t deadline)
+    {
+        deadlines.push_back(deadline);
+        scheduler.Schedule(deadline + 100, periodic);
+    };
+    scheduler.Schedule(100, periodic);
+    EXPECT_EQ(size_t{ 3 }, scheduler.RunDue(350));
+    EXPECT_EQ(vector<uint64_t>({ 100, 200, 300 }), deadlines);
+    EXPECT_EQ(uint64_t{ 400 }, scheduler.NextDeadline());
+}
+
+TEST_FIXTURE(EventSchedulerTest, InterruptController)
+{
+    InterruptControllerIntel8080 controller;
+    EXPECT_FALSE(controller.IsPending());
+    controller.Request(2);
+    controller.Request(5);
+    EXPECT_TRUE(controller.IsPending());
+    EXPECT_EQ(0x24, controller.GetPending());
+
+    controller.SetMask(0x20);
+    EXPECT_EQ(2, controller.Acknowledge());
+    EXPECT_FALSE(controller.IsPending());
+    controller.SetMask(0x00);
+    EXPECT_EQ(5, controller.Acknowledge());
+    EXPECT_EQ(0x00, controller.GetPending());
+
+    controller.Request(0);
+    controller.Cancel(0);
+    EXPECT_FALSE(controller.IsPending());
+    EXPECT_THROW(controller.Request(8), std::runtime_error);
+}
+
+} // namespace Test
+
+} // namespace Emulator
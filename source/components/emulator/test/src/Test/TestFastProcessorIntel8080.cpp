@@ -0,0 +1,590 @@
+#include "unit-test-c++/UnitTestC++.h"
+
+#include "emulator/FastProcessorIntel8080.h"
+#include "emulator/IODevice.h"
+#include "TestMachineIntel8080.h"
+
+using namespace std;
+
+namespace Emulator
+{
+
+namespace Test
+{
+
+// Single port device counting its reads, which are passive or not as set up
+class ReadCountingDevice : public IODevice
+{
+public:
+    ReadCountingDevice(size_t base, bool passive)
+        : IODevice(base, 1)
+        , passive(passive)
+        , value()
+        , reads()
+    {}
+
+    uint8_t In8(size_t address) const override
+    {
+        CheckRange(address, 1, "In");
+        ++reads;
+        return value;
+    }
+    void Out8(size_t address, uint8_t data) override
+    {
+        CheckRange(address, 1, "Out");
+        value = data;
+    }
+    bool IsPassiveIn(size_t /*address*/) const override { return passive; }
+    size_t Reads() const { return reads; }
+
+private:
+    bool passive;
+    uint8_t value;
+    mutable size_t reads;
+};
+
+class FastProcessorIntel8080Test : public UnitTestCpp::TestFixture, public TestMachineIntel8080
+{
+public:
+	virtual void SetUp();
+	virtual void TearDown();
+
+};
+
+void FastProcessorIntel8080Test::SetUp()
+{
+}
+
+void FastProcessorIntel8080Test::TearDown()
+{
+}
+
+TEST_FIXTURE(FastProcessorIntel8080Test, Construct)
+{
+    FastProcessorIntel8080 processor;
+    RegistersIntel8080 & registers = processor.GetRegisters();
+    EXPECT_EQ(0, registers.pc);
+    EXPECT_FALSE(registers.isHalted);
+    EXPECT_NULL(processor.GetMemoryManager());
+    EXPECT_NULL(processor.GetIOManager());
+}
+
+TEST_FIXTURE(FastProcessorIntel8080Test, ExecuteInstructionMatchesProcessorIntel8080)
+{
+    for (int opcode = 0; opcode < 256; ++opcode)
+    {
+        for (FlagsIntel8080 flags : { FlagsIntel8080::None, FlagsIntel8080(0xD5) })
+        for (bool lazyFlags : { false, true })
+        {
+            ProcessorIntel8080 reference;
+            FastProcessorIntel8080 processor;
+            processor.SetLazyFlags(lazyFlags);
+            vector<uint8_t> code = { uint8_t(opcode), 0x34, 0x02 };
+            SetupProcessor(reference, code);
+            SetupProcessor(processor, code);
+            for (RegistersIntel8080 * registers : { &reference.GetRegisters(), &processor.GetRegisters() })
+            {
+                registers->bc.W = 0x0123;
+                registers->de.W = 0x0345;
+                registers->hl.W = 0x0567;
+                registers->sp.W = 0x0800;
+                registers->a = 0x9A;
+                registers->flags = flags;
+                registers->cycleCountPeriod = 1000;
+                registers->cycleCount = 1000;
+            }
+
+            bool referenceThrows = false;
+            bool processorThrows = false;
+            try
+            {
+                reference.FetchInstruction();
+                reference.ExecuteInstruction();
+            }
+            catch (ProcessorInvalidInstruction &)
+            {
+                referenceThrows = true;
+            }
+            try
+            {
+                processor.FetchInstruction();
+                processor.ExecuteInstruction();
+            }
+            catch (ProcessorInvalidInstruction &)
+            {
+                processorThrows = true;
+            }
+            EXPECT_EQ(referenceThrows, processorThrows);
+            if (referenceThrows)
+                continue;
+            AssertRegisters(reference.GetRegisters(), processor.GetRegisters());
+            EXPECT_EQ(reference.GetMemoryManager()->Fetch16(0x07FE), processor.GetMemoryManager()->Fetch16(0x07FE));
+            EXPECT_EQ(reference.GetMemoryManager()->Fetch8(0x0567), processor.GetMemoryManager()->Fetch8(0x0567));
+            EXPECT_EQ(reference.GetMemoryManager()->Fetch16(0x0234), processor.GetMemoryManager()->Fetch16(0x0234));
+        }
+    }
+}
+
+TEST_FIXTURE(FastProcessorIntel8080Test, RunMultiply)
+{
+    ProcessorIntel8080 reference;
+    FastProcessorIntel8080 processor;
+    SetupProcessor(reference, Multiply3x7());
+    SetupProcessor(processor, Multiply3x7());
+    reference.Run();
+    processor.Run();
+
+    RegistersIntel8080 & registers = processor.GetRegisters();
+    EXPECT_TRUE(registers.isHalted);
+    EXPECT_EQ(0x1A, registers.pc);
+    AssertRegisters(reference.GetRegisters(), registers);
+}
+
+TEST_FIXTURE(FastProcessorIntel8080Test, RunMultiplyLazyFlags)
+{
+    FastProcessorIntel8080 reference;
+    FastProcessorIntel8080 processor;
+    SetupProcessor(reference, Multiply3x7());
+    SetupProcessor(processor, Multiply3x7());
+    processor.SetLazyFlags(true);
+    EXPECT_TRUE(processor.GetLazyFlags());
+    reference.Run();
+    processor.Run();
+
+    AssertRegisters(reference.GetRegisters(), processor.GetRegisters());
+}
+
+TEST_FIXTURE(FastProcessorIntel8080Test, LazyFlagsPushPSW)
+{
+    FastProcessorIntel8080 processor;
+    SetupProcessor(processor,
+    {
+        0x31, 0x00, 0x08,   // LXI SP,0800
+        0x3E, 0x80,         // MVI A,80
+        0xC6, 0x80,         // ADI 80
+        0x3C,               // INR A
+        0xF5,               // PUSH PSW
+        0xD6, 0x01,         // SUI 01
+        0x76,               // HLT
+    });
+    processor.SetLazyFlags(true);
+    processor.Run();
+
+    RegistersIntel8080 & registers = processor.GetRegisters();
+    EXPECT_EQ(0x00, registers.a);
+    EXPECT_EQ(FlagsIntel8080::Zero | FlagsIntel8080::Parity, registers.flags);
+    EXPECT_EQ(0x0103, processor.GetMemoryManager()->Fetch16(0x07FE));
+}
+
+TEST_FIXTURE(FastProcessorIntel8080Test, LazyFlagsDebugCallback)
+{
+    FastProcessorIntel8080 processor;
+    SetupProcessor(processor,
+    {
+        0x3E, 0xFF,         // MVI A,FF
+        0xC6, 0x01,         // ADI 01
+        0x00,               // NOP
+        0x76,               // HLT
+    });
+    processor.SetLazyFlags(true);
+    FlagsIntel8080 flags = FlagsIntel8080::None;
+    processor.SetupDebug([&flags](RegistersIntel8080 const & registers) { if (registers.pc == 0x0004) flags = registers.flags; return true; });
+    processor.GetRegisters().trace = true;
+    processor.Run();
+
+    EXPECT_EQ(FlagsIntel8080::Zero | FlagsIntel8080::Parity | FlagsIntel8080::AuxCarry | FlagsIntel8080::Carry, flags);
+}
+
+TEST_FIXTURE(FastProcessorIntel8080Test, RunBudget)
+{
+    ProcessorIntel8080 reference;
+    FastProcessorIntel8080 processor;
+    SetupProcessor(reference, { 0xC3, 0x00, 0x00 });    // JMP 0000
+    SetupProcessor(processor, { 0xC3, 0x00, 0x00 });
+    EXPECT_EQ(size_t{ 100 }, reference.Run(100));
+    EXPECT_EQ(size_t{ 100 }, processor.Run(100));
+    // A budget ending halfway an instruction is exceeded by the rest of the instruction
+    EXPECT_EQ(size_t{ 100 }, reference.Run(95));
+    EXPECT_EQ(size_t{ 100 }, processor.Run(95));
+    EXPECT_EQ(size_t{ 200 }, processor.GetRegisters().cycleCountTotal);
+    AssertRegisters(reference.GetRegisters(), processor.GetRegisters());
+
+    FastProcessorIntel8080 multiply;
+    SetupProcessor(reference, Multiply3x7());
+    SetupProcessor(multiply, Multiply3x7());
+    reference.Run();
+    size_t cycles = multiply.Run(1000000);
+    EXPECT_TRUE(multiply.GetRegisters().isHalted);
+    EXPECT_TRUE(cycles < 1000000);
+    EXPECT_EQ(size_t{ 0 }, multiply.Run(1000000));
+    EXPECT_EQ(reference.GetRegisters().a, multiply.GetRegisters().a);
+}
+
+TEST_FIXTURE(FastProcessorIntel8080Test, RunBudgetPeriodic)
+{
+    ProcessorIntel8080 reference;
+    FastProcessorIntel8080 processor;
+    SetupProcessor(reference, { 0xC3, 0x00, 0x00 });    // JMP 0000
+    SetupProcessor(processor, { 0xC3, 0x00, 0x00 });
+    size_t referenceCalls = 0;
+    size_t calls = 0;
+    reference.SetupLoop([&referenceCalls](RegistersIntel8080 &) { ++referenceCalls; return InterruptFlagsIntel8080::None; });
+    processor.SetupLoop([&calls](RegistersIntel8080 &) { ++calls; return InterruptFlagsIntel8080::None; });
+    for (RegistersIntel8080 * registers : { &reference.GetRegisters(), &processor.GetRegisters() })
+    {
+        registers->cycleCountPeriod = 1000;
+        registers->cycleCount = 1000;
+    }
+    EXPECT_EQ(size_t{ 10000 }, reference.Run(10000));
+    EXPECT_EQ(size_t{ 10000 }, processor.Run(10000));
+    EXPECT_EQ(size_t{ 10 }, referenceCalls);
+    EXPECT_EQ(size_t{ 10 }, calls);
+    AssertRegisters(reference.GetRegisters(), processor.GetRegisters());
+
+    processor.SetupLoop([](RegistersIntel8080 &) { return InterruptFlagsIntel8080::Quit; });
+    EXPECT_EQ(size_t{ 1000 }, processor.Run(10000));
+    EXPECT_EQ(1000, processor.GetRegisters().cycleCount);
+}
+
+TEST_FIXTURE(FastProcessorIntel8080Test, RunBudgetInterrupt)
+{
+    vector<uint8_t> code =
+    {
+        0x31, 0x00, 0x08,   // 0000 LXI SP,0800
+        0xFB,               // 0003 EI
+        0xC3, 0x04, 0x00,   // 0004 JMP 0004
+        0x00,               // 0007 NOP
+        0x76,               // 0008 HLT
+    };
+    ProcessorIntel8080 reference;
+    FastProcessorIntel8080 processor;
+    SetupProcessor(reference, code);
+    SetupProcessor(processor, code);
+    for (ProcessorIntel8080 * cpu : { &reference, static_cast<ProcessorIntel8080 *>(&processor) })
+    {
+        cpu->SetupLoop([](RegistersIntel8080 &) { return InterruptFlagsIntel8080(0x0008); });  // RST 1
+        cpu->GetRegisters().cycleCountPeriod = 100;
+        cpu->GetRegisters().cycleCount = 100;
+        cpu->Run(size_t{ 10000 });
+    }
+
+    RegistersIntel8080 & registers = processor.GetRegisters();
+    EXPECT_TRUE(registers.isHalted);
+    EXPECT_FALSE(registers.ie);
+    EXPECT_EQ(0x0009, registers.pc);
+    EXPECT_EQ(0x07FE, registers.sp.W);
+    EXPECT_EQ(0x0004, processor.GetMemoryManager()->Fetch16(0x07FE));
+    AssertRegisters(reference.GetRegisters(), registers);
+}
+
+TEST_FIXTURE(FastProcessorIntel8080Test, RunPeriodicInterruptWakesHalted)
+{
+    vector<uint8_t> code =
+    {
+        0x31, 0x00, 0x08,   // 0000 LXI SP,0800
+        0xFB,               // 0003 EI
+        0x76,               // 0004 HLT
+        0x00, 0x00, 0x00,
+        0x3E, 0x55,         // 0008 MVI A,55
+        0x76,               // 000A HLT
+    };
+    ProcessorIntel8080 reference;
+    FastProcessorIntel8080 processor;
+    SetupProcessor(reference, code);
+    SetupProcessor(processor, code);
+    size_t calls[2] = {};
+    for (ProcessorIntel8080 * cpu : { &reference, static_cast<ProcessorIntel8080 *>(&processor) })
+    {
+        size_t & count = calls[cpu == &reference ? 0 : 1];
+        cpu->SetupLoop([&count](RegistersIntel8080 &) { ++count; return InterruptFlagsIntel8080(0x0008); });  // RST 1
+        cpu->GetRegisters().cycleCountPeriod = 100;
+        cpu->GetRegisters().cycleCount = 100;
+        // Loop() keeps being called while halted, with interrupts disabled after the first one
+        EXPECT_EQ(size_t{ 1000 }, cpu->Run(size_t{ 1000 }));
+    }
+
+    RegistersIntel8080 & registers = processor.GetRegisters();
+    EXPECT_TRUE(registers.isHalted);
+    EXPECT_FALSE(registers.ie);
+    EXPECT_EQ(0x55, registers.a);
+    EXPECT_EQ(0x000B, registers.pc);
+    EXPECT_EQ(0x0005, processor.GetMemoryManager()->Fetch16(0x07FE));
+    EXPECT_EQ(uint64_t{ 1000 }, registers.cycleCountTotal);
+    EXPECT_EQ(size_t{ 10 }, calls[0]);
+    EXPECT_EQ(size_t{ 10 }, calls[1]);
+    AssertRegisters(reference.GetRegisters(), registers);
+}
+
+TEST_FIXTURE(FastProcessorIntel8080Test, RunScheduledInterrupt)
+{
+    vector<uint8_t> code =
+    {
+        0x31, 0x00, 0x08,   // 0000 LXI SP,0800
+        0x06, 0x0A,         // 0003 MVI B,0A
+        0x05,               // 0005 LOOP: DCR B
+        0xC2, 0x05, 0x00,   // 0006 JNZ LOOP
+        0xFB,               // 0009 EI
+        0x00,               // 000A NOP
+        0xC3, 0x0B, 0x00,   // 000B JMP 000B
+        0x00, 0x00,
+        0x3E, 0x55,         // 0010 MVI A,55
+        0x76,               // 0012 HLT
+    };
+    ProcessorIntel8080 reference;
+    FastProcessorIntel8080 processor;
+    SetupProcessor(reference, code);
+    SetupProcessor(processor, code);
+    for (ProcessorIntel8080 * cpu : { &reference, static_cast<ProcessorIntel8080 *>(&processor) })
+    {
+        // Requested while interrupts are disabled, accepted after the instruction following EI
+        cpu->GetScheduler().Schedule(50, [cpu](uint64_t) { cpu->GetInterruptController().Request(2); });
+        cpu->Run(size_t{ 10000 });
+    }
+
+    RegistersIntel8080 & registers = processor.GetRegisters();
+    EXPECT_TRUE(registers.isHalted);
+    EXPECT_FALSE(registers.ie);
+    EXPECT_EQ(0x55, registers.a);
+    EXPECT_EQ(0x0013, registers.pc);
+    EXPECT_EQ(0x000B, processor.GetMemoryManager()->Fetch16(0x07FE));
+    EXPECT_EQ(uint64_t{ 10 + 7 + 10 * (5 + 10) + 4 + 4 + 7 + 7 }, registers.cycleCountTotal);
+    EXPECT_FALSE(processor.GetInterruptController().IsPending());
+    AssertRegisters(reference.GetRegisters(), registers);
+}
+
+TEST_FIXTURE(FastProcessorIntel8080Test, RunScheduledInterruptWakesHalted)
+{
+    vector<uint8_t> code =
+    {
+        0x31, 0x00, 0x08,   // 0000 LXI SP,0800
+        0xFB,               // 0003 EI
+        0x76,               // 0004 HLT
+        0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+        0x3E, 0x55,         // 0010 MVI A,55
+        0x76,               // 0012 HLT
+    };
+    ProcessorIntel8080 reference;
+    FastProcessorIntel8080 processor;
+    SetupProcessor(reference, code);
+    SetupProcessor(processor, code);
+    for (ProcessorIntel8080 * cpu : { &reference, static_cast<ProcessorIntel8080 *>(&processor) })
+    {
+        cpu->GetScheduler().Schedule(1000, [cpu](uint64_t) { cpu->GetInterruptController().Request(2); });
+        // Time passes while halted, in slices shorter than the wait for the interrupt
+        EXPECT_EQ(size_t{ 500 }, cpu->Run(size_t{ 500 }));
+        EXPECT_TRUE(cpu->GetRegisters().isHalted);
+        EXPECT_EQ(uint64_t{ 500 }, cpu->Now());
+        EXPECT_EQ(size_t{ 500 }, cpu->Run(size_t{ 500 }));
+        EXPECT_EQ(size_t{ 7 + 7 }, cpu->Run(size_t{ 500 }));
+        // Halted with interrupts disabled and nothing scheduled, so stopped
+        EXPECT_EQ(size_t{ 0 }, cpu->Run(size_t{ 500 }));
+        EXPECT_EQ(uint64_t{ 1014 }, cpu->Now());
+        EXPECT_EQ(uint64_t{ 1000 - 10 - 4 - 7 }, cpu->GetIdleStatistics().haltCycles);
+    }
+
+    RegistersIntel8080 & registers = processor.GetRegisters();
+    EXPECT_TRUE(registers.isHalted);
+    EXPECT_FALSE(registers.ie);
+    EXPECT_EQ(0x55, registers.a);
+    EXPECT_EQ(0x0005, processor.GetMemoryManager()->Fetch16(0x07FE));
+    AssertRegisters(reference.GetRegisters(), registers);
+}
+
+TEST_FIXTURE(FastProcessorIntel8080Test, RunScheduledEvents)
+{
+    FastProcessorIntel8080 processor;
+    SetupProcessor(processor, { 0xC3, 0x00, 0x00 });    // JMP 0000
+    vector<uint64_t> times;
+    EventCallback periodic = [&](uint64_t deadline)
+    {
+        times.push_back(processor.Now());
+        processor.GetScheduler().Schedule(deadline + 100, periodic);
+    };
+    processor.GetScheduler().Schedule(100, periodic);
+    EXPECT_EQ(size_t{ 1000 }, processor.Run(1000));
+    EXPECT_EQ(vector<uint64_t>({ 100, 200, 300, 400, 500, 600, 700, 800, 900, 1000 }), times);
+    EXPECT_EQ(uint64_t{ 1100 }, processor.GetScheduler().NextDeadline());
+}
+
+TEST_FIXTURE(FastProcessorIntel8080Test, RunIdleSkippingHalted)
+{
+    vector<uint8_t> code =
+    {
+        0x31, 0x00, 0x08,   // 0000 LXI SP,0800
+        0xFB,               // 0003 EI
+        0x76,               // 0004 HLT
+        0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+        0x3E, 0x55,         // 0010 MVI A,55
+        0x76,               // 0012 HLT
+    };
+    ProcessorIntel8080 reference;
+    FastProcessorIntel8080 processor;
+    SetupProcessor(reference, code);
+    SetupProcessor(processor, code);
+    for (ProcessorIntel8080 * cpu : { &reference, static_cast<ProcessorIntel8080 *>(&processor) })
+    {
+        cpu->SetIdleSkipping(true);
+        cpu->GetScheduler().Schedule(1000, [cpu](uint64_t) { cpu->GetInterruptController().Request(2); });
+        EXPECT_EQ(size_t{ 1000 + 7 + 7 }, cpu->Run(size_t{ 10000 }));
+        EXPECT_EQ(size_t{ 1 }, cpu->GetIdleStatistics().haltSkips);
+        EXPECT_EQ(uint64_t{ 1000 - 10 - 4 - 7 }, cpu->GetIdleStatistics().haltCycles);
+    }
+
+    RegistersIntel8080 & registers = processor.GetRegisters();
+    EXPECT_TRUE(registers.isHalted);
+    EXPECT_FALSE(registers.ie);
+    EXPECT_EQ(0x55, registers.a);
+    EXPECT_EQ(0x0005, processor.GetMemoryManager()->Fetch16(0x07FE));
+    EXPECT_EQ(uint64_t{ 1014 }, registers.cycleCountTotal);
+    AssertRegisters(reference.GetRegisters(), registers);
+}
+
+TEST_FIXTURE(FastProcessorIntel8080Test, RunIdleSkippingPollingLoop)
+{
+    vector<uint8_t> code =
+    {
+        0x31, 0x00, 0x08,   // 0000 LXI SP,0800
+        0xDB, 0x10,         // 0003 LOOP: IN 10
+        0xE6, 0x01,         // 0005 ANI 01
+        0xCA, 0x03, 0x00,   // 0007 JZ LOOP
+        0x76,               // 000A HLT
+    };
+    FastProcessorIntel8080 reference;
+    FastProcessorIntel8080 processor;
+    SetupProcessor(reference, code);
+    SetupProcessor(processor, code);
+    processor.SetIdleSkipping(true);
+    for (ProcessorIntel8080 * cpu : { static_cast<ProcessorIntel8080 *>(&reference), static_cast<ProcessorIntel8080 *>(&processor) })
+    {
+        cpu->GetScheduler().Schedule(1000, [cpu](uint64_t) { cpu->GetIOManager()->Out8(0x10, 0x01); });
+        cpu->Run(size_t{ 10000 });
+    }
+
+    // One iteration runs to find the loop and one to check it, then the whole iterations up to the event are skipped
+    EXPECT_EQ(size_t{ 1 }, processor.GetIdleStatistics().loopSkips);
+    EXPECT_EQ(uint64_t{ (1000 - 10 - 2 * 27) / 27 * 27 }, processor.GetIdleStatistics().loopCycles);
+    EXPECT_EQ(size_t{ 0 }, reference.GetIdleStatistics().loopSkips);
+    RegistersIntel8080 & registers = processor.GetRegisters();
+    EXPECT_TRUE(registers.isHalted);
+    EXPECT_EQ(0x01, registers.a);
+    EXPECT_EQ(reference.GetRegisters().cycleCountTotal, registers.cycleCountTotal);
+    AssertRegisters(reference.GetRegisters(), registers);
+}
+
+TEST_FIXTURE(FastProcessorIntel8080Test, RunIdleSkippingDeviceRead)
+{
+    vector<uint8_t> code =
+    {
+        0x31, 0x00, 0x08,   // 0000 LXI SP,0800
+        0xDB, 0x10,         // 0003 LOOP: IN 10
+        0xE6, 0x01,         // 0005 ANI 01
+        0xCA, 0x03, 0x00,   // 0007 JZ LOOP
+        0x76,               // 000A HLT
+    };
+    for (bool passive : { false, true })
+    {
+        FastProcessorIntel8080 reference;
+        FastProcessorIntel8080 processor;
+        std::shared_ptr<ReadCountingDevice> referenceDevice = std::make_shared<ReadCountingDevice>(0x10, passive);
+        std::shared_ptr<ReadCountingDevice> device = std::make_shared<ReadCountingDevice>(0x10, passive);
+        SetupProcessor(reference, code);
+        SetupProcessor(processor, code);
+        for (auto setup : { make_pair(static_cast<ProcessorIntel8080 *>(&reference), referenceDevice),
+                            make_pair(static_cast<ProcessorIntel8080 *>(&processor), device) })
+        {
+            IOManagerPtr ioManager = std::make_shared<IOManager>();
+            ioManager->AddIO(setup.second);
+            setup.first->Setup(setup.first->GetMemoryManager(), ioManager);
+        }
+        processor.SetIdleSkipping(true);
+        for (ProcessorIntel8080 * cpu : { static_cast<ProcessorIntel8080 *>(&reference), static_cast<ProcessorIntel8080 *>(&processor) })
+        {
+            cpu->GetScheduler().Schedule(1000, [cpu](uint64_t) { cpu->GetIOManager()->Out8(0x10, 0x01); });
+            cpu->Run(size_t{ 10000 });
+        }
+
+        RegistersIntel8080 & registers = processor.GetRegisters();
+        EXPECT_TRUE(registers.isHalted);
+        EXPECT_EQ(reference.GetRegisters().cycleCountTotal, registers.cycleCountTotal);
+        AssertRegisters(reference.GetRegisters(), registers);
+        if (passive)
+        {
+            EXPECT_EQ(size_t{ 1 }, processor.GetIdleStatistics().loopSkips);
+            EXPECT_TRUE(device->Reads() < referenceDevice->Reads());
+        }
+        else
+        {
+            // Every read happens, as without idle skipping
+            EXPECT_EQ(size_t{ 0 }, processor.GetIdleStatistics().loopSkips);
+            EXPECT_EQ(referenceDevice->Reads(), device->Reads());
+        }
+    }
+}
+
+TEST_FIXTURE(FastProcessorIntel8080Test, RunIdleSkippingBusyLoop)
+{
+    vector<uint8_t> code =
+    {
+        0x06, 0x0A,         // 0000 MVI B,0A
+        0x05,               // 0002 LOOP: DCR B
+        0xC2, 0x02, 0x00,   // 0003 JNZ LOOP
+        0x76,               // 0006 HLT
+    };
+    FastProcessorIntel8080 processor;
+    SetupProcessor(processor, code);
+    processor.SetIdleSkipping(true);
+    processor.Run(size_t{ 10000 });
+
+    // The registers change every iteration, so nothing is skipped
+    EXPECT_EQ(size_t{ 0 }, processor.GetIdleStatistics().loopSkips);
+    EXPECT_EQ(size_t{ 0 }, processor.GetIdleStatistics().haltSkips);
+    EXPECT_EQ(uint64_t{ 7 + 10 * (5 + 10) + 7 }, processor.GetRegisters().cycleCountTotal);
+    EXPECT_TRUE(processor.GetRegisters().isHalted);
+}
+
+TEST_FIXTURE(FastProcessorIntel8080Test, RunWithTrace)
+{
+    ProcessorIntel8080 reference;
+    FastProcessorIntel8080 processor;
+    SetupProcessor(reference, Multiply3x7());
+    SetupProcessor(processor, Multiply3x7());
+    size_t referenceCount = 0;
+    size_t instructionCount = 0;
+    reference.SetupDebug([&referenceCount](RegistersIntel8080 const &) { ++referenceCount; return true; });
+    processor.SetupDebug([&instructionCount](RegistersIntel8080 const &) { ++instructionCount; return true; });
+    reference.GetRegisters().trace = true;
+    processor.GetRegisters().trace = true;
+    reference.Run();
+    processor.Run();
+
+    EXPECT_TRUE(processor.GetRegisters().isHalted);
+    EXPECT_EQ(size_t{ 92 }, instructionCount);
+    EXPECT_EQ(referenceCount, instructionCount);
+}
+
+TEST_FIXTURE(FastProcessorIntel8080Test, RunWithTrapStopsOnCallback)
+{
+    FastProcessorIntel8080 processor;
+    SetupProcessor(processor, Multiply3x7());
+    processor.SetupDebug([](RegistersIntel8080 const &) { return false; });
+    RegistersIntel8080 & registers = processor.GetRegisters();
+    registers.trap = 0x0014;
+    registers.trapEnabled = true;
+    processor.Run();
+
+    EXPECT_TRUE(registers.trace);
+    EXPECT_FALSE(registers.isHalted);
+    EXPECT_EQ(0x0014, registers.pc);
+}
+
+TEST_FIXTURE(FastProcessorIntel8080Test, RunInvalidInstruction)
+{
+    FastProcessorIntel8080 processor;
+    SetupProcessor(processor, { 0x00, 0x08 });
+    EXPECT_THROW(processor.Run(), ProcessorInvalidInstruction);
+    EXPECT_EQ(0x0002, processor.GetRegisters().pc);
+}
+
+} // namespace Test
+
+} // namespace Emulator
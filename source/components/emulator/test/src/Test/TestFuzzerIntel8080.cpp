@@ -0,0 +1,136 @@
+#include "unit-test-c++/UnitTestC++.h"
+
+#include "emulator/FuzzerIntel8080.h"
+
+using namespace std;
+
+namespace Emulator
+{
+
+namespace Test
+{
+
+class FuzzerIntel8080Test : public UnitTestCpp::TestFixture
+{
+public:
+	virtual void SetUp();
+	virtual void TearDown();
+
+    static const vector<uint8_t> TestProgram;
+
+    static Assembler::ObjectCode CreateImage(vector<uint8_t> const & code);
+};
+
+// Runs into an invalid instruction on input "FUZ" only
+const vector<uint8_t> FuzzerIntel8080Test::TestProgram =
+{
+    0xDB, 0x00,         // 0000 IN 00
+    0xFE, 0x46,         // 0002 CPI 'F'
+    0xC2, 0x16, 0x00,   // 0004 JNZ DONE
+    0xDB, 0x00,         // 0007 IN 00
+    0xFE, 0x55,         // 0009 CPI 'U'
+    0xC2, 0x16, 0x00,   // 000B JNZ DONE
+    0xDB, 0x00,         // 000E IN 00
+    0xFE, 0x5A,         // 0010 CPI 'Z'
+    0xC2, 0x16, 0x00,   // 0012 JNZ DONE
+    0x08,               // 0015 (invalid)
+    0x76,               // 0016 DONE: HLT
+};
+
+void FuzzerIntel8080Test::SetUp()
+{
+}
+
+void FuzzerIntel8080Test::TearDown()
+{
+}
+
+Assembler::ObjectCode FuzzerIntel8080Test::CreateImage(vector<uint8_t> const & code)
+{
+    Assembler::ObjectCode objectCode("test");
+    objectCode.GetSegment(Assembler::SegmentID::ASEG).SetOffset(0);
+    objectCode.GetSegment(Assembler::SegmentID::ASEG).SetData(code);
+    return objectCode;
+}
+
+TEST_FIXTURE(FuzzerIntel8080Test, Construct)
+{
+    FuzzerIntel8080 fuzzer(CreateImage(TestProgram));
+    EXPECT_EQ(FuzzerIntel8080::DefaultMaxCycles, fuzzer.MaxCycles());
+    EXPECT_EQ(FuzzerIntel8080::DefaultMaxInputSize, fuzzer.MaxInputSize());
+    EXPECT_EQ(size_t{ 0 }, fuzzer.GetCorpus().size());
+    EXPECT_EQ(size_t{ 0 }, fuzzer.GetCrashes().size());
+    EXPECT_EQ(size_t{ 0 }, fuzzer.GetStatistics().executions);
+}
+
+TEST_FIXTURE(FuzzerIntel8080Test, Execute)
+{
+    FuzzerIntel8080 fuzzer(CreateImage(TestProgram));
+    FuzzRunIntel8080 run = fuzzer.Execute({});
+    EXPECT_TRUE(run.halted);
+    EXPECT_FALSE(run.Crashed());
+    EXPECT_TRUE(run.newCoverage);
+    EXPECT_EQ(size_t{ 10 + 7 + 10 + 7 }, run.cycles);
+    EXPECT_EQ(1, fuzzer.GetCoverage().Hits(0x0004, 0x0016));
+
+    // Same path
+    run = fuzzer.Execute({ 'X' });
+    EXPECT_FALSE(run.newCoverage);
+    run = fuzzer.Execute({ 'F' });
+    EXPECT_TRUE(run.newCoverage);
+    EXPECT_EQ(size_t{ 2 }, fuzzer.GetCorpus().size());
+
+    run = fuzzer.Execute({ 'F', 'U', 'Z' });
+    EXPECT_TRUE(run.Crashed());
+    EXPECT_FALSE(run.halted);
+    EXPECT_FALSE(run.timedOut);
+    EXPECT_EQ(size_t{ 2 }, fuzzer.GetCorpus().size());
+    EXPECT_EQ(size_t{ 1 }, fuzzer.GetCrashes().size());
+    run = fuzzer.Execute({ 'F', 'U', 'Z', '!' });
+    EXPECT_TRUE(run.Crashed());
+    EXPECT_FALSE(run.newCoverage);
+    EXPECT_EQ(size_t{ 1 }, fuzzer.GetCrashes().size());
+
+    FuzzStatisticsIntel8080 const & statistics = fuzzer.GetStatistics();
+    EXPECT_EQ(size_t{ 5 }, statistics.executions);
+    EXPECT_EQ(size_t{ 2 }, statistics.crashes);
+    EXPECT_EQ(size_t{ 0 }, statistics.timeouts);
+    EXPECT_EQ(size_t{ 2 }, statistics.edges);
+}
+
+TEST_FIXTURE(FuzzerIntel8080Test, TimeOut)
+{
+    // 0000 IN 00; 0002 ORA A; 0003 JNZ 0000; 0006 JMP 0006
+    FuzzerIntel8080 fuzzer(CreateImage({ 0xDB, 0x00, 0xB7, 0xC2, 0x00, 0x00, 0xC3, 0x06, 0x00 }), 1, 1000);
+    FuzzRunIntel8080 run = fuzzer.Execute({ 1, 2, 3 });
+    EXPECT_TRUE(run.timedOut);
+    EXPECT_FALSE(run.halted);
+    EXPECT_TRUE(run.newCoverage);
+    EXPECT_LE(size_t{ 1000 }, run.cycles);
+    EXPECT_EQ(size_t{ 0 }, fuzzer.GetCorpus().size());
+    EXPECT_EQ(size_t{ 1 }, fuzzer.GetStatistics().timeouts);
+}
+
+TEST_FIXTURE(FuzzerIntel8080Test, FindCrash)
+{
+    FuzzerIntel8080 fuzzer(CreateImage(TestProgram), 1234);
+    for (size_t round = 0; (round < 100) && fuzzer.GetCrashes().empty(); ++round)
+        fuzzer.Run(1000);
+    ASSERT_EQ(size_t{ 1 }, fuzzer.GetCrashes().size());
+    vector<uint8_t> const & crash = fuzzer.GetCrashes()[0];
+    ASSERT_LE(size_t{ 3 }, crash.size());
+    EXPECT_EQ('F', crash[0]);
+    EXPECT_EQ('U', crash[1]);
+    EXPECT_EQ('Z', crash[2]);
+    EXPECT_EQ(size_t{ 3 }, fuzzer.GetCorpus().size());
+
+    // Reproducible
+    FuzzerIntel8080 other(CreateImage(TestProgram), 1234);
+    other.Run(fuzzer.GetStatistics().executions - 1);
+    EXPECT_TRUE(fuzzer.GetCrashes() == other.GetCrashes());
+    EXPECT_TRUE(fuzzer.GetCorpus() == other.GetCorpus());
+}
+
+} // namespace Test
+
+} // namespace Emulator
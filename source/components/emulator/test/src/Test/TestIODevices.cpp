@@ -0,0 +1,165 @@
+#include "unit-test-c++/UnitTestC++.h"
+
+#include <limits>
+#include <sstream>
+#include "emulator/DiskControllerDevice.h"
+#include "emulator/FastProcessorIntel8080.h"
+#include "emulator/SerialConsoleDevice.h"
+#include "emulator/TestResultDevice.h"
+#include "emulator/TimerDevice.h"
+
+using namespace std;
+
+namespace Emulator
+{
+
+namespace Test
+{
+
+class IODevicesTest : public UnitTestCpp::TestFixture
+{
+public:
+	virtual void SetUp();
+	virtual void TearDown();
+};
+
+void IODevicesTest::SetUp()
+{
+}
+
+void IODevicesTest::TearDown()
+{
+}
+
+TEST_FIXTURE(IODevicesTest, SerialConsole)
+{
+    SerialConsoleDevice serial(0x10);
+    ostringstream echo;
+    serial.SetOutputStream(&echo);
+    EXPECT_EQ(size_t{ 0x10 }, serial.Offset());
+    EXPECT_EQ(size_t{ 2 }, serial.Size());
+    EXPECT_EQ(uint8_t{ SerialConsoleDevice::StatusTransmitReady }, serial.In8(0x11));
+    serial.Receive("ab");
+    EXPECT_EQ(SerialConsoleDevice::StatusTransmitReady | SerialConsoleDevice::StatusReceiveReady, serial.In8(0x11));
+    EXPECT_EQ('a', serial.In8(0x10));
+    serial.Out8(0x10, 'x');
+    serial.Out(0x10, { 'y', 0x00 });
+
+    uint8_t data[3];
+    serial.InRepeated(0x10, data, sizeof(data));
+    EXPECT_EQ('b', data[0]);
+    EXPECT_EQ(0, data[1]);
+    EXPECT_EQ(size_t{ 0 }, serial.ReceiveQueueSize());
+    serial.OutRepeated(0x10, reinterpret_cast<uint8_t const *>("z!"), 2);
+    EXPECT_EQ("xyz!", serial.TransmittedText());
+    EXPECT_EQ("xyz!", echo.str());
+    EXPECT_THROW(serial.In8(0x12), std::runtime_error);
+}
+
+TEST_FIXTURE(IODevicesTest, Timer)
+{
+    TimerDevice timer(0x20, 10);
+    EXPECT_EQ(std::numeric_limits<size_t>::max(), timer.CyclesUntilExpiry());
+    EXPECT_EQ(size_t{ 0 }, timer.Advance(1000000));
+    timer.Out16(0x21, 5);
+    EXPECT_EQ(5, timer.In16(0x21));
+    timer.Out8(0x20, TimerDevice::ControlEnable | TimerDevice::ControlInterruptEnable);
+    EXPECT_EQ(size_t{ 50 }, timer.CyclesUntilExpiry());
+    EXPECT_EQ(size_t{ 0 }, timer.Advance(49));
+    EXPECT_FALSE(timer.IsExpired());
+    EXPECT_EQ(size_t{ 1 }, timer.Advance(1));
+    EXPECT_TRUE(timer.InterruptPending());
+    EXPECT_EQ(size_t{ 50 }, timer.CyclesUntilExpiry());
+    EXPECT_EQ(size_t{ 2 }, timer.Advance(120));
+    EXPECT_EQ(size_t{ 30 }, timer.CyclesUntilExpiry());
+    EXPECT_EQ(TimerDevice::StatusExpired | TimerDevice::ControlEnable | TimerDevice::ControlInterruptEnable, timer.In8(0x20));
+    EXPECT_FALSE(timer.IsExpired());
+    timer.Out8(0x20, 0);
+    EXPECT_EQ(size_t{ 0 }, timer.Advance(1000));
+}
+
+TEST_FIXTURE(IODevicesTest, DiskController)
+{
+    DiskControllerDevice disk(0x30, 2, 4, 16);
+    vector<uint8_t> image(2 * 4 * 16);
+    for (size_t index = 0; index < image.size(); ++index)
+        image[index] = uint8_t(index);
+    disk.LoadImage(image);
+
+    disk.Out8(0x30, 1);
+    disk.Out8(0x31, 2);
+    disk.Out8(0x32, DiskControllerDevice::CommandRead);
+    EXPECT_EQ(0, disk.In8(0x32));
+    EXPECT_EQ((4 + 1) * 16, disk.In8(0x33));
+    uint8_t data[16];
+    disk.InRepeated(0x33, data, sizeof(data));
+    EXPECT_EQ((4 + 1) * 16 + 1, data[0]);
+    EXPECT_EQ((4 + 1) * 16, data[15]);
+
+    for (auto & value : data)
+        value = 0xAA;
+    disk.Out8(0x31, 1);
+    disk.Out8(0x32, DiskControllerDevice::CommandRead);
+    disk.OutRepeated(0x33, data, sizeof(data));
+    disk.Out8(0x32, DiskControllerDevice::CommandWrite);
+    EXPECT_EQ(0, disk.In8(0x32));
+    EXPECT_EQ(0xAA, disk.Image()[4 * 16]);
+    EXPECT_EQ(0xAA, disk.Image()[5 * 16 - 1]);
+    EXPECT_EQ(5 * 16, disk.Image()[5 * 16]);
+
+    disk.Out8(0x31, 5);
+    disk.Out8(0x32, DiskControllerDevice::CommandRead);
+    EXPECT_EQ(uint8_t{ DiskControllerDevice::StatusError }, disk.In8(0x32));
+    disk.Out8(0x31, 1);
+    disk.Out8(0x32, 0x7F);
+    EXPECT_EQ(uint8_t{ DiskControllerDevice::StatusError }, disk.In8(0x32));
+}
+
+TEST_FIXTURE(IODevicesTest, TestResult)
+{
+    TestResultDevice result(0xFF);
+    EXPECT_FALSE(result.HasResult());
+    EXPECT_EQ(uint8_t{ TestResultDevice::NoResult }, result.In8(0xFF));
+    result.Out8(0xFF, TestResultDevice::Passed);
+    result.Out8(0xFF, 0x01);
+    EXPECT_TRUE(result.IsPassed());
+    EXPECT_EQ(size_t{ 2 }, result.Results().size());
+    result.Clear();
+    result.Out8(0xFF, 0x03);
+    EXPECT_FALSE(result.IsPassed());
+    EXPECT_EQ(0x03, result.In8(0xFF));
+}
+
+TEST_FIXTURE(IODevicesTest, SerialEcho)
+{
+    FastProcessorIntel8080 processor;
+    MemoryManagerPtr memoryManager = std::make_shared<MemoryManager>();
+    ROMPtr rom = std::make_shared<ROM>(0, 256);
+    memoryManager->AddMemory(rom);
+    IOManagerPtr ioManager = std::make_shared<IOManager>();
+    SerialConsoleDevicePtr serial = std::make_shared<SerialConsoleDevice>(0x00);
+    TestResultDevicePtr result = std::make_shared<TestResultDevice>(0xFF);
+    ioManager->AddIO(serial);
+    ioManager->AddIO(result);
+    processor.Setup(memoryManager, ioManager);
+    processor.LoadCode(
+    {
+        0xDB, 0x01,         // 0000 LOOP: IN 01
+        0xE6, 0x01,         // 0002 ANI 01
+        0xCA, 0x0E, 0x00,   // 0004 JZ DONE
+        0xDB, 0x00,         // 0007 IN 00
+        0xD3, 0x00,         // 0009 OUT 00
+        0xC3, 0x00, 0x00,   // 000B JMP LOOP
+        0xAF,               // 000E DONE: XRA A
+        0xD3, 0xFF,         // 000F OUT FF
+        0x76,               // 0011 HLT
+    }, 0, rom);
+    serial->Receive("Hello, world");
+    processor.Run();
+    EXPECT_EQ("Hello, world", serial->TransmittedText());
+    EXPECT_TRUE(result->IsPassed());
+}
+
+} // namespace Test
+
+} // namespace Emulator
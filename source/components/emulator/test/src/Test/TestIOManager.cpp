@@ -0,0 +1,124 @@
+#include "unit-test-c++/UnitTestC++.h"
+
+#include "emulator/IOManager.h"
+#include "emulator/IOPort.h"
+#include "emulator/SerialConsoleDevice.h"
+#include "emulator/TestResultDevice.h"
+#include "emulator/TimerDevice.h"
+
+using namespace std;
+
+namespace Emulator
+{
+
+namespace Test
+{
+
+class IOManagerTest : public UnitTestCpp::TestFixture
+{
+public:
+	virtual void SetUp();
+	virtual void TearDown();
+};
+
+void IOManagerTest::SetUp()
+{
+}
+
+void IOManagerTest::TearDown()
+{
+}
+
+TEST_FIXTURE(IOManagerTest, Construct)
+{
+    IOManager io;
+    EXPECT_EQ(size_t{ 0 }, io.Size());
+    EXPECT_EQ(size_t{ 0 }, io.GetIOPorts().size());
+    EXPECT_NULL(io.GetPort(0).io);
+    EXPECT_THROW(io.In8(0), std::runtime_error);
+    EXPECT_THROW(io.Out8(0, 0), std::runtime_error);
+}
+
+TEST_FIXTURE(IOManagerTest, PortTable)
+{
+    IOManager io;
+    IOPortPtr ioPort = std::make_shared<IOPort>(0x10, 0x10);
+    TestResultDevicePtr device = std::make_shared<TestResultDevice>(0x40);
+    io.AddIO(ioPort);
+    io.AddIO(device);
+    io.AddIO(std::make_shared<IOPort>(0x18, 0x10));
+    EXPECT_NULL(io.GetPort(0x0F).io);
+    EXPECT_EQ(ioPort.get(), io.GetPort(0x10).io);
+    EXPECT_EQ(ioPort->Data(), io.GetPort(0x10).contents);
+    EXPECT_NULL(io.GetPort(0x10).device);
+    // Ports claimed by the first block stay with it
+    EXPECT_EQ(ioPort.get(), io.GetPort(0x1F).io);
+    EXPECT_NE(ioPort.get(), io.GetPort(0x20).io);
+    EXPECT_EQ(device.get(), io.GetPort(0x40).io);
+    EXPECT_EQ(device.get(), io.GetPort(0x40).device);
+    EXPECT_NULL(io.GetPort(0x40).contents);
+
+    io.Out8(0x11, 0x12);
+    EXPECT_EQ(0x12, ioPort->In8(0x11));
+    EXPECT_EQ(0x12, io.In8(0x11));
+    io.Out8(0x40, 0x03);
+    EXPECT_EQ(0x03, device->Result());
+    EXPECT_EQ(0x03, io.In8(0x40));
+    EXPECT_THROW(io.In8(0x41), std::runtime_error);
+}
+
+TEST_FIXTURE(IOManagerTest, BeyondPortTable)
+{
+    IOManager io;
+    IOPortPtr ioPort = std::make_shared<IOPort>(0xF0, 0x20);
+    io.AddIO(ioPort);
+    io.Out8(0x100, 0x01);
+    io.Out8(0xFF, 0x02);
+    EXPECT_EQ(0x01, ioPort->In8(0x100));
+    EXPECT_EQ(0x0102, io.In16(0xFF));
+}
+
+TEST_FIXTURE(IOManagerTest, Repeated)
+{
+    IOManager io;
+    IOPortPtr ioPort = std::make_shared<IOPort>(0, 0x10);
+    TestResultDevicePtr device = std::make_shared<TestResultDevice>(0x10);
+    io.AddIO(ioPort);
+    io.AddIO(device);
+    uint8_t data[] = { 0x01, 0x02, 0x03 };
+    io.OutRepeated(0x10, data, sizeof(data));
+    EXPECT_EQ(vector<uint8_t>({ 0x01, 0x02, 0x03 }), device->Results());
+    io.OutRepeated(0x05, data, sizeof(data));
+    EXPECT_EQ(0x03, ioPort->In8(0x05));
+    EXPECT_EQ(0x00, ioPort->In8(0x06));
+    uint8_t result[2];
+    io.InRepeated(0x10, result, sizeof(result));
+    EXPECT_EQ(0x01, result[0]);
+    EXPECT_EQ(0x01, result[1]);
+}
+
+TEST_FIXTURE(IOManagerTest, PassiveIn)
+{
+    IOManager io;
+    io.AddIO(std::make_shared<IOPort>(0x00, 0x10));
+    io.AddIO(std::make_shared<TestResultDevice>(0x10));
+    io.AddIO(std::make_shared<SerialConsoleDevice>(0x20));
+    io.AddIO(std::make_shared<TimerDevice>(0x30));
+    EXPECT_TRUE(io.IsPassiveIn(0x00));
+    EXPECT_TRUE(io.IsPassiveIn(0x0F));
+    EXPECT_FALSE(io.IsPassiveIn(0x10));
+    // Serial data reads consume input, status reads do not
+    EXPECT_FALSE(io.IsPassiveIn(0x20 + SerialConsoleDevice::DataPort));
+    EXPECT_TRUE(io.IsPassiveIn(0x20 + SerialConsoleDevice::StatusPort));
+    // Timer status reads clear the expired bit
+    EXPECT_FALSE(io.IsPassiveIn(0x30 + TimerDevice::ControlPort));
+    EXPECT_TRUE(io.IsPassiveIn(0x30 + TimerDevice::PeriodLowPort));
+    EXPECT_TRUE(io.IsPassiveIn(0x30 + TimerDevice::PeriodHighPort));
+    // Unmapped
+    EXPECT_FALSE(io.IsPassiveIn(0x40));
+    EXPECT_FALSE(io.IsPassiveIn(IOManager::PortCount));
+}
+
+} // namespace Test
+
+} // namespace Emulator
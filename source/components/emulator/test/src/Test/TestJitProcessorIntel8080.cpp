@@ -0,0 +1,420 @@
+#include "unit-test-c++/UnitTestC++.h"
+
+#include "emulator/JitProcessorIntel8080.h"
+#include "TestMachineIntel8080.h"
+
+using namespace std;
+
+namespace Emulator
+{
+
+namespace Test
+{
+
+class JitProcessorIntel8080Test : public UnitTestCpp::TestFixture, public TestMachineIntel8080
+{
+public:
+	virtual void SetUp();
+	virtual void TearDown();
+
+};
+
+void JitProcessorIntel8080Test::SetUp()
+{
+}
+
+void JitProcessorIntel8080Test::TearDown()
+{
+}
+
+TEST_FIXTURE(JitProcessorIntel8080Test, Construct)
+{
+    JitProcessorIntel8080 processor;
+    RegistersIntel8080 & registers = processor.GetRegisters();
+    EXPECT_EQ(0, registers.pc);
+    EXPECT_FALSE(registers.isHalted);
+    EXPECT_NULL(processor.GetMemoryManager());
+    EXPECT_EQ(uint8_t{ JitProcessorIntel8080::DefaultHotThreshold }, processor.GetHotThreshold());
+    EXPECT_EQ(size_t{ 0 }, processor.TranslatedBlockCount());
+    processor.SetHotThreshold(0);
+    EXPECT_EQ(1, processor.GetHotThreshold());
+}
+
+TEST_FIXTURE(JitProcessorIntel8080Test, RunInstructionMatchesProcessorIntel8080)
+{
+    // Each opcode is followed by INR M, STAX B and HLT, all jumps, calls and returns end on a HLT
+    vector<uint8_t> code(ROMSize, 0x76);
+    vector<uint8_t> halt = { 0x76 };
+    for (int opcode = 0; opcode < 256; ++opcode)
+    {
+        for (FlagsIntel8080 flags : { FlagsIntel8080::None, FlagsIntel8080(0xD5) })
+        {
+            ProcessorIntel8080 reference;
+            JitProcessorIntel8080 processor;
+            processor.SetHotThreshold(1);
+            code[0x40] = uint8_t(opcode);
+            code[0x41] = 0x34;
+            code[0x42] = 0x02;
+            for (ProcessorIntel8080 * cpu : { &reference, static_cast<ProcessorIntel8080 *>(&processor) })
+            {
+                SetupProcessor(*cpu, code);
+                cpu->GetMemoryManager()->Store(0x0234, halt);
+                cpu->GetMemoryManager()->Store(0x0567, halt);
+                RegistersIntel8080 & registers = cpu->GetRegisters();
+                registers.pc = 0x0040;
+                registers.bc.W = 0x0123;
+                registers.de.W = 0x0345;
+                registers.hl.W = 0x0567;
+                registers.sp.W = 0x0800;
+                registers.a = 0x9A;
+                registers.flags = flags;
+            }
+
+            bool referenceThrows = false;
+            bool processorThrows = false;
+            try
+            {
+                reference.Run();
+            }
+            catch (std::exception &)
+            {
+                referenceThrows = true;
+            }
+            try
+            {
+                processor.Run();
+            }
+            catch (std::exception &)
+            {
+                processorThrows = true;
+            }
+            // Translated code reports memory errors with pc at the start of the instruction
+            EXPECT_EQ(referenceThrows, processorThrows);
+            if (referenceThrows)
+                continue;
+            AssertRegisters(reference.GetRegisters(), processor.GetRegisters());
+            EXPECT_EQ(reference.GetMemoryManager()->Fetch(ROMSize, RAMSize), processor.GetMemoryManager()->Fetch(ROMSize, RAMSize));
+        }
+    }
+}
+
+TEST_FIXTURE(JitProcessorIntel8080Test, RunMultiply)
+{
+    ProcessorIntel8080 reference;
+    JitProcessorIntel8080 processor;
+    processor.SetHotThreshold(1);
+    SetupProcessor(reference, Multiply3x7());
+    SetupProcessor(processor, Multiply3x7());
+    reference.Run();
+    processor.Run();
+
+    RegistersIntel8080 & registers = processor.GetRegisters();
+    EXPECT_TRUE(registers.isHalted);
+    EXPECT_EQ(0x1A, registers.pc);
+    AssertRegisters(reference.GetRegisters(), registers);
+    if (JitProcessorIntel8080::IsSupported())
+    {
+        EXPECT_NE(size_t{ 0 }, processor.TranslatedBlockCount());
+        EXPECT_NE(size_t{ 0 }, processor.CodeCacheUsed());
+    }
+}
+
+TEST_FIXTURE(JitProcessorIntel8080Test, RunRandomProgramsMatchProcessorIntel8080)
+{
+    // Random valid instructions as code, the rest of memory HLT, so stray jumps and returns end the program
+    uint32_t seed = 8080;
+    for (int program = 0; program < 200; ++program)
+    {
+        vector<uint8_t> code(MemoryManager::AddressSpaceSize, 0x76);
+        for (size_t address = 0x1000; address < 0x1080; ++address)
+        {
+            do
+            {
+                seed = seed * 1103515245 + 12345;
+                code[address] = uint8_t(seed >> 16);
+            }
+            while (ProcessorIntel8080::GetInstructionData(OpcodesIntel8080(code[address])).instructionSize == 0);
+        }
+        ProcessorIntel8080 reference;
+        JitProcessorIntel8080 processor;
+        processor.SetHotThreshold(1);
+        SetupProcessorRAM(reference, code);
+        SetupProcessorRAM(processor, code);
+        for (RegistersIntel8080 * registers : { &reference.GetRegisters(), &processor.GetRegisters() })
+        {
+            registers->pc = 0x1000;
+            registers->bc.W = 0x1010;
+            registers->de.W = 0x1050;
+            registers->hl.W = 0x1040;
+            registers->sp.W = 0x2000;
+        }
+
+        // Stores can still write invalid instructions into the code
+        bool referenceThrows = false;
+        bool processorThrows = false;
+        try
+        {
+            reference.Run(size_t{ 100000 });
+        }
+        catch (std::exception &)
+        {
+            referenceThrows = true;
+        }
+        try
+        {
+            processor.Run(size_t{ 100000 });
+        }
+        catch (std::exception &)
+        {
+            processorThrows = true;
+        }
+        EXPECT_EQ(referenceThrows, processorThrows);
+        // Runs ended by the budget stop at a different cycle, as blocks are only checked at their end
+        EXPECT_EQ(reference.GetRegisters().isHalted, processor.GetRegisters().isHalted);
+        if (referenceThrows || !reference.GetRegisters().isHalted)
+            continue;
+        AssertRegisters(reference.GetRegisters(), processor.GetRegisters());
+        EXPECT_TRUE(reference.GetMemoryManager()->Fetch(0, MemoryManager::AddressSpaceSize) ==
+                    processor.GetMemoryManager()->Fetch(0, MemoryManager::AddressSpaceSize));
+    }
+}
+
+TEST_FIXTURE(JitProcessorIntel8080Test, RunChained)
+{
+    vector<uint8_t> code =
+    {
+        0x31, 0x00, 0x08,   // 0000 LXI SP,0800
+        0x06, 0x0A,         // 0003 MVI B,0A
+        0x05,               // 0005 LOOP: DCR B
+        0xC2, 0x05, 0x00,   // 0006 JNZ LOOP
+        0x76,               // 0009 HLT
+    };
+    ProcessorIntel8080 reference;
+    JitProcessorIntel8080 processor;
+    processor.SetHotThreshold(1);
+    SetupProcessor(reference, code);
+    SetupProcessor(processor, code);
+    reference.Run();
+    processor.Run();
+    AssertRegisters(reference.GetRegisters(), processor.GetRegisters());
+
+    if (JitProcessorIntel8080::IsSupported())
+    {
+        // The loop jumps to itself without returning to the run loop
+        JitStatistics const & statistics = processor.GetStatistics();
+        EXPECT_EQ(size_t{ 2 }, statistics.translations);
+        EXPECT_EQ(size_t{ 2 }, statistics.entries);
+        EXPECT_EQ(size_t{ 1 }, statistics.interpretedInstructions);
+        EXPECT_EQ(size_t{ 2 }, processor.TranslatedBlockCount());
+    }
+    processor.FlushCache();
+    EXPECT_EQ(size_t{ 0 }, processor.TranslatedBlockCount());
+}
+
+TEST_FIXTURE(JitProcessorIntel8080Test, RunSelfModifyingCode)
+{
+    vector<uint8_t> code =
+    {
+        0x31, 0x00, 0x08,   // 0000 LXI SP,0800
+        0x06, 0x04,         // 0003 MVI B,04
+        0xCD, 0x20, 0x00,   // 0005 LOOP: CALL 0020
+        0x3E, 0x0C,         // 0008 MVI A,0C        INR C
+        0x32, 0x20, 0x00,   // 000A STA 0020
+        0x05,               // 000D DCR B
+        0xC2, 0x05, 0x00,   // 000E JNZ LOOP
+        0x3E, 0x14,         // 0011 MVI A,14        INR D
+        0x32, 0x18, 0x00,   // 0013 STA 0018, in the block being run
+        0x00,               // 0016 NOP
+        0x00,               // 0017 NOP
+        0x00,               // 0018 NOP
+        0x76,               // 0019 HLT
+        0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+        0x00,               // 0020 NOP
+        0xC9,               // 0021 RET
+    };
+    ProcessorIntel8080 reference;
+    JitProcessorIntel8080 processor;
+    processor.SetHotThreshold(1);
+    SetupProcessorRAM(reference, code);
+    SetupProcessorRAM(processor, code);
+    reference.Run();
+    processor.Run();
+
+    RegistersIntel8080 & registers = processor.GetRegisters();
+    EXPECT_EQ(0x03, registers.bc.B.l);
+    EXPECT_EQ(0x01, registers.de.B.h);
+    AssertRegisters(reference.GetRegisters(), registers);
+    if (JitProcessorIntel8080::IsSupported())
+    {
+        EXPECT_EQ(size_t{ 5 }, processor.GetStatistics().invalidations);
+    }
+}
+
+TEST_FIXTURE(JitProcessorIntel8080Test, RunCodeCacheFull)
+{
+    ProcessorIntel8080 reference;
+    JitProcessorIntel8080 processor(384);
+    processor.SetHotThreshold(1);
+    SetupProcessor(reference, Multiply3x7());
+    SetupProcessor(processor, Multiply3x7());
+    reference.Run();
+    processor.Run();
+
+    AssertRegisters(reference.GetRegisters(), processor.GetRegisters());
+    if (JitProcessorIntel8080::IsSupported())
+    {
+        EXPECT_NE(size_t{ 0 }, processor.GetStatistics().flushes);
+        EXPECT_TRUE(processor.CodeCacheUsed() <= 384);
+    }
+}
+
+TEST_FIXTURE(JitProcessorIntel8080Test, RunBudgetPeriodic)
+{
+    ProcessorIntel8080 reference;
+    JitProcessorIntel8080 processor;
+    processor.SetHotThreshold(1);
+    SetupProcessor(reference, { 0xC3, 0x00, 0x00 });    // JMP 0000
+    SetupProcessor(processor, { 0xC3, 0x00, 0x00 });
+    size_t referenceCalls = 0;
+    size_t calls = 0;
+    reference.SetupLoop([&referenceCalls](RegistersIntel8080 &) { ++referenceCalls; return InterruptFlagsIntel8080::None; });
+    processor.SetupLoop([&calls](RegistersIntel8080 &) { ++calls; return InterruptFlagsIntel8080::None; });
+    for (RegistersIntel8080 * registers : { &reference.GetRegisters(), &processor.GetRegisters() })
+    {
+        registers->cycleCountPeriod = 1000;
+        registers->cycleCount = 1000;
+    }
+    EXPECT_EQ(size_t{ 10000 }, reference.Run(10000));
+    EXPECT_EQ(size_t{ 10000 }, processor.Run(10000));
+    EXPECT_EQ(size_t{ 10 }, referenceCalls);
+    EXPECT_EQ(size_t{ 10 }, calls);
+    AssertRegisters(reference.GetRegisters(), processor.GetRegisters());
+}
+
+TEST_FIXTURE(JitProcessorIntel8080Test, RunPeriodicInterruptWakesHalted)
+{
+    vector<uint8_t> code =
+    {
+        0x31, 0x00, 0x08,   // 0000 LXI SP,0800
+        0xFB,               // 0003 EI
+        0x76,               // 0004 HLT
+        0x00, 0x00, 0x00,
+        0x3E, 0x55,         // 0008 MVI A,55
+        0x76,               // 000A HLT
+    };
+    ProcessorIntel8080 reference;
+    JitProcessorIntel8080 processor;
+    processor.SetHotThreshold(1);
+    SetupProcessor(reference, code);
+    SetupProcessor(processor, code);
+    size_t calls[2] = {};
+    for (ProcessorIntel8080 * cpu : { &reference, static_cast<ProcessorIntel8080 *>(&processor) })
+    {
+        size_t & count = calls[cpu == &reference ? 0 : 1];
+        cpu->SetupLoop([&count](RegistersIntel8080 &) { ++count; return InterruptFlagsIntel8080(0x0008); });  // RST 1
+        cpu->GetRegisters().cycleCountPeriod = 100;
+        cpu->GetRegisters().cycleCount = 100;
+        // Loop() keeps being called while halted, with interrupts disabled after the first one
+        EXPECT_EQ(size_t{ 1000 }, cpu->Run(size_t{ 1000 }));
+    }
+
+    RegistersIntel8080 & registers = processor.GetRegisters();
+    EXPECT_TRUE(registers.isHalted);
+    EXPECT_FALSE(registers.ie);
+    EXPECT_EQ(0x55, registers.a);
+    EXPECT_EQ(0x000B, registers.pc);
+    EXPECT_EQ(0x0005, processor.GetMemoryManager()->Fetch16(0x07FE));
+    EXPECT_EQ(uint64_t{ 1000 }, registers.cycleCountTotal);
+    EXPECT_EQ(size_t{ 10 }, calls[0]);
+    EXPECT_EQ(size_t{ 10 }, calls[1]);
+    AssertRegisters(reference.GetRegisters(), registers);
+}
+
+TEST_FIXTURE(JitProcessorIntel8080Test, RunScheduledInterrupt)
+{
+    vector<uint8_t> code =
+    {
+        0x31, 0x00, 0x08,   // 0000 LXI SP,0800
+        0x06, 0x0A,         // 0003 MVI B,0A
+        0x05,               // 0005 LOOP: DCR B
+        0xC2, 0x05, 0x00,   // 0006 JNZ LOOP
+        0xFB,               // 0009 EI
+        0x00,               // 000A NOP
+        0xC3, 0x0B, 0x00,   // 000B JMP 000B
+        0x00, 0x00,
+        0x3E, 0x55,         // 0010 MVI A,55
+        0x76,               // 0012 HLT
+    };
+    ProcessorIntel8080 reference;
+    JitProcessorIntel8080 processor;
+    processor.SetHotThreshold(1);
+    SetupProcessor(reference, code);
+    SetupProcessor(processor, code);
+    for (ProcessorIntel8080 * cpu : { &reference, static_cast<ProcessorIntel8080 *>(&processor) })
+    {
+        cpu->GetScheduler().Schedule(50, [cpu](uint64_t) { cpu->GetInterruptController().Request(2); });
+        cpu->Run(size_t{ 10000 });
+    }
+
+    RegistersIntel8080 & registers = processor.GetRegisters();
+    EXPECT_TRUE(registers.isHalted);
+    EXPECT_EQ(0x55, registers.a);
+    EXPECT_EQ(0x000B, processor.GetMemoryManager()->Fetch16(0x07FE));
+    AssertRegisters(reference.GetRegisters(), registers);
+}
+
+TEST_FIXTURE(JitProcessorIntel8080Test, RunScheduledInterruptWakesHalted)
+{
+    vector<uint8_t> code =
+    {
+        0x31, 0x00, 0x08,   // 0000 LXI SP,0800
+        0xFB,               // 0003 EI
+        0x76,               // 0004 HLT
+        0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+        0x3E, 0x55,         // 0010 MVI A,55
+        0x76,               // 0012 HLT
+    };
+    ProcessorIntel8080 reference;
+    JitProcessorIntel8080 processor;
+    processor.SetHotThreshold(1);
+    SetupProcessor(reference, code);
+    SetupProcessor(processor, code);
+    for (ProcessorIntel8080 * cpu : { &reference, static_cast<ProcessorIntel8080 *>(&processor) })
+    {
+        cpu->GetScheduler().Schedule(1000, [cpu](uint64_t) { cpu->GetInterruptController().Request(2); });
+        for (int slice = 0; slice < 10; ++slice)
+        {
+            cpu->Run(size_t{ 500 });
+        }
+    }
+
+    RegistersIntel8080 & registers = processor.GetRegisters();
+    EXPECT_TRUE(registers.isHalted);
+    EXPECT_EQ(0x55, registers.a);
+    EXPECT_EQ(0x0005, processor.GetMemoryManager()->Fetch16(0x07FE));
+    EXPECT_EQ(uint64_t{ 1014 }, registers.cycleCountTotal);
+    AssertRegisters(reference.GetRegisters(), registers);
+}
+
+TEST_FIXTURE(JitProcessorIntel8080Test, RunMemoryError)
+{
+    // Store to ROM from translated code
+    JitProcessorIntel8080 processor;
+    processor.SetHotThreshold(1);
+    SetupProcessor(processor,
+    {
+        0x3E, 0x12,         // 0000 MVI A,12
+        0x32, 0x10, 0x00,   // 0002 STA 0010
+        0x76,               // 0005 HLT
+    });
+    EXPECT_THROW(processor.Run(), std::runtime_error);
+    if (JitProcessorIntel8080::IsSupported())
+    {
+        EXPECT_EQ(0x0002, processor.GetRegisters().pc);
+        EXPECT_EQ(0x12, processor.GetRegisters().a);
+    }
+}
+
+} // namespace Test
+
+} // namespace Emulator
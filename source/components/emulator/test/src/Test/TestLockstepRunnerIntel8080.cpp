@@ -0,0 +1,368 @@
+#include "unit-test-c++/UnitTestC++.h"
+
+#include "emulator/LockstepRunnerIntel8080.h"
+
+using namespace std;
+
+namespace Emulator
+{
+
+namespace Test
+{
+
+class LockstepRunnerIntel8080Test : public UnitTestCpp::TestFixture
+{
+public:
+	virtual void SetUp();
+	virtual void TearDown();
+
+    static Assembler::ObjectCode CreateImage(vector<uint8_t> const & code);
+    static uint8_t Random(uint32_t & seed);
+    // Runs the image in lockstep and one lane at a time, and checks that all lanes end up the same
+    static BatchResultsIntel8080 RunBoth(Assembler::ObjectCode const & image, vector<LockstepInputIntel8080> const & inputs,
+                                         vector<pair<uint16_t, size_t>> const & memory, LockstepStatisticsIntel8080 & statistics,
+                                         size_t maxCycles = LockstepRunnerIntel8080::DefaultMaxCycles);
+};
+
+void LockstepRunnerIntel8080Test::SetUp()
+{
+}
+
+void LockstepRunnerIntel8080Test::TearDown()
+{
+}
+
+Assembler::ObjectCode LockstepRunnerIntel8080Test::CreateImage(vector<uint8_t> const & code)
+{
+    Assembler::ObjectCode objectCode("test");
+    objectCode.GetSegment(Assembler::SegmentID::ASEG).SetOffset(0);
+    objectCode.GetSegment(Assembler::SegmentID::ASEG).SetData(code);
+    return objectCode;
+}
+
+uint8_t LockstepRunnerIntel8080Test::Random(uint32_t & seed)
+{
+    seed = seed * 1103515245 + 12345;
+    return uint8_t(seed >> 16);
+}
+
+BatchResultsIntel8080 LockstepRunnerIntel8080Test::RunBoth(Assembler::ObjectCode const & image, vector<LockstepInputIntel8080> const & inputs,
+                                                           vector<pair<uint16_t, size_t>> const & memory, LockstepStatisticsIntel8080 & statistics,
+                                                           size_t maxCycles)
+{
+    LockstepRunnerIntel8080 lockstep(maxCycles);
+    LockstepRunnerIntel8080 scalar(maxCycles);
+    scalar.SetLockstep(false);
+    BatchResultsIntel8080 results = lockstep.Run(image, inputs);
+    BatchResultsIntel8080 expected = scalar.Run(image, inputs);
+    statistics = lockstep.GetStatistics();
+    EXPECT_EQ(size_t{ 0 }, scalar.GetStatistics().lockstepInstructions);
+    EXPECT_EQ(expected.size(), results.size());
+    for (size_t lane = 0; lane < expected.size(); ++lane)
+    {
+        RegistersIntel8080 const & actualRegisters = results[lane].registers;
+        RegistersIntel8080 const & expectedRegisters = expected[lane].registers;
+        EXPECT_EQ(lane, results[lane].index);
+        EXPECT_EQ(expected[lane].halted, results[lane].halted);
+        EXPECT_EQ(expected[lane].timedOut, results[lane].timedOut);
+        EXPECT_EQ(expected[lane].error, results[lane].error);
+        EXPECT_EQ(expectedRegisters.pc, actualRegisters.pc);
+        EXPECT_EQ(expectedRegisters.sp.W, actualRegisters.sp.W);
+        EXPECT_EQ(expectedRegisters.bc.W, actualRegisters.bc.W);
+        EXPECT_EQ(expectedRegisters.de.W, actualRegisters.de.W);
+        EXPECT_EQ(expectedRegisters.hl.W, actualRegisters.hl.W);
+        EXPECT_EQ(expectedRegisters.wz.W, actualRegisters.wz.W);
+        EXPECT_EQ(expectedRegisters.a, actualRegisters.a);
+        EXPECT_EQ(uint8_t(expectedRegisters.flags), uint8_t(actualRegisters.flags));
+        EXPECT_EQ(expectedRegisters.ie, actualRegisters.ie);
+        EXPECT_EQ(expectedRegisters.instructionCycles, actualRegisters.instructionCycles);
+        EXPECT_EQ(expectedRegisters.cycleCountTotal, actualRegisters.cycleCountTotal);
+        for (auto const & block : memory)
+        {
+            EXPECT_TRUE(scalar.GetRAM(lane)->Fetch(block.first, block.second) == lockstep.GetRAM(lane)->Fetch(block.first, block.second));
+        }
+        EXPECT_TRUE(scalar.GetIOPort(lane)->In(0, 256) == lockstep.GetIOPort(lane)->In(0, 256));
+    }
+    return results;
+}
+
+TEST_FIXTURE(LockstepRunnerIntel8080Test, Construct)
+{
+    LockstepRunnerIntel8080 runner(1000);
+    EXPECT_EQ(size_t{ 1000 }, runner.MaxCycles());
+    EXPECT_TRUE(runner.GetLockstep());
+    EXPECT_EQ(size_t{ 0 }, runner.Run(CreateImage({ 0x76 }), {}).size());
+    EXPECT_EQ(size_t{ 0 }, runner.LaneCount());
+    EXPECT_NULL(runner.GetRAM(0));
+}
+
+TEST_FIXTURE(LockstepRunnerIntel8080Test, Checksum)
+{
+    // 0000 LXI H,1000; 0003 MVI B,10; 0005 XRA A; 0006 LOOP: ADD M; 0007 INX H; 0008 DCR B; 0009 JNZ LOOP;
+    // 000C STA 2000; 000F HLT
+    Assembler::ObjectCode image = CreateImage({ 0x21, 0x00, 0x10, 0x06, 0x10, 0xAF, 0x86, 0x23, 0x05, 0xC2, 0x06, 0x00,
+                                                0x32, 0x00, 0x20, 0x76 });
+    // Not a multiple of the vector width
+    vector<LockstepInputIntel8080> inputs;
+    vector<uint8_t> sums;
+    uint32_t seed = 1;
+    for (size_t lane = 0; lane < 37; ++lane)
+    {
+        vector<uint8_t> data;
+        uint8_t sum = 0;
+        for (size_t index = 0; index < 16; ++index)
+        {
+            data.push_back(Random(seed));
+            sum += data.back();
+        }
+        inputs.emplace_back(0x1000, data);
+        sums.push_back(sum);
+    }
+    LockstepStatisticsIntel8080 statistics;
+    BatchResultsIntel8080 results = RunBoth(image, inputs, { { 0x1000, 16 }, { 0x2000, 1 } }, statistics);
+
+    LockstepRunnerIntel8080 runner;
+    results = runner.Run(image, inputs);
+    EXPECT_EQ(size_t{ 37 }, runner.LaneCount());
+    for (size_t lane = 0; lane < inputs.size(); ++lane)
+    {
+        EXPECT_TRUE(results[lane].Succeeded());
+        EXPECT_EQ(size_t{ 10 + 7 + 4 + 16 * (7 + 5 + 5 + 10) + 13 + 7 }, results[lane].registers.cycleCountTotal);
+        EXPECT_EQ(sums[lane], results[lane].registers.a);
+        EXPECT_EQ(sums[lane], runner.GetRAM(lane)->Fetch8(0x2000));
+    }
+    // All lanes take the same path
+    EXPECT_EQ(size_t{ 69 }, runner.GetStatistics().lockstepInstructions);
+    EXPECT_EQ(size_t{ 69 * 37 }, runner.GetStatistics().lockstepLaneInstructions);
+    EXPECT_EQ(size_t{ 0 }, runner.GetStatistics().scalarCycles);
+    EXPECT_EQ(size_t{ 0 }, runner.GetStatistics().divergedLanes);
+}
+
+TEST_FIXTURE(LockstepRunnerIntel8080Test, Blocks)
+{
+    // 0000 LXI H,1000; 0003 MOV A,M; 0004 INR A; 0005 MOV M,A; 0006 HLT
+    Assembler::ObjectCode image = CreateImage({ 0x21, 0x00, 0x10, 0x7E, 0x3C, 0x77, 0x76 });
+    vector<LockstepInputIntel8080> inputs;
+    for (size_t lane = 0; lane < LockstepRunnerIntel8080::BlockLanes + 10; ++lane)
+    {
+        inputs.emplace_back(0x1000, vector<uint8_t>{ uint8_t(lane) });
+    }
+    LockstepStatisticsIntel8080 statistics;
+    BatchResultsIntel8080 results = RunBoth(image, inputs, { { 0x1000, 1 } }, statistics);
+    for (size_t lane = 0; lane < inputs.size(); ++lane)
+    {
+        EXPECT_TRUE(results[lane].Succeeded());
+        EXPECT_EQ(uint8_t(lane + 1), results[lane].registers.a);
+    }
+    // Every block runs the program from the start
+    EXPECT_EQ(size_t{ 2 * 5 }, statistics.lockstepInstructions);
+    EXPECT_EQ(size_t{ 5 * inputs.size() }, statistics.lockstepLaneInstructions);
+    EXPECT_EQ(size_t{ 0 }, statistics.scalarCycles);
+
+    // Too few lanes for lockstep
+    inputs.resize(LockstepRunnerIntel8080::MinLockstepLanes - 1);
+    results = RunBoth(image, inputs, { { 0x1000, 1 } }, statistics);
+    for (size_t lane = 0; lane < inputs.size(); ++lane)
+    {
+        EXPECT_TRUE(results[lane].Succeeded());
+        EXPECT_EQ(uint8_t(lane + 1), results[lane].registers.a);
+    }
+    EXPECT_EQ(size_t{ 0 }, statistics.lockstepInstructions);
+    EXPECT_EQ(size_t{ 0 }, statistics.divergedLanes);
+    EXPECT_NE(size_t{ 0 }, statistics.scalarCycles);
+}
+
+TEST_FIXTURE(LockstepRunnerIntel8080Test, BCDAddition)
+{
+    // 0000 LXI H,1000; 0003 MOV A,M; 0004 INX H; 0005 INX H; 0006 ADD M; 0007 DAA; 0008 STA 1004;
+    // 000B DCX H; 000C MOV A,M; 000D INX H; 000E INX H; 000F ADC M; 0010 DAA; 0011 STA 1005; 0014 HLT
+    Assembler::ObjectCode image = CreateImage({ 0x21, 0x00, 0x10, 0x7E, 0x23, 0x23, 0x86, 0x27, 0x32, 0x04, 0x10,
+                                                0x2B, 0x7E, 0x23, 0x23, 0x8E, 0x27, 0x32, 0x05, 0x10, 0x76 });
+    vector<LockstepInputIntel8080> inputs;
+    for (int lane = 0; lane < 40; ++lane)
+    {
+        int x = (lane * 2719) % 10000;
+        int y = (lane * 7919 + 1234) % 10000;
+        auto bcd = [](int value) { return uint8_t(((value / 10) % 10) << 4 | (value % 10)); };
+        inputs.emplace_back(0x1000, vector<uint8_t>{ bcd(x), bcd(x / 100), bcd(y), bcd(y / 100) });
+    }
+    LockstepStatisticsIntel8080 statistics;
+    BatchResultsIntel8080 results = RunBoth(image, inputs, { { 0x1000, 6 } }, statistics);
+    LockstepRunnerIntel8080 runner;
+    results = runner.Run(image, inputs);
+    for (int lane = 0; lane < 40; ++lane)
+    {
+        int sum = ((lane * 2719) % 10000 + (lane * 7919 + 1234) % 10000) % 10000;
+        auto bcd = [](int value) { return uint8_t(((value / 10) % 10) << 4 | (value % 10)); };
+        EXPECT_TRUE(results[lane].Succeeded());
+        EXPECT_EQ(bcd(sum), runner.GetRAM(lane)->Fetch8(0x1004));
+        EXPECT_EQ(bcd(sum / 100), runner.GetRAM(lane)->Fetch8(0x1005));
+    }
+    EXPECT_EQ(size_t{ 0 }, statistics.scalarCycles);
+    EXPECT_EQ(size_t{ 0 }, statistics.divergedLanes);
+}
+
+TEST_FIXTURE(LockstepRunnerIntel8080Test, Diverge)
+{
+    // Counts the bits of the input, the number of iterations depends on the input
+    // 0000 LDA 1000; 0003 MVI B,0; 0005 LOOP: ORA A; 0006 JZ DONE; 0009 ADD A; 000A JNC LOOP; 000D INR B;
+    // 000E JMP LOOP; 0011 DONE: MOV A,B; 0012 STA 1001; 0015 HLT
+    Assembler::ObjectCode image = CreateImage({ 0x3A, 0x00, 0x10, 0x06, 0x00, 0xB7, 0xCA, 0x11, 0x00, 0x87, 0xD2, 0x05, 0x00,
+                                                0x04, 0xC3, 0x05, 0x00, 0x78, 0x32, 0x01, 0x10, 0x76 });
+    vector<LockstepInputIntel8080> inputs;
+    for (size_t lane = 0; lane < 64; ++lane)
+    {
+        inputs.emplace_back(0x1000, vector<uint8_t>{ uint8_t(lane * 4 + 1) });
+    }
+    LockstepStatisticsIntel8080 statistics;
+    BatchResultsIntel8080 results = RunBoth(image, inputs, { { 0x1000, 2 } }, statistics);
+    for (size_t lane = 0; lane < inputs.size(); ++lane)
+    {
+        uint8_t value = uint8_t(lane * 4 + 1);
+        int bits = 0;
+        for (; value != 0; value >>= 1)
+            bits += value & 1;
+        EXPECT_TRUE(results[lane].Succeeded());
+        EXPECT_EQ(bits, results[lane].registers.a);
+    }
+    EXPECT_NE(size_t{ 0 }, statistics.divergedLanes);
+    EXPECT_NE(size_t{ 0 }, statistics.lockstepLaneInstructions);
+    EXPECT_NE(size_t{ 0 }, statistics.scalarCycles);
+}
+
+TEST_FIXTURE(LockstepRunnerIntel8080Test, AllInstructions)
+{
+    vector<uint8_t> code(0x112);
+    auto place = [&code](uint16_t address, vector<uint8_t> const & bytes)
+    {
+        copy(bytes.begin(), bytes.end(), code.begin() + address);
+    };
+    place(0x0000, { 0xC3, 0x80, 0x00 });                    // JMP MAIN
+    place(0x0008, { 0x04, 0x0C, 0xC9 });                    // RST 1: INR B; INR C; RET
+    // SUB: ANI 0F; CPI 08; RC; ADI 03; CPE SUB2; SUI 01; RET
+    place(0x0060, { 0xE6, 0x0F, 0xFE, 0x08, 0xD8, 0xC6, 0x03, 0xEC, 0x70, 0x00, 0xD6, 0x01, 0xC9 });
+    // SUB2: SBI 02; ACI 05; XRI 55; ORI 80; RET
+    place(0x0070, { 0xDE, 0x02, 0xCE, 0x05, 0xEE, 0x55, 0xF6, 0x80, 0xC9 });
+    place(0x0080,
+    {
+        0x31, 0x00, 0x30,       // LXI SP,3000
+        0x2A, 0x00, 0x10,       // LHLD 1000
+        0x3A, 0x02, 0x10,       // LDA 1002
+        0x01, 0x34, 0x12,       // LXI B,1234
+        0x11, 0x78, 0x56,       // LXI D,5678
+        0x09, 0x19, 0x29, 0x39, // DAD B; DAD D; DAD H; DAD SP
+        0xE5, 0xF5, 0xEB, 0xE3, // PUSH H; PUSH PSW; XCHG; XTHL
+        0xCD, 0x60, 0x00,       // CALL SUB
+        0xF1, 0xC1,             // POP PSW; POP B
+        0x07, 0x0F, 0x17, 0x1F, // RLC; RRC; RAL; RAR
+        0x2F, 0x37, 0x3F,       // CMA; STC; CMC
+        0xD3, 0x10,             // OUT 10
+        0xDB, 0x11,             // IN 11
+        0x22, 0x04, 0x10,       // SHLD 1004
+        0x21, 0x10, 0x10,       // LXI H,1010
+        0x77, 0x34, 0x35, 0x35, // MOV M,A; INR M; DCR M; DCR M
+        0x86, 0x8E, 0x96, 0x9E, // ADD M; ADC M; SUB M; SBB M
+        0xA6, 0xAE, 0xB6, 0xBE, // ANA M; XRA M; ORA M; CMP M
+        0x46,                   // MOV B,M
+        0x36, 0x5A,             // MVI M,5A
+        0x01, 0x20, 0x10,       // LXI B,1020
+        0x02, 0x0A,             // STAX B; LDAX B
+        0x11, 0x21, 0x10,       // LXI D,1021
+        0x12, 0x1A,             // STAX D; LDAX D
+        0xCF,                   // RST 1
+        0x03, 0x13, 0x23, 0x33, // INX B; INX D; INX H; INX SP
+        0x0B, 0x1B, 0x2B, 0x3B, // DCX B; DCX D; DCX H; DCX SP
+        0x80, 0x89, 0x92, 0x9B, // ADD B; ADC C; SUB D; SBB E
+        0xA4, 0xAD, 0xB7, 0xB9, // ANA H; XRA L; ORA A; CMP C
+        0x27,                   // DAA
+        0x32, 0x06, 0x10,       // STA 1006
+        0xFB, 0xF3,             // EI; DI
+        0x21, 0xE4, 0x00,       // LXI H,00E4
+        0xE9,                   // PCHL
+    });
+    place(0x00E4,
+    {
+        0x21, 0x00, 0x30,       // LXI H,3000
+        0xF9,                   // SPHL
+        0xDA, 0xEE, 0x00,       // JC 00EE
+        0xC2, 0xEE, 0x00,       // JNZ 00EE
+        0x04, 0x0D, 0x14, 0x1D, // INR B; DCR C; INR D; DCR E
+        0x24, 0x2D, 0x3C, 0x3D, // INR H; DCR L; INR A; DCR A
+        0x06, 0x11, 0x0E, 0x22, // MVI B,11; MVI C,22
+        0x16, 0x33, 0x1E, 0x44, // MVI D,33; MVI E,44
+        0x26, 0x55, 0x2E, 0x66, // MVI H,55; MVI L,66
+        0x3E, 0x77,             // MVI A,77
+        0x41, 0x4A, 0x53, 0x5C, // MOV B,C; MOV C,D; MOV D,E; MOV E,H
+        0x65, 0x6F, 0x78,       // MOV H,L; MOV L,A; MOV A,B
+        0xF4, 0x10, 0x01,       // CP 0110
+        0x76,                   // HLT
+        0x00,
+        0xC0, 0xC9,             // 0110: RNZ; RET
+    });
+    vector<LockstepInputIntel8080> inputs;
+    uint32_t seed = 7;
+    for (size_t lane = 0; lane < 64; ++lane)
+    {
+        vector<uint8_t> data = { Random(seed), Random(seed), Random(seed) };
+        vector<uint8_t> io(0x12);
+        io[0x11] = Random(seed);
+        inputs.emplace_back(0x1000, data, io);
+    }
+    LockstepStatisticsIntel8080 statistics;
+    BatchResultsIntel8080 results = RunBoth(CreateImage(code), inputs, { { 0x1000, 0x30 }, { 0x2F00, 0x100 } }, statistics);
+    for (auto const & result : results)
+    {
+        EXPECT_TRUE(result.Succeeded());
+    }
+    EXPECT_NE(size_t{ 0 }, statistics.lockstepInstructions);
+}
+
+TEST_FIXTURE(LockstepRunnerIntel8080Test, Errors)
+{
+    // 0000 LHLD 1000; 0003 MOV M,A; 0004 HLT
+    // Stores to ROM fail for the lanes pointing HL at it
+    Assembler::ObjectCode image = CreateImage({ 0x2A, 0x00, 0x10, 0x77, 0x76 });
+    vector<LockstepInputIntel8080> inputs;
+    for (size_t lane = 0; lane < 10; ++lane)
+    {
+        inputs.emplace_back(0x1000, vector<uint8_t>{ uint8_t((lane % 3 == 0) ? 0x02 : 0x00), uint8_t((lane % 3 == 0) ? 0x00 : 0x20) });
+    }
+    // Data outside of RAM
+    inputs.emplace_back(0x0000, vector<uint8_t>{ 0x00 });
+    LockstepStatisticsIntel8080 statistics;
+    BatchResultsIntel8080 results = RunBoth(image, inputs, { { 0x1000, 2 } }, statistics);
+    for (size_t lane = 0; lane < 10; ++lane)
+    {
+        EXPECT_EQ(lane % 3 != 0, results[lane].Succeeded());
+    }
+    EXPECT_FALSE(results[10].Succeeded());
+    EXPECT_FALSE(results[10].error.empty());
+    EXPECT_EQ(size_t{ 0 }, results[10].registers.cycleCountTotal);
+
+    // Invalid instruction: 0000 NOP; 0001 (08)
+    results = RunBoth(CreateImage({ 0x00, 0x08 }), vector<LockstepInputIntel8080>(3), {}, statistics);
+    for (auto const & result : results)
+    {
+        EXPECT_FALSE(result.error.empty());
+        EXPECT_EQ(size_t{ 4 }, result.registers.cycleCountTotal);
+    }
+}
+
+TEST_FIXTURE(LockstepRunnerIntel8080Test, TimeOut)
+{
+    // 0000 INR A; 0001 JMP 0000, 15 cycles per iteration
+    LockstepStatisticsIntel8080 statistics;
+    BatchResultsIntel8080 results = RunBoth(CreateImage({ 0x3C, 0xC3, 0x00, 0x00 }), vector<LockstepInputIntel8080>(9), {}, statistics, 751);
+    for (auto const & result : results)
+    {
+        EXPECT_TRUE(result.timedOut);
+        EXPECT_FALSE(result.halted);
+        EXPECT_EQ(size_t{ 755 }, result.registers.cycleCountTotal);
+        EXPECT_EQ(uint8_t{ 51 }, result.registers.a);
+    }
+    EXPECT_EQ(size_t{ 101 }, statistics.lockstepInstructions);
+}
+
+} // namespace Test
+
+} // namespace Emulator
@@ -76,6 +76,24 @@ TEST_FIXTURE(MemoryManagerTest, Fetch)
     EXPECT_EQ(data, memory.Fetch(OriginRAM, data.size()));
 }
 
+TEST_FIXTURE(MemoryManagerTest, FetchBuffer)
+{
+    std::vector<uint8_t> code = { 0x10, 0x22, 0x58, 0x13 };
+    std::vector<uint8_t> data = { 0x01, 0x02, 0x03, 0x04 };
+    MemoryManager memory;
+    ROMPtr rom = std::make_shared<ROM>(BaseROM, SizeROM);
+    RAMPtr ram = std::make_shared<RAM>(BaseRAM, SizeRAM);
+    memory.AddMemory(rom);
+    memory.AddMemory(ram);
+    rom->Load(code, BaseROM + SizeROM - code.size());
+    ram->Load(data, BaseRAM);
+    std::vector<uint8_t> expected = { 0x10, 0x22, 0x58, 0x13, 0x01, 0x02, 0x03, 0x04 };
+    std::vector<uint8_t> actual(expected.size());
+    memory.Fetch(BaseRAM - code.size(), actual.data(), actual.size());
+    EXPECT_EQ(expected, actual);
+    EXPECT_THROW(memory.Fetch(BaseRAM + SizeRAM - 4, actual.data(), actual.size()), std::runtime_error);
+}
+
 TEST_FIXTURE(MemoryManagerTest, Fetch8)
 {
     std::vector<uint8_t> code =
@@ -306,6 +324,23 @@ TEST_FIXTURE(MemoryManagerTest, Store)
     EXPECT_EQ(data, memory.Fetch(BaseRAM, data.size()));
 }
 
+TEST_FIXTURE(MemoryManagerTest, StoreBuffer)
+{
+    MemoryManager memory;
+    RAMPtr ram1 = std::make_shared<RAM>(0, 1024);
+    RAMPtr ram2 = std::make_shared<RAM>(1024, 1024);
+    memory.AddMemory(ram1);
+    memory.AddMemory(ram2);
+    std::vector<uint8_t> image(2048);
+    for (size_t index = 0; index < image.size(); ++index)
+        image[index] = uint8_t(index * 7);
+    memory.Store(0, image.data(), image.size());
+    EXPECT_EQ(image, memory.Fetch(0, image.size()));
+    EXPECT_EQ(image[1023], ram1->Fetch8(1023));
+    EXPECT_EQ(image[1024], ram2->Fetch8(1024));
+    EXPECT_THROW(memory.Store(1024, image.data(), image.size()), std::runtime_error);
+}
+
 TEST_FIXTURE(MemoryManagerTest, Store8)
 {
     std::vector<uint8_t> code =
@@ -502,6 +537,213 @@ TEST_FIXTURE(MemoryManagerTest, Store64InvalidOffset)
     EXPECT_THROW(memory.Store64(BaseRAM + SizeRAM - 7, 0x0000000000000000), std::runtime_error);
 }
 
+TEST_FIXTURE(MemoryManagerTest, PageMap)
+{
+    MemoryManager memory;
+    ROMPtr rom = std::make_shared<ROM>(BaseROM, SizeROM);
+    RAMPtr ram = std::make_shared<RAM>(BaseRAM, SizeRAM);
+    memory.AddMemory(rom);
+    memory.AddMemory(ram);
+    EXPECT_EQ(size_t(256), memory.PageSize());
+    EXPECT_NULL(memory.GetPage(0).read);
+    EXPECT_NULL(memory.GetPage(0).write);
+    EXPECT_EQ(rom->Data(), memory.GetPage(BaseROM).read);
+    EXPECT_NULL(memory.GetPage(BaseROM).write);
+    EXPECT_EQ(ram->Data(), memory.GetPage(BaseRAM).read);
+    EXPECT_EQ(ram->Data(), memory.GetPage(BaseRAM).write);
+    EXPECT_EQ(ram->Data() + 256, memory.GetPage(BaseRAM + 256).write);
+    EXPECT_NULL(memory.GetPage(BaseRAM + SizeRAM).read);
+}
+
+TEST_FIXTURE(MemoryManagerTest, PageMapSharedPage)
+{
+    static const size_t SizeSharedROM = 384;
+    MemoryManager memory;
+    ROMPtr rom = std::make_shared<ROM>(0, SizeSharedROM);
+    RAMPtr ram = std::make_shared<RAM>(SizeSharedROM, SizeRAM);
+    memory.AddMemory(rom);
+    memory.AddMemory(ram);
+    rom->Load({ 0x01, 0x02 }, SizeSharedROM - 2);
+    ram->Load({ 0x03, 0x04 }, SizeSharedROM);
+    EXPECT_NOT_NULL(memory.GetPage(0).read);
+    EXPECT_NULL(memory.GetPage(SizeSharedROM).read);
+    EXPECT_NULL(memory.GetPage(SizeSharedROM).write);
+    EXPECT_EQ(0x04030201, memory.Fetch32(SizeSharedROM - 2));
+    EXPECT_THROW(memory.Store8(SizeSharedROM - 1, 0x00), std::runtime_error);
+    EXPECT_NOTHROW(memory.Store8(SizeSharedROM, 0x05));
+    EXPECT_EQ(0x05, memory.Fetch8(SizeSharedROM));
+}
+
+TEST_FIXTURE(MemoryManagerTest, PageMapPageSize)
+{
+    MemoryManager memory(10);
+    RAMPtr ram = std::make_shared<RAM>(0, 2048);
+    memory.AddMemory(ram);
+    EXPECT_EQ(size_t(1024), memory.PageSize());
+    EXPECT_EQ(ram->Data() + 1024, memory.GetPage(1024).write);
+    memory.Store16(1023, 0x1234);
+    EXPECT_EQ(0x1234, memory.Fetch16(1023));
+    EXPECT_THROW(MemoryManager(17), std::invalid_argument);
+}
+
+TEST_FIXTURE(MemoryManagerTest, WatchStores)
+{
+    MemoryManager memory;
+    RAMPtr ram = std::make_shared<RAM>(0, 1024);
+    memory.AddMemory(ram);
+    std::vector<size_t> stores;
+    memory.SubscribeStores([&stores](size_t address) { stores.push_back(address); });
+    memory.WatchStores(256, true);
+    EXPECT_TRUE(memory.IsWatchingStores(511));
+    EXPECT_FALSE(memory.IsWatchingStores(512));
+    EXPECT_NULL(memory.GetPage(256).write);
+    EXPECT_EQ(ram->Data() + 256, memory.GetPage(256).read);
+
+    memory.Store8(255, 0x01);
+    memory.Store16(511, 0x0302);
+    memory.Store(300, { 0x04, 0x05 });
+    EXPECT_EQ(size_t(3), stores.size());
+    EXPECT_EQ(size_t(511), stores[0]);
+    EXPECT_EQ(size_t(300), stores[1]);
+    EXPECT_EQ(size_t(301), stores[2]);
+    EXPECT_EQ(0x0302, memory.Fetch16(511));
+
+    uint8_t data[] = { 0x07, 0x08, 0x09, 0x0A };
+    memory.Store(254, data, sizeof(data));
+    EXPECT_EQ(size_t(5), stores.size());
+    EXPECT_EQ(size_t(256), stores[3]);
+    EXPECT_EQ(size_t(257), stores[4]);
+
+    memory.WatchStores(256, false);
+    EXPECT_EQ(ram->Data() + 256, memory.GetPage(256).write);
+    memory.Store8(256, 0x06);
+    EXPECT_EQ(size_t(5), stores.size());
+}
+
+TEST_FIXTURE(MemoryManagerTest, StoreSubscribers)
+{
+    MemoryManager memory;
+    RAMPtr ram = std::make_shared<RAM>(0, 1024);
+    memory.AddMemory(ram);
+    std::vector<size_t> first;
+    std::vector<size_t> second;
+    MemoryManager::StoreSubscription firstSubscription = memory.SubscribeStores([&first](size_t address) { first.push_back(address); });
+    MemoryManager::StoreSubscription secondSubscription = memory.SubscribeStores([&second](size_t address) { second.push_back(address); });
+    EXPECT_NE(firstSubscription, secondSubscription);
+
+    // Both subscribers watch the page, and both see the store
+    memory.WatchStores(256, true);
+    memory.WatchStores(256, true);
+    memory.Store8(300, 0x01);
+    EXPECT_EQ(std::vector<size_t>({ 300 }), first);
+    EXPECT_EQ(std::vector<size_t>({ 300 }), second);
+
+    // The page stays watched until both have stopped watching it
+    memory.UnsubscribeStores(firstSubscription);
+    memory.WatchStores(256, false);
+    EXPECT_TRUE(memory.IsWatchingStores(256));
+    EXPECT_NULL(memory.GetPage(256).write);
+    memory.Store8(301, 0x02);
+    EXPECT_EQ(std::vector<size_t>({ 300 }), first);
+    EXPECT_EQ(std::vector<size_t>({ 300, 301 }), second);
+
+    memory.WatchStores(256, false);
+    EXPECT_FALSE(memory.IsWatchingStores(256));
+    EXPECT_EQ(ram->Data() + 256, memory.GetPage(256).write);
+    memory.WatchStores(256, false);
+    EXPECT_FALSE(memory.IsWatchingStores(256));
+    memory.Store8(302, 0x03);
+    EXPECT_EQ(std::vector<size_t>({ 300, 301 }), second);
+    memory.UnsubscribeStores(secondSubscription);
+}
+
+TEST_FIXTURE(MemoryManagerTest, DirtyPages)
+{
+    MemoryManager memory;
+    RAMPtr ram = std::make_shared<RAM>(0, 1024);
+    memory.AddMemory(ram);
+    memory.Store8(0, 0x01);
+    EXPECT_FALSE(memory.IsTrackingDirtyPages());
+    EXPECT_FALSE(memory.IsDirty(0));
+    EXPECT_EQ(size_t(0), memory.GetDirtyPages().size());
+
+    memory.TrackDirtyPages(true);
+    EXPECT_TRUE(memory.IsTrackingDirtyPages());
+    EXPECT_NULL(memory.GetPage(0).write);
+    EXPECT_EQ(ram->Data(), memory.GetPage(0).read);
+
+    memory.Store8(10, 0x02);
+    memory.Store16(511, 0x0403);
+    EXPECT_EQ(ram->Data(), memory.GetPage(0).write);
+    EXPECT_EQ(ram->Data() + 256, memory.GetPage(256).write);
+    EXPECT_NULL(memory.GetPage(768).write);
+    uint8_t data[] = { 0x05, 0x06 };
+    memory.Store(1000, data, sizeof(data));
+    EXPECT_EQ(std::vector<size_t>({ 0, 256, 512, 768 }), memory.GetDirtyPages());
+    EXPECT_EQ(0x02, memory.Fetch8(10));
+    EXPECT_EQ(0x0403, memory.Fetch16(511));
+
+    memory.ClearDirtyPages();
+    EXPECT_EQ(size_t(0), memory.GetDirtyPages().size());
+    EXPECT_NULL(memory.GetPage(256).write);
+    memory.WatchStores(256, true);
+    memory.Store8(300, 0x07);
+    EXPECT_TRUE(memory.IsDirty(256));
+    EXPECT_NULL(memory.GetPage(256).write);
+    memory.WatchStores(256, false);
+    EXPECT_EQ(ram->Data() + 256, memory.GetPage(256).write);
+
+    memory.TrackDirtyPages(false);
+    EXPECT_FALSE(memory.IsDirty(256));
+    EXPECT_EQ(ram->Data() + 768, memory.GetPage(768).write);
+    memory.Store8(768, 0x08);
+    EXPECT_FALSE(memory.IsDirty(768));
+}
+
+TEST_FIXTURE(MemoryManagerTest, Traps)
+{
+    MemoryManager memory;
+    RAMPtr ram = std::make_shared<RAM>(0, 512);
+    ROMPtr rom = std::make_shared<ROM>(512, 512);
+    memory.AddMemory(ram);
+    memory.AddMemory(rom);
+    std::vector<std::pair<size_t, MemoryAccess>> accesses;
+    memory.SetAccessCallback([&accesses](size_t address, MemoryAccess access, uint8_t /*data*/) { accesses.push_back(std::make_pair(address, access)); });
+    EXPECT_FALSE(memory.HasTraps());
+
+    memory.SetTraps(256, MemoryAccess::Write);
+    memory.SetTraps(512, MemoryAccess::Execute);
+    EXPECT_TRUE(memory.HasTraps());
+    EXPECT_EQ(MemoryAccess::Write, memory.GetTraps(300));
+    EXPECT_EQ(ram->Data() + 256, memory.GetPage(256).read);
+    EXPECT_NULL(memory.GetPage(256).write);
+    EXPECT_NULL(memory.GetPage(512).read);
+    EXPECT_EQ(rom->Data(), memory.GetPage(512).data);
+
+    memory.Store8(10, 0x01);
+    memory.Store16(300, 0x0302);
+    EXPECT_EQ(0x0302, memory.Fetch16(300));
+    EXPECT_EQ(0x00, memory.Fetch8(512));
+    EXPECT_EQ(0x00, memory.FetchOpcode8(512));
+    EXPECT_EQ(0x01, memory.FetchOpcode8(10));
+    memory.Store(256, { 0x04 });
+    EXPECT_EQ(size_t(3), accesses.size());
+    EXPECT_EQ(size_t(300), accesses[0].first);
+    EXPECT_EQ(MemoryAccess::Write, accesses[0].second);
+    EXPECT_EQ(size_t(301), accesses[1].first);
+    EXPECT_EQ(size_t(512), accesses[2].first);
+    EXPECT_EQ(MemoryAccess::Execute, accesses[2].second);
+
+    // Traps survive remapping
+    memory.AddMemory(std::make_shared<RAM>(1024, 256));
+    EXPECT_NULL(memory.GetPage(256).write);
+    memory.SetTraps(256, MemoryAccess::None);
+    memory.SetTraps(512, MemoryAccess::None);
+    EXPECT_FALSE(memory.HasTraps());
+    EXPECT_EQ(ram->Data() + 256, memory.GetPage(256).write);
+    EXPECT_EQ(rom->Data(), memory.GetPage(512).read);
+}
+
 } // namespace Test
 
 } // namespace Emulator
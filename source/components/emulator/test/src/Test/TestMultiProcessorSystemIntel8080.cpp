@@ -0,0 +1,227 @@
+#include "unit-test-c++/UnitTestC++.h"
+
+#include "emulator/MultiProcessorSystemIntel8080.h"
+#include "emulator/CachedProcessorIntel8080.h"
+#include "emulator/RAM.h"
+#include "emulator/ROM.h"
+
+using namespace std;
+
+namespace Emulator
+{
+
+namespace Test
+{
+
+class MultiProcessorSystemIntel8080Test : public UnitTestCpp::TestFixture
+{
+public:
+	virtual void SetUp();
+	virtual void TearDown();
+
+    static const size_t ROMSize = 256;
+    static const size_t SharedOrigin = 0x8000;
+    static const size_t SharedSize = 0x1000;
+
+    // Shared RAM at 8000, every processor with its own code in ROM at 0000
+    RAMPtr SetupSystem(MultiProcessorSystemIntel8080 & system, vector<shared_ptr<ProcessorIntel8080>> const & processors,
+                       vector<vector<uint8_t>> const & code);
+    // Adds 10 to the byte at address, one at a time
+    static vector<uint8_t> Counter(uint16_t address);
+};
+
+void MultiProcessorSystemIntel8080Test::SetUp()
+{
+}
+
+void MultiProcessorSystemIntel8080Test::TearDown()
+{
+}
+
+RAMPtr MultiProcessorSystemIntel8080Test::SetupSystem(MultiProcessorSystemIntel8080 & system,
+                                                      vector<shared_ptr<ProcessorIntel8080>> const & processors,
+                                                      vector<vector<uint8_t>> const & code)
+{
+    RAMPtr shared = std::make_shared<RAM>(SharedOrigin, SharedSize);
+    system.AddSharedMemory(shared);
+    for (size_t index = 0; index < processors.size(); ++index)
+    {
+        ROMPtr rom = std::make_shared<ROM>(0, ROMSize);
+        EXPECT_EQ(index, system.AddProcessor(processors[index]));
+        system.AddPrivateMemory(index, rom);
+        processors[index]->LoadCode(code[index], 0, rom);
+    }
+    return shared;
+}
+
+vector<uint8_t> MultiProcessorSystemIntel8080Test::Counter(uint16_t address)
+{
+    return {
+        0x21, uint8_t(address), uint8_t(address >> 8),  // 0000 LXI H,address
+        0x06, 0x0A,                                     // 0003 MVI B,0A
+        0x34,                                           // 0005 LOOP: INR M
+        0x05,                                           // 0006 DCR B
+        0xC2, 0x05, 0x00,                               // 0007 JNZ LOOP
+        0x76,                                           // 000A HLT
+    };
+}
+
+TEST_FIXTURE(MultiProcessorSystemIntel8080Test, Construct)
+{
+    MultiProcessorSystemIntel8080 system;
+    EXPECT_EQ(size_t{ 0 }, system.ProcessorCount());
+    EXPECT_EQ(size_t{ MultiProcessorSystemIntel8080::DefaultQuantum }, system.GetQuantum());
+    EXPECT_EQ(size_t{ MultiProcessorSystemIntel8080::DefaultSyncQuanta }, system.GetSyncQuanta());
+    EXPECT_EQ(SchedulingIntel8080::Deterministic, system.GetScheduling());
+    EXPECT_NOT_NULL(system.GetIOManager());
+    EXPECT_EQ(uint64_t{ 0 }, system.Run(1000));
+    EXPECT_THROW(system.GetProcessor(0), std::runtime_error);
+    EXPECT_THROW(system.SetQuantum(0), std::runtime_error);
+}
+
+TEST_FIXTURE(MultiProcessorSystemIntel8080Test, SharedMemory)
+{
+    MultiProcessorSystemIntel8080 system;
+    vector<shared_ptr<ProcessorIntel8080>> processors =
+        { std::make_shared<ProcessorIntel8080>(), std::make_shared<FastProcessorIntel8080>() };
+    RAMPtr shared = SetupSystem(system, processors, { Counter(0x8000), Counter(0x8000) });
+    // Private memory of one processor is not visible to the other
+    EXPECT_EQ(0x21, system.GetMemoryManager(0)->Fetch8(0x0000));
+    system.GetMemoryManager(1)->Store8(0x8010, 0x55);
+    EXPECT_EQ(0x55, system.GetMemoryManager(0)->Fetch8(0x8010));
+
+    EXPECT_EQ(uint64_t{ MultiProcessorSystemIntel8080::DefaultQuantum }, system.Run(100000));
+    EXPECT_TRUE(system.IsStopped());
+    EXPECT_EQ(20, shared->Fetch8(0x8000));
+    for (auto const & processor : processors)
+    {
+        EXPECT_TRUE(processor->GetRegisters().isHalted);
+        EXPECT_EQ(uint64_t{ MultiProcessorSystemIntel8080::DefaultQuantum }, processor->Now());
+    }
+
+    MultiProcessorStatisticsIntel8080 const & statistics = system.GetStatistics();
+    EXPECT_EQ(size_t{ 1 }, statistics.syncs);
+    EXPECT_EQ(size_t{ 2 }, statistics.quanta);
+    EXPECT_EQ(uint64_t{ 2 * (10 + 7 + 10 * (10 + 5 + 10) + 7) }, statistics.quantumCycles);
+    EXPECT_EQ(size_t{ 2 }, statistics.haltedQuanta);
+    EXPECT_EQ(size_t{ 2 }, statistics.sharedPageWrites);
+    EXPECT_EQ(size_t{ 1 }, statistics.contendedPages);
+    EXPECT_EQ(size_t{ 1 }, statistics.contendedSyncs);
+}
+
+TEST_FIXTURE(MultiProcessorSystemIntel8080Test, DeterministicInterleaving)
+{
+    vector<uint8_t> waiter =
+    {
+        0x3A, 0x01, 0x80,   // 0000 WAIT: LDA 8001
+        0xB7,               // 0003 ORA A
+        0xCA, 0x00, 0x00,   // 0004 JZ WAIT
+        0x3A, 0x00, 0x80,   // 0007 LDA 8000
+        0x32, 0x02, 0x80,   // 000A STA 8002
+        0x76,               // 000D HLT
+    };
+    vector<uint8_t> writer =
+    {
+        0x3E, 0x2A,         // 0000 MVI A,2A
+        0x32, 0x00, 0x80,   // 0002 STA 8000
+        0x3E, 0x01,         // 0005 MVI A,01
+        0x32, 0x01, 0x80,   // 0007 STA 8001
+        0x76,               // 000A HLT
+    };
+    vector<RegistersIntel8080> results;
+    for (int run = 0; run < 2; ++run)
+    {
+        MultiProcessorSystemIntel8080 system(100);
+        vector<shared_ptr<ProcessorIntel8080>> processors =
+            { std::make_shared<FastProcessorIntel8080>(), std::make_shared<CachedProcessorIntel8080>() };
+        RAMPtr shared = SetupSystem(system, processors, { waiter, writer });
+        system.Run(100000);
+
+        // The waiter polls through the first quantum, before the writer runs
+        EXPECT_TRUE(system.IsStopped());
+        EXPECT_EQ(uint64_t{ 200 }, system.Now());
+        EXPECT_EQ(0x2A, shared->Fetch8(0x8002));
+        EXPECT_EQ(size_t{ 2 }, system.GetStatistics().syncs);
+        EXPECT_EQ(size_t{ 0 }, system.GetStatistics().contendedPages);
+        results.push_back(processors[0]->GetRegisters());
+    }
+    EXPECT_EQ(results[0].pc, results[1].pc);
+    EXPECT_EQ(results[0].a, results[1].a);
+    EXPECT_EQ(results[0].cycleCountTotal, results[1].cycleCountTotal);
+}
+
+TEST_FIXTURE(MultiProcessorSystemIntel8080Test, HaltedProcessorWokenByEvent)
+{
+    vector<uint8_t> sleeper =
+    {
+        0x31, 0x00, 0x90,   // 0000 LXI SP,9000
+        0xFB,               // 0003 EI
+        0x76,               // 0004 HLT
+        0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+        0x3E, 0x55,         // 0010 MVI A,55
+        0x32, 0x00, 0x80,   // 0012 STA 8000
+        0x76,               // 0015 HLT
+    };
+    MultiProcessorSystemIntel8080 system(100);
+    vector<shared_ptr<ProcessorIntel8080>> processors =
+        { std::make_shared<FastProcessorIntel8080>(), std::make_shared<FastProcessorIntel8080>() };
+    RAMPtr shared = SetupSystem(system, processors, { sleeper, Counter(0x8001) });
+    ProcessorIntel8080 & processor = *processors[0];
+    uint64_t serviced = 0;
+    processor.GetScheduler().Schedule(450, [&processor, &serviced](uint64_t)
+    {
+        serviced = processor.Now();
+        processor.GetInterruptController().Request(2);
+    });
+
+    system.Run(100000);
+    EXPECT_TRUE(system.IsStopped());
+    EXPECT_EQ(0x55, shared->Fetch8(0x8000));
+    EXPECT_EQ(10, shared->Fetch8(0x8001));
+    EXPECT_EQ(0x0005, shared->Fetch16(0x8FFE));
+    // The halted processor passes the time up to the event, which is serviced at its deadline within the quantum,
+    // and the interrupt routine runs in the same quantum
+    EXPECT_EQ(uint64_t{ 450 }, serviced);
+    EXPECT_EQ(uint64_t{ 500 }, system.Now());
+    EXPECT_EQ(uint64_t{ 500 }, processor.Now());
+    EXPECT_EQ(size_t{ 2 + 3 }, system.GetStatistics().quanta);
+    EXPECT_EQ(uint64_t{ 10 + 4 + 7 + 7 + 13 + 7 + 10 + 7 + 10 * (10 + 5 + 10) + 7 }, system.GetStatistics().quantumCycles);
+    // Every quantum of the sleeper, and the counter from the quantum it halts in
+    EXPECT_EQ(size_t{ 5 + 3 }, system.GetStatistics().haltedQuanta);
+}
+
+TEST_FIXTURE(MultiProcessorSystemIntel8080Test, Threaded)
+{
+    static const size_t ProcessorCount = 4;
+    MultiProcessorSystemIntel8080 system(50);
+    system.SetScheduling(SchedulingIntel8080::Threaded);
+    system.SetSyncQuanta(2);
+    vector<shared_ptr<ProcessorIntel8080>> processors;
+    vector<vector<uint8_t>> code;
+    for (size_t index = 0; index < ProcessorCount; ++index)
+    {
+        processors.push_back(std::make_shared<FastProcessorIntel8080>());
+        code.push_back(Counter(uint16_t(0x8000 + index)));
+    }
+    RAMPtr shared = SetupSystem(system, processors, code);
+
+    EXPECT_EQ(uint64_t{ 300 }, system.Run(100000));
+    EXPECT_TRUE(system.IsStopped());
+    for (size_t index = 0; index < ProcessorCount; ++index)
+    {
+        EXPECT_EQ(10, shared->Fetch8(0x8000 + index));
+        EXPECT_EQ(uint64_t{ 300 }, processors[index]->Now());
+    }
+    MultiProcessorStatisticsIntel8080 const & statistics = system.GetStatistics();
+    // All processors write the same page in every sync window
+    EXPECT_EQ(size_t{ 3 }, statistics.syncs);
+    EXPECT_EQ(size_t{ 3 }, statistics.contendedSyncs);
+    EXPECT_EQ(size_t{ 3 }, statistics.contendedPages);
+    EXPECT_EQ(size_t{ 3 * ProcessorCount }, statistics.sharedPageWrites);
+    EXPECT_EQ(size_t{ 6 * ProcessorCount }, statistics.quanta);
+    EXPECT_EQ(size_t{ ProcessorCount }, statistics.haltedQuanta);
+}
+
+} // namespace Test
+
+} // namespace Emulator
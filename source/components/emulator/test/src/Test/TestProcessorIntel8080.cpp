@@ -4077,6 +4077,27 @@ TEST_FIXTURE(ProcessorIntel8080Test, RunInstruction_DAA)
     EXPECT_TRUE(Core::Util::Compare(machineCode, memoryManager->Fetch(Origin, machineCode.size())));
 }
 
+// Above 99 the upper digit is corrected as well and carry is set, up to FF where adding 66 wraps around
+TEST_FIXTURE(ProcessorIntel8080Test, RunInstruction_DAA_UpperDigit)
+{
+    std::vector<uint8_t> machineCode{ 0x27 };
+    processor.LoadCode(machineCode, Origin, rom);
+
+    for (unsigned value = 0x9A; value <= 0xFF; ++value)
+    {
+        for (auto auxCarry : { FlagsIntel8080::None, FlagsIntel8080::AuxCarry })
+        {
+            Reg8 a = Reg8(value);
+            Reg8 correction = (((a & 0x0F) > 9) || (auxCarry != FlagsIntel8080::None)) ? 0x66 : 0x60;
+            RegistersSet(processor, B, C, D, E, H, L, SP, PC, a, auxCarry);
+            processor.RunInstruction();
+            RegistersIntel8080 & registers = processor.GetRegisters();
+            EXPECT_EQ(Reg8(a + correction), registers.a);
+            EXPECT_EQ(FlagsIntel8080::Carry, registers.flags & FlagsIntel8080::Carry);
+        }
+    }
+}
+
 TEST_FIXTURE(ProcessorIntel8080Test, RunInstruction_ANA_r)
 {
     std::vector<uint8_t> machineCode{ 0xA0, 0xA1, 0xA2, 0xA3, 0xA4, 0xA5,       0xA7 };
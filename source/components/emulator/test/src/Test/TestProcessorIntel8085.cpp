@@ -0,0 +1,284 @@
+#include "unit-test-c++/UnitTestC++.h"
+
+#include "emulator/ProcessorIntel8085.h"
+#include "emulator/RAM.h"
+#include "emulator/IOPort.h"
+
+using namespace std;
+
+namespace Emulator
+{
+
+namespace Test
+{
+
+class ProcessorIntel8085Test : public UnitTestCpp::TestFixture
+{
+public:
+	virtual void SetUp();
+	virtual void TearDown();
+
+    static const size_t ROMSize = 256;
+    static const size_t RAMSize = 2048;
+    static const size_t Origin = 0;
+    static const size_t IOOrigin = 0;
+    static const size_t IOSize = 256;
+
+    void SetupProcessor(FastProcessorIntel8080 & processor, vector<uint8_t> const & code);
+};
+
+void ProcessorIntel8085Test::SetUp()
+{
+}
+
+void ProcessorIntel8085Test::TearDown()
+{
+}
+
+void ProcessorIntel8085Test::SetupProcessor(FastProcessorIntel8080 & processor, vector<uint8_t> const & code)
+{
+    MemoryManagerPtr memoryManager = std::make_shared<MemoryManager>();
+    ROMPtr rom = std::make_shared<ROM>(Origin, ROMSize);
+    RAMPtr ram = std::make_shared<RAM>(Origin + ROMSize, RAMSize);
+    memoryManager->AddMemory(rom);
+    memoryManager->AddMemory(ram);
+    IOManagerPtr ioManager = std::make_shared<IOManager>();
+    IOPortPtr ioPort = std::make_shared<IOPort>(IOOrigin, IOSize);
+    ioManager->AddIO(ioPort);
+    processor.Setup(memoryManager, ioManager);
+    processor.LoadCode(code, Origin, rom);
+}
+
+TEST_FIXTURE(ProcessorIntel8085Test, Construct)
+{
+    ProcessorIntel8085 processor;
+    EXPECT_EQ(0x07, processor.GetInterruptMasks());
+    EXPECT_FALSE(processor.GetSerialOutput());
+    EXPECT_FALSE(processor.GetRegisters().isHalted);
+}
+
+TEST_FIXTURE(ProcessorIntel8085Test, RIMAndSIM)
+{
+    ProcessorIntel8085 processor;
+    SetupProcessor(processor, {
+        0x3E, 0x0D,         // MVI A,0DH    ; set masks to 101
+        0x30,               // SIM
+        0x3E, 0xC0,         // MVI A,0C0H   ; SOD = 1, masks unchanged
+        0x30,               // SIM
+        0xFB,               // EI
+        0x20,               // RIM
+        0x76,               // HLT
+    });
+    processor.Reset();
+    processor.SetSerialInput(true);
+    processor.Run();
+    EXPECT_EQ(0x05, processor.GetInterruptMasks());
+    EXPECT_TRUE(processor.GetSerialOutput());
+    EXPECT_EQ(0x8D, processor.GetRegisters().a);
+
+    processor.Reset();
+    EXPECT_EQ(0x07, processor.GetInterruptMasks());
+    EXPECT_FALSE(processor.GetSerialOutput());
+}
+
+TEST_FIXTURE(ProcessorIntel8085Test, UndocumentedInstructions)
+{
+    ProcessorIntel8085 processor;
+    SetupProcessor(processor, {
+        0x31, 0x00, 0x08,   // LXI SP,0800H
+        0x21, 0x00, 0x10,   // LXI H,1000H
+        0x01, 0x01, 0x00,   // LXI B,0001H
+        0x08,               // DSUB         ; HL = 0FFFH
+        0x38, 0x02,         // LDSP 2       ; DE = 0802H
+        0xEB,               // XCHG         ; HL = 0802H, DE = 0FFFH
+        0x28, 0x10,         // LDHI 10H     ; DE = 0812H
+        0x21, 0x03, 0x80,   // LXI H,8003H
+        0x10,               // ARHL         ; HL = 0C001H, CY
+        0xD9,               // SHLX         ; [0812H] = 0C001H
+        0x21, 0x00, 0x00,   // LXI H,0
+        0xED,               // LHLX         ; HL = 0C001H
+        0x76,               // HLT
+    });
+    processor.Reset();
+    processor.Run();
+    RegistersIntel8080 & registers = processor.GetRegisters();
+    EXPECT_EQ(0xC001, registers.hl.W);
+    EXPECT_EQ(0x0812, registers.de.W);
+    EXPECT_EQ(0x0001, registers.bc.W);
+    EXPECT_TRUE((registers.flags & FlagsIntel8080::Carry) != FlagsIntel8080::None);
+    EXPECT_EQ(0x01, processor.GetMemoryManager()->Fetch8(0x0812));
+    EXPECT_EQ(0xC0, processor.GetMemoryManager()->Fetch8(0x0813));
+}
+
+TEST_FIXTURE(ProcessorIntel8085Test, DSUBAndRDELFlags)
+{
+    ProcessorIntel8085 processor;
+    SetupProcessor(processor, {
+        0x21, 0x00, 0x00,   // LXI H,0
+        0x01, 0x01, 0x00,   // LXI B,1
+        0x08,               // DSUB         ; HL = 0FFFFH, CY, S
+        0x76,               // HLT
+        0x11, 0x01, 0x80,   // LXI D,8001H
+        0xAF,               // XRA A
+        0x18,               // RDEL         ; DE = 0002H, CY, V
+        0x76,               // HLT
+    });
+    processor.Reset();
+    processor.Run();
+    RegistersIntel8080 & registers = processor.GetRegisters();
+    EXPECT_EQ(0xFFFF, registers.hl.W);
+    EXPECT_TRUE((registers.flags & FlagsIntel8080::Carry) != FlagsIntel8080::None);
+    EXPECT_TRUE((registers.flags & FlagsIntel8080::Sign) != FlagsIntel8080::None);
+    EXPECT_TRUE((registers.flags & FlagsIntel8080::Zero) == FlagsIntel8080::None);
+
+    registers.isHalted = false;
+    processor.Run();
+    EXPECT_EQ(0x0002, registers.de.W);
+    EXPECT_TRUE((registers.flags & FlagsIntel8080::Carry) != FlagsIntel8080::None);
+    EXPECT_TRUE((registers.flags & FlagsIntel8080::Overflow) != FlagsIntel8080::None);
+}
+
+TEST_FIXTURE(ProcessorIntel8085Test, OverflowAndKFlags)
+{
+    ProcessorIntel8085 processor;
+    processor.SetLazyFlags(true);
+    SetupProcessor(processor, {
+        0x3E, 0x7F,         // MVI A,7FH
+        0xC6, 0x01,         // ADI 1        ; 80H, S and V, K = S xor V clear
+        0x76,               // HLT
+        0x3E, 0x10,         // MVI A,10H
+        0xD6, 0x20,         // SUI 20H      ; F0H, S without V, K set
+        0x76,               // HLT
+        0xE6, 0xFF,         // ANI 0FFH     ; V and K cleared, AC set
+        0x76,               // HLT
+    });
+    processor.Reset();
+    processor.Run();
+    RegistersIntel8080 & registers = processor.GetRegisters();
+    EXPECT_EQ(0x80, registers.a);
+    EXPECT_TRUE((registers.flags & FlagsIntel8080::Overflow) != FlagsIntel8080::None);
+    EXPECT_TRUE((registers.flags & FlagsIntel8080::KFlag) == FlagsIntel8080::None);
+
+    registers.isHalted = false;
+    processor.Run();
+    EXPECT_EQ(0xF0, registers.a);
+    EXPECT_TRUE((registers.flags & FlagsIntel8080::Overflow) == FlagsIntel8080::None);
+    EXPECT_TRUE((registers.flags & FlagsIntel8080::KFlag) != FlagsIntel8080::None);
+
+    registers.isHalted = false;
+    processor.Run();
+    EXPECT_TRUE((registers.flags & (FlagsIntel8080::Overflow | FlagsIntel8080::KFlag)) == FlagsIntel8080::None);
+    EXPECT_TRUE((registers.flags & FlagsIntel8080::AuxCarry) != FlagsIntel8080::None);
+}
+
+TEST_FIXTURE(ProcessorIntel8085Test, JKAndJNKOnPairWrap)
+{
+    ProcessorIntel8085 processor;
+    SetupProcessor(processor, {
+        0x01, 0x02, 0x00,   // LXI B,2
+        0x3C,               // LOOP: INR A
+        0x0B,               // DCX B
+        0xDD, 0x03, 0x00,   // JNK LOOP
+        0xFD, 0x0C, 0x00,   // JK DONE
+        0x76,               // HLT
+        0x76,               // DONE: HLT
+    });
+    processor.Reset();
+    processor.Run();
+    RegistersIntel8080 & registers = processor.GetRegisters();
+    EXPECT_EQ(0xFFFF, registers.bc.W);
+    EXPECT_EQ(0x03, registers.a);
+    EXPECT_EQ(0x000D, registers.pc);
+}
+
+TEST_FIXTURE(ProcessorIntel8085Test, RSTV)
+{
+    vector<uint8_t> code(0x44, 0x00);
+    vector<uint8_t> program = {
+        0x31, 0x00, 0x08,   // LXI SP,0800H
+        0xAF,               // XRA A
+        0xCB,               // RSTV         ; not taken
+        0x3E, 0x7F,         // MVI A,7FH
+        0xC6, 0x01,         // ADI 1
+        0xCB,               // RSTV         ; taken
+        0x76,               // HLT
+    };
+    copy(program.begin(), program.end(), code.begin());
+    code[0x40] = 0x06;      // MVI B,55H
+    code[0x41] = 0x55;
+    code[0x42] = 0x76;      // HLT
+    ProcessorIntel8085 processor;
+    SetupProcessor(processor, code);
+    processor.Reset();
+    processor.Run();
+    RegistersIntel8080 & registers = processor.GetRegisters();
+    EXPECT_EQ(0x55, registers.bc.B.h);
+    EXPECT_EQ(0x0043, registers.pc);
+    EXPECT_EQ(0x07FE, registers.sp.W);
+    EXPECT_EQ(0x000A, processor.GetMemoryManager()->Fetch16(0x07FE));
+}
+
+TEST_FIXTURE(ProcessorIntel8085Test, Timings)
+{
+    // Instruction, 8080 cycles, 8085 cycles
+    struct Timing { vector<uint8_t> code; uint8_t cycles8080; uint8_t cycles8085; };
+    vector<Timing> timings = {
+        { { 0x41 }, 5, 4 },                 // MOV B,C
+        { { 0x04 }, 5, 4 },                 // INR B
+        { { 0x03 }, 5, 6 },                 // INX B
+        { { 0xC2, 0x00, 0x00 }, 10, 7 },    // JNZ, not taken with Z set
+        { { 0xCD, 0x00, 0x00 }, 17, 18 },   // CALL
+        { { 0xC5 }, 11, 12 },               // PUSH B
+        { { 0xE3 }, 18, 16 },               // XTHL
+        { { 0x76 }, 7, 5 },                 // HLT
+    };
+    for (auto const & timing : timings)
+    {
+        FastProcessorIntel8080 processor8080;
+        ProcessorIntel8085 processor8085;
+        for (FastProcessorIntel8080 * processor : { &processor8080, static_cast<FastProcessorIntel8080 *>(&processor8085) })
+        {
+            SetupProcessor(*processor, timing.code);
+            processor->Reset();
+            processor->GetRegisters().sp.W = 0x0800;
+            processor->GetRegisters().flags = FlagsIntel8080::Zero;
+            processor->RunInstruction();
+        }
+        EXPECT_EQ(timing.cycles8080, processor8080.GetRegisters().instructionCycles);
+        EXPECT_EQ(timing.cycles8085, processor8085.GetRegisters().instructionCycles);
+    }
+}
+
+TEST_FIXTURE(ProcessorIntel8085Test, PushPSW)
+{
+    for (bool is8085 : { false, true })
+    {
+        FastProcessorIntel8080 processor8080;
+        ProcessorIntel8085 processor8085;
+        FastProcessorIntel8080 & processor = is8085 ? static_cast<FastProcessorIntel8080 &>(processor8085) : processor8080;
+        SetupProcessor(processor, {
+            0xF5,               // PUSH PSW
+            0x76,               // HLT
+        });
+        processor.Reset();
+        processor.GetRegisters().sp.W = 0x0800;
+        processor.GetRegisters().flags = FlagsIntel8080(0xFF);
+        processor.Run();
+        EXPECT_EQ(is8085 ? 0xF7 : 0xD7, processor.GetMemoryManager()->Fetch8(0x07FE));
+    }
+}
+
+TEST_FIXTURE(ProcessorIntel8085Test, ExtendedOpcodesInvalidOn8080)
+{
+    for (uint8_t opcode : { 0x08, 0x10, 0x18, 0x20, 0x28, 0x30, 0x38, 0xCB, 0xD9, 0xDD, 0xED, 0xFD })
+    {
+        FastProcessorIntel8080 processor;
+        SetupProcessor(processor, { opcode, 0x00, 0x00, 0x76 });
+        processor.Reset();
+        EXPECT_THROW(processor.Run(), ProcessorInvalidInstruction);
+    }
+}
+
+} // namespace Test
+
+} // namespace Emulator
@@ -0,0 +1,199 @@
+#include "unit-test-c++/UnitTestC++.h"
+
+#include <sstream>
+#include "assembler/SymbolMap.h"
+#include "emulator/JitProcessorIntel8080.h"
+#include "emulator/ProfilerIntel8080.h"
+#include "TestMachineIntel8080.h"
+
+using namespace std;
+
+namespace Emulator
+{
+
+namespace Test
+{
+
+class ProfilerIntel8080Test : public UnitTestCpp::TestFixture
+{
+public:
+	virtual void SetUp();
+	virtual void TearDown();
+
+    SymbolTableIntel8080 symbols;
+
+    void SetupProcessor(ProcessorIntel8080 & processor, vector<uint8_t> const & code = TestMachineIntel8080::CallProgram());
+    void AssertProfile(ProfilerIntel8080 const & profiler);
+};
+
+void ProfilerIntel8080Test::SetUp()
+{
+    symbols = { { 0x0000, "START" }, { 0x0005, "LOOP" }, { 0x0010, "MULT" }, { 0x0018, "ADDER" } };
+}
+
+void ProfilerIntel8080Test::TearDown()
+{
+}
+
+void ProfilerIntel8080Test::SetupProcessor(ProcessorIntel8080 & processor, vector<uint8_t> const & code)
+{
+    TestMachineIntel8080::SetupProcessorRAM(processor, code, TestMachineIntel8080::RAMSize);
+}
+
+void ProfilerIntel8080Test::AssertProfile(ProfilerIntel8080 const & profiler)
+{
+    EXPECT_EQ(uint64_t{ 288 }, profiler.TotalCycles());
+    EXPECT_EQ(uint64_t{ 30 }, profiler.TotalInstructions());
+    EXPECT_EQ(uint64_t{ 3 }, profiler.GetCounters(0x0005).executions);
+    EXPECT_EQ(uint64_t{ 51 }, profiler.GetCounters(0x0005).cycles);
+    EXPECT_EQ(uint64_t{ 2 }, profiler.GetCounters(0x0009).taken);
+    EXPECT_EQ(uint64_t{ 1 }, profiler.GetCounters(0x0009).notTaken);
+    EXPECT_EQ(uint64_t{ 0 }, profiler.GetCounters(0x0015).taken);
+    EXPECT_EQ(uint64_t{ 3 }, profiler.GetCounters(0x0015).notTaken);
+    EXPECT_EQ(uint64_t{ 0 }, profiler.GetCounters(0x000D).executions);
+
+    std::vector<CallNodeIntel8080> const & tree = profiler.GetCallTree();
+    EXPECT_EQ(size_t{ 3 }, tree.size());
+    EXPECT_EQ(uint64_t{ 120 }, tree[0].selfCycles);
+    EXPECT_EQ(0x0010, tree[1].function);
+    EXPECT_EQ(uint64_t{ 3 }, tree[1].calls);
+    EXPECT_EQ(uint64_t{ 117 }, tree[1].selfCycles);
+    EXPECT_EQ(0x0018, tree[2].function);
+    EXPECT_EQ(size_t{ 1 }, tree[2].parent);
+    EXPECT_EQ(uint64_t{ 51 }, tree[2].selfCycles);
+
+    ostringstream folded;
+    profiler.WriteFolded(folded, symbols);
+    EXPECT_EQ("START 120\n"
+              "START;MULT 117\n"
+              "START;MULT;ADDER 51\n", folded.str());
+}
+
+TEST_FIXTURE(ProfilerIntel8080Test, Construct)
+{
+    ProfilerIntel8080 profiler;
+    EXPECT_EQ(uint64_t{ 0 }, profiler.TotalCycles());
+    EXPECT_EQ(uint64_t{ 0 }, profiler.TotalInstructions());
+    EXPECT_EQ(size_t{ 1 }, profiler.GetCallTree().size());
+    EXPECT_EQ(uint64_t{ 1 }, profiler.GetCallTree()[0].calls);
+}
+
+TEST_FIXTURE(ProfilerIntel8080Test, Describe)
+{
+    EXPECT_EQ("START", ProfilerIntel8080::Describe(symbols, 0x0000));
+    EXPECT_EQ("LOOP+4", ProfilerIntel8080::Describe(symbols, 0x0009));
+    EXPECT_EQ("ADDER+1F", ProfilerIntel8080::Describe(symbols, 0x0037));
+    EXPECT_EQ("0009", ProfilerIntel8080::Describe(SymbolTableIntel8080(), 0x0009));
+}
+
+TEST_FIXTURE(ProfilerIntel8080Test, MakeSymbolTable)
+{
+    struct Label
+    {
+        std::wstring name;
+        bool locationDefined;
+        uint16_t location;
+    };
+    Assembler::SymbolMap<Label> labels;
+    labels.Add(L"MULT", { L"MULT", true, 0x0010 });
+    labels.Add(L"EXTERNAL", { L"EXTERNAL", false, 0x0000 });
+    labels.Add(L"LOOP", { L"LOOP", true, 0x0005 });
+    SymbolTableIntel8080 table = ProfilerIntel8080::MakeSymbolTable(labels);
+    EXPECT_EQ(size_t{ 2 }, table.size());
+    EXPECT_EQ("LOOP", table[0x0005]);
+    EXPECT_EQ("MULT", table[0x0010]);
+}
+
+TEST_FIXTURE(ProfilerIntel8080Test, ProfileProcessorIntel8080)
+{
+    ProcessorIntel8080 processor;
+    ProfilerIntel8080 profiler;
+    SetupProcessor(processor);
+    processor.SetProfiler(&profiler);
+    processor.Run(size_t{ 100000 });
+    AssertProfile(profiler);
+}
+
+TEST_FIXTURE(ProfilerIntel8080Test, ProfileFastProcessorIntel8080)
+{
+    FastProcessorIntel8080 processor;
+    ProfilerIntel8080 profiler;
+    SetupProcessor(processor);
+    processor.SetProfiler(&profiler);
+    processor.Run();
+    AssertProfile(profiler);
+
+    profiler.Reset();
+    EXPECT_EQ(uint64_t{ 0 }, profiler.TotalCycles());
+    processor.SetProfiler(nullptr);
+    processor.GetRegisters().pc = 0;
+    processor.GetRegisters().isHalted = false;
+    processor.Run();
+    EXPECT_EQ(uint64_t{ 0 }, profiler.TotalCycles());
+}
+
+TEST_FIXTURE(ProfilerIntel8080Test, ProfileJitProcessorIntel8080)
+{
+    // Uses the handlers while profiling
+    JitProcessorIntel8080 processor;
+    processor.SetHotThreshold(1);
+    ProfilerIntel8080 profiler;
+    SetupProcessor(processor);
+    processor.SetProfiler(&profiler);
+    processor.Run(size_t{ 100000 });
+    AssertProfile(profiler);
+    EXPECT_EQ(size_t{ 0 }, processor.GetStatistics().translations);
+}
+
+TEST_FIXTURE(ProfilerIntel8080Test, UnmatchedReturn)
+{
+    // A return to an address not pushed by a call is a jump, the tree is not changed
+    const vector<uint8_t> code =
+    {
+        0x31, 0x00, 0x08,   // 0000 LXI SP,0800
+        0xCD, 0x08, 0x00,   // 0003 CALL SUB
+        0x76,               // 0006 HLT
+        0x00,
+        0x21, 0x0D, 0x00,   // 0008 SUB: LXI H,000D
+        0xE5,               // 000B PUSH H
+        0xC9,               // 000C RET
+        0xC9,               // 000D RET
+    };
+    FastProcessorIntel8080 processor;
+    ProfilerIntel8080 profiler;
+    SetupProcessor(processor, code);
+    processor.SetProfiler(&profiler);
+    processor.Run();
+    std::vector<CallNodeIntel8080> const & tree = profiler.GetCallTree();
+    EXPECT_EQ(size_t{ 2 }, tree.size());
+    EXPECT_EQ(uint64_t{ 10 + 17 + 7 }, tree[0].selfCycles);
+    EXPECT_EQ(uint64_t{ 10 + 11 + 10 + 10 }, tree[1].selfCycles);
+}
+
+TEST_FIXTURE(ProfilerIntel8080Test, Reports)
+{
+    FastProcessorIntel8080 processor;
+    ProfilerIntel8080 profiler;
+    SetupProcessor(processor);
+    processor.SetProfiler(&profiler);
+    processor.Run();
+
+    ostringstream flat;
+    profiler.WriteFlat(flat, symbols, 2);
+    string text = flat.str();
+    EXPECT_EQ(0u, text.find("Total: 288 cycles, 30 instructions\n"));
+    EXPECT_NE(string::npos, text.find("          51  17.71%             6  ADDER\n"));
+    EXPECT_NE(string::npos, text.find("          51  17.71%             3           0           0  0005     LOOP\n"));
+    EXPECT_EQ(string::npos, text.find("START+3\n"));
+
+    ostringstream callTree;
+    profiler.WriteCallTree(callTree, symbols);
+    EXPECT_EQ("       calls   inclusive        self  function\n"
+              "           1         288         120  START\n"
+              "           3         168         117    MULT\n"
+              "           3          51          51      ADDER\n", callTree.str());
+}
+
+} // namespace Test
+
+} // namespace Emulator
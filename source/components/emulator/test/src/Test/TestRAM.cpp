@@ -106,6 +106,22 @@ TEST_FIXTURE(RAMTest, Fetch)
     EXPECT_EQ(machineCode, memory.Fetch(Origin, machineCode.size()));
 }
 
+TEST_FIXTURE(RAMTest, FetchBuffer)
+{
+    std::vector<uint8_t> machineCode =
+    {
+        0x10, 0x22, 0x58, 0x13, 0x30, 0x19, 0x25, 0x20,
+        0x05, 0x30, 0x20, 0x25, 0x19, 0x55, 0x01, 0x25,
+        0x20, 0x14, 0x24, 0x00, 0x00
+    };
+    RAM memory(Base, Size);
+    memory.Load(machineCode, Origin);
+    std::vector<uint8_t> data(machineCode.size());
+    memory.Fetch(Origin, data.data(), data.size());
+    EXPECT_EQ(machineCode, data);
+    EXPECT_THROW(memory.Fetch(Base + Size - 1, data.data(), data.size()), std::runtime_error);
+}
+
 TEST_FIXTURE(RAMTest, Fetch8)
 {
     std::vector<uint8_t> machineCode =
@@ -228,6 +244,19 @@ TEST_FIXTURE(RAMTest, Store)
     }
 }
 
+TEST_FIXTURE(RAMTest, StoreBuffer)
+{
+    RAM memory(Base, Size);
+
+    uint8_t data[] = { 0x10, 0x22, 0x58, 0x13, 0x30, 0x19, 0x25, 0x20 };
+    memory.Store(Base + Size - sizeof(data), data, sizeof(data));
+    for (size_t index = 0; index < sizeof(data); ++index)
+    {
+        EXPECT_EQ(data[index], memory.Fetch8(Base + Size - sizeof(data) + index));
+    }
+    EXPECT_THROW(memory.Store(Base + Size - sizeof(data) + 1, data, sizeof(data)), std::runtime_error);
+}
+
 TEST_FIXTURE(RAMTest, Store8)
 {
     RAM memory(Base, Size);
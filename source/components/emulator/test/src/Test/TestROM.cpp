@@ -106,6 +106,22 @@ TEST_FIXTURE(ROMTest, Fetch)
     EXPECT_EQ(machineCode, memory.Fetch(Origin, machineCode.size()));
 }
 
+TEST_FIXTURE(ROMTest, FetchBuffer)
+{
+    std::vector<uint8_t> machineCode =
+    {
+        0x10, 0x22, 0x58, 0x13, 0x30, 0x19, 0x25, 0x20,
+        0x05, 0x30, 0x20, 0x25, 0x19, 0x55, 0x01, 0x25,
+        0x20, 0x14, 0x24, 0x00, 0x00
+    };
+    ROM memory(Base, Size);
+    memory.Load(machineCode, Origin);
+    std::vector<uint8_t> data(machineCode.size());
+    memory.Fetch(Origin, data.data(), data.size());
+    EXPECT_EQ(machineCode, data);
+    EXPECT_THROW(memory.Fetch(Base + Size - 1, data.data(), data.size()), std::runtime_error);
+}
+
 TEST_FIXTURE(ROMTest, Fetch8)
 {
     std::vector<uint8_t> machineCode =
@@ -219,6 +235,14 @@ TEST_FIXTURE(ROMTest, Store)
     EXPECT_THROW(memory.Store(Base, data), std::runtime_error);
 }
 
+TEST_FIXTURE(ROMTest, StoreBuffer)
+{
+    ROM memory(Base, Size);
+    uint8_t data[] = { 0x00 };
+
+    EXPECT_THROW(memory.Store(Base, data, sizeof(data)), std::runtime_error);
+}
+
 TEST_FIXTURE(ROMTest, Store8)
 {
     ROM memory(Base, Size);
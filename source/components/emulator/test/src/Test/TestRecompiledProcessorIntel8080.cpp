@@ -0,0 +1,294 @@
+#include "unit-test-c++/UnitTestC++.h"
+
+#include <fstream>
+#include <sstream>
+#include "emulator/RecompilerIntel8080.h"
+#include "emulator/RecompiledProcessorIntel8080.h"
+#include "TestData.h"
+#include "TestMachineIntel8080.h"
+
+using namespace std;
+
+namespace Emulator
+{
+
+namespace Recompiled
+{
+
+// RecompiledTestProgram.cpp, generated from RecompiledProcessorIntel8080Test::TestProgram and checked by GeneratedFileUpToDate
+RecompiledCodeIntel8080 const & TestProgram();
+
+} // namespace Recompiled
+
+namespace Test
+{
+
+class RecompiledProcessorIntel8080Test : public UnitTestCpp::TestFixture
+{
+public:
+	virtual void SetUp();
+	virtual void TearDown();
+
+    static const size_t RAMSize = 4096;
+
+    static const vector<uint8_t> TestProgram;
+
+    void SetupProcessor(ProcessorIntel8080 & processor, vector<uint8_t> const & code);
+};
+
+// Runs from RAM, as it modifies its own code
+const vector<uint8_t> RecompiledProcessorIntel8080Test::TestProgram =
+{
+    0xC3, 0x40, 0x00,   // 0000 JMP 0040
+    0x00, 0x00, 0x00, 0x00, 0x00,
+    0x1C,               // 0008 INR E
+    0xC9,               // 0009 RET
+    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+    0x31, 0x00, 0x08,   // 0040 LXI SP,0800
+    0x0E, 0x03,         // 0043 MVI C,03
+    0x16, 0x07,         // 0045 MVI D,07
+    0xCD, 0x90, 0x00,   // 0047 CALL MULT
+    0x21, 0x00, 0x04,   // 004A LXI H,0400
+    0x77,               // 004D MOV M,A
+    0x34,               // 004E INR M
+    0xF5,               // 004F PUSH PSW
+    0xC1,               // 0050 POP B
+    0xEB,               // 0051 XCHG
+    0x19,               // 0052 DAD D
+    0x22, 0x02, 0x04,   // 0053 SHLD 0402
+    0x2A, 0x02, 0x04,   // 0056 LHLD 0402
+    0xCF,               // 0059 RST 1
+    0xE3,               // 005A XTHL
+    0xE3,               // 005B XTHL
+    0x32, 0x04, 0x04,   // 005C STA 0404
+    0x3A, 0x04, 0x04,   // 005F LDA 0404
+    0xC6, 0x99,         // 0062 ADI 99
+    0x27,               // 0064 DAA
+    0x2F,               // 0065 CMA
+    0x37,               // 0066 STC
+    0x3F,               // 0067 CMC
+    0x07,               // 0068 RLC
+    0xD3, 0x10,         // 0069 OUT 10
+    0xDB, 0x10,         // 006B IN 10
+    0xFE, 0x7F,         // 006D CPI 7F
+    0xD4, 0xA0, 0x00,   // 006F CNC ORONE
+    0x3E, 0x04,         // 0072 MVI A,04        INR B
+    0x32, 0xC1, 0x00,   // 0074 STA PATCH1+1
+    0xCD, 0xC0, 0x00,   // 0077 CALL PATCH1
+    0xCD, 0xD0, 0x00,   // 007A CALL PATCH2
+    0x21, 0xA8, 0x00,   // 007D LXI H,DONE
+    0xE9,               // 0080 PCHL
+    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+    0x3E, 0x00,         // 0090 MULT: MVI A,00
+    0x82,               // 0092 MULT0: ADD D
+    0x0D,               // 0093 DCR C
+    0xC2, 0x92, 0x00,   // 0094 JNZ MULT0
+    0xC9,               // 0097 RET
+    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+    0xF6, 0x01,         // 00A0 ORONE: ORI 01
+    0xC8,               // 00A2 RZ
+    0xC9,               // 00A3 RET
+    0x00, 0x00, 0x00, 0x00,
+    0x3C,               // 00A8 DONE: INR A
+    0x76,               // 00A9 HLT
+    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+    0x47,               // 00C0 PATCH1: MOV B,A
+    0x00,               // 00C1 NOP
+    0xC9,               // 00C2 RET
+    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+    0x3E, 0x2C,         // 00D0 PATCH2: MVI A,2C    INR L
+    0x32, 0xD6, 0x00,   // 00D2 STA 00D6
+    0x00,               // 00D5 NOP
+    0x00,               // 00D6 NOP
+    0xC9,               // 00D7 RET
+};
+
+void RecompiledProcessorIntel8080Test::SetUp()
+{
+}
+
+void RecompiledProcessorIntel8080Test::TearDown()
+{
+}
+
+void RecompiledProcessorIntel8080Test::SetupProcessor(ProcessorIntel8080 & processor, vector<uint8_t> const & code)
+{
+    TestMachineIntel8080::SetupProcessorRAM(processor, code, RAMSize);
+}
+
+TEST_FIXTURE(RecompiledProcessorIntel8080Test, Discover)
+{
+    RecompilerIntel8080 recompiler(TestProgram, 0);
+    EXPECT_EQ(vector<uint16_t>({ 0x0000, 0x0008, 0x0040, 0x004A, 0x005A, 0x0072, 0x007A, 0x007D,
+                                 0x0090, 0x0092, 0x0097, 0x00A0, 0x00A3, 0x00C0, 0x00D0 }), recompiler.GetBlockAddresses());
+    RecompilerIntel8080::Block const & block = recompiler.GetBlock(0x0090);
+    EXPECT_EQ(size_t{ 2 }, size_t{ block.size });
+    EXPECT_EQ(vector<uint16_t>({ 0x0090 }), block.instructions);
+    EXPECT_THROW(recompiler.GetBlock(0x00A8), std::runtime_error);
+
+    // Only reachable through PCHL
+    recompiler.AddEntryPoint(0x00A8);
+    EXPECT_EQ(size_t{ 2 }, size_t{ recompiler.GetBlock(0x00A8).size });
+}
+
+TEST_FIXTURE(RecompiledProcessorIntel8080Test, Generate)
+{
+    RecompilerIntel8080 recompiler(TestProgram, 0);
+    ostringstream stream;
+    recompiler.Generate(stream, "TestProgram");
+    string code = stream.str();
+    EXPECT_NE(string::npos, code.find("RecompiledCodeIntel8080 const & TestProgram()"));
+    EXPECT_NE(string::npos, code.find("    // 0094 JNZ 0092\n"
+                                      "    if ((r.flags & FlagsIntel8080::Zero) == FlagsIntel8080::None) { r.pc = 0x0092; r.instructionCycles = 10; return 19; }\n"
+                                      "    r.pc = 0x0097; r.instructionCycles = 10; return 19;\n"));
+    EXPECT_THROW(recompiler.Generate(stream, "3x7"), std::runtime_error);
+    EXPECT_THROW(recompiler.Generate(stream, "Test-Program"), std::runtime_error);
+
+    RecompilerIntel8080 invalid({ 0x08 }, 0);
+    EXPECT_THROW(invalid.Generate(stream, "Invalid"), std::runtime_error);
+}
+
+// A changed recompiler or test program writes the new output next to RecompiledTestProgram.cpp, to be copied over it
+TEST_FIXTURE(RecompiledProcessorIntel8080Test, GeneratedFileUpToDate)
+{
+    RecompilerIntel8080 recompiler(TestProgram, 0);
+    ostringstream generated;
+    recompiler.Generate(generated, "TestProgram");
+
+    string path = TestData::RecompiledTestProgram();
+    ifstream file(path, ios::binary);
+    ASSERT_TRUE(file.good());
+    ostringstream checkedIn;
+    checkedIn << file.rdbuf();
+    if (checkedIn.str() != generated.str())
+    {
+        ofstream actual(path + ".actual", ios::binary);
+        actual << generated.str();
+    }
+    EXPECT_TRUE(checkedIn.str() == generated.str());
+}
+
+TEST_FIXTURE(RecompiledProcessorIntel8080Test, Run)
+{
+    ProcessorIntel8080 reference;
+    RecompiledProcessorIntel8080 processor;
+    SetupProcessor(reference, TestProgram);
+    SetupProcessor(processor, TestProgram);
+    EXPECT_EQ(size_t{ 15 }, processor.LoadRecompiledCode(Recompiled::TestProgram()));
+    EXPECT_EQ(size_t{ 15 }, processor.RecompiledBlockCount());
+    reference.Run(size_t{ 1000000 });
+    processor.Run(size_t{ 1000000 });
+
+    TestMachineIntel8080::AssertRegisters(reference.GetRegisters(), processor.GetRegisters());
+    EXPECT_EQ(reference.GetMemoryManager()->Fetch(0, 0x0800), processor.GetMemoryManager()->Fetch(0, 0x0800));
+    EXPECT_EQ(reference.GetIOManager()->In8(0x10), processor.GetIOManager()->In8(0x10));
+
+    // Both patched blocks are discarded and interpreted instead, as is the target of PCHL.
+    // Any block stops after a store discarding code, so CALL PATCH1 is interpreted as well.
+    RecompiledStatistics const & statistics = processor.GetStatistics();
+    EXPECT_EQ(size_t{ 2 }, statistics.invalidations);
+    EXPECT_EQ(size_t{ 13 }, processor.RecompiledBlockCount());
+    EXPECT_EQ(size_t{ 1 + 3 + 3 + 2 }, statistics.interpretedInstructions);
+    EXPECT_EQ(size_t{ 16 }, statistics.blocks);
+}
+
+TEST_FIXTURE(RecompiledProcessorIntel8080Test, RunPeriodicInterruptWakesHalted)
+{
+    vector<uint8_t> code =
+    {
+        0x31, 0x00, 0x08,   // 0000 LXI SP,0800
+        0xFB,               // 0003 EI
+        0x76,               // 0004 HLT
+        0x00, 0x00, 0x00,
+        0x3E, 0x55,         // 0008 MVI A,55
+        0x76,               // 000A HLT
+    };
+    ProcessorIntel8080 reference;
+    RecompiledProcessorIntel8080 processor;
+    SetupProcessor(reference, code);
+    SetupProcessor(processor, code);
+    size_t calls[2] = {};
+    for (ProcessorIntel8080 * cpu : { &reference, static_cast<ProcessorIntel8080 *>(&processor) })
+    {
+        size_t & count = calls[cpu == &reference ? 0 : 1];
+        cpu->SetupLoop([&count](RegistersIntel8080 &) { ++count; return InterruptFlagsIntel8080(0x0008); });  // RST 1
+        cpu->GetRegisters().cycleCountPeriod = 100;
+        cpu->GetRegisters().cycleCount = 100;
+        // Loop() keeps being called while halted, with interrupts disabled after the first one
+        EXPECT_EQ(size_t{ 1000 }, cpu->Run(size_t{ 1000 }));
+    }
+
+    RegistersIntel8080 & registers = processor.GetRegisters();
+    EXPECT_TRUE(registers.isHalted);
+    EXPECT_FALSE(registers.ie);
+    EXPECT_EQ(0x55, registers.a);
+    EXPECT_EQ(0x000B, registers.pc);
+    EXPECT_EQ(0x0005, processor.GetMemoryManager()->Fetch16(0x07FE));
+    EXPECT_EQ(uint64_t{ 1000 }, registers.cycleCountTotal);
+    EXPECT_EQ(size_t{ 10 }, calls[0]);
+    EXPECT_EQ(size_t{ 10 }, calls[1]);
+    TestMachineIntel8080::AssertRegisters(reference.GetRegisters(), registers);
+}
+
+// 0003 EI, as generated by RecompilerIntel8080
+static size_t BlockEI(RecompiledProcessorIntel8080 & p)
+{
+    RegistersIntel8080 & r = p.Registers();
+    r.ie = true;
+    r.pc = 0x0004; r.instructionCycles = 4; return 4;
+}
+
+TEST_FIXTURE(RecompiledProcessorIntel8080Test, RunInterruptAfterRecompiledEI)
+{
+    vector<uint8_t> code =
+    {
+        0x31, 0x00, 0x08,   // 0000 LXI SP,0800
+        0xFB,               // 0003 EI
+        0x3C,               // 0004 INR A
+        0x76,               // 0005 HLT
+        0x00, 0x00,
+        0x76,               // 0008 HLT
+    };
+    RecompiledBlockIntel8080 const blocks[] = { { 0x0003, 1, OpcodesIntel8080::EI, &BlockEI } };
+    RecompiledCodeIntel8080 const recompiled = { "EI", 0x0000, code.data(), code.size(), blocks, 1 };
+    ProcessorIntel8080 reference;
+    RecompiledProcessorIntel8080 processor;
+    SetupProcessor(reference, code);
+    SetupProcessor(processor, code);
+    EXPECT_EQ(size_t{ 1 }, processor.LoadRecompiledCode(recompiled));
+    // The request is accepted after the instruction following EI
+    for (ProcessorIntel8080 * cpu : { &reference, static_cast<ProcessorIntel8080 *>(&processor) })
+    {
+        cpu->GetInterruptController().Request(1);
+        cpu->Run(size_t{ 100 });
+    }
+    EXPECT_EQ(size_t{ 1 }, processor.GetStatistics().blocks);
+    EXPECT_EQ(0x0009, processor.GetRegisters().pc);
+    EXPECT_EQ(0x01, processor.GetRegisters().a);
+    EXPECT_EQ(0x0005, processor.GetMemoryManager()->Fetch16(0x07FE));
+    TestMachineIntel8080::AssertRegisters(reference.GetRegisters(), processor.GetRegisters());
+}
+
+TEST_FIXTURE(RecompiledProcessorIntel8080Test, LoadMismatch)
+{
+    vector<uint8_t> code = TestProgram;
+    code[0x00A0] = 0xE6;                                // ANI 01
+    RecompiledProcessorIntel8080 processor;
+    SetupProcessor(processor, code);
+    EXPECT_EQ(size_t{ 14 }, processor.LoadRecompiledCode(Recompiled::TestProgram()));
+    processor.UnloadRecompiledCode();
+    EXPECT_EQ(size_t{ 0 }, processor.RecompiledBlockCount());
+
+    ProcessorIntel8080 reference;
+    SetupProcessor(reference, code);
+    processor.LoadRecompiledCode(Recompiled::TestProgram());
+    reference.Run();
+    processor.Run();
+    TestMachineIntel8080::AssertRegisters(reference.GetRegisters(), processor.GetRegisters());
+}
+
+} // namespace Test
+
+} // namespace Emulator
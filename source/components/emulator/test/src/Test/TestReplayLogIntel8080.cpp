@@ -0,0 +1,268 @@
+#include "unit-test-c++/UnitTestC++.h"
+
+#include <sstream>
+#include "emulator/ReplayLogIntel8080.h"
+#include "emulator/JitProcessorIntel8080.h"
+#include "emulator/RAM.h"
+#include "emulator/IOPort.h"
+
+using namespace std;
+
+namespace Emulator
+{
+
+namespace Test
+{
+
+class ReplayLogIntel8080Test : public UnitTestCpp::TestFixture
+{
+public:
+	virtual void SetUp();
+	virtual void TearDown();
+
+    static const size_t RAMSize = 2048;
+    static const size_t IOSize = 256;
+    static const uint64_t DevicePeriod = 1000;
+    static const size_t RunCycles = 100000;
+
+    static const vector<uint8_t> TestProgram;
+
+    uint8_t deviceValue;
+
+    void SetupProcessor(ProcessorIntel8080 & processor);
+    // Every DevicePeriod cycles changes the value of port 10 and requests RST 1
+    void StartDevice(ProcessorIntel8080 & processor, uint64_t deadline);
+    void AssertSameState(ProcessorIntel8080 & expected, ProcessorIntel8080 & actual);
+};
+
+const vector<uint8_t> ReplayLogIntel8080Test::TestProgram =
+{
+    0x31, 0x00, 0x08,   // 0000 LXI SP,0800
+    0xC3, 0x10, 0x00,   // 0003 JMP MAIN
+    0x00, 0x00,
+    0x0C,               // 0008 RST1: INR C
+    0xFB,               // 0009 EI
+    0xC9,               // 000A RET
+    0x00, 0x00, 0x00, 0x00, 0x00,
+    0xFB,               // 0010 MAIN: EI
+    0xDB, 0x10,         // 0011 LOOP: IN 10
+    0x80,               // 0013 ADD B
+    0x47,               // 0014 MOV B,A
+    0xC3, 0x11, 0x00,   // 0015 JMP LOOP
+};
+
+void ReplayLogIntel8080Test::SetUp()
+{
+    deviceValue = 0;
+}
+
+void ReplayLogIntel8080Test::TearDown()
+{
+}
+
+void ReplayLogIntel8080Test::SetupProcessor(ProcessorIntel8080 & processor)
+{
+    MemoryManagerPtr memoryManager = std::make_shared<MemoryManager>();
+    RAMPtr ram = std::make_shared<RAM>(0, RAMSize);
+    memoryManager->AddMemory(ram);
+    IOManagerPtr ioManager = std::make_shared<IOManager>();
+    ioManager->AddIO(std::make_shared<IOPort>(0, IOSize));
+    processor.Setup(memoryManager, ioManager);
+    processor.LoadData(TestProgram, 0, ram);
+}
+
+void ReplayLogIntel8080Test::StartDevice(ProcessorIntel8080 & processor, uint64_t deadline)
+{
+    processor.GetScheduler().Schedule(deadline, [this, &processor](uint64_t time)
+    {
+        deviceValue = uint8_t(deviceValue * 5 + 3);
+        processor.GetIOManager()->Out8(0x10, deviceValue);
+        processor.GetInterruptController().Request(1);
+        StartDevice(processor, time + DevicePeriod);
+    });
+}
+
+void ReplayLogIntel8080Test::AssertSameState(ProcessorIntel8080 & expected, ProcessorIntel8080 & actual)
+{
+    EXPECT_EQ(expected.Now(), actual.Now());
+    EXPECT_EQ(expected.GetRegisters().pc, actual.GetRegisters().pc);
+    EXPECT_EQ(expected.GetRegisters().sp.W, actual.GetRegisters().sp.W);
+    EXPECT_EQ(expected.GetRegisters().bc.W, actual.GetRegisters().bc.W);
+    EXPECT_EQ(expected.GetRegisters().a, actual.GetRegisters().a);
+    EXPECT_EQ(expected.GetRegisters().ie, actual.GetRegisters().ie);
+    for (uint16_t address = 0x07F0; address < 0x0800; ++address)
+        EXPECT_EQ(expected.GetMemoryManager()->Fetch8(address), actual.GetMemoryManager()->Fetch8(address));
+}
+
+TEST_FIXTURE(ReplayLogIntel8080Test, Construct)
+{
+    ReplayLogIntel8080 log;
+    EXPECT_TRUE(ReplayModeIntel8080::Idle == log.GetMode());
+    EXPECT_FALSE(log.IsReplaying());
+    EXPECT_EQ(size_t{ 0 }, log.GetEntries().size());
+    EXPECT_EQ(size_t{ 0 }, log.GetCheckpoints().size());
+    EXPECT_EQ(size_t{ 0 }, log.Position());
+    EXPECT_THROW(log.Seek(0), std::runtime_error);
+}
+
+TEST_FIXTURE(ReplayLogIntel8080Test, Record)
+{
+    FastProcessorIntel8080 processor;
+    SetupProcessor(processor);
+    StartDevice(processor, DevicePeriod);
+    ReplayLogIntel8080 log;
+    log.StartRecording(processor);
+    EXPECT_TRUE(ReplayModeIntel8080::Recording == log.GetMode());
+    EXPECT_EQ(&log, processor.GetReplayLog());
+    processor.Run(RunCycles);
+
+    ReplayEntriesIntel8080 const & entries = log.GetEntries();
+    size_t interrupts = 0;
+    for (auto const & entry : entries)
+    {
+        if (entry.event == ReplayEventIntel8080::Interrupt)
+        {
+            ++interrupts;
+            EXPECT_EQ(0x0008, entry.address);
+        }
+    }
+    EXPECT_EQ(size_t{ RunCycles / DevicePeriod }, interrupts);
+    // The last interrupt is delivered at the end of the run, before its routine counts it
+    EXPECT_EQ(interrupts - 1, size_t(processor.GetRegisters().bc.B.l));
+    // IN 10 at the start of the loop, after LXI SP, JMP and EI
+    EXPECT_EQ(uint64_t{ 10 + 10 + 4 }, entries[0].cycles);
+    EXPECT_TRUE(ReplayEventIntel8080::In == entries[0].event);
+    EXPECT_EQ(0x10, entries[0].address);
+    EXPECT_EQ(0x00, entries[0].data);
+
+    log.Stop();
+    EXPECT_TRUE(ReplayModeIntel8080::Idle == log.GetMode());
+    EXPECT_NULL(processor.GetReplayLog());
+}
+
+TEST_FIXTURE(ReplayLogIntel8080Test, Replay)
+{
+    // Replays without the device on every engine, interrupts requested during replay are ignored
+    FastProcessorIntel8080 recorder;
+    SetupProcessor(recorder);
+    StartDevice(recorder, DevicePeriod);
+    ReplayLogIntel8080 log;
+    log.StartRecording(recorder);
+    recorder.Run(RunCycles);
+    log.Stop();
+
+    ProcessorIntel8080 processor;
+    FastProcessorIntel8080 fast;
+    JitProcessorIntel8080 jit;
+    jit.SetHotThreshold(1);
+    ProcessorIntel8080 * processors[] = { &processor, &fast, &jit };
+    for (auto replayer : processors)
+    {
+        SetupProcessor(*replayer);
+        log.StartReplay(*replayer);
+        EXPECT_TRUE(log.IsReplaying());
+        replayer->GetInterruptController().Request(2);
+        replayer->Run(RunCycles);
+        AssertSameState(recorder, *replayer);
+        EXPECT_EQ(log.GetEntries().size(), log.Position());
+        log.Stop();
+    }
+    EXPECT_EQ(size_t{ 0 }, jit.GetStatistics().translations);
+}
+
+TEST_FIXTURE(ReplayLogIntel8080Test, Diverge)
+{
+    FastProcessorIntel8080 recorder;
+    SetupProcessor(recorder);
+    StartDevice(recorder, DevicePeriod);
+    ReplayLogIntel8080 log;
+    log.StartRecording(recorder, 10000);
+    recorder.Run(RunCycles);
+    log.Stop();
+
+    FastProcessorIntel8080 processor;
+    SetupProcessor(processor);
+    log.StartReplay(processor);
+    // ADD M takes 7 cycles instead of 4, so the next IN is not at the cycle recorded
+    processor.GetMemoryManager()->Store8(0x0013, 0x86);
+    EXPECT_THROW(processor.Run(RunCycles), std::runtime_error);
+}
+
+TEST_FIXTURE(ReplayLogIntel8080Test, Seek)
+{
+    FastProcessorIntel8080 recorder;
+    SetupProcessor(recorder);
+    StartDevice(recorder, DevicePeriod);
+    ReplayLogIntel8080 log;
+    log.StartRecording(recorder, 10000);
+    recorder.Run(RunCycles);
+    log.Stop();
+    std::vector<ReplayCheckpointIntel8080> const & checkpoints = log.GetCheckpoints();
+    EXPECT_EQ(size_t{ 11 }, checkpoints.size());
+    EXPECT_EQ(size_t{ 0 }, checkpoints[0].entry);
+    EXPECT_EQ(uint64_t{ 0 }, uint64_t(checkpoints[0].snapshot.GetRegisters().cycleCountTotal));
+    EXPECT_LE(uint64_t{ 50000 }, uint64_t(checkpoints[5].snapshot.GetRegisters().cycleCountTotal));
+    EXPECT_GREATER(uint64_t{ 50020 }, uint64_t(checkpoints[5].snapshot.GetRegisters().cycleCountTotal));
+    // Only the stack page and the IO port page change between checkpoints
+    EXPECT_EQ(checkpoints[5].snapshot.PageCount() - 2, checkpoints[5].snapshot.SharedPageCount(checkpoints[4].snapshot));
+
+    // Compare with replaying from the start without seeking
+    FastProcessorIntel8080 expected;
+    SetupProcessor(expected);
+    ReplayLogIntel8080 expectedLog(log);
+
+    FastProcessorIntel8080 processor;
+    SetupProcessor(processor);
+    log.StartReplay(processor);
+    uint64_t targets[] = { 55555, 21000, 21500, 99999, 0 };
+    for (auto target : targets)
+    {
+        log.Seek(target);
+        EXPECT_LE(target, processor.Now());
+        EXPECT_GREATER(target + 20, processor.Now());
+        expectedLog.StartReplay(expected);
+        while (expected.Now() < target)
+            expected.Run(size_t(target - expected.Now()));
+        AssertSameState(expected, processor);
+        EXPECT_EQ(expectedLog.Position(), log.Position());
+    }
+}
+
+TEST_FIXTURE(ReplayLogIntel8080Test, SaveLoad)
+{
+    FastProcessorIntel8080 recorder;
+    SetupProcessor(recorder);
+    StartDevice(recorder, DevicePeriod);
+    ReplayLogIntel8080 log;
+    log.StartRecording(recorder, 25000);
+    recorder.Run(RunCycles);
+    log.Stop();
+
+    ostringstream stream;
+    log.Save(stream);
+    string data = stream.str();
+    // Deltas of up to 63 cycles take a single byte
+    EXPECT_GREATER(log.GetEntries().size() * 4 + log.GetCheckpoints().size() * (RAMSize + IOSize + 256), data.size());
+
+    istringstream input(data);
+    ReplayLogIntel8080 loaded = ReplayLogIntel8080::Load(input);
+    EXPECT_TRUE(log.GetEntries() == loaded.GetEntries());
+    EXPECT_EQ(log.GetCheckpoints().size(), loaded.GetCheckpoints().size());
+    EXPECT_EQ(size_t{ 0 }, loaded.GetCheckpoints()[2].snapshot.SharedPageCount(log.GetCheckpoints()[2].snapshot));
+
+    FastProcessorIntel8080 processor;
+    SetupProcessor(processor);
+    loaded.StartReplay(processor);
+    loaded.Seek(80000);
+    processor.Run(RunCycles - size_t(processor.Now()));
+    AssertSameState(recorder, processor);
+
+    istringstream invalid(data.substr(0, data.size() / 2));
+    EXPECT_THROW(ReplayLogIntel8080::Load(invalid), std::runtime_error);
+    istringstream empty;
+    EXPECT_THROW(ReplayLogIntel8080::Load(empty), std::runtime_error);
+}
+
+} // namespace Test
+
+} // namespace Emulator
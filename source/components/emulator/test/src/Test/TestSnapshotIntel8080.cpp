@@ -0,0 +1,292 @@
+#include "unit-test-c++/UnitTestC++.h"
+
+#include <sstream>
+#include "emulator/SnapshotIntel8080.h"
+#include "emulator/CachedProcessorIntel8080.h"
+#include "emulator/ProcessorIntel8085.h"
+
+using namespace std;
+
+namespace Emulator
+{
+
+namespace Test
+{
+
+class SnapshotIntel8080Test : public UnitTestCpp::TestFixture
+{
+public:
+	virtual void SetUp();
+	virtual void TearDown();
+
+    static const size_t ROMSize = 256;
+    static const size_t RAMOrigin = 256;
+    static const size_t RAMSize = 2048;
+    static const size_t IOSize = 256;
+
+    // 0000 LXI SP,0800; 0003 MVI A,5A; 0005 STA 0400; 0008 OUT 10; 000A INR A; 000B STA 0401; 000E HLT
+    static const vector<uint8_t> Code;
+
+    void SetupProcessor(ProcessorIntel8080 & processor, vector<uint8_t> const & code = Code);
+};
+
+const vector<uint8_t> SnapshotIntel8080Test::Code =
+{
+    0x31, 0x00, 0x08, 0x3E, 0x5A, 0x32, 0x00, 0x04, 0xD3, 0x10, 0x3C, 0x32, 0x01, 0x04, 0x76,
+};
+
+void SnapshotIntel8080Test::SetUp()
+{
+}
+
+void SnapshotIntel8080Test::TearDown()
+{
+}
+
+void SnapshotIntel8080Test::SetupProcessor(ProcessorIntel8080 & processor, vector<uint8_t> const & code)
+{
+    MemoryManagerPtr memoryManager = std::make_shared<MemoryManager>();
+    ROMPtr rom = std::make_shared<ROM>(0, ROMSize);
+    memoryManager->AddMemory(rom);
+    memoryManager->AddMemory(std::make_shared<RAM>(RAMOrigin, RAMSize));
+    IOManagerPtr ioManager = std::make_shared<IOManager>();
+    ioManager->AddIO(std::make_shared<IOPort>(0, IOSize));
+    processor.Setup(memoryManager, ioManager);
+    processor.LoadCode(code, 0, rom);
+}
+
+TEST_FIXTURE(SnapshotIntel8080Test, TakeRestore)
+{
+    ProcessorIntel8080 processor;
+    SetupProcessor(processor);
+    processor.Run(size_t{ 40 });   // Up to and including OUT 10
+    EXPECT_EQ(0x000A, processor.GetRegisters().pc);
+    SnapshotIntel8080 snapshot = SnapshotIntel8080::Take(processor);
+    EXPECT_EQ(size_t{ 9 }, snapshot.PageCount());
+    EXPECT_EQ(0x000A, snapshot.GetRegisters().pc);
+
+    processor.Run();
+    EXPECT_TRUE(processor.GetRegisters().isHalted);
+    EXPECT_EQ(0x5B, processor.GetMemoryManager()->Fetch8(0x0401));
+
+    snapshot.Restore(processor);
+    RegistersIntel8080 & registers = processor.GetRegisters();
+    EXPECT_FALSE(registers.isHalted);
+    EXPECT_EQ(0x000A, registers.pc);
+    EXPECT_EQ(0x5A, registers.a);
+    EXPECT_EQ(0x0800, registers.sp.W);
+    EXPECT_EQ(0x5A, processor.GetMemoryManager()->Fetch8(0x0400));
+    EXPECT_EQ(0x00, processor.GetMemoryManager()->Fetch8(0x0401));
+    EXPECT_EQ(0x5A, processor.GetIOManager()->In8(0x10));
+
+    processor.Run();
+    EXPECT_EQ(0x5B, processor.GetMemoryManager()->Fetch8(0x0401));
+}
+
+TEST_FIXTURE(SnapshotIntel8080Test, Fork)
+{
+    ProcessorIntel8080 processor;
+    SetupProcessor(processor);
+    processor.Run(size_t{ 40 });
+    SnapshotIntel8080 warm = SnapshotIntel8080::Take(processor);
+
+    for (int fork = 0; fork < 3; ++fork)
+    {
+        ProcessorIntel8080 forked;
+        SetupProcessor(forked);
+        SnapshotIntel8080 copy = warm;
+        EXPECT_EQ(copy.PageCount(), copy.SharedPageCount(warm));
+        copy.Restore(forked);
+        forked.GetRegisters().a = uint8_t(fork);
+        forked.Run();
+        EXPECT_EQ(uint8_t(fork + 1), forked.GetMemoryManager()->Fetch8(0x0401));
+
+        // Only the page written after the snapshot is stored again
+        SnapshotIntel8080 next = SnapshotIntel8080::Take(forked, &warm);
+        EXPECT_EQ(warm.PageCount() - 1, next.SharedPageCount(warm));
+    }
+}
+
+TEST_FIXTURE(SnapshotIntel8080Test, TakeIncremental)
+{
+    ProcessorIntel8080 processor;
+    SetupProcessor(processor);
+    EXPECT_THROW(SnapshotIntel8080::TakeIncremental(processor, SnapshotIntel8080()), std::runtime_error);
+
+    processor.GetMemoryManager()->TrackDirtyPages(true);
+    SnapshotIntel8080 first = SnapshotIntel8080::TakeIncremental(processor, SnapshotIntel8080());
+    EXPECT_EQ(size_t{ 9 }, first.PageCount());
+    EXPECT_EQ(size_t{ 0 }, processor.GetMemoryManager()->GetDirtyPages().size());
+
+    processor.Run(size_t{ 40 });
+    EXPECT_EQ(std::vector<size_t>({ 0x0400 }), processor.GetMemoryManager()->GetDirtyPages());
+    SnapshotIntel8080 second = SnapshotIntel8080::TakeIncremental(processor, first);
+    EXPECT_EQ(first.PageCount() - 2, second.SharedPageCount(first));
+    EXPECT_EQ(size_t{ 0 }, processor.GetMemoryManager()->GetDirtyPages().size());
+
+    // A page changed behind the back of dirty tracking is not picked up
+    processor.GetMemoryManager()->TrackDirtyPages(false);
+    processor.GetMemoryManager()->Store8(0x0200, 0xFF);
+    processor.GetMemoryManager()->TrackDirtyPages(true);
+    SnapshotIntel8080 third = SnapshotIntel8080::TakeIncremental(processor, second);
+    EXPECT_EQ(second.PageCount(), third.SharedPageCount(second));
+
+    processor.Run();
+    first.Restore(processor);
+    EXPECT_EQ(0x00, processor.GetMemoryManager()->Fetch8(0x0400));
+    second.Restore(processor);
+    EXPECT_EQ(0x5A, processor.GetMemoryManager()->Fetch8(0x0400));
+    EXPECT_EQ(0x000A, processor.GetRegisters().pc);
+}
+
+TEST_FIXTURE(SnapshotIntel8080Test, SaveLoad)
+{
+    ProcessorIntel8080 processor;
+    SetupProcessor(processor);
+    processor.GetRegisters().cycleCountPeriod = 1000;
+    processor.GetRegisters().cycleCount = 1000;
+    processor.Run(size_t{ 40 });
+    SnapshotIntel8080 snapshot = SnapshotIntel8080::Take(processor);
+    stringstream stream;
+    snapshot.Save(stream);
+    EXPECT_EQ(size_t{ 86 + RAMSize + IOSize }, stream.str().size());
+    SnapshotIntel8080 loaded = SnapshotIntel8080::Load(stream);
+
+    ProcessorIntel8080 restored;
+    SetupProcessor(restored);
+    loaded.Restore(restored);
+    RegistersIntel8080 const & expected = processor.GetRegisters();
+    RegistersIntel8080 const & actual = restored.GetRegisters();
+    EXPECT_EQ(expected.pc, actual.pc);
+    EXPECT_EQ(expected.sp.W, actual.sp.W);
+    EXPECT_EQ(expected.a, actual.a);
+    EXPECT_EQ(expected.flags, actual.flags);
+    EXPECT_EQ(expected.cycleCount, actual.cycleCount);
+    EXPECT_EQ(expected.cycleCountPeriod, actual.cycleCountPeriod);
+    EXPECT_EQ(expected.cycleCountTotal, actual.cycleCountTotal);
+    EXPECT_EQ(processor.GetMemoryManager()->Fetch(RAMOrigin, RAMSize), restored.GetMemoryManager()->Fetch(RAMOrigin, RAMSize));
+    EXPECT_EQ(processor.GetIOManager()->In(0, IOSize), restored.GetIOManager()->In(0, IOSize));
+}
+
+TEST_FIXTURE(SnapshotIntel8080Test, Interrupts)
+{
+    ProcessorIntel8080 processor;
+    SetupProcessor(processor);
+    InterruptControllerIntel8080 & interruptController = processor.GetInterruptController();
+    interruptController.Request(2);
+    interruptController.Request(5);
+    interruptController.SetMask(0x20);
+    SnapshotIntel8080 snapshot = SnapshotIntel8080::Take(processor);
+    EXPECT_EQ(0x24, snapshot.GetInterrupts().pending);
+    EXPECT_EQ(0x20, snapshot.GetInterrupts().mask);
+    EXPECT_FALSE(snapshot.GetInterrupts().is8085);
+
+    interruptController.Reset();
+    interruptController.Request(7);
+    snapshot.Restore(processor);
+    EXPECT_EQ(0x24, interruptController.GetPending());
+    EXPECT_EQ(0x20, interruptController.GetMask());
+
+    stringstream stream;
+    snapshot.Save(stream);
+    ProcessorIntel8080 restored;
+    SetupProcessor(restored);
+    SnapshotIntel8080::Load(stream).Restore(restored);
+    EXPECT_EQ(0x24, restored.GetInterruptController().GetPending());
+    EXPECT_EQ(0x20, restored.GetInterruptController().GetMask());
+    // The pending level 2 is delivered after restoring, the masked level 5 is not
+    restored.GetRegisters().sp.W = 0x0800;
+    restored.GetRegisters().ie = true;
+    restored.Run(size_t{ 1 });
+    EXPECT_EQ(0x07FE, restored.GetRegisters().sp.W);
+    EXPECT_FALSE(restored.GetRegisters().ie);
+    EXPECT_EQ(0x20, restored.GetInterruptController().GetPending());
+}
+
+TEST_FIXTURE(SnapshotIntel8080Test, Interrupts8085)
+{
+    // 0000 MVI A,CD; 0002 SIM; 0003 HLT: M5.5 and M7.5 set, M6.5 clear, SOD high
+    ProcessorIntel8085 processor;
+    SetupProcessor(processor, { 0x3E, 0xCD, 0x30, 0x76 });
+    processor.SetSerialInput(true);
+    processor.Run();
+    EXPECT_EQ(0x05, processor.GetInterruptMasks());
+    EXPECT_TRUE(processor.GetSerialOutput());
+    SnapshotIntel8080 snapshot = SnapshotIntel8080::Take(processor);
+    EXPECT_TRUE(snapshot.GetInterrupts().is8085);
+    stringstream stream;
+    snapshot.Save(stream);
+
+    ProcessorIntel8085 restored;
+    SetupProcessor(restored, { 0x3E, 0xCD, 0x30, 0x76 });
+    EXPECT_EQ(0x07, restored.GetInterruptMasks());
+    SnapshotIntel8080::Load(stream).Restore(restored);
+    EXPECT_EQ(0x05, restored.GetInterruptMasks());
+    EXPECT_TRUE(restored.GetSerialOutput());
+    // RIM returns SID in bit 7 and the masks in bits 0 - 2
+    restored.GetMemoryManager()->Store(RAMOrigin, vector<uint8_t>{ 0x20, 0x76 });     // RIM; HLT
+    restored.GetRegisters().pc = Reg16(RAMOrigin);
+    restored.GetRegisters().isHalted = false;
+    restored.Run();
+    EXPECT_EQ(0x85, restored.GetRegisters().a);
+
+    // An 8080 and an 8085 snapshot do not restore into each other
+    ProcessorIntel8080 processor8080;
+    SetupProcessor(processor8080);
+    EXPECT_THROW(snapshot.Restore(processor8080), std::runtime_error);
+    EXPECT_THROW(SnapshotIntel8080::Take(processor8080).Restore(restored), std::runtime_error);
+}
+
+TEST_FIXTURE(SnapshotIntel8080Test, LoadInvalid)
+{
+    stringstream empty;
+    EXPECT_THROW(SnapshotIntel8080::Load(empty), std::runtime_error);
+    stringstream invalid("Not a snapshot");
+    EXPECT_THROW(SnapshotIntel8080::Load(invalid), std::runtime_error);
+
+    ProcessorIntel8080 processor;
+    SetupProcessor(processor);
+    stringstream truncated;
+    SnapshotIntel8080::Take(processor).Save(truncated);
+    truncated.str(truncated.str().substr(0, 100));
+    EXPECT_THROW(SnapshotIntel8080::Load(truncated), std::runtime_error);
+}
+
+TEST_FIXTURE(SnapshotIntel8080Test, RestoreLayoutMismatch)
+{
+    ProcessorIntel8080 processor;
+    SetupProcessor(processor);
+    SnapshotIntel8080 snapshot = SnapshotIntel8080::Take(processor);
+
+    ProcessorIntel8080 other;
+    MemoryManagerPtr memoryManager = std::make_shared<MemoryManager>();
+    memoryManager->AddMemory(std::make_shared<RAM>(0, 4096));
+    IOManagerPtr ioManager = std::make_shared<IOManager>();
+    ioManager->AddIO(std::make_shared<IOPort>(0, IOSize));
+    other.Setup(memoryManager, ioManager);
+    EXPECT_THROW(snapshot.Restore(other), std::runtime_error);
+    ProcessorIntel8080 notSetup;
+    EXPECT_THROW(SnapshotIntel8080::Take(notSetup), std::runtime_error);
+}
+
+TEST_FIXTURE(SnapshotIntel8080Test, RestoreInvalidatesCachedCode)
+{
+    CachedProcessorIntel8080 processor;
+    SetupProcessor(processor);
+    processor.LoadCode({ 0xC3, 0x00, 0x01 }, 0, std::dynamic_pointer_cast<ROM>(processor.GetMemoryManager()->GetMemoryBlocks()[0]));
+    processor.GetMemoryManager()->Store(0x0100, vector<uint8_t>{ 0x3C, 0x76 });   // 0100 INR A; 0101 HLT
+    SnapshotIntel8080 snapshot = SnapshotIntel8080::Take(processor);
+
+    processor.GetMemoryManager()->Store8(0x0100, 0x04);                         // 0100 INR B
+    processor.Run();
+    EXPECT_EQ(0x01, processor.GetRegisters().bc.B.h);
+
+    snapshot.Restore(processor);
+    processor.Run();
+    EXPECT_EQ(0x01, processor.GetRegisters().a);
+    EXPECT_EQ(0x00, processor.GetRegisters().bc.B.h);
+}
+
+} // namespace Test
+
+} // namespace Emulator
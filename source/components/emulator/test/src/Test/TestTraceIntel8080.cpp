@@ -0,0 +1,232 @@
+#include "unit-test-c++/UnitTestC++.h"
+
+#include <sstream>
+#include "emulator/BreakpointManager.h"
+#include "emulator/CachedProcessorIntel8080.h"
+#include "emulator/TraceIntel8080.h"
+
+using namespace std;
+
+namespace Emulator
+{
+
+namespace Test
+{
+
+class TraceIntel8080Test : public UnitTestCpp::TestFixture
+{
+public:
+	virtual void SetUp();
+	virtual void TearDown();
+
+    static const size_t ROMSize = 256;
+    static const size_t RAMSize = 256;
+
+    void SetupProcessor(ProcessorIntel8080 & processor, vector<uint8_t> const & code);
+    static TraceRecordIntel8080 CreateRecord(uint16_t pc);
+};
+
+void TraceIntel8080Test::SetUp()
+{
+}
+
+void TraceIntel8080Test::TearDown()
+{
+}
+
+void TraceIntel8080Test::SetupProcessor(ProcessorIntel8080 & processor, vector<uint8_t> const & code)
+{
+    MemoryManagerPtr memoryManager = std::make_shared<MemoryManager>();
+    ROMPtr rom = std::make_shared<ROM>(0, ROMSize);
+    memoryManager->AddMemory(rom);
+    memoryManager->AddMemory(std::make_shared<RAM>(ROMSize, RAMSize));
+    IOManagerPtr ioManager = std::make_shared<IOManager>();
+    ioManager->AddIO(std::make_shared<IOPort>(0, 256));
+    processor.Setup(memoryManager, ioManager);
+    processor.LoadCode(code, 0, rom);
+}
+
+TraceRecordIntel8080 TraceIntel8080Test::CreateRecord(uint16_t pc)
+{
+    TraceRecordIntel8080 record;
+    record.pc = pc;
+    return record;
+}
+
+TEST_FIXTURE(TraceIntel8080Test, Buffer)
+{
+    TraceBufferIntel8080 buffer(3);
+    EXPECT_EQ(size_t{ 4 }, buffer.Capacity());
+    TraceRecordIntel8080 records[4];
+    for (uint16_t round = 0; round < 3; ++round)
+    {
+        for (uint16_t index = 0; index < 4; ++index)
+        {
+            EXPECT_TRUE(buffer.TryPush(CreateRecord(round * 4 + index)));
+        }
+        EXPECT_FALSE(buffer.TryPush(CreateRecord(0)));
+        EXPECT_EQ(size_t{ 4 }, buffer.Size());
+        EXPECT_EQ(size_t{ 3 }, buffer.Pop(records, 3));
+        EXPECT_EQ(round * 4 + 2, records[2].pc);
+        EXPECT_EQ(size_t{ 1 }, buffer.Pop(records, 4));
+        EXPECT_EQ(round * 4 + 3, records[0].pc);
+        EXPECT_EQ(size_t{ 0 }, buffer.Pop(records, 4));
+    }
+}
+
+TEST_FIXTURE(TraceIntel8080Test, RecordAndLoad)
+{
+    ProcessorIntel8080 processor;
+    // 0000 LXI SP,0200; 0003 MVI B,0A; 0005 LOOP: DCR B; 0006 JNZ LOOP; 0009 EI; 000A HLT
+    SetupProcessor(processor, { 0x31, 0x00, 0x02, 0x06, 0x0A, 0x05, 0xC2, 0x05, 0x00, 0xFB, 0x76 });
+    stringstream stream;
+    {
+        // Small buffer, so the writer thread has to keep up with the processor
+        TraceRecorderIntel8080 recorder(stream, 4);
+        recorder.Start(processor);
+        processor.Run();
+        recorder.Stop();
+        EXPECT_EQ(size_t{ 24 }, recorder.RecordCount());
+        EXPECT_FALSE(processor.GetRegisters().trace);
+    }
+    EXPECT_EQ(size_t{ 8 + 24 * TraceRecordIntel8080::Size }, stream.str().size());
+
+    TraceRecordsIntel8080 trace = TraceReaderIntel8080::Load(stream);
+    ASSERT_EQ(size_t{ 24 }, trace.size());
+    EXPECT_EQ(0x0000, trace[0].pc);
+    EXPECT_EQ(0x31, trace[0].opcode);
+    EXPECT_EQ(0x00, trace[0].operand1);
+    EXPECT_EQ(0x02, trace[0].operand2);
+    EXPECT_EQ(uint64_t{ 0 }, trace[0].cycles);
+    EXPECT_EQ(0x0003, trace[1].pc);
+    EXPECT_EQ(0x0200, trace[1].sp);
+    EXPECT_EQ(uint64_t{ 10 }, trace[1].cycles);
+    EXPECT_EQ(0x0005, trace[2].pc);
+    EXPECT_EQ(0x0A00, trace[2].bc);
+    EXPECT_EQ(uint64_t{ 17 }, trace[2].cycles);
+    EXPECT_EQ(0x0009, trace[22].pc);
+    EXPECT_EQ(0x00, trace[22].status);
+    EXPECT_EQ(0x000A, trace[23].pc);
+    EXPECT_EQ(0x0000, trace[23].bc);
+    EXPECT_EQ(uint8_t{ TraceRecordIntel8080::StatusInterruptsEnabled }, trace[23].status);
+    EXPECT_EQ(uint64_t{ 10 + 7 + 10 * (5 + 10) + 4 }, trace[23].cycles);
+}
+
+TEST_FIXTURE(TraceIntel8080Test, RecordEngines)
+{
+    // 0000 LXI SP,0200; 0003 MVI B,0A; 0005 LOOP: ADI 11; 0007 DCR B; 0008 JNZ LOOP; 000B EI; 000C HLT
+    vector<uint8_t> const code = { 0x31, 0x00, 0x02, 0x06, 0x0A, 0xC6, 0x11, 0x05, 0xC2, 0x05, 0x00, 0xFB, 0x76 };
+    ProcessorIntel8080 reference;
+    SetupProcessor(reference, code);
+    stringstream referenceStream;
+    TraceRecorderIntel8080 referenceRecorder(referenceStream);
+    referenceRecorder.Start(reference);
+    reference.Run();
+    referenceRecorder.Stop();
+    TraceRecordsIntel8080 expected = TraceReaderIntel8080::Load(referenceStream);
+    ASSERT_EQ(size_t{ 34 }, expected.size());
+
+    // The fast engine records from its own loop, with the lazy flags evaluated, and leaves the debug callback alone
+    FastProcessorIntel8080 fast;
+    SetupProcessor(fast, code);
+    fast.SetLazyFlags(true);
+    stringstream fastStream;
+    TraceRecorderIntel8080 fastRecorder(fastStream);
+    fastRecorder.Start(fast);
+    EXPECT_EQ(&fastRecorder, fast.GetTraceRecorder());
+    EXPECT_FALSE(fast.GetRegisters().trace);
+    fast.Run();
+    fastRecorder.Stop();
+    EXPECT_NULL(fast.GetTraceRecorder());
+    EXPECT_EQ(TraceReaderIntel8080::npos, TraceReaderIntel8080::Diff(expected, TraceReaderIntel8080::Load(fastStream)));
+
+    // Engines running translated code fall back to the same loop
+    CachedProcessorIntel8080 cached;
+    SetupProcessor(cached, code);
+    stringstream cachedStream;
+    TraceRecorderIntel8080 cachedRecorder(cachedStream);
+    cachedRecorder.Start(cached);
+    cached.Run(1000);
+    cachedRecorder.Stop();
+    EXPECT_EQ(size_t{ 0 }, cached.CachedBlockCount());
+    EXPECT_EQ(TraceReaderIntel8080::npos, TraceReaderIntel8080::Diff(expected, TraceReaderIntel8080::Load(cachedStream)));
+}
+
+TEST_FIXTURE(TraceIntel8080Test, RecordWithReadWatchpoint)
+{
+    // 0000 LXI SP,0200; 0003 MVI B,0A; 0005 LOOP: DCR B; 0006 JNZ LOOP; 0009 EI; 000A HLT
+    vector<uint8_t> const code = { 0x31, 0x00, 0x02, 0x06, 0x0A, 0x05, 0xC2, 0x05, 0x00, 0xFB, 0x76 };
+    // Reading the instructions for the trace must not hit a read watchpoint on code the program only executes.
+    // Operand fetches are reads, so the watchpoint only covers DCR B.
+    ProcessorIntel8080 reference;
+    FastProcessorIntel8080 fast;
+    ProcessorIntel8080 * processors[] = { &reference, &fast };
+    for (auto processor : processors)
+    {
+        SetupProcessor(*processor, code);
+        BreakpointManager breakpoints(processor->GetMemoryManager());
+        breakpoints.AddWatchpoint(0x0005, 0x0005, MemoryAccess::Read);
+        stringstream stream;
+        TraceRecorderIntel8080 recorder(stream);
+        recorder.Start(*processor);
+        processor->Run();
+        recorder.Stop();
+        EXPECT_FALSE(breakpoints.HasStopped());
+        EXPECT_TRUE(processor->GetRegisters().isHalted);
+        TraceRecordsIntel8080 trace = TraceReaderIntel8080::Load(stream);
+        ASSERT_EQ(size_t{ 24 }, trace.size());
+        EXPECT_EQ(0x31, trace[0].opcode);
+        EXPECT_EQ(0x02, trace[0].operand2);
+        EXPECT_EQ(0x05, trace[2].opcode);
+        EXPECT_EQ(0xC2, trace[3].opcode);
+        EXPECT_EQ(0x05, trace[3].operand1);
+    }
+}
+
+TEST_FIXTURE(TraceIntel8080Test, Print)
+{
+    TraceRecordIntel8080 record;
+    record.cycles = 17;
+    record.pc = 0x0006;
+    record.opcode = 0xC2;
+    record.operand1 = 0x05;
+    record.operand2 = 0x00;
+    record.a = 0xAB;
+    record.bc = 0x0900;
+    record.sp = 0x0200;
+    record.flags = 0x02;
+    ostringstream stream;
+    TraceReaderIntel8080::Print(stream, record);
+    EXPECT_EQ("          17 0006 C2 05 00 JNZ          A=AB BC=0900 DE=0000 HL=0000 SP=0200 F=02 DI\n", stream.str());
+}
+
+TEST_FIXTURE(TraceIntel8080Test, Diff)
+{
+    TraceRecordsIntel8080 first = { CreateRecord(0), CreateRecord(1), CreateRecord(2) };
+    TraceRecordsIntel8080 second = first;
+    EXPECT_EQ(TraceReaderIntel8080::npos, TraceReaderIntel8080::Diff(first, second));
+    second[1].flags = 0x01;
+    EXPECT_EQ(size_t{ 1 }, TraceReaderIntel8080::Diff(first, second));
+    second = first;
+    second.pop_back();
+    EXPECT_EQ(size_t{ 2 }, TraceReaderIntel8080::Diff(first, second));
+}
+
+TEST_FIXTURE(TraceIntel8080Test, LoadInvalid)
+{
+    stringstream empty;
+    EXPECT_THROW(TraceReaderIntel8080::Load(empty), std::runtime_error);
+    stringstream invalid("Not a trace");
+    EXPECT_THROW(TraceReaderIntel8080::Load(invalid), std::runtime_error);
+
+    stringstream truncated;
+    TraceRecorderIntel8080::WriteHeader(truncated);
+    TraceRecordIntel8080 record;
+    TraceRecorderIntel8080::Write(truncated, &record, 1);
+    truncated.str(truncated.str().substr(0, 8 + TraceRecordIntel8080::Size - 1));
+    EXPECT_THROW(TraceReaderIntel8080::Load(truncated), std::runtime_error);
+}
+
+} // namespace Test
+
+} // namespace Emulator
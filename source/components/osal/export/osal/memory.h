@@ -0,0 +1,17 @@
+#pragma once
+
+#include <cstddef>
+
+namespace OSAL
+{
+
+// Memory for generated code, allocated in whole pages. It is never writable and executable at the same time:
+// it starts out readable and writable, and has to be made executable before the code in it runs.
+// Returns nullptr if the system refuses the allocation.
+void * AllocateExecutableMemory(std::size_t size);
+// Switches memory from AllocateExecutableMemory() between readable and executable, and readable and writable.
+// Returns false if the system refuses the change.
+bool ProtectExecutableMemory(void * address, std::size_t size, bool executable);
+void FreeExecutableMemory(void * address, std::size_t size);
+
+}
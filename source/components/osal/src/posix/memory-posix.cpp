@@ -0,0 +1,27 @@
+#include "osal/memory.h"
+
+#if defined(__GNUC__)
+
+#include <sys/mman.h>
+
+using namespace std;
+using namespace OSAL;
+
+void * OSAL::AllocateExecutableMemory(std::size_t size)
+{
+	void * address = mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+	return (address == MAP_FAILED) ? nullptr : address;
+}
+
+bool OSAL::ProtectExecutableMemory(void * address, std::size_t size, bool executable)
+{
+	return mprotect(address, size, executable ? (PROT_READ | PROT_EXEC) : (PROT_READ | PROT_WRITE)) == 0;
+}
+
+void OSAL::FreeExecutableMemory(void * address, std::size_t size)
+{
+	if (address != nullptr)
+		munmap(address, size);
+}
+
+#endif // defined(__GNUC__)
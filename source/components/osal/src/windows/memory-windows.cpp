@@ -0,0 +1,28 @@
+#include "osal/memory.h"
+
+#if defined(_MSC_VER)
+
+#include "osal.h"
+using namespace std;
+using namespace OSAL;
+
+void * OSAL::AllocateExecutableMemory(std::size_t size)
+{
+	return VirtualAlloc(nullptr, size, MEM_COMMIT | MEM_RESERVE, PAGE_READWRITE);
+}
+
+bool OSAL::ProtectExecutableMemory(void * address, std::size_t size, bool executable)
+{
+	DWORD oldProtection;
+	if (!VirtualProtect(address, size, executable ? PAGE_EXECUTE_READ : PAGE_READWRITE, &oldProtection))
+		return false;
+	return !executable || FlushInstructionCache(GetCurrentProcess(), address, size);
+}
+
+void OSAL::FreeExecutableMemory(void * address, std::size_t size)
+{
+	if (address != nullptr)
+		VirtualFree(address, 0, MEM_RELEASE);
+}
+
+#endif // defined(_MSC_VER)
@@ -1,6 +1,7 @@
 #include "unit-test-c++/UnitTestC++.h"
 
 #include "osal.h"
+#include "osal/memory.h"
 
 using namespace std;
 
@@ -89,6 +90,20 @@ TEST_FIXTURE(OSALTest, SwapBytesInt64)
 	EXPECT_EQ(expected, actual);
 }
 
+TEST_FIXTURE(OSALTest, ProtectExecutableMemory)
+{
+	size_t size = 4096;
+	uint8_t * memory = static_cast<uint8_t *>(OSAL::AllocateExecutableMemory(size));
+	ASSERT_NOT_NULL(memory);
+	memory[0] = 0xC3;
+	EXPECT_TRUE(OSAL::ProtectExecutableMemory(memory, size, true));
+	EXPECT_EQ(0xC3, memory[0]);
+	EXPECT_TRUE(OSAL::ProtectExecutableMemory(memory, size, false));
+	memory[1] = 0xC3;
+	EXPECT_EQ(0xC3, memory[1]);
+	OSAL::FreeExecutableMemory(memory, size);
+}
+
 } // namespace Test
 
 } // namespace OSAL
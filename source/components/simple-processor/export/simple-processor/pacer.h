@@ -0,0 +1,85 @@
+#pragma once
+
+#include <chrono>
+#include <cstdint>
+
+namespace Simulate
+{
+
+struct PacerStatistics
+{
+    uint64_t clockCount;        // Clocks run since the last reset
+    double elapsedSeconds;      // Wall clock time since the last reset
+    double targetFrequency;     // Clock frequency times the speed multiplier, 0 when unthrottled
+    double achievedFrequency;
+    uint64_t slices;            // Slices paced
+    uint64_t overruns;          // Slices which ended after their deadline
+
+    PacerStatistics()
+        : clockCount()
+        , elapsedSeconds()
+        , targetFrequency()
+        , achievedFrequency()
+        , slices()
+        , overruns()
+    {}
+};
+
+// Keeps an emulated processor at its real-time clock frequency.
+// The processor runs free for a slice of clocks (1 ms of emulated time by default), then sleeps until the absolute
+// wall clock time that slice should end at. Deadlines are computed from a fixed starting point, so errors in sleeping
+// are corrected by the next slices instead of accumulating.
+// A processor that falls behind by more than a slice (e.g. stopped in a debugger) starts over from the current time
+// instead of running unthrottled to catch up.
+class Pacer
+{
+public:
+    using TimePoint = std::chrono::steady_clock::time_point;
+    using Duration = std::chrono::nanoseconds;
+
+    static const double Unthrottled;
+
+    explicit Pacer(double clockFrequency, Duration slice = std::chrono::milliseconds(1));
+    virtual ~Pacer();
+
+    void Reset(uint64_t clockCount = 0);
+
+    // Run at multiplier times the clock frequency, e.g. 2 or 10, or as fast as possible with Unthrottled (0)
+    void SetSpeed(double multiplier, uint64_t clockCount);
+    double GetSpeed() const { return multiplier; }
+    void SetSlice(Duration slice, uint64_t clockCount);
+    Duration GetSlice() const { return slice; }
+    double GetClockFrequency() const { return clockFrequency; }
+
+    // Called with the total clock count after every instruction, only does work at the end of a slice
+    void Pace(uint64_t clockCount)
+    {
+        if (clockCount >= sliceEnd)
+            EndSlice(clockCount);
+    }
+
+    PacerStatistics GetStatistics(uint64_t clockCount) const;
+
+protected:
+    virtual TimePoint Now() const;
+    virtual void SleepUntil(TimePoint time);
+
+private:
+    double clockFrequency;
+    double multiplier;
+    Duration slice;
+    uint64_t sliceClocks;
+    uint64_t sliceEnd;
+    // Deadlines are startTime plus the time clocks since startClockCount take at the target frequency
+    TimePoint startTime;
+    uint64_t startClockCount;
+    TimePoint resetTime;
+    uint64_t resetClockCount;
+    uint64_t slices;
+    uint64_t overruns;
+
+    void Restart(uint64_t clockCount);
+    void EndSlice(uint64_t clockCount);
+};
+
+} // namespace Simulate
@@ -4,6 +4,7 @@
 #include <iostream>
 #include <sstream>
 #include "simple-processor/imemory.h"
+#include "simple-processor/pacer.h"
 #include "osal/flagoperators.h"
 #include "core/Observable.h"
 
@@ -138,24 +139,6 @@ template <class AddressType, class Opcode, class Registers, class InstructionInf
 class Processor : public Core::Observable<IDebugger<InstructionInfo, Registers>>
 {
 public:
-    using picoseconds = std::chrono::duration<int64_t, std::pico>;
-
-    class Clock
-    {
-    public:
-        Clock() = delete;
-        Clock(picoseconds clockInterval);
-        virtual ~Clock();
-        virtual void Reset();
-        void Wait(uint64_t clockCount);
-
-    protected:
-        picoseconds clockintervalPS;
-        uint64_t lastClockCount;
-        std::chrono::high_resolution_clock clock;
-        std::chrono::high_resolution_clock::time_point lastTime;
-    };
-
     Processor(double clockFreq,
               CharReader & reader, 
               CharWriter & writer);
@@ -169,6 +152,9 @@ public:
     virtual void FetchInstruction() = 0;
     virtual void Execute(uint8_t opcodeByte) = 0;
     void SetDebugMode(DebugMode value) { debugMode = value; }
+    // Real-time pacing, not used with DebugMode::NonRealTime
+    Pacer & GetPacer() { return pacer; }
+    PacerStatistics GetPacerStatistics() const { return pacer.GetStatistics(registers.totalClockCount); }
 
     void ClearMemory()
     {
@@ -196,7 +182,7 @@ public:
     }
 
 protected:
-    Clock clock;
+    Pacer pacer;
     Registers registers;
     IMemory<uint8_t> * memory;
     CharReader & reader;
@@ -210,47 +196,11 @@ protected:
 };
 
 
-template <class AddressType, class Opcode, class Registers, class InstructionInfo>
-Processor<AddressType, Opcode, Registers, InstructionInfo>::Clock::Clock(picoseconds clockInterval)
-    : clockintervalPS(clockInterval)
-    , clock()
-    , lastClockCount()
-    , lastTime()
-{
-    lastClockCount = 0;
-    lastTime = clock.now();
-}
-
-template <class AddressType, class Opcode, class Registers, class InstructionInfo>
-Processor<AddressType, Opcode, Registers, InstructionInfo>::Clock::~Clock()
-{
-}
-
-template <class AddressType, class Opcode, class Registers, class InstructionInfo>
-void Processor<AddressType, Opcode, Registers, InstructionInfo>::Clock::Reset()
-{
-    lastClockCount = 0;
-    lastTime = clock.now();
-}
-
-template <class AddressType, class Opcode, class Registers, class InstructionInfo>
-void Processor<AddressType, Opcode, Registers, InstructionInfo>::Clock::Wait(uint64_t clockCount)
-{
-    chrono::high_resolution_clock::time_point deadline = lastTime + chrono::duration_cast<chrono::nanoseconds>((clockCount - lastClockCount) * clockintervalPS);
-    chrono::high_resolution_clock::time_point now = clock.now();
-    if (now < deadline)
-    {
-        this_thread::sleep_for(chrono::duration_cast<chrono::nanoseconds>(deadline - now));
-    }
-    lastTime = clock.now();
-    lastClockCount = clockCount;
-}
-
 template <class AddressType, class Opcode, class Registers, class InstructionInfo>
 Processor<AddressType, Opcode, Registers, InstructionInfo>::Processor(double clockFreq,
                                           CharReader & reader, 
                                           CharWriter & writer)
-    : clock(picoseconds(int64_t(tera::num / clockFreq + 0.5)))
+    : pacer(clockFreq)
     , registers()
     , memory(nullptr)
     , reader(reader)
@@ -268,7 +218,7 @@ template <class AddressType, class Opcode, class Registers, class InstructionInf
 void Processor<AddressType, Opcode, Registers, InstructionInfo>::Reset()
 {
     registers.Reset();
-    clock.Reset();
+    pacer.Reset();
     if ((debugMode & DebugMode::Trace) != 0)
     {
         for (auto observer : observers)
@@ -0,0 +1,108 @@
+#include "simple-processor/pacer.h"
+
+#include <stdexcept>
+#include <thread>
+
+using namespace std;
+using namespace Simulate;
+
+const double Pacer::Unthrottled = 0.0;
+
+Pacer::Pacer(double clockFrequency, Duration slice)
+    : clockFrequency(clockFrequency)
+    , multiplier(1.0)
+    , slice(slice)
+    , sliceClocks()
+    , sliceEnd()
+    , startTime()
+    , startClockCount()
+    , resetTime()
+    , resetClockCount()
+    , slices()
+    , overruns()
+{
+    if (clockFrequency <= 0)
+        throw std::invalid_argument("Pacer: clock frequency must be positive");
+    Reset();
+}
+
+Pacer::~Pacer()
+{
+}
+
+void Pacer::Reset(uint64_t clockCount)
+{
+    slices = 0;
+    overruns = 0;
+    Restart(clockCount);
+    resetTime = startTime;
+    resetClockCount = clockCount;
+}
+
+void Pacer::SetSpeed(double multiplier, uint64_t clockCount)
+{
+    if (multiplier < 0)
+        throw std::invalid_argument("Pacer: speed multiplier must not be negative");
+    this->multiplier = multiplier;
+    Restart(clockCount);
+}
+
+void Pacer::SetSlice(Duration slice, uint64_t clockCount)
+{
+    this->slice = slice;
+    Restart(clockCount);
+}
+
+// Start a new time line at the current time, with the slice length for the current speed
+void Pacer::Restart(uint64_t clockCount)
+{
+    startTime = Now();
+    startClockCount = clockCount;
+    double clocks = clockFrequency * ((multiplier == Unthrottled) ? 1.0 : multiplier) * chrono::duration<double>(slice).count();
+    sliceClocks = (clocks < 1.0) ? 1 : uint64_t(clocks);
+    sliceEnd = clockCount + sliceClocks;
+}
+
+void Pacer::EndSlice(uint64_t clockCount)
+{
+    ++slices;
+    sliceEnd = clockCount + sliceClocks;
+    if (multiplier == Unthrottled)
+        return;
+    double seconds = double(clockCount - startClockCount) / (clockFrequency * multiplier);
+    TimePoint deadline = startTime + chrono::duration_cast<Duration>(chrono::duration<double>(seconds));
+    TimePoint now = Now();
+    if (now < deadline)
+    {
+        SleepUntil(deadline);
+        return;
+    }
+    ++overruns;
+    if (now - deadline > slice)
+    {
+        startTime = now;
+        startClockCount = clockCount;
+    }
+}
+
+PacerStatistics Pacer::GetStatistics(uint64_t clockCount) const
+{
+    PacerStatistics statistics;
+    statistics.clockCount = clockCount - resetClockCount;
+    statistics.elapsedSeconds = chrono::duration<double>(Now() - resetTime).count();
+    statistics.targetFrequency = clockFrequency * multiplier;
+    statistics.achievedFrequency = (statistics.elapsedSeconds > 0) ? double(statistics.clockCount) / statistics.elapsedSeconds : 0.0;
+    statistics.slices = slices;
+    statistics.overruns = overruns;
+    return statistics;
+}
+
+Pacer::TimePoint Pacer::Now() const
+{
+    return chrono::steady_clock::now();
+}
+
+void Pacer::SleepUntil(TimePoint time)
+{
+    this_thread::sleep_until(time);
+}
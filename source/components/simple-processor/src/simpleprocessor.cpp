@@ -1,7 +1,6 @@
 #include "simple-processor/simpleprocessor.h"
 
 #include <map>
-#include <thread>
 #include "core/String.h"
 #include "core/Util.h"
 
@@ -362,7 +361,7 @@ void SimpleProcessor::Registers::Reset()
 void SimpleProcessor::Reset()
 {
     registers.Reset();
-    clock.Reset();
+    pacer.Reset();
     if ((debugMode & DebugMode::Trace) != 0)
     {
         for (auto observer : observers)
@@ -805,7 +804,7 @@ void SimpleProcessor::Execute(uint8_t opcodeByte)
     }
     if ((debugMode & DebugMode::NonRealTime) == 0)
     {
-        clock.Wait(registers.totalClockCount);
+        pacer.Pace(registers.totalClockCount);
     }
 }
 
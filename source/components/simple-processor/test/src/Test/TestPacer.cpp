@@ -0,0 +1,170 @@
+#include "unit-test-c++/UnitTestC++.h"
+
+#include "simple-processor/pacer.h"
+
+using namespace std;
+
+namespace Simulate
+{
+
+namespace Test
+{
+
+// Pacer on a simulated wall clock, sleeping moves the clock to the deadline plus oversleep
+class PacerAccessor : public Pacer
+{
+public:
+    PacerAccessor(double clockFrequency)
+        : Pacer(clockFrequency)
+        , time()
+        , oversleep()
+        , sleeps()
+    {
+        Reset();
+    }
+
+    TimePoint time;
+    Duration oversleep;
+    size_t sleeps;
+
+protected:
+    TimePoint Now() const override { return time; }
+    void SleepUntil(TimePoint deadline) override
+    {
+        ++sleeps;
+        time = deadline + oversleep;
+    }
+};
+
+class PacerTest : public UnitTestCpp::TestFixture
+{
+public:
+	virtual void SetUp();
+	virtual void TearDown();
+
+    static const double ClockFreq;
+};
+
+const double PacerTest::ClockFreq = 1000000;
+
+void PacerTest::SetUp()
+{
+}
+
+void PacerTest::TearDown()
+{
+}
+
+static Pacer::Duration Microseconds(int64_t count)
+{
+    return chrono::microseconds(count);
+}
+
+TEST_FIXTURE(PacerTest, Construct)
+{
+    PacerAccessor pacer(ClockFreq);
+    EXPECT_EQ(1.0, pacer.GetSpeed());
+    EXPECT_TRUE(Microseconds(1000) == pacer.GetSlice());
+    PacerStatistics statistics = pacer.GetStatistics(0);
+    EXPECT_EQ(uint64_t{ 0 }, statistics.clockCount);
+    EXPECT_EQ(ClockFreq, statistics.targetFrequency);
+    EXPECT_EQ(uint64_t{ 0 }, statistics.slices);
+    EXPECT_EQ(uint64_t{ 0 }, statistics.overruns);
+    EXPECT_THROW(Pacer(0), std::invalid_argument);
+    EXPECT_THROW(pacer.SetSpeed(-1, 0), std::invalid_argument);
+}
+
+TEST_FIXTURE(PacerTest, SleepsOncePerSlice)
+{
+    PacerAccessor pacer(ClockFreq);
+    Pacer::TimePoint start = pacer.time;
+    for (uint64_t clockCount = 1; clockCount <= 5000; ++clockCount)
+        pacer.Pace(clockCount);
+    EXPECT_EQ(size_t{ 5 }, pacer.sleeps);
+    EXPECT_TRUE(start + Microseconds(5000) == pacer.time);
+
+    PacerStatistics statistics = pacer.GetStatistics(5000);
+    EXPECT_EQ(uint64_t{ 5000 }, statistics.clockCount);
+    EXPECT_NEAR(0.005, statistics.elapsedSeconds, 1E-9);
+    EXPECT_NEAR(ClockFreq, statistics.achievedFrequency, 1E-3);
+    EXPECT_EQ(uint64_t{ 5 }, statistics.slices);
+    EXPECT_EQ(uint64_t{ 0 }, statistics.overruns);
+}
+
+TEST_FIXTURE(PacerTest, DriftCorrected)
+{
+    // Deadlines are absolute, sleeping too long is made up for in the next slice
+    PacerAccessor pacer(ClockFreq);
+    Pacer::TimePoint start = pacer.time;
+    pacer.oversleep = Microseconds(300);
+    pacer.Pace(1000);
+    EXPECT_TRUE(start + Microseconds(1300) == pacer.time);
+    pacer.Pace(2000);
+    EXPECT_TRUE(start + Microseconds(2300) == pacer.time);
+    // Instructions don't end exactly at the slice end
+    pacer.Pace(3007);
+    EXPECT_TRUE(start + Microseconds(3307) == pacer.time);
+    EXPECT_EQ(size_t{ 3 }, pacer.sleeps);
+    EXPECT_EQ(uint64_t{ 0 }, pacer.GetStatistics(3007).overruns);
+}
+
+TEST_FIXTURE(PacerTest, Overruns)
+{
+    PacerAccessor pacer(ClockFreq);
+    Pacer::TimePoint start = pacer.time;
+    // Half a slice late: no sleep, caught up in the next slice
+    pacer.time += Microseconds(1500);
+    pacer.Pace(1000);
+    EXPECT_EQ(size_t{ 0 }, pacer.sleeps);
+    pacer.Pace(2000);
+    EXPECT_EQ(size_t{ 1 }, pacer.sleeps);
+    EXPECT_TRUE(start + Microseconds(2000) == pacer.time);
+
+    // Far behind: start over from now instead of running unthrottled
+    pacer.time += Microseconds(10000);
+    pacer.Pace(3000);
+    Pacer::TimePoint restart = pacer.time;
+    pacer.Pace(4000);
+    EXPECT_EQ(size_t{ 2 }, pacer.sleeps);
+    EXPECT_TRUE(restart + Microseconds(1000) == pacer.time);
+    EXPECT_EQ(uint64_t{ 2 }, pacer.GetStatistics(4000).overruns);
+}
+
+TEST_FIXTURE(PacerTest, Speed)
+{
+    PacerAccessor pacer(ClockFreq);
+    pacer.SetSpeed(10, 0);
+    Pacer::TimePoint start = pacer.time;
+    for (uint64_t clockCount = 1; clockCount <= 50000; ++clockCount)
+        pacer.Pace(clockCount);
+    EXPECT_EQ(size_t{ 5 }, pacer.sleeps);
+    EXPECT_TRUE(start + Microseconds(5000) == pacer.time);
+    EXPECT_EQ(10 * ClockFreq, pacer.GetStatistics(50000).targetFrequency);
+
+    pacer.SetSpeed(2, 50000);
+    pacer.Pace(52000);
+    EXPECT_TRUE(start + Microseconds(6000) == pacer.time);
+
+    pacer.SetSpeed(Pacer::Unthrottled, 52000);
+    for (uint64_t clockCount = 52001; clockCount <= 152000; ++clockCount)
+        pacer.Pace(clockCount);
+    EXPECT_EQ(size_t{ 6 }, pacer.sleeps);
+    PacerStatistics statistics = pacer.GetStatistics(152000);
+    EXPECT_EQ(0.0, statistics.targetFrequency);
+    EXPECT_EQ(uint64_t{ 5 + 1 + 100 }, statistics.slices);
+}
+
+TEST_FIXTURE(PacerTest, Slice)
+{
+    PacerAccessor pacer(ClockFreq);
+    pacer.SetSlice(Microseconds(10000), 0);
+    for (uint64_t clockCount = 1; clockCount <= 50000; ++clockCount)
+        pacer.Pace(clockCount);
+    EXPECT_EQ(size_t{ 5 }, pacer.sleeps);
+    pacer.Reset();
+    EXPECT_EQ(uint64_t{ 0 }, pacer.GetStatistics(0).slices);
+}
+
+} // namespace Test
+
+} // namespace Simulate